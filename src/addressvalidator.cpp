@@ -0,0 +1,160 @@
+#include "addressvalidator.h"
+#include <array>
+#include "stringutils.h"
+
+using namespace jed_utils;
+
+namespace {
+// Limits of RFC 5321 section 4.5.3.1
+const size_t MAX_LOCAL_PART_LENGTH = 64;
+const size_t MAX_DOMAIN_LENGTH = 255;
+const size_t MAX_LABEL_LENGTH = 63;
+// A path is at most 256 octets including the angle brackets
+const size_t MAX_ADDRESS_LENGTH = 254;
+
+enum CharacterClass : unsigned char {
+    ATEXT = 1,
+    LABEL = 2,
+    LITERAL = 4
+};
+
+constexpr std::array<unsigned char, 256> createCharacterTable() {
+    std::array<unsigned char, 256> table {};
+    for (int c = 'a'; c <= 'z'; c++) {
+        table[static_cast<size_t>(c)] = ATEXT | LABEL;
+        table[static_cast<size_t>(c - 'a' + 'A')] = ATEXT | LABEL;
+    }
+    for (int c = '0'; c <= '9'; c++) {
+        table[static_cast<size_t>(c)] = ATEXT | LABEL | LITERAL;
+    }
+    for (int c = 'a'; c <= 'f'; c++) {
+        table[static_cast<size_t>(c)] |= LITERAL;
+        table[static_cast<size_t>(c - 'a' + 'A')] |= LITERAL;
+    }
+    const char others[] = "!#$%&'*+/=?^_`{|}~";
+    for (size_t index = 0; others[index] != '\0'; index++) {
+        table[static_cast<unsigned char>(others[index])] = ATEXT;
+    }
+    // The bytes of the UTF-8 sequences, whose structure is checked apart
+    for (int c = 0x80; c <= 0xFF; c++) {
+        table[static_cast<size_t>(c)] = ATEXT | LABEL;
+    }
+    table['-'] = ATEXT | LABEL;
+    table['.'] = LITERAL;
+    table[':'] = LITERAL;
+    return table;
+}
+
+constexpr std::array<unsigned char, 256> CHARACTER_TABLE = createCharacterTable();
+
+bool hasClass(char pChar, CharacterClass pClass) {
+    return (CHARACTER_TABLE[static_cast<unsigned char>(pChar)] & pClass) != 0;
+}
+}  // namespace
+
+bool AddressValidator::isValid(std::string_view pAddress) {
+    if (pAddress.size() > MAX_ADDRESS_LENGTH) {
+        return false;
+    }
+    // The local part cannot contain an @ unless it is quoted
+    const size_t at_position = pAddress.rfind('@');
+    if (at_position == std::string_view::npos || !StringUtils::isValidUtf8(pAddress)) {
+        return false;
+    }
+    return isValidLocalPart(pAddress.substr(0, at_position)) &&
+        isValidDomain(pAddress.substr(at_position + 1));
+}
+
+std::vector<size_t> AddressValidator::validateAddresses(const char * const *pAddresses, size_t pCount) {
+    std::vector<size_t> invalid_indices;
+    for (size_t index = 0; index < pCount; index++) {
+        if (pAddresses[index] == nullptr || !isValid(pAddresses[index])) {
+            invalid_indices.push_back(index);
+        }
+    }
+    return invalid_indices;
+}
+
+std::vector<size_t> AddressValidator::validateAddresses(const std::vector<std::string> &pAddresses) {
+    std::vector<size_t> invalid_indices;
+    for (size_t index = 0; index < pAddresses.size(); index++) {
+        if (!isValid(pAddresses[index])) {
+            invalid_indices.push_back(index);
+        }
+    }
+    return invalid_indices;
+}
+
+bool AddressValidator::isValidLocalPart(std::string_view pLocalPart) {
+    if (pLocalPart.empty() || pLocalPart.size() > MAX_LOCAL_PART_LENGTH) {
+        return false;
+    }
+    // Dot-string: atoms separated by single dots
+    bool previous_is_dot = true;
+    for (const char c : pLocalPart) {
+        if (c == '.') {
+            if (previous_is_dot) {
+                return false;
+            }
+            previous_is_dot = true;
+        } else if (hasClass(c, ATEXT)) {
+            previous_is_dot = false;
+        } else {
+            return false;
+        }
+    }
+    return !previous_is_dot;
+}
+
+bool AddressValidator::isValidDomain(std::string_view pDomain) {
+    if (pDomain.empty() || pDomain.size() > MAX_DOMAIN_LENGTH) {
+        return false;
+    }
+    if (pDomain.front() == '[') {
+        return pDomain.back() == ']' && isValidAddressLiteral(pDomain.substr(1, pDomain.size() - 2));
+    }
+    // Labels of letters, digits and hyphens that do not start or end with a
+    // hyphen. The length of a label with UTF-8 characters is checked when it
+    // is converted to its A-label.
+    size_t label_length = 0;
+    bool label_is_ascii = true;
+    char previous = '.';
+    for (const char c : pDomain) {
+        if (c == '.') {
+            if (label_length == 0 || previous == '-') {
+                return false;
+            }
+            label_length = 0;
+            label_is_ascii = true;
+        } else if (hasClass(c, LABEL)) {
+            if (c == '-' && label_length == 0) {
+                return false;
+            }
+            label_is_ascii = label_is_ascii && static_cast<unsigned char>(c) < 0x80;
+            if (++label_length > MAX_LABEL_LENGTH && label_is_ascii) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+        previous = c;
+    }
+    return label_length > 0 && previous != '-';
+}
+
+bool AddressValidator::isValidAddressLiteral(std::string_view pLiteral) {
+    const std::string_view IPV6_TAG { "IPv6:" };
+    const bool is_ipv6 = pLiteral.substr(0, IPV6_TAG.size()) == IPV6_TAG;
+    if (is_ipv6) {
+        pLiteral.remove_prefix(IPV6_TAG.size());
+    }
+    if (pLiteral.empty()) {
+        return false;
+    }
+    for (const char c : pLiteral) {
+        if (!hasClass(c, LITERAL) || (!is_ipv6 && c != '.' && (c < '0' || c > '9'))) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef ADDRESSVALIDATOR_H
+#define ADDRESSVALIDATOR_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define ADDRESSVALIDATOR_API __declspec(dllexport)
+    #else
+        #define ADDRESSVALIDATOR_API __declspec(dllimport)
+    #endif
+#else
+    #define ADDRESSVALIDATOR_API
+#endif
+
+namespace jed_utils {
+/** @brief The AddressValidator checks the syntax of email addresses as they
+ *  are sent in the MAIL FROM and RCPT TO commands (RFC 5321 section 4.1.2).
+ *
+ *  The local part is a dot-string of atext characters and the domain is
+ *  either a list of labels made of letters, digits and hyphens or an
+ *  address literal between brackets. The internationalized addresses of
+ *  RFC 6531 are accepted: the local part and the labels may also contain
+ *  UTF-8 characters, the address being valid UTF-8. Quoted local parts are
+ *  not accepted. The address is scanned with a character table, without
+ *  allocating.
+ */
+class ADDRESSVALIDATOR_API AddressValidator {
+ public:
+    /**
+     *  @brief  Indicate if an email address is valid.
+     *  @param pAddress The email address. Example: joeblow@domainexample.com
+     */
+    static bool isValid(std::string_view pAddress);
+
+    /**
+     *  @brief  Validate a list of email addresses.
+     *  @param pAddresses The email addresses. A null pointer is invalid.
+     *  @param pCount The number of addresses.
+     *  @return The indices of the invalid addresses in increasing order.
+     */
+    static std::vector<size_t> validateAddresses(const char * const *pAddresses, size_t pCount);
+
+    /**
+     *  @brief  Validate a list of email addresses.
+     *  @param pAddresses The email addresses.
+     *  @return The indices of the invalid addresses in increasing order.
+     */
+    static std::vector<size_t> validateAddresses(const std::vector<std::string> &pAddresses);
+
+ private:
+    static bool isValidLocalPart(std::string_view pLocalPart);
+    static bool isValidDomain(std::string_view pDomain);
+    static bool isValidAddressLiteral(std::string_view pLiteral);
+};
+}  // namespace jed_utils
+
+#endif
@@ -0,0 +1,92 @@
+#include "asyncsmtpclient.h"
+#include <stdexcept>
+#include <utility>
+
+using namespace jed_utils;
+
+AsyncSmtpClient::AsyncSmtpClient(SmtpClientType pType,
+        const char *pServerName,
+        unsigned int pPort,
+        const Credential *pCredential,
+        size_t pWorkerCount)
+    : mType(pType),
+      mServerName(pServerName == nullptr ? "" : pServerName),
+      mPort(pPort),
+      mCredential(pCredential != nullptr ? new Credential(*pCredential) : nullptr),
+      mPool(pWorkerCount == 0 ? 1 : pWorkerCount) {
+    if (mServerName.empty()) {
+        throw std::invalid_argument("Server name cannot be null or empty");
+    }
+    const size_t worker_count = pWorkerCount == 0 ? 1 : pWorkerCount;
+    mWorkers.reserve(worker_count);
+    for (size_t index = 0; index < worker_count; index++) {
+        mWorkers.emplace_back(&AsyncSmtpClient::workerLoop, this);
+    }
+}
+
+AsyncSmtpClient::~AsyncSmtpClient() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mJobQueued.notify_all();
+    for (auto &worker : mWorkers) {
+        worker.join();
+    }
+}
+
+std::future<int> AsyncSmtpClient::sendMailAsync(std::shared_ptr<const Message> pMsg) {
+    auto promise = std::make_shared<std::promise<int>>();
+    std::future<int> result = promise->get_future();
+    sendMailAsync(std::move(pMsg), [promise](int pReturnCode) {
+            promise->set_value(pReturnCode);
+            });
+    return result;
+}
+
+void AsyncSmtpClient::sendMailAsync(std::shared_ptr<const Message> pMsg, CompletionCallback pCallback) {
+    if (pMsg == nullptr) {
+        throw std::invalid_argument("Message cannot be null");
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJobs.push_back(SendJob { std::move(pMsg), std::move(pCallback) });
+    }
+    mJobQueued.notify_one();
+}
+
+size_t AsyncSmtpClient::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mJobs.size() + mActiveJobs;
+}
+
+void AsyncSmtpClient::waitForIdle() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mJobCompleted.wait(lock, [this]() { return mJobs.empty() && mActiveJobs == 0; });
+}
+
+void AsyncSmtpClient::workerLoop() {
+    while (true) {
+        SendJob job;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mJobQueued.wait(lock, [this]() { return mStopping || !mJobs.empty(); });
+            // The queue is drained before the worker stops
+            if (mJobs.empty()) {
+                return;
+            }
+            job = std::move(mJobs.front());
+            mJobs.pop_front();
+            mActiveJobs++;
+        }
+        int ret_code = mPool.sendMail(mType, mServerName.c_str(), mPort, mCredential.get(), *job.message);
+        if (job.callback) {
+            job.callback(ret_code);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mActiveJobs--;
+        }
+        mJobCompleted.notify_all();
+    }
+}
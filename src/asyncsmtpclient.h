@@ -0,0 +1,190 @@
+#ifndef ASYNCSMTPCLIENT_H
+#define ASYNCSMTPCLIENT_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "credential.h"
+#include "message.h"
+#include "smtpconnectionpool.h"
+
+// The coroutine support is available when the application is compiled as
+// C++20 (the library itself does not need it).
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+    #include <coroutine>
+    #define SMTPCLIENT_HAS_COROUTINES
+#endif
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define ASYNCSMTPCLIENT_API __declspec(dllexport)
+    #else
+        #define ASYNCSMTPCLIENT_API __declspec(dllimport)
+    #endif
+#else
+    #define ASYNCSMTPCLIENT_API
+#endif
+
+namespace jed_utils {
+#ifdef SMTPCLIENT_HAS_COROUTINES
+class SendMailAwaiter;
+#endif
+
+/** @brief The AsyncSmtpClient sends messages without blocking the calling
+ *  thread. The messages are queued and sent by a fixed number of worker
+ *  threads through persistent sessions kept in a SmtpConnectionPool, so
+ *  the number of threads does not grow with the number of messages.
+ */
+class ASYNCSMTPCLIENT_API AsyncSmtpClient {
+ public:
+    /** The function called once a message has been sent. It receives 0 for
+     *  success, otherwise the error code of the failed step. It is called
+     *  on a worker thread and must not throw.
+     */
+    using CompletionCallback = std::function<void(int pReturnCode)>;
+
+#ifdef SMTPCLIENT_HAS_COROUTINES
+    /** The function that resumes a coroutine once its message has been sent,
+     *  for instance by posting it to the event loop of the coroutine. It is
+     *  called on a worker thread.
+     */
+    using ResumeExecutor = std::function<void(std::coroutine_handle<> pHandle)>;
+#endif
+
+    /**
+     *  @brief  Construct a new AsyncSmtpClient.
+     *  @param pType The SMTP client class used for the sessions.
+     *  @param pServerName The name of the server.
+     *  Example: smtp.domainexample.com
+     *  @param pPort The server port number.
+     *  Example: 25, 465, 587
+     *  @param pCredential The credential used to authenticate or nullptr.
+     *  @param pWorkerCount The number of worker threads, which is also the
+     *  maximum number of sessions opened with the server.
+     *  Default: 4
+     */
+    AsyncSmtpClient(SmtpClientType pType,
+            const char *pServerName,
+            unsigned int pPort,
+            const Credential *pCredential = nullptr,
+            size_t pWorkerCount = 4);
+
+    /** Destructor of the AsyncSmtpClient. The queued messages are sent
+     *  before the worker threads are stopped. */
+    ~AsyncSmtpClient();
+
+    AsyncSmtpClient(const AsyncSmtpClient& other) = delete;
+    AsyncSmtpClient& operator=(const AsyncSmtpClient& other) = delete;
+
+    /**
+     *  @brief  Queue a message to be sent.
+     *  @param pMsg The message to send. It is kept alive until it is sent.
+     *  @return A future that receives 0 for success, otherwise the error
+     *  code of the failed step.
+     */
+    std::future<int> sendMailAsync(std::shared_ptr<const Message> pMsg);
+
+    /**
+     *  @brief  Queue a message to be sent and call a function once it is sent.
+     *  @param pMsg The message to send. It is kept alive until it is sent.
+     *  @param pCallback The function called with the return code.
+     */
+    void sendMailAsync(std::shared_ptr<const Message> pMsg, CompletionCallback pCallback);
+
+#ifdef SMTPCLIENT_HAS_COROUTINES
+    /**
+     *  @brief  Queue a message to be sent when the result is awaited with
+     *  co_await, which gives 0 for success, otherwise the error code of the
+     *  failed step. The coroutine is suspended while the message is sent.
+     *  @param pMsg The message to send. It is kept alive until it is sent.
+     *  @param pExecutor The function that resumes the coroutine or nullptr to
+     *  resume it directly on the worker thread that sent the message.
+     */
+    [[nodiscard]] SendMailAwaiter sendMail(std::shared_ptr<const Message> pMsg, ResumeExecutor pExecutor = nullptr);
+#endif
+
+    /** Return the number of messages queued or being sent. */
+    size_t getPendingCount() const;
+
+    /** Block until all the queued messages have been sent. */
+    void waitForIdle();
+
+ private:
+    struct SendJob {
+        std::shared_ptr<const Message> message;
+        CompletionCallback callback;
+    };
+
+    void workerLoop();
+
+    SmtpClientType mType;
+    std::string mServerName;
+    unsigned int mPort;
+    std::unique_ptr<Credential> mCredential;
+    SmtpConnectionPool mPool;
+    mutable std::mutex mMutex;
+    std::condition_variable mJobQueued;
+    std::condition_variable mJobCompleted;
+    std::deque<SendJob> mJobs;
+    size_t mActiveJobs = 0;
+    bool mStopping = false;
+    std::vector<std::thread> mWorkers;
+};
+
+#ifdef SMTPCLIENT_HAS_COROUTINES
+/** @brief The SendMailAwaiter is the result of AsyncSmtpClient::sendMail.
+ *  Awaiting it queues the message and suspends the coroutine until the
+ *  message is sent.
+ */
+class SendMailAwaiter {
+ public:
+    SendMailAwaiter(AsyncSmtpClient &pClient,
+            std::shared_ptr<const Message> pMsg,
+            AsyncSmtpClient::ResumeExecutor pExecutor)
+        : mClient(pClient), mMessage(std::move(pMsg)), mExecutor(std::move(pExecutor)) {
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> pHandle) {
+        // The executor is moved into the callback because the awaiter is
+        // destroyed with the coroutine frame once the coroutine is resumed.
+        mClient.sendMailAsync(std::move(mMessage),
+                [this, pHandle, executor = std::move(mExecutor)](int pReturnCode) {
+                    mReturnCode = pReturnCode;
+                    if (executor) {
+                        executor(pHandle);
+                    } else {
+                        pHandle.resume();
+                    }
+                });
+    }
+
+    int await_resume() const noexcept {
+        return mReturnCode;
+    }
+
+ private:
+    AsyncSmtpClient &mClient;
+    std::shared_ptr<const Message> mMessage;
+    AsyncSmtpClient::ResumeExecutor mExecutor;
+    int mReturnCode = 0;
+};
+
+inline SendMailAwaiter AsyncSmtpClient::sendMail(std::shared_ptr<const Message> pMsg, ResumeExecutor pExecutor) {
+    return SendMailAwaiter(*this, std::move(pMsg), std::move(pExecutor));
+}
+#endif
+}  // namespace jed_utils
+
+#endif
@@ -2,13 +2,27 @@
 #include <algorithm>
 #include <ios>
 #include <iostream>
-#include <limits>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
+#include "mimetypes.h"
+#include "quotedprintable.h"
 #include "stringutils.h"
 
 using namespace jed_utils;
 
+namespace {
+char *copyString(const char *pSource) {
+    size_t length = strlen(pSource);
+    auto *retval = new char[length + 1];
+    strncpy(retval, pSource, length);
+    retval[length] = '\0';
+    return retval;
+}
+}  // namespace
+
 Attachment::Attachment(const char *pFilename, const char *pName)
     : mName(nullptr), mFilename(nullptr) {
     size_t pFileNameLength = strlen(pFilename);
@@ -16,15 +30,22 @@ Attachment::Attachment(const char *pFilename, const char *pName)
         throw std::invalid_argument("filename");
     }
 
-    size_t filename_len = pFileNameLength;
-    mFilename = new char[filename_len+1];
-    strncpy(mFilename, pFilename, filename_len);
-    mFilename[filename_len] = '\0';
+    mFilename = copyString(pFilename);
+    mName = copyString(pName);
+    mSource = std::make_shared<const FileAttachmentSource>(pFilename);
+}
 
-    size_t name_len = strlen(pName);
-    mName = new char[name_len+1];
-    strncpy(mName, pName, name_len);
-    mName[name_len] = '\0';
+Attachment::Attachment(std::shared_ptr<const AttachmentSource> pSource, const char *pName)
+    : mName(nullptr), mFilename(nullptr), mSource(std::move(pSource)) {
+    if (mSource == nullptr) {
+        throw std::invalid_argument("source");
+    }
+    if (pName == nullptr || StringUtils::trim(std::string(pName)).length() == 0) {
+        throw std::invalid_argument("name");
+    }
+    // The display name gives the MIME type of the content
+    mFilename = copyString(pName);
+    mName = copyString(pName);
 }
 
 Attachment::~Attachment() {
@@ -36,14 +57,9 @@ Attachment::~Attachment() {
 
 // Copy constructor
 Attachment::Attachment(const Attachment& other)
-    : mName(new char[strlen(other.mName) + 1]),
-      mFilename(new char[strlen(other.mFilename) + 1]) {
-    size_t name_len = strlen(other.mName);
-    strncpy(mName, other.mName, name_len);
-    mName[name_len] = '\0';
-    size_t filename_len = strlen(other.mFilename);
-    strncpy(mFilename, other.mFilename, filename_len);
-    mFilename[filename_len] = '\0';
+    : mName(copyString(other.mName)),
+      mFilename(copyString(other.mFilename)),
+      mSource(other.mSource) {
 }
 
 // Assignment operator
@@ -51,23 +67,16 @@ Attachment& Attachment::operator=(const Attachment& other) {
     if (this != &other) {
         delete[] mName;
         delete[] mFilename;
-        // mName
-        size_t name_len = strlen(other.mName);
-        mName = new char[name_len + 1];
-        strncpy(mName, other.mName, name_len);
-        mName[name_len] = '\0';
-        // mFilename
-        size_t filename_len = strlen(other.mFilename);
-        mFilename = new char[filename_len + 1];
-        strncpy(mFilename, other.mFilename, filename_len);
-        mFilename[filename_len] = '\0';
+        mName = copyString(other.mName);
+        mFilename = copyString(other.mFilename);
+        mSource = other.mSource;
     }
     return *this;
 }
 
 // Move constructor
 Attachment::Attachment(Attachment&& other) noexcept
-: mName(other.mName), mFilename(other.mFilename) {
+: mName(other.mName), mFilename(other.mFilename), mSource(std::move(other.mSource)) {
     // Release the data pointer from the source object so that the destructor
     // does not free the memory multiple times.
     other.mName = nullptr;
@@ -82,6 +91,7 @@ Attachment& Attachment::operator=(Attachment&& other) noexcept {
         // Copy the data pointer and its length from the source object.
         mName = other.mName;
         mFilename = other.mFilename;
+        mSource = std::move(other.mSource);
         // Release the data pointer from the source object so that
         // the destructor does not free the memory multiple times.
         other.mName = nullptr;
@@ -98,186 +108,144 @@ const char *Attachment::getFilename() const {
     return mFilename;
 }
 
-const char *Attachment::getBase64EncodedFile() const {
-    // Open the file
-    std::ifstream in(mFilename, std::ios::in | std::ios::binary);
-    if (in) {
-        std::string contents;
-        in.seekg(0, std::ios::end);
-        contents.resize(static_cast<unsigned int>(in.tellg()));
-        in.seekg(0, std::ios::beg);
-        if (static_cast<intmax_t>(contents.size()) <= std::numeric_limits<std::streamsize>::max()) {
-            in.read(&contents[0], static_cast<std::streamsize>(contents.size()));
-            in.close();
-            std::string base64_result = Base64::Encode(reinterpret_cast<const unsigned char*>(contents.c_str()), contents.length());
-            auto *base64_file = new char[base64_result.length() + 1];
-            strncpy(base64_file, base64_result.c_str(), base64_result.length() + 1);
-            return base64_file;
-        }
-        in.close();
+std::optional<size_t> Attachment::getSize() const {
+    if (mSource == nullptr) {
+        return std::nullopt;
     }
-
-    std::cerr << "Could not open file " << mFilename << std::endl;
-    return nullptr;
+    return mSource->getSize();
 }
 
-const char *Attachment::getMimeType() const {
-    std::string filename_str { mFilename };
-    const std::string extension = StringUtils::toUpper(filename_str.substr(filename_str.find_last_of('.') + 1));
-    // Images
-    if (extension == "PNG") {
-        return "image/png";
-    }
-    if (extension == "JPEG" || extension == "JPG" || extension == "JPE") {
-        return "image/jpeg";
-    }
-    if (extension == "GIF") {
-        return "image/gif";
-    }
-    if (extension == "TIFF" || extension == "TIF") {
-        return "image/tiff";
-    }
-    if (extension == "ICO") {
-        return "image/x-icon";
-    }
-    // Application
-    if (extension == "XML" || extension == "XSL") {
-        return "application/xml";
-    }
-    if (extension == "XHTML" || extension == "XHT") {
-        return "application/xhtml+xml";
-    }
-    if (extension == "PDF") {
-        return "application/pdf";
-    }
-    if (extension == "JS") {
-        return "application/javascript";
-    }
-    // Text
-    if (extension == "CSS") {
-        return "text/css";
-    }
-    if (extension == "CSV") {
-        return "text/csv";
-    }
-    if (extension == "HTML" || extension == "HTM") {
-        return "text/html";
-    }
-    if (extension == "TXT" || extension == "TEXT" || extension == "CONF"
-            || extension == "DEF" || extension == "LIST" || extension == "LOG"
-            || extension == "IN") {
-        return "text/plain";
-    }
-    // Videos
-    if (extension == "MPEG" || extension == "MPG" || extension == "MPE"
-            || extension == "M1V" || extension == "M2V") {
-        return "video/mpeg";
-    }
-    if (extension == "MP4" || extension == "MP4V" || extension == "MPG4") {
-        return "video/mp4";
-    }
-    if (extension == "QT" || extension == "MOV") {
-        return "video/quicktime";
-    }
-    if (extension == "WMV") {
-        return "video/x-ms-wmv";
-    }
-    if (extension == "AVI") {
-        return "video/x-msvideo";
-    }
-    if (extension == "FLV") {
-        return "video/x-flv";
-    }
-    if (extension == "WEBM") {
-        return "video/webm";
-    }
-    // Archives
-    if (extension == "ZIP") {
-        return "application/zip";
-    }
-    if (extension == "RAR") {
-        return "application/x-rar-compressed";
-    }
-    // Documents
-    if (extension == "ODT") {
-        return "application/vnd.oasis.opendocument.text";
-    }
-    if (extension == "ODS") {
-        return "application/vnd.oasis.opendocument.spreadsheet";
-    }
-    if (extension == "ODP") {
-        return "application/vnd.oasis.opendocument.presentation";
-    }
-    if (extension == "ODG") {
-        return "application/vnd.oasis.opendocument.graphics";
-    }
-    if (extension == "XLS" || extension == "XLM" || extension == "XLA"
-            || extension == "XLC" || extension == "XLT" || extension == "XLW") {
-        return "application/vnd.ms-excel";
+std::string Attachment::getCacheKey() const {
+    if (mSource == nullptr) {
+        return "";
     }
-    if (extension == "XLAM") {
-        return "application/vnd.ms-excel.addin.macroenabled.12";
-    }
-    if (extension == "XLSB") {
-        return "application/vnd.ms-excel.sheet.binary.macroenabled.12";
-    }
-    if (extension == "XLSM") {
-        return "application/vnd.ms-excel.sheet.macroenabled.12";
-    }
-    if (extension == "XLTM") {
-        return "application/vnd.ms-excel.template.macroenabled.12";
-    }
-    if (extension == "XLSX") {
-        return "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet";
-    }
-    if (extension == "XLTX") {
-        return "application/vnd.openxmlformats-officedocument.spreadsheetml.template";
-    }
-    if (extension == "PPT" || extension == "PPS" || extension == "POT") {
-        return "application/vnd.ms-powerpoint";
-    }
-    if (extension == "PPAM") {
-        return "application/vnd.ms-powerpoint.addin.macroenabled.12";
-    }
-    if (extension == "PPTM") {
-        return "application/vnd.ms-powerpoint.presentation.macroenabled.12";
-    }
-    if (extension == "SLDM") {
-        return "application/vnd.ms-powerpoint.slide.macroenabled.12";
-    }
-    if (extension == "PPSM") {
-        return "application/vnd.ms-powerpoint.slideshow.macroenabled.12";
-    }
-    if (extension == "POTM") {
-        return "application/vnd.ms-powerpoint.template.macroenabled.12";
-    }
-    if (extension == "PPTX") {
-        return "application/vnd.openxmlformats-officedocument.presentationml.presentation";
-    }
-    if (extension == "SLDX") {
-        return "application/vnd.openxmlformats-officedocument.presentationml.slide";
-    }
-    if (extension == "PPSX") {
-        return "application/vnd.openxmlformats-officedocument.presentationml.slideshow";
-    }
-    if (extension == "POTX") {
-        return "application/vnd.openxmlformats-officedocument.presentationml.template";
-    }
-    if (extension == "DOC") {
-        return "application/msword";
-    }
-    if (extension == "DOT") {
-        return "application/msword";
+    return mSource->getCacheKey();
+}
+
+const char *Attachment::getBase64EncodedFile() const {
+    std::string contents;
+    if (mSource != nullptr) {
+        const auto size = mSource->getSize();
+        if (size.has_value()) {
+            contents.reserve(*size);
+        }
     }
-    if (extension == "DOCX") {
-        return "application/vnd.openxmlformats-officedocument.wordprocessingml.document";
+    if (streamFile([&contents](std::string_view pBlock) {
+                contents.append(pBlock.data(), pBlock.size());
+                return 0;
+            }) != 0) {
+        return nullptr;
     }
-    if (extension == "DOTX") {
-        return "application/vnd.openxmlformats-officedocument.wordprocessingml.template";
+    std::string base64_result = Base64::Encode(reinterpret_cast<const unsigned char*>(contents.c_str()), contents.length());
+    auto *base64_file = new char[base64_result.length() + 1];
+    strncpy(base64_file, base64_result.c_str(), base64_result.length() + 1);
+    return base64_file;
+}
+
+int Attachment::streamBase64EncodedFile(const std::function<int(const std::string &pEncodedBlock)> &pWriter) const {
+    // 57 bytes of the content produce a line of 76 base64 characters. A
+    // block contains complete lines so that padding is only added at the end.
+    const size_t LINE_INPUT_LENGTH = 57;
+    const size_t LINES_PER_BLOCK = 1024;
+    const size_t BLOCK_INPUT_LENGTH = LINE_INPUT_LENGTH * LINES_PER_BLOCK;
+    const size_t ENCODED_BLOCK_MAXLENGTH = (Base64::EncodedLength(LINE_INPUT_LENGTH) + 2) * LINES_PER_BLOCK;
+    // The bytes that do not fill a block wait for the next block of the
+    // source. The blocks of a source that gives its content at once are
+    // encoded without being copied.
+    std::vector<char> pending;
+    std::string encoded_block;
+    encoded_block.reserve(ENCODED_BLOCK_MAXLENGTH);
+    bool first_line = true;
+    auto encode_block = [&](const char *pData, size_t pLength) {
+        // The capacity is kept so the block is encoded in place
+        encoded_block.resize(ENCODED_BLOCK_MAXLENGTH);
+        size_t encoded_length = 0;
+        for (size_t offset = 0; offset < pLength; offset += LINE_INPUT_LENGTH) {
+            size_t length = (std::min)(LINE_INPUT_LENGTH, pLength - offset);
+            if (!first_line) {
+                encoded_block[encoded_length++] = '\r';
+                encoded_block[encoded_length++] = '\n';
+            }
+            first_line = false;
+            encoded_length += Base64::EncodeToBuffer(reinterpret_cast<const unsigned char*>(pData + offset),
+                    length,
+                    &encoded_block[encoded_length]);
+        }
+        encoded_block.resize(encoded_length);
+        return pWriter(encoded_block);
+    };
+    int read_ret_code = streamFile([&](std::string_view pBlock) {
+        if (!pending.empty()) {
+            const size_t length = (std::min)(BLOCK_INPUT_LENGTH - pending.size(), pBlock.size());
+            pending.insert(pending.end(), pBlock.data(), pBlock.data() + length);
+            pBlock.remove_prefix(length);
+            if (pending.size() < BLOCK_INPUT_LENGTH) {
+                return 0;
+            }
+            int writer_ret_code = encode_block(pending.data(), pending.size());
+            pending.clear();
+            if (writer_ret_code != 0) {
+                return writer_ret_code;
+            }
+        }
+        while (pBlock.size() >= BLOCK_INPUT_LENGTH) {
+            int writer_ret_code = encode_block(pBlock.data(), BLOCK_INPUT_LENGTH);
+            if (writer_ret_code != 0) {
+                return writer_ret_code;
+            }
+            pBlock.remove_prefix(BLOCK_INPUT_LENGTH);
+        }
+        if (!pBlock.empty()) {
+            pending.reserve(BLOCK_INPUT_LENGTH);
+            pending.insert(pending.end(), pBlock.begin(), pBlock.end());
+        }
+        return 0;
+    });
+    if (read_ret_code != 0) {
+        return read_ret_code;
     }
-    if (extension == "XUL") {
-        return "application/vnd.mozilla.xul+xml";
+    return pending.empty() ? 0 : encode_block(pending.data(), pending.size());
+}
+
+int Attachment::streamQuotedPrintableEncodedFile(const std::function<int(const std::string &pEncodedBlock)> &pWriter) const {
+    // A source that gives its content at once is encoded by parts of the
+    // same size as a base64 block
+    const size_t BLOCK_INPUT_LENGTH = 57 * 1024;
+    QuotedPrintableEncoder encoder;
+    std::string encoded_block;
+    encoded_block.reserve(BLOCK_INPUT_LENGTH + BLOCK_INPUT_LENGTH / 4);
+    int read_ret_code = streamFile([&](std::string_view pBlock) {
+        while (!pBlock.empty()) {
+            const size_t length = (std::min)(BLOCK_INPUT_LENGTH, pBlock.size());
+            encoded_block.clear();
+            encoder.encode(pBlock.substr(0, length), encoded_block);
+            pBlock.remove_prefix(length);
+            if (!encoded_block.empty()) {
+                int writer_ret_code = pWriter(encoded_block);
+                if (writer_ret_code != 0) {
+                    return writer_ret_code;
+                }
+            }
+        }
+        return 0;
+    });
+    if (read_ret_code != 0) {
+        return read_ret_code;
+    }
+    encoded_block.clear();
+    encoder.finish(encoded_block);
+    return encoded_block.empty() ? 0 : pWriter(encoded_block);
+}
+
+int Attachment::streamFile(const std::function<int(std::string_view pBlock)> &pWriter) const {
+    if (mSource == nullptr) {
+        return -1;
     }
+    return mSource->read(pWriter);
+}
 
-    return "";
+const char *Attachment::getMimeType() const {
+    const std::string_view filename { mFilename };
+    // Without a dot the whole file name is looked up
+    return MimeTypes::find(filename.substr(filename.find_last_of('.') + 1));
 }
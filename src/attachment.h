@@ -3,9 +3,16 @@
 
 #include <cstring>
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "attachmentsource.h"
 #include "base64.h"
 
 #ifdef _WIN32
+    #pragma warning(disable: 4251)
     #ifdef SMTPCLIENT_EXPORTS
         #define ATTACHMENT_API __declspec(dllexport)
     #else
@@ -18,6 +25,9 @@
 namespace jed_utils {
 /** @brief The Attachment class represent a file attachment in a
  *  message. It can be a picture, a document, a text file etc.
+ *
+ *  The content is read from the file when the message is sent, or from an
+ *  AttachmentSource for a content generated by the application.
  */
 class ATTACHMENT_API Attachment {
  public:
@@ -29,6 +39,17 @@ class ATTACHMENT_API Attachment {
      */
     explicit Attachment(const char *pFilename, const char *pName = "");
 
+    /**
+     *  @brief  Construct a new Attachment whose content is given by a
+     *  source, for instance a BufferAttachmentSource for a content generated
+     *  in memory.
+     *  @param pSource The content of the attachment. It is shared by the
+     *  copies of the attachment.
+     *  @param pName The display name that will appear in the mail content.
+     *  Its extension gives the MIME type.
+     */
+    Attachment(std::shared_ptr<const AttachmentSource> pSource, const char *pName);
+
     /** Destructor of the Attachment */
     virtual ~Attachment();
 
@@ -47,12 +68,60 @@ class ATTACHMENT_API Attachment {
     /** Return the display name. */
     const char *getName() const;
 
-    /** Return the file name including the path. */
+    /** Return the file name including the path. For an attachment created
+     *  from a source, return the display name. */
     const char *getFilename() const;
 
-    /** Return the base64 representation of the file content. */
+    /** Return the size of the content in bytes or nothing if it is not known
+     *  before the content is read. */
+    std::optional<size_t> getSize() const;
+
+    /** Return a key that identifies the content or an empty string if the
+     *  content cannot be identified before it is read. */
+    std::string getCacheKey() const;
+
+    /**
+     *  @brief  Return the base64 representation of the file content.
+     *  @return A pointer to an allocated char array or nullptr if the file
+     *  cannot be read. The user is responsible to delete this pointer after
+     *  usage.
+     */
     const char *getBase64EncodedFile() const;
 
+    /**
+     *  @brief  Read the content by blocks and encode each block in base64
+     *  with lines of 76 characters separated by CRLF (RFC 2045). The memory
+     *  used does not depend on the size of the content.
+     *  @param pWriter The function called with each encoded block. It returns
+     *  0 to continue or an error code to stop the encoding.
+     *  @return 0 for success, -1 if the content cannot be read, otherwise the
+     *  error code returned by pWriter.
+     */
+    int streamBase64EncodedFile(const std::function<int(const std::string &pEncodedBlock)> &pWriter) const;
+
+    /**
+     *  @brief  Read the content by blocks and encode each block in
+     *  quoted-printable (RFC 2045), for a text content. The line breaks are
+     *  written as CRLF. The memory used does not depend on the size of the
+     *  content.
+     *  @param pWriter The function called with each encoded block. It returns
+     *  0 to continue or an error code to stop the encoding.
+     *  @return 0 for success, -1 if the content cannot be read, otherwise the
+     *  error code returned by pWriter.
+     */
+    int streamQuotedPrintableEncodedFile(const std::function<int(const std::string &pEncodedBlock)> &pWriter) const;
+
+    /**
+     *  @brief  Read the content by blocks without encoding, for the servers
+     *  that accept binary content (RFC 3030). The memory used does not depend
+     *  on the size of the content.
+     *  @param pWriter The function called with each block. It returns 0 to
+     *  continue or an error code to stop the reading.
+     *  @return 0 for success, -1 if the content cannot be read, otherwise the
+     *  error code returned by pWriter.
+     */
+    int streamFile(const std::function<int(std::string_view pBlock)> &pWriter) const;
+
     /** Return the MIME type corresponding to the file extension. */
     const char *getMimeType() const;
 
@@ -62,6 +131,7 @@ class ATTACHMENT_API Attachment {
     Attachment() = default;
     char *mName;
     char *mFilename;
+    std::shared_ptr<const AttachmentSource> mSource;
 };
 }  // namespace jed_utils
 
@@ -0,0 +1,78 @@
+#include "attachmentprefetcher.h"
+#include <utility>
+
+using namespace jed_utils;
+
+AttachmentPrefetcher::AttachmentPrefetcher(std::vector<Producer> pProducers, size_t pMaxBlockCount)
+    : mProducers(std::move(pProducers)),
+      mMaxBlockCount(pMaxBlockCount == 0 ? 1 : pMaxBlockCount),
+      mBlockCount(0),
+      mStopping(false) {
+    mThread = std::thread(&AttachmentPrefetcher::prepareAttachments, this);
+}
+
+AttachmentPrefetcher::~AttachmentPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mItemRemoved.notify_all();
+    mThread.join();
+}
+
+bool AttachmentPrefetcher::nextBlock(std::string &pBlock, int &pReturnCode) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mItemAdded.wait(lock, [this]() { return !mItems.empty(); });
+    Item &item = mItems.front();
+    if (item.last) {
+        pReturnCode = item.returnCode;
+        mItems.pop_front();
+        return false;
+    }
+    pBlock.swap(item.block);
+    // The previous buffer of the caller keeps its capacity for a next block
+    mSpareBlocks.push_back(std::move(item.block));
+    mItems.pop_front();
+    mBlockCount--;
+    lock.unlock();
+    mItemRemoved.notify_one();
+    return true;
+}
+
+void AttachmentPrefetcher::prepareAttachments() {
+    for (const auto &producer : mProducers) {
+        int ret_code = -1;
+        try {
+            ret_code = producer([this](std::string_view pBlock) {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mItemRemoved.wait(lock, [this]() { return mStopping || mBlockCount < mMaxBlockCount; });
+                if (mStopping) {
+                    // Any non-zero code stops the producer
+                    return -1;
+                }
+                std::string block;
+                if (!mSpareBlocks.empty()) {
+                    block = std::move(mSpareBlocks.back());
+                    mSpareBlocks.pop_back();
+                }
+                block.assign(pBlock.data(), pBlock.size());
+                mItems.push_back({ std::move(block), false, 0 });
+                mBlockCount++;
+                lock.unlock();
+                mItemAdded.notify_one();
+                return 0;
+            });
+        } catch (...) {
+            // An attachment that cannot be read entirely is reported like a
+            // read error, the exception cannot cross the thread
+            ret_code = -1;
+        }
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mStopping) {
+            return;
+        }
+        mItems.push_back({ std::string(), true, ret_code });
+        lock.unlock();
+        mItemAdded.notify_one();
+    }
+}
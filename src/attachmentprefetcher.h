@@ -0,0 +1,84 @@
+#ifndef ATTACHMENTPREFETCHER_H
+#define ATTACHMENTPREFETCHER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "attachmentsource.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define ATTACHMENTPREFETCHER_API __declspec(dllexport)
+    #else
+        #define ATTACHMENTPREFETCHER_API __declspec(dllimport)
+    #endif
+#else
+    #define ATTACHMENTPREFETCHER_API
+#endif
+
+namespace jed_utils {
+/** @brief The AttachmentPrefetcher class reads and encodes the attachments
+ *  of a message on its own thread while the sending thread writes the blocks
+ *  already prepared.
+ *
+ *  The attachments are prepared in order and their blocks are returned in
+ *  the same order as if they were read by the sending thread. The number of
+ *  blocks prepared but not yet returned is bounded, so the memory used does
+ *  not depend on the size of the attachments. The destruction stops the
+ *  preparation and waits for the thread.
+ */
+class ATTACHMENTPREFETCHER_API AttachmentPrefetcher {
+ public:
+    /** @brief A function that reads an attachment and passes its blocks to
+     *  the writer. It returns 0 for success or an error code. */
+    using Producer = std::function<int(const AttachmentBlockWriter &pWriter)>;
+
+    /**
+     *  @brief  Construct a new AttachmentPrefetcher and start the preparation.
+     *  @param pProducers The producers of the attachments, in sending order.
+     *  @param pMaxBlockCount The maximum number of blocks prepared in advance.
+     *  0 is replaced by 1.
+     */
+    AttachmentPrefetcher(std::vector<Producer> pProducers, size_t pMaxBlockCount);
+    ~AttachmentPrefetcher();
+    AttachmentPrefetcher(const AttachmentPrefetcher& other) = delete;
+    AttachmentPrefetcher& operator=(const AttachmentPrefetcher& other) = delete;
+
+    /**
+     *  @brief  Wait for the next block of the current attachment.
+     *  @param pBlock Receive the block. Its previous buffer is reused for the
+     *  next blocks.
+     *  @param pReturnCode Receive the return code of the producer when the
+     *  attachment is complete.
+     *  @return True if a block is returned, false when the attachment is
+     *  complete. The next call returns the blocks of the next attachment.
+     */
+    bool nextBlock(std::string &pBlock, int &pReturnCode);
+
+ private:
+    struct Item {
+        std::string block;
+        bool last;
+        int returnCode;
+    };
+    void prepareAttachments();
+    std::vector<Producer> mProducers;
+    size_t mMaxBlockCount;
+    std::mutex mMutex;
+    std::condition_variable mItemAdded;
+    std::condition_variable mItemRemoved;
+    std::deque<Item> mItems;
+    size_t mBlockCount;
+    std::vector<std::string> mSpareBlocks;
+    bool mStopping;
+    std::thread mThread;
+};
+}  // namespace jed_utils
+
+#endif
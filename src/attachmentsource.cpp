@@ -0,0 +1,252 @@
+#include "attachmentsource.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <iostream>
+#include <limits>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <openssl/evp.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace jed_utils;
+
+namespace {
+const size_t BLOCK_LENGTH = 65536;
+
+// The hash identifies a content whatever its origin, a collision would send
+// the content of another attachment
+std::string createContentKey(std::string_view pData) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_length = 0;
+    if (EVP_Digest(pData.data(), pData.size(), digest, &digest_length, EVP_sha256(), nullptr) != 1) {
+        return "";
+    }
+    const char HEX_DIGITS[] = "0123456789abcdef";
+    std::string retval { "sha256:" };
+    for (unsigned int index = 0; index < digest_length; index++) {
+        retval += HEX_DIGITS[digest[index] >> 4];
+        retval += HEX_DIGITS[digest[index] & 0x0F];
+    }
+    return retval;
+}
+
+// A read-only mapping of a whole file, released with the object
+class MappedFile {
+ public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile() {
+        if (mData == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(mData);
+#else
+        munmap(mData, mSize);
+#endif
+    }
+
+    // Return false if the file cannot be mapped, it can still be readable
+    bool map(const std::string &pFilename) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(pFilename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER file_size;
+        if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &file_size) ||
+                file_size.QuadPart <= 0 ||
+                static_cast<unsigned long long>(file_size.QuadPart) > (std::numeric_limits<size_t>::max)()) {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            return false;
+        }
+        // The view keeps the mapping alive once it is created
+        mData = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (mData == nullptr) {
+            return false;
+        }
+        mSize = static_cast<size_t>(file_size.QuadPart);
+        return true;
+#else
+        int fd = open(pFilename.c_str(), O_RDONLY);
+        if (fd == -1) {
+            return false;
+        }
+        struct stat file_stat {};
+        if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || file_stat.st_size <= 0) {
+            close(fd);
+            return false;
+        }
+        const auto size = static_cast<size_t>(file_stat.st_size);
+        void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping stays valid after the descriptor is closed
+        close(fd);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        madvise(data, size, MADV_SEQUENTIAL);
+        mData = data;
+        mSize = size;
+        return true;
+#endif
+    }
+
+    std::string_view getContent() const {
+        return { static_cast<const char *>(mData), mSize };
+    }
+
+ private:
+    void *mData = nullptr;
+    size_t mSize = 0;
+};
+}  // namespace
+
+std::string AttachmentSource::getCacheKey() const {
+    return "";
+}
+
+FileAttachmentSource::FileAttachmentSource(std::string pFilename, bool pMemoryMapped)
+    : mFilename(std::move(pFilename)),
+      mMemoryMapped(pMemoryMapped) {
+}
+
+int FileAttachmentSource::read(const AttachmentBlockWriter &pWriter) const {
+    if (mMemoryMapped) {
+        MappedFile mapped_file;
+        if (mapped_file.map(mFilename)) {
+            return pWriter(mapped_file.getContent());
+        }
+    }
+    return readBlocks(pWriter);
+}
+
+int FileAttachmentSource::readBlocks(const AttachmentBlockWriter &pWriter) const {
+    std::ifstream in(mFilename, std::ios::in | std::ios::binary);
+    if (!in) {
+        std::cerr << "Could not open file " << mFilename << std::endl;
+        return -1;
+    }
+    std::vector<char> block(BLOCK_LENGTH);
+    while (in) {
+        in.read(block.data(), static_cast<std::streamsize>(block.size()));
+        std::streamsize bytes_read = in.gcount();
+        if (bytes_read <= 0) {
+            break;
+        }
+        int writer_ret_code = pWriter(std::string_view(block.data(), static_cast<size_t>(bytes_read)));
+        if (writer_ret_code != 0) {
+            return writer_ret_code;
+        }
+    }
+    if (in.bad()) {
+        std::cerr << "Could not read file " << mFilename << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+std::optional<size_t> FileAttachmentSource::getSize() const {
+    std::error_code error;
+    const auto file_size = std::filesystem::file_size(mFilename, error);
+    if (error) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(file_size);
+}
+
+std::string FileAttachmentSource::getCacheKey() const {
+    std::error_code error;
+    const auto file_size = std::filesystem::file_size(mFilename, error);
+    if (error) {
+        return "";
+    }
+    const auto write_time = std::filesystem::last_write_time(mFilename, error);
+    if (error) {
+        return "";
+    }
+    return "file:" + std::to_string(write_time.time_since_epoch().count()) + ":" +
+        std::to_string(file_size) + ":" + mFilename;
+}
+
+BufferAttachmentSource::BufferAttachmentSource(std::string pData)
+    : mData(std::move(pData)) {
+}
+
+int BufferAttachmentSource::read(const AttachmentBlockWriter &pWriter) const {
+    return mData.empty() ? 0 : pWriter(mData);
+}
+
+std::optional<size_t> BufferAttachmentSource::getSize() const {
+    return mData.size();
+}
+
+std::string BufferAttachmentSource::getCacheKey() const {
+    return createContentKey(mData);
+}
+
+ViewAttachmentSource::ViewAttachmentSource(std::string_view pData)
+    : mData(pData) {
+}
+
+int ViewAttachmentSource::read(const AttachmentBlockWriter &pWriter) const {
+    return mData.empty() ? 0 : pWriter(mData);
+}
+
+std::optional<size_t> ViewAttachmentSource::getSize() const {
+    return mData.size();
+}
+
+std::string ViewAttachmentSource::getCacheKey() const {
+    return createContentKey(mData);
+}
+
+CallbackAttachmentSource::CallbackAttachmentSource(AttachmentReadCallback pCallback, std::optional<size_t> pSize)
+    : mCallback(std::move(pCallback)),
+      mSize(pSize) {
+}
+
+int CallbackAttachmentSource::read(const AttachmentBlockWriter &pWriter) const {
+    if (!mCallback) {
+        return -1;
+    }
+    std::vector<char> block(BLOCK_LENGTH);
+    for (;;) {
+        size_t bytes_read = 0;
+        if (mCallback(block.data(), block.size(), bytes_read) != 0) {
+            std::cerr << "Could not read attachment content" << std::endl;
+            return -1;
+        }
+        if (bytes_read == 0) {
+            return 0;
+        }
+        int writer_ret_code = pWriter(std::string_view(block.data(), (std::min)(bytes_read, block.size())));
+        if (writer_ret_code != 0) {
+            return writer_ret_code;
+        }
+    }
+}
+
+std::optional<size_t> CallbackAttachmentSource::getSize() const {
+    return mSize;
+}
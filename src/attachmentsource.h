@@ -0,0 +1,157 @@
+#ifndef ATTACHMENTSOURCE_H
+#define ATTACHMENTSOURCE_H
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define ATTACHMENTSOURCE_API __declspec(dllexport)
+    #else
+        #define ATTACHMENTSOURCE_API __declspec(dllimport)
+    #endif
+#else
+    #define ATTACHMENTSOURCE_API
+#endif
+
+namespace jed_utils {
+/** @brief A function that receives the blocks of an attachment. It returns 0
+ *  to continue or an error code to stop the reading. */
+using AttachmentBlockWriter = std::function<int(std::string_view pBlock)>;
+
+/** @brief The AttachmentSource class is the base class of the content of an
+ *  attachment. The content is given to the encoders by blocks, so the
+ *  attachments are encoded the same way whatever their source.
+ *
+ *  A source is shared by the copies of the attachment and can be read each
+ *  time the message is sent.
+ */
+class ATTACHMENTSOURCE_API AttachmentSource {
+ public:
+    /** Destructor of the AttachmentSource */
+    virtual ~AttachmentSource() = default;
+
+    /**
+     *  @brief  Give the content to a writer by blocks.
+     *  @param pWriter The function called with each block.
+     *  @return 0 for success, -1 if the content cannot be read, otherwise
+     *  the error code returned by pWriter.
+     */
+    virtual int read(const AttachmentBlockWriter &pWriter) const = 0;
+
+    /** Return the size of the content in bytes or nothing if it is not known
+     *  before the content is read. */
+    virtual std::optional<size_t> getSize() const = 0;
+
+    /** Return a key that identifies the content, used by the
+     *  EncodedAttachmentCache, or an empty string if the content cannot be
+     *  identified. The default implementation returns an empty string. */
+    virtual std::string getCacheKey() const;
+};
+
+/** @brief The content of a file, read when the message is sent.
+ *
+ *  The file is mapped in memory and given to the encoders as a single block,
+ *  so it is encoded directly from the page cache and the threads that send
+ *  the same file share its pages. The file must not be truncated while it is
+ *  mapped. A file that cannot be mapped, for instance an empty file or a
+ *  pipe, is read by blocks.
+ */
+class ATTACHMENTSOURCE_API FileAttachmentSource : public AttachmentSource {
+ public:
+    /**
+     *  @brief  Construct a new FileAttachmentSource.
+     *  @param pFilename The full path of the file.
+     *  @param pMemoryMapped Indicate if the file is mapped in memory or read
+     *  by blocks.
+     */
+    explicit FileAttachmentSource(std::string pFilename, bool pMemoryMapped = true);
+
+    int read(const AttachmentBlockWriter &pWriter) const override;
+    std::optional<size_t> getSize() const override;
+
+    /** Return the path, the modification time and the size of the file. */
+    std::string getCacheKey() const override;
+
+ private:
+    int readBlocks(const AttachmentBlockWriter &pWriter) const;
+
+    std::string mFilename;
+    bool mMemoryMapped;
+};
+
+/** @brief A content that is owned by the source, for instance a report
+ *  generated in memory. */
+class ATTACHMENTSOURCE_API BufferAttachmentSource : public AttachmentSource {
+ public:
+    /**
+     *  @brief  Construct a new BufferAttachmentSource.
+     *  @param pData The content. Pass it with std::move to avoid a copy.
+     */
+    explicit BufferAttachmentSource(std::string pData);
+
+    int read(const AttachmentBlockWriter &pWriter) const override;
+    std::optional<size_t> getSize() const override;
+
+    /** Return the SHA-256 hash of the content. */
+    std::string getCacheKey() const override;
+
+ private:
+    std::string mData;
+};
+
+/** @brief A content that is borrowed from the application without being
+ *  copied. The data must stay valid until the last message that contains
+ *  the attachment has been sent. */
+class ATTACHMENTSOURCE_API ViewAttachmentSource : public AttachmentSource {
+ public:
+    /**
+     *  @brief  Construct a new ViewAttachmentSource.
+     *  @param pData The content.
+     */
+    explicit ViewAttachmentSource(std::string_view pData);
+
+    int read(const AttachmentBlockWriter &pWriter) const override;
+    std::optional<size_t> getSize() const override;
+
+    /** Return the SHA-256 hash of the content. */
+    std::string getCacheKey() const override;
+
+ private:
+    std::string_view mData;
+};
+
+/** @brief A function that fills a buffer with the next bytes of a content.
+ *  It sets pBytesRead to the number of bytes written in the buffer, 0 at the
+ *  end of the content, and returns 0 for success or any other value if the
+ *  content cannot be read. */
+using AttachmentReadCallback = std::function<int(char *pBuffer, size_t pBufferSize, size_t &pBytesRead)>;
+
+/** @brief A content pulled from the application by blocks, for instance
+ *  from a stream. The callback is called until the end of the content each
+ *  time the attachment is read, so it must restart from the beginning of the
+ *  content after it has reported the end if the message can be sent again. */
+class ATTACHMENTSOURCE_API CallbackAttachmentSource : public AttachmentSource {
+ public:
+    /**
+     *  @brief  Construct a new CallbackAttachmentSource.
+     *  @param pCallback The function that gives the content.
+     *  @param pSize The size of the content if it is known. It is only used
+     *  to estimate the size of the message.
+     */
+    explicit CallbackAttachmentSource(AttachmentReadCallback pCallback, std::optional<size_t> pSize = std::nullopt);
+
+    int read(const AttachmentBlockWriter &pWriter) const override;
+    std::optional<size_t> getSize() const override;
+
+ private:
+    AttachmentReadCallback mCallback;
+    std::optional<size_t> mSize;
+};
+}  // namespace jed_utils
+
+#endif
@@ -1,13 +1,51 @@
 #ifndef BASE64UTILS_H
 #define BASE64UTILS_H
 
+#include <cstddef>
 #include <string>
 
+#ifdef _WIN32
+    #ifdef SMTPCLIENT_EXPORTS
+        #define BASE64_API __declspec(dllexport)
+    #else
+        #define BASE64_API __declspec(dllimport)
+    #endif
+#else
+    #define BASE64_API
+#endif
+
 namespace jed_utils {
-class Base64 {
+class BASE64_API Base64 {
  public:
     static std::string Encode(unsigned char const *bytes_to_encode, size_t in_len);
     static std::string Decode(std::string const &encoded_string);
+
+    /** Return the number of characters produced by the encoding of in_len bytes. */
+    static size_t EncodedLength(size_t in_len);
+
+    /**
+     *  @brief  Encode in a buffer provided by the caller.
+     *  @param bytes_to_encode The bytes to encode.
+     *  @param in_len The number of bytes to encode.
+     *  @param out The destination buffer. It must contain at least
+     *  EncodedLength(in_len) characters. No null character is added.
+     *  @return The number of characters written.
+     */
+    static size_t EncodeToBuffer(unsigned char const *bytes_to_encode, size_t in_len, char *out);
+
+    /** Return the maximum number of bytes produced by the decoding of in_len characters. */
+    static size_t DecodedMaxLength(size_t in_len);
+
+    /**
+     *  @brief  Decode in a buffer provided by the caller. The decoding stops
+     *  at the first padding or invalid character.
+     *  @param encoded The characters to decode.
+     *  @param in_len The number of characters to decode.
+     *  @param out The destination buffer. It must contain at least
+     *  DecodedMaxLength(in_len) bytes.
+     *  @return The number of bytes written.
+     */
+    static size_t DecodeToBuffer(const char *encoded, size_t in_len, unsigned char *out);
 };
 }  // namespace jed_utils
 
@@ -0,0 +1,120 @@
+#ifndef BOUNDEDMPMCQUEUE_H
+#define BOUNDEDMPMCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#ifdef _WIN32
+    // Structure padded due to the alignment of the positions
+    #pragma warning(disable: 4324)
+#endif
+
+namespace jed_utils {
+/** @brief The BoundedMpmcQueue is a fixed capacity, lock-free queue for
+ *  multiple producers and multiple consumers (D. Vyukov, "Bounded MPMC
+ *  queue").
+ *
+ *  Each cell holds a sequence number that tells the producers and the
+ *  consumers whether the cell is free for the current turn, so a push or a
+ *  pop is one compare-and-swap on the shared position in the common case.
+ *  Neither operation blocks: they fail when the queue is full or empty.
+ */
+template <typename T>
+class BoundedMpmcQueue {
+ public:
+    /**
+     *  @brief  Construct a new BoundedMpmcQueue.
+     *  @param pCapacity The maximum number of items. 0 is replaced by 1.
+     */
+    explicit BoundedMpmcQueue(size_t pCapacity)
+        : mCapacity(pCapacity == 0 ? 1 : pCapacity),
+          mCells(new Cell[mCapacity]) {
+        for (size_t index = 0; index < mCapacity; index++) {
+            mCells[index].sequence.store(index, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMpmcQueue(const BoundedMpmcQueue& other) = delete;
+    BoundedMpmcQueue& operator=(const BoundedMpmcQueue& other) = delete;
+
+    /**
+     *  @brief  Add an item at the end of the queue.
+     *  @param pValue The item. It is moved only if the push succeeds.
+     *  @return True for success, false if the queue is full.
+     */
+    bool tryPush(T &&pValue) {
+        size_t position = mEnqueuePosition.load(std::memory_order_relaxed);
+        Cell *cell = nullptr;
+        while (true) {
+            cell = &mCells[position % mCapacity];
+            const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(cell->sequence.load(std::memory_order_acquire)) -
+                static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                if (mEnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                // The consumers have not released the cell yet
+                return false;
+            } else {
+                position = mEnqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(pValue);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     *  @brief  Remove the item at the front of the queue.
+     *  @param pValue Receive the item.
+     *  @return True for success, false if the queue is empty.
+     */
+    bool tryPop(T &pValue) {
+        size_t position = mDequeuePosition.load(std::memory_order_relaxed);
+        Cell *cell = nullptr;
+        while (true) {
+            cell = &mCells[position % mCapacity];
+            const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(cell->sequence.load(std::memory_order_acquire)) -
+                static_cast<std::ptrdiff_t>(position + 1);
+            if (difference == 0) {
+                if (mDequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                // The producers have not filled the cell yet
+                return false;
+            } else {
+                position = mDequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        pValue = std::move(cell->value);
+        cell->value = T();
+        cell->sequence.store(position + mCapacity, std::memory_order_release);
+        return true;
+    }
+
+    /** Return the maximum number of items. */
+    size_t getCapacity() const {
+        return mCapacity;
+    }
+
+ private:
+    // The positions are kept on separate cache lines to avoid false sharing
+    // between the producers and the consumers
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t mCapacity;
+    std::unique_ptr<Cell[]> mCells;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mEnqueuePosition { 0 };
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mDequeuePosition { 0 };
+};
+}  // namespace jed_utils
+
+#endif
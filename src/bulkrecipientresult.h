@@ -0,0 +1,21 @@
+#ifndef BULKRECIPIENTRESULT_H
+#define BULKRECIPIENTRESULT_H
+
+#include <string>
+
+namespace jed_utils {
+/** @brief The BulkRecipientResult struct contains the outcome of the
+ *  delivery of a bulk message to one recipient.
+ */
+struct BulkRecipientResult {
+    /** 0 for success, otherwise the error code of the failed step. */
+    int ReturnCode = 0;
+    /** The enhanced status code of the server reply that determined the
+     *  result (RFC 3463) or an empty string if the server did not provide it.
+     *  Example: 2.0.0, 5.1.1
+     */
+    std::string EnhancedStatusCode;
+};
+}  // namespace jed_utils
+
+#endif
@@ -0,0 +1,11 @@
+#include "cancellationtoken.h"
+
+using namespace jed_utils;
+
+void CancellationToken::cancel() {
+    mCancelled.store(true, std::memory_order_release);
+}
+
+bool CancellationToken::isCancelled() const {
+    return mCancelled.load(std::memory_order_acquire);
+}
@@ -0,0 +1,47 @@
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <atomic>
+
+#ifdef _WIN32
+    #ifdef SMTPCLIENT_EXPORTS
+        #define CANCELLATIONTOKEN_API __declspec(dllexport)
+    #else
+        #define CANCELLATIONTOKEN_API __declspec(dllimport)
+    #endif
+#else
+    #define CANCELLATIONTOKEN_API
+#endif
+
+namespace jed_utils {
+/** @brief The CancellationToken class lets another thread interrupt the
+ *  operations of the clients that have been given the token.
+ *
+ *  A client checks the token while it waits for the server and between its
+ *  writes, so an operation in progress ends within
+ *  CancellationToken::CHECK_INTERVAL_IN_MILLISECONDS of the cancellation
+ *  with CLIENT_OPERATION_CANCELLED_ERROR. A token cannot be reset, give a
+ *  new one to the client for the next operations.
+ */
+class CANCELLATIONTOKEN_API CancellationToken {
+ public:
+    /** The longest time a client waits for the server between two checks. */
+    static constexpr unsigned int CHECK_INTERVAL_IN_MILLISECONDS = 50;
+
+    CancellationToken() = default;
+
+    CancellationToken(const CancellationToken& other) = delete;
+    CancellationToken& operator=(const CancellationToken& other) = delete;
+
+    /** Request the cancellation of the operations. It can be called from any thread. */
+    void cancel();
+
+    /** Indicate if the cancellation has been requested. */
+    bool isCancelled() const;
+
+ private:
+    std::atomic<bool> mCancelled { false };
+};
+}  // namespace jed_utils
+
+#endif
@@ -0,0 +1,88 @@
+#include "capabilitycache.h"
+#include <utility>
+#include "stringutils.h"
+
+using namespace jed_utils;
+
+bool CapabilityCache::find(const char *pServerName,
+        unsigned int pPort,
+        bool pSecure,
+        std::string_view pEhloResponse,
+        ServerCapabilities &pCapabilities) {
+    const std::string key { makeKey(pServerName, pPort, pSecure) };
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto entry = mEntries.find(key);
+    if (entry == mEntries.end() || entry->second.extensions != getExtensionLines(pEhloResponse)) {
+        mMissCount++;
+        return false;
+    }
+    mHitCount++;
+    pCapabilities = entry->second.capabilities;
+    return true;
+}
+
+bool CapabilityCache::find(const char *pServerName,
+        unsigned int pPort,
+        bool pSecure,
+        ServerCapabilities &pCapabilities) const {
+    const std::string key { makeKey(pServerName, pPort, pSecure) };
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto entry = mEntries.find(key);
+    if (entry == mEntries.end()) {
+        return false;
+    }
+    pCapabilities = entry->second.capabilities;
+    return true;
+}
+
+void CapabilityCache::insert(const char *pServerName,
+        unsigned int pPort,
+        bool pSecure,
+        std::string_view pEhloResponse,
+        const ServerCapabilities &pCapabilities) {
+    Entry entry;
+    entry.extensions = getExtensionLines(pEhloResponse);
+    entry.capabilities = pCapabilities;
+    const std::string key { makeKey(pServerName, pPort, pSecure) };
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries[key] = std::move(entry);
+}
+
+size_t CapabilityCache::getEntryCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+size_t CapabilityCache::getHitCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mHitCount;
+}
+
+size_t CapabilityCache::getMissCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMissCount;
+}
+
+void CapabilityCache::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.clear();
+}
+
+std::string CapabilityCache::makeKey(const char *pServerName, unsigned int pPort, bool pSecure) {
+    // The host names are not case sensitive
+    std::string key { StringUtils::toLower(pServerName != nullptr ? pServerName : "") };
+    key += ':';
+    key += std::to_string(pPort);
+    if (pSecure) {
+        key += "/tls";
+    }
+    return key;
+}
+
+std::string_view CapabilityCache::getExtensionLines(std::string_view pEhloResponse) {
+    const size_t greeting_end = pEhloResponse.find('\n');
+    if (greeting_end == std::string_view::npos) {
+        return std::string_view();
+    }
+    return pEhloResponse.substr(greeting_end + 1);
+}
@@ -0,0 +1,115 @@
+#ifndef CAPABILITYCACHE_H
+#define CAPABILITYCACHE_H
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include "servercapabilities.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define CAPABILITYCACHE_API __declspec(dllexport)
+    #else
+        #define CAPABILITYCACHE_API __declspec(dllimport)
+    #endif
+#else
+    #define CAPABILITYCACHE_API
+#endif
+
+namespace jed_utils {
+/** @brief The CapabilityCache keeps the capabilities advertised by each
+ *  server endpoint in its EHLO response.
+ *
+ *  The EHLO command is still sent on each new connection (RFC 5321), but a
+ *  response identical to the previous one of the endpoint is not parsed
+ *  again. The first line, which often contains the address of the client,
+ *  is not compared. The capabilities received in clear and after STARTTLS
+ *  are kept apart. The last capabilities of an endpoint are also available
+ *  before the first connection, for instance to choose a client.
+ *
+ *  The cache is thread-safe and can be shared by several clients.
+ */
+class CAPABILITYCACHE_API CapabilityCache {
+ public:
+    CapabilityCache() = default;
+
+    CapabilityCache(const CapabilityCache &) = delete;
+    CapabilityCache &operator=(const CapabilityCache &) = delete;
+
+    /**
+     *  @brief  Find the capabilities of an EHLO response already received
+     *  from the endpoint.
+     *  @param pServerName The name of the server.
+     *  @param pPort The server port number.
+     *  @param pSecure True for a response received over TLS.
+     *  @param pEhloResponse The EHLO response.
+     *  @param pCapabilities Receive the capabilities when they are found.
+     *  @return True if the endpoint has sent the same response before.
+     */
+    bool find(const char *pServerName,
+            unsigned int pPort,
+            bool pSecure,
+            std::string_view pEhloResponse,
+            ServerCapabilities &pCapabilities);
+
+    /**
+     *  @brief  Find the last capabilities received from the endpoint.
+     *  @param pServerName The name of the server.
+     *  @param pPort The server port number.
+     *  @param pSecure True for the capabilities received over TLS.
+     *  @param pCapabilities Receive the capabilities when they are found.
+     *  @return True if the endpoint has sent an EHLO response before.
+     */
+    bool find(const char *pServerName,
+            unsigned int pPort,
+            bool pSecure,
+            ServerCapabilities &pCapabilities) const;
+
+    /**
+     *  @brief  Keep the capabilities parsed from an EHLO response, in place
+     *  of the previous ones of the endpoint.
+     *  @param pServerName The name of the server.
+     *  @param pPort The server port number.
+     *  @param pSecure True for a response received over TLS.
+     *  @param pEhloResponse The EHLO response.
+     *  @param pCapabilities The capabilities parsed from the response.
+     */
+    void insert(const char *pServerName,
+            unsigned int pPort,
+            bool pSecure,
+            std::string_view pEhloResponse,
+            const ServerCapabilities &pCapabilities);
+
+    /** Return the number of endpoints kept. */
+    size_t getEntryCount() const;
+
+    /** Return the number of responses found in the cache. */
+    size_t getHitCount() const;
+
+    /** Return the number of responses that had to be parsed. */
+    size_t getMissCount() const;
+
+    /** Discard the capabilities of all the endpoints. */
+    void clear();
+
+ private:
+    struct Entry {
+        std::string extensions;
+        ServerCapabilities capabilities;
+    };
+
+    static std::string makeKey(const char *pServerName, unsigned int pPort, bool pSecure);
+    // The lines of the response after the greeting line
+    static std::string_view getExtensionLines(std::string_view pEhloResponse);
+
+    mutable std::mutex mMutex;
+    std::map<std::string, Entry> mEntries;
+    size_t mHitCount = 0;
+    size_t mMissCount = 0;
+};
+}  // namespace jed_utils
+
+#endif
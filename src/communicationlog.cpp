@@ -0,0 +1,181 @@
+#include "communicationlog.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+using namespace jed_utils;
+
+const size_t CommunicationLog::DEFAULT_CAPACITY;
+
+CommunicationLog::CommunicationLog(size_t pCapacity)
+    : mStart(0),
+      mSize(0),
+      mCapacity(pCapacity),
+      mOverwritten(false),
+      mLevel(CommunicationLogLevel::Full) {
+}
+
+CommunicationLog::CommunicationLog(CommunicationLog &&other) noexcept
+    : mBuffer(std::move(other.mBuffer)),
+      mStart(other.mStart),
+      mSize(other.mSize),
+      mCapacity(other.mCapacity),
+      mOverwritten(other.mOverwritten),
+      mLevel(other.mLevel),
+      mSink(std::move(other.mSink)) {
+    other.mBuffer.clear();
+    other.clear();
+}
+
+CommunicationLog &CommunicationLog::operator=(CommunicationLog &&other) noexcept {
+    if (this != &other) {
+        mBuffer = std::move(other.mBuffer);
+        mStart = other.mStart;
+        mSize = other.mSize;
+        mCapacity = other.mCapacity;
+        mOverwritten = other.mOverwritten;
+        mLevel = other.mLevel;
+        mSink = std::move(other.mSink);
+        other.mBuffer.clear();
+        other.clear();
+    }
+    return *this;
+}
+
+CommunicationLog CommunicationLog::createEmptyCopy() const {
+    CommunicationLog log(mCapacity);
+    log.mLevel = mLevel;
+    log.mSink = mSink;
+    return log;
+}
+
+bool CommunicationLog::isAvailable() {
+#ifdef SMTPCLIENT_NO_COMM_LOG
+    return false;
+#else
+    return true;
+#endif
+}
+
+CommunicationLogLevel CommunicationLog::getLevel() const {
+    return mLevel;
+}
+
+void CommunicationLog::setLevel(CommunicationLogLevel pLevel) {
+    mLevel = pLevel;
+}
+
+size_t CommunicationLog::getCapacity() const {
+    return mCapacity;
+}
+
+void CommunicationLog::setCapacity(size_t pCapacity) {
+    mCapacity = pCapacity;
+    mBuffer.clear();
+    mBuffer.shrink_to_fit();
+    clear();
+}
+
+void CommunicationLog::setSink(CommunicationLogSink pSink) {
+    mSink = std::move(pSink);
+}
+
+bool CommunicationLog::isEnabled(CommunicationLogLevel pLevel) const {
+    return pLevel != CommunicationLogLevel::None &&
+        static_cast<int>(pLevel) <= static_cast<int>(mLevel) &&
+        (mCapacity > 0 || mSink);
+}
+
+void CommunicationLog::add(CommunicationLogLevel pLevel, const char *pPrefix, std::initializer_list<std::string_view> pParts) {
+    if (!isEnabled(pLevel)) {
+        return;
+    }
+    if (mSink) {
+        for (const auto &part : pParts) {
+            mSink(pPrefix, part);
+        }
+    }
+    if (mCapacity == 0) {
+        return;
+    }
+    if (mBuffer.empty()) {
+        mBuffer.resize(mCapacity + 1);
+    }
+    append("\n");
+    append(pPrefix);
+    append(": ");
+    const bool escape_line_breaks = strcmp(pPrefix, "c") == 0;
+    for (const auto &part : pParts) {
+        if (escape_line_breaks) {
+            appendEscaped(part);
+        } else {
+            append(part);
+        }
+    }
+}
+
+void CommunicationLog::clear() {
+    mStart = 0;
+    mSize = 0;
+    mOverwritten = false;
+}
+
+const char *CommunicationLog::getContent() const {
+    return getContentView().data();
+}
+
+std::string_view CommunicationLog::getContentView() const {
+    if (mSize == 0) {
+        return "";
+    }
+    if (mStart + mSize > mCapacity) {
+        // Unwrap the content so that it can be returned as a single string
+        std::rotate(mBuffer.begin(), mBuffer.begin() + static_cast<std::ptrdiff_t>(mStart),
+                mBuffer.begin() + static_cast<std::ptrdiff_t>(mCapacity));
+        mStart = 0;
+    }
+    char *content = mBuffer.data() + mStart;
+    content[mSize] = '\0';
+    if (mOverwritten) {
+        // Skip the end of the line partially overwritten
+        const char *line_start = static_cast<const char *>(memchr(content, '\n', mSize));
+        if (line_start == nullptr) {
+            return std::string_view(content + mSize, 0);
+        }
+        return std::string_view(line_start, static_cast<size_t>(content + mSize - line_start));
+    }
+    return std::string_view(content, mSize);
+}
+
+void CommunicationLog::append(std::string_view pData) {
+    if (pData.size() >= mCapacity) {
+        // Only the end of the data fits in the buffer
+        memcpy(mBuffer.data(), pData.data() + pData.size() - mCapacity, mCapacity);
+        mStart = 0;
+        mSize = mCapacity;
+        mOverwritten = true;
+        return;
+    }
+    const size_t end = (mStart + mSize) % mCapacity;
+    const size_t first_length = std::min(pData.size(), mCapacity - end);
+    memcpy(mBuffer.data() + end, pData.data(), first_length);
+    memcpy(mBuffer.data(), pData.data() + first_length, pData.size() - first_length);
+    mSize += pData.size();
+    if (mSize > mCapacity) {
+        // The oldest bytes have been overwritten
+        mStart = (mStart + mSize - mCapacity) % mCapacity;
+        mSize = mCapacity;
+        mOverwritten = true;
+    }
+}
+
+void CommunicationLog::appendEscaped(std::string_view pData) {
+    size_t start = 0;
+    size_t position;
+    while ((position = pData.find("\r\n", start)) != std::string_view::npos) {
+        append(pData.substr(start, position - start));
+        append("\\r\\n");
+        start = position + 2;
+    }
+    append(pData.substr(start));
+}
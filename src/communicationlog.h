@@ -0,0 +1,134 @@
+#ifndef COMMUNICATIONLOG_H
+#define COMMUNICATIONLOG_H
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define COMMUNICATIONLOG_API __declspec(dllexport)
+    #else
+        #define COMMUNICATIONLOG_API __declspec(dllimport)
+    #endif
+#else
+    #define COMMUNICATIONLOG_API
+#endif
+
+namespace jed_utils {
+/** @brief The items recorded in the communication log. */
+enum class CommunicationLogLevel {
+    /** Nothing is recorded. */
+    None,
+    /** The commands, the server replies and the connection events. */
+    Commands,
+    /** The commands and the content of the messages: the header lines, the
+     *  body and the attachment part headers. */
+    Full
+};
+
+/** @brief A function that receives each item of the communication log: the
+ *  prefix (c for the client, s for the server) and the text as given by the
+ *  client. The content of a message may be given in several parts. */
+using CommunicationLogSink = std::function<void(const char *pPrefix, std::string_view pItem)>;
+
+/** @brief The CommunicationLog records the exchanges with the server in a
+ *  ring buffer of fixed capacity. Once the buffer is full, the oldest items
+ *  are overwritten, so adding an item never allocates and costs only the
+ *  copy of the item.
+ *
+ *  The buffer is allocated with the first item. A sink can also receive the
+ *  items as they are added, for instance to forward them to the logger of
+ *  the application.
+ */
+class COMMUNICATIONLOG_API CommunicationLog {
+ public:
+    /** The default capacity of the ring buffer in bytes. */
+    static const size_t DEFAULT_CAPACITY = 65536;
+
+    /**
+     *  @brief  Construct a new empty CommunicationLog.
+     *  @param pCapacity The capacity of the ring buffer in bytes. 0 records
+     *  nothing in the buffer, the sink still receives the items.
+     */
+    explicit CommunicationLog(size_t pCapacity = DEFAULT_CAPACITY);
+
+    /** CommunicationLog copy constructor. */
+    CommunicationLog(const CommunicationLog &other) = default;
+
+    /** CommunicationLog copy assignment operator. */
+    CommunicationLog &operator=(const CommunicationLog &other) = default;
+
+    /** CommunicationLog move constructor. The source is left empty. */
+    CommunicationLog(CommunicationLog &&other) noexcept;
+
+    /** CommunicationLog move assignment operator. The source is left empty. */
+    CommunicationLog &operator=(CommunicationLog &&other) noexcept;
+
+    /** Return an empty log with the capacity, the level and the sink of
+     *  this one. */
+    CommunicationLog createEmptyCopy() const;
+
+    /** Indicate if the clients of the library record their communication,
+     *  false when it is built with the SMTPCLIENT_ENABLE_COMM_LOG option off. */
+    static bool isAvailable();
+
+    /** Return the items recorded. Default: CommunicationLogLevel::Full */
+    CommunicationLogLevel getLevel() const;
+
+    /** Set the items recorded. */
+    void setLevel(CommunicationLogLevel pLevel);
+
+    /** Return the capacity of the ring buffer in bytes. */
+    size_t getCapacity() const;
+
+    /** Set the capacity of the ring buffer in bytes. The content is discarded. */
+    void setCapacity(size_t pCapacity);
+
+    /** Set the function that receives each item or an empty function to remove it. */
+    void setSink(CommunicationLogSink pSink);
+
+    /** Indicate if the items of a level are recorded or sent to the sink. */
+    bool isEnabled(CommunicationLogLevel pLevel) const;
+
+    /**
+     *  @brief  Add an item made of several parts.
+     *  @param pLevel The level of the item. It is ignored if it is above the
+     *  level of the log.
+     *  @param pPrefix The prefix of the item. The CRLF of the client items
+     *  (prefix c) are written as \\r\\n.
+     *  @param pParts The parts of the item.
+     */
+    void add(CommunicationLogLevel pLevel, const char *pPrefix, std::initializer_list<std::string_view> pParts);
+
+    /** Discard the content. The buffer is kept. */
+    void clear();
+
+    /** Return the content as a null terminated string. When the oldest items
+     *  have been overwritten, it starts with the first complete line. */
+    const char *getContent() const;
+
+    /** Return the content without computing its length. The view is null
+     *  terminated and remains valid until the next change of the log. */
+    std::string_view getContentView() const;
+
+ private:
+    void append(std::string_view pData);
+    void appendEscaped(std::string_view pData);
+
+    // The content starts at mStart and may wrap at the end of the buffer.
+    // The buffer has one more byte for the terminating null character.
+    mutable std::vector<char> mBuffer;
+    mutable size_t mStart;
+    size_t mSize;
+    size_t mCapacity;
+    bool mOverwritten;
+    CommunicationLogLevel mLevel;
+    CommunicationLogSink mSink;
+};
+}  // namespace jed_utils
+
+#endif
@@ -1,4 +1,5 @@
 #include "attachment.hpp"
+#include <utility>
 
 using namespace jed_utils::cpp;
 
@@ -6,6 +7,10 @@ Attachment::Attachment(const std::string &pFilename, const std::string &pName)
     : jed_utils::Attachment(pFilename.c_str(), pName.c_str()) {
 }
 
+Attachment::Attachment(std::shared_ptr<const jed_utils::AttachmentSource> pSource, const std::string &pName)
+    : jed_utils::Attachment(std::move(pSource), pName.c_str()) {
+}
+
 std::string Attachment::getName() const {
     return jed_utils::Attachment::getName();
 }
@@ -14,9 +19,30 @@ std::string Attachment::getFilename() const {
     return jed_utils::Attachment::getFilename();
 }
 
+std::optional<size_t> Attachment::getSize() const {
+    return jed_utils::Attachment::getSize();
+}
+
 std::string Attachment::getBase64EncodedFile() const {
     const char *retval = jed_utils::Attachment::getBase64EncodedFile();
-    return retval == nullptr ? "" : retval;
+    if (retval == nullptr) {
+        return "";
+    }
+    std::string encoded_file { retval };
+    delete[] retval;
+    return encoded_file;
+}
+
+int Attachment::streamBase64EncodedFile(const std::function<int(const std::string &pEncodedBlock)> &pWriter) const {
+    return jed_utils::Attachment::streamBase64EncodedFile(pWriter);
+}
+
+int Attachment::streamQuotedPrintableEncodedFile(const std::function<int(const std::string &pEncodedBlock)> &pWriter) const {
+    return jed_utils::Attachment::streamQuotedPrintableEncodedFile(pWriter);
+}
+
+int Attachment::streamFile(const std::function<int(std::string_view pBlock)> &pWriter) const {
+    return jed_utils::Attachment::streamFile(pWriter);
 }
 
 std::string Attachment::getMimeType() const {
@@ -24,7 +50,6 @@ std::string Attachment::getMimeType() const {
 }
 
 jed_utils::Attachment Attachment::toStdAttachment() const {
-    return jed_utils::Attachment(jed_utils::Attachment::getFilename(),
-                                 jed_utils::Attachment::getName());
+    return static_cast<const jed_utils::Attachment &>(*this);
 }
 
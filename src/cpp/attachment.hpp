@@ -2,11 +2,17 @@
 #define CPPATTACHMENT_H
 
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include "../attachment.h"
+#include "../attachmentsource.h"
 #include "../base64.h"
 
 #ifdef _WIN32
+    #pragma warning(disable: 4251)
     #ifdef SMTPCLIENT_EXPORTS
         #define CPP_ATTACHMENT_API __declspec(dllexport)
     #else
@@ -31,6 +37,17 @@ class CPP_ATTACHMENT_API Attachment : private jed_utils::Attachment {
      */
     explicit Attachment(const std::string &pFilename, const std::string &pName = "");
 
+    /**
+     *  @brief  Construct a new Attachment whose content is given by a
+     *  source, for instance a jed_utils::BufferAttachmentSource for a content
+     *  generated in memory.
+     *  @param pSource The content of the attachment. It is shared by the
+     *  copies of the attachment.
+     *  @param pName The display name that will appear in the mail content.
+     *  Its extension gives the MIME type.
+     */
+    Attachment(std::shared_ptr<const jed_utils::AttachmentSource> pSource, const std::string &pName);
+
     /** Destructor of the Attachment */
     ~Attachment() override = default;
 
@@ -49,12 +66,46 @@ class CPP_ATTACHMENT_API Attachment : private jed_utils::Attachment {
     /** Return the display name. */
     std::string getName() const;
 
-    /** Return the file name including the path. */
+    /** Return the file name including the path. For an attachment created
+     *  from a source, return the display name. */
     std::string getFilename() const;
 
+    /** Return the size of the content in bytes or nothing if it is not known
+     *  before the content is read. */
+    std::optional<size_t> getSize() const;
+
     /** Return the base64 representation of the file content. */
     std::string getBase64EncodedFile() const;
 
+    /**
+     *  @brief  Read the file by blocks and encode each block in base64 with
+     *  lines of 76 characters separated by CRLF (RFC 2045).
+     *  @param pWriter The function called with each encoded block. It returns
+     *  0 to continue or an error code to stop the encoding.
+     *  @return 0 for success, -1 if the file cannot be read, otherwise the
+     *  error code returned by pWriter.
+     */
+    int streamBase64EncodedFile(const std::function<int(const std::string &pEncodedBlock)> &pWriter) const;
+
+    /**
+     *  @brief  Read the file by blocks and encode each block in
+     *  quoted-printable (RFC 2045), for a text file.
+     *  @param pWriter The function called with each encoded block. It returns
+     *  0 to continue or an error code to stop the encoding.
+     *  @return 0 for success, -1 if the file cannot be read, otherwise the
+     *  error code returned by pWriter.
+     */
+    int streamQuotedPrintableEncodedFile(const std::function<int(const std::string &pEncodedBlock)> &pWriter) const;
+
+    /**
+     *  @brief  Read the file by blocks without encoding.
+     *  @param pWriter The function called with each block. It returns 0 to
+     *  continue or an error code to stop the reading.
+     *  @return 0 for success, -1 if the file cannot be read, otherwise the
+     *  error code returned by pWriter.
+     */
+    int streamFile(const std::function<int(std::string_view pBlock)> &pWriter) const;
+
     /** Return the MIME type corresponding to the file extension. */
     std::string getMimeType() const;
 
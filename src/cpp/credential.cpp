@@ -1,4 +1,5 @@
 #include "credential.hpp"
+#include <utility>
 
 using namespace jed_utils::cpp;
 
@@ -6,6 +7,10 @@ Credential::Credential(const std::string &pUsername, const std::string &pPasswor
     : jed_utils::Credential(pUsername.c_str(), pPassword.c_str()) {
 }
 
+Credential::Credential(const std::string &pUsername, std::shared_ptr<OAuth2TokenSource> pTokenSource)
+    : jed_utils::Credential(pUsername.c_str(), std::move(pTokenSource)) {
+}
+
 std::string Credential::getUsername() const {
     return jed_utils::Credential::getUsername();
 }
@@ -14,6 +19,10 @@ std::string Credential::getPassword() const {
     return jed_utils::Credential::getPassword();
 }
 
+std::shared_ptr<jed_utils::OAuth2TokenSource> Credential::getTokenSource() const {
+    return jed_utils::Credential::getTokenSource();
+}
+
 void Credential::setUsername(const std::string &pUsername) {
     jed_utils::Credential::setUsername(pUsername.c_str());
 }
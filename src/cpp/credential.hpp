@@ -11,6 +11,7 @@
     #define CPP_CREDENTIAL_API
 #endif
 
+#include <memory>
 #include <string>
 #include "../credential.h"
 
@@ -28,6 +29,14 @@ class CPP_CREDENTIAL_API Credential : private jed_utils::Credential {
      */
     Credential(const std::string &pUsername, const std::string &pPassword);
 
+    /**
+     *  @brief  Construct a new Credential that authenticates with an OAuth 2.0
+     *  access token (XOAUTH2 or OAUTHBEARER) instead of a password.
+     *  @param pUsername The user name (the email address of the account).
+     *  @param pTokenSource The source of the access tokens of the user.
+     */
+    Credential(const std::string &pUsername, std::shared_ptr<OAuth2TokenSource> pTokenSource);
+
     /** The destructor og Credential */
     ~Credential() override = default;
 
@@ -49,6 +58,9 @@ class CPP_CREDENTIAL_API Credential : private jed_utils::Credential {
     /** Return the password. */
     std::string getPassword() const;
 
+    /** Return the source of the access tokens or nullptr for a password credential. */
+    std::shared_ptr<OAuth2TokenSource> getTokenSource() const;
+
     /**
      *  @brief  Set the user name.
      *  @param pUsername A char array pointer of the user name.
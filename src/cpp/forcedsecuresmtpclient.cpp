@@ -1,6 +1,7 @@
 #include "forcedsecuresmtpclient.hpp"
 #include <string>
 #include <utility>
+#include "../errorresolver.h"
 
 using namespace jed_utils::cpp;
 
@@ -8,14 +9,16 @@ ForcedSecureSMTPClient::ForcedSecureSMTPClient(const std::string &pServerName, u
     : jed_utils::ForcedSecureSMTPClient(pServerName.c_str(), pPort) {
 }
 
-ForcedSecureSMTPClient::~ForcedSecureSMTPClient() {
-    delete mCredential;
-}
+ForcedSecureSMTPClient::~ForcedSecureSMTPClient() = default;
 
 std::string ForcedSecureSMTPClient::getServerName() const {
     return jed_utils::ForcedSecureSMTPClient::getServerName();
 }
 
+std::string_view ForcedSecureSMTPClient::getServerNameView() const {
+    return jed_utils::SMTPClientBase::getServerName();
+}
+
 unsigned int ForcedSecureSMTPClient::getServerPort() const {
     return jed_utils::ForcedSecureSMTPClient::getServerPort();
 }
@@ -24,12 +27,20 @@ unsigned int ForcedSecureSMTPClient::getCommandTimeout() const {
     return jed_utils::SMTPClientBase::getCommandTimeout();
 }
 
+unsigned int ForcedSecureSMTPClient::getCommandTimeoutInMilliseconds() const {
+    return jed_utils::SMTPClientBase::getCommandTimeoutInMilliseconds();
+}
+
 std::string ForcedSecureSMTPClient::getCommunicationLog() const {
     return jed_utils::ForcedSecureSMTPClient::getCommunicationLog();
 }
 
+std::string_view ForcedSecureSMTPClient::getCommunicationLogView() const {
+    return jed_utils::SMTPClientBase::getCommunicationLogView();
+}
+
 const Credential *ForcedSecureSMTPClient::getCredentials() const {
-    return mCredential;
+    return mCredential.get();
 }
 
 void ForcedSecureSMTPClient::setServerName(const std::string &pServerName) {
@@ -44,28 +55,190 @@ void ForcedSecureSMTPClient::setCommandTimeout(unsigned int pTimeOutInSeconds) {
     jed_utils::SMTPClientBase::setCommandTimeout(pTimeOutInSeconds);
 }
 
+void ForcedSecureSMTPClient::setCommandTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds) {
+    jed_utils::SMTPClientBase::setCommandTimeoutInMilliseconds(pTimeOutInMilliseconds);
+}
+
 void ForcedSecureSMTPClient::setCredentials(const Credential &pCredential) {
-    jed_utils::SMTPClientBase::setCredentials(jed_utils::Credential(pCredential.getUsername().c_str(),
-                                                                    pCredential.getPassword().c_str()));
-    delete mCredential;
-    mCredential = new Credential(pCredential);
+    if (pCredential.getTokenSource() != nullptr) {
+        jed_utils::SMTPClientBase::setCredentials(jed_utils::Credential(pCredential.getUsername().c_str(),
+                                                                        pCredential.getTokenSource()));
+    } else {
+        jed_utils::SMTPClientBase::setCredentials(jed_utils::Credential(pCredential.getUsername().c_str(),
+                                                                        pCredential.getPassword().c_str()));
+    }
+    mCredential = std::make_shared<const Credential>(pCredential);
 }
 
 void ForcedSecureSMTPClient::setKeepUsingBaseSendCommands(bool pValue) {
     jed_utils::SMTPClientBase::setKeepUsingBaseSendCommands(pValue);
 }
 
+const jed_utils::ServerCapabilities &ForcedSecureSMTPClient::getServerCapabilities() const {
+    return jed_utils::SMTPClientBase::getServerCapabilities();
+}
+
+bool ForcedSecureSMTPClient::isPipeliningEnabled() const {
+    return jed_utils::SMTPClientBase::isPipeliningEnabled();
+}
+
+void ForcedSecureSMTPClient::setPipeliningEnabled(bool pValue) {
+    jed_utils::SMTPClientBase::setPipeliningEnabled(pValue);
+}
+
+bool ForcedSecureSMTPClient::isChunkingEnabled() const {
+    return jed_utils::SMTPClientBase::isChunkingEnabled();
+}
+
+void ForcedSecureSMTPClient::setChunkingEnabled(bool pValue) {
+    jed_utils::SMTPClientBase::setChunkingEnabled(pValue);
+}
+
+bool ForcedSecureSMTPClient::isTextAttachmentEncodingEnabled() const {
+    return jed_utils::SMTPClientBase::isTextAttachmentEncodingEnabled();
+}
+
+void ForcedSecureSMTPClient::setTextAttachmentEncodingEnabled(bool pValue) {
+    jed_utils::SMTPClientBase::setTextAttachmentEncodingEnabled(pValue);
+}
+
+size_t ForcedSecureSMTPClient::getDataWriteSize() const {
+    return jed_utils::SMTPClientBase::getDataWriteSize();
+}
+
+void ForcedSecureSMTPClient::setDataWriteSize(size_t pWriteSize) {
+    jed_utils::SMTPClientBase::setDataWriteSize(pWriteSize);
+}
+
+const jed_utils::TransportOptions &ForcedSecureSMTPClient::getTransportOptions() const {
+    return jed_utils::SMTPClientBase::getTransportOptions();
+}
+
+void ForcedSecureSMTPClient::setTransportOptions(const jed_utils::TransportOptions &pOptions) {
+    jed_utils::SMTPClientBase::setTransportOptions(pOptions);
+}
+
+const jed_utils::DsnOptions &ForcedSecureSMTPClient::getDsnOptions() const {
+    return jed_utils::SMTPClientBase::getDsnOptions();
+}
+
+void ForcedSecureSMTPClient::setDsnOptions(const jed_utils::DsnOptions &pOptions) {
+    jed_utils::SMTPClientBase::setDsnOptions(pOptions);
+}
+
+unsigned int ForcedSecureSMTPClient::getOperationTimeoutInMilliseconds() const {
+    return jed_utils::SMTPClientBase::getOperationTimeoutInMilliseconds();
+}
+
+void ForcedSecureSMTPClient::setOperationTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds) {
+    jed_utils::SMTPClientBase::setOperationTimeoutInMilliseconds(pTimeOutInMilliseconds);
+}
+
+std::shared_ptr<jed_utils::CancellationToken> ForcedSecureSMTPClient::getCancellationToken() const {
+    return jed_utils::SMTPClientBase::getCancellationToken();
+}
+
+void ForcedSecureSMTPClient::setCancellationToken(std::shared_ptr<jed_utils::CancellationToken> pToken) {
+    jed_utils::SMTPClientBase::setCancellationToken(std::move(pToken));
+}
+
+size_t ForcedSecureSMTPClient::getAttachmentPrefetchBlockCount() const {
+    return jed_utils::SMTPClientBase::getAttachmentPrefetchBlockCount();
+}
+
+void ForcedSecureSMTPClient::setAttachmentPrefetchBlockCount(size_t pBlockCount) {
+    jed_utils::SMTPClientBase::setAttachmentPrefetchBlockCount(pBlockCount);
+}
+
+jed_utils::CommunicationLogLevel ForcedSecureSMTPClient::getCommunicationLogLevel() const {
+    return jed_utils::SMTPClientBase::getCommunicationLogLevel();
+}
+
+void ForcedSecureSMTPClient::setCommunicationLogLevel(jed_utils::CommunicationLogLevel pLevel) {
+    jed_utils::SMTPClientBase::setCommunicationLogLevel(pLevel);
+}
+
+size_t ForcedSecureSMTPClient::getCommunicationLogCapacity() const {
+    return jed_utils::SMTPClientBase::getCommunicationLogCapacity();
+}
+
+void ForcedSecureSMTPClient::setCommunicationLogCapacity(size_t pCapacity) {
+    jed_utils::SMTPClientBase::setCommunicationLogCapacity(pCapacity);
+}
+
+void ForcedSecureSMTPClient::setCommunicationLogSink(jed_utils::CommunicationLogSink pSink) {
+    jed_utils::SMTPClientBase::setCommunicationLogSink(std::move(pSink));
+}
+
+std::shared_ptr<jed_utils::EncodedAttachmentCache> ForcedSecureSMTPClient::getEncodedAttachmentCache() const {
+    return jed_utils::SMTPClientBase::getEncodedAttachmentCache();
+}
+
+void ForcedSecureSMTPClient::setEncodedAttachmentCache(std::shared_ptr<jed_utils::EncodedAttachmentCache> pCache) {
+    jed_utils::SMTPClientBase::setEncodedAttachmentCache(std::move(pCache));
+}
+
+std::shared_ptr<jed_utils::CapabilityCache> ForcedSecureSMTPClient::getCapabilityCache() const {
+    return jed_utils::SMTPClientBase::getCapabilityCache();
+}
+
+void ForcedSecureSMTPClient::setCapabilityCache(std::shared_ptr<jed_utils::CapabilityCache> pCache) {
+    jed_utils::SMTPClientBase::setCapabilityCache(std::move(pCache));
+}
+
+std::shared_ptr<const jed_utils::DkimSigner> ForcedSecureSMTPClient::getDkimSigner() const {
+    return jed_utils::SMTPClientBase::getDkimSigner();
+}
+
+void ForcedSecureSMTPClient::setDkimSigner(std::shared_ptr<const jed_utils::DkimSigner> pSigner) {
+    jed_utils::SMTPClientBase::setDkimSigner(std::move(pSigner));
+}
+
+std::shared_ptr<jed_utils::SessionObserver> ForcedSecureSMTPClient::getSessionObserver() const {
+    return jed_utils::SMTPClientBase::getSessionObserver();
+}
+
+void ForcedSecureSMTPClient::setSessionObserver(std::shared_ptr<jed_utils::SessionObserver> pObserver) {
+    jed_utils::SMTPClientBase::setSessionObserver(std::move(pObserver));
+}
+
+std::shared_ptr<const jed_utils::SessionTrace> ForcedSecureSMTPClient::getSessionTrace() const {
+    return jed_utils::SMTPClientBase::getSessionTrace();
+}
+
+void ForcedSecureSMTPClient::setSessionTraceCapacity(size_t pCapacity) {
+    jed_utils::SMTPClientBase::setSessionTraceCapacity(pCapacity);
+}
+
+std::shared_ptr<jed_utils::Transport> ForcedSecureSMTPClient::getTransport() const {
+    return jed_utils::SMTPClientBase::getTransport();
+}
+
+void ForcedSecureSMTPClient::setTransport(std::shared_ptr<jed_utils::Transport> pTransport) {
+    jed_utils::SMTPClientBase::setTransport(std::move(pTransport));
+}
+
+const jed_utils::IoCounters &ForcedSecureSMTPClient::getIoCounters() const {
+    return jed_utils::SMTPClientBase::getIoCounters();
+}
+
+std::shared_ptr<jed_utils::TlsContext> ForcedSecureSMTPClient::getTlsContext() const {
+    return jed_utils::SecureSMTPClientBase::getTlsContext();
+}
+
+void ForcedSecureSMTPClient::setTlsContext(std::shared_ptr<jed_utils::TlsContext> pTlsContext) {
+    jed_utils::SecureSMTPClientBase::setTlsContext(std::move(pTlsContext));
+}
+
 std::string ForcedSecureSMTPClient::getErrorMessage(int errorCode) {
-    return jed_utils::SMTPClientBase::getErrorMessage(errorCode);
+    return std::string(jed_utils::ErrorResolver::findErrorMessage(errorCode));
 }
 
 int ForcedSecureSMTPClient::getErrorMessage_r(int errorCode,
                                   std::string &errorMessage) {
-    const size_t MAXSIZE = 1024;
-    char *errorMsg = new char[MAXSIZE];
-    int result = jed_utils::SMTPClientBase::getErrorMessage_r(errorCode, errorMsg, MAXSIZE);
-    errorMessage = errorMsg;
-    return result;
+    // The messages are static, the string is the only copy made
+    errorMessage = jed_utils::ErrorResolver::findErrorMessage(errorCode);
+    return 0;
 }
 
 int ForcedSecureSMTPClient::extractReturnCode(const std::string &pOutput) {
@@ -76,6 +249,46 @@ jed_utils::ServerAuthOptions *ForcedSecureSMTPClient::extractAuthenticationOptio
     return jed_utils::SMTPClientBase::extractAuthenticationOptions(pEhloOutput.c_str());
 }
 
+jed_utils::ServerCapabilities ForcedSecureSMTPClient::extractServerCapabilities(const std::string &pEhloOutput) {
+    return jed_utils::SMTPClientBase::extractServerCapabilities(pEhloOutput.c_str());
+}
+
+int ForcedSecureSMTPClient::connect() {
+    return jed_utils::SMTPClientBase::connect();
+}
+
+int ForcedSecureSMTPClient::disconnect() {
+    return jed_utils::SMTPClientBase::disconnect();
+}
+
+bool ForcedSecureSMTPClient::isConnected() const {
+    return jed_utils::SMTPClientBase::isConnected();
+}
+
+int ForcedSecureSMTPClient::prepare() {
+    return jed_utils::SMTPClientBase::prepare();
+}
+
+std::vector<jed_utils::BulkRecipientResult> ForcedSecureSMTPClient::sendBulk(const jed_utils::Message &pTemplate,
+        const std::vector<jed_utils::MessageAddress> &pRecipients) {
+    return jed_utils::SMTPClientBase::sendBulk(pTemplate, pRecipients.data(), pRecipients.size());
+}
+
+std::vector<jed_utils::BulkRecipientResult> ForcedSecureSMTPClient::sendBulk(const std::string &pSenderAddress,
+        const jed_utils::MessageTemplate &pTemplate,
+        const std::vector<jed_utils::MergeRecipient> &pRecipients) {
+    return jed_utils::SMTPClientBase::sendBulk(pSenderAddress.c_str(), pTemplate, pRecipients.data(), pRecipients.size());
+}
+
+jed_utils::SendResult ForcedSecureSMTPClient::getLastSendResult() const {
+    return jed_utils::SMTPClientBase::getLastSendResult();
+}
+
 int ForcedSecureSMTPClient::sendMail(const jed_utils::Message &pMsg) {
     return jed_utils::ForcedSecureSMTPClient::sendMail(pMsg);
 }
+
+int ForcedSecureSMTPClient::sendMail(const jed_utils::Message &pMsg,
+        const std::vector<jed_utils::MessageAddress> &pEnvelopeRecipients) {
+    return jed_utils::SMTPClientBase::sendMail(pMsg, pEnvelopeRecipients.data(), pEnvelopeRecipients.size());
+}
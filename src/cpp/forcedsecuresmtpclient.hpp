@@ -1,8 +1,17 @@
 #ifndef CPPFORCEDSECURESMTPCLIENT_H
 #define CPPFORCEDSECURESMTPCLIENT_H
 
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "credential.hpp"
+#include "../bulkrecipientresult.h"
+#include "../cancellationtoken.h"
+#include "../dsnoptions.h"
+#include "../messagetemplate.h"
 #include "../forcedsecuresmtpclient.h"
+#include "../sendresult.h"
 
 #ifdef _WIN32
     #ifdef SMTPCLIENT_EXPORTS
@@ -49,15 +58,26 @@ class CPP_FORCEDSECURESMTPCLIENT_API ForcedSecureSMTPClient : private jed_utils:
     /** Return the server name. */
     std::string getServerName() const;
 
+    /** Return the server name without copying it. The view remains valid
+     *  until the server name is changed. */
+    std::string_view getServerNameView() const;
+
     /** Return the server port number. */
     unsigned int getServerPort() const;
 
     /** Return the command timeout in seconds. */
     unsigned int getCommandTimeout() const;
 
+    /** Return the command timeout in milliseconds. */
+    unsigned int getCommandTimeoutInMilliseconds() const;
+
     /** Return the communication log produced by the sendMail method. */
     std::string getCommunicationLog() const;
 
+    /** Return the communication log without copying it. The view remains
+     *  valid until the next command of the client. */
+    std::string_view getCommunicationLogView() const;
+
     /** Return the credentials configured. */
     const Credential *getCredentials() const;
 
@@ -78,10 +98,17 @@ class CPP_FORCEDSECURESMTPCLIENT_API ForcedSecureSMTPClient : private jed_utils:
     /**
      *  @brief  Set the command timeout in seconds.
      *  @param pTimeOutInSeconds The timeout in seconds.
-     *  Default: 3 seconds
+     *  Default: 5 seconds
      */
     void setCommandTimeout(unsigned int pTimeOutInSeconds);
 
+    /**
+     *  @brief  Set the command timeout in milliseconds.
+     *  @param pTimeOutInMilliseconds The timeout in milliseconds.
+     *  Default: 5000 milliseconds
+     */
+    void setCommandTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds);
+
     /**
      *  @brief  Set the credentials.
      *  @param pCredential The credential containing the username and the password.
@@ -99,6 +126,220 @@ class CPP_FORCEDSECURESMTPCLIENT_API ForcedSecureSMTPClient : private jed_utils:
      */
     void setKeepUsingBaseSendCommands(bool pValue);
 
+    /** Return the ESMTP extensions advertised by the server in its last EHLO response. */
+    const jed_utils::ServerCapabilities &getServerCapabilities() const;
+
+    /** Indicate if the commands are pipelined when the server supports PIPELINING. */
+    bool isPipeliningEnabled() const;
+
+    /**
+     *  @brief  Indicate if the MAIL FROM and RCPT TO commands are sent in a
+     *  single write when the server advertises the PIPELINING extension.
+     *  @param pValue True to pipeline the commands (default), false otherwise.
+     */
+    void setPipeliningEnabled(bool pValue);
+
+    /** Indicate if the content is sent with BDAT when the server supports CHUNKING. */
+    bool isChunkingEnabled() const;
+
+    /**
+     *  @brief  Indicate if the content is sent with BDAT chunks when the
+     *  server advertises the CHUNKING extension (RFC 3030).
+     *  @param pValue True to use BDAT (default), false to always use DATA.
+     */
+    void setChunkingEnabled(bool pValue);
+
+    /** Indicate if the encoding of the text attachments is chosen from their content. */
+    bool isTextAttachmentEncodingEnabled() const;
+
+    /**
+     *  @brief  Indicate if the attachments of a text type are sent in 7bit or
+     *  in quoted-printable when it is smaller than base64.
+     *  @param pValue True to choose the encoding from the content, false to
+     *  send all the attachments in base64 (default).
+     */
+    void setTextAttachmentEncodingEnabled(bool pValue);
+
+    /** Return the maximum number of bytes passed to a single write of the message data. */
+    size_t getDataWriteSize() const;
+
+    /**
+     *  @brief  Set the maximum number of bytes passed to a single socket or
+     *  TLS write when the message body and the attachments are sent.
+     *  @param pWriteSize The write size in bytes (minimum 512).
+     *  Default: 65536 bytes
+     */
+    void setDataWriteSize(size_t pWriteSize);
+
+    /** Return the buffer sizes and the socket options of the connections. */
+    const jed_utils::TransportOptions &getTransportOptions() const;
+
+    /**
+     *  @brief  Set the buffer sizes and the socket options of the
+     *  connections. They apply from the next connection.
+     *  @param pOptions The options. The buffer sizes lower than 512 are
+     *  replaced by 512.
+     */
+    void setTransportOptions(const jed_utils::TransportOptions &pOptions);
+
+    /** Return the delivery status notifications requested. */
+    const jed_utils::DsnOptions &getDsnOptions() const;
+
+    /**
+     *  @brief  Set the delivery status notifications requested to the
+     *  servers that advertise DSN (RFC 3461).
+     *  @param pOptions The notifications.
+     *  Default: no parameter
+     */
+    void setDsnOptions(const jed_utils::DsnOptions &pOptions);
+
+    /** Return the maximum duration of an operation in milliseconds, 0 if
+     *  only the command timeout applies. */
+    unsigned int getOperationTimeoutInMilliseconds() const;
+
+    /**
+     *  @brief  Set the maximum duration of each operation, a sendMail call
+     *  including its connection for example. The operation then fails with
+     *  CLIENT_OPERATION_DEADLINE_EXCEEDED_ERROR.
+     *  @param pTimeOutInMilliseconds The timeout in milliseconds or 0 to
+     *  only apply the command timeout to each reply.
+     *  Default: 0
+     */
+    void setOperationTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds);
+
+    /** Return the token that cancels the operations or nullptr if there is none. */
+    std::shared_ptr<jed_utils::CancellationToken> getCancellationToken() const;
+
+    /**
+     *  @brief  Set the token that another thread triggers to interrupt the
+     *  operations, which then fail with CLIENT_OPERATION_CANCELLED_ERROR.
+     *  @param pToken The token or nullptr.
+     *  Default: nullptr
+     */
+    void setCancellationToken(std::shared_ptr<jed_utils::CancellationToken> pToken);
+
+    /** Return the maximum number of attachment blocks prepared in advance. */
+    size_t getAttachmentPrefetchBlockCount() const;
+
+    /**
+     *  @brief  Set the maximum number of attachment blocks prepared in
+     *  advance when a message has several attachments.
+     *  @param pBlockCount The number of blocks or 0 to read and encode the
+     *  attachments on the sending thread.
+     *  Default: 4
+     */
+    void setAttachmentPrefetchBlockCount(size_t pBlockCount);
+
+    /** Return the items recorded in the communication log. */
+    jed_utils::CommunicationLogLevel getCommunicationLogLevel() const;
+
+    /**
+     *  @brief  Set the items recorded in the communication log.
+     *  @param pLevel Full (default), Commands or None.
+     */
+    void setCommunicationLogLevel(jed_utils::CommunicationLogLevel pLevel);
+
+    /** Return the capacity of the communication log in bytes. */
+    size_t getCommunicationLogCapacity() const;
+
+    /**
+     *  @brief  Set the capacity of the communication log. Once it is full,
+     *  the oldest items are overwritten.
+     *  @param pCapacity The capacity in bytes.
+     *  Default: 65536 bytes
+     */
+    void setCommunicationLogCapacity(size_t pCapacity);
+
+    /** Set a function that receives each item of the communication log as it is added. */
+    void setCommunicationLogSink(jed_utils::CommunicationLogSink pSink);
+
+    /** Return the cache of the encoded attachments or nullptr if there is none. */
+    std::shared_ptr<jed_utils::EncodedAttachmentCache> getEncodedAttachmentCache() const;
+
+    /**
+     *  @brief  Set the cache of the encoded attachments. The attachments
+     *  sent in base64 are then encoded once for all the messages and the
+     *  clients that share the cache.
+     *  @param pCache The cache or nullptr to encode the attachments each time.
+     *  Default: nullptr
+     */
+    void setEncodedAttachmentCache(std::shared_ptr<jed_utils::EncodedAttachmentCache> pCache);
+
+    /** Return the cache of the server capabilities or nullptr if there is none. */
+    std::shared_ptr<jed_utils::CapabilityCache> getCapabilityCache() const;
+
+    /**
+     *  @brief  Set the cache of the server capabilities. An EHLO response
+     *  identical to the previous one of the server is then not parsed again.
+     *  @param pCache The cache or nullptr to parse each EHLO response.
+     *  Default: nullptr
+     */
+    void setCapabilityCache(std::shared_ptr<jed_utils::CapabilityCache> pCache);
+
+    /** Return the DKIM signer of the messages or nullptr if they are not signed. */
+    std::shared_ptr<const jed_utils::DkimSigner> getDkimSigner() const;
+
+    /**
+     *  @brief  Set the signer that adds a DKIM-Signature header field to the
+     *  messages (RFC 6376). The body is hashed before it is sent, so the
+     *  attachments are read twice.
+     *  @param pSigner The signer or nullptr to send the messages unsigned.
+     *  Default: nullptr
+     */
+    void setDkimSigner(std::shared_ptr<const jed_utils::DkimSigner> pSigner);
+
+    /** Return the observer of the session phases or nullptr if there is none. */
+    std::shared_ptr<jed_utils::SessionObserver> getSessionObserver() const;
+
+    /**
+     *  @brief  Set the observer that receives the duration and the data
+     *  exchanged of each phase of the sessions: connection, greeting, EHLO,
+     *  STARTTLS, authentication, envelope, headers and body.
+     *  @param pObserver The observer or nullptr to measure nothing.
+     *  Default: nullptr
+     */
+    void setSessionObserver(std::shared_ptr<jed_utils::SessionObserver> pObserver);
+
+    /** Return the trace of the last protocol events of the sessions or
+     *  nullptr if they are not traced. */
+    std::shared_ptr<const jed_utils::SessionTrace> getSessionTrace() const;
+
+    /**
+     *  @brief  Keep the last protocol events of the sessions in a ring of
+     *  fixed capacity, for instance to dump them when sendMail fails.
+     *  @param pCapacity The number of events kept or 0 to trace nothing.
+     *  Default: 0
+     */
+    void setSessionTraceCapacity(size_t pCapacity);
+
+    /** Return the transport of the sessions or nullptr if the client connects
+     *  its own socket. */
+    std::shared_ptr<jed_utils::Transport> getTransport() const;
+
+    /**
+     *  @brief  Set the transport through which the sessions exchange data
+     *  with the server. The transport is opened when a session starts and
+     *  closed when it ends.
+     *  @param pTransport The transport or nullptr to connect a socket.
+     *  Default: nullptr
+     */
+    void setTransport(std::shared_ptr<jed_utils::Transport> pTransport);
+
+    /** Return the data exchanged with the servers and the calls made to the
+     *  socket since the client was created. */
+    const jed_utils::IoCounters &getIoCounters() const;
+
+    /** Return the TLS context set with setTlsContext or nullptr if the
+     *  process-wide default context is used. */
+    std::shared_ptr<jed_utils::TlsContext> getTlsContext() const;
+
+    /**
+     *  @brief  Set the TLS context used by the next TLS negotiations. The
+     *  context can be shared with other clients.
+     *  @param pTlsContext The context or nullptr to use TlsContext::getDefault().
+     */
+    void setTlsContext(std::shared_ptr<jed_utils::TlsContext> pTlsContext);
+
     /**
      *  @brief  Retreive the error message string that correspond to
      *  the error code provided.
@@ -121,14 +362,88 @@ class CPP_FORCEDSECURESMTPCLIENT_API ForcedSecureSMTPClient : private jed_utils:
     static int getErrorMessage_r(int errorCode,
                                  std::string &errorMessage);
 
+    /**
+     *  @brief  Open a persistent session with the server.
+     *
+     *  The following calls to sendMail will reuse the session until
+     *  disconnect is called.
+     *  @return 0 for success, otherwise the error code of the failed step.
+     */
+    int connect();
+
+    /**
+     *  @brief  Close the persistent session opened by connect.
+     *  @return 0 for success, otherwise CLIENT_SENDMAIL_QUIT_ERROR.
+     */
+    int disconnect();
+
+    /** Indicate if a persistent session is currently opened with the server. */
+    bool isConnected() const;
+
+    /**
+     *  @brief  Prepare a persistent session ahead of the first message.
+     *
+     *  The session is opened as by connect. When it is already opened, a
+     *  NOOP command keeps it alive and a session dropped by the server is
+     *  opened again.
+     *  @return 0 for success, otherwise the error code of the failed step.
+     */
+    int prepare();
+
     int sendMail(const jed_utils::Message &pMsg);
 
+    /**
+     *  @brief  Send a message to a subset of its recipients. The From, To
+     *  and Cc headers of the message are kept unchanged.
+     *  @param pMsg The message to send.
+     *  @param pEnvelopeRecipients The recipients of the envelope.
+     *  @return 0 for success, otherwise the error code of the failed step.
+     */
+    int sendMail(const jed_utils::Message &pMsg,
+            const std::vector<jed_utils::MessageAddress> &pEnvelopeRecipients);
+
+    /**
+     *  @brief  Send the same message to each recipient in its own mail
+     *  transaction over a single session. A rejected recipient does not
+     *  stop the batch.
+     *  @param pTemplate The message to send. Its To, Cc and Bcc recipients
+     *  are ignored.
+     *  @param pRecipients The recipients.
+     *  @return The result of each recipient, in the order of the vector.
+     */
+    std::vector<jed_utils::BulkRecipientResult> sendBulk(const jed_utils::Message &pTemplate,
+            const std::vector<jed_utils::MessageAddress> &pRecipients);
+
+    /**
+     *  @brief  Send a message template to each recipient of a mail merge in
+     *  its own mail transaction over a single session. A recipient with a
+     *  missing merge field fails with CLIENT_TEMPLATE_FIELD_ERROR.
+     *  @param pSenderAddress The email address of the envelope sender.
+     *  @param pTemplate The message template.
+     *  @param pRecipients The recipients and their merge fields.
+     *  @return The result of each recipient, in the order of the vector.
+     */
+    std::vector<jed_utils::BulkRecipientResult> sendBulk(const std::string &pSenderAddress,
+            const jed_utils::MessageTemplate &pTemplate,
+            const std::vector<jed_utils::MergeRecipient> &pRecipients);
+
+    /**
+     *  @brief  Retreive the outcome of the last sendMail or sendRenderedMail
+     *  call without any allocation.
+     *  @return The return code, its category and message, the phase that
+     *  failed and the last reply of the server. The views remain valid until
+     *  the next command sent by the client.
+     */
+    jed_utils::SendResult getLastSendResult() const;
+
  protected:
     static int extractReturnCode(const std::string &pOutput);
     static jed_utils::ServerAuthOptions *extractAuthenticationOptions(const std::string &pEhloOutput);
+    static jed_utils::ServerCapabilities extractServerCapabilities(const std::string &pEhloOutput);
 
  private:
-    Credential* mCredential = nullptr;
+    // Shared with the copies of the client, a credential is never modified
+    std::shared_ptr<const Credential> mCredential;
 };
 }  // namespace cpp
 }  // namespace jed_utils
@@ -1,47 +1,34 @@
 #include "htmlmessage.hpp"
 #include <algorithm>
 #include <iterator>
+#include <utility>
 #include <vector>
 #include "message.hpp"
 #include "../messageaddress.h"
 
 using namespace jed_utils::cpp;
 
-HTMLMessage::HTMLMessage(const MessageAddress &pFrom,
-                 const std::vector<MessageAddress> &pTo,
-                 const std::string &pSubject,
-                 const std::string &pBody,
-                 const std::vector<MessageAddress> &pCc,
-                 const std::vector<MessageAddress> &pBcc,
-                 const std::vector<Attachment> &pAttachments)
-    : Message(pFrom,
-              pTo,
-              pSubject,
-              pBody,
-              pCc,
-              pBcc,
-              pAttachments) {
+HTMLMessage::HTMLMessage(MessageAddress pFrom,
+                 std::vector<MessageAddress> pTo,
+                 std::string pSubject,
+                 std::string pBody,
+                 std::vector<MessageAddress> pCc,
+                 std::vector<MessageAddress> pBcc,
+                 std::vector<Attachment> pAttachments)
+    : Message(std::move(pFrom),
+              std::move(pTo),
+              std::move(pSubject),
+              std::move(pBody),
+              std::move(pCc),
+              std::move(pBcc),
+              std::move(pAttachments)),
+      mStdMessage(createStdMessage<jed_utils::HTMLMessage>()) {
 }
 
 std::string HTMLMessage::getMimeType() const {
     return "text/html";
 }
 
-HTMLMessage::operator jed_utils::HTMLMessage() const {
-    const auto to = getStdMessageAddressVec(getTo());
-    const auto cc = getStdMessageAddressVec(getCc());
-    const auto bcc = getStdMessageAddressVec(getBcc());
-    const auto att = getStdAttachmentVec(getAttachments());
-    const jed_utils::HTMLMessage msg (getFrom().toStdMessageAddress(),
-                                  to.data(),
-                                  to.size(),
-                                  getSubject().c_str(),
-                                  getBody().c_str(),
-                                  cc.data(),
-                                  cc.size(),
-                                  bcc.data(),
-                                  bcc.size(),
-                                  att.data(),
-                                  att.size());
-    return msg;
+HTMLMessage::operator const jed_utils::HTMLMessage &() const {
+    return *mStdMessage;
 }
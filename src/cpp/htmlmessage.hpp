@@ -1,6 +1,7 @@
 #ifndef CPPHTMLMESSAGE_H
 #define CPPHTMLMESSAGE_H
 
+#include <memory>
 #include <string>
 #include <vector>
 #include "attachment.hpp"
@@ -9,6 +10,7 @@
 #include "messageaddress.hpp"
 
 #ifdef _WIN32
+    #pragma warning(disable: 4251)
     #ifdef SMTPCLIENT_EXPORTS
         #define CPP_HTMLMESSAGE_API __declspec(dllexport)
     #else
@@ -32,14 +34,17 @@ class CPP_HTMLMESSAGE_API HTMLMessage : public Message {
      *  @param pCc The carbon-copy recipient email addresses.
      *  @param pBcc The blind carbon-copy recipient email addresses.
      *  @param pAttachments The attachments of the message
+     *
+     *  The parameters are taken by value, pass them with std::move to
+     *  avoid copying a large body or recipient list.
      */
-    HTMLMessage(const MessageAddress &pFrom,
-            const std::vector<MessageAddress> &pTo,
-            const std::string &pSubject,
-            const std::string &pBody,
-            const std::vector<MessageAddress> &pCc = {},
-            const std::vector<MessageAddress> &pBcc = {},
-            const std::vector<Attachment> &pAttachments = {});
+    HTMLMessage(MessageAddress pFrom,
+            std::vector<MessageAddress> pTo,
+            std::string pSubject,
+            std::string pBody,
+            std::vector<MessageAddress> pCc = {},
+            std::vector<MessageAddress> pBcc = {},
+            std::vector<Attachment> pAttachments = {});
 
     /** The destructor of the Message */
     virtual ~HTMLMessage() = default;
@@ -47,7 +52,13 @@ class CPP_HTMLMESSAGE_API HTMLMessage : public Message {
     /** Return the string MIME type of the message (Pure virtual function). */
     std::string getMimeType() const override;
 
-    operator jed_utils::HTMLMessage() const;
+    /** Return the jed_utils counterpart of the message. It is built once
+     *  when the message is constructed, so passing the message to sendMail
+     *  does not copy it. */
+    operator const jed_utils::HTMLMessage &() const;
+
+ private:
+    std::shared_ptr<const jed_utils::HTMLMessage> mStdMessage;
 };
 }  // namespace cpp
 }  // namespace jed_utils
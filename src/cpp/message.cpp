@@ -1,25 +1,27 @@
 #include "message.hpp"
 #include <algorithm>
+#include <initializer_list>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 using namespace jed_utils::cpp;
 
-Message::Message(const MessageAddress &pFrom,
-                 const std::vector<MessageAddress> &pTo,
-                 const std::string &pSubject,
-                 const std::string &pBody,
-                 const std::vector<MessageAddress> &pCc,
-                 const std::vector<MessageAddress> &pBcc,
-                 const std::vector<Attachment> &pAttachments)
-    : mFrom(pFrom),
-      mTo(pTo),
-      mSubject(pSubject),
-      mBody(pBody),
-      mCc(pCc),
-      mBcc(pBcc),
-      mAttachments(pAttachments) {
-    if (pTo.empty()) {
+Message::Message(MessageAddress pFrom,
+                 std::vector<MessageAddress> pTo,
+                 std::string pSubject,
+                 std::string pBody,
+                 std::vector<MessageAddress> pCc,
+                 std::vector<MessageAddress> pBcc,
+                 std::vector<Attachment> pAttachments)
+    : mFrom(std::move(pFrom)),
+      mTo(std::move(pTo)),
+      mSubject(std::move(pSubject)),
+      mBody(std::make_shared<const std::string>(std::move(pBody))),
+      mCc(std::move(pCc)),
+      mBcc(std::move(pBcc)),
+      mAttachments(std::move(pAttachments)) {
+    if (mTo.empty()) {
         throw std::invalid_argument("To cannot be empty");
     }
 }
@@ -40,8 +42,12 @@ std::string Message::getSubject() const {
     return mSubject;
 }
 
-std::string Message::getBody() const {
-    return mBody;
+std::string_view Message::getSubjectView() const {
+    return mSubject;
+}
+
+const std::string &Message::getBody() const {
+    return *mBody;
 }
 
 const std::vector<MessageAddress> &Message::getCc() const {
@@ -68,13 +74,21 @@ size_t Message::getAttachmentsCount() const {
     return mAttachments.size();
 }
 
-std::vector<jed_utils::MessageAddress> Message::getStdMessageAddressVec(const std::vector<MessageAddress> &src) const {
-    std::vector<jed_utils::MessageAddress> retval = {};
-    std::transform(src.cbegin(),
-                   src.cend(),
-                   std::back_inserter(retval),
-                   [](const auto &recipient) { return recipient.toStdMessageAddress(); });
-    return retval;
+jed_utils::RecipientTable Message::getStdRecipientTable() const {
+    size_t pool_size = 0;
+    for (const auto *addresses : { &mTo, &mCc, &mBcc }) {
+        for (const auto &address : *addresses) {
+            pool_size += address.getEmailAddressView().size() + address.getDisplayNameView().size();
+        }
+    }
+    jed_utils::RecipientTable table;
+    table.reserve(mTo.size() + mCc.size() + mBcc.size(), pool_size);
+    for (const auto *addresses : { &mTo, &mCc, &mBcc }) {
+        for (const auto &address : *addresses) {
+            table.append(address.getEmailAddressView(), address.getDisplayNameView());
+        }
+    }
+    return table;
 }
 
 std::vector<jed_utils::Attachment> Message::getStdAttachmentVec(const std::vector<Attachment> &src) const {
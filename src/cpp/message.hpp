@@ -1,7 +1,9 @@
 #ifndef CPPMESSAGE_H
 #define CPPMESSAGE_H
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "attachment.hpp"
 #include "../message.h"
@@ -32,14 +34,17 @@ class CPP_MESSAGE_API Message {
      *  @param pCc The carbon-copy recipient email addresses.
      *  @param pBcc The blind carbon-copy recipient email addresses.
      *  @param pAttachments The attachments of the message
+     *
+     *  The parameters are taken by value, pass them with std::move to
+     *  avoid copying a large body or recipient list.
      */
-    Message(const MessageAddress &pFrom,
-            const std::vector<MessageAddress> &pTo,
-            const std::string &pSubject,
-            const std::string &pBody,
-            const std::vector<MessageAddress> &pCc = {},
-            const std::vector<MessageAddress> &pBcc = {},
-            const std::vector<Attachment> &pAttachments = {});
+    Message(MessageAddress pFrom,
+            std::vector<MessageAddress> pTo,
+            std::string pSubject,
+            std::string pBody,
+            std::vector<MessageAddress> pCc = {},
+            std::vector<MessageAddress> pBcc = {},
+            std::vector<Attachment> pAttachments = {});
 
     /** The destructor of the Message */
     virtual ~Message() = default;
@@ -59,8 +64,11 @@ class CPP_MESSAGE_API Message {
     /** Return the subject of the message. */
     std::string getSubject() const;
 
+    /** Return the subject of the message without copying it. */
+    std::string_view getSubjectView() const;
+
     /** Return the body of the message. */
-    std::string getBody() const;
+    const std::string &getBody() const;
 
     /** Return the carbon-copy recipient MessageAddress vector of the message  */
     const std::vector<MessageAddress> &getCc() const;
@@ -81,14 +89,31 @@ class CPP_MESSAGE_API Message {
     size_t getAttachmentsCount() const;
 
  protected:
-    std::vector<jed_utils::MessageAddress> getStdMessageAddressVec(const std::vector<MessageAddress> &src) const;
     std::vector<jed_utils::Attachment> getStdAttachmentVec(const std::vector<Attachment> &src) const;
 
+    // Return the To, Cc and Bcc recipients in a single table, read from
+    // the addresses without copying them one by one
+    jed_utils::RecipientTable getStdRecipientTable() const;
+
+    // Build the jed_utils counterpart of the message. The derived classes
+    // build it once and share it between their copies since a message
+    // cannot be modified. The body itself is shared, not copied.
+    template <typename T>
+    std::shared_ptr<const T> createStdMessage() const {
+        return std::make_shared<const T>(mFrom.toStdMessageAddress(),
+                getStdRecipientTable(),
+                mTo.size(),
+                mCc.size(),
+                mSubject,
+                mBody,
+                getStdAttachmentVec(mAttachments));
+    }
+
  private:
     MessageAddress mFrom;
     std::vector<MessageAddress> mTo;
     std::string mSubject;
-    std::string mBody;
+    std::shared_ptr<const std::string> mBody;
     std::vector<MessageAddress> mCc;
     std::vector<MessageAddress> mBcc;
     std::vector<Attachment> mAttachments;
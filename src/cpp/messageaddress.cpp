@@ -20,8 +20,17 @@ std::string MessageAddress::getDisplayName() const {
     return jed_utils::MessageAddress::getDisplayName();
 }
 
+std::string_view MessageAddress::getEmailAddressView() const {
+    return jed_utils::MessageAddress::getEmailAddress();
+}
+
+std::string_view MessageAddress::getDisplayNameView() const {
+    return jed_utils::MessageAddress::getDisplayName();
+}
+
 jed_utils::MessageAddress MessageAddress::toStdMessageAddress() const {
-    return jed_utils::MessageAddress(jed_utils::MessageAddress::getEmailAddress(),
-                                     jed_utils::MessageAddress::getDisplayName());
+    // The address has been validated on construction, the copy does not
+    // validate it again
+    return static_cast<const jed_utils::MessageAddress &>(*this);
 }
 
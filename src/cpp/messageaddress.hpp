@@ -4,6 +4,7 @@
 #include <cstring>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "../messageaddress.h"
 
@@ -62,6 +63,12 @@ class CPP_MESSAGEADDRESS_API MessageAddress : private jed_utils::MessageAddress
     /** Return the display name. */
     std::string getDisplayName() const;
 
+    /** Return the email address without copying it. */
+    std::string_view getEmailAddressView() const;
+
+    /** Return the display name without copying it. */
+    std::string_view getDisplayNameView() const;
+
     jed_utils::MessageAddress toStdMessageAddress() const;
 
     friend class Message;
@@ -0,0 +1,89 @@
+#include "messagebuilder.hpp"
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+using namespace jed_utils::cpp;
+
+MessageBuilder &MessageBuilder::setFrom(MessageAddress pFrom) {
+    mFrom = std::move(pFrom);
+    return *this;
+}
+
+MessageBuilder &MessageBuilder::addRecipient(MessageAddress pRecipient, RecipientType pType) {
+    switch (pType) {
+        case RecipientType::Cc:
+            mCc.push_back(std::move(pRecipient));
+            break;
+        case RecipientType::Bcc:
+            mBcc.push_back(std::move(pRecipient));
+            break;
+        default:
+            mTo.push_back(std::move(pRecipient));
+            break;
+    }
+    return *this;
+}
+
+MessageBuilder &MessageBuilder::addRecipients(std::vector<MessageAddress> pRecipients, RecipientType pType) {
+    std::vector<MessageAddress> &recipients = pType == RecipientType::Cc ? mCc
+        : pType == RecipientType::Bcc ? mBcc
+        : mTo;
+    if (recipients.empty()) {
+        recipients = std::move(pRecipients);
+    } else {
+        recipients.insert(recipients.end(),
+                std::make_move_iterator(pRecipients.begin()),
+                std::make_move_iterator(pRecipients.end()));
+    }
+    return *this;
+}
+
+MessageBuilder &MessageBuilder::addAttachment(Attachment pAttachment) {
+    mAttachments.push_back(std::move(pAttachment));
+    return *this;
+}
+
+MessageBuilder &MessageBuilder::setSubject(std::string pSubject) {
+    mSubject = std::move(pSubject);
+    return *this;
+}
+
+MessageBuilder &MessageBuilder::setBody(std::string pBody) {
+    mBody = std::move(pBody);
+    return *this;
+}
+
+template <typename T>
+T MessageBuilder::build() {
+    if (!mFrom.has_value()) {
+        throw std::invalid_argument("From cannot be empty");
+    }
+    if (mTo.empty()) {
+        throw std::invalid_argument("To cannot be empty");
+    }
+    T retval(std::move(*mFrom),
+            std::move(mTo),
+            std::move(mSubject),
+            std::move(mBody),
+            std::move(mCc),
+            std::move(mBcc),
+            std::move(mAttachments));
+    // Leave the builder empty whatever the state of the moved-from parts
+    mFrom.reset();
+    mTo.clear();
+    mCc.clear();
+    mBcc.clear();
+    mAttachments.clear();
+    mSubject.clear();
+    mBody.clear();
+    return retval;
+}
+
+PlaintextMessage MessageBuilder::buildPlaintextMessage() {
+    return build<PlaintextMessage>();
+}
+
+HTMLMessage MessageBuilder::buildHTMLMessage() {
+    return build<HTMLMessage>();
+}
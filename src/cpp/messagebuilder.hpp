@@ -0,0 +1,111 @@
+#ifndef CPPMESSAGEBUILDER_H
+#define CPPMESSAGEBUILDER_H
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "attachment.hpp"
+#include "htmlmessage.hpp"
+#include "messageaddress.hpp"
+#include "plaintextmessage.hpp"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define CPP_MESSAGEBUILDER_API __declspec(dllexport)
+    #else
+        #define CPP_MESSAGEBUILDER_API __declspec(dllimport)
+    #endif
+#else
+    #define CPP_MESSAGEBUILDER_API
+#endif
+
+namespace jed_utils {
+namespace cpp {
+/** @brief The type of a recipient of a message. */
+enum class RecipientType {
+    To,
+    Cc,
+    Bcc
+};
+
+/** @brief The MessageBuilder class builds a PlaintextMessage or an
+ *  HTMLMessage step by step.
+ *
+ *  The parts of the message are taken by value and moved into the builder,
+ *  then into the message, so a large body or a long recipient list passed
+ *  with std::move is never copied.
+ *
+ *  Example:
+ *  @code
+ *  auto msg = MessageBuilder()
+ *          .setFrom(MessageAddress("from@test.com"))
+ *          .addRecipient(MessageAddress("to@test.com"))
+ *          .setSubject("Subject")
+ *          .setBody(std::move(body))
+ *          .buildHTMLMessage();
+ *  @endcode
+ */
+class CPP_MESSAGEBUILDER_API MessageBuilder {
+ public:
+    /** Construct a new empty MessageBuilder. */
+    MessageBuilder() = default;
+
+    /** Set the sender email address of the message. */
+    MessageBuilder &setFrom(MessageAddress pFrom);
+
+    /**
+     *  @brief  Add a recipient to the message.
+     *  @param pRecipient The email address of the recipient.
+     *  @param pType The type of the recipient. Default: RecipientType::To
+     */
+    MessageBuilder &addRecipient(MessageAddress pRecipient, RecipientType pType = RecipientType::To);
+
+    /**
+     *  @brief  Add several recipients to the message.
+     *  @param pRecipients The email addresses of the recipients.
+     *  @param pType The type of the recipients. Default: RecipientType::To
+     */
+    MessageBuilder &addRecipients(std::vector<MessageAddress> pRecipients, RecipientType pType = RecipientType::To);
+
+    /** Add an attachment to the message. */
+    MessageBuilder &addAttachment(Attachment pAttachment);
+
+    /** Set the subject of the message. */
+    MessageBuilder &setSubject(std::string pSubject);
+
+    /** Set the content of the message. */
+    MessageBuilder &setBody(std::string pBody);
+
+    /**
+     *  @brief  Build a PlaintextMessage with the parts of the builder.
+     *  The parts are moved into the message and the builder is left empty.
+     *  @exception std::invalid_argument The sender or the recipients are
+     *  missing.
+     */
+    PlaintextMessage buildPlaintextMessage();
+
+    /**
+     *  @brief  Build an HTMLMessage with the parts of the builder.
+     *  The parts are moved into the message and the builder is left empty.
+     *  @exception std::invalid_argument The sender or the recipients are
+     *  missing.
+     */
+    HTMLMessage buildHTMLMessage();
+
+ private:
+    template <typename T>
+    T build();
+
+    std::optional<MessageAddress> mFrom;
+    std::vector<MessageAddress> mTo;
+    std::vector<MessageAddress> mCc;
+    std::vector<MessageAddress> mBcc;
+    std::vector<Attachment> mAttachments;
+    std::string mSubject;
+    std::string mBody;
+};
+}  // namespace cpp
+}  // namespace jed_utils
+
+#endif
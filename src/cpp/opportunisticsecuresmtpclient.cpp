@@ -1,6 +1,7 @@
 #include "opportunisticsecuresmtpclient.hpp"
 #include <string>
 #include <utility>
+#include "../errorresolver.h"
 
 using namespace jed_utils::cpp;
 
@@ -8,14 +9,16 @@ OpportunisticSecureSMTPClient::OpportunisticSecureSMTPClient(const std::string &
     : jed_utils::OpportunisticSecureSMTPClient(pServerName.c_str(), pPort) {
 }
 
-OpportunisticSecureSMTPClient::~OpportunisticSecureSMTPClient() {
-    delete mCredential;
-}
+OpportunisticSecureSMTPClient::~OpportunisticSecureSMTPClient() = default;
 
 std::string OpportunisticSecureSMTPClient::getServerName() const {
     return jed_utils::OpportunisticSecureSMTPClient::getServerName();
 }
 
+std::string_view OpportunisticSecureSMTPClient::getServerNameView() const {
+    return jed_utils::SMTPClientBase::getServerName();
+}
+
 unsigned int OpportunisticSecureSMTPClient::getServerPort() const {
     return jed_utils::OpportunisticSecureSMTPClient::getServerPort();
 }
@@ -24,12 +27,20 @@ unsigned int OpportunisticSecureSMTPClient::getCommandTimeout() const {
     return jed_utils::SMTPClientBase::getCommandTimeout();
 }
 
+unsigned int OpportunisticSecureSMTPClient::getCommandTimeoutInMilliseconds() const {
+    return jed_utils::SMTPClientBase::getCommandTimeoutInMilliseconds();
+}
+
 std::string OpportunisticSecureSMTPClient::getCommunicationLog() const {
     return jed_utils::OpportunisticSecureSMTPClient::getCommunicationLog();
 }
 
+std::string_view OpportunisticSecureSMTPClient::getCommunicationLogView() const {
+    return jed_utils::SMTPClientBase::getCommunicationLogView();
+}
+
 const Credential *OpportunisticSecureSMTPClient::getCredentials() const {
-    return mCredential;
+    return mCredential.get();
 }
 
 void OpportunisticSecureSMTPClient::setServerName(const std::string &pServerName) {
@@ -44,28 +55,190 @@ void OpportunisticSecureSMTPClient::setCommandTimeout(unsigned int pTimeOutInSec
     jed_utils::SMTPClientBase::setCommandTimeout(pTimeOutInSeconds);
 }
 
+void OpportunisticSecureSMTPClient::setCommandTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds) {
+    jed_utils::SMTPClientBase::setCommandTimeoutInMilliseconds(pTimeOutInMilliseconds);
+}
+
 void OpportunisticSecureSMTPClient::setCredentials(const Credential &pCredential) {
-    jed_utils::SMTPClientBase::setCredentials(jed_utils::Credential(pCredential.getUsername().c_str(),
-                                                                    pCredential.getPassword().c_str()));
-    delete mCredential;
-    mCredential = new Credential(pCredential);
+    if (pCredential.getTokenSource() != nullptr) {
+        jed_utils::SMTPClientBase::setCredentials(jed_utils::Credential(pCredential.getUsername().c_str(),
+                                                                        pCredential.getTokenSource()));
+    } else {
+        jed_utils::SMTPClientBase::setCredentials(jed_utils::Credential(pCredential.getUsername().c_str(),
+                                                                        pCredential.getPassword().c_str()));
+    }
+    mCredential = std::make_shared<const Credential>(pCredential);
 }
 
 void OpportunisticSecureSMTPClient::setKeepUsingBaseSendCommands(bool pValue) {
     jed_utils::SMTPClientBase::setKeepUsingBaseSendCommands(pValue);
 }
 
+const jed_utils::ServerCapabilities &OpportunisticSecureSMTPClient::getServerCapabilities() const {
+    return jed_utils::SMTPClientBase::getServerCapabilities();
+}
+
+bool OpportunisticSecureSMTPClient::isPipeliningEnabled() const {
+    return jed_utils::SMTPClientBase::isPipeliningEnabled();
+}
+
+void OpportunisticSecureSMTPClient::setPipeliningEnabled(bool pValue) {
+    jed_utils::SMTPClientBase::setPipeliningEnabled(pValue);
+}
+
+bool OpportunisticSecureSMTPClient::isChunkingEnabled() const {
+    return jed_utils::SMTPClientBase::isChunkingEnabled();
+}
+
+void OpportunisticSecureSMTPClient::setChunkingEnabled(bool pValue) {
+    jed_utils::SMTPClientBase::setChunkingEnabled(pValue);
+}
+
+bool OpportunisticSecureSMTPClient::isTextAttachmentEncodingEnabled() const {
+    return jed_utils::SMTPClientBase::isTextAttachmentEncodingEnabled();
+}
+
+void OpportunisticSecureSMTPClient::setTextAttachmentEncodingEnabled(bool pValue) {
+    jed_utils::SMTPClientBase::setTextAttachmentEncodingEnabled(pValue);
+}
+
+size_t OpportunisticSecureSMTPClient::getDataWriteSize() const {
+    return jed_utils::SMTPClientBase::getDataWriteSize();
+}
+
+void OpportunisticSecureSMTPClient::setDataWriteSize(size_t pWriteSize) {
+    jed_utils::SMTPClientBase::setDataWriteSize(pWriteSize);
+}
+
+const jed_utils::TransportOptions &OpportunisticSecureSMTPClient::getTransportOptions() const {
+    return jed_utils::SMTPClientBase::getTransportOptions();
+}
+
+void OpportunisticSecureSMTPClient::setTransportOptions(const jed_utils::TransportOptions &pOptions) {
+    jed_utils::SMTPClientBase::setTransportOptions(pOptions);
+}
+
+const jed_utils::DsnOptions &OpportunisticSecureSMTPClient::getDsnOptions() const {
+    return jed_utils::SMTPClientBase::getDsnOptions();
+}
+
+void OpportunisticSecureSMTPClient::setDsnOptions(const jed_utils::DsnOptions &pOptions) {
+    jed_utils::SMTPClientBase::setDsnOptions(pOptions);
+}
+
+unsigned int OpportunisticSecureSMTPClient::getOperationTimeoutInMilliseconds() const {
+    return jed_utils::SMTPClientBase::getOperationTimeoutInMilliseconds();
+}
+
+void OpportunisticSecureSMTPClient::setOperationTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds) {
+    jed_utils::SMTPClientBase::setOperationTimeoutInMilliseconds(pTimeOutInMilliseconds);
+}
+
+std::shared_ptr<jed_utils::CancellationToken> OpportunisticSecureSMTPClient::getCancellationToken() const {
+    return jed_utils::SMTPClientBase::getCancellationToken();
+}
+
+void OpportunisticSecureSMTPClient::setCancellationToken(std::shared_ptr<jed_utils::CancellationToken> pToken) {
+    jed_utils::SMTPClientBase::setCancellationToken(std::move(pToken));
+}
+
+size_t OpportunisticSecureSMTPClient::getAttachmentPrefetchBlockCount() const {
+    return jed_utils::SMTPClientBase::getAttachmentPrefetchBlockCount();
+}
+
+void OpportunisticSecureSMTPClient::setAttachmentPrefetchBlockCount(size_t pBlockCount) {
+    jed_utils::SMTPClientBase::setAttachmentPrefetchBlockCount(pBlockCount);
+}
+
+jed_utils::CommunicationLogLevel OpportunisticSecureSMTPClient::getCommunicationLogLevel() const {
+    return jed_utils::SMTPClientBase::getCommunicationLogLevel();
+}
+
+void OpportunisticSecureSMTPClient::setCommunicationLogLevel(jed_utils::CommunicationLogLevel pLevel) {
+    jed_utils::SMTPClientBase::setCommunicationLogLevel(pLevel);
+}
+
+size_t OpportunisticSecureSMTPClient::getCommunicationLogCapacity() const {
+    return jed_utils::SMTPClientBase::getCommunicationLogCapacity();
+}
+
+void OpportunisticSecureSMTPClient::setCommunicationLogCapacity(size_t pCapacity) {
+    jed_utils::SMTPClientBase::setCommunicationLogCapacity(pCapacity);
+}
+
+void OpportunisticSecureSMTPClient::setCommunicationLogSink(jed_utils::CommunicationLogSink pSink) {
+    jed_utils::SMTPClientBase::setCommunicationLogSink(std::move(pSink));
+}
+
+std::shared_ptr<jed_utils::EncodedAttachmentCache> OpportunisticSecureSMTPClient::getEncodedAttachmentCache() const {
+    return jed_utils::SMTPClientBase::getEncodedAttachmentCache();
+}
+
+void OpportunisticSecureSMTPClient::setEncodedAttachmentCache(std::shared_ptr<jed_utils::EncodedAttachmentCache> pCache) {
+    jed_utils::SMTPClientBase::setEncodedAttachmentCache(std::move(pCache));
+}
+
+std::shared_ptr<jed_utils::CapabilityCache> OpportunisticSecureSMTPClient::getCapabilityCache() const {
+    return jed_utils::SMTPClientBase::getCapabilityCache();
+}
+
+void OpportunisticSecureSMTPClient::setCapabilityCache(std::shared_ptr<jed_utils::CapabilityCache> pCache) {
+    jed_utils::SMTPClientBase::setCapabilityCache(std::move(pCache));
+}
+
+std::shared_ptr<const jed_utils::DkimSigner> OpportunisticSecureSMTPClient::getDkimSigner() const {
+    return jed_utils::SMTPClientBase::getDkimSigner();
+}
+
+void OpportunisticSecureSMTPClient::setDkimSigner(std::shared_ptr<const jed_utils::DkimSigner> pSigner) {
+    jed_utils::SMTPClientBase::setDkimSigner(std::move(pSigner));
+}
+
+std::shared_ptr<jed_utils::SessionObserver> OpportunisticSecureSMTPClient::getSessionObserver() const {
+    return jed_utils::SMTPClientBase::getSessionObserver();
+}
+
+void OpportunisticSecureSMTPClient::setSessionObserver(std::shared_ptr<jed_utils::SessionObserver> pObserver) {
+    jed_utils::SMTPClientBase::setSessionObserver(std::move(pObserver));
+}
+
+std::shared_ptr<const jed_utils::SessionTrace> OpportunisticSecureSMTPClient::getSessionTrace() const {
+    return jed_utils::SMTPClientBase::getSessionTrace();
+}
+
+void OpportunisticSecureSMTPClient::setSessionTraceCapacity(size_t pCapacity) {
+    jed_utils::SMTPClientBase::setSessionTraceCapacity(pCapacity);
+}
+
+std::shared_ptr<jed_utils::Transport> OpportunisticSecureSMTPClient::getTransport() const {
+    return jed_utils::SMTPClientBase::getTransport();
+}
+
+void OpportunisticSecureSMTPClient::setTransport(std::shared_ptr<jed_utils::Transport> pTransport) {
+    jed_utils::SMTPClientBase::setTransport(std::move(pTransport));
+}
+
+const jed_utils::IoCounters &OpportunisticSecureSMTPClient::getIoCounters() const {
+    return jed_utils::SMTPClientBase::getIoCounters();
+}
+
+std::shared_ptr<jed_utils::TlsContext> OpportunisticSecureSMTPClient::getTlsContext() const {
+    return jed_utils::SecureSMTPClientBase::getTlsContext();
+}
+
+void OpportunisticSecureSMTPClient::setTlsContext(std::shared_ptr<jed_utils::TlsContext> pTlsContext) {
+    jed_utils::SecureSMTPClientBase::setTlsContext(std::move(pTlsContext));
+}
+
 std::string OpportunisticSecureSMTPClient::getErrorMessage(int errorCode) {
-    return jed_utils::SMTPClientBase::getErrorMessage(errorCode);
+    return std::string(jed_utils::ErrorResolver::findErrorMessage(errorCode));
 }
 
 int OpportunisticSecureSMTPClient::getErrorMessage_r(int errorCode,
                                   std::string &errorMessage) {
-    const size_t MAXSIZE = 1024;
-    char *errorMsg = new char[MAXSIZE];
-    int result = jed_utils::SMTPClientBase::getErrorMessage_r(errorCode, errorMsg, MAXSIZE);
-    errorMessage = errorMsg;
-    return result;
+    // The messages are static, the string is the only copy made
+    errorMessage = jed_utils::ErrorResolver::findErrorMessage(errorCode);
+    return 0;
 }
 
 int OpportunisticSecureSMTPClient::extractReturnCode(const std::string &pOutput) {
@@ -76,6 +249,46 @@ jed_utils::ServerAuthOptions *OpportunisticSecureSMTPClient::extractAuthenticati
     return jed_utils::SMTPClientBase::extractAuthenticationOptions(pEhloOutput.c_str());
 }
 
+jed_utils::ServerCapabilities OpportunisticSecureSMTPClient::extractServerCapabilities(const std::string &pEhloOutput) {
+    return jed_utils::SMTPClientBase::extractServerCapabilities(pEhloOutput.c_str());
+}
+
+int OpportunisticSecureSMTPClient::connect() {
+    return jed_utils::SMTPClientBase::connect();
+}
+
+int OpportunisticSecureSMTPClient::disconnect() {
+    return jed_utils::SMTPClientBase::disconnect();
+}
+
+bool OpportunisticSecureSMTPClient::isConnected() const {
+    return jed_utils::SMTPClientBase::isConnected();
+}
+
+int OpportunisticSecureSMTPClient::prepare() {
+    return jed_utils::SMTPClientBase::prepare();
+}
+
+std::vector<jed_utils::BulkRecipientResult> OpportunisticSecureSMTPClient::sendBulk(const jed_utils::Message &pTemplate,
+        const std::vector<jed_utils::MessageAddress> &pRecipients) {
+    return jed_utils::SMTPClientBase::sendBulk(pTemplate, pRecipients.data(), pRecipients.size());
+}
+
+std::vector<jed_utils::BulkRecipientResult> OpportunisticSecureSMTPClient::sendBulk(const std::string &pSenderAddress,
+        const jed_utils::MessageTemplate &pTemplate,
+        const std::vector<jed_utils::MergeRecipient> &pRecipients) {
+    return jed_utils::SMTPClientBase::sendBulk(pSenderAddress.c_str(), pTemplate, pRecipients.data(), pRecipients.size());
+}
+
+jed_utils::SendResult OpportunisticSecureSMTPClient::getLastSendResult() const {
+    return jed_utils::SMTPClientBase::getLastSendResult();
+}
+
 int OpportunisticSecureSMTPClient::sendMail(const jed_utils::Message &pMsg) {
     return jed_utils::OpportunisticSecureSMTPClient::sendMail(pMsg);
 }
+
+int OpportunisticSecureSMTPClient::sendMail(const jed_utils::Message &pMsg,
+        const std::vector<jed_utils::MessageAddress> &pEnvelopeRecipients) {
+    return jed_utils::SMTPClientBase::sendMail(pMsg, pEnvelopeRecipients.data(), pEnvelopeRecipients.size());
+}
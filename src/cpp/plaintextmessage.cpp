@@ -1,43 +1,30 @@
 #include "plaintextmessage.hpp"
+#include <utility>
 #include "message.hpp"
 
 using namespace jed_utils::cpp;
 
-PlaintextMessage::PlaintextMessage(const MessageAddress &pFrom,
-                 const std::vector<MessageAddress> &pTo,
-                 const std::string &pSubject,
-                 const std::string &pBody,
-                 const std::vector<MessageAddress> &pCc,
-                 const std::vector<MessageAddress> &pBcc,
-                 const std::vector<Attachment> &pAttachments)
-    : Message(pFrom,
-              pTo,
-              pSubject,
-              pBody,
-              pCc,
-              pBcc,
-              pAttachments) {
+PlaintextMessage::PlaintextMessage(MessageAddress pFrom,
+                 std::vector<MessageAddress> pTo,
+                 std::string pSubject,
+                 std::string pBody,
+                 std::vector<MessageAddress> pCc,
+                 std::vector<MessageAddress> pBcc,
+                 std::vector<Attachment> pAttachments)
+    : Message(std::move(pFrom),
+              std::move(pTo),
+              std::move(pSubject),
+              std::move(pBody),
+              std::move(pCc),
+              std::move(pBcc),
+              std::move(pAttachments)),
+      mStdMessage(createStdMessage<jed_utils::PlaintextMessage>()) {
 }
 
 std::string PlaintextMessage::getMimeType() const {
     return "text/plain";
 }
 
-PlaintextMessage::operator jed_utils::PlaintextMessage() const {
-    const auto to = getStdMessageAddressVec(getTo());
-    const auto cc = getStdMessageAddressVec(getCc());
-    const auto bcc = getStdMessageAddressVec(getBcc());
-    const auto att = getStdAttachmentVec(getAttachments());
-    const jed_utils::PlaintextMessage msg (getFrom().toStdMessageAddress(),
-                                  to.data(),
-                                  to.size(),
-                                  getSubject().c_str(),
-                                  getBody().c_str(),
-                                  cc.data(),
-                                  cc.size(),
-                                  bcc.data(),
-                                  bcc.size(),
-                                  att.data(),
-                                  att.size());
-    return msg;
+PlaintextMessage::operator const jed_utils::PlaintextMessage &() const {
+    return *mStdMessage;
 }
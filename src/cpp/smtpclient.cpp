@@ -1,6 +1,7 @@
 #include "smtpclient.hpp"
 #include <string>
 #include <utility>
+#include "../errorresolver.h"
 
 using namespace jed_utils::cpp;
 
@@ -8,14 +9,16 @@ SmtpClient::SmtpClient(const std::string &pServerName, unsigned int pPort)
     : jed_utils::SmtpClient(pServerName.c_str(), pPort) {
 }
 
-SmtpClient::~SmtpClient() {
-    delete mCredential;
-}
+SmtpClient::~SmtpClient() = default;
 
 std::string SmtpClient::getServerName() const {
     return jed_utils::SmtpClient::getServerName();
 }
 
+std::string_view SmtpClient::getServerNameView() const {
+    return jed_utils::SMTPClientBase::getServerName();
+}
+
 unsigned int SmtpClient::getServerPort() const {
     return jed_utils::SmtpClient::getServerPort();
 }
@@ -24,12 +27,20 @@ unsigned int SmtpClient::getCommandTimeout() const {
     return jed_utils::SMTPClientBase::getCommandTimeout();
 }
 
+unsigned int SmtpClient::getCommandTimeoutInMilliseconds() const {
+    return jed_utils::SMTPClientBase::getCommandTimeoutInMilliseconds();
+}
+
 std::string SmtpClient::getCommunicationLog() const {
     return jed_utils::SmtpClient::getCommunicationLog();
 }
 
+std::string_view SmtpClient::getCommunicationLogView() const {
+    return jed_utils::SMTPClientBase::getCommunicationLogView();
+}
+
 const Credential *SmtpClient::getCredentials() const {
-    return mCredential;
+    return mCredential.get();
 }
 
 void SmtpClient::setServerName(const std::string &pServerName) {
@@ -44,28 +55,182 @@ void SmtpClient::setCommandTimeout(unsigned int pTimeOutInSeconds) {
     jed_utils::SMTPClientBase::setCommandTimeout(pTimeOutInSeconds);
 }
 
+void SmtpClient::setCommandTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds) {
+    jed_utils::SMTPClientBase::setCommandTimeoutInMilliseconds(pTimeOutInMilliseconds);
+}
+
 void SmtpClient::setCredentials(const Credential &pCredential) {
-    jed_utils::SMTPClientBase::setCredentials(jed_utils::Credential(pCredential.getUsername().c_str(),
-                                                                    pCredential.getPassword().c_str()));
-    delete mCredential;
-    mCredential = new Credential(pCredential);
+    if (pCredential.getTokenSource() != nullptr) {
+        jed_utils::SMTPClientBase::setCredentials(jed_utils::Credential(pCredential.getUsername().c_str(),
+                                                                        pCredential.getTokenSource()));
+    } else {
+        jed_utils::SMTPClientBase::setCredentials(jed_utils::Credential(pCredential.getUsername().c_str(),
+                                                                        pCredential.getPassword().c_str()));
+    }
+    mCredential = std::make_shared<const Credential>(pCredential);
 }
 
 void SmtpClient::setKeepUsingBaseSendCommands(bool pValue) {
     jed_utils::SMTPClientBase::setKeepUsingBaseSendCommands(pValue);
 }
 
+const jed_utils::ServerCapabilities &SmtpClient::getServerCapabilities() const {
+    return jed_utils::SMTPClientBase::getServerCapabilities();
+}
+
+bool SmtpClient::isPipeliningEnabled() const {
+    return jed_utils::SMTPClientBase::isPipeliningEnabled();
+}
+
+void SmtpClient::setPipeliningEnabled(bool pValue) {
+    jed_utils::SMTPClientBase::setPipeliningEnabled(pValue);
+}
+
+bool SmtpClient::isChunkingEnabled() const {
+    return jed_utils::SMTPClientBase::isChunkingEnabled();
+}
+
+void SmtpClient::setChunkingEnabled(bool pValue) {
+    jed_utils::SMTPClientBase::setChunkingEnabled(pValue);
+}
+
+bool SmtpClient::isTextAttachmentEncodingEnabled() const {
+    return jed_utils::SMTPClientBase::isTextAttachmentEncodingEnabled();
+}
+
+void SmtpClient::setTextAttachmentEncodingEnabled(bool pValue) {
+    jed_utils::SMTPClientBase::setTextAttachmentEncodingEnabled(pValue);
+}
+
+size_t SmtpClient::getDataWriteSize() const {
+    return jed_utils::SMTPClientBase::getDataWriteSize();
+}
+
+void SmtpClient::setDataWriteSize(size_t pWriteSize) {
+    jed_utils::SMTPClientBase::setDataWriteSize(pWriteSize);
+}
+
+const jed_utils::TransportOptions &SmtpClient::getTransportOptions() const {
+    return jed_utils::SMTPClientBase::getTransportOptions();
+}
+
+void SmtpClient::setTransportOptions(const jed_utils::TransportOptions &pOptions) {
+    jed_utils::SMTPClientBase::setTransportOptions(pOptions);
+}
+
+const jed_utils::DsnOptions &SmtpClient::getDsnOptions() const {
+    return jed_utils::SMTPClientBase::getDsnOptions();
+}
+
+void SmtpClient::setDsnOptions(const jed_utils::DsnOptions &pOptions) {
+    jed_utils::SMTPClientBase::setDsnOptions(pOptions);
+}
+
+unsigned int SmtpClient::getOperationTimeoutInMilliseconds() const {
+    return jed_utils::SMTPClientBase::getOperationTimeoutInMilliseconds();
+}
+
+void SmtpClient::setOperationTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds) {
+    jed_utils::SMTPClientBase::setOperationTimeoutInMilliseconds(pTimeOutInMilliseconds);
+}
+
+std::shared_ptr<jed_utils::CancellationToken> SmtpClient::getCancellationToken() const {
+    return jed_utils::SMTPClientBase::getCancellationToken();
+}
+
+void SmtpClient::setCancellationToken(std::shared_ptr<jed_utils::CancellationToken> pToken) {
+    jed_utils::SMTPClientBase::setCancellationToken(std::move(pToken));
+}
+
+size_t SmtpClient::getAttachmentPrefetchBlockCount() const {
+    return jed_utils::SMTPClientBase::getAttachmentPrefetchBlockCount();
+}
+
+void SmtpClient::setAttachmentPrefetchBlockCount(size_t pBlockCount) {
+    jed_utils::SMTPClientBase::setAttachmentPrefetchBlockCount(pBlockCount);
+}
+
+jed_utils::CommunicationLogLevel SmtpClient::getCommunicationLogLevel() const {
+    return jed_utils::SMTPClientBase::getCommunicationLogLevel();
+}
+
+void SmtpClient::setCommunicationLogLevel(jed_utils::CommunicationLogLevel pLevel) {
+    jed_utils::SMTPClientBase::setCommunicationLogLevel(pLevel);
+}
+
+size_t SmtpClient::getCommunicationLogCapacity() const {
+    return jed_utils::SMTPClientBase::getCommunicationLogCapacity();
+}
+
+void SmtpClient::setCommunicationLogCapacity(size_t pCapacity) {
+    jed_utils::SMTPClientBase::setCommunicationLogCapacity(pCapacity);
+}
+
+void SmtpClient::setCommunicationLogSink(jed_utils::CommunicationLogSink pSink) {
+    jed_utils::SMTPClientBase::setCommunicationLogSink(std::move(pSink));
+}
+
+std::shared_ptr<jed_utils::EncodedAttachmentCache> SmtpClient::getEncodedAttachmentCache() const {
+    return jed_utils::SMTPClientBase::getEncodedAttachmentCache();
+}
+
+void SmtpClient::setEncodedAttachmentCache(std::shared_ptr<jed_utils::EncodedAttachmentCache> pCache) {
+    jed_utils::SMTPClientBase::setEncodedAttachmentCache(std::move(pCache));
+}
+
+std::shared_ptr<jed_utils::CapabilityCache> SmtpClient::getCapabilityCache() const {
+    return jed_utils::SMTPClientBase::getCapabilityCache();
+}
+
+void SmtpClient::setCapabilityCache(std::shared_ptr<jed_utils::CapabilityCache> pCache) {
+    jed_utils::SMTPClientBase::setCapabilityCache(std::move(pCache));
+}
+
+std::shared_ptr<const jed_utils::DkimSigner> SmtpClient::getDkimSigner() const {
+    return jed_utils::SMTPClientBase::getDkimSigner();
+}
+
+void SmtpClient::setDkimSigner(std::shared_ptr<const jed_utils::DkimSigner> pSigner) {
+    jed_utils::SMTPClientBase::setDkimSigner(std::move(pSigner));
+}
+
+std::shared_ptr<jed_utils::SessionObserver> SmtpClient::getSessionObserver() const {
+    return jed_utils::SMTPClientBase::getSessionObserver();
+}
+
+void SmtpClient::setSessionObserver(std::shared_ptr<jed_utils::SessionObserver> pObserver) {
+    jed_utils::SMTPClientBase::setSessionObserver(std::move(pObserver));
+}
+
+std::shared_ptr<const jed_utils::SessionTrace> SmtpClient::getSessionTrace() const {
+    return jed_utils::SMTPClientBase::getSessionTrace();
+}
+
+void SmtpClient::setSessionTraceCapacity(size_t pCapacity) {
+    jed_utils::SMTPClientBase::setSessionTraceCapacity(pCapacity);
+}
+
+std::shared_ptr<jed_utils::Transport> SmtpClient::getTransport() const {
+    return jed_utils::SMTPClientBase::getTransport();
+}
+
+void SmtpClient::setTransport(std::shared_ptr<jed_utils::Transport> pTransport) {
+    jed_utils::SMTPClientBase::setTransport(std::move(pTransport));
+}
+
+const jed_utils::IoCounters &SmtpClient::getIoCounters() const {
+    return jed_utils::SMTPClientBase::getIoCounters();
+}
+
 std::string SmtpClient::getErrorMessage(int errorCode) {
-    return jed_utils::SMTPClientBase::getErrorMessage(errorCode);
+    return std::string(jed_utils::ErrorResolver::findErrorMessage(errorCode));
 }
 
 int SmtpClient::getErrorMessage_r(int errorCode,
                                   std::string &errorMessage) {
-    const size_t MAXSIZE = 1024;
-    char *errorMsg = new char[MAXSIZE];
-    int result = jed_utils::SMTPClientBase::getErrorMessage_r(errorCode, errorMsg, MAXSIZE);
-    errorMessage = errorMsg;
-    return result;
+    // The messages are static, the string is the only copy made
+    errorMessage = jed_utils::ErrorResolver::findErrorMessage(errorCode);
+    return 0;
 }
 
 int SmtpClient::extractReturnCode(const std::string &pOutput) {
@@ -76,6 +241,46 @@ jed_utils::ServerAuthOptions *SmtpClient::extractAuthenticationOptions(const std
     return jed_utils::SMTPClientBase::extractAuthenticationOptions(pEhloOutput.c_str());
 }
 
+jed_utils::ServerCapabilities SmtpClient::extractServerCapabilities(const std::string &pEhloOutput) {
+    return jed_utils::SMTPClientBase::extractServerCapabilities(pEhloOutput.c_str());
+}
+
+int SmtpClient::connect() {
+    return jed_utils::SMTPClientBase::connect();
+}
+
+int SmtpClient::disconnect() {
+    return jed_utils::SMTPClientBase::disconnect();
+}
+
+bool SmtpClient::isConnected() const {
+    return jed_utils::SMTPClientBase::isConnected();
+}
+
+int SmtpClient::prepare() {
+    return jed_utils::SMTPClientBase::prepare();
+}
+
+std::vector<jed_utils::BulkRecipientResult> SmtpClient::sendBulk(const jed_utils::Message &pTemplate,
+        const std::vector<jed_utils::MessageAddress> &pRecipients) {
+    return jed_utils::SMTPClientBase::sendBulk(pTemplate, pRecipients.data(), pRecipients.size());
+}
+
+std::vector<jed_utils::BulkRecipientResult> SmtpClient::sendBulk(const std::string &pSenderAddress,
+        const jed_utils::MessageTemplate &pTemplate,
+        const std::vector<jed_utils::MergeRecipient> &pRecipients) {
+    return jed_utils::SMTPClientBase::sendBulk(pSenderAddress.c_str(), pTemplate, pRecipients.data(), pRecipients.size());
+}
+
+jed_utils::SendResult SmtpClient::getLastSendResult() const {
+    return jed_utils::SMTPClientBase::getLastSendResult();
+}
+
 int SmtpClient::sendMail(const jed_utils::Message &pMsg) {
     return jed_utils::SmtpClient::sendMail(pMsg);
 }
+
+int SmtpClient::sendMail(const jed_utils::Message &pMsg,
+        const std::vector<jed_utils::MessageAddress> &pEnvelopeRecipients) {
+    return jed_utils::SMTPClientBase::sendMail(pMsg, pEnvelopeRecipients.data(), pEnvelopeRecipients.size());
+}
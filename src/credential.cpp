@@ -2,6 +2,7 @@
 #include <cstring>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include "stringutils.h"
 
 using namespace jed_utils;
@@ -29,6 +30,28 @@ Credential::Credential(const char *pUsername, const char *pPassword)
     mPassword[password_len] = '\0';
 }
 
+Credential::Credential(const char *pUsername, std::shared_ptr<OAuth2TokenSource> pTokenSource)
+    : mUsername(nullptr),
+      mPassword(new char[1]),
+      mTokenSource(std::move(pTokenSource)) {
+    mPassword[0] = '\0';
+    std::string username_str { pUsername == nullptr ? "" : pUsername };
+    if (pUsername == nullptr || strcmp(pUsername, "") == 0 || StringUtils::trim(username_str).empty()) {
+        delete[] mPassword;
+        throw std::invalid_argument("Username cannot be null or empty");
+    }
+
+    if (mTokenSource == nullptr) {
+        delete[] mPassword;
+        throw std::invalid_argument("Token source cannot be null");
+    }
+
+    size_t username_len = strlen(pUsername);
+    mUsername = new char[username_len + 1];
+    std::strncpy(mUsername, pUsername, username_len);
+    mUsername[username_len] = '\0';
+}
+
 Credential::~Credential() {
     delete[] mUsername;
     delete[] mPassword;
@@ -39,7 +62,8 @@ Credential::~Credential() {
 // Copy constructor
 Credential::Credential(const Credential& other)
     : mUsername(new char[strlen(other.mUsername) + 1]),
-      mPassword(new char[strlen(other.mPassword) + 1]) {
+      mPassword(new char[strlen(other.mPassword) + 1]),
+      mTokenSource(other.mTokenSource) {
     size_t username_len = strlen(other.mUsername);
     strncpy(mUsername, other.mUsername, username_len);
     mUsername[username_len] = '\0';
@@ -64,6 +88,7 @@ Credential& Credential::operator=(const Credential& other) {
         mPassword = new char[password_len + 1];
         strncpy(mPassword, other.mPassword, password_len);
         mPassword[password_len] = '\0';
+        mTokenSource = other.mTokenSource;
     }
     return *this;
 }
@@ -71,7 +96,8 @@ Credential& Credential::operator=(const Credential& other) {
 // Move constructor
 Credential::Credential(Credential&& other) noexcept
     : mUsername(other.mUsername),
-      mPassword(other.mPassword) {
+      mPassword(other.mPassword),
+      mTokenSource(std::move(other.mTokenSource)) {
     // Release the data pointer from the source object so that the destructor
     // does not free the memory multiple times.
     other.mUsername = nullptr;
@@ -86,6 +112,7 @@ Credential& Credential::operator=(Credential&& other) noexcept {
         // Copy the data pointer and its length from the source object.
         mUsername = other.mUsername;
         mPassword = other.mPassword;
+        mTokenSource = std::move(other.mTokenSource);
         // Release the data pointer from the source object so that
         // the destructor does not free the memory multiple times.
         other.mUsername = nullptr;
@@ -103,6 +130,10 @@ const char *Credential::getPassword() const {
     return mPassword;
 }
 
+std::shared_ptr<OAuth2TokenSource> Credential::getTokenSource() const {
+    return mTokenSource;
+}
+
 void Credential::setUsername(const char *pUsername) {
     std::string username_str { pUsername == nullptr ? "" : pUsername };
     if (pUsername == nullptr || strcmp(pUsername, "") == 0 || StringUtils::trim(username_str).empty()) {
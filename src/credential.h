@@ -1,7 +1,11 @@
 #ifndef CREDENTIAL_H
 #define CREDENTIAL_H
 
+#include <memory>
+#include "oauth2tokensource.h"
+
 #ifdef _WIN32
+    #pragma warning(disable: 4251)
     #ifdef SMTPCLIENT_EXPORTS
         #define CREDENTIAL_API __declspec(dllexport)
     #else
@@ -24,6 +28,14 @@ class CREDENTIAL_API Credential {
      */
     Credential(const char *pUsername, const char *pPassword);
 
+    /**
+     *  @brief  Construct a new Credential that authenticates with an OAuth 2.0
+     *  access token (XOAUTH2 or OAUTHBEARER) instead of a password.
+     *  @param pUsername The user name (the email address of the account).
+     *  @param pTokenSource The source of the access tokens of the user.
+     */
+    Credential(const char *pUsername, std::shared_ptr<OAuth2TokenSource> pTokenSource);
+
     /** The destructor og Credential */
     virtual ~Credential();
 
@@ -42,9 +54,12 @@ class CREDENTIAL_API Credential {
     /** Return the username. */
     const char *getUsername() const;
 
-    /** Return the password. */
+    /** Return the password, an empty string for a credential with a token source. */
     const char *getPassword() const;
 
+    /** Return the source of the access tokens or nullptr for a password credential. */
+    std::shared_ptr<OAuth2TokenSource> getTokenSource() const;
+
     /**
      *  @brief  Set the user name.
      *  @param pUsername A char array pointer of the user name.
@@ -60,6 +75,7 @@ class CREDENTIAL_API Credential {
  private:
     char *mUsername;
     char *mPassword;
+    std::shared_ptr<OAuth2TokenSource> mTokenSource;
 };
 }  // namespace jed_utils
 
@@ -0,0 +1,95 @@
+#include "datanormalizer.h"
+#include <cstring>
+
+using namespace jed_utils;
+
+namespace {
+// The inserted text are views of this string: CRLF, the doubled dot or both
+const char STUFFED_LINE_BREAK[] = "\r\n.";
+const std::string_view LINE_BREAK(STUFFED_LINE_BREAK, 2);
+const std::string_view STUFFED_DOT(STUFFED_LINE_BREAK + 2, 1);
+const std::string_view LINE_BREAK_AND_DOT(STUFFED_LINE_BREAK, 3);
+
+struct SegmentSink {
+    std::vector<std::string_view> &segments;
+    void append(std::string_view pData) {
+        if (!pData.empty()) {
+            segments.push_back(pData);
+        }
+    }
+};
+
+struct BufferSink {
+    std::string &buffer;
+    void append(std::string_view pData) {
+        buffer.append(pData.data(), pData.size());
+    }
+};
+}  // namespace
+
+DataNormalizer::DataNormalizer(bool pDotStuffing)
+    : mDotStuffing(pDotStuffing),
+      mAtLineStart(true),
+      mPreviousCarriageReturn(false) {
+}
+
+void DataNormalizer::reset() {
+    mAtLineStart = true;
+    mPreviousCarriageReturn = false;
+}
+
+void DataNormalizer::normalize(std::string_view pData, std::vector<std::string_view> &pSegments) {
+    SegmentSink sink { pSegments };
+    process(pData, sink);
+}
+
+void DataNormalizer::normalize(std::string_view pData, std::string &pOutput) {
+    pOutput.reserve(pOutput.size() + pData.size());
+    BufferSink sink { pOutput };
+    process(pData, sink);
+}
+
+bool DataNormalizer::isNormalized(std::string_view pData) const {
+    std::vector<std::string_view> segments;
+    DataNormalizer normalizer(*this);
+    normalizer.normalize(pData, segments);
+    return segments.size() <= 1;
+}
+
+template <typename Sink>
+void DataNormalizer::process(std::string_view pData, Sink &pSink) {
+    const char *data = pData.data();
+    const size_t size = pData.size();
+    if (size == 0) {
+        return;
+    }
+    // Start of the run of data that has not been appended yet
+    size_t run_start = 0;
+    if (mDotStuffing && mAtLineStart && data[0] == '.') {
+        pSink.append(STUFFED_DOT);
+    }
+    size_t position = 0;
+    while (position < size) {
+        const void *found = memchr(data + position, '\n', size - position);
+        if (found == nullptr) {
+            break;
+        }
+        const size_t line_feed = static_cast<size_t>(static_cast<const char *>(found) - data);
+        const bool has_carriage_return = line_feed > 0 ? data[line_feed - 1] == '\r' : mPreviousCarriageReturn;
+        const bool needs_dot = mDotStuffing && line_feed + 1 < size && data[line_feed + 1] == '.';
+        if (!has_carriage_return) {
+            // The bare LF is replaced by CRLF
+            pSink.append(pData.substr(run_start, line_feed - run_start));
+            pSink.append(needs_dot ? LINE_BREAK_AND_DOT : LINE_BREAK);
+            run_start = line_feed + 1;
+        } else if (needs_dot) {
+            pSink.append(pData.substr(run_start, line_feed + 1 - run_start));
+            pSink.append(STUFFED_DOT);
+            run_start = line_feed + 1;
+        }
+        position = line_feed + 1;
+    }
+    pSink.append(pData.substr(run_start));
+    mAtLineStart = data[size - 1] == '\n';
+    mPreviousCarriageReturn = data[size - 1] == '\r';
+}
@@ -0,0 +1,70 @@
+#ifndef DATANORMALIZER_H
+#define DATANORMALIZER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define DATANORMALIZER_API __declspec(dllexport)
+    #else
+        #define DATANORMALIZER_API __declspec(dllimport)
+    #endif
+#else
+    #define DATANORMALIZER_API
+#endif
+
+namespace jed_utils {
+/** @brief The DataNormalizer converts the bare LF line endings of a text
+ *  into CRLF and doubles the dot that starts a line (RFC 5321 section
+ *  4.5.2), so that the text cannot end the DATA command early.
+ *
+ *  The text is searched for line feeds with memchr and the runs that need
+ *  no change are kept as they are: they are either returned as views of the
+ *  text or copied once into the output. The data can be given in several
+ *  parts, the state of the current line is kept between the calls.
+ */
+class DATANORMALIZER_API DataNormalizer {
+ public:
+    /**
+     *  @brief  Construct a new DataNormalizer positioned at the start of a line.
+     *  @param pDotStuffing True to double the leading dots (DATA), false to
+     *  only convert the line endings (BDAT).
+     */
+    explicit DataNormalizer(bool pDotStuffing = true);
+
+    /** Return to the start of a line, as before the first part. */
+    void reset();
+
+    /**
+     *  @brief  Normalize a part of the text without copying it.
+     *  @param pData The part of the text.
+     *  @param pSegments Receive the views of the normalized text. They refer
+     *  to pData or to static strings, so pData must outlive them.
+     */
+    void normalize(std::string_view pData, std::vector<std::string_view> &pSegments);
+
+    /**
+     *  @brief  Normalize a part of the text by appending it to a buffer.
+     *  @param pData The part of the text.
+     *  @param pOutput The buffer that receives the normalized text.
+     */
+    void normalize(std::string_view pData, std::string &pOutput);
+
+    /** Indicate if a text is already normalized: all its line endings are
+     *  CRLF and no line starts with a dot that would need to be doubled. */
+    bool isNormalized(std::string_view pData) const;
+
+ private:
+    template <typename Sink>
+    void process(std::string_view pData, Sink &pSink);
+
+    bool mDotStuffing;
+    bool mAtLineStart;
+    bool mPreviousCarriageReturn;
+};
+}  // namespace jed_utils
+
+#endif
@@ -0,0 +1,132 @@
+#include "deliverythrottle.h"
+#include <algorithm>
+#include "stringutils.h"
+
+using namespace jed_utils;
+
+DeliveryThrottle::DeliveryThrottle(const DeliveryThrottleOptions &pOptions)
+    : mOptions(pOptions) {
+    // The limits are kept consistent so that a host can always progress
+    const double MIN_RATE = 0.001;
+    mOptions.MinRate = (std::max)(mOptions.MinRate, MIN_RATE);
+    mOptions.MaxRate = (std::max)(mOptions.MaxRate, mOptions.MinRate);
+    mOptions.InitialRate = (std::min)((std::max)(mOptions.InitialRate, mOptions.MinRate), mOptions.MaxRate);
+    mOptions.BurstSize = (std::max)(mOptions.BurstSize, 1.0);
+    mOptions.MinConcurrency = (std::max)(mOptions.MinConcurrency, static_cast<size_t>(1));
+    mOptions.MaxConcurrency = (std::max)(mOptions.MaxConcurrency, mOptions.MinConcurrency);
+    mOptions.InitialConcurrency = (std::min)((std::max)(mOptions.InitialConcurrency, mOptions.MinConcurrency), mOptions.MaxConcurrency);
+    mOptions.RateIncrease = (std::max)(mOptions.RateIncrease, 0.0);
+    if (mOptions.DecreaseFactor <= 0.0 || mOptions.DecreaseFactor >= 1.0) {
+        mOptions.DecreaseFactor = 0.5;
+    }
+}
+
+bool DeliveryThrottle::acquire(const char *pHost,
+        std::chrono::steady_clock::time_point pDeadline,
+        DeliveryPermit &pPermit) {
+    const std::string host { StringUtils::toLower(pHost != nullptr ? pHost : "") };
+    std::unique_lock<std::mutex> lock(mMutex);
+    HostState &state = getHostState(host);
+    while (true) {
+        const auto now = std::chrono::steady_clock::now();
+        refill(state, now);
+        auto wake_time = pDeadline;
+        if (state.activeCount < state.concurrencyLimit) {
+            if (state.tokens >= 1.0) {
+                state.tokens -= 1.0;
+                state.activeCount++;
+                pPermit.Host = host;
+                pPermit.Generation = state.generation;
+                return true;
+            }
+            // The next token is due at the current rate
+            const std::chrono::duration<double> token_delay { (1.0 - state.tokens) / state.rate };
+            wake_time = (std::min)(wake_time, now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(token_delay));
+        }
+        if (now >= pDeadline) {
+            return false;
+        }
+        // A release wakes the waits for a delivery slot
+        mPermitReleased.wait_until(lock, wake_time);
+    }
+}
+
+void DeliveryThrottle::release(const DeliveryPermit &pPermit, int pReturnCode) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        HostState &state = getHostState(pPermit.Host);
+        if (state.activeCount > 0) {
+            state.activeCount--;
+        }
+        if (isThrottlingError(pReturnCode)) {
+            // Only the first rejection of the deliveries started with the
+            // same limits decreases them
+            if (pPermit.Generation == state.generation) {
+                refill(state, std::chrono::steady_clock::now());
+                state.generation++;
+                state.rate = (std::max)(state.rate * mOptions.DecreaseFactor, mOptions.MinRate);
+                state.tokens = (std::min)(state.tokens, 0.0);
+                state.concurrencyLimit = (std::max)(static_cast<size_t>(static_cast<double>(state.concurrencyLimit) * mOptions.DecreaseFactor),
+                        mOptions.MinConcurrency);
+                state.acceptedCount = 0;
+            }
+        } else if (pReturnCode == 0) {
+            // The rate gains RateIncrease per second at the current rate and
+            // the concurrency gains one once each slot has been used
+            state.rate = (std::min)(state.rate + mOptions.RateIncrease / state.rate, mOptions.MaxRate);
+            if (++state.acceptedCount >= state.concurrencyLimit) {
+                state.acceptedCount = 0;
+                state.concurrencyLimit = (std::min)(state.concurrencyLimit + 1, mOptions.MaxConcurrency);
+            }
+        }
+    }
+    mPermitReleased.notify_all();
+}
+
+double DeliveryThrottle::getRate(const char *pHost) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const HostState *state = findHostState(pHost);
+    return state != nullptr ? state->rate : mOptions.InitialRate;
+}
+
+size_t DeliveryThrottle::getConcurrencyLimit(const char *pHost) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const HostState *state = findHostState(pHost);
+    return state != nullptr ? state->concurrencyLimit : mOptions.InitialConcurrency;
+}
+
+size_t DeliveryThrottle::getActiveCount(const char *pHost) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const HostState *state = findHostState(pHost);
+    return state != nullptr ? state->activeCount : 0;
+}
+
+bool DeliveryThrottle::isThrottlingError(int pReturnCode) {
+    // STATUS_CODE_SERVICE_NOT_AVAILABLE, STATUS_CODE_MAILBOX_BUSY,
+    // STATUS_CODE_LOCAL_ERROR_IN_PROCESSING and the other 4xx replies
+    return pReturnCode >= 400 && pReturnCode < 500;
+}
+
+DeliveryThrottle::HostState &DeliveryThrottle::getHostState(const std::string &pHost) {
+    auto state = mHosts.find(pHost);
+    if (state == mHosts.end()) {
+        HostState new_state;
+        new_state.rate = mOptions.InitialRate;
+        new_state.tokens = mOptions.BurstSize;
+        new_state.lastRefill = std::chrono::steady_clock::now();
+        new_state.concurrencyLimit = mOptions.InitialConcurrency;
+        state = mHosts.emplace(pHost, new_state).first;
+    }
+    return state->second;
+}
+
+const DeliveryThrottle::HostState *DeliveryThrottle::findHostState(const char *pHost) const {
+    auto state = mHosts.find(StringUtils::toLower(pHost != nullptr ? pHost : ""));
+    return state != mHosts.end() ? &state->second : nullptr;
+}
+
+void DeliveryThrottle::refill(HostState &pState, std::chrono::steady_clock::time_point pNow) const {
+    const std::chrono::duration<double> elapsed = pNow - pState.lastRefill;
+    pState.tokens = (std::min)(pState.tokens + elapsed.count() * pState.rate, mOptions.BurstSize);
+    pState.lastRefill = pNow;
+}
@@ -0,0 +1,127 @@
+#ifndef DELIVERYTHROTTLE_H
+#define DELIVERYTHROTTLE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define DELIVERYTHROTTLE_API __declspec(dllexport)
+    #else
+        #define DELIVERYTHROTTLE_API __declspec(dllimport)
+    #endif
+#else
+    #define DELIVERYTHROTTLE_API
+#endif
+
+namespace jed_utils {
+/** @brief The DeliveryThrottleOptions struct contains the limits applied by
+ *  a DeliveryThrottle to each host. */
+struct DeliveryThrottleOptions {
+    /** The rate, in messages per second, of a host not yet throttled. */
+    double InitialRate = 10.0;
+    /** The lowest rate reached after the decreases. */
+    double MinRate = 0.1;
+    /** The highest rate reached after the increases. */
+    double MaxRate = 1000.0;
+    /** The number of messages that can start at once after an idle period. */
+    double BurstSize = 5.0;
+    /** The number of parallel deliveries of a host not yet throttled. */
+    size_t InitialConcurrency = 2;
+    /** The lowest number of parallel deliveries. */
+    size_t MinConcurrency = 1;
+    /** The highest number of parallel deliveries. */
+    size_t MaxConcurrency = 16;
+    /** The rate gained per second of deliveries accepted at the current rate. */
+    double RateIncrease = 1.0;
+    /** The factor applied to the rate and to the concurrency when the host
+     *  replies with a transient error (4xx). */
+    double DecreaseFactor = 0.5;
+};
+
+/** @brief The DeliveryPermit struct is given by DeliveryThrottle::acquire
+ *  and returned to DeliveryThrottle::release once the delivery is done. */
+struct DeliveryPermit {
+    /** The host, in lowercase. */
+    std::string Host;
+    /** The number of decreases of the host when the permit was given. */
+    unsigned long long Generation = 0;
+};
+
+/** @brief The DeliveryThrottle class limits the rate and the number of
+ *  parallel deliveries to each destination host.
+ *
+ *  Each host has a token bucket that refills at its current rate and a
+ *  limit of parallel deliveries. Both grow additively while the host accepts
+ *  the messages and are multiplied by the decrease factor when it replies
+ *  with a transient error such as STATUS_CODE_SERVICE_NOT_AVAILABLE (AIMD).
+ *  The deliveries that were started before a decrease do not decrease the
+ *  limits again, so a burst of rejections halves them only once. The class
+ *  is thread-safe and can be shared by several queues.
+ */
+class DELIVERYTHROTTLE_API DeliveryThrottle {
+ public:
+    explicit DeliveryThrottle(const DeliveryThrottleOptions &pOptions = DeliveryThrottleOptions());
+
+    DeliveryThrottle(const DeliveryThrottle& other) = delete;
+    DeliveryThrottle& operator=(const DeliveryThrottle& other) = delete;
+
+    /**
+     *  @brief  Wait until a delivery to the host is allowed.
+     *  @param pHost The name of the host.
+     *  @param pDeadline The time after which the wait is abandoned.
+     *  @param pPermit Receive the permit to return to release.
+     *  @return True if the delivery is allowed, false if the deadline has
+     *  been reached.
+     */
+    bool acquire(const char *pHost,
+            std::chrono::steady_clock::time_point pDeadline,
+            DeliveryPermit &pPermit);
+
+    /**
+     *  @brief  Return a permit once the delivery is done and adapt the limits
+     *  of the host to the result.
+     *  @param pPermit The permit given by acquire.
+     *  @param pReturnCode The return code of the delivery.
+     */
+    void release(const DeliveryPermit &pPermit, int pReturnCode);
+
+    /** Return the current rate of the host in messages per second. */
+    double getRate(const char *pHost) const;
+
+    /** Return the current limit of parallel deliveries of the host. */
+    size_t getConcurrencyLimit(const char *pHost) const;
+
+    /** Return the number of deliveries to the host in progress. */
+    size_t getActiveCount(const char *pHost) const;
+
+    /** Indicate if a return code means that the host throttles the client. */
+    static bool isThrottlingError(int pReturnCode);
+
+ private:
+    struct HostState {
+        double rate;
+        double tokens;
+        std::chrono::steady_clock::time_point lastRefill;
+        size_t concurrencyLimit;
+        size_t activeCount = 0;
+        size_t acceptedCount = 0;
+        unsigned long long generation = 0;
+    };
+    HostState &getHostState(const std::string &pHost);
+    const HostState *findHostState(const char *pHost) const;
+    void refill(HostState &pState, std::chrono::steady_clock::time_point pNow) const;
+
+    DeliveryThrottleOptions mOptions;
+    mutable std::mutex mMutex;
+    std::condition_variable mPermitReleased;
+    std::map<std::string, HostState> mHosts;
+};
+}  // namespace jed_utils
+
+#endif
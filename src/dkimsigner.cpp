@@ -0,0 +1,323 @@
+#include "dkimsigner.h"
+#include <openssl/bio.h>
+#include <openssl/pem.h>
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include "base64.h"
+
+using namespace jed_utils;
+
+namespace {
+const size_t HASH_BUFFER_LENGTH = 16384;
+// Length of the folded lines of the b= tag value
+const size_t SIGNATURE_LINE_LENGTH = 72;
+
+bool isWhitespace(char pChar) {
+    return pChar == ' ' || pChar == '\t';
+}
+
+struct HeaderField {
+    std::string Name;
+    std::string_view Field;
+};
+
+// Split the header fields, each with its continuation lines
+std::vector<HeaderField> splitHeaderFields(std::string_view pHeaders) {
+    std::vector<HeaderField> fields;
+    size_t field_start = 0;
+    size_t position = 0;
+    while (position < pHeaders.size()) {
+        size_t line_end = pHeaders.find("\r\n", position);
+        if (line_end == std::string_view::npos) {
+            line_end = pHeaders.size();
+        }
+        if (line_end == position) {
+            // The blank line that ends the header fields
+            break;
+        }
+        if (isWhitespace(pHeaders[position]) && !fields.empty()) {
+            fields.back().Field = pHeaders.substr(field_start, line_end - field_start);
+        } else {
+            field_start = position;
+            const std::string_view line { pHeaders.substr(position, line_end - position) };
+            std::string name { line.substr(0, line.find(':')) };
+            while (!name.empty() && isWhitespace(name.back())) {
+                name.pop_back();
+            }
+            std::transform(name.begin(), name.end(), name.begin(), [](char pChar) {
+                    return static_cast<char>(std::tolower(static_cast<unsigned char>(pChar)));
+                    });
+            fields.push_back({ std::move(name), line });
+        }
+        position = line_end + 2;
+    }
+    return fields;
+}
+}  // namespace
+
+DkimKey::DkimKey(std::string_view pPem)
+    : mKey(nullptr),
+      mEd25519(false) {
+    if (pPem.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        throw std::invalid_argument("pem");
+    }
+    BIO *bio = BIO_new_mem_buf(pPem.data(), static_cast<int>(pPem.size()));
+    if (bio != nullptr) {
+        mKey = PEM_read_bio_PrivateKey(bio, nullptr, nullptr, nullptr);
+        BIO_free(bio);
+    }
+    const int key_type = mKey != nullptr ? EVP_PKEY_base_id(mKey) : EVP_PKEY_NONE;
+    mEd25519 = key_type == EVP_PKEY_ED25519;
+    if (key_type != EVP_PKEY_RSA && !mEd25519) {
+        EVP_PKEY_free(mKey);
+        throw std::invalid_argument("pem");
+    }
+}
+
+DkimKey::~DkimKey() {
+    EVP_PKEY_free(mKey);
+}
+
+const char *DkimKey::getAlgorithm() const {
+    return mEd25519 ? "ed25519-sha256" : "rsa-sha256";
+}
+
+bool DkimKey::sign(std::string_view pData, std::string &pSignature) const {
+    const auto *data = reinterpret_cast<const unsigned char *>(pData.data());
+    size_t data_length = pData.size();
+    // Ed25519 signs the SHA-256 hash of the data (RFC 8463 section 3)
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_length = 0;
+    if (mEd25519) {
+        if (EVP_Digest(data, data_length, digest, &digest_length, EVP_sha256(), nullptr) != 1) {
+            return false;
+        }
+        data = digest;
+        data_length = digest_length;
+    }
+    EVP_MD_CTX *context = EVP_MD_CTX_new();
+    if (context == nullptr) {
+        return false;
+    }
+    std::vector<unsigned char> signature;
+    size_t signature_length = 0;
+    bool signed_ok = EVP_DigestSignInit(context, nullptr, mEd25519 ? nullptr : EVP_sha256(), nullptr, mKey) == 1 &&
+        EVP_DigestSign(context, nullptr, &signature_length, data, data_length) == 1;
+    if (signed_ok) {
+        signature.resize(signature_length);
+        signed_ok = EVP_DigestSign(context, signature.data(), &signature_length, data, data_length) == 1;
+    }
+    EVP_MD_CTX_free(context);
+    if (!signed_ok) {
+        return false;
+    }
+    pSignature = Base64::Encode(signature.data(), signature_length);
+    return true;
+}
+
+DkimBodyHasher::DkimBodyHasher()
+    : mContext(EVP_MD_CTX_new()) {
+    if (mContext == nullptr || EVP_DigestInit_ex(mContext, EVP_sha256(), nullptr) != 1) {
+        EVP_MD_CTX_free(mContext);
+        throw std::runtime_error("Unable to initialize the SHA-256 hash");
+    }
+    mBuffer.reserve(HASH_BUFFER_LENGTH);
+}
+
+DkimBodyHasher::~DkimBodyHasher() {
+    EVP_MD_CTX_free(mContext);
+}
+
+void DkimBodyHasher::update(std::string_view pData) {
+    size_t position = 0;
+    while (position < pData.size()) {
+        const char current = pData[position];
+        if (mPreviousCarriageReturn) {
+            mPreviousCarriageReturn = false;
+            if (current == '\n') {
+                // The whitespace that ends a line is ignored
+                mPendingSpace = false;
+                mPendingLineBreakCount++;
+                position++;
+                continue;
+            }
+            appendCanonical(std::string_view("\r", 1));
+        }
+        if (current == '\r') {
+            mPreviousCarriageReturn = true;
+            position++;
+        } else if (isWhitespace(current)) {
+            mPendingSpace = true;
+            position++;
+        } else {
+            // The characters that are kept as they are, copied at once
+            size_t run_end = position + 1;
+            while (run_end < pData.size() && pData[run_end] != '\r' && !isWhitespace(pData[run_end])) {
+                run_end++;
+            }
+            appendCanonical(pData.substr(position, run_end - position));
+            position = run_end;
+        }
+    }
+}
+
+std::string DkimBodyHasher::finish() {
+    if (mPreviousCarriageReturn) {
+        appendCanonical(std::string_view("\r", 1));
+    }
+    // The empty lines that end the body are ignored and a body that is
+    // not empty ends with a line break
+    if (mContentWritten) {
+        mBuffer += "\r\n";
+    }
+    flush();
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_length = 0;
+    EVP_DigestFinal_ex(mContext, digest, &digest_length);
+    EVP_DigestInit_ex(mContext, EVP_sha256(), nullptr);
+    mPendingLineBreakCount = 0;
+    mPendingSpace = false;
+    mPreviousCarriageReturn = false;
+    mContentWritten = false;
+    return Base64::Encode(digest, digest_length);
+}
+
+void DkimBodyHasher::appendCanonical(std::string_view pContent) {
+    for (; mPendingLineBreakCount > 0; mPendingLineBreakCount--) {
+        mBuffer += "\r\n";
+    }
+    // A sequence of whitespace within a line is reduced to a single space
+    if (mPendingSpace) {
+        mBuffer += ' ';
+        mPendingSpace = false;
+    }
+    mBuffer.append(pContent);
+    mContentWritten = true;
+    if (mBuffer.size() >= HASH_BUFFER_LENGTH) {
+        flush();
+    }
+}
+
+void DkimBodyHasher::flush() {
+    EVP_DigestUpdate(mContext, mBuffer.data(), mBuffer.size());
+    mBuffer.clear();
+}
+
+DkimSigner::DkimSigner(std::string pDomain,
+        std::string pSelector,
+        std::shared_ptr<const DkimKey> pKey,
+        std::vector<std::string> pSignedHeaders)
+    : mDomain(std::move(pDomain)),
+      mSelector(std::move(pSelector)),
+      mKey(std::move(pKey)),
+      mSignedHeaders(std::move(pSignedHeaders)) {
+    if (mDomain.empty()) {
+        throw std::invalid_argument("domain");
+    }
+    if (mSelector.empty()) {
+        throw std::invalid_argument("selector");
+    }
+    if (mKey == nullptr) {
+        throw std::invalid_argument("key");
+    }
+    // The From field must be signed (RFC 6376 section 5.4)
+    if (std::find(mSignedHeaders.begin(), mSignedHeaders.end(), "from") == mSignedHeaders.end()) {
+        throw std::invalid_argument("signedHeaders");
+    }
+}
+
+const std::string &DkimSigner::getDomain() const {
+    return mDomain;
+}
+
+const std::string &DkimSigner::getSelector() const {
+    return mSelector;
+}
+
+bool DkimSigner::createSignatureField(std::string_view pHeaders,
+        std::string_view pBodyHash,
+        std::time_t pTimestamp,
+        std::string &pField) const {
+    const std::vector<HeaderField> fields { splitHeaderFields(pHeaders) };
+    // A name listed several times signs the instances of the field from
+    // the last one upwards (RFC 6376 section 5.4.2)
+    std::map<std::string, size_t> used_counts;
+    std::string signed_names;
+    std::string signed_data;
+    for (const std::string &name : mSignedHeaders) {
+        size_t &used_count = used_counts[name];
+        size_t skipped = 0;
+        for (auto field = fields.rbegin(); field != fields.rend(); ++field) {
+            if (field->Name != name || skipped++ < used_count) {
+                continue;
+            }
+            used_count++;
+            signed_data += canonicalizeHeaderField(field->Field);
+            signed_data += "\r\n";
+            signed_names += signed_names.empty() ? "" : ":";
+            signed_names += name;
+            break;
+        }
+    }
+
+    std::string field { "DKIM-Signature: v=1; a=" };
+    field.append(mKey->getAlgorithm()).append("; c=relaxed/relaxed; d=").append(mDomain)
+        .append("; s=").append(mSelector).append(";\r\n\tt=").append(std::to_string(pTimestamp))
+        .append("; h=").append(signed_names).append(";\r\n\tbh=").append(pBodyHash).append(";\r\n\tb=");
+    // The field itself is signed with an empty signature (RFC 6376 section 3.7)
+    signed_data += canonicalizeHeaderField(field);
+    std::string signature;
+    if (!mKey->sign(signed_data, signature)) {
+        return false;
+    }
+    for (size_t position = 0; position < signature.size(); position += SIGNATURE_LINE_LENGTH) {
+        if (position > 0) {
+            field += "\r\n\t";
+        }
+        field.append(signature, position, SIGNATURE_LINE_LENGTH);
+    }
+    field += "\r\n";
+    pField = std::move(field);
+    return true;
+}
+
+std::string DkimSigner::canonicalizeHeaderField(std::string_view pField) {
+    const size_t colon = pField.find(':');
+    std::string canonical;
+    canonical.reserve(pField.size());
+    // The name is in lowercase without the whitespace before the colon
+    for (const char current : pField.substr(0, colon)) {
+        canonical += static_cast<char>(std::tolower(static_cast<unsigned char>(current)));
+    }
+    while (!canonical.empty() && isWhitespace(canonical.back())) {
+        canonical.pop_back();
+    }
+    canonical += ':';
+    if (colon == std::string_view::npos) {
+        return canonical;
+    }
+    // The value is unfolded, its sequences of whitespace are reduced to a
+    // single space and the whitespace around it is removed
+    bool pending_space = false;
+    bool value_started = false;
+    for (const char current : pField.substr(colon + 1)) {
+        if (current == '\r' || current == '\n') {
+            continue;
+        }
+        if (isWhitespace(current)) {
+            pending_space = value_started;
+            continue;
+        }
+        if (pending_space) {
+            canonical += ' ';
+            pending_space = false;
+        }
+        canonical += current;
+        value_started = true;
+    }
+    return canonical;
+}
@@ -0,0 +1,162 @@
+#ifndef DKIMSIGNER_H
+#define DKIMSIGNER_H
+
+#include <openssl/evp.h>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define DKIMSIGNER_API __declspec(dllexport)
+    #else
+        #define DKIMSIGNER_API __declspec(dllimport)
+    #endif
+#else
+    #define DKIMSIGNER_API
+#endif
+
+namespace jed_utils {
+/** @brief The DkimKey class owns a private key that signs the messages,
+ *  RSA (rsa-sha256) or Ed25519 (ed25519-sha256, RFC 8463).
+ *
+ *  The key is parsed once when it is constructed and is never modified
+ *  afterwards, so it can be shared by any number of signers and threads.
+ */
+class DKIMSIGNER_API DkimKey {
+ public:
+    /**
+     *  @brief  Construct a new DkimKey from a private key in the PEM format.
+     *  @param pPem The PEM content, PKCS#1 or PKCS#8, unencrypted.
+     *  @throw std::invalid_argument pPem is not an RSA or an Ed25519 private key.
+     */
+    explicit DkimKey(std::string_view pPem);
+
+    /** Destructor of the DkimKey. */
+    ~DkimKey();
+
+    DkimKey(const DkimKey& other) = delete;
+    DkimKey& operator=(const DkimKey& other) = delete;
+
+    /** Return the signing algorithm of the key. Example: rsa-sha256 */
+    const char *getAlgorithm() const;
+
+    /**
+     *  @brief  Sign data.
+     *  @param pData The canonicalized header fields.
+     *  @param pSignature Receive the signature encoded in base64.
+     *  @return True for success, false if OpenSSL failed to sign.
+     */
+    bool sign(std::string_view pData, std::string &pSignature) const;
+
+ private:
+    EVP_PKEY *mKey;
+    bool mEd25519;
+};
+
+/** @brief The DkimBodyHasher computes the SHA-256 hash of a message body
+ *  with the relaxed canonicalization (RFC 6376 section 3.4.4) as the body
+ *  is written.
+ *
+ *  The body can be given in any number of parts: the whitespace and the
+ *  empty lines that may end the body are held back between the parts, so
+ *  nothing of the body is kept in memory.
+ */
+class DKIMSIGNER_API DkimBodyHasher {
+ public:
+    /** Construct a new DkimBodyHasher positioned at the start of the body. */
+    DkimBodyHasher();
+
+    /** Destructor of the DkimBodyHasher. */
+    ~DkimBodyHasher();
+
+    DkimBodyHasher(const DkimBodyHasher& other) = delete;
+    DkimBodyHasher& operator=(const DkimBodyHasher& other) = delete;
+
+    /** Canonicalize and hash a part of the body, as it is sent. */
+    void update(std::string_view pData);
+
+    /** Complete the hash and return it encoded in base64, the value of the
+     *  bh= tag. The hasher is then positioned at the start of a new body. */
+    std::string finish();
+
+ private:
+    void appendCanonical(std::string_view pContent);
+    void flush();
+
+    EVP_MD_CTX *mContext;
+    std::string mBuffer;
+    // Line breaks of the last lines, written once a character follows them
+    size_t mPendingLineBreakCount = 0;
+    bool mPendingSpace = false;
+    bool mPreviousCarriageReturn = false;
+    bool mContentWritten = false;
+};
+
+/** @brief The DkimSigner creates the DKIM-Signature header field of the
+ *  messages of a signing domain (RFC 6376).
+ *
+ *  The header fields and the body are canonicalized with the relaxed
+ *  algorithm (c=relaxed/relaxed). A signer is never modified once it is
+ *  constructed, so one instance can be given to all the clients that send
+ *  for the domain.
+ */
+class DKIMSIGNER_API DkimSigner {
+ public:
+    /**
+     *  @brief  Construct a new DkimSigner.
+     *  @param pDomain The signing domain, the d= tag. Example: example.com
+     *  @param pSelector The selector of the public key in the DNS, the s=
+     *  tag. Example: mail2024
+     *  @param pKey The private key.
+     *  @param pSignedHeaders The names of the header fields to sign, in
+     *  lowercase. Those that are absent from a message are not signed.
+     *  Default: from, to, cc, subject, content-type
+     *  @throw std::invalid_argument pDomain or pSelector is empty, pKey is
+     *  null or pSignedHeaders does not contain from.
+     */
+    DkimSigner(std::string pDomain,
+            std::string pSelector,
+            std::shared_ptr<const DkimKey> pKey,
+            std::vector<std::string> pSignedHeaders = { "from", "to", "cc", "subject", "content-type" });
+
+    /** Return the signing domain. */
+    const std::string &getDomain() const;
+
+    /** Return the selector of the public key. */
+    const std::string &getSelector() const;
+
+    /**
+     *  @brief  Create the DKIM-Signature header field of a message.
+     *  @param pHeaders The header fields of the message as they are sent,
+     *  each ending with CRLF. The blank line that ends them is optional.
+     *  @param pBodyHash The hash of the body returned by DkimBodyHasher::finish.
+     *  @param pTimestamp The signature time, the t= tag.
+     *  @param pField Receive the field, folded and ending with CRLF, to
+     *  insert before the other header fields.
+     *  @return True for success, false if the key failed to sign.
+     */
+    bool createSignatureField(std::string_view pHeaders,
+            std::string_view pBodyHash,
+            std::time_t pTimestamp,
+            std::string &pField) const;
+
+    /**
+     *  @brief  Return a header field canonicalized with the relaxed
+     *  algorithm (RFC 6376 section 3.4.2), without its ending CRLF.
+     *  @param pField The field, possibly folded.
+     */
+    static std::string canonicalizeHeaderField(std::string_view pField);
+
+ private:
+    std::string mDomain;
+    std::string mSelector;
+    std::shared_ptr<const DkimKey> mKey;
+    std::vector<std::string> mSignedHeaders;
+};
+}  // namespace jed_utils
+
+#endif
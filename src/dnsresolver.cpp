@@ -0,0 +1,120 @@
+#include "dnsresolver.h"
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+    #include <WinSock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <netdb.h>
+    #include <sys/socket.h>
+    #include <sys/types.h>
+#endif
+
+using namespace jed_utils;
+
+DnsResolver::DnsResolver(unsigned int pCacheTtlInSeconds, unsigned int pNegativeCacheTtlInSeconds)
+    : mCacheTtl(pCacheTtlInSeconds),
+      mNegativeCacheTtl(pNegativeCacheTtlInSeconds) {
+}
+
+DnsResolver &DnsResolver::getDefault() {
+    static DnsResolver default_resolver;
+    return default_resolver;
+}
+
+int DnsResolver::resolve(const char *pServerName, unsigned int pPort, std::vector<ResolvedAddress> &pAddresses) {
+    pAddresses.clear();
+    if (pServerName == nullptr) {
+        return EAI_NONAME;
+    }
+    const std::string key { std::string(pServerName) + ":" + std::to_string(pPort) };
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto entry = mCache.find(key);
+        if (entry != mCache.end()) {
+            if (std::chrono::steady_clock::now() < entry->second.expiration) {
+                pAddresses = entry->second.addresses;
+                return entry->second.errorCode;
+            }
+            mCache.erase(entry);
+        }
+    }
+
+    // The lock is not held during the resolution, which can take seconds
+    int error_code = resolveUncached(pServerName, pPort, pAddresses);
+    std::lock_guard<std::mutex> lock(mMutex);
+    // EAI_AGAIN is a transient failure that must not be cached
+    const std::chrono::seconds ttl = error_code == 0 ? mCacheTtl : (error_code == EAI_AGAIN ? std::chrono::seconds(0) : mNegativeCacheTtl);
+    if (ttl.count() > 0) {
+        CacheEntry entry;
+        entry.errorCode = error_code;
+        entry.addresses = pAddresses;
+        entry.expiration = std::chrono::steady_clock::now() + ttl;
+        mCache[key] = std::move(entry);
+    }
+    return error_code;
+}
+
+void DnsResolver::clearCache() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCache.clear();
+}
+
+size_t DnsResolver::getCacheEntryCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCache.size();
+}
+
+unsigned int DnsResolver::getCacheTtl() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return static_cast<unsigned int>(mCacheTtl.count());
+}
+
+void DnsResolver::setCacheTtl(unsigned int pCacheTtlInSeconds) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCacheTtl = std::chrono::seconds(pCacheTtlInSeconds);
+}
+
+int DnsResolver::resolveUncached(const char *pServerName, unsigned int pPort, std::vector<ResolvedAddress> &pAddresses) {
+    struct addrinfo hints {};
+    hints.ai_family = AF_UNSPEC;  // use IPv4 or IPv6, whichever
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *result = nullptr;
+    int error_code = getaddrinfo(pServerName, std::to_string(pPort).c_str(), &hints, &result);
+    if (error_code != 0) {
+        return error_code;
+    }
+
+    // Interleave the families (RFC 8305 section 4)
+    std::vector<ResolvedAddress> first_family;
+    std::vector<ResolvedAddress> other_families;
+    for (struct addrinfo *item = result; item != nullptr; item = item->ai_next) {
+        if (item->ai_addr == nullptr || static_cast<size_t>(item->ai_addrlen) > sizeof(ResolvedAddress::Address)) {
+            continue;
+        }
+        ResolvedAddress address;
+        address.Family = item->ai_family;
+        address.SocketType = item->ai_socktype;
+        address.Protocol = item->ai_protocol;
+        address.AddressLength = static_cast<size_t>(item->ai_addrlen);
+        memcpy(address.Address.data(), item->ai_addr, address.AddressLength);
+        if (first_family.empty() || first_family.front().Family == address.Family) {
+            first_family.push_back(address);
+        } else {
+            other_families.push_back(address);
+        }
+    }
+    freeaddrinfo(result);
+
+    pAddresses.reserve(first_family.size() + other_families.size());
+    for (size_t index = 0; index < first_family.size() || index < other_families.size(); index++) {
+        if (index < first_family.size()) {
+            pAddresses.push_back(first_family[index]);
+        }
+        if (index < other_families.size()) {
+            pAddresses.push_back(other_families[index]);
+        }
+    }
+    return pAddresses.empty() ? EAI_NONAME : 0;
+}
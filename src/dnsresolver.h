@@ -0,0 +1,108 @@
+#ifndef DNSRESOLVER_H
+#define DNSRESOLVER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define DNSRESOLVER_API __declspec(dllexport)
+    #else
+        #define DNSRESOLVER_API __declspec(dllimport)
+    #endif
+#else
+    #define DNSRESOLVER_API
+#endif
+
+namespace jed_utils {
+/** @brief The ResolvedAddress struct contains one socket address returned
+ *  by the resolution of a server name.
+ */
+struct ResolvedAddress {
+    /** The address family (AF_INET or AF_INET6). */
+    int Family = 0;
+    /** The socket type and protocol to pass to socket(). */
+    int SocketType = 0;
+    int Protocol = 0;
+    /** The bytes of the sockaddr structure and their number. */
+    std::array<unsigned char, 128> Address {};
+    size_t AddressLength = 0;
+};
+
+/** @brief The DnsResolver class resolves server names with getaddrinfo and
+ *  keeps the results in a thread-safe, in-process cache.
+ *
+ *  getaddrinfo does not report the TTL of the records, so the entries
+ *  expire after a configurable duration. Failed resolutions are cached for
+ *  a shorter duration.
+ */
+class DNSRESOLVER_API DnsResolver {
+ public:
+    /**
+     *  @brief  Construct a new DnsResolver.
+     *  @param pCacheTtlInSeconds The number of seconds a successful
+     *  resolution is kept. 0 disables the cache.
+     *  Default: 60 seconds
+     *  @param pNegativeCacheTtlInSeconds The number of seconds a failed
+     *  resolution is kept.
+     *  Default: 5 seconds
+     */
+    explicit DnsResolver(unsigned int pCacheTtlInSeconds = 60,
+            unsigned int pNegativeCacheTtlInSeconds = 5);
+
+    DnsResolver(const DnsResolver& other) = delete;
+    DnsResolver& operator=(const DnsResolver& other) = delete;
+
+    /** Return the process-wide resolver used by the SMTP clients. */
+    static DnsResolver &getDefault();
+
+    /**
+     *  @brief  Resolve a server name and port into stream socket addresses.
+     *  The addresses are ordered for Happy Eyeballs (RFC 8305): the families
+     *  alternate, starting with the family of the first address returned
+     *  by getaddrinfo.
+     *  @param pServerName The name or the numeric address of the server.
+     *  @param pPort The server port number.
+     *  @param pAddresses Receive the addresses.
+     *  @return 0 for success, otherwise the getaddrinfo error code.
+     */
+    int resolve(const char *pServerName, unsigned int pPort, std::vector<ResolvedAddress> &pAddresses);
+
+    /** Discard all the cached resolutions. */
+    void clearCache();
+
+    /** Return the number of resolutions in the cache, including expired ones. */
+    size_t getCacheEntryCount() const;
+
+    /** Return the number of seconds a successful resolution is kept. */
+    unsigned int getCacheTtl() const;
+
+    /**
+     *  @brief  Set the number of seconds a successful resolution is kept.
+     *  @param pCacheTtlInSeconds The duration in seconds. 0 disables the cache.
+     */
+    void setCacheTtl(unsigned int pCacheTtlInSeconds);
+
+ private:
+    struct CacheEntry {
+        int errorCode = 0;
+        std::vector<ResolvedAddress> addresses;
+        std::chrono::steady_clock::time_point expiration;
+    };
+
+    static int resolveUncached(const char *pServerName, unsigned int pPort, std::vector<ResolvedAddress> &pAddresses);
+
+    std::chrono::seconds mCacheTtl;
+    std::chrono::seconds mNegativeCacheTtl;
+    mutable std::mutex mMutex;
+    std::map<std::string, CacheEntry> mCache;
+};
+}  // namespace jed_utils
+
+#endif
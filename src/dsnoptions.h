@@ -0,0 +1,40 @@
+#ifndef DSNOPTIONS_H
+#define DSNOPTIONS_H
+
+#include <string>
+
+namespace jed_utils {
+/** @brief The DsnReturn enum indicates what a delivery status notification
+ *  of failure contains (RET parameter of RFC 3461). */
+enum class DsnReturn {
+    // The server chooses
+    Default,
+    // The whole message
+    Full,
+    // The header fields of the message only
+    Headers
+};
+
+/** @brief The DsnOptions struct contains the delivery status notifications
+ *  requested from the server (RFC 3461).
+ *
+ *  The parameters are only sent to the servers that advertise DSN in their
+ *  EHLO response. The notify flags apply to every recipient of the
+ *  envelope; when none is set, the server applies its default.
+ */
+struct DsnOptions {
+    // NOTIFY=SUCCESS, FAILURE or DELAY, any combination
+    bool NotifySuccess = false;
+    bool NotifyFailure = false;
+    bool NotifyDelay = false;
+    // NOTIFY=NEVER, which excludes the other flags
+    bool NotifyNever = false;
+    // RET parameter of the MAIL FROM command
+    DsnReturn Return = DsnReturn::Default;
+    // ENVID parameter, an identifier of the message returned in the
+    // notifications. Encoded as xtext when it is sent. Empty to omit it.
+    std::string EnvelopeId;
+};
+}  // namespace jed_utils
+
+#endif
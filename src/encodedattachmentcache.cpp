@@ -0,0 +1,125 @@
+#include "encodedattachmentcache.h"
+#include "base64.h"
+
+using namespace jed_utils;
+
+const size_t EncodedAttachmentCache::DEFAULT_CAPACITY;
+
+EncodedAttachmentCache::EncodedAttachmentCache(size_t pCapacity)
+    : mCapacity(pCapacity) {
+}
+
+int EncodedAttachmentCache::streamBase64EncodedFile(const Attachment &pAttachment,
+        const std::function<int(const std::string &pEncodedBlock)> &pWriter) {
+    std::shared_ptr<const std::string> encoded;
+    int find_ret_code = find(pAttachment, encoded);
+    if (find_ret_code != 0) {
+        return find_ret_code;
+    }
+    if (encoded == nullptr) {
+        return pAttachment.streamBase64EncodedFile(pWriter);
+    }
+    return encoded->empty() ? 0 : pWriter(*encoded);
+}
+
+std::shared_ptr<const std::string> EncodedAttachmentCache::getEncodedContent(const Attachment &pAttachment) {
+    std::shared_ptr<const std::string> encoded;
+    find(pAttachment, encoded);
+    return encoded;
+}
+
+size_t EncodedAttachmentCache::getCapacity() const {
+    return mCapacity;
+}
+
+size_t EncodedAttachmentCache::getSize() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSize;
+}
+
+size_t EncodedAttachmentCache::getEntryCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+size_t EncodedAttachmentCache::getHitCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mHitCount;
+}
+
+size_t EncodedAttachmentCache::getMissCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMissCount;
+}
+
+void EncodedAttachmentCache::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.clear();
+    mIndex.clear();
+    mSize = 0;
+}
+
+int EncodedAttachmentCache::find(const Attachment &pAttachment, std::shared_ptr<const std::string> &pEncoded) {
+    pEncoded = nullptr;
+    const std::string key { pAttachment.getCacheKey() };
+    if (key.empty()) {
+        return 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto index_item = mIndex.find(key);
+        if (index_item != mIndex.end()) {
+            mEntries.splice(mEntries.begin(), mEntries, index_item->second);
+            mHitCount++;
+            pEncoded = index_item->second->second;
+            return 0;
+        }
+    }
+
+    // The content is encoded outside of the lock. The lines are wrapped the
+    // same way as when the attachment is encoded by blocks.
+    const auto content_size = pAttachment.getSize();
+    if (!content_size.has_value()) {
+        return 0;
+    }
+    const size_t LINE_INPUT_LENGTH = 57;
+    const size_t line_count = (*content_size + LINE_INPUT_LENGTH - 1) / LINE_INPUT_LENGTH;
+    const size_t encoded_size = Base64::EncodedLength(*content_size) + (line_count > 0 ? 2 * (line_count - 1) : 0);
+    if (encoded_size + key.size() > mCapacity) {
+        return 0;
+    }
+    auto encoded = std::make_shared<std::string>();
+    encoded->reserve(encoded_size);
+    int stream_ret_code = pAttachment.streamBase64EncodedFile([&encoded](const std::string &pEncodedBlock) {
+        encoded->append(pEncodedBlock);
+        return 0;
+    });
+    if (stream_ret_code != 0) {
+        return stream_ret_code;
+    }
+    pEncoded = encoded;
+    insert(key, pEncoded);
+    return 0;
+}
+
+void EncodedAttachmentCache::insert(const std::string &pKey, const std::shared_ptr<const std::string> &pEncoded) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMissCount++;
+    // Another thread may have added the same content in the meantime
+    if (mIndex.find(pKey) != mIndex.end()) {
+        return;
+    }
+    mEntries.emplace_front(pKey, pEncoded);
+    mIndex.emplace(pKey, mEntries.begin());
+    mSize += pKey.size() + pEncoded->size();
+    evict();
+}
+
+void EncodedAttachmentCache::evict() {
+    while (mSize > mCapacity && !mEntries.empty()) {
+        const Entry &entry = mEntries.back();
+        mSize -= entry.first.size() + entry.second->size();
+        mIndex.erase(entry.first);
+        mEntries.pop_back();
+    }
+}
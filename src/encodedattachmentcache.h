@@ -0,0 +1,114 @@
+#ifndef ENCODEDATTACHMENTCACHE_H
+#define ENCODEDATTACHMENTCACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "attachment.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define ENCODEDATTACHMENTCACHE_API __declspec(dllexport)
+    #else
+        #define ENCODEDATTACHMENTCACHE_API __declspec(dllimport)
+    #endif
+#else
+    #define ENCODEDATTACHMENTCACHE_API
+#endif
+
+namespace jed_utils {
+/** @brief The EncodedAttachmentCache keeps the base64 encoding of the
+ *  attachments sent repeatedly, for instance a logo or the terms attached to
+ *  every message of a bulk send.
+ *
+ *  The attachments are identified by the key of their source: the path, the
+ *  modification time and the size of a file, or the SHA-256 hash of a
+ *  content in memory. The encoded contents are wrapped in lines of 76
+ *  characters and are sent as is. When the size of the cache exceeds its
+ *  capacity, the least recently used contents are evicted.
+ *
+ *  The cache is thread-safe and can be shared by several clients and
+ *  MimeWriter objects. A content being sent stays valid even if it is
+ *  evicted in the meantime.
+ */
+class ENCODEDATTACHMENTCACHE_API EncodedAttachmentCache {
+ public:
+    /** The default capacity of the cache in bytes. */
+    static const size_t DEFAULT_CAPACITY = 64 * 1024 * 1024;
+
+    /**
+     *  @brief  Construct a new empty EncodedAttachmentCache.
+     *  @param pCapacity The maximum size of the encoded contents kept, in
+     *  bytes. A larger content is encoded each time it is sent.
+     */
+    explicit EncodedAttachmentCache(size_t pCapacity = DEFAULT_CAPACITY);
+
+    EncodedAttachmentCache(const EncodedAttachmentCache &) = delete;
+    EncodedAttachmentCache &operator=(const EncodedAttachmentCache &) = delete;
+
+    /**
+     *  @brief  Give the base64 encoding of an attachment to a writer, from
+     *  the cache when it is present. An attachment that is absent is encoded
+     *  and added to the cache, an attachment that cannot be identified is
+     *  encoded by blocks.
+     *  @param pAttachment The attachment.
+     *  @param pWriter The function called with the encoded content. It
+     *  returns 0 to continue or an error code to stop the encoding.
+     *  @return Same as Attachment::streamBase64EncodedFile.
+     */
+    int streamBase64EncodedFile(const Attachment &pAttachment,
+            const std::function<int(const std::string &pEncodedBlock)> &pWriter);
+
+    /**
+     *  @brief  Return the base64 encoding of an attachment, from the cache
+     *  when it is present.
+     *  @param pAttachment The attachment.
+     *  @return The encoded content or nullptr if the attachment cannot be
+     *  read, cannot be identified or is larger than the capacity.
+     */
+    std::shared_ptr<const std::string> getEncodedContent(const Attachment &pAttachment);
+
+    /** Return the capacity of the cache in bytes. */
+    size_t getCapacity() const;
+
+    /** Return the size of the encoded contents kept, in bytes. */
+    size_t getSize() const;
+
+    /** Return the number of encoded contents kept. */
+    size_t getEntryCount() const;
+
+    /** Return the number of attachments found in the cache. */
+    size_t getHitCount() const;
+
+    /** Return the number of attachments encoded and added to the cache. */
+    size_t getMissCount() const;
+
+    /** Discard the encoded contents. */
+    void clear();
+
+ private:
+    // Return 0 with a null content if the attachment is not cached
+    int find(const Attachment &pAttachment, std::shared_ptr<const std::string> &pEncoded);
+    void insert(const std::string &pKey, const std::shared_ptr<const std::string> &pEncoded);
+    void evict();
+
+    using Entry = std::pair<std::string, std::shared_ptr<const std::string>>;
+
+    mutable std::mutex mMutex;
+    size_t mCapacity;
+    size_t mSize = 0;
+    size_t mHitCount = 0;
+    size_t mMissCount = 0;
+    // The most recently used entry is at the front
+    std::list<Entry> mEntries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> mIndex;
+};
+}  // namespace jed_utils
+
+#endif
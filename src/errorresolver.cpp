@@ -1,192 +1,135 @@
 #include "errorresolver.h"
+#include <algorithm>
 #include <cstddef>
-#include <cstring>
-#include <string>
+#include <iterator>
 #include "smtpclienterrors.h"
 #include "socketerrors.h"
 #include "sslerrors.h"
 
 using namespace jed_utils;
 
-ErrorResolver::ErrorResolver(int pErrorCode)
-    : mErrorCode(pErrorCode) {
-    std::string errorMessage = "";
-    switch (mErrorCode) {
-        case SOCKET_INIT_SESSION_CREATION_ERROR:
-            errorMessage = "Unable to create the socket";
-            break;
-        case SOCKET_INIT_SESSION_CONNECT_ERROR:
-            errorMessage = "Unable to connect to the socket";
-            break;
-        case SOCKET_INIT_SESSION_CONNECT_TIMEOUT:
-            errorMessage = "The connection attempt has timed out";
-            break;
-        case SOCKET_INIT_SESSION_WINSOCKET_STARTUP_ERROR:
-            errorMessage = "Unable to start WSA (Winsock)";
-            break;
-        case SOCKET_INIT_SESSION_WINSOCKET_GETADDRINFO_ERROR:
-            errorMessage = "Unable to get address info (Winsock)";
-            break;
-        case SOCKET_INIT_SESSION_GETHOSTBYNAME_ERROR:
-            errorMessage = "Unable to get host by name";
-            break;
-        case SOCKET_INIT_SESSION_FCNTL_GET_ERROR:
-            errorMessage = "Unable to get socket file descriptor status flags";
-            break;
-        case SOCKET_INIT_SESSION_FCNTL_SET_ERROR:
-            errorMessage = "Unable to set socket file descriptor status flags";
-            break;
-        case SOCKET_INIT_SESSION_GET_SOCKET_OPTIONS_ERROR:
-            errorMessage = "Unable to get socket options";
-            break;
-        case SOCKET_INIT_SESSION_DELAYED_CONNECTION_ERROR:
-            errorMessage = "Error in delayed connection";
-            break;
-        case SOCKET_INIT_CLIENT_SEND_EHLO_ERROR:
-            errorMessage = "Unable to send the EHLO command";
-            break;
-        case SOCKET_INIT_CLIENT_SEND_EHLO_TIMEOUT:
-            errorMessage = "The EHLO command has timed out";
-            break;
-        case SOCKET_INIT_CLIENT_SEND_STARTTLS_ERROR:
-            errorMessage = "Unable to send the STARTTLS command";
-            break;
-        case SOCKET_INIT_CLIENT_SEND_STARTTLS_TIMEOUT:
-            errorMessage = "The STARTTLS command has timed out";
-            break;
-        case SSL_CLIENT_STARTTLS_INITSSLCTX_ERROR:
-            errorMessage = "Unable to initialize the SSL Context";
-            break;
-        case SSL_CLIENT_STARTTLS_BIONEWSSLCONNECT_ERROR:
-            errorMessage = "Unable to create the SSL BIO";
-            break;
-        case SSL_CLIENT_STARTTLS_WIN_CERTOPENSYSTEMSTORE_ERROR:
-            errorMessage = "Unable to open the Windows Certificate System Store";
-            break;
-        case SSL_CLIENT_STARTTLS_CTX_SET_DEFAULT_VERIFY_PATHS_ERROR:
-            errorMessage = "Unable to open the specifies that the default locations from which CA certificates are loaded";
-            break;
-        case SSL_CLIENT_STARTTLS_BIO_CONNECT_ERROR:
-            errorMessage = "Unable to connect SSL BIO";
-            break;
-        case SSL_CLIENT_STARTTLS_BIO_HANDSHAKE_ERROR:
-            errorMessage = "Unable to handshake with SSL BIO";
-            break;
-        case SSL_CLIENT_STARTTLS_GET_CERTIFICATE_ERROR:
-            errorMessage = "Unable to get peer certificate";
-            break;
-        case SSL_CLIENT_STARTTLS_VERIFY_RESULT_ERROR:
-            errorMessage = "Unable to verify the result of chain verification";
-            break;
-        case SSL_CLIENT_INITSECURECLIENT_ERROR:
-            errorMessage = "Unable to EHLO the server via the secure channel";
-            break;
-        case SSL_CLIENT_INITSECURECLIENT_TIMEOUT:
-            errorMessage = "The EHLO command via the secure channel timed out";
-            break;
-        case CLIENT_AUTHENTICATE_ERROR:
-            errorMessage = "Unable to authenticate with the credentials provided";
-            break;
-        case CLIENT_AUTHENTICATE_TIMEOUT:
-            errorMessage = "The authentication to the server has timed out";
-            break;
-        case CLIENT_AUTHENTICATE_NONEED:
-            errorMessage = "The authentication is not needed on the server";
-            break;
-        case CLIENT_AUTHENTICATION_METHOD_NOTSUPPORTED:
-            errorMessage = "The authentication method selected is not supported by the server";
-            break;
-        case CLIENT_SENDMAIL_MAILFROM_ERROR:
-            errorMessage = "The MAIL FROM command return an error";
-            break;
-        case CLIENT_SENDMAIL_MAILFROM_TIMEOUT:
-            errorMessage = "The MAIL FROM command timed out";
-            break;
-        case CLIENT_SENDMAIL_RCPTTO_ERROR:
-            errorMessage = "The RCPT TO command return an error";
-            break;
-        case CLIENT_SENDMAIL_RCPTTO_TIMEOUT:
-            errorMessage = "The RCPT TO command timed out";
-            break;
-        case CLIENT_SENDMAIL_DATA_ERROR:
-            errorMessage = "The DATA command return an error";
-            break;
-        case CLIENT_SENDMAIL_DATA_TIMEOUT:
-            errorMessage = "The DATA command timed out";
-            break;
-        case CLIENT_SENDMAIL_HEADERFROM_ERROR:
-            errorMessage = "The From header command return an error";
-            break;
-        case CLIENT_SENDMAIL_HEADERTOANDCC_ERROR:
-            errorMessage = "The To and CC header command return an error";
-            break;
-        case CLIENT_SENDMAIL_HEADERSUBJECT_ERROR:
-            errorMessage = "The Subject header command return an error";
-            break;
-        case CLIENT_SENDMAIL_HEADERCONTENTTYPE_ERROR:
-            errorMessage = "The Content type header command return an error";
-            break;
-        case CLIENT_SENDMAIL_BODYPART_ERROR:
-            errorMessage = "The Body part return an error";
-            break;
-        case CLIENT_SENDMAIL_BODY_ERROR:
-            errorMessage = "The Body command return an error";
-            break;
-        case CLIENT_SENDMAIL_END_DATA_ERROR:
-            errorMessage = "The End data command return an error";
-            break;
-        case CLIENT_SENDMAIL_END_DATA_TIMEOUT:
-            errorMessage = "The End data command timed out";
-            break;
-        case CLIENT_SENDMAIL_QUIT_ERROR:
-            errorMessage = "The QUIT command return an error";
-            break;
-        case SMTPSERVER_AUTHENTICATIONREQUIRED_ERROR:
-            errorMessage = "Authentication required";
-            break;
-        case SMTPSERVER_AUTHENTICATIONTOOWEAK_ERROR:
-            errorMessage = "Authentication mechanism is too weak";
-            break;
-        case SMTPSERVER_CREDENTIALSINVALID_ERROR:
-            errorMessage = "Authentication credentials invalid";
-            break;
-        case SMTPSERVER_ENCRYPTIONREQUIREDFORAUTH_ERROR:
-            errorMessage = "Encryption required for requested authentication mechanism";
-            break;
-        default:
-            errorMessage = "No message correspond to this error code";
+namespace {
+struct ErrorDescription {
+    int Code;
+    ErrorCategory Category;
+    std::string_view Message;
+};
+
+constexpr std::string_view NO_MESSAGE = "No message correspond to this error code";
+
+// Sorted by code for the binary search of findErrorDescription
+constexpr ErrorDescription ERROR_DESCRIPTIONS[] = {
+    { CLIENT_SPOOL_CORRUPT_RECORD_ERROR, ErrorCategory::Permanent, "A record of the mail spool cannot be parsed, it has been dropped" },
+    { CLIENT_SENDMAIL_IDNA_CONVERSION_ERROR, ErrorCategory::Permanent, "Unable to convert the domain of an address to its ASCII form" },
+    { CLIENT_SENDMAIL_SMTPUTF8_NOT_SUPPORTED_ERROR, ErrorCategory::Permanent, "The server does not support the internationalized email addresses (SMTPUTF8)" },
+    { CLIENT_OPERATION_CANCELLED_ERROR, ErrorCategory::Transient, "The operation has been cancelled" },
+    { CLIENT_OPERATION_DEADLINE_EXCEEDED_ERROR, ErrorCategory::Transport, "The operation has not completed before its deadline" },
+    { CLIENT_DKIM_SIGNATURE_ERROR, ErrorCategory::Permanent, "Unable to create the DKIM signature of the message" },
+    { CLIENT_TEMPLATE_FIELD_ERROR, ErrorCategory::Permanent, "A merge field of the message template has no value" },
+    { CLIENT_AUTHENTICATE_TOKEN_ERROR, ErrorCategory::Authentication, "Unable to obtain the OAuth 2.0 access token" },
+    { CLIENT_SENDMAIL_MESSAGE_SIZE_EXCEEDED_ERROR, ErrorCategory::Permanent, "The message exceeds the maximum size accepted by the server" },
+    { CLIENT_SENDMAIL_BDAT_TIMEOUT, ErrorCategory::Transport, "The BDAT command timed out" },
+    { CLIENT_SENDMAIL_BDAT_ERROR, ErrorCategory::Transport, "The BDAT command return an error" },
+    { CLIENT_SPOOL_EMPTY_ERROR, ErrorCategory::Transient, "The mail spool has no pending message" },
+    { CLIENT_SPOOL_IO_ERROR, ErrorCategory::Transient, "Unable to read or write the spool files" },
+    { CLIENT_QUEUE_STOPPED_ERROR, ErrorCategory::Transient, "The mail queue has been stopped" },
+    { CLIENT_QUEUE_FULL_ERROR, ErrorCategory::Transient, "The mail queue is full" },
+    { CLIENT_DELIVERY_INVALID_DOMAIN_ERROR, ErrorCategory::Permanent, "The recipient address has no domain" },
+    { CLIENT_DELIVERY_NULL_MX_ERROR, ErrorCategory::Permanent, "The domain does not accept email (null MX)" },
+    { CLIENT_DELIVERY_MX_LOOKUP_ERROR, ErrorCategory::Transient, "Unable to find the mail exchangers of the domain" },
+    { CLIENT_SESSION_NOT_OPENED_ERROR, ErrorCategory::Transport, "No persistent session is opened with the server" },
+    { CLIENT_SESSION_NOOP_TIMEOUT, ErrorCategory::Transport, "The NOOP command timed out" },
+    { CLIENT_SESSION_NOOP_ERROR, ErrorCategory::Transport, "The NOOP command return an error" },
+    { CLIENT_SENDMAIL_RSET_TIMEOUT, ErrorCategory::Transport, "The RSET command timed out" },
+    { CLIENT_SENDMAIL_RSET_ERROR, ErrorCategory::Transport, "The RSET command return an error" },
+    { CLIENT_SENDMAIL_QUIT_ERROR, ErrorCategory::Transport, "The QUIT command return an error" },
+    { CLIENT_SENDMAIL_END_DATA_TIMEOUT, ErrorCategory::Transport, "The End data command timed out" },
+    { CLIENT_SENDMAIL_END_DATA_ERROR, ErrorCategory::Transport, "The End data command return an error" },
+    { CLIENT_SENDMAIL_BODY_ERROR, ErrorCategory::Transport, "The Body command return an error" },
+    { CLIENT_SENDMAIL_BODYPART_ERROR, ErrorCategory::Transport, "The Body part return an error" },
+    { CLIENT_SENDMAIL_HEADERCONTENTTYPE_ERROR, ErrorCategory::Transport, "The Content type header command return an error" },
+    { CLIENT_SENDMAIL_HEADERSUBJECT_ERROR, ErrorCategory::Transport, "The Subject header command return an error" },
+    { CLIENT_SENDMAIL_HEADERTOANDCC_ERROR, ErrorCategory::Transport, "The To and CC header command return an error" },
+    { CLIENT_SENDMAIL_HEADERFROM_ERROR, ErrorCategory::Transport, "The From header command return an error" },
+    { CLIENT_SENDMAIL_DATA_TIMEOUT, ErrorCategory::Transport, "The DATA command timed out" },
+    { CLIENT_SENDMAIL_DATA_ERROR, ErrorCategory::Transport, "The DATA command return an error" },
+    { CLIENT_SENDMAIL_RCPTTO_TIMEOUT, ErrorCategory::Transport, "The RCPT TO command timed out" },
+    { CLIENT_SENDMAIL_RCPTTO_ERROR, ErrorCategory::Transport, "The RCPT TO command return an error" },
+    { CLIENT_SENDMAIL_MAILFROM_TIMEOUT, ErrorCategory::Transport, "The MAIL FROM command timed out" },
+    { CLIENT_SENDMAIL_MAILFROM_ERROR, ErrorCategory::Transport, "The MAIL FROM command return an error" },
+    { CLIENT_AUTHENTICATION_METHOD_NOTSUPPORTED, ErrorCategory::Authentication, "The authentication method selected is not supported by the server" },
+    { CLIENT_AUTHENTICATE_NONEED, ErrorCategory::Authentication, "The authentication is not needed on the server" },
+    { CLIENT_AUTHENTICATE_TIMEOUT, ErrorCategory::Authentication, "The authentication to the server has timed out" },
+    { CLIENT_AUTHENTICATE_ERROR, ErrorCategory::Authentication, "Unable to authenticate with the credentials provided" },
+    { SSL_CLIENT_INITSECURECLIENT_TIMEOUT, ErrorCategory::TLS, "The EHLO command via the secure channel timed out" },
+    { SSL_CLIENT_INITSECURECLIENT_ERROR, ErrorCategory::TLS, "Unable to EHLO the server via the secure channel" },
+    { SSL_CLIENT_STARTTLS_VERIFY_RESULT_ERROR, ErrorCategory::TLS, "Unable to verify the result of chain verification" },
+    { SSL_CLIENT_STARTTLS_GET_CERTIFICATE_ERROR, ErrorCategory::TLS, "Unable to get peer certificate" },
+    { SSL_CLIENT_STARTTLS_BIO_HANDSHAKE_ERROR, ErrorCategory::TLS, "Unable to handshake with SSL BIO" },
+    { SSL_CLIENT_STARTTLS_BIO_CONNECT_ERROR, ErrorCategory::TLS, "Unable to connect SSL BIO" },
+    { SSL_CLIENT_STARTTLS_CTX_SET_DEFAULT_VERIFY_PATHS_ERROR, ErrorCategory::TLS, "Unable to open the specifies that the default locations from which CA certificates are loaded" },
+    { SSL_CLIENT_STARTTLS_WIN_CERTOPENSYSTEMSTORE_ERROR, ErrorCategory::TLS, "Unable to open the Windows Certificate System Store" },
+    { SSL_CLIENT_STARTTLS_BIONEWSSLCONNECT_ERROR, ErrorCategory::TLS, "Unable to create the SSL BIO" },
+    { SSL_CLIENT_STARTTLS_INITSSLCTX_ERROR, ErrorCategory::TLS, "Unable to initialize the SSL Context" },
+    { SOCKET_INIT_CLIENT_SEND_STARTTLS_TIMEOUT, ErrorCategory::Transport, "The STARTTLS command has timed out" },
+    { SOCKET_INIT_CLIENT_SEND_STARTTLS_ERROR, ErrorCategory::Transport, "Unable to send the STARTTLS command" },
+    { SOCKET_INIT_CLIENT_SEND_EHLO_TIMEOUT, ErrorCategory::Transport, "The EHLO command has timed out" },
+    { SOCKET_INIT_CLIENT_SEND_EHLO_ERROR, ErrorCategory::Transport, "Unable to send the EHLO command" },
+    { SOCKET_INIT_SESSION_DELAYED_CONNECTION_ERROR, ErrorCategory::Transport, "Error in delayed connection" },
+    { SOCKET_INIT_SESSION_GET_SOCKET_OPTIONS_ERROR, ErrorCategory::Transport, "Unable to get socket options" },
+    { SOCKET_INIT_SESSION_FCNTL_SET_ERROR, ErrorCategory::Transport, "Unable to set socket file descriptor status flags" },
+    { SOCKET_INIT_SESSION_FCNTL_GET_ERROR, ErrorCategory::Transport, "Unable to get socket file descriptor status flags" },
+    { SOCKET_INIT_SESSION_GETHOSTBYNAME_ERROR, ErrorCategory::Transport, "Unable to get host by name" },
+    { SOCKET_INIT_SESSION_WINSOCKET_GETADDRINFO_ERROR, ErrorCategory::Transport, "Unable to get address info (Winsock)" },
+    { SOCKET_INIT_SESSION_WINSOCKET_STARTUP_ERROR, ErrorCategory::Transport, "Unable to start WSA (Winsock)" },
+    { SOCKET_INIT_SESSION_CONNECT_TIMEOUT, ErrorCategory::Transport, "The connection attempt has timed out" },
+    { SOCKET_INIT_SESSION_CONNECT_ERROR, ErrorCategory::Transport, "Unable to connect to the socket" },
+    { SOCKET_INIT_SESSION_CREATION_ERROR, ErrorCategory::Transport, "Unable to create the socket" },
+    { SMTPSERVER_AUTHENTICATIONREQUIRED_ERROR, ErrorCategory::Authentication, "Authentication required" },
+    { SMTPSERVER_AUTHENTICATIONTOOWEAK_ERROR, ErrorCategory::Authentication, "Authentication mechanism is too weak" },
+    { SMTPSERVER_CREDENTIALSINVALID_ERROR, ErrorCategory::Authentication, "Authentication credentials invalid" },
+    { SMTPSERVER_ENCRYPTIONREQUIREDFORAUTH_ERROR, ErrorCategory::Authentication, "Encryption required for requested authentication mechanism" },
+};
+
+constexpr bool isSorted() {
+    for (size_t index = 1; index < std::size(ERROR_DESCRIPTIONS); index++) {
+        if (ERROR_DESCRIPTIONS[index - 1].Code >= ERROR_DESCRIPTIONS[index].Code) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(isSorted(), "The error descriptions must be sorted by code");
+
+const ErrorDescription *findErrorDescription(int pErrorCode) {
+    const auto description = std::lower_bound(std::begin(ERROR_DESCRIPTIONS), std::end(ERROR_DESCRIPTIONS), pErrorCode,
+            [](const ErrorDescription &pDescription, int pCode) { return pDescription.Code < pCode; });
+    if (description == std::end(ERROR_DESCRIPTIONS) || description->Code != pErrorCode) {
+        return nullptr;
     }
+    return description;
+}
+}  // namespace
 
-    size_t errorMessageLength = errorMessage.length();
-    mErrorMessage = new char[errorMessageLength + 1];
-    std::strncpy(mErrorMessage, errorMessage.c_str(), errorMessageLength);
-    mErrorMessage[errorMessageLength] = '\0';
+ErrorResolver::ErrorResolver(int pErrorCode)
+    : mErrorCode(pErrorCode),
+      mErrorMessage(findErrorMessage(pErrorCode).data()) {
 }
 
 ErrorResolver::~ErrorResolver() {
-    delete[] mErrorMessage;
-    mErrorMessage = nullptr;
 }
 
 // Copy constructor
 ErrorResolver::ErrorResolver(const ErrorResolver& other)
     : mErrorCode(other.mErrorCode),
-      mErrorMessage(new char[std::strlen(other.mErrorMessage) + 1]) {
-    size_t errorMessageLength = std::strlen(other.mErrorMessage);
-    std::strncpy(mErrorMessage, other.mErrorMessage, errorMessageLength);
-    mErrorMessage[errorMessageLength] = '\0';
+      mErrorMessage(other.mErrorMessage) {
 }
 
 // Assignment operator
 ErrorResolver& ErrorResolver::operator=(const ErrorResolver& other) {
-    if (this != &other) {
-        mErrorCode = other.mErrorCode;
-        delete[] mErrorMessage;
-        size_t errorMessageLength = std::strlen(other.mErrorMessage);
-        mErrorMessage = new char[errorMessageLength + 1];
-        std::strncpy(mErrorMessage, other.mErrorMessage, errorMessageLength);
-        mErrorMessage[errorMessageLength] = '\0';
-    }
+    mErrorCode = other.mErrorCode;
+    mErrorMessage = other.mErrorMessage;
     return *this;
 }
 
@@ -194,23 +137,18 @@ ErrorResolver& ErrorResolver::operator=(const ErrorResolver& other) {
 ErrorResolver::ErrorResolver(ErrorResolver&& other) noexcept
     : mErrorCode(other.mErrorCode),
       mErrorMessage(other.mErrorMessage) {
+    // The messages are static, the source is only reset to a valid state
     other.mErrorCode = 0;
-    // Release the data pointer from the source object so that the destructor
-    // does not free the memory multiple times.
-    other.mErrorMessage = nullptr;
+    other.mErrorMessage = NO_MESSAGE.data();
 }
 
 // Move assignement operator
 ErrorResolver& ErrorResolver::operator=(ErrorResolver&& other) noexcept {
     if (this != &other) {
         mErrorCode = other.mErrorCode;
-        delete[] mErrorMessage;
-        // Copy the data pointer and its length from the source object.
         mErrorMessage = other.mErrorMessage;
-        // Release the data pointer from the source object so that
-        // the destructor does not free the memory multiple times.
         other.mErrorCode = 0;
-        other.mErrorMessage = nullptr;
+        other.mErrorMessage = NO_MESSAGE.data();
     }
     return *this;
 }
@@ -222,3 +160,30 @@ int ErrorResolver::getErrorCode() const {
 const char *ErrorResolver::getErrorMessage() const {
     return mErrorMessage;
 }
+
+ErrorCategory ErrorResolver::getErrorCategory() const {
+    return findErrorCategory(mErrorCode);
+}
+
+std::string_view ErrorResolver::findErrorMessage(int pErrorCode) {
+    const ErrorDescription *description = findErrorDescription(pErrorCode);
+    return description != nullptr ? description->Message : NO_MESSAGE;
+}
+
+ErrorCategory ErrorResolver::findErrorCategory(int pErrorCode) {
+    if (pErrorCode == 0) {
+        return ErrorCategory::None;
+    }
+    const ErrorDescription *description = findErrorDescription(pErrorCode);
+    if (description != nullptr) {
+        return description->Category;
+    }
+    // The other server replies (RFC 5321 section 4.2.1)
+    if (pErrorCode >= 400 && pErrorCode < 500) {
+        return ErrorCategory::Transient;
+    }
+    if (pErrorCode >= 500 && pErrorCode < 600) {
+        return ErrorCategory::Permanent;
+    }
+    return ErrorCategory::Unknown;
+}
@@ -1,6 +1,8 @@
 #ifndef ERRORRESOLVER_H
 #define ERRORRESOLVER_H
 
+#include <string_view>
+
 #ifdef _WIN32
     #ifdef SMTPCLIENT_EXPORTS
         #define ERRORRESOLVER_API __declspec(dllexport)
@@ -12,6 +14,28 @@
 #endif
 
 namespace jed_utils {
+/** @brief The ErrorCategory enum classifies the return codes so that a
+ *  caller can decide whether a failed delivery is worth retrying.
+ */
+enum class ErrorCategory {
+    // The operation has succeeded
+    None = 0,
+    // The server has replied with a 4xx code or the failure is local and
+    // temporary, the delivery can be tried again later
+    Transient,
+    // The server has replied with a 5xx code or the message cannot be
+    // delivered as it is
+    Permanent,
+    // The connection could not be established or has been lost
+    Transport,
+    // The TLS context, handshake or certificate verification has failed
+    TLS,
+    // The authentication has failed or is required by the server
+    Authentication,
+    // The code is not known by the library
+    Unknown
+};
+
 /** @brief The ErrorResolver class is used to translate an error code
  * return be the sendMail method of the differents SMTP client classes
  * to a string representation of the error message.
@@ -48,9 +72,32 @@ class ERRORRESOLVER_API ErrorResolver {
      */
     const char *getErrorMessage() const;
 
+    /** Return the category of the currently set error code. */
+    ErrorCategory getErrorCategory() const;
+
+    /**
+     *  @brief  Find the message of an error code without any allocation.
+     *  @param pErrorCode The error code returned by the sendMail method
+     *  of the different smtp client classes.
+     *  @return A view of a static null-terminated string, or of the
+     *  "No message correspond to this error code" message if the code is
+     *  not known.
+     */
+    static std::string_view findErrorMessage(int pErrorCode);
+
+    /**
+     *  @brief  Find the category of an error code.
+     *  @param pErrorCode The error code returned by the sendMail method
+     *  of the different smtp client classes or a server reply code.
+     *  @return ErrorCategory::None for 0, the category of the code if it is
+     *  known, Transient or Permanent for the other 4xx and 5xx server reply
+     *  codes, otherwise ErrorCategory::Unknown.
+     */
+    static ErrorCategory findErrorCategory(int pErrorCode);
+
  private:
     int mErrorCode;
-    char *mErrorMessage = nullptr;
+    const char *mErrorMessage;
 };
 }  // namespace jed_utils
 
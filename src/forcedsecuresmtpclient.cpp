@@ -12,7 +12,6 @@
     #include <BaseTsd.h>
     typedef SSIZE_T ssize_t;
     #include <windows.h>
-    constexpr auto sleep = Sleep;
 #else
     #include <fcntl.h>
     #include <netdb.h>
@@ -49,28 +48,33 @@ ForcedSecureSMTPClient& ForcedSecureSMTPClient::operator=(ForcedSecureSMTPClient
 }
 
 int ForcedSecureSMTPClient::establishConnectionWithServer() {
-    int session_init_return_code = initializeSession();
+    beginPhase();
+    int session_init_return_code = endPhase(SessionPhase::Connection, initializeSession());
     if (session_init_return_code != 0) {
         return session_init_return_code;
     }
 
-    int tls_start_return_code = startTLSNegotiation();
+    beginPhase();
+    int tls_start_return_code = endPhase(SessionPhase::StartTLS, startTLSNegotiation());
     if (tls_start_return_code != 0) {
         return tls_start_return_code;
     }
 
-    int server_greetings_return_code = checkServerGreetings();
+    beginPhase();
+    int server_greetings_return_code = endPhase(SessionPhase::Greeting, checkServerGreetings());
     if (server_greetings_return_code != STATUS_CODE_SERVICE_READY) {
         return server_greetings_return_code;
     }
 
-    int client_initSecure_return_code = getServerSecureIdentification();
+    beginPhase();
+    int client_initSecure_return_code = endPhase(SessionPhase::Identification, getServerSecureIdentification());
     if (client_initSecure_return_code != STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED) {
         return client_initSecure_return_code;
     }
 
     if (getCredentials() != nullptr) {
-        int client_auth_return_code = authenticateClient();
+        beginPhase();
+        int client_auth_return_code = endPhase(SessionPhase::Authentication, authenticateClient());
         if (client_auth_return_code != STATUS_CODE_AUTHENTICATION_SUCCEEDED) {
             return client_auth_return_code;
         }
@@ -79,17 +83,8 @@ int ForcedSecureSMTPClient::establishConnectionWithServer() {
 }
 
 int ForcedSecureSMTPClient::checkServerGreetings() {
-    char outbuf[SERVERRESPONSE_BUFFER_LENGTH];
-    unsigned int waitTime = 0;
-    ssize_t bytes_received = 0;
-    while ((bytes_received = BIO_read(getBIO(), outbuf, SERVERRESPONSE_BUFFER_LENGTH)) <= 0 && waitTime < getCommandTimeout()) {
-        sleep(1);
-        waitTime += 1;
-    }
-    if (waitTime < getCommandTimeout()) {
-        outbuf[bytes_received-1] = '\0';
-        addCommunicationLogItem(outbuf, "s");
-        int status_code = extractReturnCode(outbuf);
+    if (readServerReply()) {
+        int status_code = getServerReplyReader().getCode();
         if (status_code == STATUS_CODE_SERVICE_READY) {
             addCommunicationLogItem("Connected!");
         }
@@ -0,0 +1,125 @@
+#include "gzipattachmentsource.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef SMTPCLIENT_HAS_ZLIB
+    #include <zlib.h>
+#endif
+
+using namespace jed_utils;
+
+namespace {
+#ifdef SMTPCLIENT_HAS_ZLIB
+const size_t OUTPUT_BLOCK_LENGTH = 65536;
+
+// Release the state of the compression on every return path
+class Deflater {
+ public:
+    Deflater() = default;
+    ~Deflater() {
+        if (mInitialized) {
+            deflateEnd(&mStream);
+        }
+    }
+    Deflater(const Deflater &) = delete;
+    Deflater &operator=(const Deflater &) = delete;
+
+    bool init(int pLevel) {
+        // A window of 15 bits plus 16 writes the gzip header and trailer
+        mInitialized = deflateInit2(&mStream, pLevel, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        return mInitialized;
+    }
+
+    // Compress the input and give each full output block to the writer
+    int compress(std::string_view pInput, int pFlush, const AttachmentBlockWriter &pWriter) {
+        do {
+            // The input size of zlib is 32 bits
+            const size_t input_length = (std::min)(pInput.size(), static_cast<size_t>(std::numeric_limits<uInt>::max()));
+            mStream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(pInput.data()));
+            mStream.avail_in = static_cast<uInt>(input_length);
+            const int flush = input_length == pInput.size() ? pFlush : Z_NO_FLUSH;
+            int deflate_ret_code = Z_OK;
+            do {
+                mStream.next_out = mOutput.data();
+                mStream.avail_out = static_cast<uInt>(mOutput.size());
+                deflate_ret_code = deflate(&mStream, flush);
+                if (deflate_ret_code == Z_STREAM_ERROR) {
+                    return -1;
+                }
+                const size_t produced = mOutput.size() - mStream.avail_out;
+                if (produced > 0) {
+                    int writer_ret_code = pWriter(std::string_view(reinterpret_cast<const char *>(mOutput.data()), produced));
+                    if (writer_ret_code != 0) {
+                        return writer_ret_code;
+                    }
+                }
+            } while (mStream.avail_out == 0 || (flush == Z_FINISH && deflate_ret_code != Z_STREAM_END));
+            pInput.remove_prefix(input_length);
+        } while (!pInput.empty());
+        return 0;
+    }
+
+ private:
+    z_stream mStream {};
+    bool mInitialized = false;
+    std::vector<Bytef> mOutput = std::vector<Bytef>(OUTPUT_BLOCK_LENGTH);
+};
+#endif
+}  // namespace
+
+GzipAttachmentSource::GzipAttachmentSource(std::shared_ptr<const AttachmentSource> pSource, int pLevel)
+    : mSource(std::move(pSource)),
+      mLevel(pLevel) {
+    if (mSource == nullptr) {
+        throw std::invalid_argument("source");
+    }
+    if (pLevel < 1 || pLevel > 9) {
+        throw std::invalid_argument("level");
+    }
+    if (!isAvailable()) {
+        throw std::runtime_error("The gzip compression requires a build with zlib");
+    }
+}
+
+int GzipAttachmentSource::read(const AttachmentBlockWriter &pWriter) const {
+#ifdef SMTPCLIENT_HAS_ZLIB
+    Deflater deflater;
+    if (!deflater.init(mLevel)) {
+        return -1;
+    }
+    int read_ret_code = mSource->read([&deflater, &pWriter](std::string_view pBlock) {
+        return deflater.compress(pBlock, Z_NO_FLUSH, pWriter);
+    });
+    if (read_ret_code != 0) {
+        return read_ret_code;
+    }
+    return deflater.compress(std::string_view(), Z_FINISH, pWriter);
+#else
+    (void)pWriter;
+    return -1;
+#endif
+}
+
+std::optional<size_t> GzipAttachmentSource::getSize() const {
+    return std::nullopt;
+}
+
+std::string GzipAttachmentSource::getCacheKey() const {
+    const std::string source_key { mSource->getCacheKey() };
+    if (source_key.empty()) {
+        return "";
+    }
+    return "gzip" + std::to_string(mLevel) + ":" + source_key;
+}
+
+bool GzipAttachmentSource::isAvailable() {
+#ifdef SMTPCLIENT_HAS_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,64 @@
+#ifndef GZIPATTACHMENTSOURCE_H
+#define GZIPATTACHMENTSOURCE_H
+
+#include <memory>
+#include <optional>
+#include <string>
+#include "attachmentsource.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define GZIPATTACHMENTSOURCE_API __declspec(dllexport)
+    #else
+        #define GZIPATTACHMENTSOURCE_API __declspec(dllimport)
+    #endif
+#else
+    #define GZIPATTACHMENTSOURCE_API
+#endif
+
+namespace jed_utils {
+/** @brief The content of another source compressed in the gzip format
+ *  (RFC 1952) while it is read.
+ *
+ *  The compressed blocks are given to the encoders as they are produced, so
+ *  a large export is neither loaded nor compressed in memory at once. With
+ *  several attachments, the compression runs on the prefetch thread of the
+ *  client while the previous blocks are written. Give the attachment a name
+ *  that ends with .gz so that it is sent as application/gzip.
+ *
+ *  The compression is available when the library is built with zlib.
+ */
+class GZIPATTACHMENTSOURCE_API GzipAttachmentSource : public AttachmentSource {
+ public:
+    /**
+     *  @brief  Construct a new GzipAttachmentSource.
+     *  @param pSource The content to compress.
+     *  @param pLevel The compression level, from 1 (fastest) to 9 (smallest).
+     *  Default: 6
+     *  @throw std::invalid_argument pSource is null or pLevel is out of range.
+     *  @throw std::runtime_error The library is built without zlib.
+     */
+    explicit GzipAttachmentSource(std::shared_ptr<const AttachmentSource> pSource, int pLevel = 6);
+
+    /** Give the compressed content to a writer by blocks of at most 64 KB.
+     *  Return -1 if the content cannot be read or compressed. */
+    int read(const AttachmentBlockWriter &pWriter) const override;
+
+    /** Return nothing, the compressed size is only known once it is read. */
+    std::optional<size_t> getSize() const override;
+
+    /** Return the key of the content prefixed by the compression level, or an
+     *  empty string if the content cannot be identified. */
+    std::string getCacheKey() const override;
+
+    /** Indicate if the library is built with zlib. */
+    static bool isAvailable();
+
+ private:
+    std::shared_ptr<const AttachmentSource> mSource;
+    int mLevel;
+};
+}  // namespace jed_utils
+
+#endif
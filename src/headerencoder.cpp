@@ -0,0 +1,126 @@
+#include "headerencoder.h"
+#include <algorithm>
+#include "base64.h"
+
+using namespace jed_utils;
+
+namespace {
+const char ENCODED_WORD_PREFIX[] = "=?UTF-8?B?";
+const char ENCODED_WORD_SUFFIX[] = "?=";
+const size_t ENCODED_WORD_OVERHEAD = sizeof(ENCODED_WORD_PREFIX) - 1 + sizeof(ENCODED_WORD_SUFFIX) - 1;
+
+bool isFoldingWhitespace(char pChar) {
+    return pChar == ' ' || pChar == '\t';
+}
+
+bool isUtf8Continuation(char pChar) {
+    return (static_cast<unsigned char>(pChar) & 0xC0) == 0x80;
+}
+}  // namespace
+
+void HeaderEncoder::appendUnstructuredField(std::string &pOutput, std::string_view pName, std::string_view pValue) {
+    const size_t line_start = pOutput.size();
+    pOutput.append(pName).append(": ");
+    if (requiresEncoding(pValue)) {
+        appendEncodedWords(pOutput, line_start, pValue);
+    } else {
+        appendFoldedText(pOutput, line_start, pValue);
+    }
+    pOutput.append("\r\n");
+}
+
+void HeaderEncoder::appendAddressField(std::string &pOutput,
+        std::string_view pName,
+        const RecipientTable &pRecipients,
+        size_t pBegin,
+        size_t pEnd) {
+    if (pBegin >= pEnd) {
+        return;
+    }
+    size_t line_start = pOutput.size();
+    pOutput.append(pName).append(": ");
+    for (size_t index = pBegin; index < pEnd; index++) {
+        const std::string_view address { pRecipients.getEmailAddressView(index) };
+        if (index > pBegin) {
+            pOutput += ',';
+            // The separator space becomes the folding whitespace of the
+            // next line when the address does not fit
+            if (pOutput.size() - line_start + 1 + address.size() > MAX_LINE_LENGTH) {
+                pOutput.append("\r\n");
+                line_start = pOutput.size();
+            }
+            pOutput += ' ';
+        }
+        pOutput.append(address);
+    }
+    pOutput.append("\r\n");
+}
+
+bool HeaderEncoder::requiresEncoding(std::string_view pValue) {
+    return std::any_of(pValue.begin(), pValue.end(), [](char pChar) {
+            const auto byte = static_cast<unsigned char>(pChar);
+            return byte >= 0x7F || (byte < 0x20 && byte != '\t');
+            });
+}
+
+void HeaderEncoder::appendFoldedText(std::string &pOutput, size_t pLineStart, std::string_view pValue) {
+    size_t position = 0;
+    while (position < pValue.size()) {
+        // A word includes the whitespace that precedes it
+        size_t word_end = position + 1;
+        while (word_end < pValue.size() && !isFoldingWhitespace(pValue[word_end])) {
+            word_end++;
+        }
+        const size_t line_length = pOutput.size() - pLineStart;
+        // A line is only folded before whitespace and never left with
+        // whitespace alone, a longer word is kept on its line
+        if (isFoldingWhitespace(pValue[position]) && line_length > 1 &&
+                line_length + word_end - position > MAX_LINE_LENGTH) {
+            pOutput.append("\r\n");
+            pLineStart = pOutput.size();
+        }
+        pOutput.append(pValue.substr(position, word_end - position));
+        position = word_end;
+    }
+}
+
+void HeaderEncoder::appendEncodedWords(std::string &pOutput, size_t pLineStart, std::string_view pValue) {
+    size_t position = 0;
+    // The first encoded-word starts on the next line if a long field name
+    // leaves no room for two characters of 4 bytes
+    if (pOutput.size() - pLineStart + ENCODED_WORD_OVERHEAD + 8 > MAX_LINE_LENGTH) {
+        pOutput.back() = '\r';
+        pOutput.append("\n ");
+        pLineStart = pOutput.size() - 1;
+    }
+    while (position < pValue.size()) {
+        const size_t available = std::min(MAX_ENCODED_WORD_LENGTH, MAX_LINE_LENGTH - (pOutput.size() - pLineStart));
+        // Each group of 3 bytes is encoded in 4 characters
+        const size_t max_bytes = (available - ENCODED_WORD_OVERHEAD) / 4 * 3;
+        size_t byte_count = std::min(max_bytes, pValue.size() - position);
+        // An encoded-word holds complete UTF-8 characters (RFC 2047 5.3)
+        if (position + byte_count < pValue.size()) {
+            size_t character_end = byte_count;
+            while (character_end > 0 && isUtf8Continuation(pValue[position + character_end])) {
+                character_end--;
+            }
+            if (character_end > 0) {
+                byte_count = character_end;
+            }
+        }
+        pOutput.append(ENCODED_WORD_PREFIX);
+        const size_t encoded_start = pOutput.size();
+        pOutput.resize(encoded_start + Base64::EncodedLength(byte_count));
+        Base64::EncodeToBuffer(reinterpret_cast<const unsigned char *>(pValue.data() + position),
+                byte_count,
+                &pOutput[encoded_start]);
+        pOutput.append(ENCODED_WORD_SUFFIX);
+        position += byte_count;
+        // The whitespace between two encoded-words is ignored when they
+        // are decoded
+        if (position < pValue.size()) {
+            pOutput.append("\r\n ");
+            pLineStart = pOutput.size() - 1;
+        }
+    }
+}
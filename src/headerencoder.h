@@ -0,0 +1,75 @@
+#ifndef HEADERENCODER_H
+#define HEADERENCODER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "recipienttable.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define HEADERENCODER_API __declspec(dllexport)
+    #else
+        #define HEADERENCODER_API __declspec(dllimport)
+    #endif
+#else
+    #define HEADERENCODER_API
+#endif
+
+namespace jed_utils {
+/** @brief The HeaderEncoder class appends header fields to a buffer,
+ *  encoded and folded in a single pass.
+ *
+ *  The lines are folded before a space so that they do not exceed 78
+ *  characters when possible (RFC 5322). A value that contains characters
+ *  outside of the printable 7-bit ASCII range is written as a sequence of
+ *  UTF-8 encoded-words (RFC 2047). An ASCII value is copied as is, nothing
+ *  is allocated once the capacity of the buffer has grown to the size of
+ *  the headers.
+ */
+class HEADERENCODER_API HeaderEncoder {
+ public:
+    /** The recommended maximum length of a header line, without the CRLF. */
+    static constexpr size_t MAX_LINE_LENGTH = 78;
+
+    /** The maximum length of an encoded-word (RFC 2047). */
+    static constexpr size_t MAX_ENCODED_WORD_LENGTH = 75;
+
+    /**
+     *  @brief  Append an unstructured field, such as the Subject.
+     *  @param pOutput The buffer that receives the field and its CRLF. It
+     *  must end with a complete line.
+     *  @param pName The name of the field. Example: Subject
+     *  @param pValue The value of the field, in UTF-8.
+     */
+    static void appendUnstructuredField(std::string &pOutput, std::string_view pName, std::string_view pValue);
+
+    /**
+     *  @brief  Append an address list field, such as To or Cc, with all the
+     *  addresses of a range of a recipient table in a single field. Nothing
+     *  is appended for an empty range.
+     *  @param pOutput The buffer that receives the field and its CRLF. It
+     *  must end with a complete line.
+     *  @param pName The name of the field. Example: To
+     *  @param pRecipients The recipient table.
+     *  @param pBegin The index of the first address of the field.
+     *  @param pEnd The index that follows the last address of the field.
+     */
+    static void appendAddressField(std::string &pOutput,
+            std::string_view pName,
+            const RecipientTable &pRecipients,
+            size_t pBegin,
+            size_t pEnd);
+
+    /** Indicate if a value must be written as encoded-words, because it
+     *  contains 8-bit or control characters. */
+    static bool requiresEncoding(std::string_view pValue);
+
+ private:
+    static void appendFoldedText(std::string &pOutput, size_t pLineStart, std::string_view pValue);
+    static void appendEncodedWords(std::string &pOutput, size_t pLineStart, std::string_view pValue);
+};
+}  // namespace jed_utils
+
+#endif
@@ -1,7 +1,9 @@
 #ifndef HTMLMESSAGE_H
 #define HTMLMESSAGE_H
 
+#include <memory>
 #include <string>
+#include <vector>
 #include "message.h"
 
 #ifdef _WIN32
@@ -65,6 +67,44 @@ class HTMLMESSAGE_API HTMLMessage : public Message {
             size_t pBccCount = 0,
             const Attachment pAttachments[] = nullptr,
             size_t pAttachmentsSize = 0);
+
+    /**
+     *  @brief  Construct a new HTMLMessage from parts that are moved into it.
+     *  @param pFrom The sender email address of the message.
+     *  @param pTo The recipients email addresses of the message.
+     *  @param pSubject The subject of the message.
+     *  @param pBody The content of the message, shared with the copies of
+     *  the message. nullptr is an empty body.
+     *  @param pCc The carbon-copy recipients email addresses.
+     *  @param pBcc The blind carbon-copy recipients email addresses.
+     *  @param pAttachments The attachments of the message.
+     */
+    HTMLMessage(MessageAddress pFrom,
+            std::vector<MessageAddress> pTo,
+            std::string pSubject,
+            std::shared_ptr<const std::string> pBody,
+            std::vector<MessageAddress> pCc = {},
+            std::vector<MessageAddress> pBcc = {},
+            std::vector<Attachment> pAttachments = {});
+
+    /**
+     *  @brief  Construct a new HTMLMessage from a recipient table that is
+     *  moved into it. See the corresponding Message constructor.
+     *  @param pFrom The sender email address of the message.
+     *  @param pRecipients The To, Cc and Bcc recipients, in this order.
+     *  @param pToCount The number of To recipients.
+     *  @param pCcCount The number of Cc recipients.
+     *  @param pSubject The subject of the message.
+     *  @param pBody The content of the message. nullptr is an empty body.
+     *  @param pAttachments The attachments of the message.
+     */
+    HTMLMessage(MessageAddress pFrom,
+            RecipientTable pRecipients,
+            size_t pToCount,
+            size_t pCcCount,
+            std::string pSubject,
+            std::shared_ptr<const std::string> pBody,
+            std::vector<Attachment> pAttachments = {});
     const char *getMimeType() const override;
 };
 }  // namespace jed_utils
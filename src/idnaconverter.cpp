@@ -0,0 +1,162 @@
+#include "idnaconverter.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "stringutils.h"
+
+using namespace jed_utils;
+
+namespace {
+// Parameters of Punycode (RFC 3492 section 5)
+const uint32_t BASE = 36;
+const uint32_t TMIN = 1;
+const uint32_t TMAX = 26;
+const uint32_t SKEW = 38;
+const uint32_t DAMP = 700;
+const uint32_t INITIAL_BIAS = 72;
+const uint32_t INITIAL_N = 0x80;
+const char ACE_PREFIX[] = "xn--";
+const size_t MAX_LABEL_LENGTH = 63;
+
+uint32_t adaptBias(uint32_t pDelta, uint32_t pPointCount, bool pFirstTime) {
+    pDelta = pFirstTime ? pDelta / DAMP : pDelta / 2;
+    pDelta += pDelta / pPointCount;
+    uint32_t k = 0;
+    while (pDelta > ((BASE - TMIN) * TMAX) / 2) {
+        pDelta /= BASE - TMIN;
+        k += BASE;
+    }
+    return k + (BASE - TMIN + 1) * pDelta / (pDelta + SKEW);
+}
+
+char encodeDigit(uint32_t pDigit) {
+    return static_cast<char>(pDigit < 26 ? 'a' + pDigit : '0' + (pDigit - 26));
+}
+
+// Decode a label that is valid UTF-8, the ASCII letters being lowercased
+void decodeLabel(std::string_view pLabel, std::vector<uint32_t> &pCodePoints) {
+    pCodePoints.clear();
+    size_t index = 0;
+    while (index < pLabel.size()) {
+        const auto lead = static_cast<unsigned char>(pLabel[index]);
+        if (lead < 0x80) {
+            pCodePoints.push_back(lead >= 'A' && lead <= 'Z' ? static_cast<uint32_t>(lead - 'A' + 'a') : lead);
+            index++;
+            continue;
+        }
+        const size_t length = lead >= 0xF0 ? 4 : (lead >= 0xE0 ? 3 : 2);
+        uint32_t code_point = lead & (0x7Fu >> length);
+        for (size_t offset = 1; offset < length; offset++) {
+            code_point = (code_point << 6) | (static_cast<unsigned char>(pLabel[index + offset]) & 0x3Fu);
+        }
+        pCodePoints.push_back(code_point);
+        index += length;
+    }
+}
+
+// Append the A-label of a label with non-ASCII characters (RFC 3492 section 6.3)
+bool appendALabel(const std::vector<uint32_t> &pCodePoints, std::string &pOutput) {
+    // Each code point is encoded with at least one character, which also
+    // keeps the delta from overflowing
+    if (pCodePoints.size() > MAX_LABEL_LENGTH) {
+        return false;
+    }
+    const size_t label_start = pOutput.size();
+    pOutput += ACE_PREFIX;
+    uint32_t basic_count = 0;
+    for (const uint32_t code_point : pCodePoints) {
+        if (code_point < INITIAL_N) {
+            pOutput += static_cast<char>(code_point);
+            basic_count++;
+        }
+    }
+    if (basic_count > 0) {
+        pOutput += '-';
+    }
+    const auto point_count = static_cast<uint32_t>(pCodePoints.size());
+    uint32_t handled_count = basic_count;
+    uint32_t n = INITIAL_N;
+    uint32_t delta = 0;
+    uint32_t bias = INITIAL_BIAS;
+    while (handled_count < point_count) {
+        uint32_t next = UINT32_MAX;
+        for (const uint32_t code_point : pCodePoints) {
+            if (code_point >= n && code_point < next) {
+                next = code_point;
+            }
+        }
+        delta += (next - n) * (handled_count + 1);
+        n = next;
+        for (const uint32_t code_point : pCodePoints) {
+            if (code_point < n) {
+                delta++;
+            } else if (code_point == n) {
+                uint32_t q = delta;
+                for (uint32_t k = BASE;; k += BASE) {
+                    const uint32_t t = k <= bias ? TMIN : (k >= bias + TMAX ? TMAX : k - bias);
+                    if (q < t) {
+                        break;
+                    }
+                    pOutput += encodeDigit(t + (q - t) % (BASE - t));
+                    q = (q - t) / (BASE - t);
+                }
+                pOutput += encodeDigit(q);
+                bias = adaptBias(delta, handled_count + 1, handled_count == basic_count);
+                delta = 0;
+                handled_count++;
+            }
+        }
+        delta++;
+        n++;
+        if (pOutput.size() - label_start > MAX_LABEL_LENGTH) {
+            return false;
+        }
+    }
+    return pOutput.size() - label_start <= MAX_LABEL_LENGTH;
+}
+}  // namespace
+
+const std::string *IdnaConverter::toAscii(std::string_view pDomain) {
+    auto domain = mDomains.find(pDomain);
+    if (domain != mDomains.end()) {
+        return &domain->second;
+    }
+    std::string ascii_domain;
+    if (!convertToAscii(pDomain, ascii_domain)) {
+        return nullptr;
+    }
+    if (mDomains.size() >= MAX_CACHED_DOMAIN_COUNT) {
+        mDomains.clear();
+    }
+    return &mDomains.emplace(std::string(pDomain), std::move(ascii_domain)).first->second;
+}
+
+size_t IdnaConverter::getCachedDomainCount() const {
+    return mDomains.size();
+}
+
+bool IdnaConverter::convertToAscii(std::string_view pDomain, std::string &pAsciiDomain) {
+    pAsciiDomain.clear();
+    if (!StringUtils::isValidUtf8(pDomain)) {
+        return false;
+    }
+    std::vector<uint32_t> code_points;
+    size_t start = 0;
+    for (;;) {
+        const size_t end = pDomain.find('.', start);
+        const std::string_view label = pDomain.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+        if (StringUtils::isAscii(label)) {
+            pAsciiDomain.append(label);
+        } else {
+            decodeLabel(label, code_points);
+            if (!appendALabel(code_points, pAsciiDomain)) {
+                return false;
+            }
+        }
+        if (end == std::string_view::npos) {
+            return true;
+        }
+        pAsciiDomain += '.';
+        start = end + 1;
+    }
+}
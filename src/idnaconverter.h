@@ -0,0 +1,67 @@
+#ifndef IDNACONVERTER_H
+#define IDNACONVERTER_H
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define IDNACONVERTER_API __declspec(dllexport)
+    #else
+        #define IDNACONVERTER_API __declspec(dllimport)
+    #endif
+#else
+    #define IDNACONVERTER_API
+#endif
+
+namespace jed_utils {
+/** @brief The IdnaConverter converts the internationalized domain names to
+ *  their ASCII form, each label with non-ASCII characters being replaced by
+ *  its A-label: xn-- followed by its Punycode encoding (RFC 3492).
+ *
+ *  The ASCII letters of these labels are lowercased, the other characters
+ *  are encoded as they are: the labels must already be in the normalized
+ *  form of IDNA2008 (RFC 5895), since the Unicode mapping tables are not
+ *  applied. The converted domains are kept, so that the addresses of a
+ *  domain are converted once. An instance is not thread-safe.
+ */
+class IDNACONVERTER_API IdnaConverter {
+ public:
+    /** The maximum number of domains kept, the cache being cleared when it
+     *  is full. */
+    static const size_t MAX_CACHED_DOMAIN_COUNT = 256;
+
+    /**
+     *  @brief  Convert a domain to its ASCII form, or return the conversion
+     *  kept from a previous call.
+     *  @param pDomain The domain, in UTF-8. Example: bücher.example
+     *  @return The ASCII form of the domain or nullptr if the domain is not
+     *  valid UTF-8 or if a label is longer than 63 characters once
+     *  converted. The pointer remains valid until the next call.
+     *  Example: xn--bcher-kva.example
+     */
+    const std::string *toAscii(std::string_view pDomain);
+
+    /** Return the number of domains kept. */
+    size_t getCachedDomainCount() const;
+
+    /**
+     *  @brief  Convert a domain to its ASCII form, without cache.
+     *  @param pDomain The domain, in UTF-8.
+     *  @param pAsciiDomain Receive the ASCII form of the domain.
+     *  @return True for success, false if the domain is not valid UTF-8 or
+     *  if a label is longer than 63 characters once converted.
+     */
+    static bool convertToAscii(std::string_view pDomain, std::string &pAsciiDomain);
+
+ private:
+    // Compared with std::less<> so that the lookups do not copy the domain
+    std::map<std::string, std::string, std::less<>> mDomains;
+};
+}  // namespace jed_utils
+
+#endif
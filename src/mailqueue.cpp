@@ -0,0 +1,441 @@
+#include "mailqueue.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include "smtpclienterrors.h"
+#include "socketerrors.h"
+
+using namespace jed_utils;
+
+namespace {
+const unsigned int MAX_PRIORITY_WEIGHT = 1000;
+
+// Smooth weighted round robin: the classes are interleaved instead of being
+// taken in runs, so that a class waits at most a few slots for its turn
+std::vector<MailPriority> buildSchedule(const std::array<unsigned int, MAIL_PRIORITY_COUNT> &pWeights) {
+    long long total = 0;
+    for (const unsigned int weight : pWeights) {
+        total += weight;
+    }
+    std::array<long long, MAIL_PRIORITY_COUNT> current {};
+    std::vector<MailPriority> schedule;
+    schedule.reserve(static_cast<size_t>(total));
+    for (long long slot = 0; slot < total; slot++) {
+        size_t selected = 0;
+        for (size_t index = 0; index < MAIL_PRIORITY_COUNT; index++) {
+            current[index] += pWeights[index];
+            if (current[index] > current[selected]) {
+                selected = index;
+            }
+        }
+        current[selected] -= total;
+        schedule.push_back(static_cast<MailPriority>(selected));
+    }
+    return schedule;
+}
+}  // namespace
+
+MailQueue::MailQueue(SmtpClientType pType,
+        const char *pServerName,
+        unsigned int pPort,
+        const Credential *pCredential,
+        size_t pCapacity,
+        size_t pWorkerCount)
+    : mType(pType),
+      mServerName(pServerName == nullptr ? "" : pServerName),
+      mPort(pPort),
+      mCredential(pCredential != nullptr ? new Credential(*pCredential) : nullptr),
+      mPool(pWorkerCount == 0 ? 1 : pWorkerCount),
+      mCapacity(pCapacity == 0 ? 1 : pCapacity),
+      mQueues(),
+      mState(State::Running),
+      mQueuedCount(0),
+      mPriorityQueuedCounts {},
+      mInFlightCount(0),
+      mIdleWorkerCount(0),
+      mActiveProducerCount(0),
+      mRetryCount(0),
+      mBackpressureActive(false),
+      mBackpressureCallback(nullptr),
+      mHighWatermark(mCapacity),
+      mLowWatermark(mCapacity / 2),
+      mMaxAttempts(5),
+      mInitialRetryDelayInMilliseconds(1000),
+      mMaxRetryDelayInMilliseconds(300000),
+      mPriorityWeights { { 8, 4, 1 } },
+      mSchedule(buildSchedule(mPriorityWeights)),
+      mScheduleTick(0),
+      mReservedWorkerCount(0),
+      mRetryGeneration(0) {
+    if (mServerName.empty()) {
+        throw std::invalid_argument("Server name cannot be null or empty");
+    }
+    // Each ring can hold the whole capacity, the total is bounded by enqueue
+    for (auto &queue : mQueues) {
+        queue.reset(new BoundedMpmcQueue<QueueItem>(mCapacity));
+    }
+    const size_t worker_count = pWorkerCount == 0 ? 1 : pWorkerCount;
+    mWorkers.reserve(worker_count);
+    for (size_t index = 0; index < worker_count; index++) {
+        mWorkers.emplace_back(&MailQueue::workerLoop, this, index);
+    }
+}
+
+MailQueue::~MailQueue() {
+    shutdown(true);
+}
+
+int MailQueue::enqueue(std::shared_ptr<const Message> pMsg,
+        CompletionCallback pCallback,
+        MailPriority pPriority) {
+    if (pMsg == nullptr) {
+        throw std::invalid_argument("Message cannot be null");
+    }
+    // The shutdown waits for the producers that have passed the state check
+    mActiveProducerCount++;
+    if (mState.load() != State::Running) {
+        mActiveProducerCount--;
+        return CLIENT_QUEUE_STOPPED_ERROR;
+    }
+    // The count is raised before the push so that it never goes below the
+    // number of items a consumer can pop
+    const auto priority_index = static_cast<size_t>(pPriority);
+    const size_t queued_count = ++mQueuedCount;
+    mPriorityQueuedCounts[priority_index]++;
+    QueueItem item;
+    item.message = std::move(pMsg);
+    item.callback = std::move(pCallback);
+    item.priority = pPriority;
+    if (queued_count > mCapacity || !mQueues[priority_index]->tryPush(std::move(item))) {
+        mPriorityQueuedCounts[priority_index]--;
+        onQueuedCountChanged(--mQueuedCount);
+        mActiveProducerCount--;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+        }
+        mItemCompleted.notify_all();
+        return CLIENT_QUEUE_FULL_ERROR;
+    }
+    onQueuedCountChanged(queued_count);
+    mActiveProducerCount--;
+    if (mIdleWorkerCount.load() > 0) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+        }
+        mWorkAvailable.notify_one();
+        if (pPriority == MailPriority::High && mReservedWorkerCount.load() > 0) {
+            mPriorityWorkAvailable.notify_one();
+        }
+    }
+    return 0;
+}
+
+void MailQueue::shutdown(bool pDrain) {
+    State expected = State::Running;
+    if (!mState.compare_exchange_strong(expected, pDrain ? State::Draining : State::Stopped) && !pDrain) {
+        mState.store(State::Stopped);
+    }
+    while (mActiveProducerCount.load() > 0) {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+    }
+    mWorkAvailable.notify_all();
+    mPriorityWorkAvailable.notify_all();
+    for (auto &worker : mWorkers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    mState.store(State::Stopped);
+
+    // Release the messages that have not been sent
+    QueueItem item;
+    for (size_t index = 0; index < MAIL_PRIORITY_COUNT; index++) {
+        while (tryPopItem(item, static_cast<MailPriority>(index))) {
+            if (item.callback) {
+                item.callback(CLIENT_QUEUE_STOPPED_ERROR);
+            }
+        }
+    }
+    RetryMap retries;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        retries.swap(mRetries);
+    }
+    for (auto &retry : retries) {
+        if (retry.second.callback) {
+            retry.second.callback(CLIENT_QUEUE_STOPPED_ERROR);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+    }
+    mItemCompleted.notify_all();
+}
+
+void MailQueue::waitForIdle() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mItemCompleted.wait(lock, [this]() {
+            return mQueuedCount.load() == 0 && mInFlightCount.load() == 0 && mRetries.empty();
+            });
+}
+
+size_t MailQueue::getCapacity() const {
+    return mCapacity;
+}
+
+size_t MailQueue::getQueuedCount() const {
+    return mQueuedCount.load();
+}
+
+size_t MailQueue::getQueuedCount(MailPriority pPriority) const {
+    return mPriorityQueuedCounts[static_cast<size_t>(pPriority)].load();
+}
+
+size_t MailQueue::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mQueuedCount.load() + mInFlightCount.load() + mRetries.size();
+}
+
+bool MailQueue::isBackpressureActive() const {
+    return mBackpressureActive.load();
+}
+
+void MailQueue::setBackpressureCallback(BackpressureCallback pCallback, size_t pHighWatermark, size_t pLowWatermark) {
+    mBackpressureCallback = std::move(pCallback);
+    mHighWatermark = (std::max)(pHighWatermark, static_cast<size_t>(1));
+    mLowWatermark = (std::min)(pLowWatermark, mHighWatermark - 1);
+}
+
+void MailQueue::setRetryPolicy(unsigned int pMaxAttempts,
+        unsigned int pInitialDelayInMilliseconds,
+        unsigned int pMaxDelayInMilliseconds) {
+    mMaxAttempts.store(pMaxAttempts == 0 ? 1 : pMaxAttempts);
+    mInitialRetryDelayInMilliseconds.store(pInitialDelayInMilliseconds);
+    mMaxRetryDelayInMilliseconds.store((std::max)(pMaxDelayInMilliseconds, pInitialDelayInMilliseconds));
+}
+
+void MailQueue::setThrottle(std::shared_ptr<DeliveryThrottle> pThrottle) {
+    mThrottle = std::move(pThrottle);
+}
+
+std::shared_ptr<DeliveryThrottle> MailQueue::getThrottle() const {
+    return mThrottle;
+}
+
+void MailQueue::setPriorityWeights(unsigned int pHighWeight, unsigned int pNormalWeight, unsigned int pBulkWeight) {
+    for (const auto &weight : { std::make_pair(MailPriority::High, pHighWeight),
+            std::make_pair(MailPriority::Normal, pNormalWeight),
+            std::make_pair(MailPriority::Bulk, pBulkWeight) }) {
+        mPriorityWeights[static_cast<size_t>(weight.first)] = (std::min)((std::max)(weight.second, 1U), MAX_PRIORITY_WEIGHT);
+    }
+    mSchedule = buildSchedule(mPriorityWeights);
+    mScheduleTick.store(0);
+}
+
+unsigned int MailQueue::getPriorityWeight(MailPriority pPriority) const {
+    return mPriorityWeights[static_cast<size_t>(pPriority)];
+}
+
+void MailQueue::setReservedWorkerCount(size_t pReservedWorkerCount) {
+    mReservedWorkerCount.store((std::min)(pReservedWorkerCount, mWorkers.size() - 1));
+    // The idle workers wait again on the condition of their new role
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+    }
+    mWorkAvailable.notify_all();
+    mPriorityWorkAvailable.notify_all();
+}
+
+size_t MailQueue::getReservedWorkerCount() const {
+    return mReservedWorkerCount.load();
+}
+
+size_t MailQueue::getRetryCount() const {
+    return mRetryCount.load();
+}
+
+bool MailQueue::isTransientError(int pReturnCode) {
+    // 4xx replies such as STATUS_CODE_SERVICE_NOT_AVAILABLE (RFC 5321 section 4.2.1)
+    if (pReturnCode >= 400 && pReturnCode < 500) {
+        return true;
+    }
+    // The server could not be reached
+    return pReturnCode <= SOCKET_INIT_SESSION_CREATION_ERROR &&
+        pReturnCode >= SOCKET_INIT_SESSION_DELAYED_CONNECTION_ERROR;
+}
+
+void MailQueue::workerLoop(size_t pWorkerIndex) {
+    QueueItem item;
+    while (takeNextItem(item, pWorkerIndex)) {
+        processItem(item);
+        item = QueueItem();
+    }
+}
+
+bool MailQueue::takeNextItem(QueueItem &pItem, size_t pWorkerIndex) {
+    while (true) {
+        if (mState.load() == State::Stopped) {
+            return false;
+        }
+        const bool reserved = pWorkerIndex < mReservedWorkerCount.load();
+        // The item is counted as in flight before it leaves the queue so
+        // that waitForIdle never sees it in neither
+        mInFlightCount++;
+        if (tryPopItem(pItem, reserved)) {
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        const State state = mState.load();
+        const auto retry = findRetry(reserved);
+        if (retry != mRetries.end() &&
+                (state == State::Draining || retry->first <= std::chrono::steady_clock::now())) {
+            pItem = std::move(retry->second);
+            mRetries.erase(retry);
+            return true;
+        }
+        mInFlightCount--;
+        mItemCompleted.notify_all();
+        if (state != State::Running && getServedQueuedCount(reserved) == 0) {
+            return false;
+        }
+        mIdleWorkerCount++;
+        const size_t retry_generation = mRetryGeneration;
+        auto work_available = [this, pWorkerIndex, reserved, retry_generation]() {
+            return getServedQueuedCount(reserved) > 0 || mState.load() != State::Running ||
+                mRetryGeneration != retry_generation || (pWorkerIndex < mReservedWorkerCount.load()) != reserved;
+        };
+        std::condition_variable &work_condition = reserved ? mPriorityWorkAvailable : mWorkAvailable;
+        if (retry == mRetries.end()) {
+            work_condition.wait(lock, work_available);
+        } else {
+            work_condition.wait_until(lock, retry->first, work_available);
+        }
+        mIdleWorkerCount--;
+    }
+}
+
+bool MailQueue::tryPopItem(QueueItem &pItem, bool pReserved) {
+    if (pReserved) {
+        return tryPopItem(pItem, MailPriority::High);
+    }
+    // The schedule is only read once a message is queued, after the weights are set
+    if (mQueuedCount.load() == 0) {
+        return false;
+    }
+    const size_t schedule_size = mSchedule.size();
+    const size_t tick = mScheduleTick.fetch_add(1);
+    for (size_t offset = 0; offset < schedule_size; offset++) {
+        if (tryPopItem(pItem, mSchedule[(tick + offset) % schedule_size])) {
+            // The slots of the empty classes are skipped for the next workers too
+            if (offset > 0) {
+                mScheduleTick.fetch_add(offset);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MailQueue::tryPopItem(QueueItem &pItem, MailPriority pPriority) {
+    const auto index = static_cast<size_t>(pPriority);
+    if (mPriorityQueuedCounts[index].load() == 0 || !mQueues[index]->tryPop(pItem)) {
+        return false;
+    }
+    mPriorityQueuedCounts[index]--;
+    onQueuedCountChanged(--mQueuedCount);
+    return true;
+}
+
+MailQueue::RetryMap::iterator MailQueue::findRetry(bool pReserved) {
+    if (!pReserved) {
+        return mRetries.begin();
+    }
+    return std::find_if(mRetries.begin(), mRetries.end(), [](const RetryMap::value_type &pRetry) {
+            return pRetry.second.priority == MailPriority::High;
+            });
+}
+
+size_t MailQueue::getServedQueuedCount(bool pReserved) const {
+    return pReserved ? mPriorityQueuedCounts[static_cast<size_t>(MailPriority::High)].load() : mQueuedCount.load();
+}
+
+void MailQueue::processItem(QueueItem &pItem) {
+    DeliveryPermit permit;
+    if (mThrottle != nullptr && !acquireThrottlePermit(permit)) {
+        completeItem(pItem, CLIENT_QUEUE_STOPPED_ERROR);
+        return;
+    }
+    pItem.attemptCount++;
+    int ret_code = mPool.sendMail(mType, mServerName.c_str(), mPort, mCredential.get(), *pItem.message);
+    if (mThrottle != nullptr) {
+        mThrottle->release(permit, ret_code);
+    }
+    if (isTransientError(ret_code) && pItem.attemptCount < mMaxAttempts.load() && mState.load() == State::Running) {
+        const auto retry_time = std::chrono::steady_clock::now() + getRetryDelay(pItem.attemptCount);
+        const MailPriority priority = pItem.priority;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mRetries.emplace(retry_time, std::move(pItem));
+            mRetryGeneration++;
+            mInFlightCount--;
+        }
+        mRetryCount++;
+        // An idle worker recomputes the time of the next retry
+        mWorkAvailable.notify_one();
+        if (priority == MailPriority::High && mReservedWorkerCount.load() > 0) {
+            mPriorityWorkAvailable.notify_one();
+        }
+        return;
+    }
+    completeItem(pItem, ret_code);
+}
+
+void MailQueue::completeItem(QueueItem &pItem, int pReturnCode) {
+    if (pItem.callback) {
+        pItem.callback(pReturnCode);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mInFlightCount--;
+    }
+    mItemCompleted.notify_all();
+}
+
+void MailQueue::onQueuedCountChanged(size_t pQueuedCount) {
+    if (pQueuedCount >= mHighWatermark) {
+        bool expected = false;
+        if (mBackpressureActive.compare_exchange_strong(expected, true) && mBackpressureCallback) {
+            mBackpressureCallback(true);
+        }
+    } else if (pQueuedCount <= mLowWatermark) {
+        bool expected = true;
+        if (mBackpressureActive.compare_exchange_strong(expected, false) && mBackpressureCallback) {
+            mBackpressureCallback(false);
+        }
+    }
+}
+
+std::chrono::milliseconds MailQueue::getRetryDelay(unsigned int pAttemptCount) const {
+    const unsigned long long max_delay = mMaxRetryDelayInMilliseconds.load();
+    unsigned long long delay = mInitialRetryDelayInMilliseconds.load();
+    for (unsigned int attempt = 1; attempt < pAttemptCount && delay < max_delay; attempt++) {
+        delay *= 2;
+    }
+    return std::chrono::milliseconds((std::min)(delay, max_delay));
+}
+
+bool MailQueue::acquireThrottlePermit(DeliveryPermit &pPermit) {
+    // The wait is split so that a shutdown without drain is not delayed by
+    // a throttled server
+    const auto STOP_CHECK_INTERVAL = std::chrono::milliseconds(100);
+    while (mState.load() != State::Stopped) {
+        if (mThrottle->acquire(mServerName.c_str(), std::chrono::steady_clock::now() + STOP_CHECK_INTERVAL, pPermit)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,284 @@
+#ifndef MAILQUEUE_H
+#define MAILQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "boundedmpmcqueue.h"
+#include "credential.h"
+#include "deliverythrottle.h"
+#include "message.h"
+#include "smtpconnectionpool.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define MAILQUEUE_API __declspec(dllexport)
+    #else
+        #define MAILQUEUE_API __declspec(dllimport)
+    #endif
+#else
+    #define MAILQUEUE_API
+#endif
+
+namespace jed_utils {
+/** @brief The priority classes of the messages of a MailQueue. */
+enum class MailPriority {
+    // Transactional messages such as a password reset
+    High = 0,
+    Normal,
+    // Newsletters and other batches
+    Bulk
+};
+
+/** The number of priority classes. */
+const size_t MAIL_PRIORITY_COUNT = 3;
+
+/** @brief The MailQueue is an outbound queue of messages drained by worker
+ *  threads through persistent sessions kept in a SmtpConnectionPool.
+ *
+ *  The producers never block: the messages are stored in a bounded
+ *  lock-free ring buffer and enqueue fails when it is full. The messages
+ *  rejected with a transient error are retried with an exponential backoff.
+ *
+ *  Each priority class has its own ring buffer. The workers take the
+ *  messages of the classes in proportion to their weights, and a number of
+ *  workers, with their sessions, can be reserved to the high priority
+ *  messages so that a large bulk batch does not delay them.
+ */
+class MAILQUEUE_API MailQueue {
+ public:
+    /** The function called once a message has been sent or has definitely
+     *  failed. It receives 0 for success, otherwise the error code of the
+     *  last attempt. It is called on a worker thread and must not throw.
+     */
+    using CompletionCallback = std::function<void(int pReturnCode)>;
+
+    /** The function called with true when the number of queued messages
+     *  reaches the high watermark and with false when it goes back down to
+     *  the low watermark. It must not throw.
+     */
+    using BackpressureCallback = std::function<void(bool pActive)>;
+
+    /**
+     *  @brief  Construct a new MailQueue and start its worker threads.
+     *  @param pType The SMTP client class used for the sessions.
+     *  @param pServerName The name of the server.
+     *  Example: smtp.domainexample.com
+     *  @param pPort The server port number.
+     *  Example: 25, 465, 587
+     *  @param pCredential The credential used to authenticate or nullptr.
+     *  @param pCapacity The maximum number of queued messages.
+     *  Default: 1024
+     *  @param pWorkerCount The number of worker threads, which is also the
+     *  maximum number of sessions opened with the server.
+     *  Default: 4
+     */
+    MailQueue(SmtpClientType pType,
+            const char *pServerName,
+            unsigned int pPort,
+            const Credential *pCredential = nullptr,
+            size_t pCapacity = 1024,
+            size_t pWorkerCount = 4);
+
+    /** Destructor of the MailQueue. The queue is drained before the worker
+     *  threads are stopped. */
+    ~MailQueue();
+
+    MailQueue(const MailQueue& other) = delete;
+    MailQueue& operator=(const MailQueue& other) = delete;
+
+    /**
+     *  @brief  Queue a message without blocking.
+     *  @param pMsg The message to send. It is kept alive until it is sent.
+     *  @param pCallback The function called with the final return code or nullptr.
+     *  @param pPriority The priority class of the message.
+     *  Default: MailPriority::Normal
+     *  @return 0 for success, CLIENT_QUEUE_FULL_ERROR if the queue is full
+     *  or CLIENT_QUEUE_STOPPED_ERROR if the queue has been shut down. The
+     *  callback is not called when the message is not queued.
+     */
+    int enqueue(std::shared_ptr<const Message> pMsg,
+            CompletionCallback pCallback = nullptr,
+            MailPriority pPriority = MailPriority::Normal);
+
+    /**
+     *  @brief  Stop accepting messages and stop the worker threads.
+     *  @param pDrain True to send the queued messages first. The retries
+     *  already scheduled are attempted once without waiting for their delay.
+     *  False to stop after the messages being sent, the callback of the
+     *  other messages receives CLIENT_QUEUE_STOPPED_ERROR.
+     */
+    void shutdown(bool pDrain = true);
+
+    /** Block until all the queued messages have been sent or have failed. */
+    void waitForIdle();
+
+    /** Return the maximum number of queued messages. */
+    size_t getCapacity() const;
+
+    /** Return the number of messages in the ring buffers. */
+    size_t getQueuedCount() const;
+
+    /** Return the number of messages of a priority class in the ring buffers. */
+    size_t getQueuedCount(MailPriority pPriority) const;
+
+    /** Return the number of messages queued, waiting for a retry or being sent. */
+    size_t getPendingCount() const;
+
+    /** Indicate if the number of queued messages has reached the high
+     *  watermark and not yet gone back down to the low watermark. */
+    bool isBackpressureActive() const;
+
+    /**
+     *  @brief  Set the function notified of the backpressure changes. It
+     *  must be set before the first message is queued.
+     *  @param pCallback The function or nullptr.
+     *  @param pHighWatermark The number of queued messages that activates
+     *  the backpressure.
+     *  @param pLowWatermark The number of queued messages that releases it.
+     */
+    void setBackpressureCallback(BackpressureCallback pCallback, size_t pHighWatermark, size_t pLowWatermark);
+
+    /**
+     *  @brief  Set the retry policy of the messages rejected with a transient
+     *  error. The delay doubles after each attempt.
+     *  @param pMaxAttempts The maximum number of attempts, 1 disables the retries.
+     *  Default: 5
+     *  @param pInitialDelayInMilliseconds The delay before the first retry.
+     *  Default: 1000 milliseconds
+     *  @param pMaxDelayInMilliseconds The maximum delay between two attempts.
+     *  Default: 300000 milliseconds
+     */
+    void setRetryPolicy(unsigned int pMaxAttempts,
+            unsigned int pInitialDelayInMilliseconds,
+            unsigned int pMaxDelayInMilliseconds);
+
+    /**
+     *  @brief  Set the throttle that limits the rate and the number of
+     *  parallel deliveries to the server. It can be shared by the queues of
+     *  several servers and must be set before the first message is queued.
+     *  @param pThrottle The throttle or nullptr to send as fast as the
+     *  workers allow.
+     */
+    void setThrottle(std::shared_ptr<DeliveryThrottle> pThrottle);
+
+    /** Return the throttle of the deliveries or nullptr if there is none. */
+    std::shared_ptr<DeliveryThrottle> getThrottle() const;
+
+    /**
+     *  @brief  Set the share of the workers given to each priority class
+     *  while several classes have queued messages. A class without queued
+     *  messages leaves its share to the others. It must be set before the
+     *  first message is queued. The weights are between 1 and 1000.
+     *  @param pHighWeight The weight of the high priority messages.
+     *  Default: 8
+     *  @param pNormalWeight The weight of the normal priority messages.
+     *  Default: 4
+     *  @param pBulkWeight The weight of the bulk messages.
+     *  Default: 1
+     */
+    void setPriorityWeights(unsigned int pHighWeight, unsigned int pNormalWeight, unsigned int pBulkWeight);
+
+    /** Return the weight of a priority class. */
+    unsigned int getPriorityWeight(MailPriority pPriority) const;
+
+    /**
+     *  @brief  Set the number of workers, and so of sessions of the pool,
+     *  that only send the high priority messages. At least one worker is
+     *  left for the other classes. It must be set before the first message
+     *  is queued.
+     *  @param pReservedWorkerCount The number of reserved workers.
+     *  Default: 0
+     */
+    void setReservedWorkerCount(size_t pReservedWorkerCount);
+
+    /** Return the number of workers reserved to the high priority messages. */
+    size_t getReservedWorkerCount() const;
+
+    /** Return the number of retries scheduled since the queue was created. */
+    size_t getRetryCount() const;
+
+    /**
+     *  @brief  Indicate if a return code is worth a retry: a transient
+     *  negative reply of the server (4xx) or a connection failure.
+     */
+    static bool isTransientError(int pReturnCode);
+
+ private:
+    struct QueueItem {
+        std::shared_ptr<const Message> message;
+        CompletionCallback callback;
+        unsigned int attemptCount = 0;
+        MailPriority priority = MailPriority::Normal;
+    };
+    enum class State {
+        Running,
+        Draining,
+        Stopped
+    };
+
+    using RetryMap = std::multimap<std::chrono::steady_clock::time_point, QueueItem>;
+
+    void workerLoop(size_t pWorkerIndex);
+    bool takeNextItem(QueueItem &pItem, size_t pWorkerIndex);
+    // Pop from the ring buffers in the order of the weighted schedule
+    bool tryPopItem(QueueItem &pItem, bool pReserved);
+    bool tryPopItem(QueueItem &pItem, MailPriority pPriority);
+    // The first retry a worker can take, the mutex must be held
+    RetryMap::iterator findRetry(bool pReserved);
+    // The number of queued messages a worker can take
+    size_t getServedQueuedCount(bool pReserved) const;
+    void processItem(QueueItem &pItem);
+    void completeItem(QueueItem &pItem, int pReturnCode);
+    void onQueuedCountChanged(size_t pQueuedCount);
+    std::chrono::milliseconds getRetryDelay(unsigned int pAttemptCount) const;
+    // Wait for the permit of the throttle, false if the queue is stopped
+    bool acquireThrottlePermit(DeliveryPermit &pPermit);
+
+    SmtpClientType mType;
+    std::string mServerName;
+    unsigned int mPort;
+    std::unique_ptr<Credential> mCredential;
+    SmtpConnectionPool mPool;
+    size_t mCapacity;
+    std::array<std::unique_ptr<BoundedMpmcQueue<QueueItem>>, MAIL_PRIORITY_COUNT> mQueues;
+    std::atomic<State> mState;
+    std::atomic<size_t> mQueuedCount;
+    std::array<std::atomic<size_t>, MAIL_PRIORITY_COUNT> mPriorityQueuedCounts;
+    std::atomic<size_t> mInFlightCount;
+    std::atomic<size_t> mIdleWorkerCount;
+    std::atomic<size_t> mActiveProducerCount;
+    std::atomic<size_t> mRetryCount;
+    std::atomic<bool> mBackpressureActive;
+    BackpressureCallback mBackpressureCallback;
+    std::shared_ptr<DeliveryThrottle> mThrottle;
+    size_t mHighWatermark;
+    size_t mLowWatermark;
+    std::atomic<unsigned int> mMaxAttempts;
+    std::atomic<unsigned int> mInitialRetryDelayInMilliseconds;
+    std::atomic<unsigned int> mMaxRetryDelayInMilliseconds;
+    std::array<unsigned int, MAIL_PRIORITY_COUNT> mPriorityWeights;
+    // The smooth weighted round robin of the priority classes
+    std::vector<MailPriority> mSchedule;
+    std::atomic<size_t> mScheduleTick;
+    std::atomic<size_t> mReservedWorkerCount;
+    mutable std::mutex mMutex;
+    std::condition_variable mWorkAvailable;
+    std::condition_variable mPriorityWorkAvailable;
+    std::condition_variable mItemCompleted;
+    RetryMap mRetries;
+    size_t mRetryGeneration;
+    std::vector<std::thread> mWorkers;
+};
+}  // namespace jed_utils
+
+#endif
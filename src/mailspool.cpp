@@ -0,0 +1,572 @@
+#include "mailspool.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <unordered_set>
+#include <vector>
+#include "mailqueue.h"
+#include "mimewriter.h"
+#include "smtpclienterrors.h"
+
+#ifdef _WIN32
+    #include <io.h>
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+using namespace jed_utils;
+
+namespace {
+// Record layout, all the integers in little-endian:
+// u32 magic, u32 FNV-1a checksum of the payload, u64 payload length,
+// then the payload: u32 sender length, sender, u32 recipient count,
+// for each recipient u32 length and address, u64 content length, content.
+const uint32_t RECORD_MAGIC = 0x314C5053;  // "SPL1"
+const size_t RECORD_HEADER_SIZE = 16;
+const char SEGMENT_PREFIX[] = "spool-";
+const char SEGMENT_EXTENSION[] = ".seg";
+const char ACK_EXTENSION[] = ".ack";
+
+uint32_t computeChecksum(const unsigned char *pData, size_t pLength) {
+    uint32_t hash = 2166136261u;
+    for (size_t index = 0; index < pLength; index++) {
+        hash ^= pData[index];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void appendUInt32(std::string &pBuffer, uint32_t pValue) {
+    for (int index = 0; index < 4; index++) {
+        pBuffer += static_cast<char>((pValue >> (8 * index)) & 0xFF);
+    }
+}
+
+void appendUInt64(std::string &pBuffer, uint64_t pValue) {
+    for (int index = 0; index < 8; index++) {
+        pBuffer += static_cast<char>((pValue >> (8 * index)) & 0xFF);
+    }
+}
+
+uint64_t readUInt(const unsigned char *pData, size_t pSize) {
+    uint64_t value = 0;
+    for (size_t index = 0; index < pSize; index++) {
+        value |= static_cast<uint64_t>(pData[index]) << (8 * index);
+    }
+    return value;
+}
+
+// Read the fields of a payload with bounds checking
+class PayloadReader {
+ public:
+    PayloadReader(const unsigned char *pData, uint64_t pLength)
+        : mData(pData), mLength(pLength), mOffset(0) {}
+
+    bool readUInt32(uint32_t &pValue) {
+        if (mLength - mOffset < 4) {
+            return false;
+        }
+        pValue = static_cast<uint32_t>(readUInt(mData + mOffset, 4));
+        mOffset += 4;
+        return true;
+    }
+
+    bool readUInt64(uint64_t &pValue) {
+        if (mLength - mOffset < 8) {
+            return false;
+        }
+        pValue = readUInt(mData + mOffset, 8);
+        mOffset += 8;
+        return true;
+    }
+
+    bool readBytes(uint64_t pLength, const char *&pBytes) {
+        if (mLength - mOffset < pLength) {
+            return false;
+        }
+        pBytes = reinterpret_cast<const char *>(mData + mOffset);
+        mOffset += pLength;
+        return true;
+    }
+
+    bool readString(std::string &pValue) {
+        uint32_t length = 0;
+        const char *bytes = nullptr;
+        if (!readUInt32(length) || !readBytes(length, bytes)) {
+            return false;
+        }
+        pValue.assign(bytes, length);
+        return true;
+    }
+
+    uint64_t getRemainingLength() const {
+        return mLength - mOffset;
+    }
+
+ private:
+    const unsigned char *mData;
+    uint64_t mLength;
+    uint64_t mOffset;
+};
+
+// A read-only mapping of a range of a file. The view starts on the
+// allocation boundary that precedes the range.
+class MappedRange {
+ public:
+    MappedRange() = default;
+    ~MappedRange() {
+        unmap();
+    }
+    MappedRange(const MappedRange& other) = delete;
+    MappedRange& operator=(const MappedRange& other) = delete;
+
+    bool map(const std::string &pPath, uint64_t pOffset, uint64_t pLength) {
+        unmap();
+        if (pLength == 0) {
+            return false;
+        }
+#ifdef _WIN32
+        SYSTEM_INFO system_info;
+        GetSystemInfo(&system_info);
+        const uint64_t aligned_offset = pOffset - pOffset % system_info.dwAllocationGranularity;
+        HANDLE file = CreateFileA(pPath.c_str(), GENERIC_READ,
+                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            return false;
+        }
+        mViewLength = static_cast<size_t>(pLength + (pOffset - aligned_offset));
+        mView = MapViewOfFile(mapping, FILE_MAP_READ,
+                static_cast<DWORD>(aligned_offset >> 32),
+                static_cast<DWORD>(aligned_offset & 0xFFFFFFFF),
+                mViewLength);
+        // The view keeps the mapping alive
+        CloseHandle(mapping);
+        if (mView == nullptr) {
+            return false;
+        }
+#else
+        const uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        const uint64_t aligned_offset = pOffset - pOffset % page_size;
+        int fd = ::open(pPath.c_str(), O_RDONLY);
+        if (fd == -1) {
+            return false;
+        }
+        mViewLength = pLength + (pOffset - aligned_offset);
+        void *view = mmap(nullptr, mViewLength, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(aligned_offset));
+        close(fd);
+        if (view == MAP_FAILED) {
+            return false;
+        }
+        mView = view;
+#endif
+        mData = static_cast<const unsigned char *>(mView) + (pOffset - aligned_offset);
+        return true;
+    }
+
+    const unsigned char *data() const {
+        return mData;
+    }
+
+ private:
+    void unmap() {
+        if (mView != nullptr) {
+#ifdef _WIN32
+            UnmapViewOfFile(mView);
+#else
+            munmap(mView, mViewLength);
+#endif
+        }
+        mView = nullptr;
+        mViewLength = 0;
+        mData = nullptr;
+    }
+
+    void *mView = nullptr;
+    size_t mViewLength = 0;
+    const unsigned char *mData = nullptr;
+};
+
+bool flushFile(std::FILE *pFile, bool pSync) {
+    if (std::fflush(pFile) != 0) {
+        return false;
+    }
+    if (!pSync) {
+        return true;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(pFile)) == 0;
+#else
+    return fsync(fileno(pFile)) == 0;
+#endif
+}
+
+std::string createRecord(const Message &pMsg, std::string_view pContent) {
+    std::string payload;
+    const char *sender = pMsg.getFrom().getEmailAddress();
+    appendUInt32(payload, static_cast<uint32_t>(strlen(sender)));
+    payload += sender;
+    const RecipientTable &recipients = pMsg.getRecipients();
+    appendUInt32(payload, static_cast<uint32_t>(recipients.size()));
+    for (size_t index = 0; index < recipients.size(); index++) {
+        const std::string_view address { recipients.getEmailAddressView(index) };
+        appendUInt32(payload, static_cast<uint32_t>(address.size()));
+        payload += address;
+    }
+    appendUInt64(payload, pContent.size());
+    payload += pContent;
+
+    std::string record;
+    record.reserve(RECORD_HEADER_SIZE + payload.size());
+    appendUInt32(record, RECORD_MAGIC);
+    appendUInt32(record, computeChecksum(reinterpret_cast<const unsigned char *>(payload.data()), payload.size()));
+    appendUInt64(record, payload.size());
+    record += payload;
+    return record;
+}
+
+int deliverRecord(SMTPClientBase &pClient, const std::string &pSegmentPath, uint64_t pOffset, uint64_t pLength) {
+    // A segment cut short after it was loaded will never hold the record,
+    // and reading a mapping past the end of the file would fault
+    std::error_code error;
+    const uint64_t file_size = std::filesystem::file_size(pSegmentPath, error);
+    if (error) {
+        return CLIENT_SPOOL_IO_ERROR;
+    }
+    if (file_size < pOffset || file_size - pOffset < pLength) {
+        return CLIENT_SPOOL_CORRUPT_RECORD_ERROR;
+    }
+    MappedRange range;
+    if (!range.map(pSegmentPath, pOffset, pLength)) {
+        return CLIENT_SPOOL_IO_ERROR;
+    }
+    // The record could be mapped, a payload that cannot be parsed never will
+    PayloadReader reader(range.data() + RECORD_HEADER_SIZE, pLength - RECORD_HEADER_SIZE);
+    std::string sender;
+    uint32_t recipient_count = 0;
+    // Each recipient takes at least its length field
+    if (!reader.readString(sender) || !reader.readUInt32(recipient_count) ||
+            recipient_count > reader.getRemainingLength() / 4) {
+        return CLIENT_SPOOL_CORRUPT_RECORD_ERROR;
+    }
+    std::vector<std::string> recipients(recipient_count);
+    for (auto &recipient : recipients) {
+        if (!reader.readString(recipient)) {
+            return CLIENT_SPOOL_CORRUPT_RECORD_ERROR;
+        }
+    }
+    uint64_t content_length = 0;
+    const char *content = nullptr;
+    if (!reader.readUInt64(content_length) || !reader.readBytes(content_length, content)) {
+        return CLIENT_SPOOL_CORRUPT_RECORD_ERROR;
+    }
+    std::vector<const char *> recipient_addresses;
+    recipient_addresses.reserve(recipients.size());
+    for (const auto &recipient : recipients) {
+        recipient_addresses.push_back(recipient.c_str());
+    }
+    return pClient.sendRenderedMail(sender.c_str(),
+            recipient_addresses.data(),
+            recipient_addresses.size(),
+            content,
+            content_length);
+}
+}  // namespace
+
+MailSpool::MailSpool(const char *pDirectory, size_t pMaxSegmentSize)
+    : mDirectory(pDirectory == nullptr ? "" : pDirectory),
+      mMaxSegmentSize(pMaxSegmentSize),
+      mSyncOnWrite(false),
+      mOpened(false),
+      mActiveSegment(0),
+      mActiveFile(nullptr) {
+    if (mDirectory.empty()) {
+        throw std::invalid_argument("Spool directory cannot be null or empty");
+    }
+}
+
+MailSpool::~MailSpool() {
+    if (mActiveFile != nullptr) {
+        std::fclose(mActiveFile);
+    }
+}
+
+int MailSpool::open() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mOpened) {
+        return 0;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(mDirectory, error);
+    if (error) {
+        return CLIENT_SPOOL_IO_ERROR;
+    }
+    std::vector<uint64_t> sequences;
+    for (std::filesystem::directory_iterator it(mDirectory, error), end; !error && it != end; it.increment(error)) {
+        const std::string file_name = it->path().filename().string();
+        const size_t prefix_length = sizeof(SEGMENT_PREFIX) - 1;
+        const size_t extension_length = sizeof(SEGMENT_EXTENSION) - 1;
+        if (file_name.size() <= prefix_length + extension_length ||
+                file_name.compare(0, prefix_length, SEGMENT_PREFIX) != 0 ||
+                file_name.compare(file_name.size() - extension_length, extension_length, SEGMENT_EXTENSION) != 0) {
+            continue;
+        }
+        // The names that are not a sequence number, for instance too large
+        // for 64 bits, are foreign files
+        const char *digits_begin = file_name.data() + prefix_length;
+        const char *digits_end = file_name.data() + file_name.size() - extension_length;
+        uint64_t sequence = 0;
+        const auto parsed = std::from_chars(digits_begin, digits_end, sequence);
+        if (parsed.ec != std::errc() || parsed.ptr != digits_end) {
+            continue;
+        }
+        sequences.push_back(sequence);
+    }
+    if (error) {
+        return CLIENT_SPOOL_IO_ERROR;
+    }
+    std::sort(sequences.begin(), sequences.end());
+    mSegments.clear();
+    mPending.clear();
+    for (uint64_t sequence : sequences) {
+        int load_ret_code = loadSegment(sequence);
+        if (load_ret_code != 0) {
+            mSegments.clear();
+            mPending.clear();
+            return load_ret_code;
+        }
+    }
+    // The segments of the previous runs are never appended to again
+    mActiveSegment = sequences.empty() ? 1 : sequences.back() + 1;
+    mOpened = true;
+    return 0;
+}
+
+int MailSpool::loadSegment(uint64_t pSequence) {
+    const std::string segment_path = getSegmentPath(pSequence, SEGMENT_EXTENSION);
+    std::error_code error;
+    const uint64_t file_size = std::filesystem::file_size(segment_path, error);
+    if (error) {
+        return CLIENT_SPOOL_IO_ERROR;
+    }
+    std::vector<RecordLocation> records;
+    uint64_t valid_size = 0;
+    {
+        MappedRange range;
+        if (file_size > 0 && !range.map(segment_path, 0, file_size)) {
+            return CLIENT_SPOOL_IO_ERROR;
+        }
+        while (file_size - valid_size >= RECORD_HEADER_SIZE) {
+            const unsigned char *header = range.data() + valid_size;
+            const uint64_t payload_length = readUInt(header + 8, 8);
+            if (readUInt(header, 4) != RECORD_MAGIC ||
+                    file_size - valid_size - RECORD_HEADER_SIZE < payload_length ||
+                    readUInt(header + 4, 4) != computeChecksum(header + RECORD_HEADER_SIZE, static_cast<size_t>(payload_length))) {
+                break;
+            }
+            records.push_back({ pSequence, valid_size, RECORD_HEADER_SIZE + payload_length });
+            valid_size += RECORD_HEADER_SIZE + payload_length;
+        }
+    }
+    // Drop the record that was being written when the process stopped
+    if (valid_size < file_size) {
+        std::filesystem::resize_file(segment_path, valid_size, error);
+        if (error) {
+            return CLIENT_SPOOL_IO_ERROR;
+        }
+    }
+
+    std::unordered_set<uint64_t> acknowledged;
+    std::FILE *ack_file = std::fopen(getSegmentPath(pSequence, ACK_EXTENSION).c_str(), "rb");
+    if (ack_file != nullptr) {
+        unsigned char entry[8];
+        while (std::fread(entry, 1, sizeof(entry), ack_file) == sizeof(entry)) {
+            acknowledged.insert(readUInt(entry, sizeof(entry)));
+        }
+        std::fclose(ack_file);
+    }
+
+    Segment &segment = mSegments[pSequence];
+    segment.size = valid_size;
+    for (const auto &record : records) {
+        if (acknowledged.find(record.offset) == acknowledged.end()) {
+            mPending.push_back(record);
+            segment.outstandingCount++;
+        }
+    }
+    removeSegmentIfCompleted(pSequence);
+    return 0;
+}
+
+int MailSpool::enqueue(const Message &pMsg) {
+    int open_ret_code = open();
+    if (open_ret_code != 0) {
+        return open_ret_code;
+    }
+    // The rendering is done outside of the lock
+    MimeWriter writer;
+    int write_ret_code = writer.write(pMsg);
+    if (write_ret_code != 0) {
+        return write_ret_code;
+    }
+    const std::string record = createRecord(pMsg, writer.getContent());
+    std::lock_guard<std::mutex> lock(mMutex);
+    return appendRecord(record);
+}
+
+int MailSpool::appendRecord(const std::string &pRecord) {
+    Segment &active_segment = mSegments[mActiveSegment];
+    if (active_segment.size > 0 && active_segment.size + pRecord.size() > mMaxSegmentSize) {
+        std::fclose(mActiveFile);
+        mActiveFile = nullptr;
+        const uint64_t completed_segment = mActiveSegment++;
+        removeSegmentIfCompleted(completed_segment);
+        return appendRecord(pRecord);
+    }
+    const std::string segment_path = getSegmentPath(mActiveSegment, SEGMENT_EXTENSION);
+    if (mActiveFile == nullptr) {
+        mActiveFile = std::fopen(segment_path.c_str(), "ab");
+        if (mActiveFile == nullptr) {
+            return CLIENT_SPOOL_IO_ERROR;
+        }
+    }
+    if (std::fwrite(pRecord.data(), 1, pRecord.size(), mActiveFile) != pRecord.size() ||
+            !flushFile(mActiveFile, mSyncOnWrite)) {
+        // Remove the partial record so that the next one is appended at a
+        // record boundary
+        std::fclose(mActiveFile);
+        mActiveFile = nullptr;
+        std::error_code error;
+        std::filesystem::resize_file(segment_path, active_segment.size, error);
+        return CLIENT_SPOOL_IO_ERROR;
+    }
+    mPending.push_back({ mActiveSegment, active_segment.size, pRecord.size() });
+    active_segment.size += pRecord.size();
+    active_segment.outstandingCount++;
+    return 0;
+}
+
+int MailSpool::deliverNext(SMTPClientBase &pClient) {
+    int open_ret_code = open();
+    if (open_ret_code != 0) {
+        return open_ret_code;
+    }
+    RecordLocation record;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mPending.empty()) {
+            return CLIENT_SPOOL_EMPTY_ERROR;
+        }
+        record = mPending.front();
+        mPending.pop_front();
+    }
+    // The segment is not deleted while one of its records is outstanding
+    const int delivery_ret_code = deliverRecord(pClient,
+            getSegmentPath(record.segment, SEGMENT_EXTENSION),
+            record.offset,
+            record.length);
+    std::lock_guard<std::mutex> lock(mMutex);
+    // Only a segment that cannot be mapped is retried, a corrupt record is
+    // acknowledged so that it does not block the records behind it
+    if (delivery_ret_code == CLIENT_SPOOL_IO_ERROR || MailQueue::isTransientError(delivery_ret_code)) {
+        mPending.push_front(record);
+        return delivery_ret_code;
+    }
+    int ack_ret_code = acknowledgeRecord(record);
+    return delivery_ret_code == 0 ? ack_ret_code : delivery_ret_code;
+}
+
+size_t MailSpool::deliverAll(SMTPClientBase &pClient) {
+    size_t removed_count = 0;
+    while (true) {
+        const int delivery_ret_code = deliverNext(pClient);
+        if (delivery_ret_code == CLIENT_SPOOL_EMPTY_ERROR ||
+                delivery_ret_code == CLIENT_SPOOL_IO_ERROR ||
+                MailQueue::isTransientError(delivery_ret_code)) {
+            return removed_count;
+        }
+        removed_count++;
+    }
+}
+
+int MailSpool::acknowledgeRecord(const RecordLocation &pRecord) {
+    Segment &segment = mSegments[pRecord.segment];
+    segment.outstandingCount--;
+    std::string entry;
+    appendUInt64(entry, pRecord.offset);
+    int ack_ret_code = 0;
+    std::FILE *ack_file = std::fopen(getSegmentPath(pRecord.segment, ACK_EXTENSION).c_str(), "ab");
+    if (ack_file == nullptr) {
+        ack_ret_code = CLIENT_SPOOL_IO_ERROR;
+    } else {
+        if (std::fwrite(entry.data(), 1, entry.size(), ack_file) != entry.size() ||
+                !flushFile(ack_file, mSyncOnWrite)) {
+            ack_ret_code = CLIENT_SPOOL_IO_ERROR;
+        }
+        std::fclose(ack_file);
+    }
+    removeSegmentIfCompleted(pRecord.segment);
+    return ack_ret_code;
+}
+
+void MailSpool::removeSegmentIfCompleted(uint64_t pSequence) {
+    auto it = mSegments.find(pSequence);
+    if (it == mSegments.end() || it->second.outstandingCount > 0 || pSequence == mActiveSegment) {
+        return;
+    }
+    mSegments.erase(it);
+    std::error_code error;
+    std::filesystem::remove(getSegmentPath(pSequence, SEGMENT_EXTENSION), error);
+    std::filesystem::remove(getSegmentPath(pSequence, ACK_EXTENSION), error);
+}
+
+std::string MailSpool::getSegmentPath(uint64_t pSequence, const char *pExtension) const {
+    char file_name[64];
+    snprintf(file_name, sizeof(file_name), "%s%016llu%s", SEGMENT_PREFIX,
+            static_cast<unsigned long long>(pSequence), pExtension);
+    return (std::filesystem::path(mDirectory) / file_name).string();
+}
+
+const char *MailSpool::getDirectory() const {
+    return mDirectory.c_str();
+}
+
+size_t MailSpool::getMaxSegmentSize() const {
+    return mMaxSegmentSize;
+}
+
+size_t MailSpool::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t pending_count = 0;
+    for (const auto &segment : mSegments) {
+        pending_count += segment.second.outstandingCount;
+    }
+    return pending_count;
+}
+
+size_t MailSpool::getSegmentCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSegments.size();
+}
+
+bool MailSpool::isSyncOnWrite() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSyncOnWrite;
+}
+
+void MailSpool::setSyncOnWrite(bool pValue) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSyncOnWrite = pValue;
+}
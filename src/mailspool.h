@@ -0,0 +1,150 @@
+#ifndef MAILSPOOL_H
+#define MAILSPOOL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include "message.h"
+#include "smtpclientbase.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define MAILSPOOL_API __declspec(dllexport)
+    #else
+        #define MAILSPOOL_API __declspec(dllimport)
+    #endif
+#else
+    #define MAILSPOOL_API
+#endif
+
+namespace jed_utils {
+/** @brief The MailSpool is a disk-backed queue of rendered messages.
+ *
+ *  The messages are rendered once when they are queued and appended to
+ *  segment files of the spool directory. A message is delivered from a
+ *  mapping of its record, so the memory used does not grow with the number
+ *  of queued messages and the encoding is not redone on retry. The records
+ *  delivered or rejected permanently are acknowledged in a file next to
+ *  their segment and a segment is deleted once all its records have been
+ *  acknowledged. The messages not yet acknowledged are delivered again
+ *  after a restart of the process.
+ *
+ *  The methods can be called from several threads; the deliveries run
+ *  outside of the lock of the spool.
+ */
+class MAILSPOOL_API MailSpool {
+ public:
+    /**
+     *  @brief  Construct a new MailSpool. The directory is not accessed
+     *  before the spool is opened.
+     *  @param pDirectory The spool directory. It is created if needed.
+     *  @param pMaxSegmentSize The size from which a new segment file is
+     *  started. A record larger than this size gets its own segment.
+     *  Default: 64 MB
+     */
+    explicit MailSpool(const char *pDirectory, size_t pMaxSegmentSize = 64 * 1024 * 1024);
+
+    /** Destructor of the MailSpool. The records not delivered stay on disk. */
+    ~MailSpool();
+
+    MailSpool(const MailSpool& other) = delete;
+    MailSpool& operator=(const MailSpool& other) = delete;
+
+    /**
+     *  @brief  Create the spool directory if needed and load the records
+     *  not yet acknowledged. A record partially written when the process
+     *  stopped is truncated. Calling open again has no effect.
+     *  @return 0 for success or CLIENT_SPOOL_IO_ERROR.
+     */
+    int open();
+
+    /**
+     *  @brief  Render a message and append it to the spool. The spool is
+     *  opened if needed.
+     *  @param pMsg The message to queue. The envelope recipients are the
+     *  To, Cc and Bcc addresses of the message.
+     *  @return 0 for success, CLIENT_SENDMAIL_BODYPART_ERROR if an
+     *  attachment could not be read or CLIENT_SPOOL_IO_ERROR.
+     */
+    int enqueue(const Message &pMsg);
+
+    /**
+     *  @brief  Deliver the oldest pending record. The record is acknowledged
+     *  when it is sent or rejected with a permanent error and it stays at the
+     *  head of the spool when the error is transient.
+     *  @param pClient The client used for the delivery. Its persistent
+     *  session is used when it is opened.
+     *  @return The return code of the delivery, CLIENT_SPOOL_EMPTY_ERROR
+     *  if no record is pending, CLIENT_SPOOL_IO_ERROR if the segment of the
+     *  record cannot be mapped (the record is kept) or
+     *  CLIENT_SPOOL_CORRUPT_RECORD_ERROR if the record cannot be parsed (it
+     *  is acknowledged without being sent).
+     */
+    int deliverNext(SMTPClientBase &pClient);
+
+    /**
+     *  @brief  Deliver the pending records until the spool is empty or a
+     *  delivery fails with a transient error.
+     *  @param pClient The client used for the deliveries.
+     *  @return The number of records removed from the spool.
+     */
+    size_t deliverAll(SMTPClientBase &pClient);
+
+    /** Return the spool directory. */
+    const char *getDirectory() const;
+
+    /** Return the size from which a new segment file is started. */
+    size_t getMaxSegmentSize() const;
+
+    /** Return the number of records not yet acknowledged. */
+    size_t getPendingCount() const;
+
+    /** Return the number of segment files of the spool. */
+    size_t getSegmentCount() const;
+
+    /** Indicate if the writes are flushed to the storage device before
+     *  enqueue returns. */
+    bool isSyncOnWrite() const;
+
+    /**
+     *  @brief  Set if the writes are flushed to the storage device before
+     *  enqueue returns. Without it a record survives a crash of the process
+     *  but not a crash of the system.
+     *  Default: false
+     */
+    void setSyncOnWrite(bool pValue);
+
+ private:
+    struct RecordLocation {
+        uint64_t segment;
+        uint64_t offset;
+        uint64_t length;
+    };
+    struct Segment {
+        uint64_t size = 0;
+        size_t outstandingCount = 0;
+    };
+
+    int loadSegment(uint64_t pSequence);
+    int appendRecord(const std::string &pRecord);
+    int acknowledgeRecord(const RecordLocation &pRecord);
+    void removeSegmentIfCompleted(uint64_t pSequence);
+    std::string getSegmentPath(uint64_t pSequence, const char *pExtension) const;
+
+    std::string mDirectory;
+    size_t mMaxSegmentSize;
+    bool mSyncOnWrite;
+    bool mOpened;
+    uint64_t mActiveSegment;
+    std::FILE *mActiveFile;
+    std::map<uint64_t, Segment> mSegments;
+    std::deque<RecordLocation> mPending;
+    mutable std::mutex mMutex;
+};
+}  // namespace jed_utils
+
+#endif
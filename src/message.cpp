@@ -1,10 +1,35 @@
 #include "message.h"
 #include <cstddef>
-#include <iterator>
+#include <mutex>
+#include <stdexcept>
 #include <utility>
 
 using namespace jed_utils;
 
+struct Message::RecipientStorage {
+    RecipientTable table;
+    // Built on the first call to getTo, getCc or getBcc
+    mutable std::once_flag addressesBuilt;
+    mutable std::vector<MessageAddress> addresses;
+    mutable std::vector<MessageAddress *> pointers;
+};
+
+namespace {
+void appendAddresses(RecipientTable &pTable, const MessageAddress *pAddresses, size_t pCount) {
+    for (size_t index = 0; index < pCount; index++) {
+        pTable.append(pAddresses[index].getEmailAddress(), pAddresses[index].getDisplayName());
+    }
+}
+
+size_t measureAddresses(const MessageAddress *pAddresses, size_t pCount) {
+    size_t size = 0;
+    for (size_t index = 0; index < pCount; index++) {
+        size += strlen(pAddresses[index].getEmailAddress()) + strlen(pAddresses[index].getDisplayName());
+    }
+    return size;
+}
+}  // namespace
+
 Message::Message(const MessageAddress &pFrom,
         const MessageAddress &pTo,
         const char *pSubject,
@@ -31,227 +56,100 @@ Message::Message(const MessageAddress &pFrom,
         const Attachment pAttachments[],
         size_t pAttachmentsSize)
     : mFrom(pFrom),
-      mTo(nullptr),
-      mToCount(pToCount),
-      mCc(nullptr),
-      mCCCount(pCcCount),
-      mBcc(nullptr),
-      mBCCCount(pBccCount),
-      mSubject(nullptr),
-      mBody(nullptr),
-      mAttachments(nullptr),
-      mAttachmentCount(pAttachmentsSize) {
-    if (pSubject == nullptr) {
-        mSubject = new char('\0');
-    } else {
-        size_t subject_len = strlen(pSubject);
-        mSubject = new char[subject_len + 1];
-        strncpy(mSubject, pSubject, subject_len);
-        mSubject[subject_len] = '\0';
-    }
-
-    if (pBody == nullptr) {
-        mBody = new char('\0');
-    } else {
-        size_t body_len = strlen(pBody);
-        mBody = new char[body_len + 1];
-        strncpy(mBody, pBody, body_len);
-        mBody[body_len] = '\0';
-    }
-
-    if (pTo != nullptr) {
-        mTo = new MessageAddress*[mToCount];
-        for (unsigned int index = 0; index < mToCount; index++) {
-            mTo[index] = new MessageAddress(pTo[index]);
-        }
-    }
-
-    if (pCc != nullptr) {
-        mCc = new MessageAddress*[mCCCount];
-        for (unsigned int index = 0; index < mCCCount; index++) {
-            mCc[index] = new MessageAddress(pCc[index]);
-        }
-    }
-
-    if (pBcc != nullptr) {
-        mBcc = new MessageAddress*[mBCCCount];
-        for (unsigned int index = 0; index < mBCCCount; index++) {
-            mBcc[index] = new MessageAddress(pBcc[index]);
-        }
-    }
+      mToCount(pTo != nullptr ? pToCount : 0),
+      mCCCount(pCc != nullptr ? pCcCount : 0),
+      mBCCCount(pBcc != nullptr ? pBccCount : 0),
+      mSubject(pSubject == nullptr ? "" : pSubject),
+      mBody(std::make_shared<const std::string>(pBody == nullptr ? "" : pBody)) {
+    auto recipients = std::make_shared<RecipientStorage>();
+    recipients->table.reserve(mToCount + mCCCount + mBCCCount,
+            measureAddresses(pTo, mToCount) + measureAddresses(pCc, mCCCount) + measureAddresses(pBcc, mBCCCount));
+    appendAddresses(recipients->table, pTo, mToCount);
+    appendAddresses(recipients->table, pCc, mCCCount);
+    appendAddresses(recipients->table, pBcc, mBCCCount);
+    mRecipients = std::move(recipients);
 
     if (pAttachments != nullptr) {
-        mAttachments = new Attachment*[mAttachmentCount];
-        for (unsigned int index = 0; index < mAttachmentCount; index++) {
-            mAttachments[index] = new Attachment(pAttachments[index]);
-        }
+        mAttachmentList.assign(pAttachments, pAttachments + pAttachmentsSize);
     }
+    updatePointerTables();
 }
 
-Message::~Message() {
-    delete[] mSubject;
-    mSubject = nullptr;
-    delete[] mBody;
-    mBody = nullptr;
-    // To
-    if (mTo != nullptr) {
-        for (unsigned int i = 0; i < mToCount; i++) {
-            delete mTo[i];
-        }
-        delete[] mTo;
-    }
-    mTo = nullptr;
-    // Cc
-    if (mCc != nullptr) {
-        for (unsigned int i = 0; i < mCCCount; i++) {
-            delete mCc[i];
-        }
-        delete[] mCc;
-    }
-    mCc = nullptr;
-    // Bcc
-    if (mBcc != nullptr) {
-        for (unsigned int i = 0; i < mBCCCount; i++) {
-            delete mBcc[i];
-        }
-        delete[] mBcc;
-    }
-    mBcc = nullptr;
-    // Attachment
-    if (mAttachments != nullptr) {
-        for (unsigned int i = 0; i < mAttachmentCount; i++) {
-            delete mAttachments[i];
-        }
-        delete[] mAttachments;
+Message::Message(MessageAddress pFrom,
+        std::vector<MessageAddress> pTo,
+        std::string pSubject,
+        std::shared_ptr<const std::string> pBody,
+        std::vector<MessageAddress> pCc,
+        std::vector<MessageAddress> pBcc,
+        std::vector<Attachment> pAttachments)
+    : mFrom(std::move(pFrom)),
+      mToCount(pTo.size()),
+      mCCCount(pCc.size()),
+      mBCCCount(pBcc.size()),
+      mSubject(std::move(pSubject)),
+      mBody(pBody != nullptr ? std::move(pBody) : std::make_shared<const std::string>()),
+      mAttachmentList(std::move(pAttachments)) {
+    auto recipients = std::make_shared<RecipientStorage>();
+    recipients->table.reserve(mToCount + mCCCount + mBCCCount,
+            measureAddresses(pTo.data(), mToCount) + measureAddresses(pCc.data(), mCCCount) + measureAddresses(pBcc.data(), mBCCCount));
+    appendAddresses(recipients->table, pTo.data(), mToCount);
+    appendAddresses(recipients->table, pCc.data(), mCCCount);
+    appendAddresses(recipients->table, pBcc.data(), mBCCCount);
+    mRecipients = std::move(recipients);
+    updatePointerTables();
+}
+
+Message::Message(MessageAddress pFrom,
+        RecipientTable pRecipients,
+        size_t pToCount,
+        size_t pCcCount,
+        std::string pSubject,
+        std::shared_ptr<const std::string> pBody,
+        std::vector<Attachment> pAttachments)
+    : mFrom(std::move(pFrom)),
+      mToCount(pToCount),
+      mCCCount(pCcCount),
+      mBCCCount(0),
+      mSubject(std::move(pSubject)),
+      mBody(pBody != nullptr ? std::move(pBody) : std::make_shared<const std::string>()),
+      mAttachmentList(std::move(pAttachments)) {
+    if (pToCount > pRecipients.size() || pCcCount > pRecipients.size() - pToCount) {
+        throw std::invalid_argument("pCcCount");
     }
-    mAttachments = nullptr;
+    mBCCCount = pRecipients.size() - pToCount - pCcCount;
+    auto recipients = std::make_shared<RecipientStorage>();
+    recipients->table = std::move(pRecipients);
+    mRecipients = std::move(recipients);
+    updatePointerTables();
 }
 
+Message::~Message() = default;
+
 // Copy constructor
 Message::Message(const Message &other)
     : mFrom(other.mFrom),
-      mTo(nullptr),
+      mRecipients(other.mRecipients),
       mToCount(other.mToCount),
-      mCc(nullptr),
       mCCCount(other.mCCCount),
-      mBcc(nullptr),
       mBCCCount(other.mBCCCount),
-      mSubject(new char[strlen(other.mSubject) + 1]),
-      mBody(new char[strlen(other.mBody) + 1]),
-      mAttachments(nullptr),
-      mAttachmentCount(other.mAttachmentCount) {
-    size_t body_len = strlen(other.mBody);
-    strncpy(mBody, other.mBody, body_len);
-    mBody[body_len] = '\0';
-
-    size_t subject_len = strlen(other.mSubject);
-    strncpy(mSubject, other.mSubject, subject_len);
-    mSubject[subject_len] = '\0';
-
-    // mTo
-    if (other.mToCount > 0) {
-        mTo = new MessageAddress*[other.mToCount];
-        for (unsigned int i = 0; i < other.mToCount; i++) {
-            mTo[i] = new MessageAddress(*other.mTo[i]);
-        }
-    }
-
-    // mCc
-    if (other.mCCCount > 0) {
-        mCc = new MessageAddress*[other.mCCCount];
-        for (unsigned int i = 0; i < other.mCCCount; i++) {
-            mCc[i] = new MessageAddress(*other.mCc[i]);
-        }
-    }
-
-    // mBcc
-    if (other.mBCCCount > 0) {
-        mBcc = new MessageAddress*[other.mBCCCount];
-        for (unsigned int i = 0; i < other.mBCCCount; i++) {
-            mBcc[i] = new MessageAddress(*other.mBcc[i]);
-        }
-    }
-
-    // mAttachment
-    if (other.mAttachmentCount > 0) {
-        mAttachments = new Attachment*[other.mAttachmentCount];
-        for (unsigned int i = 0; i < other.mAttachmentCount; i++) {
-            mAttachments[i] = new Attachment(*other.mAttachments[i]);
-        }
-    }
+      mSubject(other.mSubject),
+      mBody(other.mBody),
+      mAttachmentList(other.mAttachmentList) {
+    updatePointerTables();
 }
 
 // Copy assignment
 Message& Message::operator=(const Message &other) {
     if (this != &other) {
-        // mSubject
-        delete[] mSubject;
-        size_t subject_len = strlen(other.mSubject);
-        mSubject = new char[subject_len + 1];
-        strncpy(mSubject, other.mSubject, subject_len);
-        mSubject[subject_len] = '\0';
-        // mBody
-        delete[] mBody;
-        size_t body_len = strlen(other.mBody);
-        mBody = new char[body_len + 1];
-        strncpy(mBody, other.mBody, body_len);
-        mBody[body_len] = '\0';
-        // mTo and mToCount
-        if (mToCount > 0) {
-            for (unsigned int i = 0; i < mToCount; i++) {
-                delete mTo[i];
-            }
-            delete[] mTo;
-        }
-        if (other.mToCount > 0) {
-            mTo = new MessageAddress*[other.mToCount];
-            for (unsigned int i = 0; i < other.mToCount; i++) {
-                mTo[i] = new MessageAddress(*other.mTo[i]);
-            }
-        }
+        mFrom = other.mFrom;
+        mRecipients = other.mRecipients;
         mToCount = other.mToCount;
-        // mCc and mCCCount
-        if (mCCCount > 0) {
-            for (unsigned int i = 0; i < mCCCount; i++) {
-                delete mCc[i];
-            }
-            delete[] mCc;
-        }
-        if (other.mCCCount > 0) {
-            mCc = new MessageAddress*[other.mCCCount];
-            for (unsigned int i = 0; i < other.mCCCount; i++) {
-                mCc[i] = new MessageAddress(*other.mCc[i]);
-            }
-        }
         mCCCount = other.mCCCount;
-        // mBcc and mBCCCount
-        if (mBCCCount > 0) {
-            for (unsigned int i = 0; i < mBCCCount; i++) {
-                delete mBcc[i];
-            }
-            delete[] mBcc;
-        }
-        if (other.mBCCCount > 0) {
-            mBcc = new MessageAddress*[other.mBCCCount];
-            for (unsigned int i = 0; i < other.mBCCCount; i++) {
-                mBcc[i] = new MessageAddress(*other.mBcc[i]);
-            }
-        }
         mBCCCount = other.mBCCCount;
-        // Attachments and mAttachmentCount
-        if (mAttachmentCount > 0) {
-            for (unsigned int i = 0; i < mAttachmentCount; i++) {
-                delete mAttachments[i];
-            }
-            delete[] mAttachments;
-        }
-        if (other.mAttachmentCount > 0) {
-            mAttachments = new Attachment*[other.mAttachmentCount];
-            for (unsigned int i = 0; i < other.mAttachmentCount; i++) {
-                mAttachments[i] = new Attachment(*other.mAttachments[i]);
-            }
-        }
-        mAttachmentCount = other.mAttachmentCount;
+        mSubject = other.mSubject;
+        mBody = other.mBody;
+        mAttachmentList = other.mAttachmentList;
+        updatePointerTables();
     }
     return *this;
 }
@@ -259,94 +157,46 @@ Message& Message::operator=(const Message &other) {
 // Move constructor
 Message::Message(Message &&other) noexcept
     : mFrom(std::move(other.mFrom)),
-      mTo(other.mTo),
+      mRecipients(std::move(other.mRecipients)),
       mToCount(other.mToCount),
-      mCc(other.mCc),
       mCCCount(other.mCCCount),
-      mBcc(other.mBcc),
       mBCCCount(other.mBCCCount),
-      mSubject(other.mSubject),
-      mBody(other.mBody),
-      mAttachments(other.mAttachments),
-      mAttachmentCount(other.mAttachmentCount) {
-    // Release the data pointer from the source object so that the destructor
-    // does not free the memory multiple times.
-    other.mTo = nullptr;
+      mSubject(std::move(other.mSubject)),
+      mBody(std::move(other.mBody)),
+      mAttachmentList(std::move(other.mAttachmentList)),
+      mAttachmentPointers(std::move(other.mAttachmentPointers)) {
+    // The pointer table still refers to the moved elements. The source is
+    // left without recipients, subject and body.
+    other.mAttachmentPointers.clear();
     other.mToCount = 0;
-    other.mCc = nullptr;
     other.mCCCount = 0;
-    other.mBcc = nullptr;
     other.mBCCCount = 0;
-    other.mSubject = nullptr;
-    other.mBody = nullptr;
-    other.mAttachments = nullptr;
-    other.mAttachmentCount = 0;
+    other.mSubject.clear();
 }
 
 // Move assignement
 Message& Message::operator=(Message &&other) noexcept {
     if (this != &other) {
-        delete[] mSubject;
-        delete[] mBody;
-        // mTo
-        if (mTo != nullptr) {
-            for (unsigned int i = 0; i < mToCount; i++) {
-                delete mTo[i];
-            }
-            delete[] mTo;
-        }
-        // mCc
-        if (mCc != nullptr) {
-            for (unsigned int i = 0; i < mCCCount; i++) {
-                delete mCc[i];
-            }
-            delete[] mCc;
-        }
-        // mBcc
-        if (mBcc != nullptr) {
-            for (unsigned int i = 0; i < mBCCCount; i++) {
-                delete mBcc[i];
-            }
-            delete[] mBcc;
-        }
-        // mAttachments
-        if (mAttachments != nullptr) {
-            for (unsigned int i = 0; i < mAttachmentCount; i++) {
-                delete mAttachments[i];
-            }
-            delete[] mAttachments;
-        }
-        // Copy the data pointer and its length from the
-        // source object.
         mFrom = other.mFrom;
-        mSubject = other.mSubject;
-        mBody = other.mBody;
-        mTo = other.mTo;
+        mRecipients = std::move(other.mRecipients);
         mToCount = other.mToCount;
-        mCc = other.mCc;
         mCCCount = other.mCCCount;
-        mBcc = other.mBcc;
         mBCCCount = other.mBCCCount;
-        mAttachments = other.mAttachments;
-        mAttachmentCount = other.mAttachmentCount;
-        // Release the data pointer from the source object so that
-        // the destructor does not free the memory multiple times.
-        other.mSubject = nullptr;
-        other.mBody = nullptr;
-        other.mTo = nullptr;
+        mSubject = std::move(other.mSubject);
+        mBody = std::move(other.mBody);
+        mAttachmentList = std::move(other.mAttachmentList);
+        mAttachmentPointers = std::move(other.mAttachmentPointers);
+        other.mAttachmentPointers.clear();
         other.mToCount = 0;
-        other.mCc = nullptr;
         other.mCCCount = 0;
-        other.mBcc = nullptr;
         other.mBCCCount = 0;
-        other.mAttachments = nullptr;
-        other.mAttachmentCount = 0;
+        other.mSubject.clear();
     }
     return *this;
 }
 
 MessageAddress **Message::getTo() const {
-    return mTo;
+    return mToCount > 0 ? getRecipientPointers() : nullptr;
 }
 
 size_t Message::getToCount() const {
@@ -354,15 +204,23 @@ size_t Message::getToCount() const {
 }
 
 const char *Message::getSubject() const {
-    return mSubject;
+    return mSubject.c_str();
 }
 
 const char *Message::getBody() const {
-    return mBody;
+    return mBody != nullptr ? mBody->c_str() : "";
+}
+
+std::string_view Message::getSubjectView() const {
+    return mSubject;
+}
+
+std::string_view Message::getBodyView() const {
+    return mBody != nullptr ? std::string_view(*mBody) : std::string_view();
 }
 
 MessageAddress **Message::getCc() const {
-    return mCc;
+    return mCCCount > 0 ? getRecipientPointers() + mToCount : nullptr;
 }
 
 size_t Message::getCcCount() const {
@@ -370,22 +228,51 @@ size_t Message::getCcCount() const {
 }
 
 MessageAddress **Message::getBcc() const {
-    return mBcc;
+    return mBCCCount > 0 ? getRecipientPointers() + mToCount + mCCCount : nullptr;
 }
 
 size_t Message::getBccCount() const {
     return mBCCCount;
 }
 
+const RecipientTable &Message::getRecipients() const {
+    static const RecipientTable EMPTY_TABLE;
+    return mRecipients != nullptr ? mRecipients->table : EMPTY_TABLE;
+}
+
 const MessageAddress &Message::getFrom() const {
     return mFrom;
 }
 
 Attachment **Message::getAttachments() const {
-    return mAttachments;
+    return mAttachmentPointers.empty() ? nullptr : const_cast<Attachment **>(mAttachmentPointers.data());
 }
 
 size_t Message::getAttachmentsCount() const {
-    return mAttachmentCount;
+    return mAttachmentPointers.size();
+}
+
+MessageAddress **Message::getRecipientPointers() const {
+    // The copies of the message share the addresses built by the first call
+    const RecipientStorage &recipients = *mRecipients;
+    std::call_once(recipients.addressesBuilt, [&recipients]() {
+        const RecipientTable &table = recipients.table;
+        recipients.addresses.reserve(table.size());
+        for (size_t index = 0; index < table.size(); index++) {
+            recipients.addresses.emplace_back(table.getEmailAddress(index), table.getDisplayName(index));
+        }
+        recipients.pointers.reserve(recipients.addresses.size());
+        for (auto &address : recipients.addresses) {
+            recipients.pointers.push_back(&address);
+        }
+    });
+    return recipients.pointers.data();
 }
 
+void Message::updatePointerTables() {
+    mAttachmentPointers.clear();
+    mAttachmentPointers.reserve(mAttachmentList.size());
+    for (auto &attachment : mAttachmentList) {
+        mAttachmentPointers.push_back(&attachment);
+    }
+}
@@ -2,11 +2,16 @@
 #define MESSAGE_H
 
 #include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
 #include <vector>
 #include "attachment.h"
 #include "messageaddress.h"
+#include "recipienttable.h"
 
 #ifdef _WIN32
+    #pragma warning(disable: 4251)
     #ifdef SMTPCLIENT_EXPORTS
         #define MESSAGE_API __declspec(dllexport)
     #else
@@ -17,7 +22,15 @@
 #endif
 
 namespace jed_utils {
-/** @brief The Message class represents the base class of an email message. */
+/** @brief The Message class represents the base class of an email message.
+ *
+ *  The recipients are stored in a RecipientTable and the attachments in a
+ *  contiguous array, so building a message does a fixed number of
+ *  allocations whatever the number of recipients. The recipients and the
+ *  body cannot be modified and are shared between the copies of the
+ *  message. The MessageAddress arrays returned by getTo, getCc and getBcc
+ *  are only built on their first call.
+ */
 class MESSAGE_API Message {
  public:
     /**
@@ -66,6 +79,50 @@ class MESSAGE_API Message {
             const Attachment pAttachments[] = nullptr,
             size_t pAttachmentsSize = 0);
 
+    /**
+     *  @brief  Construct a new Message from parts that are moved into it.
+     *  The MessageBuilder class uses this constructor.
+     *  @param pFrom The sender email address of the message.
+     *  @param pTo The recipients email addresses of the message.
+     *  @param pSubject The subject of the message.
+     *  @param pBody The content of the message, shared with the copies of
+     *  the message. nullptr is an empty body.
+     *  @param pCc The carbon-copy recipients email addresses.
+     *  @param pBcc The blind carbon-copy recipients email addresses.
+     *  @param pAttachments The attachments of the message.
+     */
+    Message(MessageAddress pFrom,
+            std::vector<MessageAddress> pTo,
+            std::string pSubject,
+            std::shared_ptr<const std::string> pBody,
+            std::vector<MessageAddress> pCc = {},
+            std::vector<MessageAddress> pBcc = {},
+            std::vector<Attachment> pAttachments = {});
+
+    /**
+     *  @brief  Construct a new Message from a recipient table that is moved
+     *  into it, without building a MessageAddress per recipient. The cpp
+     *  Message class uses this constructor.
+     *  @param pFrom The sender email address of the message.
+     *  @param pRecipients The To, Cc and Bcc recipients, in this order.
+     *  @param pToCount The number of To recipients at the start of the table.
+     *  @param pCcCount The number of Cc recipients that follow them. The
+     *  remaining entries are the Bcc recipients.
+     *  @param pSubject The subject of the message.
+     *  @param pBody The content of the message, shared with the copies of
+     *  the message. nullptr is an empty body.
+     *  @param pAttachments The attachments of the message.
+     *  @throw std::invalid_argument pToCount and pCcCount exceed the size
+     *  of the table.
+     */
+    Message(MessageAddress pFrom,
+            RecipientTable pRecipients,
+            size_t pToCount,
+            size_t pCcCount,
+            std::string pSubject,
+            std::shared_ptr<const std::string> pBody,
+            std::vector<Attachment> pAttachments = {});
+
     /** The destructor of the Message */
     virtual ~Message();
 
@@ -99,6 +156,12 @@ class MESSAGE_API Message {
     /** Return the body of the message. */
     const char *getBody() const;
 
+    /** Return the subject of the message without computing its length. */
+    std::string_view getSubjectView() const;
+
+    /** Return the body of the message without computing its length. */
+    std::string_view getBodyView() const;
+
     /** Return the carbon-copy recipient MessageAddress array of the message  */
     MessageAddress **getCc() const;
 
@@ -111,6 +174,11 @@ class MESSAGE_API Message {
     /** Return the number of message blind carbon-copy recipients in the array. */
     size_t getBccCount() const;
 
+    /** Return the To, Cc and Bcc recipients, in this order. The Cc
+     *  recipients start at getToCount() and the Bcc recipients at
+     *  getToCount() + getCcCount(). */
+    const RecipientTable &getRecipients() const;
+
     /** Return the attachment array of the message  */
     Attachment **getAttachments() const;
 
@@ -118,17 +186,20 @@ class MESSAGE_API Message {
     size_t getAttachmentsCount() const;
 
  private:
+    struct RecipientStorage;
+    void updatePointerTables();
+    MessageAddress **getRecipientPointers() const;
+
     MessageAddress mFrom;
-    MessageAddress **mTo;
+    // The To, Cc and Bcc recipients in this order, nullptr once moved
+    std::shared_ptr<const RecipientStorage> mRecipients;
     size_t mToCount;
-    MessageAddress **mCc;
     size_t mCCCount;
-    MessageAddress **mBcc;
     size_t mBCCCount;
-    char *mSubject;
-    char *mBody;
-    Attachment **mAttachments;
-    size_t mAttachmentCount;
+    std::string mSubject;
+    std::shared_ptr<const std::string> mBody;
+    std::vector<Attachment> mAttachmentList;
+    std::vector<Attachment *> mAttachmentPointers;
 };
 }  // namespace jed_utils
 
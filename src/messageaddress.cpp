@@ -1,67 +1,35 @@
 #include "messageaddress.h"
 #include <cstddef>
-#include <regex>
 #include <stdexcept>
 #include <string>
-#include "stringutils.h"
+#include "addressvalidator.h"
 
 using namespace jed_utils;
 
 MessageAddress::MessageAddress(const char *pEmailAddress, const char *pDisplayName)
     : mEmailAddress(nullptr), mDisplayName(nullptr) {
-    std::string email_address { pEmailAddress };
-    // Check if the email address is not empty or white spaces
-    if (email_address.length() == 0 || StringUtils::trim(email_address).empty()) {
+    // Check is the email address is valid, an empty address is not
+    if (pEmailAddress == nullptr || !AddressValidator::isValid(pEmailAddress)) {
         throw std::invalid_argument("pEmailAddress");
     }
-    // Check is the email address is valid
-    if (!isEmailAddressValid(email_address)) {
-        throw std::invalid_argument("pEmailAddress");
-    }
-
-    size_t email_len = strlen(pEmailAddress);
-    mEmailAddress = new char[email_len+1];
-    strncpy(mEmailAddress, pEmailAddress, email_len);
-    mEmailAddress[email_len] = '\0';
-
-    size_t name_len = strlen(pDisplayName);
-    mDisplayName = new char[name_len+1];
-    strncpy(mDisplayName, pDisplayName, name_len);
-    mDisplayName[name_len] = '\0';
+    setAddress(pEmailAddress, pDisplayName == nullptr ? "" : pDisplayName);
 }
 
 MessageAddress::~MessageAddress() {
+    // The display name is stored in the same buffer
     delete[] mEmailAddress;
-    delete[] mDisplayName;
 }
 
 // Copy constructor
 MessageAddress::MessageAddress(const MessageAddress& other)
-    : mEmailAddress(new char[strlen(other.mEmailAddress) + 1]),
-      mDisplayName(new char[strlen(other.mDisplayName) + 1]) {
-    size_t email_len = strlen(other.mEmailAddress);
-    strncpy(mEmailAddress, other.mEmailAddress, email_len);
-    mEmailAddress[email_len] = '\0';
-    size_t name_len = strlen(other.mDisplayName);
-    strncpy(mDisplayName, other.mDisplayName, name_len);
-    mDisplayName[name_len] = '\0';
+    : mEmailAddress(nullptr), mDisplayName(nullptr) {
+    setAddress(other.mEmailAddress, other.mDisplayName);
 }
 
 // Assignment operator
 MessageAddress& MessageAddress::operator=(const MessageAddress& other) {
     if (this != &other) {
-        delete[] mEmailAddress;
-        delete[] mDisplayName;
-        // mEmailAddress
-        size_t email_len = strlen(other.mEmailAddress);
-        mEmailAddress = new char[email_len + 1];
-        strncpy(mEmailAddress, other.mEmailAddress, email_len);
-        mEmailAddress[email_len] = '\0';
-        // mDisplayName
-        size_t name_len = strlen(other.mDisplayName);
-        mDisplayName = new char[name_len + 1];
-        strncpy(mDisplayName, other.mDisplayName, name_len);
-        mDisplayName[name_len] = '\0';
+        setAddress(other.mEmailAddress, other.mDisplayName);
     }
     return *this;
 }
@@ -80,7 +48,6 @@ MessageAddress::MessageAddress(MessageAddress&& other) noexcept
 MessageAddress& MessageAddress::operator=(MessageAddress&& other) noexcept {
     if (this != &other) {
         delete[] mEmailAddress;
-        delete[] mDisplayName;
         // Copy the data pointer and its length from the source object.
         mEmailAddress = other.mEmailAddress;
         mDisplayName = other.mDisplayName;
@@ -116,8 +83,14 @@ const char *MessageAddress::getDisplayName() const {
     return mDisplayName;
 }
 
-bool MessageAddress::isEmailAddressValid(const std::string &pEmailAddress) const {
-    std::regex emailPattern("^[_a-z0-9-]+(.[_a-z0-9-]+)*@[a-z0-9-]+(.[a-z0-9-]+)*(.[a-z]{2,4})$");
-    return regex_match(StringUtils::toLower(pEmailAddress), emailPattern);
+void MessageAddress::setAddress(const char *pEmailAddress, const char *pDisplayName) {
+    // The email address and the display name share a single allocation
+    const size_t email_len = strlen(pEmailAddress);
+    const size_t name_len = strlen(pDisplayName);
+    char *buffer = new char[email_len + name_len + 2];
+    memcpy(buffer, pEmailAddress, email_len + 1);
+    memcpy(buffer + email_len + 1, pDisplayName, name_len + 1);
+    delete[] mEmailAddress;
+    mEmailAddress = buffer;
+    mDisplayName = buffer + email_len + 1;
 }
-
@@ -63,7 +63,7 @@ class MESSAGEADDRESS_API MessageAddress {
  private:
     char *mEmailAddress = nullptr;
     char *mDisplayName = nullptr;
-    bool isEmailAddressValid(const std::string &pEmailAddress) const;
+    void setAddress(const char *pEmailAddress, const char *pDisplayName);
 };
 }  // namespace jed_utils
 
@@ -0,0 +1,114 @@
+#include "messagetemplate.h"
+#include <utility>
+#include "smtpclienterrors.h"
+
+using namespace jed_utils;
+
+void RenderedTemplate::clear() {
+    mArena.clear();
+    mSegments.clear();
+    mSize = 0;
+}
+
+const std::string_view *RenderedTemplate::getSegments() const {
+    return mSegments.data();
+}
+
+size_t RenderedTemplate::getSegmentCount() const {
+    return mSegments.size();
+}
+
+size_t RenderedTemplate::getSize() const {
+    return mSize;
+}
+
+std::string RenderedTemplate::toString() const {
+    std::string content;
+    content.reserve(mSize);
+    for (const auto &segment : mSegments) {
+        content.append(segment);
+    }
+    return content;
+}
+
+MessageTemplate::MessageTemplate(std::string pContent)
+    : mContent(std::move(pContent)) {
+    parse();
+}
+
+int MessageTemplate::render(const std::map<std::string, std::string> &pFields, RenderedTemplate &pOutput) const {
+    pOutput.clear();
+    // The arena is reserved for all the values, so the views of the values
+    // already appended are not moved by the next ones
+    size_t values_size = 0;
+    for (size_t index = 0; index + 1 < mParts.size(); index++) {
+        auto value = pFields.find(mParts[index].name);
+        if (value == pFields.end()) {
+            return CLIENT_TEMPLATE_FIELD_ERROR;
+        }
+        values_size += value->second.size();
+    }
+    pOutput.mArena.reserve(values_size);
+    pOutput.mSegments.reserve(mParts.size() * 2);
+    for (size_t index = 0; index < mParts.size(); index++) {
+        const Part &part = mParts[index];
+        if (part.literalSize > 0) {
+            pOutput.mSegments.emplace_back(mContent.data() + part.literalOffset, part.literalSize);
+        }
+        if (index + 1 < mParts.size()) {
+            const std::string &value = pFields.find(part.name)->second;
+            if (!value.empty()) {
+                const size_t value_offset = pOutput.mArena.size();
+                pOutput.mArena.append(value);
+                pOutput.mSegments.emplace_back(pOutput.mArena.data() + value_offset, value.size());
+            }
+        }
+    }
+    pOutput.mSize = values_size;
+    for (const Part &part : mParts) {
+        pOutput.mSize += part.literalSize;
+    }
+    return 0;
+}
+
+std::string_view MessageTemplate::getContent() const {
+    return mContent;
+}
+
+size_t MessageTemplate::getFieldCount() const {
+    return mParts.size() - 1;
+}
+
+std::string_view MessageTemplate::getFieldName(size_t pIndex) const {
+    if (pIndex + 1 >= mParts.size()) {
+        return std::string_view();
+    }
+    return mParts[pIndex].name;
+}
+
+void MessageTemplate::parse() {
+    const std::string_view content { mContent };
+    size_t literal_start = 0;
+    size_t search_start = 0;
+    while (true) {
+        const size_t field_start = content.find("{{", search_start);
+        if (field_start == std::string_view::npos) {
+            break;
+        }
+        const size_t field_end = content.find("}}", field_start + 2);
+        if (field_end == std::string_view::npos) {
+            break;
+        }
+        const std::string_view name { content.substr(field_start + 2, field_end - field_start - 2) };
+        // A name spans a single line and is not empty, otherwise the braces
+        // are literal text
+        if (name.empty() || name.find_first_of("{\r\n") != std::string_view::npos) {
+            search_start = field_start + 1;
+            continue;
+        }
+        mParts.push_back({ literal_start, field_start - literal_start, std::string(name) });
+        literal_start = field_end + 2;
+        search_start = literal_start;
+    }
+    mParts.push_back({ literal_start, content.size() - literal_start, std::string() });
+}
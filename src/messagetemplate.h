@@ -0,0 +1,129 @@
+#ifndef MESSAGETEMPLATE_H
+#define MESSAGETEMPLATE_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define MESSAGETEMPLATE_API __declspec(dllexport)
+    #else
+        #define MESSAGETEMPLATE_API __declspec(dllimport)
+    #endif
+#else
+    #define MESSAGETEMPLATE_API
+#endif
+
+namespace jed_utils {
+/** @brief The MergeRecipient struct contains a recipient of a mail merge
+ *  and the values of its merge fields. */
+struct MergeRecipient {
+    /** The email address of the envelope recipient. */
+    std::string EmailAddress;
+    /** The value of each merge field, by name. */
+    std::map<std::string, std::string> Fields;
+};
+
+/** @brief The RenderedTemplate class contains a copy of a MessageTemplate
+ *  rendered for one recipient.
+ *
+ *  The segments refer to the literal text of the template and to the
+ *  values of the merge fields, which are the only bytes copied. Reuse the
+ *  same object for each recipient so that rendering does not allocate once
+ *  its capacity has grown to the size of the values. The segments remain
+ *  valid until the next render or clear and while the template exists.
+ */
+class MESSAGETEMPLATE_API RenderedTemplate {
+ public:
+    /** Construct a new empty RenderedTemplate. */
+    RenderedTemplate() = default;
+
+    /** Discard the content. The capacity is kept. */
+    void clear();
+
+    /** Return the segments of the content, in order. */
+    const std::string_view *getSegments() const;
+
+    /** Return the number of segments of the content. */
+    size_t getSegmentCount() const;
+
+    /** Return the total size of the content. */
+    size_t getSize() const;
+
+    /** Return the content as a single string. */
+    std::string toString() const;
+
+ private:
+    friend class MessageTemplate;
+    // The values of the merge fields of the recipient
+    std::string mArena;
+    std::vector<std::string_view> mSegments;
+    size_t mSize = 0;
+};
+
+/** @brief The MessageTemplate class is a rendered message that contains
+ *  merge fields, parsed once and rendered for each recipient of a mail
+ *  merge.
+ *
+ *  A merge field is written {{Name}} anywhere in the content, for instance
+ *  in the To header and in the body of the content written by a MimeWriter.
+ *  The content is split into the literal segments and the merge fields
+ *  when the template is constructed. The values are inserted as is, so
+ *  they must suit the part of the message where they appear (a header
+ *  value without line break, HTML escaped text in an HTML body).
+ */
+class MESSAGETEMPLATE_API MessageTemplate {
+ public:
+    /**
+     *  @brief  Construct a new MessageTemplate.
+     *  @param pContent The headers and body of the message, with the merge
+     *  fields. A {{ without matching }} is kept as literal text.
+     */
+    explicit MessageTemplate(std::string pContent);
+
+    /**
+     *  @brief  Render the template for a recipient.
+     *  @param pFields The values of the merge fields, by name.
+     *  @param pOutput Receive the rendered content, its previous content is
+     *  replaced.
+     *  @return 0 for success or CLIENT_TEMPLATE_FIELD_ERROR if a merge field
+     *  has no value. The output is empty on error.
+     */
+    int render(const std::map<std::string, std::string> &pFields, RenderedTemplate &pOutput) const;
+
+    /** Return the content of the template. */
+    std::string_view getContent() const;
+
+    /** Return the number of merge fields in the content. A field used
+     *  several times is counted each time. */
+    size_t getFieldCount() const;
+
+    /**
+     *  @brief  Return the name of a merge field.
+     *  @param pIndex The index of the field in the content.
+     *  @return The name or an empty view if the index is out of range.
+     */
+    std::string_view getFieldName(size_t pIndex) const;
+
+ private:
+    // The parts refer to the content by offset, so the copies of a
+    // template do not refer to the original
+    struct Part {
+        // The literal text that precedes the merge field
+        size_t literalOffset;
+        size_t literalSize;
+        // The name of the merge field, empty for the last literal text
+        std::string name;
+    };
+    void parse();
+
+    std::string mContent;
+    std::vector<Part> mParts;
+};
+}  // namespace jed_utils
+
+#endif
@@ -0,0 +1,98 @@
+#include "mimeboundary.h"
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+using namespace jed_utils;
+
+const size_t MimeBoundary::GENERATED_LENGTH;
+const size_t MimeBoundary::MAX_LENGTH;
+
+namespace {
+// Characters allowed in a boundary without quoting issue, 6 bits each
+const char BOUNDARY_CHARACTERS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789._";
+const char GENERATED_PREFIX[] = "=_";
+const size_t GENERATED_PREFIX_LENGTH = sizeof(GENERATED_PREFIX) - 1;
+const unsigned int BITS_PER_CHARACTER = 6;
+const unsigned int CHARACTERS_PER_DRAW = 64 / BITS_PER_CHARACTER;
+
+// The random device is read once per thread, the boundaries are then
+// drawn from the generator
+std::mt19937_64 &getGenerator() {
+    static thread_local std::mt19937_64 generator { (static_cast<uint64_t>(std::random_device {}()) << 32) ^ std::random_device {}() };
+    return generator;
+}
+
+bool containsGeneratedPrefix(std::string_view pBody) {
+    const char *data = pBody.data();
+    size_t position = 0;
+    while (position + 1 < pBody.size()) {
+        const void *found = memchr(data + position, GENERATED_PREFIX[0], pBody.size() - position - 1);
+        if (found == nullptr) {
+            return false;
+        }
+        position = static_cast<size_t>(static_cast<const char *>(found) - data) + 1;
+        if (data[position] == GENERATED_PREFIX[1]) {
+            return true;
+        }
+    }
+    return false;
+}
+}  // namespace
+
+MimeBoundary::MimeBoundary() {
+    generateValue();
+}
+
+MimeBoundary::MimeBoundary(std::string_view pValue) {
+    if (pValue.empty() || pValue.size() > MAX_LENGTH) {
+        throw std::invalid_argument("The boundary must have 1 to 70 characters");
+    }
+    setValue(pValue);
+}
+
+void MimeBoundary::generate(std::string_view pBody) {
+    generateValue();
+    // Only a body with =_ can contain a generated boundary
+    if (!containsGeneratedPrefix(pBody)) {
+        return;
+    }
+    while (pBody.find(getValue()) != std::string_view::npos) {
+        generateValue();
+    }
+}
+
+std::string_view MimeBoundary::getValue() const {
+    return std::string_view(mBuffer + DELIMITER_PREFIX_LENGTH, mLength);
+}
+
+std::string_view MimeBoundary::getDelimiter() const {
+    return std::string_view(mBuffer + 2, mLength + 2);
+}
+
+std::string_view MimeBoundary::getClosingDelimiter() const {
+    return std::string_view(mBuffer, DELIMITER_PREFIX_LENGTH + mLength + 2);
+}
+
+void MimeBoundary::setValue(std::string_view pValue) {
+    memcpy(mBuffer, "\r\n--", DELIMITER_PREFIX_LENGTH);
+    memcpy(mBuffer + DELIMITER_PREFIX_LENGTH, pValue.data(), pValue.size());
+    memcpy(mBuffer + DELIMITER_PREFIX_LENGTH + pValue.size(), "--", 2);
+    mLength = pValue.size();
+}
+
+void MimeBoundary::generateValue() {
+    char value[GENERATED_LENGTH];
+    memcpy(value, GENERATED_PREFIX, GENERATED_PREFIX_LENGTH);
+    std::mt19937_64 &generator = getGenerator();
+    uint64_t bits = 0;
+    for (size_t index = GENERATED_PREFIX_LENGTH; index < GENERATED_LENGTH; index++) {
+        if ((index - GENERATED_PREFIX_LENGTH) % CHARACTERS_PER_DRAW == 0) {
+            bits = generator();
+        }
+        value[index] = BOUNDARY_CHARACTERS[bits & 0x3F];
+        bits >>= BITS_PER_CHARACTER;
+    }
+    setValue(std::string_view(value, GENERATED_LENGTH));
+}
@@ -0,0 +1,79 @@
+#ifndef MIMEBOUNDARY_H
+#define MIMEBOUNDARY_H
+
+#include <cstddef>
+#include <string_view>
+
+#ifdef _WIN32
+    #ifdef SMTPCLIENT_EXPORTS
+        #define MIMEBOUNDARY_API __declspec(dllexport)
+    #else
+        #define MIMEBOUNDARY_API __declspec(dllimport)
+    #endif
+#else
+    #define MIMEBOUNDARY_API
+#endif
+
+namespace jed_utils {
+/** @brief The MimeBoundary class is the boundary that delimits the parts of
+ *  a multipart message (RFC 2046 section 5.1.1).
+ *
+ *  A generated boundary starts with =_ followed by 22 random characters
+ *  drawn from a generator seeded once per thread. The =_ sequence cannot
+ *  appear in base64 or quoted-printable content, nor in a 7bit attachment
+ *  since its equal signs would have been encoded, so only the text of the
+ *  body is checked, and quickly skipped when it has no =_. The 132 random
+ *  bits make a collision with binary content negligible.
+ *
+ *  The delimiters are views on an inline buffer, so a boundary is copied
+ *  and regenerated without allocation.
+ */
+class MIMEBOUNDARY_API MimeBoundary {
+ public:
+    /** The length of a generated boundary. */
+    static const size_t GENERATED_LENGTH = 24;
+
+    /** The maximum length of a boundary (RFC 2046 section 5.1.1). */
+    static const size_t MAX_LENGTH = 70;
+
+    /** Construct a new random MimeBoundary. */
+    MimeBoundary();
+
+    /**
+     *  @brief  Construct a MimeBoundary with a fixed value.
+     *  @param pValue The boundary. Example: sep
+     *  @exception std::invalid_argument pValue is empty or longer than 70
+     *  characters.
+     */
+    explicit MimeBoundary(std::string_view pValue);
+
+    /**
+     *  @brief  Replace the value by a new random one.
+     *  @param pBody The text that must not contain the boundary, usually the
+     *  body of the message.
+     */
+    void generate(std::string_view pBody = {});
+
+    /** Return the boundary, as in the boundary parameter. Example: =_a1B2 */
+    std::string_view getValue() const;
+
+    /** Return the delimiter line that precedes each part, without its line
+     *  break. Example: --=_a1B2 */
+    std::string_view getDelimiter() const;
+
+    /** Return the delimiter that closes the multipart content, preceded by
+     *  its line break. Example: \r\n--=_a1B2-- */
+    std::string_view getClosingDelimiter() const;
+
+ private:
+    // "\r\n--" + value + "--"
+    static const size_t DELIMITER_PREFIX_LENGTH = 4;
+    char mBuffer[DELIMITER_PREFIX_LENGTH + MAX_LENGTH + 2];
+    size_t mLength = 0;
+
+    void setValue(std::string_view pValue);
+    void generateValue();
+};
+}  // namespace jed_utils
+
+#endif
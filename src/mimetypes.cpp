@@ -0,0 +1,199 @@
+#include "mimetypes.h"
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace jed_utils;
+
+namespace {
+struct MimeTypeEntry {
+    std::string_view extension;
+    const char *mimeType;
+};
+
+// Sorted by extension in lower case
+constexpr MimeTypeEntry MIME_TYPES[] {
+    { "avi", "video/x-msvideo" },
+    { "conf", "text/plain" },
+    { "css", "text/css" },
+    { "csv", "text/csv" },
+    { "def", "text/plain" },
+    { "doc", "application/msword" },
+    { "docx", "application/vnd.openxmlformats-officedocument.wordprocessingml.document" },
+    { "dot", "application/msword" },
+    { "dotx", "application/vnd.openxmlformats-officedocument.wordprocessingml.template" },
+    { "flv", "video/x-flv" },
+    { "gif", "image/gif" },
+    { "gz", "application/gzip" },
+    { "htm", "text/html" },
+    { "html", "text/html" },
+    { "ico", "image/x-icon" },
+    { "in", "text/plain" },
+    { "jpe", "image/jpeg" },
+    { "jpeg", "image/jpeg" },
+    { "jpg", "image/jpeg" },
+    { "js", "application/javascript" },
+    { "list", "text/plain" },
+    { "log", "text/plain" },
+    { "m1v", "video/mpeg" },
+    { "m2v", "video/mpeg" },
+    { "mov", "video/quicktime" },
+    { "mp4", "video/mp4" },
+    { "mp4v", "video/mp4" },
+    { "mpe", "video/mpeg" },
+    { "mpeg", "video/mpeg" },
+    { "mpg", "video/mpeg" },
+    { "mpg4", "video/mp4" },
+    { "odg", "application/vnd.oasis.opendocument.graphics" },
+    { "odp", "application/vnd.oasis.opendocument.presentation" },
+    { "ods", "application/vnd.oasis.opendocument.spreadsheet" },
+    { "odt", "application/vnd.oasis.opendocument.text" },
+    { "pdf", "application/pdf" },
+    { "png", "image/png" },
+    { "pot", "application/vnd.ms-powerpoint" },
+    { "potm", "application/vnd.ms-powerpoint.template.macroenabled.12" },
+    { "potx", "application/vnd.openxmlformats-officedocument.presentationml.template" },
+    { "ppam", "application/vnd.ms-powerpoint.addin.macroenabled.12" },
+    { "pps", "application/vnd.ms-powerpoint" },
+    { "ppsm", "application/vnd.ms-powerpoint.slideshow.macroenabled.12" },
+    { "ppsx", "application/vnd.openxmlformats-officedocument.presentationml.slideshow" },
+    { "ppt", "application/vnd.ms-powerpoint" },
+    { "pptm", "application/vnd.ms-powerpoint.presentation.macroenabled.12" },
+    { "pptx", "application/vnd.openxmlformats-officedocument.presentationml.presentation" },
+    { "qt", "video/quicktime" },
+    { "rar", "application/x-rar-compressed" },
+    { "sldm", "application/vnd.ms-powerpoint.slide.macroenabled.12" },
+    { "sldx", "application/vnd.openxmlformats-officedocument.presentationml.slide" },
+    { "text", "text/plain" },
+    { "tif", "image/tiff" },
+    { "tiff", "image/tiff" },
+    { "txt", "text/plain" },
+    { "webm", "video/webm" },
+    { "wmv", "video/x-ms-wmv" },
+    { "xht", "application/xhtml+xml" },
+    { "xhtml", "application/xhtml+xml" },
+    { "xla", "application/vnd.ms-excel" },
+    { "xlam", "application/vnd.ms-excel.addin.macroenabled.12" },
+    { "xlc", "application/vnd.ms-excel" },
+    { "xlm", "application/vnd.ms-excel" },
+    { "xls", "application/vnd.ms-excel" },
+    { "xlsb", "application/vnd.ms-excel.sheet.binary.macroenabled.12" },
+    { "xlsm", "application/vnd.ms-excel.sheet.macroenabled.12" },
+    { "xlsx", "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet" },
+    { "xlt", "application/vnd.ms-excel" },
+    { "xltm", "application/vnd.ms-excel.template.macroenabled.12" },
+    { "xltx", "application/vnd.openxmlformats-officedocument.spreadsheetml.template" },
+    { "xlw", "application/vnd.ms-excel" },
+    { "xml", "application/xml" },
+    { "xsl", "application/xml" },
+    { "xul", "application/vnd.mozilla.xul+xml" },
+    { "zip", "application/zip" },
+};
+
+constexpr char toLower(char pChar) {
+    return pChar >= 'A' && pChar <= 'Z' ? static_cast<char>(pChar - 'A' + 'a') : pChar;
+}
+
+constexpr int compareNoCase(std::string_view pFirst, std::string_view pSecond) {
+    const size_t length = pFirst.size() < pSecond.size() ? pFirst.size() : pSecond.size();
+    for (size_t index = 0; index < length; index++) {
+        const char first = toLower(pFirst[index]);
+        const char second = toLower(pSecond[index]);
+        if (first != second) {
+            return first < second ? -1 : 1;
+        }
+    }
+    if (pFirst.size() == pSecond.size()) {
+        return 0;
+    }
+    return pFirst.size() < pSecond.size() ? -1 : 1;
+}
+
+constexpr bool isSorted() {
+    for (size_t index = 1; index < std::size(MIME_TYPES); index++) {
+        if (compareNoCase(MIME_TYPES[index - 1].extension, MIME_TYPES[index].extension) >= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(isSorted(), "The MIME types must be sorted by extension");
+
+struct RegisteredMimeType {
+    std::string extension;
+    const std::string *mimeType;
+};
+
+// The types registered by the application, sorted like the table. The
+// types are never freed so that the pointers returned stay valid.
+struct Registry {
+    std::shared_mutex mutex;
+    std::vector<RegisteredMimeType> entries;
+    std::deque<std::string> mimeTypes;
+};
+
+Registry &getRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+template <typename Iterator>
+Iterator lowerBound(Iterator pBegin, Iterator pEnd, std::string_view pExtension) {
+    return std::lower_bound(pBegin, pEnd, pExtension, [](const auto &pEntry, std::string_view pValue) {
+        return compareNoCase(pEntry.extension, pValue) < 0;
+    });
+}
+}  // namespace
+
+const char *MimeTypes::find(std::string_view pExtension) {
+    Registry &registry = getRegistry();
+    {
+        std::shared_lock<std::shared_mutex> lock(registry.mutex);
+        if (!registry.entries.empty()) {
+            auto entry = lowerBound(registry.entries.begin(), registry.entries.end(), pExtension);
+            if (entry != registry.entries.end() && compareNoCase(entry->extension, pExtension) == 0) {
+                return entry->mimeType->c_str();
+            }
+        }
+    }
+    const auto entry = lowerBound(std::begin(MIME_TYPES), std::end(MIME_TYPES), pExtension);
+    if (entry != std::end(MIME_TYPES) && compareNoCase(entry->extension, pExtension) == 0) {
+        return entry->mimeType;
+    }
+    return "";
+}
+
+void MimeTypes::registerMimeType(std::string_view pExtension, std::string_view pMimeType) {
+    if (!pExtension.empty() && pExtension.front() == '.') {
+        pExtension.remove_prefix(1);
+    }
+    if (pExtension.empty()) {
+        throw std::invalid_argument("extension");
+    }
+    if (pMimeType.empty()) {
+        throw std::invalid_argument("mimeType");
+    }
+    Registry &registry = getRegistry();
+    std::unique_lock<std::shared_mutex> lock(registry.mutex);
+    registry.mimeTypes.emplace_back(pMimeType);
+    const std::string *mime_type = &registry.mimeTypes.back();
+    auto entry = lowerBound(registry.entries.begin(), registry.entries.end(), pExtension);
+    if (entry != registry.entries.end() && compareNoCase(entry->extension, pExtension) == 0) {
+        entry->mimeType = mime_type;
+    } else {
+        registry.entries.insert(entry, RegisteredMimeType { std::string(pExtension), mime_type });
+    }
+}
+
+void MimeTypes::clearRegisteredMimeTypes() {
+    Registry &registry = getRegistry();
+    std::unique_lock<std::shared_mutex> lock(registry.mutex);
+    registry.entries.clear();
+}
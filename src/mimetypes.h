@@ -0,0 +1,51 @@
+#ifndef MIMETYPES_H
+#define MIMETYPES_H
+
+#include <string_view>
+
+#ifdef _WIN32
+    #ifdef SMTPCLIENT_EXPORTS
+        #define MIMETYPES_API __declspec(dllexport)
+    #else
+        #define MIMETYPES_API __declspec(dllimport)
+    #endif
+#else
+    #define MIMETYPES_API
+#endif
+
+namespace jed_utils {
+/** @brief The MimeTypes class gives the MIME type of the attachments from
+ *  the extension of their file name.
+ *
+ *  The extensions known by the library are kept in a table sorted at
+ *  compile time and compared without case and without allocating. The
+ *  application can register other extensions or replace the type of a
+ *  known extension, preferably at startup.
+ */
+class MIMETYPES_API MimeTypes {
+ public:
+    /**
+     *  @brief  Return the MIME type of an extension.
+     *  @param pExtension The extension without the dot, in any case.
+     *  Example: pdf, PNG
+     *  @return The MIME type or an empty string if the extension is unknown.
+     */
+    static const char *find(std::string_view pExtension);
+
+    /**
+     *  @brief  Register the MIME type of an extension. The type registered
+     *  takes precedence over the type known by the library. This method is
+     *  thread-safe.
+     *  @param pExtension The extension, with or without the leading dot, in
+     *  any case.
+     *  @param pMimeType The MIME type. Example: application/json
+     *  @exception std::invalid_argument The extension or the type is empty.
+     */
+    static void registerMimeType(std::string_view pExtension, std::string_view pMimeType);
+
+    /** Remove the types registered by the application. */
+    static void clearRegisteredMimeTypes();
+};
+}  // namespace jed_utils
+
+#endif
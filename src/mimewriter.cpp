@@ -0,0 +1,314 @@
+#include "mimewriter.h"
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include "base64.h"
+#include "datanormalizer.h"
+#include "headerencoder.h"
+#include "quotedprintable.h"
+#include "smtpclienterrors.h"
+
+using namespace jed_utils;
+using namespace std::literals::string_literals;
+
+namespace {
+// The boundary is quoted since a generated one contains an equal sign
+void appendContentTypeField(const MimeBoundary &pBoundary, std::string &pOutput) {
+    pOutput.append("Content-Type: multipart/mixed; boundary=\"").append(pBoundary.getValue()).append("\"\r\n\r\n");
+}
+
+// Lines of 76 characters separated by CRLF
+size_t base64EncodedSize(size_t pContentSize) {
+    const size_t LINE_INPUT_LENGTH = 57;
+    if (pContentSize == 0) {
+        return 0;
+    }
+    const size_t line_count = (pContentSize + LINE_INPUT_LENGTH - 1) / LINE_INPUT_LENGTH;
+    return Base64::EncodedLength(pContentSize) + 2 * (line_count - 1);
+}
+
+// Each bare LF of the body is sent as CRLF
+size_t normalizedSize(std::string_view pData) {
+    size_t size = pData.size();
+    const char *data = pData.data();
+    size_t position = 0;
+    while (position < pData.size()) {
+        const void *found = memchr(data + position, '\n', pData.size() - position);
+        if (found == nullptr) {
+            break;
+        }
+        const size_t line_feed = static_cast<size_t>(static_cast<const char *>(found) - data);
+        if (line_feed == 0 || data[line_feed - 1] != '\r') {
+            size++;
+        }
+        position = line_feed + 1;
+    }
+    return size;
+}
+}  // namespace
+
+int MimeWriter::write(const Message &pMsg, const MessageAddress *pRecipient) {
+    clear();
+    mBuffer.reserve(estimateSize(pMsg));
+    mBoundary.generate(pMsg.getBodyView());
+
+    appendHeaders(pMsg, mBoundary, pRecipient, mBuffer);
+    endSegment();
+
+    mBuffer += createBodyPartHeader(pMsg, mBoundary);
+    // Bare LF are converted as the body is copied, the dots are stuffed
+    // only when the content is sent with DATA
+    DataNormalizer(false).normalize(pMsg.getBodyView(), mBuffer);
+    mBuffer += "\r\n";
+    endSegment();
+
+    Attachment** arr_attachment = pMsg.getAttachments();
+    for (size_t index = 0; index < pMsg.getAttachmentsCount(); index++) {
+        const Attachment &attachment = *arr_attachment[index];
+        const TransferEncoding encoding = mTextAttachmentEncodingEnabled ?
+            selectAttachmentEncoding(attachment) : TransferEncoding::Base64;
+        mBuffer += createAttachmentHeader(attachment, mBoundary, getTransferEncodingName(encoding));
+        bool content_written = false;
+        auto write_block = [this, &content_written](const std::string &pEncodedBlock) {
+            mBuffer += pEncodedBlock;
+            content_written = true;
+            return 0;
+        };
+        int stream_ret_code = 0;
+        if (encoding != TransferEncoding::Base64) {
+            stream_ret_code = attachment.streamQuotedPrintableEncodedFile(write_block);
+        } else if (mEncodedAttachmentCache != nullptr) {
+            stream_ret_code = mEncodedAttachmentCache->streamBase64EncodedFile(attachment, write_block);
+        } else {
+            stream_ret_code = attachment.streamBase64EncodedFile(write_block);
+        }
+        // Same rule as when the attachment is sent: a file that cannot be
+        // opened is an empty attachment, a file that cannot be read entirely
+        // is an error
+        if (content_written && stream_ret_code != 0) {
+            clear();
+            return CLIENT_SENDMAIL_BODYPART_ERROR;
+        }
+        endSegment();
+    }
+
+    mBuffer += mBoundary.getClosingDelimiter();
+    endSegment();
+    return 0;
+}
+
+void MimeWriter::setEncodedAttachmentCache(std::shared_ptr<EncodedAttachmentCache> pCache) {
+    mEncodedAttachmentCache = std::move(pCache);
+}
+
+void MimeWriter::setTextAttachmentEncodingEnabled(bool pValue) {
+    mTextAttachmentEncodingEnabled = pValue;
+}
+
+void MimeWriter::clear() {
+    mBuffer.clear();
+    mSegmentEnds.clear();
+}
+
+std::string_view MimeWriter::getContent() const {
+    return mBuffer;
+}
+
+const MimeBoundary &MimeWriter::getBoundary() const {
+    return mBoundary;
+}
+
+size_t MimeWriter::getSize() const {
+    return mBuffer.size();
+}
+
+size_t MimeWriter::getSegmentCount() const {
+    return mSegmentEnds.size();
+}
+
+std::string_view MimeWriter::getSegment(size_t pIndex) const {
+    if (pIndex >= mSegmentEnds.size()) {
+        return {};
+    }
+    const size_t start = pIndex == 0 ? 0 : mSegmentEnds[pIndex - 1];
+    return std::string_view(mBuffer).substr(start, mSegmentEnds[pIndex] - start);
+}
+
+void MimeWriter::appendHeaders(const Message &pMsg,
+        const MimeBoundary &pBoundary,
+        const MessageAddress *pRecipient,
+        std::string &pOutput) {
+    appendFromField(pMsg, pOutput);
+    appendRecipientFields(pMsg, pRecipient, pOutput);
+    HeaderEncoder::appendUnstructuredField(pOutput, "Subject", pMsg.getSubjectView());
+    appendContentTypeField(pBoundary, pOutput);
+}
+
+std::vector<std::pair<std::string, int>> MimeWriter::createHeaderLines(const Message &pMsg,
+        const MimeBoundary &pBoundary,
+        const MessageAddress *pRecipient) {
+    std::vector<std::pair<std::string, int>> lines;
+    std::string line;
+    appendFromField(pMsg, line);
+    lines.emplace_back(std::move(line), CLIENT_SENDMAIL_HEADERFROM_ERROR);
+
+    line.clear();
+    appendRecipientFields(pMsg, pRecipient, line);
+    if (!line.empty()) {
+        lines.emplace_back(std::move(line), CLIENT_SENDMAIL_HEADERTOANDCC_ERROR);
+    }
+
+    line.clear();
+    HeaderEncoder::appendUnstructuredField(line, "Subject", pMsg.getSubjectView());
+    lines.emplace_back(std::move(line), CLIENT_SENDMAIL_HEADERSUBJECT_ERROR);
+
+    line.clear();
+    appendContentTypeField(pBoundary, line);
+    lines.emplace_back(std::move(line), CLIENT_SENDMAIL_HEADERCONTENTTYPE_ERROR);
+    return lines;
+}
+
+std::string MimeWriter::createBodyPartHeader(const Message &pMsg,
+        const MimeBoundary &pBoundary,
+        const char *pTransferEncoding) {
+    std::string retval { pBoundary.getDelimiter() };
+    retval += "\r\nContent-Type: "s + pMsg.getMimeType();
+    // The parts of a multipart body declare their own charset
+    if (strncmp(pMsg.getMimeType(), "multipart/", 10) != 0) {
+        retval += "; charset=UTF-8";
+    }
+    retval += "\r\n";
+    if (pTransferEncoding != nullptr) {
+        retval += "Content-Transfer-Encoding: "s + pTransferEncoding + "\r\n"s;
+    }
+    retval += "\r\n";
+    return retval;
+}
+
+std::string MimeWriter::createAttachmentHeader(const Attachment &pAttachment,
+        const MimeBoundary &pBoundary,
+        const char *pTransferEncoding) {
+    std::string retval { "\r\n" };
+    retval += pBoundary.getDelimiter();
+    retval += "\r\n";
+    retval += "Content-Type: " + std::string(pAttachment.getMimeType()) + "; file=\"" + std::string(pAttachment.getName()) + "\"\r\n";
+    retval += "Content-Disposition: Inline; filename=\"" + std::string(pAttachment.getName()) + "\"\r\n";
+    retval += "Content-Transfer-Encoding: "s + pTransferEncoding + "\r\n\r\n"s;
+    return retval;
+}
+
+TransferEncoding MimeWriter::selectAttachmentEncoding(const Attachment &pAttachment, size_t *pEncodedSize) {
+    const std::optional<size_t> content_size = pAttachment.getSize();
+    const size_t base64_size = base64EncodedSize(content_size.value_or(0));
+    if (pEncodedSize != nullptr) {
+        *pEncodedSize = base64_size;
+    }
+    // A content of unknown size may be a stream that is costly to read
+    // twice
+    if (!content_size.has_value() || strncmp(pAttachment.getMimeType(), "text/", 5) != 0) {
+        return TransferEncoding::Base64;
+    }
+    QuotedPrintableEncoder encoder;
+    if (pAttachment.streamFile([&encoder](std::string_view pBlock) {
+                encoder.measure(pBlock);
+                return 0;
+            }) != 0) {
+        return TransferEncoding::Base64;
+    }
+    encoder.finishMeasure();
+    TransferEncoding encoding = TransferEncoding::Base64;
+    if (encoder.getEscapedCount() == 0 && encoder.getSoftLineBreakCount() == 0) {
+        // Only the line breaks were normalized, the content is sent as is
+        encoding = TransferEncoding::SevenBit;
+    } else if (encoder.getEncodedSize() < base64_size) {
+        encoding = TransferEncoding::QuotedPrintable;
+    }
+    if (pEncodedSize != nullptr && encoding != TransferEncoding::Base64) {
+        *pEncodedSize = encoder.getEncodedSize();
+    }
+    return encoding;
+}
+
+const char *MimeWriter::getTransferEncodingName(TransferEncoding pEncoding) {
+    switch (pEncoding) {
+        case TransferEncoding::SevenBit:
+            return "7bit";
+        case TransferEncoding::QuotedPrintable:
+            return "quoted-printable";
+        case TransferEncoding::Binary:
+            return "binary";
+        case TransferEncoding::Base64:
+        default:
+            return "base64";
+    }
+}
+
+bool MimeWriter::containsEightBitData(const Message &pMsg) {
+    return containsEightBitData(pMsg.getSubjectView()) || containsEightBitData(pMsg.getBodyView());
+}
+
+bool MimeWriter::containsEightBitData(std::string_view pData) {
+    return std::any_of(pData.begin(), pData.end(), [](char pChar) {
+            return (static_cast<unsigned char>(pChar) & 0x80) != 0;
+            });
+}
+
+void MimeWriter::appendFromField(const Message &pMsg, std::string &pOutput) {
+    pOutput.append("From: ").append(pMsg.getFrom().getEmailAddress()).append("\r\n");
+}
+
+void MimeWriter::appendRecipientFields(const Message &pMsg, const MessageAddress *pRecipient, std::string &pOutput) {
+    // Note : Bcc are not included in the header
+    if (pRecipient != nullptr) {
+        pOutput.append("To: ").append(pRecipient->getEmailAddress()).append("\r\n");
+        return;
+    }
+    // The Cc recipients follow the To recipients in the table
+    const RecipientTable &table = pMsg.getRecipients();
+    const size_t cc_end = pMsg.getToCount() + pMsg.getCcCount();
+    HeaderEncoder::appendAddressField(pOutput, "To", table, 0, pMsg.getToCount());
+    HeaderEncoder::appendAddressField(pOutput, "Cc", table, pMsg.getToCount(), cc_end);
+}
+
+void MimeWriter::endSegment() {
+    mSegmentEnds.push_back(mBuffer.size());
+}
+
+size_t MimeWriter::estimateSize(const Message &pMsg) {
+    // The headers and the part delimiters are small compared to the body
+    // and the attachments, a fixed allowance covers them in most cases
+    const size_t HEADERS_ALLOWANCE = 1024;
+    const size_t ATTACHMENT_HEADER_ALLOWANCE = 256;
+    size_t size = HEADERS_ALLOWANCE + pMsg.getBodyView().size();
+    Attachment** arr_attachment = pMsg.getAttachments();
+    for (size_t index = 0; index < pMsg.getAttachmentsCount(); index++) {
+        const auto content_size = arr_attachment[index]->getSize();
+        size += ATTACHMENT_HEADER_ALLOWANCE + base64EncodedSize(content_size.value_or(0));
+    }
+    return size;
+}
+
+size_t MimeWriter::computeSize(const Message &pMsg,
+        const MimeBoundary &pBoundary,
+        const MessageAddress *pRecipient,
+        const char *pBodyTransferEncoding,
+        bool pBinaryAttachments,
+        bool pTextAttachmentEncoding) {
+    std::string headers;
+    appendHeaders(pMsg, pBoundary, pRecipient, headers);
+    size_t size = headers.size();
+    size += createBodyPartHeader(pMsg, pBoundary, pBodyTransferEncoding).size() + normalizedSize(pMsg.getBodyView()) + 2;
+    Attachment** arr_attachment = pMsg.getAttachments();
+    for (size_t index = 0; index < pMsg.getAttachmentsCount(); index++) {
+        const Attachment &attachment = *arr_attachment[index];
+        if (pBinaryAttachments) {
+            size += createAttachmentHeader(attachment, pBoundary, "binary").size() + attachment.getSize().value_or(0);
+            continue;
+        }
+        size_t encoded_size = base64EncodedSize(attachment.getSize().value_or(0));
+        const TransferEncoding encoding = pTextAttachmentEncoding ?
+            selectAttachmentEncoding(attachment, &encoded_size) : TransferEncoding::Base64;
+        size += createAttachmentHeader(attachment, pBoundary, getTransferEncodingName(encoding)).size() + encoded_size;
+    }
+    return size + pBoundary.getClosingDelimiter().size();
+}
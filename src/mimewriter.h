@@ -0,0 +1,209 @@
+#ifndef MIMEWRITER_H
+#define MIMEWRITER_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "attachment.h"
+#include "encodedattachmentcache.h"
+#include "message.h"
+#include "messageaddress.h"
+#include "mimeboundary.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define MIMEWRITER_API __declspec(dllexport)
+    #else
+        #define MIMEWRITER_API __declspec(dllimport)
+    #endif
+#else
+    #define MIMEWRITER_API
+#endif
+
+namespace jed_utils {
+/** @brief The Content-Transfer-Encoding of a part of a message. */
+enum class TransferEncoding {
+    SevenBit,
+    QuotedPrintable,
+    Base64,
+    Binary
+};
+
+/** @brief The MimeWriter serializes a message once into a contiguous
+ *  buffer, as it is sent after the DATA command. The rendered content can
+ *  then be sent, retried or spooled without encoding the message again.
+ *
+ *  Each message gets a new random boundary, absent from its body. The
+ *  content is also split into segments: the headers, the body part, each
+ *  attachment part and the closing delimiter. The buffer is kept
+ *  between messages so that writing a message does not allocate once its
+ *  capacity has grown to the size of the messages. The views returned
+ *  remain valid until the next call to write or clear.
+ *
+ *  A cpp::PlaintextMessage or a cpp::HtmlMessage can be written too since
+ *  it converts to its jed_utils counterpart.
+ */
+class MIMEWRITER_API MimeWriter {
+ public:
+    /** Construct a new empty MimeWriter. */
+    MimeWriter() = default;
+
+    /**
+     *  @brief  Render a message, replacing the previous content.
+     *  @param pMsg The message to render.
+     *  @param pRecipient The only recipient of the To header or nullptr to
+     *  render the To and Cc headers of the message.
+     *  @return 0 for success or CLIENT_SENDMAIL_BODYPART_ERROR if an
+     *  attachment could not be read entirely. The content is empty on error.
+     */
+    int write(const Message &pMsg, const MessageAddress *pRecipient = nullptr);
+
+    /** Indicate if the text attachments are written in 7bit or in
+     *  quoted-printable when it is smaller than base64, as chosen by
+     *  selectAttachmentEncoding. Default: false */
+    void setTextAttachmentEncodingEnabled(bool pValue);
+
+    /** Set the cache of the encoded attachments or nullptr to encode the
+     *  attachments each time. Default: nullptr */
+    void setEncodedAttachmentCache(std::shared_ptr<EncodedAttachmentCache> pCache);
+
+    /** Discard the content. The capacity of the buffer is kept. */
+    void clear();
+
+    /** Return the rendered content. */
+    std::string_view getContent() const;
+
+    /** Return the boundary of the rendered content. */
+    const MimeBoundary &getBoundary() const;
+
+    /** Return the total size of the rendered content. */
+    size_t getSize() const;
+
+    /** Return the number of segments of the rendered content. */
+    size_t getSegmentCount() const;
+
+    /**
+     *  @brief  Return a segment of the rendered content.
+     *  @param pIndex The index of the segment.
+     *  @return The segment or an empty view if the index is out of range.
+     */
+    std::string_view getSegment(size_t pIndex) const;
+
+    /**
+     *  @brief  Append the headers of a message to a buffer. A subject that
+     *  is not ASCII is written as encoded-words (RFC 2047), the To and the
+     *  Cc addresses are each written in a single field folded at 78
+     *  characters.
+     *  @param pMsg The message.
+     *  @param pBoundary The boundary of the multipart content.
+     *  @param pRecipient The only recipient of the To header or nullptr to
+     *  use the To and Cc addresses of the message.
+     *  @param pOutput The buffer that receives the headers and the blank
+     *  line that ends them.
+     */
+    static void appendHeaders(const Message &pMsg,
+            const MimeBoundary &pBoundary,
+            const MessageAddress *pRecipient,
+            std::string &pOutput);
+
+    /**
+     *  @brief  Return the header fields of a message, each with the error
+     *  code reported when it cannot be sent. The To and the Cc fields are
+     *  returned together.
+     *  @param pMsg The message.
+     *  @param pBoundary The boundary of the multipart content.
+     *  @param pRecipient The only recipient of the To header or nullptr to
+     *  use the To and Cc addresses of the message.
+     */
+    static std::vector<std::pair<std::string, int>> createHeaderLines(const Message &pMsg,
+            const MimeBoundary &pBoundary,
+            const MessageAddress *pRecipient = nullptr);
+
+    /**
+     *  @brief  Return the part header that precedes the body of a message.
+     *  The charset is omitted for a multipart body, whose parts declare it.
+     *  @param pMsg The message.
+     *  @param pBoundary The boundary of the multipart content.
+     *  @param pTransferEncoding The Content-Transfer-Encoding of the body or
+     *  nullptr to omit the field (7bit).
+     */
+    static std::string createBodyPartHeader(const Message &pMsg,
+            const MimeBoundary &pBoundary,
+            const char *pTransferEncoding = nullptr);
+
+    /**
+     *  @brief  Return the part header that precedes the content of an attachment.
+     *  @param pAttachment The attachment.
+     *  @param pBoundary The boundary of the multipart content.
+     *  @param pTransferEncoding The Content-Transfer-Encoding of the content.
+     *  Example: base64, binary
+     */
+    static std::string createAttachmentHeader(const Attachment &pAttachment,
+            const MimeBoundary &pBoundary,
+            const char *pTransferEncoding = "base64");
+
+    /**
+     *  @brief  Choose the Content-Transfer-Encoding of an attachment. A
+     *  content of a text type whose size is known is read once and written
+     *  in 7bit if no character has to be encoded, in quoted-printable if it
+     *  is smaller than base64, otherwise in base64. The other attachments
+     *  are written in base64.
+     *  @param pAttachment The attachment.
+     *  @param pEncodedSize Receive the size of the encoded content if it is
+     *  not nullptr.
+     */
+    static TransferEncoding selectAttachmentEncoding(const Attachment &pAttachment, size_t *pEncodedSize = nullptr);
+
+    /** Return the Content-Transfer-Encoding field value of an encoding.
+     *  Example: quoted-printable */
+    static const char *getTransferEncodingName(TransferEncoding pEncoding);
+
+    /**
+     *  @brief  Return the size of a message as it is sent, without rendering
+     *  it. A line that starts with a dot counts once, as for the SIZE
+     *  parameter of the MAIL FROM command (RFC 1870).
+     *  @param pMsg The message.
+     *  @param pBoundary The boundary of the multipart content.
+     *  @param pRecipient The only recipient of the To header or nullptr to
+     *  use the To and Cc addresses of the message.
+     *  @param pBodyTransferEncoding The Content-Transfer-Encoding of the body
+     *  or nullptr to omit the field (7bit).
+     *  @param pBinaryAttachments True if the attachments are sent without
+     *  base64 (RFC 3030).
+     *  @param pTextAttachmentEncoding True if the encoding of the text
+     *  attachments is chosen by selectAttachmentEncoding, which reads them.
+     *  @return The size in bytes. An attachment whose size is not known before
+     *  it is read only counts for its part header.
+     */
+    static size_t computeSize(const Message &pMsg,
+            const MimeBoundary &pBoundary,
+            const MessageAddress *pRecipient = nullptr,
+            const char *pBodyTransferEncoding = nullptr,
+            bool pBinaryAttachments = false,
+            bool pTextAttachmentEncoding = false);
+
+    /** Indicate if the subject or the body of a message contains bytes
+     *  outside of the 7-bit ASCII range. */
+    static bool containsEightBitData(const Message &pMsg);
+
+    /** Indicate if data contains bytes outside of the 7-bit ASCII range. */
+    static bool containsEightBitData(std::string_view pData);
+
+ private:
+    void endSegment();
+    static void appendFromField(const Message &pMsg, std::string &pOutput);
+    static void appendRecipientFields(const Message &pMsg, const MessageAddress *pRecipient, std::string &pOutput);
+    static size_t estimateSize(const Message &pMsg);
+
+    std::string mBuffer;
+    std::vector<size_t> mSegmentEnds;
+    MimeBoundary mBoundary;
+    std::shared_ptr<EncodedAttachmentCache> mEncodedAttachmentCache;
+    bool mTextAttachmentEncodingEnabled = false;
+};
+}  // namespace jed_utils
+
+#endif
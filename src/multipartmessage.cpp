@@ -0,0 +1,153 @@
+#include "multipartmessage.h"
+#include <stdexcept>
+#include <utility>
+#include "mimeboundary.h"
+#include "stringutils.h"
+
+using namespace jed_utils;
+
+namespace {
+// A boundary absent from both versions of the body
+MimeBoundary createBoundary(std::string_view pTextBody, std::string_view pHtmlBody) {
+    MimeBoundary boundary;
+    do {
+        boundary.generate(pTextBody);
+    } while (pHtmlBody.find(boundary.getValue()) != std::string_view::npos);
+    return boundary;
+}
+
+void appendDelimiterLine(const MimeBoundary &pBoundary, std::string &pOutput) {
+    pOutput.append(pBoundary.getDelimiter()).append("\r\n");
+}
+
+// The nested parts declare their 8-bit content themselves since they do
+// not inherit the encoding of the body part
+void appendTextPart(const MimeBoundary &pBoundary,
+        const char *pMimeType,
+        std::string_view pText,
+        std::string &pOutput,
+        size_t &pTextStart) {
+    appendDelimiterLine(pBoundary, pOutput);
+    pOutput.append("Content-Type: ").append(pMimeType).append("; charset=UTF-8\r\n");
+    if (!StringUtils::isAscii(pText)) {
+        pOutput.append("Content-Transfer-Encoding: 8bit\r\n");
+    }
+    pOutput.append("\r\n");
+    pTextStart = pOutput.size();
+    pOutput.append(pText).append("\r\n");
+}
+
+void validateContentId(std::string_view pContentId) {
+    if (pContentId.empty() || pContentId.find_first_of("\r\n<>") != std::string_view::npos) {
+        throw std::invalid_argument("ContentId");
+    }
+}
+}  // namespace
+
+MultipartMessage::MultipartMessage(MessageAddress pFrom,
+        std::vector<MessageAddress> pTo,
+        std::string pSubject,
+        std::string_view pTextBody,
+        std::string_view pHtmlBody,
+        const std::vector<InlineResource> &pInlineResources,
+        std::vector<MessageAddress> pCc,
+        std::vector<MessageAddress> pBcc,
+        std::vector<Attachment> pAttachments,
+        EncodedAttachmentCache *pEncodedAttachmentCache)
+    : MultipartMessage(std::move(pFrom), std::move(pTo), std::move(pSubject),
+            renderBody(pTextBody, pHtmlBody, pInlineResources, pEncodedAttachmentCache),
+            std::move(pCc), std::move(pBcc), std::move(pAttachments)) {
+}
+
+MultipartMessage::MultipartMessage(MessageAddress pFrom,
+        std::vector<MessageAddress> pTo,
+        std::string pSubject,
+        RenderedBody pBody,
+        std::vector<MessageAddress> pCc,
+        std::vector<MessageAddress> pBcc,
+        std::vector<Attachment> pAttachments)
+    : Message(std::move(pFrom), std::move(pTo), std::move(pSubject), std::move(pBody.Content),
+            std::move(pCc), std::move(pBcc), std::move(pAttachments)),
+      mMimeType(std::move(pBody.MimeType)),
+      mTextStart(pBody.TextStart),
+      mTextLength(pBody.TextLength),
+      mHtmlStart(pBody.HtmlStart),
+      mHtmlLength(pBody.HtmlLength),
+      mInlineResourceCount(pBody.InlineResourceCount) {
+}
+
+const char *MultipartMessage::getMimeType() const {
+    return mMimeType.c_str();
+}
+
+std::string_view MultipartMessage::getTextBodyView() const {
+    return getBodyView().substr(mTextStart, mTextLength);
+}
+
+std::string_view MultipartMessage::getHtmlBodyView() const {
+    return getBodyView().substr(mHtmlStart, mHtmlLength);
+}
+
+size_t MultipartMessage::getInlineResourceCount() const {
+    return mInlineResourceCount;
+}
+
+MultipartMessage::RenderedBody MultipartMessage::renderBody(std::string_view pTextBody,
+        std::string_view pHtmlBody,
+        const std::vector<InlineResource> &pInlineResources,
+        EncodedAttachmentCache *pEncodedAttachmentCache) {
+    for (const InlineResource &resource : pInlineResources) {
+        validateContentId(resource.ContentId);
+    }
+    RenderedBody rendered;
+    rendered.InlineResourceCount = pInlineResources.size();
+    std::string content;
+    const MimeBoundary alternative_boundary = createBoundary(pTextBody, pHtmlBody);
+    std::string alternative_type { "multipart/alternative; boundary=\"" };
+    alternative_type.append(alternative_boundary.getValue()).append("\"");
+
+    // The related part wraps the alternative one when there are resources
+    const MimeBoundary related_boundary = createBoundary(pTextBody, pHtmlBody);
+    if (pInlineResources.empty()) {
+        rendered.MimeType = std::move(alternative_type);
+    } else {
+        rendered.MimeType.assign("multipart/related; type=\"multipart/alternative\"; boundary=\"")
+            .append(related_boundary.getValue()).append("\"");
+        appendDelimiterLine(related_boundary, content);
+        content.append("Content-Type: ").append(alternative_type).append("\r\n\r\n");
+    }
+
+    appendTextPart(alternative_boundary, "text/plain", pTextBody, content, rendered.TextStart);
+    rendered.TextLength = pTextBody.size();
+    appendTextPart(alternative_boundary, "text/html", pHtmlBody, content, rendered.HtmlStart);
+    rendered.HtmlLength = pHtmlBody.size();
+    content.append(alternative_boundary.getDelimiter()).append("--");
+
+    for (const InlineResource &resource : pInlineResources) {
+        const Attachment &attachment = resource.Content;
+        content.append("\r\n");
+        appendDelimiterLine(related_boundary, content);
+        content.append("Content-Type: ").append(attachment.getMimeType()).append("; name=\"").append(attachment.getName()).append("\"\r\n");
+        content.append("Content-ID: <").append(resource.ContentId).append(">\r\n");
+        content.append("Content-Disposition: inline; filename=\"").append(attachment.getName()).append("\"\r\n");
+        content.append("Content-Transfer-Encoding: base64\r\n\r\n");
+        bool content_written = false;
+        auto write_block = [&content, &content_written](const std::string &pEncodedBlock) {
+            content += pEncodedBlock;
+            content_written = true;
+            return 0;
+        };
+        const int stream_ret_code = pEncodedAttachmentCache != nullptr ?
+            pEncodedAttachmentCache->streamBase64EncodedFile(attachment, write_block) :
+            attachment.streamBase64EncodedFile(write_block);
+        // Same rule as for the attachments when they are sent
+        if (content_written && stream_ret_code != 0) {
+            throw std::runtime_error("The inline resource could not be read entirely");
+        }
+    }
+    if (!pInlineResources.empty()) {
+        content.append(related_boundary.getClosingDelimiter());
+    }
+    rendered.Content = std::make_shared<const std::string>(std::move(content));
+    return rendered;
+}
@@ -0,0 +1,124 @@
+#ifndef MULTIPARTMESSAGE_H
+#define MULTIPARTMESSAGE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "attachment.h"
+#include "encodedattachmentcache.h"
+#include "message.h"
+#include "messageaddress.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define MULTIPARTMESSAGE_API __declspec(dllexport)
+    #else
+        #define MULTIPARTMESSAGE_API __declspec(dllimport)
+    #endif
+#else
+    #define MULTIPARTMESSAGE_API
+#endif
+
+namespace jed_utils {
+/** @brief A resource displayed by the HTML body of a MultipartMessage,
+ *  usually an image, that the HTML references as cid:ContentId. */
+struct InlineResource {
+    // The content, its display name gives the MIME type
+    Attachment Content;
+    // The identifier, without the angle brackets. Example: logo@example.com
+    std::string ContentId;
+};
+
+/** @brief The MultipartMessage class represents an email message with an
+ *  HTML body and its plain text alternative (multipart/alternative), and
+ *  optionally the resources of the HTML (multipart/related, RFC 2387).
+ *
+ *  The alternative and related parts are rendered once, when the message is
+ *  constructed, and the inline resources are encoded in base64 at that
+ *  time. The rendered parts are the body of the message, shared with its
+ *  copies, so sending the message to each recipient of a batch neither
+ *  renders nor encodes them again. The attachments are added after the
+ *  body part as for the other messages.
+ */
+class MULTIPARTMESSAGE_API MultipartMessage : public Message {
+ public:
+    /**
+     *  @brief  Construct a new MultipartMessage.
+     *  @param pFrom The sender email address of the message.
+     *  @param pTo The recipients email addresses of the message.
+     *  @param pSubject The subject of the message.
+     *  @param pTextBody The plain text version of the body.
+     *  @param pHtmlBody The HTML version of the body.
+     *  @param pInlineResources The resources referenced by the HTML body.
+     *  @param pCc The carbon-copy recipients email addresses.
+     *  @param pBcc The blind carbon-copy recipients email addresses.
+     *  @param pAttachments The attachments of the message.
+     *  @param pEncodedAttachmentCache The cache of the encoded attachments
+     *  or nullptr, so that a resource shared by the messages of a batch is
+     *  encoded once.
+     *  @exception std::invalid_argument A content identifier is empty or
+     *  contains a line break or an angle bracket.
+     *  @exception std::runtime_error The content of a resource could not be
+     *  read entirely. A resource that cannot be opened is empty.
+     */
+    MultipartMessage(MessageAddress pFrom,
+            std::vector<MessageAddress> pTo,
+            std::string pSubject,
+            std::string_view pTextBody,
+            std::string_view pHtmlBody,
+            const std::vector<InlineResource> &pInlineResources = {},
+            std::vector<MessageAddress> pCc = {},
+            std::vector<MessageAddress> pBcc = {},
+            std::vector<Attachment> pAttachments = {},
+            EncodedAttachmentCache *pEncodedAttachmentCache = nullptr);
+
+    /** Return the Content-Type of the body part: multipart/alternative, or
+     *  multipart/related with inline resources, and its boundary. */
+    const char *getMimeType() const override;
+
+    /** Return the plain text version of the body. The body of the message
+     *  is the rendered multipart content. */
+    std::string_view getTextBodyView() const;
+
+    /** Return the HTML version of the body. */
+    std::string_view getHtmlBodyView() const;
+
+    /** Return the number of inline resources. */
+    size_t getInlineResourceCount() const;
+
+ private:
+    struct RenderedBody {
+        std::shared_ptr<const std::string> Content;
+        std::string MimeType;
+        size_t TextStart = 0;
+        size_t TextLength = 0;
+        size_t HtmlStart = 0;
+        size_t HtmlLength = 0;
+        size_t InlineResourceCount = 0;
+    };
+
+    MultipartMessage(MessageAddress pFrom,
+            std::vector<MessageAddress> pTo,
+            std::string pSubject,
+            RenderedBody pBody,
+            std::vector<MessageAddress> pCc,
+            std::vector<MessageAddress> pBcc,
+            std::vector<Attachment> pAttachments);
+    static RenderedBody renderBody(std::string_view pTextBody,
+            std::string_view pHtmlBody,
+            const std::vector<InlineResource> &pInlineResources,
+            EncodedAttachmentCache *pEncodedAttachmentCache);
+
+    std::string mMimeType;
+    size_t mTextStart;
+    size_t mTextLength;
+    size_t mHtmlStart;
+    size_t mHtmlLength;
+    size_t mInlineResourceCount;
+};
+}  // namespace jed_utils
+
+#endif
@@ -0,0 +1,227 @@
+#include "mxdeliveryclient.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <utility>
+#include "forcedsecuresmtpclient.h"
+#include "opportunisticsecuresmtpclient.h"
+#include "smtpclient.h"
+#include "smtpclienterrors.h"
+
+using namespace jed_utils;
+
+namespace {
+std::string toLower(std::string pValue) {
+    std::transform(pValue.begin(), pValue.end(), pValue.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return pValue;
+}
+
+// Run pTask for each index from 0 to pCount - 1 on up to pMaxThreads threads
+void runInParallel(size_t pCount, size_t pMaxThreads, const std::function<void(size_t)> &pTask) {
+    const size_t thread_count = (std::min)(pCount, (std::max)(pMaxThreads, static_cast<size_t>(1)));
+    if (thread_count <= 1) {
+        for (size_t index = 0; index < pCount; index++) {
+            pTask(index);
+        }
+        return;
+    }
+    std::atomic<size_t> next_index { 0 };
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    for (size_t thread_index = 0; thread_index < thread_count; thread_index++) {
+        threads.emplace_back([&next_index, pCount, &pTask]() {
+                for (size_t index = next_index++; index < pCount; index = next_index++) {
+                    pTask(index);
+                }
+                });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+}  // namespace
+
+MxDeliveryClient::MxDeliveryClient(SmtpClientType pType,
+        unsigned int pPort,
+        size_t pMaxParallelSessions)
+    : mType(pType),
+      mPort(pPort),
+      mMaxParallelSessions(pMaxParallelSessions == 0 ? 1 : pMaxParallelSessions),
+      mCommandTimeOutInSeconds(30),
+      mMxResolver(nullptr),
+      mTlsContext(nullptr) {
+}
+
+std::map<std::string, std::vector<MessageAddress>> MxDeliveryClient::groupRecipientsByDomain(const Message &pMsg) {
+    std::map<std::string, std::vector<MessageAddress>> groups;
+    const RecipientTable &recipients = pMsg.getRecipients();
+    for (size_t index = 0; index < recipients.size(); index++) {
+        const std::string_view email_address { recipients.getEmailAddressView(index) };
+        const size_t separator = email_address.rfind('@');
+        const std::string domain { separator == std::string::npos ? "" : toLower(std::string(email_address.substr(separator + 1))) };
+        groups[domain].emplace_back(recipients.getEmailAddress(index), recipients.getDisplayName(index));
+    }
+    return groups;
+}
+
+std::vector<DomainDeliveryResult> MxDeliveryClient::sendMail(const Message &pMsg) {
+    std::vector<DomainPlan> plans;
+    for (auto &group : groupRecipientsByDomain(pMsg)) {
+        DomainPlan plan;
+        plan.domain = group.first;
+        plan.recipients = std::move(group.second);
+        plans.push_back(std::move(plan));
+    }
+    std::vector<DomainDeliveryResult> results(plans.size());
+    for (size_t index = 0; index < plans.size(); index++) {
+        results[index].Domain = plans[index].domain;
+        for (const auto &recipient : plans[index].recipients) {
+            results[index].Recipients.emplace_back(recipient.getEmailAddress());
+        }
+    }
+
+    // Look up the mail exchangers of all the domains first
+    runInParallel(plans.size(), mMaxParallelSessions, [this, &plans](size_t pIndex) {
+            plans[pIndex].hosts = getExchangers(plans[pIndex].domain, plans[pIndex].lookupErrorCode);
+            });
+
+    // The domains are batched per primary mail exchanger
+    std::map<std::string, std::vector<size_t>> exchangers;
+    for (size_t index = 0; index < plans.size(); index++) {
+        if (plans[index].lookupErrorCode != 0) {
+            results[index].ReturnCode = plans[index].lookupErrorCode;
+        } else {
+            exchangers[toLower(plans[index].hosts.front())].push_back(index);
+        }
+    }
+    std::vector<const std::vector<size_t> *> batches;
+    for (const auto &exchanger : exchangers) {
+        batches.push_back(&exchanger.second);
+    }
+    runInParallel(batches.size(), mMaxParallelSessions, [this, &pMsg, &plans, &batches, &results](size_t pIndex) {
+            deliverToExchanger(pMsg, plans, *batches[pIndex], results);
+            });
+    return results;
+}
+
+void MxDeliveryClient::setDomainRoute(const char *pDomain, const char *pHost) {
+    const std::string domain { toLower(pDomain != nullptr ? pDomain : "") };
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (pHost == nullptr || strlen(pHost) == 0) {
+        mDomainRoutes.erase(domain);
+    } else {
+        mDomainRoutes[domain] = pHost;
+    }
+}
+
+void MxDeliveryClient::setMxResolver(MxResolver *pResolver) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMxResolver = pResolver;
+}
+
+void MxDeliveryClient::setTlsContext(std::shared_ptr<TlsContext> pTlsContext) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mTlsContext = std::move(pTlsContext);
+}
+
+void MxDeliveryClient::setCommandTimeout(unsigned int pTimeOutInSeconds) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCommandTimeOutInSeconds = pTimeOutInSeconds;
+}
+
+SMTPClientBase *MxDeliveryClient::createClient(const std::string &pHost) const {
+    std::shared_ptr<TlsContext> tls_context;
+    unsigned int command_timeout = 0;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        tls_context = mTlsContext;
+        command_timeout = mCommandTimeOutInSeconds;
+    }
+    SMTPClientBase *client = nullptr;
+    switch (mType) {
+        case SmtpClientType::Plain:
+            client = new SmtpClient(pHost.c_str(), mPort);
+            break;
+        case SmtpClientType::OpportunisticSecure: {
+            auto secure_client = new OpportunisticSecureSMTPClient(pHost.c_str(), mPort);
+            secure_client->setTlsContext(tls_context);
+            client = secure_client;
+            break;
+        }
+        case SmtpClientType::ForcedSecure: {
+            auto secure_client = new ForcedSecureSMTPClient(pHost.c_str(), mPort);
+            secure_client->setTlsContext(tls_context);
+            client = secure_client;
+            break;
+        }
+    }
+    if (client != nullptr) {
+        client->setCommandTimeout(command_timeout);
+    }
+    return client;
+}
+
+std::vector<std::string> MxDeliveryClient::getExchangers(const std::string &pDomain, int &pErrorCode) {
+    pErrorCode = 0;
+    if (pDomain.empty()) {
+        pErrorCode = CLIENT_DELIVERY_INVALID_DOMAIN_ERROR;
+        return {};
+    }
+    MxResolver *resolver = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto route = mDomainRoutes.find(pDomain);
+        if (route != mDomainRoutes.end()) {
+            return { route->second };
+        }
+        resolver = mMxResolver;
+    }
+    std::vector<MxRecord> records;
+    pErrorCode = (resolver != nullptr ? *resolver : MxResolver::getDefault()).resolve(pDomain.c_str(), records);
+    std::vector<std::string> hosts;
+    for (auto &record : records) {
+        hosts.push_back(std::move(record.Host));
+    }
+    return hosts;
+}
+
+void MxDeliveryClient::deliverToExchanger(const Message &pMsg,
+        std::vector<DomainPlan> &pPlans,
+        const std::vector<size_t> &pPlanIndexes,
+        std::vector<DomainDeliveryResult> &pResults) const {
+    // One persistent session with the primary mail exchanger for all the domains
+    std::unique_ptr<SMTPClientBase> session(createClient(pPlans[pPlanIndexes.front()].hosts.front()));
+    int connect_ret_code = session->connect();
+    bool reconnect_allowed = true;
+    for (size_t plan_index : pPlanIndexes) {
+        DomainPlan &plan = pPlans[plan_index];
+        DomainDeliveryResult &result = pResults[plan_index];
+        result.MxHost = plan.hosts.front();
+        if (connect_ret_code == 0 && !session->isConnected() && reconnect_allowed) {
+            // The server has dropped the session, reopen it once
+            connect_ret_code = session->connect();
+            reconnect_allowed = false;
+        }
+        result.ReturnCode = connect_ret_code == 0 && session->isConnected() ?
+            session->sendMail(pMsg, plan.recipients.data(), plan.recipients.size()) :
+            connect_ret_code;
+
+        // Fall back on the other mail exchangers by preference
+        for (size_t host_index = 1; host_index < plan.hosts.size() && !isFinalReturnCode(result.ReturnCode); host_index++) {
+            std::unique_ptr<SMTPClientBase> client(createClient(plan.hosts[host_index]));
+            result.MxHost = plan.hosts[host_index];
+            result.ReturnCode = client->sendMail(pMsg, plan.recipients.data(), plan.recipients.size());
+        }
+    }
+    session->disconnect();
+}
+
+bool MxDeliveryClient::isFinalReturnCode(int pReturnCode) {
+    // Success or permanent rejection by the server (5xx). The connection
+    // failures and the transient errors (4xx) are retried on the next host.
+    return pReturnCode == 0 || (pReturnCode >= 500 && pReturnCode < 600);
+}
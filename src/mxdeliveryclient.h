@@ -0,0 +1,143 @@
+#ifndef MXDELIVERYCLIENT_H
+#define MXDELIVERYCLIENT_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "message.h"
+#include "messageaddress.h"
+#include "mxresolver.h"
+#include "smtpclientbase.h"
+#include "smtpconnectionpool.h"
+#include "tlscontext.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define MXDELIVERYCLIENT_API __declspec(dllexport)
+    #else
+        #define MXDELIVERYCLIENT_API __declspec(dllimport)
+    #endif
+#else
+    #define MXDELIVERYCLIENT_API
+#endif
+
+namespace jed_utils {
+/** @brief The DomainDeliveryResult struct contains the outcome of the
+ *  delivery of a message to the recipients of one domain.
+ */
+struct DomainDeliveryResult {
+    /** The recipient domain, in lowercase. */
+    std::string Domain;
+    /** The email addresses of the recipients of the domain. */
+    std::vector<std::string> Recipients;
+    /** The mail exchanger that accepted the message or the last one tried. */
+    std::string MxHost;
+    /** 0 for success, otherwise the error code of the last attempt. */
+    int ReturnCode = 0;
+};
+
+/** @brief The MxDeliveryClient delivers a message directly to the mail
+ *  exchangers of the recipient domains instead of going through a relay.
+ *
+ *  The To, Cc and Bcc recipients are grouped by domain and each group is
+ *  sent in a single mail transaction. The domains that share the same
+ *  primary mail exchanger are sent over one session, and the sessions
+ *  to the different mail exchangers run in parallel. If a mail exchanger
+ *  cannot be reached or returns a transient error, the next one by
+ *  preference is tried.
+ */
+class MXDELIVERYCLIENT_API MxDeliveryClient {
+ public:
+    /**
+     *  @brief  Construct a new MxDeliveryClient.
+     *  @param pType The SMTP client class used to connect to the mail
+     *  exchangers.
+     *  Default: OpportunisticSecure (STARTTLS when the server offers it)
+     *  @param pPort The port of the mail exchangers.
+     *  Default: 25
+     *  @param pMaxParallelSessions The maximum number of mail exchangers
+     *  contacted at the same time.
+     *  Default: 8
+     */
+    explicit MxDeliveryClient(SmtpClientType pType = SmtpClientType::OpportunisticSecure,
+            unsigned int pPort = 25,
+            size_t pMaxParallelSessions = 8);
+
+    MxDeliveryClient(const MxDeliveryClient& other) = delete;
+    MxDeliveryClient& operator=(const MxDeliveryClient& other) = delete;
+
+    /**
+     *  @brief  Group the To, Cc and Bcc recipients of a message by domain.
+     *  The domain of an address is the part after its last @, in lowercase.
+     *  The addresses without a domain are grouped under an empty domain.
+     *  @param pMsg The message.
+     *  @return The recipients of each domain, in the order of the message.
+     */
+    static std::map<std::string, std::vector<MessageAddress>> groupRecipientsByDomain(const Message &pMsg);
+
+    /**
+     *  @brief  Deliver a message to the mail exchangers of its recipients.
+     *  @param pMsg The message to send.
+     *  @return The result of each recipient domain, sorted by domain.
+     */
+    std::vector<DomainDeliveryResult> sendMail(const Message &pMsg);
+
+    /**
+     *  @brief  Deliver the messages of a domain to a fixed host instead of
+     *  its mail exchangers.
+     *  @param pDomain The recipient domain.
+     *  @param pHost The host to use or an empty string to remove the route.
+     */
+    void setDomainRoute(const char *pDomain, const char *pHost);
+
+    /**
+     *  @brief  Set the resolver used to look up the mail exchangers.
+     *  @param pResolver The resolver or nullptr to use MxResolver::getDefault().
+     *  It must remain valid while the MxDeliveryClient is used.
+     */
+    void setMxResolver(MxResolver *pResolver);
+
+    /**
+     *  @brief  Set the TLS context shared by the secure sessions.
+     *  @param pTlsContext The context or nullptr to use TlsContext::getDefault().
+     */
+    void setTlsContext(std::shared_ptr<TlsContext> pTlsContext);
+
+    /**
+     *  @brief  Set the timeout of the connection and of each command.
+     *  @param pTimeOutInSeconds The timeout in seconds.
+     *  Default: 30 seconds
+     */
+    void setCommandTimeout(unsigned int pTimeOutInSeconds);
+
+ private:
+    struct DomainPlan {
+        std::string domain;
+        std::vector<MessageAddress> recipients;
+        std::vector<std::string> hosts;
+        int lookupErrorCode = 0;
+    };
+
+    SMTPClientBase *createClient(const std::string &pHost) const;
+    std::vector<std::string> getExchangers(const std::string &pDomain, int &pErrorCode);
+    void deliverToExchanger(const Message &pMsg,
+            std::vector<DomainPlan> &pPlans,
+            const std::vector<size_t> &pPlanIndexes,
+            std::vector<DomainDeliveryResult> &pResults) const;
+    static bool isFinalReturnCode(int pReturnCode);
+
+    SmtpClientType mType;
+    unsigned int mPort;
+    size_t mMaxParallelSessions;
+    unsigned int mCommandTimeOutInSeconds;
+    MxResolver *mMxResolver;
+    std::shared_ptr<TlsContext> mTlsContext;
+    mutable std::mutex mMutex;
+    std::map<std::string, std::string> mDomainRoutes;
+};
+}  // namespace jed_utils
+
+#endif
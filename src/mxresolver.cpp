@@ -0,0 +1,265 @@
+#include "mxresolver.h"
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <random>
+#include <utility>
+#include "smtpclienterrors.h"
+
+#ifdef _WIN32
+    #include <WinSock2.h>
+    #include <windows.h>
+    #include <windns.h>
+#else
+    #include <netinet/in.h>
+    #include <arpa/nameser.h>
+    #include <netdb.h>
+    #include <resolv.h>
+#endif
+
+using namespace jed_utils;
+
+namespace {
+// Number of seconds an implicit MX or a failed lookup is kept
+const unsigned int NEGATIVE_CACHE_TTL_IN_SECONDS = 60;
+const unsigned short DNS_TYPE_MX_RECORD = 15;
+const unsigned short DNS_CLASS_INTERNET = 1;
+
+unsigned short readUInt16(const unsigned char *pData) {
+    return static_cast<unsigned short>((pData[0] << 8) | pData[1]);
+}
+
+unsigned int readUInt32(const unsigned char *pData) {
+    return (static_cast<unsigned int>(pData[0]) << 24) | (static_cast<unsigned int>(pData[1]) << 16) |
+        (static_cast<unsigned int>(pData[2]) << 8) | static_cast<unsigned int>(pData[3]);
+}
+
+// Read a possibly compressed domain name (RFC 1035 section 4.1.4) and move
+// pOffset after the name as it is stored at this position
+bool readDomainName(const unsigned char *pMessage, size_t pLength, size_t &pOffset, std::string *pName) {
+    const int MAX_POINTERS = 64;
+    size_t position = pOffset;
+    bool pointer_followed = false;
+    int pointer_count = 0;
+    while (position < pLength) {
+        const unsigned char label_length = pMessage[position];
+        if (label_length == 0) {
+            if (!pointer_followed) {
+                pOffset = position + 1;
+            }
+            return true;
+        }
+        if ((label_length & 0xC0) == 0xC0) {
+            if (position + 1 >= pLength || ++pointer_count > MAX_POINTERS) {
+                return false;
+            }
+            if (!pointer_followed) {
+                pOffset = position + 2;
+            }
+            pointer_followed = true;
+            position = (static_cast<size_t>(label_length & 0x3F) << 8) | pMessage[position + 1];
+            continue;
+        }
+        if ((label_length & 0xC0) != 0 || position + 1 + label_length > pLength) {
+            return false;
+        }
+        if (pName != nullptr) {
+            if (!pName->empty()) {
+                pName->push_back('.');
+            }
+            pName->append(reinterpret_cast<const char *>(pMessage + position + 1), label_length);
+        }
+        position += 1 + static_cast<size_t>(label_length);
+    }
+    return false;
+}
+}  // namespace
+
+MxResolver::MxResolver(unsigned int pMaxCacheTtlInSeconds)
+    : mMaxCacheTtl(pMaxCacheTtlInSeconds) {
+}
+
+MxResolver &MxResolver::getDefault() {
+    static MxResolver default_resolver;
+    return default_resolver;
+}
+
+int MxResolver::resolve(const char *pDomain, std::vector<MxRecord> &pRecords) {
+    pRecords.clear();
+    std::string domain { pDomain != nullptr ? pDomain : "" };
+    std::transform(domain.begin(), domain.end(), domain.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (!domain.empty() && domain.back() == '.') {
+        domain.pop_back();
+    }
+    if (domain.empty()) {
+        return CLIENT_DELIVERY_INVALID_DOMAIN_ERROR;
+    }
+
+    int error_code = 0;
+    bool cached = false;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto entry = mCache.find(domain);
+        if (entry != mCache.end()) {
+            if (std::chrono::steady_clock::now() < entry->second.expiration) {
+                pRecords = entry->second.records;
+                error_code = entry->second.errorCode;
+                cached = true;
+            } else {
+                mCache.erase(entry);
+            }
+        }
+    }
+    if (!cached) {
+        // The lock is not held during the lookup, which can take seconds
+        unsigned int ttl = 0;
+        error_code = lookup(domain, pRecords, ttl);
+        if (error_code == 0 && pRecords.size() == 1 && pRecords[0].Host.empty()) {
+            error_code = CLIENT_DELIVERY_NULL_MX_ERROR;
+            pRecords.clear();
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        const auto entry_ttl = (std::min)(std::chrono::seconds(ttl), mMaxCacheTtl);
+        if (entry_ttl.count() > 0) {
+            CacheEntry entry;
+            entry.errorCode = error_code;
+            entry.records = pRecords;
+            entry.expiration = std::chrono::steady_clock::now() + entry_ttl;
+            mCache[domain] = std::move(entry);
+        }
+    }
+    if (error_code == 0) {
+        // Spread the load over the mail exchangers of the same preference
+        sortByPreference(pRecords);
+    }
+    return error_code;
+}
+
+void MxResolver::clearCache() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCache.clear();
+}
+
+size_t MxResolver::getCacheEntryCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCache.size();
+}
+
+bool MxResolver::parseDnsResponse(const unsigned char *pResponse,
+        size_t pLength,
+        std::vector<MxRecord> &pRecords,
+        unsigned int &pMinTtl) {
+    const size_t HEADER_LENGTH = 12;
+    const size_t RECORD_FIELDS_LENGTH = 10;
+    pRecords.clear();
+    pMinTtl = 0;
+    if (pResponse == nullptr || pLength < HEADER_LENGTH) {
+        return false;
+    }
+    const unsigned short question_count = readUInt16(pResponse + 4);
+    const unsigned short answer_count = readUInt16(pResponse + 6);
+    size_t offset = HEADER_LENGTH;
+    for (unsigned short index = 0; index < question_count; index++) {
+        // Name, type and class
+        if (!readDomainName(pResponse, pLength, offset, nullptr) || offset + 4 > pLength) {
+            return false;
+        }
+        offset += 4;
+    }
+    unsigned int min_ttl = (std::numeric_limits<unsigned int>::max)();
+    for (unsigned short index = 0; index < answer_count; index++) {
+        if (!readDomainName(pResponse, pLength, offset, nullptr) || offset + RECORD_FIELDS_LENGTH > pLength) {
+            return false;
+        }
+        const unsigned short type = readUInt16(pResponse + offset);
+        const unsigned short record_class = readUInt16(pResponse + offset + 2);
+        const unsigned int ttl = readUInt32(pResponse + offset + 4);
+        const size_t data_length = readUInt16(pResponse + offset + 8);
+        const size_t data_offset = offset + RECORD_FIELDS_LENGTH;
+        if (data_offset + data_length > pLength) {
+            return false;
+        }
+        if (type == DNS_TYPE_MX_RECORD && record_class == DNS_CLASS_INTERNET && data_length >= 3) {
+            MxRecord record;
+            record.Preference = readUInt16(pResponse + data_offset);
+            size_t name_offset = data_offset + 2;
+            if (!readDomainName(pResponse, pLength, name_offset, &record.Host)) {
+                return false;
+            }
+            pRecords.push_back(std::move(record));
+            min_ttl = (std::min)(min_ttl, ttl);
+        }
+        offset = data_offset + data_length;
+    }
+    pMinTtl = pRecords.empty() ? 0 : min_ttl;
+    return true;
+}
+
+int MxResolver::lookup(const std::string &pDomain, std::vector<MxRecord> &pRecords, unsigned int &pTtl) {
+    pTtl = NEGATIVE_CACHE_TTL_IN_SECONDS;
+#ifdef _WIN32
+    PDNS_RECORD records = nullptr;
+    DNS_STATUS status = DnsQuery_A(pDomain.c_str(), DNS_TYPE_MX, DNS_QUERY_STANDARD, nullptr, &records, nullptr);
+    if (status == 0) {
+        unsigned int min_ttl = (std::numeric_limits<unsigned int>::max)();
+        for (PDNS_RECORD record = records; record != nullptr; record = record->pNext) {
+            if (record->wType == DNS_TYPE_MX && record->Flags.S.Section == DnsSectionAnswer) {
+                MxRecord mx_record;
+                mx_record.Preference = record->Data.MX.wPreference;
+                mx_record.Host = record->Data.MX.pNameExchange != nullptr ? record->Data.MX.pNameExchange : "";
+                if (!mx_record.Host.empty() && mx_record.Host.back() == '.') {
+                    mx_record.Host.pop_back();
+                }
+                pRecords.push_back(std::move(mx_record));
+                min_ttl = (std::min)(min_ttl, static_cast<unsigned int>(record->dwTtl));
+            }
+        }
+        DnsRecordListFree(records, DnsFreeRecordList);
+        if (!pRecords.empty()) {
+            pTtl = min_ttl;
+        }
+    } else if (status != DNS_INFO_NO_RECORDS) {
+        if (status == ERROR_TIMEOUT || status == DNS_ERROR_RCODE_SERVER_FAILURE) {
+            pTtl = 0;
+        }
+        return CLIENT_DELIVERY_MX_LOOKUP_ERROR;
+    }
+#else
+    std::vector<unsigned char> response(65536);
+    int length = res_query(pDomain.c_str(), ns_c_in, ns_t_mx, response.data(), static_cast<int>(response.size()));
+    if (length < 0) {
+        if (h_errno != NO_DATA) {
+            // A temporary failure must not be cached
+            if (h_errno == TRY_AGAIN) {
+                pTtl = 0;
+            }
+            return CLIENT_DELIVERY_MX_LOOKUP_ERROR;
+        }
+    } else {
+        unsigned int min_ttl = 0;
+        if (!parseDnsResponse(response.data(), (std::min)(static_cast<size_t>(length), response.size()), pRecords, min_ttl)) {
+            pTtl = 0;
+            return CLIENT_DELIVERY_MX_LOOKUP_ERROR;
+        }
+        if (!pRecords.empty()) {
+            pTtl = min_ttl;
+        }
+    }
+#endif
+    if (pRecords.empty()) {
+        // No MX record, the domain itself is the mail exchanger (implicit MX)
+        MxRecord implicit_record;
+        implicit_record.Host = pDomain;
+        pRecords.push_back(std::move(implicit_record));
+    }
+    return 0;
+}
+
+void MxResolver::sortByPreference(std::vector<MxRecord> &pRecords) {
+    static thread_local std::mt19937 generator { std::random_device {}() };
+    std::shuffle(pRecords.begin(), pRecords.end(), generator);
+    std::stable_sort(pRecords.begin(), pRecords.end(), [](const MxRecord &first, const MxRecord &second) {
+            return first.Preference < second.Preference;
+            });
+}
@@ -0,0 +1,100 @@
+#ifndef MXRESOLVER_H
+#define MXRESOLVER_H
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define MXRESOLVER_API __declspec(dllexport)
+    #else
+        #define MXRESOLVER_API __declspec(dllimport)
+    #endif
+#else
+    #define MXRESOLVER_API
+#endif
+
+namespace jed_utils {
+/** @brief The MxRecord struct contains a mail exchanger of a domain. */
+struct MxRecord {
+    /** The preference of the mail exchanger. The lowest is tried first. */
+    unsigned short Preference = 0;
+    /** The host name of the mail exchanger, without the trailing dot. */
+    std::string Host;
+};
+
+/** @brief The MxResolver class looks up the mail exchangers of a domain
+ *  (RFC 5321 section 5.1) and keeps them in a thread-safe cache for the
+ *  TTL of the DNS records.
+ */
+class MXRESOLVER_API MxResolver {
+ public:
+    /**
+     *  @brief  Construct a new MxResolver.
+     *  @param pMaxCacheTtlInSeconds The maximum number of seconds a lookup
+     *  is kept, whatever the TTL of the records. 0 disables the cache.
+     *  Default: 3600 seconds
+     */
+    explicit MxResolver(unsigned int pMaxCacheTtlInSeconds = 3600);
+
+    MxResolver(const MxResolver& other) = delete;
+    MxResolver& operator=(const MxResolver& other) = delete;
+
+    /** Return the process-wide resolver. */
+    static MxResolver &getDefault();
+
+    /**
+     *  @brief  Look up the mail exchangers of a domain.
+     *  The records are sorted by preference and the records of the same
+     *  preference are shuffled. If the domain has no MX record, the domain
+     *  itself is returned as the only mail exchanger (implicit MX).
+     *  @param pDomain The domain name.
+     *  @param pRecords Receive the mail exchangers.
+     *  @return 0 for success, CLIENT_DELIVERY_INVALID_DOMAIN_ERROR if the
+     *  domain is empty, CLIENT_DELIVERY_NULL_MX_ERROR if the domain publishes
+     *  a null MX (RFC 7505), otherwise CLIENT_DELIVERY_MX_LOOKUP_ERROR.
+     */
+    int resolve(const char *pDomain, std::vector<MxRecord> &pRecords);
+
+    /** Discard all the cached lookups. */
+    void clearCache();
+
+    /** Return the number of lookups in the cache, including expired ones. */
+    size_t getCacheEntryCount() const;
+
+    /**
+     *  @brief  Extract the MX records from the answer section of a DNS
+     *  response message (RFC 1035 section 4.1).
+     *  @param pResponse The DNS response message.
+     *  @param pLength The length of the message.
+     *  @param pRecords Receive the MX records in the order of the message.
+     *  @param pMinTtl Receive the lowest TTL of the MX records.
+     *  @return True for success, false if the message is malformed.
+     */
+    static bool parseDnsResponse(const unsigned char *pResponse,
+            size_t pLength,
+            std::vector<MxRecord> &pRecords,
+            unsigned int &pMinTtl);
+
+ private:
+    struct CacheEntry {
+        int errorCode = 0;
+        std::vector<MxRecord> records;
+        std::chrono::steady_clock::time_point expiration;
+    };
+
+    static int lookup(const std::string &pDomain, std::vector<MxRecord> &pRecords, unsigned int &pTtl);
+    static void sortByPreference(std::vector<MxRecord> &pRecords);
+
+    std::chrono::seconds mMaxCacheTtl;
+    mutable std::mutex mMutex;
+    std::map<std::string, CacheEntry> mCache;
+};
+}  // namespace jed_utils
+
+#endif
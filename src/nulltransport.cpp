@@ -0,0 +1,184 @@
+#include "nulltransport.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "stringutils.h"
+
+using namespace jed_utils;
+
+namespace {
+// Length of the ".\r\n" that ends the content after its last line break
+const int DATA_TERMINATOR_END_LENGTH = 3;
+}  // namespace
+
+NullTransport::NullTransport(bool pChunkingAdvertised)
+    : mChunkingAdvertised(pChunkingAdvertised) {
+}
+
+int NullTransport::open(const char *pServerName, unsigned int pPort, unsigned int pTimeoutInMilliseconds) {
+    (void)pServerName;
+    (void)pPort;
+    (void)pTimeoutInMilliseconds;
+    mOpened = true;
+    mMode = InputMode::Command;
+    mCommandLine.clear();
+    mOutput = "220 null.transport ESMTP\r\n";
+    return 0;
+}
+
+void NullTransport::close() {
+    mOpened = false;
+    mOutput.clear();
+}
+
+int NullTransport::write(const std::string_view *pSegments, size_t pSegmentCount) {
+    if (!mOpened) {
+        return -1;
+    }
+    for (size_t index = 0; index < pSegmentCount; index++) {
+        std::string_view input = pSegments[index];
+        mBytesWritten += input.size();
+        while (!input.empty()) {
+            size_t consumed = 0;
+            switch (mMode) {
+                case InputMode::Command:
+                    consumed = processCommandInput(input);
+                    break;
+                case InputMode::Data:
+                    consumed = processDataInput(input);
+                    break;
+                case InputMode::Chunk:
+                    consumed = processChunkInput(input);
+                    break;
+            }
+            input.remove_prefix(consumed);
+        }
+    }
+    return 0;
+}
+
+int NullTransport::waitForData(unsigned int pTimeoutInMilliseconds) {
+    // The replies are ready as soon as the commands are written
+    (void)pTimeoutInMilliseconds;
+    if (!mOpened) {
+        return -1;
+    }
+    return mOutput.empty() ? 0 : 1;
+}
+
+int NullTransport::read(char *pBuffer, size_t pLength) {
+    if (!mOpened || mOutput.empty()) {
+        return -1;
+    }
+    const size_t length = (std::min)(pLength, mOutput.size());
+    memcpy(pBuffer, mOutput.data(), length);
+    mOutput.erase(0, length);
+    return static_cast<int>(length);
+}
+
+uint64_t NullTransport::getMessageCount() const {
+    return mMessageCount;
+}
+
+uint64_t NullTransport::getContentByteCount() const {
+    return mContentByteCount;
+}
+
+uint64_t NullTransport::getBytesWritten() const {
+    return mBytesWritten;
+}
+
+size_t NullTransport::processCommandInput(std::string_view pInput) {
+    const size_t end = pInput.find('\n');
+    if (end == std::string_view::npos) {
+        mCommandLine.append(pInput);
+        return pInput.size();
+    }
+    mCommandLine.append(pInput.substr(0, end + 1));
+    processCommand(mCommandLine);
+    mCommandLine.clear();
+    return end + 1;
+}
+
+size_t NullTransport::processDataInput(std::string_view pInput) {
+    // Look for CRLF.CRLF, the content starting at the beginning of a line
+    for (size_t index = 0; index < pInput.size(); index++) {
+        const char character = pInput[index];
+        switch (mTerminatorMatch) {
+            case 1:
+                mTerminatorMatch = character == '\n' ? 2 : (character == '\r' ? 1 : 0);
+                break;
+            case 2:
+                mTerminatorMatch = character == '.' ? 3 : (character == '\r' ? 1 : 0);
+                break;
+            case 3:
+                mTerminatorMatch = character == '\r' ? 4 : 0;
+                break;
+            case 4:
+                if (character == '\n') {
+                    mContentByteCount += index + 1;
+                    mContentByteCount -= DATA_TERMINATOR_END_LENGTH;
+                    mMessageCount++;
+                    mMode = InputMode::Command;
+                    mOutput += "250 2.0.0 OK\r\n";
+                    return index + 1;
+                }
+                mTerminatorMatch = character == '\r' ? 1 : 0;
+                break;
+            default:
+                mTerminatorMatch = character == '\r' ? 1 : 0;
+                break;
+        }
+    }
+    mContentByteCount += pInput.size();
+    return pInput.size();
+}
+
+size_t NullTransport::processChunkInput(std::string_view pInput) {
+    const size_t length = static_cast<size_t>((std::min<uint64_t>)(pInput.size(), mChunkRemaining));
+    mChunkRemaining -= length;
+    mContentByteCount += length;
+    if (mChunkRemaining == 0) {
+        mMode = InputMode::Command;
+        if (mLastChunk) {
+            mMessageCount++;
+        }
+        mOutput += "250 2.0.0 OK\r\n";
+    }
+    return length;
+}
+
+void NullTransport::processCommand(std::string_view pCommand) {
+    const std::string command = StringUtils::toUpper(std::string(pCommand.substr(0, 4)));
+    if (command == "EHLO" || command == "HELO") {
+        mOutput += "250-null.transport\r\n"
+            "250-PIPELINING\r\n"
+            "250-8BITMIME\r\n"
+            "250-SMTPUTF8\r\n"
+            "250-ENHANCEDSTATUSCODES\r\n";
+        mOutput += mChunkingAdvertised ? "250-AUTH PLAIN\r\n250 CHUNKING\r\n" : "250 AUTH PLAIN\r\n";
+    } else if (command == "AUTH") {
+        mOutput += "235 2.7.0 Authentication successful\r\n";
+    } else if (command == "DATA") {
+        mMode = InputMode::Data;
+        // The content starts at the beginning of a line
+        mTerminatorMatch = 2;
+        mOutput += "354 Start mail input\r\n";
+    } else if (command == "BDAT") {
+        const std::string parameters = StringUtils::toUpper(std::string(pCommand.substr(4)));
+        mChunkRemaining = std::strtoull(parameters.c_str(), nullptr, 10);
+        mLastChunk = parameters.find("LAST") != std::string::npos;
+        if (mChunkRemaining > 0) {
+            mMode = InputMode::Chunk;
+        } else {
+            processChunkInput({});
+        }
+    } else if (command == "QUIT") {
+        mOutput += "221 2.0.0 Bye\r\n";
+    } else if (command == "STAR") {
+        mOutput += "454 4.7.0 TLS not available\r\n";
+    } else {
+        mOutput += "250 2.0.0 OK\r\n";
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef NULLTRANSPORT_H
+#define NULLTRANSPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "transport.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define NULLTRANSPORT_API __declspec(dllexport)
+    #else
+        #define NULLTRANSPORT_API __declspec(dllimport)
+    #endif
+#else
+    #define NULLTRANSPORT_API
+#endif
+
+namespace jed_utils {
+/** @brief The NullTransport class is a Transport that answers like a server
+ *  accepting every command, without any network, so that a client runs its
+ *  whole pipeline offline: validation, MIME rendering, encodings,
+ *  dot-stuffing and DKIM signature.
+ *
+ *  It is meant for dry runs and capacity planning. With a SessionMetrics
+ *  observer set on the client, the duration of the Headers and Body phases
+ *  is then the processing time of the client and their IoCounters the bytes
+ *  it produces. The server advertises PIPELINING, 8BITMIME, SMTPUTF8,
+ *  ENHANCEDSTATUSCODES, AUTH PLAIN and optionally CHUNKING, and never
+ *  STARTTLS, so it is used with SmtpClient. The content is counted and
+ *  discarded as it is written. A transport is used by one session at a time.
+ */
+class NULLTRANSPORT_API NullTransport : public Transport {
+ public:
+    /**
+     *  @brief  Construct a new NullTransport.
+     *  @param pChunkingAdvertised Advertise CHUNKING, so that the content is
+     *  sent with BDAT instead of DATA.
+     */
+    explicit NullTransport(bool pChunkingAdvertised = true);
+
+    int open(const char *pServerName, unsigned int pPort, unsigned int pTimeoutInMilliseconds) override;
+    void close() override;
+    int write(const std::string_view *pSegments, size_t pSegmentCount) override;
+    /** Return 1 if a reply is pending, otherwise 0 immediately. */
+    int waitForData(unsigned int pTimeoutInMilliseconds) override;
+    int read(char *pBuffer, size_t pLength) override;
+
+    /** Return the number of messages accepted since the construction. */
+    uint64_t getMessageCount() const;
+
+    /** Return the number of bytes of message content received since the
+     *  construction, the DATA terminator or the BDAT commands excluded. */
+    uint64_t getContentByteCount() const;
+
+    /** Return the number of bytes written by the clients since the
+     *  construction, commands included. */
+    uint64_t getBytesWritten() const;
+
+ private:
+    enum class InputMode {
+        Command,
+        Data,
+        Chunk
+    };
+
+    size_t processCommandInput(std::string_view pInput);
+    size_t processDataInput(std::string_view pInput);
+    size_t processChunkInput(std::string_view pInput);
+    void processCommand(std::string_view pCommand);
+
+    bool mChunkingAdvertised;
+    bool mOpened = false;
+    InputMode mMode = InputMode::Command;
+    // Incomplete command line of the previous writes
+    std::string mCommandLine;
+    std::string mOutput;
+    // Number of characters of the DATA terminator matched by the content
+    int mTerminatorMatch = 0;
+    uint64_t mChunkRemaining = 0;
+    bool mLastChunk = false;
+    uint64_t mMessageCount = 0;
+    uint64_t mContentByteCount = 0;
+    uint64_t mBytesWritten = 0;
+};
+}  // namespace jed_utils
+
+#endif
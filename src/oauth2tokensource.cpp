@@ -0,0 +1,106 @@
+#include "oauth2tokensource.h"
+#include <algorithm>
+#include "base64.h"
+
+using namespace jed_utils;
+using namespace std::literals::string_literals;
+
+namespace {
+// The authorization identity of the GS2 header is a saslname (RFC 5801)
+std::string escapeSaslName(const std::string &pName) {
+    std::string retval;
+    retval.reserve(pName.size());
+    for (char c : pName) {
+        if (c == ',') {
+            retval += "=2C";
+        } else if (c == '=') {
+            retval += "=3D";
+        } else {
+            retval += c;
+        }
+    }
+    return retval;
+}
+}  // namespace
+
+OAuth2TokenSource::OAuth2TokenSource(AccessTokenRefresher pRefresher,
+        std::chrono::seconds pRefreshMargin)
+    : mRefresher(std::move(pRefresher)),
+      mRefreshMargin((std::max)(pRefreshMargin, std::chrono::seconds(0))) {
+}
+
+int OAuth2TokenSource::getAccessToken(std::string &pAccessToken) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    int refresh_ret_code = refreshIfNeeded();
+    if (refresh_ret_code != 0) {
+        return refresh_ret_code;
+    }
+    pAccessToken = mAccessToken;
+    return 0;
+}
+
+int OAuth2TokenSource::getInitialResponse(OAuth2Mechanism pMechanism,
+        const char *pUsername,
+        std::string &pResponse) {
+    const std::string username { pUsername != nullptr ? pUsername : "" };
+    std::lock_guard<std::mutex> lock(mMutex);
+    int refresh_ret_code = refreshIfNeeded();
+    if (refresh_ret_code != 0) {
+        return refresh_ret_code;
+    }
+    auto cached = mResponses.find(std::make_pair(pMechanism, username));
+    if (cached != mResponses.end()) {
+        pResponse = cached->second;
+        return 0;
+    }
+    std::string response;
+    if (pMechanism == OAuth2Mechanism::XOAuth2) {
+        response = "user="s + username + "\x01" "auth=Bearer " + mAccessToken + "\x01\x01";
+    } else {
+        // GS2 header without channel binding, then the key/value pairs
+        response = "n,a="s + escapeSaslName(username) + ",\x01" "auth=Bearer " + mAccessToken + "\x01\x01";
+    }
+    pResponse = Base64::Encode(reinterpret_cast<const unsigned char *>(response.data()), response.size());
+    mResponses.emplace(std::make_pair(pMechanism, username), pResponse);
+    return 0;
+}
+
+void OAuth2TokenSource::invalidate() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mHasToken = false;
+    mResponses.clear();
+}
+
+size_t OAuth2TokenSource::getRefreshCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mRefreshCount;
+}
+
+int OAuth2TokenSource::refreshIfNeeded() {
+    const auto now = std::chrono::steady_clock::now();
+    if (mHasToken && (!mExpires || now < mRefreshTime)) {
+        return 0;
+    }
+    mHasToken = false;
+    mResponses.clear();
+    if (!mRefresher) {
+        return -1;
+    }
+    std::string access_token;
+    std::chrono::seconds lifetime { 0 };
+    int refresher_ret_code = mRefresher(access_token, lifetime);
+    if (refresher_ret_code != 0) {
+        return refresher_ret_code;
+    }
+    if (access_token.empty()) {
+        return -1;
+    }
+    mRefreshCount++;
+    mAccessToken = std::move(access_token);
+    mHasToken = true;
+    mExpires = lifetime.count() > 0;
+    if (mExpires) {
+        mRefreshTime = now + lifetime - (std::min)(mRefreshMargin, lifetime / 2);
+    }
+    return 0;
+}
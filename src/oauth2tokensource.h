@@ -0,0 +1,108 @@
+#ifndef OAUTH2TOKENSOURCE_H
+#define OAUTH2TOKENSOURCE_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define OAUTH2TOKENSOURCE_API __declspec(dllexport)
+    #else
+        #define OAUTH2TOKENSOURCE_API __declspec(dllimport)
+    #endif
+#else
+    #define OAUTH2TOKENSOURCE_API
+#endif
+
+namespace jed_utils {
+/** The SASL mechanisms that authenticate with an OAuth 2.0 access token. */
+enum class OAuth2Mechanism {
+    // The XOAUTH2 mechanism of Google and Microsoft
+    XOAuth2 = 0,
+    // The OAUTHBEARER mechanism (RFC 7628)
+    OAuthBearer
+};
+
+/**
+ *  @brief  The function called to obtain a new access token, for instance
+ *  from the token endpoint of the authorization server.
+ *  @param pAccessToken Receive the access token.
+ *  @param pLifetime Receive the validity of the token, 0 if it is not known.
+ *  @return 0 for success, otherwise an error code.
+ */
+using AccessTokenRefresher = std::function<int(std::string &pAccessToken, std::chrono::seconds &pLifetime)>;
+
+/** @brief The OAuth2TokenSource class keeps the access token of a user and
+ *  the AUTH responses built from it.
+ *
+ *  The token is refreshed before it expires, so that the sessions opened
+ *  from a pool never send an expired token, and when the server has refused
+ *  it. The base64 responses are built once per mechanism and user name for
+ *  the lifetime of the token. The class is thread-safe and can be shared by
+ *  the credentials of several clients, a single thread calls the refresher
+ *  at a time.
+ */
+class OAUTH2TOKENSOURCE_API OAuth2TokenSource {
+ public:
+    /**
+     *  @brief  Construct a new OAuth2TokenSource.
+     *  @param pRefresher The function called to obtain a new access token.
+     *  @param pRefreshMargin The time before the expiry of a token when it
+     *  is refreshed. It is at most half of the lifetime of the token.
+     *  Default: 60 seconds
+     */
+    explicit OAuth2TokenSource(AccessTokenRefresher pRefresher,
+            std::chrono::seconds pRefreshMargin = std::chrono::seconds(60));
+
+    OAuth2TokenSource(const OAuth2TokenSource &) = delete;
+    OAuth2TokenSource &operator=(const OAuth2TokenSource &) = delete;
+
+    /**
+     *  @brief  Return the current access token, refreshed if it is about
+     *  to expire.
+     *  @param pAccessToken Receive the access token.
+     *  @return 0 for success, otherwise the error code of the refresher.
+     */
+    int getAccessToken(std::string &pAccessToken);
+
+    /**
+     *  @brief  Return the base64 initial response of the AUTH command for
+     *  a mechanism.
+     *  @param pMechanism The SASL mechanism.
+     *  @param pUsername The user name (the email address of the account).
+     *  @param pResponse Receive the base64 response.
+     *  @return 0 for success, otherwise the error code of the refresher.
+     */
+    int getInitialResponse(OAuth2Mechanism pMechanism,
+            const char *pUsername,
+            std::string &pResponse);
+
+    /** Discard the current token, the next call obtains a new one. */
+    void invalidate();
+
+    /** Return the number of tokens obtained from the refresher. */
+    size_t getRefreshCount() const;
+
+ private:
+    // Called with the mutex locked
+    int refreshIfNeeded();
+
+    AccessTokenRefresher mRefresher;
+    std::chrono::seconds mRefreshMargin;
+    mutable std::mutex mMutex;
+    std::string mAccessToken;
+    bool mHasToken = false;
+    bool mExpires = false;
+    std::chrono::steady_clock::time_point mRefreshTime;
+    size_t mRefreshCount = 0;
+    std::map<std::pair<OAuth2Mechanism, std::string>, std::string> mResponses;
+};
+}  // namespace jed_utils
+
+#endif
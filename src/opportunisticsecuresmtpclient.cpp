@@ -7,7 +7,6 @@
 #include "smtpserverstatuscodes.h"
 #include "socketerrors.h"
 #include "sslerrors.h"
-#include "stringutils.h"
 
 #ifdef _WIN32
     #include <WinSock2.h>
@@ -15,7 +14,6 @@
     #include <BaseTsd.h>
     typedef SSIZE_T ssize_t;
     #include <windows.h>
-    constexpr auto sleep = Sleep;
 #else
     #include <fcntl.h>
     #include <netdb.h>
@@ -52,37 +50,43 @@ OpportunisticSecureSMTPClient& OpportunisticSecureSMTPClient::operator=(Opportun
 }
 
 int OpportunisticSecureSMTPClient::establishConnectionWithServer() {
-    int session_init_return_code = initializeSession();
+    beginPhase();
+    int session_init_return_code = endPhase(SessionPhase::Connection, initializeSession());
     if (session_init_return_code != 0) {
         return session_init_return_code;
     }
 
-    int server_greetings_return_code = checkServerGreetings();
+    beginPhase();
+    int server_greetings_return_code = endPhase(SessionPhase::Greeting, checkServerGreetings());
     if (server_greetings_return_code != STATUS_CODE_SERVICE_READY) {
         return server_greetings_return_code;
     }
 
-    int client_init_return_code = sendServerIdentification();
+    beginPhase();
+    int client_init_return_code = endPhase(SessionPhase::Identification, sendServerIdentification());
     if (client_init_return_code != STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED) {
         return client_init_return_code;
     }
 
-    if (isStartTLSSupported(getLastServerResponse())) {
+    if (getServerCapabilities().StartTLS) {
         addCommunicationLogItem("Info: STARTTLS is available by the server, the communication will be encrypted.");
+        beginPhase();
         int tls_init_return_code = upgradeToSecureConnection();
         if (tls_init_return_code != STATUS_CODE_SERVICE_READY) {
-            return tls_init_return_code;
+            return endPhase(SessionPhase::StartTLS, tls_init_return_code);
         }
-        int tls_start_return_code = startTLSNegotiation();
+        int tls_start_return_code = endPhase(SessionPhase::StartTLS, startTLSNegotiation());
         if (tls_start_return_code != 0) {
             return tls_start_return_code;
         }
-        int client_initSecure_return_code = getServerSecureIdentification();
+        beginPhase();
+        int client_initSecure_return_code = endPhase(SessionPhase::Identification, getServerSecureIdentification());
         if (client_initSecure_return_code != STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED) {
             return client_initSecure_return_code;
         }
         if (getCredentials() != nullptr) {
-            int client_auth_return_code = authenticateClient();
+            beginPhase();
+            int client_auth_return_code = endPhase(SessionPhase::Authentication, authenticateClient());
             if (client_auth_return_code != STATUS_CODE_AUTHENTICATION_SUCCEEDED) {
                 return client_auth_return_code;
             }
@@ -104,14 +108,5 @@ int OpportunisticSecureSMTPClient::upgradeToSecureConnection() {
 
 
 bool OpportunisticSecureSMTPClient::isStartTLSSupported(const char *pServerResponse) {
-    if (pServerResponse == nullptr) {
-        return false;
-    }
-    std::string serverResponse { pServerResponse };
-    if (serverResponse.length() == 0 || StringUtils::trim(serverResponse).empty()) {
-        return false;
-    }
-
-    const std::string STARTTLS_LINE_PREFIX { "250-STARTTLS" };
-    return serverResponse.find(STARTTLS_LINE_PREFIX) != std::string::npos;
+    return extractServerCapabilities(pServerResponse).StartTLS;
 }
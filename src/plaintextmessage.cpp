@@ -1,4 +1,5 @@
 #include "plaintextmessage.h"
+#include <utility>
 
 using namespace jed_utils;
 
@@ -27,6 +28,28 @@ PlaintextMessage::PlaintextMessage(const MessageAddress &pFrom,
     : Message(pFrom, pTo, pToCount, pSubject, pBody, pCc, pCcCount, pBcc, pBccCount, pAttachments, pAttachmentsSize) {
 }
 
+PlaintextMessage::PlaintextMessage(MessageAddress pFrom,
+        std::vector<MessageAddress> pTo,
+        std::string pSubject,
+        std::shared_ptr<const std::string> pBody,
+        std::vector<MessageAddress> pCc,
+        std::vector<MessageAddress> pBcc,
+        std::vector<Attachment> pAttachments)
+    : Message(std::move(pFrom), std::move(pTo), std::move(pSubject), std::move(pBody),
+            std::move(pCc), std::move(pBcc), std::move(pAttachments)) {
+}
+
+PlaintextMessage::PlaintextMessage(MessageAddress pFrom,
+        RecipientTable pRecipients,
+        size_t pToCount,
+        size_t pCcCount,
+        std::string pSubject,
+        std::shared_ptr<const std::string> pBody,
+        std::vector<Attachment> pAttachments)
+    : Message(std::move(pFrom), std::move(pRecipients), pToCount, pCcCount, std::move(pSubject),
+            std::move(pBody), std::move(pAttachments)) {
+}
+
 const char *PlaintextMessage::getMimeType() const {
     return "text/plain";
 }
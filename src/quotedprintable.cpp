@@ -0,0 +1,225 @@
+#include "quotedprintable.h"
+#include <algorithm>
+
+#if !defined(SMTPCLIENT_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #include <emmintrin.h>
+    #define QUOTEDPRINTABLE_SSE2
+#endif
+
+using namespace jed_utils;
+
+namespace {
+const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+bool isWhitespace(char pChar) {
+    return pChar == ' ' || pChar == '\t';
+}
+
+// The characters written as is, except a dot at the beginning of a line
+bool isLiteral(unsigned char pChar) {
+    return pChar >= 33 && pChar <= 126 && pChar != '=';
+}
+
+// Return the length of the run of literal characters and whitespace at the
+// beginning of data
+size_t literalRunLength(const char *pData, size_t pLength) {
+    size_t length = 0;
+#ifdef QUOTEDPRINTABLE_SSE2
+    // A signed comparison excludes the bytes above 127
+    const __m128i before_space = _mm_set1_epi8(' ' - 1);
+    const __m128i delete_char = _mm_set1_epi8(127);
+    const __m128i equal_sign = _mm_set1_epi8('=');
+    const __m128i tab = _mm_set1_epi8('\t');
+    while (length + 16 <= pLength) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pData + length));
+        const __m128i excluded = _mm_or_si128(_mm_cmpeq_epi8(bytes, delete_char), _mm_cmpeq_epi8(bytes, equal_sign));
+        const __m128i literal = _mm_or_si128(_mm_andnot_si128(excluded, _mm_cmpgt_epi8(bytes, before_space)),
+                _mm_cmpeq_epi8(bytes, tab));
+        if (_mm_movemask_epi8(literal) != 0xFFFF) {
+            break;
+        }
+        length += 16;
+    }
+#endif
+    while (length < pLength &&
+            (isLiteral(static_cast<unsigned char>(pData[length])) || isWhitespace(pData[length]))) {
+        length++;
+    }
+    return length;
+}
+
+struct StringSink {
+    std::string &output;
+    void append(const char *pData, size_t pLength) {
+        output.append(pData, pLength);
+    }
+};
+
+struct CountingSink {
+    void append(const char *, size_t) {}
+};
+}  // namespace
+
+void QuotedPrintableEncoder::encode(std::string_view pData, std::string &pOutput) {
+    StringSink sink { pOutput };
+    process(pData, sink);
+}
+
+void QuotedPrintableEncoder::finish(std::string &pOutput) {
+    StringSink sink { pOutput };
+    end(sink);
+}
+
+void QuotedPrintableEncoder::measure(std::string_view pData) {
+    CountingSink sink;
+    process(pData, sink);
+}
+
+void QuotedPrintableEncoder::finishMeasure() {
+    CountingSink sink;
+    end(sink);
+}
+
+size_t QuotedPrintableEncoder::getEncodedSize() const {
+    return mEncodedSize;
+}
+
+size_t QuotedPrintableEncoder::getEscapedCount() const {
+    return mEscapedCount;
+}
+
+size_t QuotedPrintableEncoder::getSoftLineBreakCount() const {
+    return mSoftLineBreakCount;
+}
+
+void QuotedPrintableEncoder::reset() {
+    *this = QuotedPrintableEncoder();
+}
+
+std::string QuotedPrintableEncoder::encodeAll(std::string_view pData) {
+    QuotedPrintableEncoder encoder;
+    std::string encoded;
+    encoded.reserve(pData.size() + pData.size() / 8);
+    encoder.encode(pData, encoded);
+    encoder.finish(encoded);
+    return encoded;
+}
+
+template <typename Sink>
+void QuotedPrintableEncoder::process(std::string_view pData, Sink &pSink) {
+    const char *data = pData.data();
+    size_t position = 0;
+    while (position < pData.size()) {
+        // The runs of literal characters are copied up to the end of the
+        // line. A whitespace that ends a run may end the line too, it is
+        // written by the loop below.
+        if (!mPendingCarriageReturn && mPendingWhitespace == '\0' && mLineLength < MAX_LINE_LENGTH - 1 &&
+                (mLineLength > 0 || data[position] != '.')) {
+            size_t run = literalRunLength(data + position,
+                    (std::min)(pData.size() - position, MAX_LINE_LENGTH - 1 - mLineLength));
+            while (run > 0 && isWhitespace(data[position + run - 1])) {
+                run--;
+            }
+            if (run > 0) {
+                pSink.append(data + position, run);
+                mLineLength += run;
+                mEncodedSize += run;
+                position += run;
+                continue;
+            }
+        }
+        const auto current = static_cast<unsigned char>(data[position++]);
+        if (mPendingCarriageReturn) {
+            mPendingCarriageReturn = false;
+            if (current == '\n') {
+                writeLineBreak(pSink);
+                continue;
+            }
+            // A bare CR is not a line break
+            writePendingWhitespace(pSink, false);
+            writeEscaped(pSink, '\r');
+        }
+        if (current == '\r') {
+            mPendingCarriageReturn = true;
+        } else if (current == '\n') {
+            writeLineBreak(pSink);
+        } else if (isWhitespace(static_cast<char>(current))) {
+            writePendingWhitespace(pSink, false);
+            mPendingWhitespace = static_cast<char>(current);
+        } else {
+            writePendingWhitespace(pSink, false);
+            writeCharacter(pSink, current);
+        }
+    }
+}
+
+template <typename Sink>
+void QuotedPrintableEncoder::end(Sink &pSink) {
+    if (mPendingCarriageReturn) {
+        mPendingCarriageReturn = false;
+        writePendingWhitespace(pSink, false);
+        writeEscaped(pSink, '\r');
+    }
+    writePendingWhitespace(pSink, true);
+    mLineLength = 0;
+}
+
+template <typename Sink>
+void QuotedPrintableEncoder::breakLineIfFull(Sink &pSink, size_t pLength) {
+    // One character is left for the = of the soft line break
+    if (mLineLength + pLength > MAX_LINE_LENGTH - 1) {
+        pSink.append("=\r\n", 3);
+        mEncodedSize += 3;
+        mSoftLineBreakCount++;
+        mLineLength = 0;
+    }
+}
+
+template <typename Sink>
+void QuotedPrintableEncoder::writeLineBreak(Sink &pSink) {
+    // A whitespace at the end of a line is encoded (RFC 2045 rule 3)
+    writePendingWhitespace(pSink, true);
+    pSink.append("\r\n", 2);
+    mEncodedSize += 2;
+    mLineLength = 0;
+}
+
+template <typename Sink>
+void QuotedPrintableEncoder::writeCharacter(Sink &pSink, unsigned char pChar) {
+    breakLineIfFull(pSink, 1);
+    if (isLiteral(pChar) && (pChar != '.' || mLineLength > 0)) {
+        const char literal = static_cast<char>(pChar);
+        pSink.append(&literal, 1);
+        mLineLength++;
+        mEncodedSize++;
+    } else {
+        writeEscaped(pSink, pChar);
+    }
+}
+
+template <typename Sink>
+void QuotedPrintableEncoder::writeEscaped(Sink &pSink, unsigned char pChar) {
+    breakLineIfFull(pSink, 3);
+    const char escaped[] { '=', HEX_DIGITS[pChar >> 4], HEX_DIGITS[pChar & 0x0F] };
+    pSink.append(escaped, 3);
+    mLineLength += 3;
+    mEncodedSize += 3;
+    mEscapedCount++;
+}
+
+template <typename Sink>
+void QuotedPrintableEncoder::writePendingWhitespace(Sink &pSink, bool pEncoded) {
+    if (mPendingWhitespace == '\0') {
+        return;
+    }
+    const char whitespace = mPendingWhitespace;
+    mPendingWhitespace = '\0';
+    if (pEncoded) {
+        writeEscaped(pSink, static_cast<unsigned char>(whitespace));
+        return;
+    }
+    breakLineIfFull(pSink, 1);
+    pSink.append(&whitespace, 1);
+    mLineLength++;
+    mEncodedSize++;
+}
@@ -0,0 +1,98 @@
+#ifndef QUOTEDPRINTABLE_H
+#define QUOTEDPRINTABLE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+    #ifdef SMTPCLIENT_EXPORTS
+        #define QUOTEDPRINTABLE_API __declspec(dllexport)
+    #else
+        #define QUOTEDPRINTABLE_API __declspec(dllimport)
+    #endif
+#else
+    #define QUOTEDPRINTABLE_API
+#endif
+
+namespace jed_utils {
+/** @brief The QuotedPrintableEncoder class encodes a text content in
+ *  quoted-printable (RFC 2045 section 6.7) by blocks.
+ *
+ *  The line breaks of the content, CRLF or a bare LF, are written as CRLF.
+ *  The lines are limited to 76 characters with soft line breaks, and a dot
+ *  at the beginning of a line is encoded so that the content is sent with
+ *  DATA without being dot-stuffed. The runs of printable characters are
+ *  copied as a whole, with SSE2 when it is available.
+ *
+ *  The encoder can also measure the content without writing it, to know
+ *  the encoded size and whether any character had to be encoded.
+ */
+class QUOTEDPRINTABLE_API QuotedPrintableEncoder {
+ public:
+    /** The maximum length of an encoded line, without the CRLF. */
+    static constexpr size_t MAX_LINE_LENGTH = 76;
+
+    /** Construct a new QuotedPrintableEncoder. */
+    QuotedPrintableEncoder() = default;
+
+    /**
+     *  @brief  Encode the next block of the content.
+     *  @param pData The block.
+     *  @param pOutput The buffer that receives the encoded characters. A
+     *  trailing space or carriage return is kept until the next block.
+     */
+    void encode(std::string_view pData, std::string &pOutput);
+
+    /** Write the characters kept at the end of the content and reset the
+     *  state of the lines. The counters are kept. */
+    void finish(std::string &pOutput);
+
+    /** Count the next block of the content as encode does, without writing it. */
+    void measure(std::string_view pData);
+
+    /** Count the end of the content as finish does, without writing it. */
+    void finishMeasure();
+
+    /** Return the number of characters written or measured since the
+     *  construction or the last reset. */
+    size_t getEncodedSize() const;
+
+    /** Return the number of characters written as =XX. */
+    size_t getEscapedCount() const;
+
+    /** Return the number of soft line breaks written. */
+    size_t getSoftLineBreakCount() const;
+
+    /** Reset the state and the counters for a new content. */
+    void reset();
+
+    /** Return the quoted-printable encoding of a whole content. */
+    static std::string encodeAll(std::string_view pData);
+
+ private:
+    template <typename Sink>
+    void process(std::string_view pData, Sink &pSink);
+    template <typename Sink>
+    void end(Sink &pSink);
+    template <typename Sink>
+    void breakLineIfFull(Sink &pSink, size_t pLength);
+    template <typename Sink>
+    void writeLineBreak(Sink &pSink);
+    template <typename Sink>
+    void writeCharacter(Sink &pSink, unsigned char pChar);
+    template <typename Sink>
+    void writeEscaped(Sink &pSink, unsigned char pChar);
+    template <typename Sink>
+    void writePendingWhitespace(Sink &pSink, bool pEncoded);
+
+    size_t mLineLength = 0;
+    char mPendingWhitespace = '\0';
+    bool mPendingCarriageReturn = false;
+    size_t mEncodedSize = 0;
+    size_t mEscapedCount = 0;
+    size_t mSoftLineBreakCount = 0;
+};
+}  // namespace jed_utils
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef RECIPIENTRESULT_H
+#define RECIPIENTRESULT_H
+
+#include <cstddef>
+
+namespace jed_utils {
+/** @brief The RecipientResult struct contains the reply of the server to
+ *  the RCPT TO command of one envelope recipient.
+ *
+ *  The results are stored in an array of the client that is reused by the
+ *  transactions, so they are recorded without any allocation.
+ */
+struct RecipientResult {
+    /** The longest enhanced status code, x.yyy.zzz (RFC 3463). */
+    static constexpr size_t MAX_ENHANCED_STATUS_CODE_LENGTH = 9;
+
+    /** The reply code, 250 when the recipient is accepted, or 0 if the
+     *  command has not been answered. */
+    int ReplyCode = 0;
+    /** The enhanced status code of the reply or an empty string if the
+     *  server did not provide it. Example: 2.1.5, 5.1.1 */
+    char EnhancedStatusCode[MAX_ENHANCED_STATUS_CODE_LENGTH + 1] = {};
+};
+}  // namespace jed_utils
+
+#endif
@@ -0,0 +1,35 @@
+#include "recipienttable.h"
+
+using namespace jed_utils;
+
+void RecipientTable::reserve(size_t pCount, size_t pPoolSize) {
+    mEntries.reserve(pCount);
+    // The two terminating null characters of each entry
+    mPool.reserve(pPoolSize + pCount * 2);
+}
+
+void RecipientTable::append(std::string_view pEmailAddress, std::string_view pDisplayName) {
+    mEntries.push_back({ static_cast<uint32_t>(mPool.size()), static_cast<uint32_t>(pEmailAddress.size()) });
+    mPool.append(pEmailAddress).append(1, '\0');
+    mPool.append(pDisplayName).append(1, '\0');
+}
+
+size_t RecipientTable::size() const {
+    return mEntries.size();
+}
+
+bool RecipientTable::empty() const {
+    return mEntries.empty();
+}
+
+const char *RecipientTable::getEmailAddress(size_t pIndex) const {
+    return mPool.c_str() + mEntries[pIndex].emailOffset;
+}
+
+std::string_view RecipientTable::getEmailAddressView(size_t pIndex) const {
+    return std::string_view(mPool).substr(mEntries[pIndex].emailOffset, mEntries[pIndex].emailLength);
+}
+
+const char *RecipientTable::getDisplayName(size_t pIndex) const {
+    return mPool.c_str() + mEntries[pIndex].emailOffset + mEntries[pIndex].emailLength + 1;
+}
@@ -0,0 +1,79 @@
+#ifndef RECIPIENTTABLE_H
+#define RECIPIENTTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define RECIPIENTTABLE_API __declspec(dllexport)
+    #else
+        #define RECIPIENTTABLE_API __declspec(dllimport)
+    #endif
+#else
+    #define RECIPIENTTABLE_API
+#endif
+
+namespace jed_utils {
+/** @brief The RecipientTable class stores a list of email addresses and
+ *  their display names in a single string pool.
+ *
+ *  Each entry only keeps the offset and the lengths of its strings, so a
+ *  table of thousands of recipients is two allocations, is copied as two
+ *  blocks and is read sequentially. The strings are null-terminated in the
+ *  pool, the pointers returned remain valid until the next append.
+ */
+class RECIPIENTTABLE_API RecipientTable {
+ public:
+    /** Construct a new empty RecipientTable. */
+    RecipientTable() = default;
+
+    /**
+     *  @brief  Reserve the memory of the table.
+     *  @param pCount The number of entries.
+     *  @param pPoolSize The total length of the email addresses and of the
+     *  display names.
+     */
+    void reserve(size_t pCount, size_t pPoolSize);
+
+    /**
+     *  @brief  Add an entry at the end of the table. The address is not
+     *  validated, it usually comes from a MessageAddress.
+     *  @param pEmailAddress The email address.
+     *  @param pDisplayName The display name or an empty string.
+     */
+    void append(std::string_view pEmailAddress, std::string_view pDisplayName);
+
+    /** Return the number of entries. */
+    size_t size() const;
+
+    /** Indicate if the table has no entry. */
+    bool empty() const;
+
+    /** Return the email address of an entry. The index must be in range. */
+    const char *getEmailAddress(size_t pIndex) const;
+
+    /** Return the email address of an entry without computing its length.
+     *  The index must be in range. */
+    std::string_view getEmailAddressView(size_t pIndex) const;
+
+    /** Return the display name of an entry, an empty string if it has none.
+     *  The index must be in range. */
+    const char *getDisplayName(size_t pIndex) const;
+
+ private:
+    struct Entry {
+        // The display name follows the null-terminated email address
+        uint32_t emailOffset;
+        uint32_t emailLength;
+    };
+    std::string mPool;
+    std::vector<Entry> mEntries;
+};
+}  // namespace jed_utils
+
+#endif
@@ -0,0 +1,109 @@
+#include "relaygroup.h"
+#include <stdexcept>
+#include <utility>
+#include "errorresolver.h"
+#include "smtpserverstatuscodes.h"
+
+using namespace jed_utils;
+
+RelayGroup::RelayGroup(std::vector<RelayEndpoint> pEndpoints,
+        unsigned int pEjectionTimeInMilliseconds)
+    : mEndpoints(std::move(pEndpoints)),
+      mEjectionTime(pEjectionTimeInMilliseconds),
+      mStates(mEndpoints.size()) {
+    if (mEndpoints.empty()) {
+        throw std::invalid_argument("pEndpoints");
+    }
+    for (const RelayEndpoint &endpoint : mEndpoints) {
+        if (endpoint.ServerName.empty() || endpoint.Weight == 0) {
+            throw std::invalid_argument("pEndpoints");
+        }
+    }
+}
+
+bool RelayGroup::acquire(size_t &pIndex, const std::vector<size_t> &pTried) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const auto now = std::chrono::steady_clock::now();
+    const size_t count = mEndpoints.size();
+    bool found = false;
+    bool found_ejected = false;
+    size_t selected = 0;
+    for (size_t offset = 0; offset < count; offset++) {
+        const size_t index = (mNextIndex + offset) % count;
+        bool tried = false;
+        for (const size_t tried_index : pTried) {
+            tried = tried || tried_index == index;
+        }
+        if (tried) {
+            continue;
+        }
+        const EndpointState &state = mStates[index];
+        const bool ejected = state.ejectedUntil > now;
+        bool better = !found || (found_ejected && !ejected);
+        if (found && ejected == found_ejected) {
+            if (ejected) {
+                better = state.ejectedUntil < mStates[selected].ejectedUntil;
+            } else {
+                // Compare (outstanding + 1) / weight without division, the
+                // first server of the turn keeping the ties
+                better = (state.outstandingCount + 1) * mEndpoints[selected].Weight <
+                    (mStates[selected].outstandingCount + 1) * mEndpoints[index].Weight;
+            }
+        }
+        if (better) {
+            found = true;
+            found_ejected = ejected;
+            selected = index;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    mStates[selected].outstandingCount++;
+    mNextIndex = (selected + 1) % count;
+    pIndex = selected;
+    return true;
+}
+
+void RelayGroup::release(size_t pIndex, int pReturnCode) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (pIndex >= mStates.size()) {
+        return;
+    }
+    EndpointState &state = mStates[pIndex];
+    if (state.outstandingCount > 0) {
+        state.outstandingCount--;
+    }
+    if (isFailoverError(pReturnCode)) {
+        state.ejectedUntil = std::chrono::steady_clock::now() + mEjectionTime;
+    } else if (pReturnCode == 0) {
+        // The server is reachable again
+        state.ejectedUntil = std::chrono::steady_clock::time_point();
+    }
+}
+
+size_t RelayGroup::getEndpointCount() const {
+    return mEndpoints.size();
+}
+
+const RelayEndpoint &RelayGroup::getEndpoint(size_t pIndex) const {
+    return mEndpoints.at(pIndex);
+}
+
+size_t RelayGroup::getOutstandingCount(size_t pIndex) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStates.at(pIndex).outstandingCount;
+}
+
+bool RelayGroup::isEjected(size_t pIndex) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStates.at(pIndex).ejectedUntil > std::chrono::steady_clock::now();
+}
+
+bool RelayGroup::isFailoverError(int pReturnCode) {
+    if (pReturnCode == STATUS_CODE_SERVICE_NOT_AVAILABLE) {
+        return true;
+    }
+    const ErrorCategory category = ErrorResolver::findErrorCategory(pReturnCode);
+    return category == ErrorCategory::Transport || category == ErrorCategory::TLS;
+}
@@ -0,0 +1,113 @@
+#ifndef RELAYGROUP_H
+#define RELAYGROUP_H
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define RELAYGROUP_API __declspec(dllexport)
+    #else
+        #define RELAYGROUP_API __declspec(dllimport)
+    #endif
+#else
+    #define RELAYGROUP_API
+#endif
+
+namespace jed_utils {
+/** @brief The RelayEndpoint struct contains the address of one of the
+ *  servers of a RelayGroup. */
+struct RelayEndpoint {
+    /** The name of the server. */
+    std::string ServerName;
+    /** The server port number. */
+    unsigned int Port = 25;
+    /** The share of the messages given to the server, at least 1. A server
+     *  with a weight of 2 receives twice as many parallel deliveries as a
+     *  server with a weight of 1. */
+    unsigned int Weight = 1;
+};
+
+/** @brief The RelayGroup class balances the deliveries among several
+ *  equivalent relay servers and moves them away from the servers that fail.
+ *
+ *  Each delivery goes to the available server with the fewest deliveries in
+ *  progress relative to its weight, the ties being given in turn. A server
+ *  that cannot be reached, such as after SOCKET_INIT_SESSION_CONNECT_ERROR,
+ *  SOCKET_INIT_SESSION_CONNECT_TIMEOUT or a failed TLS negotiation, or that
+ *  replies STATUS_CODE_SERVICE_NOT_AVAILABLE is ejected for the ejection
+ *  time, so that the next deliveries do not wait for it. When all the
+ *  servers are ejected, the one whose ejection ends first is still used.
+ *  The class is thread-safe and can be shared by several queues.
+ */
+class RELAYGROUP_API RelayGroup {
+ public:
+    /**
+     *  @brief  Construct a new RelayGroup.
+     *  @param pEndpoints The relay servers.
+     *  @param pEjectionTimeInMilliseconds The time during which a failed
+     *  server receives no delivery.
+     *  @throw std::invalid_argument pEndpoints is empty or contains a server
+     *  without name or with a weight of 0.
+     */
+    explicit RelayGroup(std::vector<RelayEndpoint> pEndpoints,
+            unsigned int pEjectionTimeInMilliseconds = 30000);
+
+    RelayGroup(const RelayGroup& other) = delete;
+    RelayGroup& operator=(const RelayGroup& other) = delete;
+
+    /**
+     *  @brief  Select the server of the next delivery.
+     *  @param pIndex Receive the index of the server to pass to release.
+     *  @param pTried The indexes of the servers not to select, such as those
+     *  already tried for the message.
+     *  @return True if a server is selected, false if all the servers are
+     *  excluded.
+     */
+    bool acquire(size_t &pIndex, const std::vector<size_t> &pTried = {});
+
+    /**
+     *  @brief  End a delivery started with acquire and eject the server if
+     *  the return code is a failover error.
+     *  @param pIndex The index given by acquire.
+     *  @param pReturnCode The return code of the delivery.
+     */
+    void release(size_t pIndex, int pReturnCode);
+
+    /** Return the number of servers of the group. */
+    size_t getEndpointCount() const;
+
+    /** Return a server of the group. */
+    const RelayEndpoint &getEndpoint(size_t pIndex) const;
+
+    /** Return the number of deliveries in progress to a server. */
+    size_t getOutstandingCount(size_t pIndex) const;
+
+    /** Indicate if a server is ejected. */
+    bool isEjected(size_t pIndex) const;
+
+    /** Indicate if a return code means that the server could not be used,
+     *  so that the message can be sent again through another server of the
+     *  group: a transport or a TLS error or STATUS_CODE_SERVICE_NOT_AVAILABLE. */
+    static bool isFailoverError(int pReturnCode);
+
+ private:
+    struct EndpointState {
+        size_t outstandingCount = 0;
+        std::chrono::steady_clock::time_point ejectedUntil;
+    };
+
+    std::vector<RelayEndpoint> mEndpoints;
+    std::chrono::milliseconds mEjectionTime;
+    mutable std::mutex mMutex;
+    std::vector<EndpointState> mStates;
+    // The position from which the ties are given in turn
+    size_t mNextIndex = 0;
+};
+}  // namespace jed_utils
+
+#endif
@@ -1,6 +1,11 @@
 #include "securesmtpclientbase.h"
 #include <openssl/err.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
 #include <string>
+#include <string_view>
 #include <utility>
 #include "smtpclienterrors.h"
 #include "socketerrors.h"
@@ -12,7 +17,6 @@
     #include <BaseTsd.h>
     typedef SSIZE_T ssize_t;
     #include <windows.h>
-    constexpr auto sleep = Sleep;
 #else
     #include <fcntl.h>
     #include <netdb.h>
@@ -26,30 +30,34 @@ using namespace jed_utils;
 
 SecureSMTPClientBase::SecureSMTPClientBase(const char *pServerName, unsigned int pPort)
     : SMTPClientBase(pServerName, pPort),
-    mBIO(nullptr),
-    mCTX(nullptr),
-    mSSL(nullptr) {
+    mReadBIO(nullptr),
+    mWriteBIO(nullptr),
+    mTlsContext(nullptr) {
 }
 
 SecureSMTPClientBase::~SecureSMTPClientBase() {
     SecureSMTPClientBase::cleanup();
 }
 
-// Copy constructor
+// Copy constructor: the TLS context is configuration and is shared, the
+// copy is not connected so it has no TLS session
 SecureSMTPClientBase::SecureSMTPClientBase(const SecureSMTPClientBase& other)
     : SMTPClientBase(other),
-    mBIO(nullptr),
-    mCTX(nullptr),
-    mSSL(nullptr) {
+    mReadBIO(nullptr),
+    mWriteBIO(nullptr),
+    mTlsContext(other.mTlsContext) {
 }
 
 // Assignment operator
 SecureSMTPClientBase& SecureSMTPClientBase::operator=(const SecureSMTPClientBase& other) {
     if (this != &other) {
+        // The TLS session of this client ends with its connection
+        if (mSSL != nullptr) {
+            SecureSMTPClientBase::cleanup();
+        }
         SMTPClientBase::operator=(other);
-        mBIO = nullptr;
-        mCTX = nullptr;
-        mSSL = nullptr;
+        mTlsContext = other.mTlsContext;
+        mWriteBuffer.clear();
     }
     return *this;
 }
@@ -57,53 +65,49 @@ SecureSMTPClientBase& SecureSMTPClientBase::operator=(const SecureSMTPClientBase
 // Move constructor
 SecureSMTPClientBase::SecureSMTPClientBase(SecureSMTPClientBase&& other) noexcept
 : SMTPClientBase(std::move(other)),
-    mBIO(other.mBIO),
-    mCTX(other.mCTX),
-    mSSL(other.mSSL) {
-    // Release the data pointer from the source object so that the destructor
-    // does not free the memory multiple times.
-    other.mBIO = nullptr;
-    other.mCTX = nullptr;
-    other.mSSL = nullptr;
+    mReadBIO(other.mReadBIO),
+    mWriteBIO(other.mWriteBIO),
+    mTlsContext(std::move(other.mTlsContext)),
+    mActiveTlsContext(std::move(other.mActiveTlsContext)),
+    mSSL(std::move(other.mSSL)),
+    mWriteBuffer(std::move(other.mWriteBuffer)) {
+    // The BIOs belong to the SSL object that has been moved
+    other.mReadBIO = nullptr;
+    other.mWriteBIO = nullptr;
 }
 
 // Move assignement operator
 SecureSMTPClientBase& SecureSMTPClientBase::operator=(SecureSMTPClientBase&& other) noexcept {
     if (this != &other) {
-        // Copy the data pointer and its length from the source object.
-        mBIO = other.mBIO;
-        mCTX = other.mCTX;
-        mSSL = other.mSSL;
-        // Release the data pointer from the source object so that
-        // the destructor does not free the memory multiple times.
-        other.mBIO = nullptr;
-        other.mCTX = nullptr;
-        other.mSSL = nullptr;
+        if (mSSL != nullptr) {
+            SecureSMTPClientBase::cleanup();
+        }
+        mReadBIO = other.mReadBIO;
+        mWriteBIO = other.mWriteBIO;
+        mTlsContext = std::move(other.mTlsContext);
+        mActiveTlsContext = std::move(other.mActiveTlsContext);
+        mSSL = std::move(other.mSSL);
+        mWriteBuffer = std::move(other.mWriteBuffer);
+        other.mReadBIO = nullptr;
+        other.mWriteBIO = nullptr;
         SMTPClientBase::operator=(std::move(other));
     }
     return *this;
 }
 
 void SecureSMTPClientBase::cleanup() {
-    if (mCTX != nullptr) {
-        SSL_CTX_free(mCTX);
-    }
-    mCTX = nullptr;
-    if (mBIO != nullptr) {
-        BIO_free_all(mBIO);
-    }
-    mBIO = nullptr;
-    int socketFileDescriptor {getSocketFileDescriptor() };
-    if (socketFileDescriptor != 0) {
-#ifdef _WIN32
-        shutdown(socketFileDescriptor, SD_BOTH);
-        closesocket(socketFileDescriptor);
-#else
-        close(socketFileDescriptor);
-#endif
+    if (mSSL != nullptr && SSL_is_init_finished(mSSL.get())) {
+        // Mark the session as closed without sending an alert, otherwise
+        // OpenSSL flags it as not resumable when the SSL object is freed
+        SSL_set_quiet_shutdown(mSSL.get(), 1);
+        SSL_shutdown(mSSL.get());
     }
-    clearSocketFileDescriptor();
-    mSSL = nullptr;
+    // The SSL object owns its memory BIOs
+    mSSL.reset();
+    mReadBIO = nullptr;
+    mWriteBIO = nullptr;
+    mActiveTlsContext.reset();
+    closeSocket();
 #ifdef _WIN32
     if (isWSAStarted() && WSACleanup() != 0) {
         int wsa_retVal = WSAGetLastError();
@@ -116,97 +120,85 @@ void SecureSMTPClientBase::cleanup() {
 #endif
 }
 
-BIO* SecureSMTPClientBase::getBIO() const {
-    return mBIO;
+SSL* SecureSMTPClientBase::getSSL() const {
+    return mSSL.get();
 }
 
-void SecureSMTPClientBase::initializeSSLContext() {
-    SSL_library_init();
-
-    OpenSSL_add_all_algorithms();
-    SSL_load_error_strings();
-    const SSL_METHOD *method = TLS_client_method();
-    mCTX = SSL_CTX_new(method);
+std::shared_ptr<TlsContext> SecureSMTPClientBase::getTlsContext() const {
+    return mTlsContext;
+}
 
-    if (mCTX == nullptr) {
-        setLastSocketErrNo(static_cast<int>(ERR_get_error()));
-    }
+void SecureSMTPClientBase::setTlsContext(std::shared_ptr<TlsContext> pTlsContext) {
+    mTlsContext = std::move(pTlsContext);
 }
 
 int SecureSMTPClientBase::startTLSNegotiation() {
     addCommunicationLogItem("<Start TLS negotiation>");
-    initializeSSLContext();
-    if (mCTX == nullptr) {
-        return SSL_CLIENT_STARTTLS_INITSSLCTX_ERROR;
+    // Data received before the TLS session must not be read as a reply
+    // received through the secure channel
+    discardPendingServerData();
+    // The trust anchors are loaded once per process, not per connection
+    std::shared_ptr<TlsContext> tls_context = mTlsContext != nullptr ? mTlsContext : TlsContext::getDefault();
+    if (!tls_context->isValid()) {
+        setLastSocketErrNo(tls_context->getLastSSLErrNo());
+        return tls_context->getInitializationErrorCode();
     }
 
-    mBIO = BIO_new_ssl_connect(mCTX);
-    if (mBIO == nullptr) {
+    // The records are exchanged through memory BIOs and sent or received
+    // with the raw I/O of the session, socket or transport
+    mSSL.reset(SSL_new(tls_context->getNativeContext()));
+    BIO *read_bio = BIO_new(BIO_s_mem());
+    BIO *write_bio = BIO_new(BIO_s_mem());
+    if (mSSL == nullptr || read_bio == nullptr || write_bio == nullptr) {
+        BIO_free(read_bio);
+        BIO_free(write_bio);
+        mSSL.reset();
         return SSL_CLIENT_STARTTLS_BIONEWSSLCONNECT_ERROR;
     }
+    // An empty read BIO asks for more data instead of reporting the end of
+    // the connection
+    BIO_set_mem_eof_return(read_bio, -1);
+    SSL_set_bio(mSSL.get(), read_bio, write_bio);
+    mReadBIO = read_bio;
+    mWriteBIO = write_bio;
+    SSL_set_connect_state(mSSL.get());
+    mActiveTlsContext = tls_context;
 
-    /* Link bio channel, SSL session, and server endpoint */
     const int SERVERNAMEANDPORT_LENGTH = 1024;
     char name[SERVERNAMEANDPORT_LENGTH];
-    sprintf(name, "%s:%u", getServerName(), getServerPort());
-    BIO_get_ssl(mBIO, &mSSL); /* session */
-    SSL_set_fd(mSSL, getSocketFileDescriptor());
-    SSL_set_mode(mSSL, SSL_MODE_AUTO_RETRY); /* robustness */
-    BIO_set_conn_hostname(mBIO, name); /* prepare to connect */
-
-#ifdef _WIN32
-    /* On Windows, we need to import all the ROOT certificates to
-       the OpenSSL Store */
-    PCCERT_CONTEXT pContext = nullptr;
-    X509_STORE *store = SSL_CTX_get_cert_store(mCTX);
-    HCERTSTORE hStore = CertOpenSystemStore(NULL, "ROOT");
-
-    if (!hStore) {
-        setLastSocketErrNo(static_cast<int>(GetLastError()));
-        return SSL_CLIENT_STARTTLS_WIN_CERTOPENSYSTEMSTORE_ERROR;
-    }
-
-    pContext = CertEnumCertificatesInStore(hStore, pContext);
-    while (pContext) {
-        X509 *x509 = nullptr;
-        x509 = d2i_X509(nullptr, (const unsigned char **)&pContext->pbCertEncoded, pContext->cbCertEncoded);
-        if (x509) {
-            X509_STORE_add_cert(store, x509);
-            X509_free(x509);
-        }
-        pContext = CertEnumCertificatesInStore(hStore, pContext);
-    }
-#else
-    if (SSL_CTX_set_default_verify_paths(mCTX) == 0) {
-        return SSL_CLIENT_STARTTLS_CTX_SET_DEFAULT_VERIFY_PATHS_ERROR;
-    }
-#endif
-    long verify_flag = SSL_get_verify_result(mSSL);
-    if (verify_flag != X509_V_OK) {
-        fprintf(stderr,
-                "##### Certificate verification error (%i) but continuing...\n",
-                static_cast<int>(verify_flag));
-    }
-
-    /* Try to connect */
-    if (BIO_do_connect(mBIO) <= 0) {
-        cleanup();
-        setLastSocketErrNo(static_cast<int>(ERR_get_error()));
-        return SSL_CLIENT_STARTTLS_BIO_CONNECT_ERROR;
-    }
+    snprintf(name, sizeof(name), "%s:%u", getServerName(), getServerPort());
+    /* Offer the session previously negotiated with this server */
+    tls_context->prepareSession(mSSL.get(), name);
 
     /* Try to do the handshake */
     addCommunicationLogItem("<Negotiate a TLS session>", "c & s");
-    if (BIO_do_handshake(mBIO) <= 0) {
+    for (;;) {
+        ERR_clear_error();
+        int handshake_ret_code = SSL_do_handshake(mSSL.get());
+        if (handshake_ret_code == 1) {
+            break;
+        }
+        if (continueTLSOperation(handshake_ret_code, getCommandTimeoutInMilliseconds()) <= 0) {
+            cleanup();
+            return SSL_CLIENT_STARTTLS_BIO_HANDSHAKE_ERROR;
+        }
+    }
+    // The last flight of the handshake is still in the write BIO
+    if (!flushTLSOutput()) {
         cleanup();
-        setLastSocketErrNo(static_cast<int>(ERR_get_error()));
         return SSL_CLIENT_STARTTLS_BIO_HANDSHAKE_ERROR;
     }
+    tls_context->recordHandshake(mSSL.get());
+    const bool session_resumed = SSL_session_reused(mSSL.get()) != 0;
+    if (session_resumed) {
+        addCommunicationLogItem("<TLS session resumed>", "c & s");
+    }
+    recordTlsHandshake(session_resumed);
 
     addCommunicationLogItem("<Check result of negotiation>", "c & s");
     /* Step 1: Verify a server certificate was presented
        during the negotiation */
-    X509* cert = SSL_get_peer_certificate(mSSL);
+    X509* cert = SSL_get_peer_certificate(mSSL.get());
     if (cert != nullptr) {
         X509_free(cert); /* Free immediately */
     }
@@ -217,7 +209,7 @@ int SecureSMTPClientBase::startTLSNegotiation() {
 
     /* Step 2: verify the result of chain verification */
     /* Verification performed according to RFC 4158    */
-    int res = static_cast<int>(SSL_get_verify_result(mSSL));
+    int res = static_cast<int>(SSL_get_verify_result(mSSL.get()));
     if (!(X509_V_OK == res)) {
         addCommunicationLogItem(X509_verify_cert_error_string(res), "s");
         cleanup();
@@ -225,11 +217,6 @@ int SecureSMTPClientBase::startTLSNegotiation() {
     }
 
     addCommunicationLogItem("TLS session ready!");
-
-#ifdef _WIN32
-    CertFreeCertificateContext(pContext);
-    CertCloseStore(hStore, 0);
-#endif
     return 0;
 }
 
@@ -244,42 +231,174 @@ int SecureSMTPClientBase::getServerSecureIdentification() {
     if (tls_command_return_code != EHLO_SUCCESS_CODE) {
         return tls_command_return_code;
     }
-    // Inspect the returned values for authentication options
-    setAuthenticationOptions(SMTPClientBase::extractAuthenticationOptions(getLastServerResponse()));
+    // Inspect the returned values once for the extensions and authentication options
+    const ServerCapabilities capabilities = resolveServerCapabilities(true);
+    setServerCapabilities(capabilities);
+    setAuthenticationOptions(capabilities.Auth ? new ServerAuthOptions(capabilities.AuthOptions) : nullptr);
     return EHLO_SUCCESS_CODE;
 }
 
 int SecureSMTPClientBase::sendCommand(const char *pCommand, int pErrorCode) {
-    if (BIO_puts(mBIO, pCommand) < 0) {
-        setLastSocketErrNo(static_cast<int>(ERR_get_error()));
-        cleanup();
+    if (!writeTLS(pCommand, strlen(pCommand)) || !flushTLSOutput()) {
         return pErrorCode;
     }
     return 0;
 }
 
 int SecureSMTPClientBase::sendCommandWithFeedback(const char *pCommand, int pErrorCode, int pTimeoutCode) {
-    unsigned int waitTime {0};
-    int bytes_received {0};
-    char outbuf[SERVERRESPONSE_BUFFER_LENGTH];
-
-    if (BIO_puts(mBIO, pCommand) < 0) {
-        setLastSocketErrNo(static_cast<int>(ERR_get_error()));
-        cleanup();
+    if (!writeTLS(pCommand, strlen(pCommand)) || !flushTLSOutput()) {
         return pErrorCode;
     }
 
-    while ((bytes_received = BIO_read(mBIO, outbuf, SERVERRESPONSE_BUFFER_LENGTH)) <= 0 && waitTime < getCommandTimeout()) {
-        sleep(1);
-        waitTime += 1;
-    }
-    if (waitTime < getCommandTimeout()) {
-        outbuf[bytes_received-1] = '\0';
-        setLastServerResponse(outbuf);
-        addCommunicationLogItem(outbuf, "s");
-        return extractReturnCode(outbuf);
+    if (readServerReply()) {
+        return getServerReplyReader().getCode();
     }
 
     cleanup();
     return pTimeoutCode;
 }
+
+int SecureSMTPClientBase::sendDataSegments(const std::string_view *pSegments, size_t pSegmentCount, int pErrorCode) {
+    const size_t write_size = getDataWriteSize();
+    mWriteBuffer.clear();
+    mWriteBuffer.reserve(write_size);
+    for (size_t index = 0; index < pSegmentCount; index++) {
+        std::string_view segment { pSegments[index] };
+        while (!segment.empty()) {
+            size_t length;
+            if (mWriteBuffer.empty() && segment.length() >= write_size) {
+                // Large segments are written without being copied
+                length = write_size;
+                if (!writeTLS(segment.data(), length)) {
+                    return pErrorCode;
+                }
+            } else {
+                length = (std::min)(write_size - mWriteBuffer.length(), segment.length());
+                mWriteBuffer.append(segment.data(), length);
+                if (mWriteBuffer.length() == write_size) {
+                    if (!writeTLS(mWriteBuffer.data(), mWriteBuffer.length())) {
+                        return pErrorCode;
+                    }
+                    mWriteBuffer.clear();
+                }
+            }
+            segment.remove_prefix(length);
+        }
+    }
+    if (!mWriteBuffer.empty() && !writeTLS(mWriteBuffer.data(), mWriteBuffer.length())) {
+        return pErrorCode;
+    }
+    if (!flushTLSOutput()) {
+        return pErrorCode;
+    }
+    return 0;
+}
+
+bool SecureSMTPClientBase::writeTLS(const char *pData, size_t pLength) {
+    if (mSSL == nullptr) {
+        return false;
+    }
+    while (pLength > 0) {
+        ERR_clear_error();
+        int bytes_written = SSL_write(mSSL.get(), pData,
+                static_cast<int>((std::min)(pLength, static_cast<size_t>((std::numeric_limits<int>::max)()))));
+        if (bytes_written <= 0) {
+            if (continueTLSOperation(bytes_written, getCommandTimeoutInMilliseconds()) > 0) {
+                continue;
+            }
+            cleanup();
+            return false;
+        }
+        pData += bytes_written;
+        pLength -= static_cast<size_t>(bytes_written);
+    }
+    // The records are sent once they fill a write, the last ones by
+    // flushTLSOutput
+    if (BIO_ctrl_pending(mWriteBIO) >= getDataWriteSize()) {
+        return flushTLSOutput();
+    }
+    return true;
+}
+
+bool SecureSMTPClientBase::flushTLSOutput() {
+    if (mWriteBIO == nullptr) {
+        return false;
+    }
+    char *data = nullptr;
+    long length = BIO_get_mem_data(mWriteBIO, &data);
+    if (length <= 0) {
+        return true;
+    }
+    // The records are sent from the buffer of the BIO without being copied
+    std::string_view records { data, static_cast<size_t>(length) };
+    if (sendRawDataSegments(&records, 1, -1) != 0) {
+        return false;
+    }
+    (void)BIO_reset(mWriteBIO);
+    return true;
+}
+
+int SecureSMTPClientBase::continueTLSOperation(int pResult, unsigned int pTimeoutInMilliseconds) {
+    int ssl_error = SSL_get_error(mSSL.get(), pResult);
+    // The records produced by the operation, an alert included, are sent
+    // before waiting for the server
+    if (!flushTLSOutput()) {
+        return -1;
+    }
+    if (ssl_error == SSL_ERROR_WANT_WRITE) {
+        return 1;
+    }
+    if (ssl_error != SSL_ERROR_WANT_READ) {
+        setLastSocketErrNo(static_cast<int>(ERR_get_error()));
+        return -1;
+    }
+    char buffer[TLS_READ_SIZE];
+    int bytes_received = receiveRawData(buffer, sizeof(buffer), pTimeoutInMilliseconds);
+    if (bytes_received <= 0) {
+        return bytes_received;
+    }
+    if (BIO_write(mReadBIO, buffer, bytes_received) != bytes_received) {
+        return -1;
+    }
+    return 1;
+}
+
+int SecureSMTPClientBase::receiveData(char *pBuffer, size_t pLength, unsigned int pTimeoutInMilliseconds) {
+    if (pLength > static_cast<size_t>((std::numeric_limits<int>::max)())) {
+        pLength = static_cast<size_t>((std::numeric_limits<int>::max)());
+    }
+    if (mSSL == nullptr) {
+        return -1;
+    }
+    // The records already received are decrypted before waiting for more
+    for (;;) {
+        ERR_clear_error();
+        int bytes_received = SSL_read(mSSL.get(), pBuffer, static_cast<int>(pLength));
+        if (bytes_received > 0) {
+            return drainTLSInput(pBuffer, pLength, static_cast<size_t>(bytes_received));
+        }
+        int continue_ret_code = continueTLSOperation(bytes_received, pTimeoutInMilliseconds);
+        if (continue_ret_code <= 0) {
+            return continue_ret_code;
+        }
+    }
+}
+
+int SecureSMTPClientBase::drainTLSInput(char *pBuffer, size_t pLength, size_t pBytesReceived) {
+    // SSL_read returns one record at most: the rest of the record
+    // (SSL_pending) and the records already in the read BIO are decrypted
+    // into the same buffer, so that a reply split across records or a
+    // group of pipelined replies is handed to the reply reader at once
+    while (pBytesReceived < pLength && (SSL_pending(mSSL.get()) > 0 || BIO_ctrl_pending(mReadBIO) > 0)) {
+        ERR_clear_error();
+        int bytes_received = SSL_read(mSSL.get(), pBuffer + pBytesReceived, static_cast<int>(pLength - pBytesReceived));
+        if (bytes_received <= 0) {
+            // A partial record is completed by the next read, a failure is
+            // reported by it too
+            ERR_clear_error();
+            break;
+        }
+        pBytesReceived += static_cast<size_t>(bytes_received);
+    }
+    return static_cast<int>(pBytesReceived);
+}
@@ -2,7 +2,11 @@
 #define SECURESMTPCLIENTBASE_H
 
 #include <openssl/ssl.h>
+#include <memory>
+#include <string>
+#include <string_view>
 #include "smtpclientbase.h"
+#include "tlscontext.h"
 
 #ifdef _WIN32
     #ifdef SMTPCLIENT_EXPORTS
@@ -32,35 +36,80 @@ class SECURESMTPCLIENTBASE_API SecureSMTPClientBase : public SMTPClientBase {
     /** Destructor of the SecureSMTPClientBase. */
     ~SecureSMTPClientBase();
 
-    /** SecureSMTPClientBase copy constructor. */
+    /** SecureSMTPClientBase copy constructor. The copy shares the TLS
+     *  context and is not connected, so it has no TLS session. */
     SecureSMTPClientBase(const SecureSMTPClientBase& other);
 
-    /** SecureSMTPClientBase copy assignment operator. */
+    /** SecureSMTPClientBase copy assignment operator. The TLS session of
+     *  this client is closed. */
     SecureSMTPClientBase& operator=(const SecureSMTPClientBase& other);
 
-    /** SecureSMTPClientBase move constructor. */
+    /** SecureSMTPClientBase move constructor. The TLS session is moved with
+     *  the connection. */
     SecureSMTPClientBase(SecureSMTPClientBase&& other) noexcept;
 
-    /** SecureSMTPClientBase move assignment operator. */
+    /** SecureSMTPClientBase move assignment operator. The TLS session of
+     *  this client is closed and replaced by the one of the source. */
     SecureSMTPClientBase& operator=(SecureSMTPClientBase&& other) noexcept;
 
+    /** Return the TLS context set with setTlsContext or nullptr if the
+     *  process-wide default context is used. */
+    std::shared_ptr<TlsContext> getTlsContext() const;
+
+    /**
+     *  @brief  Set the TLS context used by the next TLS negotiations. The
+     *  context can be shared with other clients.
+     *  @param pTlsContext The context or nullptr to use TlsContext::getDefault().
+     */
+    void setTlsContext(std::shared_ptr<TlsContext> pTlsContext);
+
  protected:
     // Methods
     void cleanup() override;
-    BIO *getBIO() const;
+    SSL *getSSL() const;
     // Methods used to establish the connection with server
     int getServerSecureIdentification();
     int startTLSNegotiation();
-    void initializeSSLContext();
     // Methods to send commands to the server
     int sendCommand(const char *pCommand, int pErrorCode) override;
     int sendCommandWithFeedback(const char *pCommand, int pErrorCode, int pTimeoutCode) override;
+    int receiveData(char *pBuffer, size_t pLength, unsigned int pTimeoutInMilliseconds) override;
+    // Coalesce the segments in writes of getDataWriteSize() bytes so that
+    // each write fills complete TLS records.
+    int sendDataSegments(const std::string_view *pSegments, size_t pSegmentCount, int pErrorCode) override;
 
  private:
-    // Attributes used to communicate with the server
-    BIO *mBIO;
-    SSL_CTX *mCTX;
-    SSL *mSSL;
+    // Encrypt the data into the write BIO
+    bool writeTLS(const char *pData, size_t pLength);
+    // Send the records of the write BIO to the server
+    bool flushTLSOutput();
+    // Handle an SSL operation that did not complete: send the pending
+    // records and receive more of them if the operation needs them.
+    // Return 1 to retry the operation, 0 on timeout and -1 on error.
+    int continueTLSOperation(int pResult, unsigned int pTimeoutInMilliseconds);
+    // Decrypt the data already received after the first pBytesReceived
+    // bytes of the buffer, without waiting. Return the bytes in the buffer.
+    int drainTLSInput(char *pBuffer, size_t pLength, size_t pBytesReceived);
+    // Size of the reads of the records received, a full TLS record and its
+    // header
+    static const size_t TLS_READ_SIZE = 16384 + 2048;
+
+    struct SslDeleter {
+        void operator()(SSL *pSSL) const {
+            SSL_free(pSSL);
+        }
+    };
+
+    // Attributes used to communicate with the server: the SSL object reads
+    // the received records from mReadBIO and writes the records to send to
+    // mWriteBIO
+    BIO *mReadBIO;
+    BIO *mWriteBIO;
+    std::shared_ptr<TlsContext> mTlsContext;
+    // Context of the current TLS session, kept alive as long as the SSL object
+    std::shared_ptr<TlsContext> mActiveTlsContext;
+    std::unique_ptr<SSL, SslDeleter> mSSL;
+    std::string mWriteBuffer;
 };
 }  // namespace jed_utils
 
@@ -0,0 +1,47 @@
+#ifndef SENDRESULT_H
+#define SENDRESULT_H
+
+#include <cstddef>
+#include <string_view>
+#include "errorresolver.h"
+#include "recipientresult.h"
+#include "sessionobserver.h"
+
+namespace jed_utils {
+/** @brief The SendResult struct describes the outcome of the last message
+ *  sent by a client without any allocation. The views refer to the static
+ *  messages of ErrorResolver and to the buffers of the client, they remain
+ *  valid until the next command sent by the client.
+ */
+struct SendResult {
+    /** 0 for success, otherwise the error code of the failed step. */
+    int ReturnCode = 0;
+    /** The category of ReturnCode, see ErrorResolver::findErrorCategory. */
+    ErrorCategory Category = ErrorCategory::None;
+    /** Indicate if the failure happened in a phase of the session. The
+     *  checks done before the first command, such as the size of the
+     *  message, have no phase.
+     */
+    bool HasFailedPhase = false;
+    /** The phase that failed when HasFailedPhase is true. */
+    SessionPhase FailedPhase = SessionPhase::Connection;
+    /** The message of ReturnCode, see ErrorResolver::findErrorMessage. */
+    std::string_view Message;
+    /** The last reply of the server received while sending the message,
+     *  or an empty view if no reply was received.
+     */
+    std::string_view ServerReply;
+    /** The enhanced status code of the reply that determined the result
+     *  (RFC 3463) or an empty view if the server did not provide it.
+     *  Example: 2.0.0, 5.1.1
+     */
+    std::string_view EnhancedStatusCode;
+    /** The reply to each envelope recipient, in the order of the envelope,
+     *  or nullptr if the recipients were not sent. */
+    const RecipientResult *RecipientResults = nullptr;
+    /** The number of elements of RecipientResults. */
+    size_t RecipientResultCount = 0;
+};
+}  // namespace jed_utils
+
+#endif
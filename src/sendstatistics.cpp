@@ -0,0 +1,227 @@
+#include "sendstatistics.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace jed_utils;
+
+const size_t LatencyHistogram::BUCKET_COUNT;
+const int SendStatistics::MIN_REPLY_CODE;
+const int SendStatistics::MAX_REPLY_CODE;
+const size_t SendStatistics::REPLY_CODE_COUNT;
+
+namespace {
+// 8 sub-buckets per power of two, the durations below 8 ns have their own bucket
+const unsigned int SUB_BUCKET_BITS = 3;
+const uint64_t SUB_BUCKET_COUNT = 1U << SUB_BUCKET_BITS;
+// About 73 minutes
+const uint64_t MAX_RECORDED_VALUE = (static_cast<uint64_t>(1) << 42) - 1;
+
+unsigned int getHighestBit(uint64_t pValue) {
+    unsigned int bit = 0;
+    while (pValue >>= 1) {
+        bit++;
+    }
+    return bit;
+}
+
+void updateMax(std::atomic<uint64_t> &pMax, uint64_t pValue) {
+    uint64_t current = pMax.load(std::memory_order_relaxed);
+    while (current < pValue && !pMax.compare_exchange_weak(current, pValue, std::memory_order_relaxed)) {
+    }
+}
+}  // namespace
+
+void LatencyHistogram::record(std::chrono::nanoseconds pDuration) {
+    const uint64_t value = static_cast<uint64_t>((std::max)(pDuration.count(), static_cast<std::chrono::nanoseconds::rep>(0)));
+    mBuckets[getBucketIndex(pDuration)].fetch_add(1, std::memory_order_relaxed);
+    mCount.fetch_add(1, std::memory_order_relaxed);
+    mTotal.fetch_add(value, std::memory_order_relaxed);
+    updateMax(mMax, value);
+}
+
+uint64_t LatencyHistogram::getCount() const {
+    return mCount.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds LatencyHistogram::getTotal() const {
+    return std::chrono::nanoseconds(mTotal.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds LatencyHistogram::getMax() const {
+    return std::chrono::nanoseconds(mMax.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds LatencyHistogram::getValueAtPercentile(double pPercentile) const {
+    // The buckets are read one by one, their sum is the count
+    std::array<uint64_t, BUCKET_COUNT> counts {};
+    uint64_t count = 0;
+    for (size_t index = 0; index < BUCKET_COUNT; index++) {
+        counts[index] = mBuckets[index].load(std::memory_order_relaxed);
+        count += counts[index];
+    }
+    if (count == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    const double percentile = (std::min)((std::max)(pPercentile, 0.0), 100.0);
+    const auto rank = (std::max)(static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(count))),
+            static_cast<uint64_t>(1));
+    uint64_t cumulated = 0;
+    for (size_t index = 0; index < BUCKET_COUNT; index++) {
+        cumulated += counts[index];
+        if (cumulated >= rank) {
+            return (std::min)(getBucketUpperBound(index), getMax());
+        }
+    }
+    return getMax();
+}
+
+uint64_t LatencyHistogram::getBucketCount(size_t pIndex) const {
+    return pIndex < BUCKET_COUNT ? mBuckets[pIndex].load(std::memory_order_relaxed) : 0;
+}
+
+std::chrono::nanoseconds LatencyHistogram::getBucketLowerBound(size_t pIndex) {
+    if (pIndex < SUB_BUCKET_COUNT) {
+        return std::chrono::nanoseconds(pIndex);
+    }
+    const unsigned int shift = static_cast<unsigned int>(pIndex / SUB_BUCKET_COUNT) - 1;
+    const uint64_t sub_bucket = pIndex % SUB_BUCKET_COUNT;
+    return std::chrono::nanoseconds((SUB_BUCKET_COUNT + sub_bucket) << shift);
+}
+
+std::chrono::nanoseconds LatencyHistogram::getBucketUpperBound(size_t pIndex) {
+    if (pIndex < SUB_BUCKET_COUNT) {
+        return std::chrono::nanoseconds(pIndex);
+    }
+    const unsigned int shift = static_cast<unsigned int>(pIndex / SUB_BUCKET_COUNT) - 1;
+    return getBucketLowerBound(pIndex) + std::chrono::nanoseconds((static_cast<uint64_t>(1) << shift) - 1);
+}
+
+size_t LatencyHistogram::getBucketIndex(std::chrono::nanoseconds pDuration) {
+    if (pDuration.count() < static_cast<std::chrono::nanoseconds::rep>(SUB_BUCKET_COUNT)) {
+        return static_cast<size_t>((std::max)(pDuration.count(), static_cast<std::chrono::nanoseconds::rep>(0)));
+    }
+    const uint64_t value = (std::min)(static_cast<uint64_t>(pDuration.count()), MAX_RECORDED_VALUE);
+    // The highest bit selects the power of two, the next 3 bits the sub-bucket
+    const unsigned int shift = getHighestBit(value) - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKET_COUNT + ((value >> shift) & (SUB_BUCKET_COUNT - 1));
+}
+
+void LatencyHistogram::reset() {
+    for (auto &bucket : mBuckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    mCount.store(0, std::memory_order_relaxed);
+    mTotal.store(0, std::memory_order_relaxed);
+    mMax.store(0, std::memory_order_relaxed);
+}
+
+void SendStatistics::onPhaseCompleted(const PhaseMeasurement &pMeasurement) {
+    const auto index = static_cast<size_t>(pMeasurement.Phase);
+    if (index >= SESSION_PHASE_COUNT) {
+        return;
+    }
+    mPhaseLatencies[index].record(pMeasurement.Duration);
+    mBytesWritten.fetch_add(pMeasurement.Io.BytesWritten, std::memory_order_relaxed);
+    mBytesRead.fetch_add(pMeasurement.Io.BytesRead, std::memory_order_relaxed);
+    // The phases return 0 or a positive SMTP code below 400 when they succeed
+    const bool failed = pMeasurement.ReturnCode < 0 || pMeasurement.ReturnCode >= 400;
+    switch (pMeasurement.Phase) {
+        case SessionPhase::Envelope:
+        case SessionPhase::Headers:
+            // A transaction stops at its first failed phase
+            if (failed) {
+                mFailedMessageCount.fetch_add(1, std::memory_order_relaxed);
+            }
+            break;
+        case SessionPhase::Body:
+            (failed ? mFailedMessageCount : mMessageCount).fetch_add(1, std::memory_order_relaxed);
+            break;
+        default:
+            break;
+    }
+}
+
+void SendStatistics::onSessionOpened(bool pReconnection) {
+    mSessionCount.fetch_add(1, std::memory_order_relaxed);
+    if (pReconnection) {
+        mReconnectionCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SendStatistics::onTlsHandshakeCompleted(bool pResumed) {
+    mTlsHandshakeCount.fetch_add(1, std::memory_order_relaxed);
+    if (pResumed) {
+        mResumedTlsHandshakeCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SendStatistics::onReplyReceived(int pReplyCode) {
+    if (pReplyCode >= MIN_REPLY_CODE && pReplyCode <= MAX_REPLY_CODE) {
+        mReplyCounts[static_cast<size_t>(pReplyCode - MIN_REPLY_CODE)].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+uint64_t SendStatistics::getMessageCount() const {
+    return mMessageCount.load(std::memory_order_relaxed);
+}
+
+uint64_t SendStatistics::getFailedMessageCount() const {
+    return mFailedMessageCount.load(std::memory_order_relaxed);
+}
+
+uint64_t SendStatistics::getBytesWritten() const {
+    return mBytesWritten.load(std::memory_order_relaxed);
+}
+
+uint64_t SendStatistics::getBytesRead() const {
+    return mBytesRead.load(std::memory_order_relaxed);
+}
+
+uint64_t SendStatistics::getSessionCount() const {
+    return mSessionCount.load(std::memory_order_relaxed);
+}
+
+uint64_t SendStatistics::getReconnectionCount() const {
+    return mReconnectionCount.load(std::memory_order_relaxed);
+}
+
+uint64_t SendStatistics::getTlsHandshakeCount() const {
+    return mTlsHandshakeCount.load(std::memory_order_relaxed);
+}
+
+uint64_t SendStatistics::getResumedTlsHandshakeCount() const {
+    return mResumedTlsHandshakeCount.load(std::memory_order_relaxed);
+}
+
+uint64_t SendStatistics::getReplyCount(int pReplyCode) const {
+    if (pReplyCode < MIN_REPLY_CODE || pReplyCode > MAX_REPLY_CODE) {
+        return 0;
+    }
+    return mReplyCounts[static_cast<size_t>(pReplyCode - MIN_REPLY_CODE)].load(std::memory_order_relaxed);
+}
+
+uint64_t SendStatistics::getReplyClassCount(int pReplyClass) const {
+    uint64_t count = 0;
+    for (int code = pReplyClass * 100; code < pReplyClass * 100 + 100; code++) {
+        count += getReplyCount(code);
+    }
+    return count;
+}
+
+const LatencyHistogram &SendStatistics::getPhaseLatency(SessionPhase pPhase) const {
+    const auto index = static_cast<size_t>(pPhase);
+    return mPhaseLatencies[index < SESSION_PHASE_COUNT ? index : 0];
+}
+
+void SendStatistics::reset() {
+    for (auto *counter : { &mMessageCount, &mFailedMessageCount, &mBytesWritten, &mBytesRead,
+            &mSessionCount, &mReconnectionCount, &mTlsHandshakeCount, &mResumedTlsHandshakeCount }) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+    for (auto &count : mReplyCounts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    for (auto &latency : mPhaseLatencies) {
+        latency.reset();
+    }
+}
@@ -0,0 +1,158 @@
+#ifndef SENDSTATISTICS_H
+#define SENDSTATISTICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "sessionobserver.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define SENDSTATISTICS_API __declspec(dllexport)
+    #else
+        #define SENDSTATISTICS_API __declspec(dllimport)
+    #endif
+#else
+    #define SENDSTATISTICS_API
+#endif
+
+namespace jed_utils {
+/** @brief The LatencyHistogram class counts durations in logarithmic
+ *  buckets split in 8 linear sub-buckets, so that a percentile is known
+ *  within 12.5% from a nanosecond to an hour in a fixed memory. It is
+ *  lock-free: the durations are recorded with atomic increments.
+ */
+class SENDSTATISTICS_API LatencyHistogram {
+ public:
+    /** The number of buckets. */
+    static const size_t BUCKET_COUNT = 320;
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram& other) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram& other) = delete;
+
+    /** Count a duration. The negative durations are counted as 0 and the
+     *  durations above the range in the last bucket. */
+    void record(std::chrono::nanoseconds pDuration);
+
+    /** Return the number of durations counted. */
+    uint64_t getCount() const;
+
+    /** Return the sum of the durations counted. */
+    std::chrono::nanoseconds getTotal() const;
+
+    /** Return the longest duration counted. */
+    std::chrono::nanoseconds getMax() const;
+
+    /**
+     *  @brief  Return the duration below which a percentage of the
+     *  durations are, rounded up to the upper bound of its bucket.
+     *  @param pPercentile The percentage, from 0 to 100. Example: 99.9
+     *  @return The duration or 0 if nothing has been counted.
+     */
+    std::chrono::nanoseconds getValueAtPercentile(double pPercentile) const;
+
+    /** Return the number of durations counted in a bucket. */
+    uint64_t getBucketCount(size_t pIndex) const;
+
+    /** Return the shortest and the longest duration counted in a bucket. */
+    static std::chrono::nanoseconds getBucketLowerBound(size_t pIndex);
+    static std::chrono::nanoseconds getBucketUpperBound(size_t pIndex);
+
+    /** Return the index of the bucket of a duration. */
+    static size_t getBucketIndex(std::chrono::nanoseconds pDuration);
+
+    /** Discard the durations counted. */
+    void reset();
+
+ private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> mBuckets {};
+    std::atomic<uint64_t> mCount { 0 };
+    std::atomic<uint64_t> mTotal { 0 };
+    std::atomic<uint64_t> mMax { 0 };
+};
+
+/** @brief The SendStatistics observer counts the activity of the clients it
+ *  is set on: messages, bytes, sessions, TLS handshakes, the replies of the
+ *  servers per code and the duration of each phase. It is lock-free, so it
+ *  can be shared by all the clients of a process or by the sessions of an
+ *  SmtpConnectionPool, and read at any time by another thread.
+ *
+ *  Unlike the communication log, its memory does not grow with the number
+ *  of messages sent.
+ */
+class SENDSTATISTICS_API SendStatistics : public SessionObserver {
+ public:
+    /** The reply codes counted individually, from 100 to 599. */
+    static const int MIN_REPLY_CODE = 100;
+    static const int MAX_REPLY_CODE = 599;
+
+    SendStatistics() = default;
+    SendStatistics(const SendStatistics& other) = delete;
+    SendStatistics& operator=(const SendStatistics& other) = delete;
+
+    void onPhaseCompleted(const PhaseMeasurement &pMeasurement) override;
+    void onSessionOpened(bool pReconnection) override;
+    void onTlsHandshakeCompleted(bool pResumed) override;
+    void onReplyReceived(int pReplyCode) override;
+
+    /** Return the number of messages accepted by the servers. */
+    uint64_t getMessageCount() const;
+
+    /** Return the number of mail transactions that failed in the envelope,
+     *  the headers or the body. */
+    uint64_t getFailedMessageCount() const;
+
+    /** Return the number of bytes of SMTP data sent, before encryption. */
+    uint64_t getBytesWritten() const;
+
+    /** Return the number of bytes of SMTP data received, after decryption. */
+    uint64_t getBytesRead() const;
+
+    /** Return the number of sessions opened. */
+    uint64_t getSessionCount() const;
+
+    /** Return the number of sessions opened by a client that had already
+     *  opened one, for instance after the server has dropped it. */
+    uint64_t getReconnectionCount() const;
+
+    /** Return the number of TLS handshakes completed. */
+    uint64_t getTlsHandshakeCount() const;
+
+    /** Return the number of TLS handshakes that resumed a cached session. */
+    uint64_t getResumedTlsHandshakeCount() const;
+
+    /** Return the number of replies received with a code, or 0 if the code
+     *  is not between MIN_REPLY_CODE and MAX_REPLY_CODE. */
+    uint64_t getReplyCount(int pReplyCode) const;
+
+    /** Return the number of replies received with a code of a class.
+     *  Example: 4 for the transient failures. */
+    uint64_t getReplyClassCount(int pReplyClass) const;
+
+    /** Return the durations of a phase. */
+    const LatencyHistogram &getPhaseLatency(SessionPhase pPhase) const;
+
+    /** Discard all the counters and durations. */
+    void reset();
+
+ private:
+    static const size_t REPLY_CODE_COUNT = MAX_REPLY_CODE - MIN_REPLY_CODE + 1;
+
+    std::atomic<uint64_t> mMessageCount { 0 };
+    std::atomic<uint64_t> mFailedMessageCount { 0 };
+    std::atomic<uint64_t> mBytesWritten { 0 };
+    std::atomic<uint64_t> mBytesRead { 0 };
+    std::atomic<uint64_t> mSessionCount { 0 };
+    std::atomic<uint64_t> mReconnectionCount { 0 };
+    std::atomic<uint64_t> mTlsHandshakeCount { 0 };
+    std::atomic<uint64_t> mResumedTlsHandshakeCount { 0 };
+    std::array<std::atomic<uint64_t>, REPLY_CODE_COUNT> mReplyCounts {};
+    std::array<LatencyHistogram, SESSION_PHASE_COUNT> mPhaseLatencies;
+};
+}  // namespace jed_utils
+
+#endif
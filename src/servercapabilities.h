@@ -0,0 +1,36 @@
+#ifndef SERVERCAPABILITIES_H
+#define SERVERCAPABILITIES_H
+
+#include <cstddef>
+#include "serverauthoptions.h"
+
+namespace jed_utils {
+/** @brief The ServerCapabilities struct contains the ESMTP extensions
+ *  advertised by the server in its EHLO response.
+ */
+struct ServerCapabilities {
+    bool Pipelining = false;
+    bool StartTLS = false;
+    // BDAT command (RFC 3030)
+    bool Chunking = false;
+    // Binary content sent with BDAT (RFC 3030)
+    bool BinaryMime = false;
+    // 8-bit content (RFC 6152)
+    bool EightBitMime = false;
+    // Internationalized addresses and headers (RFC 6531)
+    bool SmtpUtf8 = false;
+    // Enhanced status codes in the replies (RFC 2034)
+    bool EnhancedStatusCodes = false;
+    // Delivery status notifications (RFC 3461)
+    bool Dsn = false;
+    // Declared message size (RFC 1870)
+    bool Size = false;
+    // Maximum message size in bytes, 0 when the server does not fix one
+    size_t MaxMessageSize = 0;
+    // AUTH command (RFC 4954) and the mechanisms it accepts
+    bool Auth = false;
+    ServerAuthOptions AuthOptions;
+};
+}  // namespace jed_utils
+
+#endif
@@ -0,0 +1,130 @@
+#include "serverreplyreader.h"
+#include <algorithm>
+#include <cctype>
+
+using namespace jed_utils;
+
+void ServerReplyReader::append(const char *pData, size_t pLength) {
+    if (pData == nullptr || pLength == 0) {
+        return;
+    }
+    mBuffer.append(pData, pLength);
+}
+
+bool ServerReplyReader::nextReply() {
+    releaseCurrentReply();
+    const size_t STATUS_CODE_LENGTH { 3 };
+    size_t line_start { mScanOffset };
+    size_t line_end { 0 };
+    while ((line_end = mBuffer.find('\n', line_start)) != std::string::npos) {
+        size_t text_end { line_end };
+        if (text_end > line_start && mBuffer[text_end - 1] == '\r') {
+            text_end--;
+        }
+        size_t line_length { text_end - line_start };
+        // The lines of a multi-line reply have a dash after the status code
+        bool is_last_line { line_length <= STATUS_CODE_LENGTH || mBuffer[line_start + STATUS_CODE_LENGTH] != '-' };
+        size_t text_offset { line_start + (std::min)(line_length, STATUS_CODE_LENGTH + 1) };
+        mLines.emplace_back(text_offset, text_end - text_offset);
+        size_t last_line_start { line_start };
+        line_start = line_end + 1;
+        mScanOffset = line_start;
+        if (is_last_line) {
+            mReplyAvailable = true;
+            mReplyLength = line_start;
+            mTextLength = text_end;
+            mCode = -1;
+            if (line_length >= STATUS_CODE_LENGTH &&
+                    std::all_of(mBuffer.begin() + static_cast<std::ptrdiff_t>(last_line_start),
+                        mBuffer.begin() + static_cast<std::ptrdiff_t>(last_line_start + STATUS_CODE_LENGTH),
+                        [](unsigned char c) { return std::isdigit(c) != 0; })) {
+                mCode = (mBuffer[last_line_start] - '0') * 100
+                    + (mBuffer[last_line_start + 1] - '0') * 10
+                    + (mBuffer[last_line_start + 2] - '0');
+            }
+            // Enhanced status code : class.subject.detail where the class
+            // is the first digit of the status code
+            std::string_view first_line { getLine(0) };
+            size_t index { 0 };
+            int dots { 0 };
+            bool digit_expected { true };
+            while (index < first_line.length() && first_line[index] != ' ') {
+                char c { first_line[index] };
+                if (std::isdigit(static_cast<unsigned char>(c)) != 0) {
+                    digit_expected = false;
+                } else if (c == '.' && !digit_expected) {
+                    dots++;
+                    digit_expected = true;
+                } else {
+                    break;
+                }
+                index++;
+            }
+            bool is_terminated { index == first_line.length() || first_line[index] == ' ' };
+            if (mCode > 0 && is_terminated && dots == 2 && !digit_expected && first_line[0] - '0' == mCode / 100) {
+                mEnhancedStatusCode = std::make_pair(mLines[0].first, index);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ServerReplyReader::hasPendingData() const {
+    return mBuffer.length() > (mReplyAvailable ? mReplyLength : 0);
+}
+
+void ServerReplyReader::clear() {
+    mBuffer.clear();
+    mScanOffset = 0;
+    mReplyLength = 0;
+    mTextLength = 0;
+    mReplyAvailable = false;
+    mCode = -1;
+    mEnhancedStatusCode = std::make_pair(0, 0);
+    mLines.clear();
+}
+
+int ServerReplyReader::getCode() const {
+    return mReplyAvailable ? mCode : -1;
+}
+
+std::string_view ServerReplyReader::getEnhancedStatusCode() const {
+    if (!mReplyAvailable) {
+        return std::string_view();
+    }
+    return std::string_view(mBuffer.data() + mEnhancedStatusCode.first, mEnhancedStatusCode.second);
+}
+
+size_t ServerReplyReader::getLineCount() const {
+    return mReplyAvailable ? mLines.size() : 0;
+}
+
+std::string_view ServerReplyReader::getLine(size_t pIndex) const {
+    if (pIndex >= mLines.size()) {
+        return std::string_view();
+    }
+    return std::string_view(mBuffer.data() + mLines[pIndex].first, mLines[pIndex].second);
+}
+
+std::string_view ServerReplyReader::getText() const {
+    if (!mReplyAvailable) {
+        return std::string_view();
+    }
+    return std::string_view(mBuffer.data(), mTextLength);
+}
+
+void ServerReplyReader::releaseCurrentReply() {
+    if (!mReplyAvailable) {
+        return;
+    }
+    // Erasing moves the remaining data without releasing the capacity
+    mBuffer.erase(0, mReplyLength);
+    mScanOffset -= mReplyLength;
+    mReplyLength = 0;
+    mTextLength = 0;
+    mReplyAvailable = false;
+    mCode = -1;
+    mEnhancedStatusCode = std::make_pair(0, 0);
+    mLines.clear();
+}
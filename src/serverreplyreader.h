@@ -0,0 +1,93 @@
+#ifndef SERVERREPLYREADER_H
+#define SERVERREPLYREADER_H
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define SERVERREPLYREADER_API __declspec(dllexport)
+    #else
+        #define SERVERREPLYREADER_API __declspec(dllimport)
+    #endif
+#else
+    #define SERVERREPLYREADER_API
+#endif
+
+namespace jed_utils {
+/** @brief The ServerReplyReader accumulates the data received from the
+ *  server and splits it into complete replies. A reply ends with the first
+ *  line that has no dash after its status code (RFC 5321 section 4.2).
+ *
+ *  The buffers are kept between replies so that reading a reply does not
+ *  allocate once their capacity has grown to the size of the replies.
+ *  The views returned remain valid until the next call to append, nextReply
+ *  or clear.
+ */
+class SERVERREPLYREADER_API ServerReplyReader {
+ public:
+    /** Construct a new empty ServerReplyReader. */
+    ServerReplyReader() = default;
+
+    /**
+     *  @brief  Append data received from the server.
+     *  @param pData The received bytes.
+     *  @param pLength The number of bytes received.
+     */
+    void append(const char *pData, size_t pLength);
+
+    /**
+     *  @brief  Release the current reply and extract the next one.
+     *  @return True if a complete reply is available, false if more data
+     *  must be received first.
+     */
+    bool nextReply();
+
+    /** Indicate if data not yet consumed by a reply is buffered. */
+    bool hasPendingData() const;
+
+    /** Discard the current reply and all the buffered data. */
+    void clear();
+
+    /** Return the status code of the current reply or -1 if none is available. */
+    int getCode() const;
+
+    /**
+     *  @brief  Return the enhanced status code of the current reply (RFC 3463).
+     *  Example: 2.1.5
+     *  @return The enhanced status code or an empty string if the server
+     *  did not provide it.
+     */
+    std::string_view getEnhancedStatusCode() const;
+
+    /** Return the number of lines of the current reply. */
+    size_t getLineCount() const;
+
+    /**
+     *  @brief  Return the text of a line of the current reply, without its
+     *  status code, its separator and its line ending.
+     *  @param pIndex The index of the line.
+     */
+    std::string_view getLine(size_t pIndex) const;
+
+    /** Return the whole current reply without its final line ending. */
+    std::string_view getText() const;
+
+ private:
+    void releaseCurrentReply();
+
+    std::string mBuffer;
+    size_t mScanOffset = 0;
+    size_t mReplyLength = 0;
+    size_t mTextLength = 0;
+    bool mReplyAvailable = false;
+    int mCode = -1;
+    std::pair<size_t, size_t> mEnhancedStatusCode { 0, 0 };
+    std::vector<std::pair<size_t, size_t>> mLines;
+};
+}  // namespace jed_utils
+
+#endif
@@ -0,0 +1,61 @@
+#include "sessionobserver.h"
+#include <algorithm>
+
+using namespace jed_utils;
+
+const char *SessionObserver::getPhaseName(SessionPhase pPhase) {
+    switch (pPhase) {
+        case SessionPhase::Connection:
+            return "connection";
+        case SessionPhase::Greeting:
+            return "greeting";
+        case SessionPhase::Identification:
+            return "identification";
+        case SessionPhase::StartTLS:
+            return "starttls";
+        case SessionPhase::Authentication:
+            return "authentication";
+        case SessionPhase::Envelope:
+            return "envelope";
+        case SessionPhase::Headers:
+            return "headers";
+        case SessionPhase::Body:
+            return "body";
+    }
+    return "";
+}
+
+void SessionMetrics::onPhaseCompleted(const PhaseMeasurement &pMeasurement) {
+    const auto index = static_cast<size_t>(pMeasurement.Phase);
+    if (index >= SESSION_PHASE_COUNT) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    PhaseStatistics &statistics = mStatistics[index];
+    statistics.Count++;
+    // The phases return 0 or a positive SMTP code below 400 when they succeed
+    if (pMeasurement.ReturnCode < 0 || pMeasurement.ReturnCode >= 400) {
+        statistics.ErrorCount++;
+    }
+    statistics.TotalDuration += pMeasurement.Duration;
+    statistics.MaxDuration = (std::max)(statistics.MaxDuration, pMeasurement.Duration);
+    statistics.Io.BytesWritten += pMeasurement.Io.BytesWritten;
+    statistics.Io.BytesRead += pMeasurement.Io.BytesRead;
+    statistics.Io.WriteCalls += pMeasurement.Io.WriteCalls;
+    statistics.Io.ReadCalls += pMeasurement.Io.ReadCalls;
+    statistics.Io.WaitCalls += pMeasurement.Io.WaitCalls;
+}
+
+PhaseStatistics SessionMetrics::getPhaseStatistics(SessionPhase pPhase) const {
+    const auto index = static_cast<size_t>(pPhase);
+    if (index >= SESSION_PHASE_COUNT) {
+        return {};
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStatistics[index];
+}
+
+void SessionMetrics::reset() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStatistics.fill(PhaseStatistics());
+}
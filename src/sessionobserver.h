@@ -0,0 +1,130 @@
+#ifndef SESSIONOBSERVER_H
+#define SESSIONOBSERVER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define SESSIONOBSERVER_API __declspec(dllexport)
+    #else
+        #define SESSIONOBSERVER_API __declspec(dllimport)
+    #endif
+#else
+    #define SESSIONOBSERVER_API
+#endif
+
+namespace jed_utils {
+/** @brief The phases of an SMTP session measured by a SessionObserver. */
+enum class SessionPhase {
+    // Name resolution and connection of the socket
+    Connection = 0,
+    // Greeting of the server
+    Greeting,
+    // EHLO command, sent again after STARTTLS
+    Identification,
+    // STARTTLS command and TLS handshake
+    StartTLS,
+    // AUTH command
+    Authentication,
+    // MAIL FROM and RCPT TO commands
+    Envelope,
+    // DATA command and header lines, which are written with the body
+    Headers,
+    // Body and attachments, with the headers when the content is sent with BDAT
+    Body
+};
+
+/** The number of values of SessionPhase. */
+const size_t SESSION_PHASE_COUNT = 8;
+
+/** @brief The IoCounters struct counts the data exchanged with the server
+ *  and the calls made to the socket, or to the TLS layer on a secure
+ *  connection. The bytes are those of the SMTP data, before encryption.
+ */
+struct IoCounters {
+    uint64_t BytesWritten = 0;
+    uint64_t BytesRead = 0;
+    uint64_t WriteCalls = 0;
+    uint64_t ReadCalls = 0;
+    // Waits for the data of the server (poll)
+    uint64_t WaitCalls = 0;
+};
+
+/** @brief The PhaseMeasurement struct describes a completed phase of a
+ *  session. The duration is measured with a monotonic clock.
+ */
+struct PhaseMeasurement {
+    SessionPhase Phase = SessionPhase::Connection;
+    std::chrono::nanoseconds Duration { 0 };
+    // Return code of the phase, as returned by sendMail
+    int ReturnCode = 0;
+    // Data exchanged during the phase
+    IoCounters Io;
+};
+
+/** @brief The SessionObserver interface receives the measurement of each
+ *  phase of the sessions of the clients it is set on with
+ *  setSessionObserver. Nothing is measured when no observer is set.
+ *
+ *  The callbacks are called by the thread that sends the message. An
+ *  observer shared by clients used in several threads must be thread-safe.
+ */
+class SESSIONOBSERVER_API SessionObserver {
+ public:
+    virtual ~SessionObserver() = default;
+
+    /** Called when a phase is completed, whether it succeeded or not. */
+    virtual void onPhaseCompleted(const PhaseMeasurement &pMeasurement) = 0;
+
+    /** Called when a session is opened. pReconnection is true when the
+     *  client had already opened a session before. */
+    virtual void onSessionOpened(bool pReconnection) { (void)pReconnection; }
+
+    /** Called when a TLS handshake is completed. pResumed is true when the
+     *  handshake has resumed a cached session. */
+    virtual void onTlsHandshakeCompleted(bool pResumed) { (void)pResumed; }
+
+    /** Called for each reply of the server, with its SMTP code. */
+    virtual void onReplyReceived(int pReplyCode) { (void)pReplyCode; }
+
+    /** Return the name of a phase in lowercase, for instance to use it as
+     *  the label of a metric. Example: connection, starttls */
+    static const char *getPhaseName(SessionPhase pPhase);
+};
+
+/** @brief The PhaseStatistics struct aggregates the measurements of a phase. */
+struct PhaseStatistics {
+    uint64_t Count = 0;
+    // Measurements whose return code reports a failure
+    uint64_t ErrorCount = 0;
+    std::chrono::nanoseconds TotalDuration { 0 };
+    std::chrono::nanoseconds MaxDuration { 0 };
+    IoCounters Io;
+};
+
+/** @brief The SessionMetrics observer aggregates the measurements of each
+ *  phase, as counters and sums that can be exported as they are to a
+ *  metrics system. It is thread-safe.
+ */
+class SESSIONOBSERVER_API SessionMetrics : public SessionObserver {
+ public:
+    void onPhaseCompleted(const PhaseMeasurement &pMeasurement) override;
+
+    /** Return the statistics of a phase. */
+    PhaseStatistics getPhaseStatistics(SessionPhase pPhase) const;
+
+    /** Discard the statistics of all the phases. */
+    void reset();
+
+ private:
+    mutable std::mutex mMutex;
+    std::array<PhaseStatistics, SESSION_PHASE_COUNT> mStatistics {};
+};
+}  // namespace jed_utils
+
+#endif
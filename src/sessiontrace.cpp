@@ -0,0 +1,161 @@
+#include "sessiontrace.h"
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+using namespace jed_utils;
+
+namespace {
+const size_t MAX_VERB_LENGTH = 8;
+
+// The first word of the command, after the line break of the end of data
+uint64_t packVerb(std::string_view pCommand) {
+    const size_t start = pCommand.find_first_not_of("\r\n");
+    if (start == std::string_view::npos) {
+        return 0;
+    }
+    uint64_t verb = 0;
+    for (size_t index = 0; index < MAX_VERB_LENGTH && start + index < pCommand.size(); index++) {
+        const char character = pCommand[start + index];
+        if (character == ' ' || character == ':' || character == '\r' || character == '\n') {
+            break;
+        }
+        verb |= static_cast<uint64_t>(static_cast<unsigned char>(character)) << (8 * index);
+    }
+    return verb;
+}
+
+std::string unpackVerb(uint64_t pVerb) {
+    std::string verb;
+    for (; pVerb != 0; pVerb >>= 8) {
+        verb += static_cast<char>(pVerb & 0xFF);
+    }
+    return verb;
+}
+
+uint64_t packHeader(TraceEventType pType, SessionPhase pPhase, int pCode) {
+    return static_cast<uint64_t>(pType) |
+        (static_cast<uint64_t>(pPhase) << 8) |
+        (static_cast<uint64_t>(static_cast<uint32_t>(pCode)) << 32);
+}
+
+double toMilliseconds(std::chrono::nanoseconds pDuration) {
+    return std::chrono::duration<double, std::milli>(pDuration).count();
+}
+}  // namespace
+
+SessionTrace::SessionTrace(size_t pCapacity)
+    : mCapacity(pCapacity),
+      mSlots(nullptr) {
+    if (pCapacity == 0) {
+        throw std::invalid_argument("The capacity of the trace must be at least 1");
+    }
+    mSlots.reset(new Slot[pCapacity]);
+}
+
+size_t SessionTrace::getCapacity() const {
+    return mCapacity;
+}
+
+uint64_t SessionTrace::getRecordedCount() const {
+    return mRecordedCount.load(std::memory_order_acquire);
+}
+
+void SessionTrace::recordSessionOpened() {
+    record(TraceEventType::SessionOpened, SessionPhase::Connection, 0, std::chrono::nanoseconds(0), 0);
+}
+
+void SessionTrace::recordCommand(std::string_view pCommand) {
+    record(TraceEventType::Command, SessionPhase::Connection, 0, std::chrono::nanoseconds(0), packVerb(pCommand));
+}
+
+void SessionTrace::recordReply(int pReplyCode) {
+    record(TraceEventType::Reply, SessionPhase::Connection, pReplyCode, std::chrono::nanoseconds(0), 0);
+}
+
+void SessionTrace::recordTlsHandshake(bool pResumed) {
+    record(TraceEventType::TlsHandshake, SessionPhase::StartTLS, pResumed ? 1 : 0, std::chrono::nanoseconds(0), 0);
+}
+
+void SessionTrace::recordPhase(SessionPhase pPhase, int pReturnCode, std::chrono::nanoseconds pDuration) {
+    record(TraceEventType::PhaseCompleted, pPhase, pReturnCode, pDuration, 0);
+}
+
+void SessionTrace::record(TraceEventType pType,
+        SessionPhase pPhase,
+        int pCode,
+        std::chrono::nanoseconds pDuration,
+        uint64_t pVerb) {
+    // A sequence lock per slot: the readers check that the sequence has
+    // not changed while they were copying the event
+    const uint64_t index = mRecordedCount.load(std::memory_order_relaxed);
+    Slot &slot = mSlots[index % mCapacity];
+    slot.Sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.Time.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    slot.Header.store(packHeader(pType, pPhase, pCode), std::memory_order_relaxed);
+    slot.Duration.store(pDuration.count(), std::memory_order_relaxed);
+    slot.Verb.store(pVerb, std::memory_order_relaxed);
+    slot.Sequence.store(2 * index + 2, std::memory_order_release);
+    mRecordedCount.store(index + 1, std::memory_order_release);
+}
+
+std::vector<TraceEvent> SessionTrace::getEvents() const {
+    const uint64_t count = mRecordedCount.load(std::memory_order_acquire);
+    const uint64_t first = count > mCapacity ? count - mCapacity : 0;
+    std::vector<TraceEvent> events;
+    events.reserve(count - first);
+    for (uint64_t index = first; index < count; index++) {
+        const Slot &slot = mSlots[index % mCapacity];
+        const uint64_t sequence = slot.Sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * index + 2) {
+            continue;
+        }
+        const int64_t time = slot.Time.load(std::memory_order_relaxed);
+        const uint64_t header = slot.Header.load(std::memory_order_relaxed);
+        const int64_t duration = slot.Duration.load(std::memory_order_relaxed);
+        const uint64_t verb = slot.Verb.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.Sequence.load(std::memory_order_relaxed) != sequence) {
+            continue;
+        }
+        TraceEvent event;
+        event.Time = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(time));
+        event.Type = static_cast<TraceEventType>(header & 0xFF);
+        event.Phase = static_cast<SessionPhase>((header >> 8) & 0xFF);
+        event.Code = static_cast<int>(static_cast<uint32_t>(header >> 32));
+        event.Duration = std::chrono::nanoseconds(duration);
+        event.Verb = unpackVerb(verb);
+        events.push_back(std::move(event));
+    }
+    return events;
+}
+
+std::string SessionTrace::dump() const {
+    const std::vector<TraceEvent> events = getEvents();
+    std::ostringstream output;
+    output << std::fixed << std::setprecision(3);
+    for (const TraceEvent &event : events) {
+        output << "+" << toMilliseconds(event.Time - events.front().Time) << " ms ";
+        switch (event.Type) {
+            case TraceEventType::SessionOpened:
+                output << "session opened";
+                break;
+            case TraceEventType::Command:
+                output << "c " << event.Verb;
+                break;
+            case TraceEventType::Reply:
+                output << "s " << event.Code;
+                break;
+            case TraceEventType::TlsHandshake:
+                output << (event.Code != 0 ? "tls resumed" : "tls handshake");
+                break;
+            case TraceEventType::PhaseCompleted:
+                output << SessionObserver::getPhaseName(event.Phase) << " " << event.Code
+                    << " (" << toMilliseconds(event.Duration) << " ms)";
+                break;
+        }
+        output << "\n";
+    }
+    return output.str();
+}
@@ -0,0 +1,113 @@
+#ifndef SESSIONTRACE_H
+#define SESSIONTRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "sessionobserver.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define SESSIONTRACE_API __declspec(dllexport)
+    #else
+        #define SESSIONTRACE_API __declspec(dllimport)
+    #endif
+#else
+    #define SESSIONTRACE_API
+#endif
+
+namespace jed_utils {
+/** @brief The types of the events of a SessionTrace. */
+enum class TraceEventType {
+    // The session is opened, after the identification
+    SessionOpened = 0,
+    // A command is sent, its verb is kept
+    Command,
+    // A reply of the server is received, its code is kept
+    Reply,
+    // A TLS handshake is completed, the code is 1 if it resumed a session
+    TlsHandshake,
+    // A phase is completed, with its return code and its duration
+    PhaseCompleted
+};
+
+/** @brief The TraceEvent struct describes an event of a SessionTrace. */
+struct TraceEvent {
+    std::chrono::steady_clock::time_point Time;
+    TraceEventType Type = TraceEventType::SessionOpened;
+    // The first word of a command, 8 characters at most. Example: MAIL
+    std::string Verb;
+    // The code of a reply, the return code of a phase
+    int Code = 0;
+    SessionPhase Phase = SessionPhase::Connection;
+    std::chrono::nanoseconds Duration { 0 };
+};
+
+/** @brief The SessionTrace class keeps the last protocol events of the
+ *  sessions of a client in a ring of fixed capacity, without the content
+ *  of the commands, so that the steps that led to an error can be dumped
+ *  when sendMail fails.
+ *
+ *  The events are recorded by the thread that uses the client, without
+ *  lock nor allocation, and can be read by any thread at the same time:
+ *  an event overwritten while it is read is skipped.
+ */
+class SESSIONTRACE_API SessionTrace {
+ public:
+    /**
+     *  @brief  Construct a new SessionTrace.
+     *  @param pCapacity The number of events kept.
+     *  @exception std::invalid_argument pCapacity is 0.
+     */
+    explicit SessionTrace(size_t pCapacity);
+
+    SessionTrace(const SessionTrace& other) = delete;
+    SessionTrace& operator=(const SessionTrace& other) = delete;
+
+    /** Return the number of events kept. */
+    size_t getCapacity() const;
+
+    /** Return the number of events recorded since the construction,
+     *  including those that have been overwritten. */
+    uint64_t getRecordedCount() const;
+
+    /** The recording functions must be called by a single thread at a time. */
+    void recordSessionOpened();
+    void recordCommand(std::string_view pCommand);
+    void recordReply(int pReplyCode);
+    void recordTlsHandshake(bool pResumed);
+    void recordPhase(SessionPhase pPhase, int pReturnCode, std::chrono::nanoseconds pDuration);
+
+    /** Return the events kept, the oldest first. */
+    std::vector<TraceEvent> getEvents() const;
+
+    /** Return the events kept as text, one line per event with its time
+     *  relative to the oldest one. Example: +1.250 ms c MAIL */
+    std::string dump() const;
+
+ private:
+    struct Slot {
+        // 2 * (index + 1) once the event of an index is written, odd while it is written
+        std::atomic<uint64_t> Sequence { 0 };
+        std::atomic<int64_t> Time { 0 };
+        // Type, phase and code
+        std::atomic<uint64_t> Header { 0 };
+        std::atomic<int64_t> Duration { 0 };
+        std::atomic<uint64_t> Verb { 0 };
+    };
+
+    void record(TraceEventType pType, SessionPhase pPhase, int pCode, std::chrono::nanoseconds pDuration, uint64_t pVerb);
+
+    size_t mCapacity;
+    std::unique_ptr<Slot[]> mSlots;
+    std::atomic<uint64_t> mRecordedCount { 0 };
+};
+}  // namespace jed_utils
+
+#endif
@@ -45,16 +45,7 @@ SmtpClient& SmtpClient::operator=(SmtpClient &&other) noexcept {
 }
 
 void SmtpClient::cleanup() {
-    int socket { getSocketFileDescriptor() };
-    if (socket != 0) {
-#ifdef _WIN32
-        shutdown(socket, SD_BOTH);
-        closesocket(socket);
-#else
-        close(socket);
-#endif
-    }
-    clearSocketFileDescriptor();
+    closeSocket();
 #ifdef _WIN32
     if (isWSAStarted() && WSACleanup() != 0) {
         int wsa_retVal = WSAGetLastError();
@@ -68,17 +59,20 @@ void SmtpClient::cleanup() {
 }
 
 int SmtpClient::establishConnectionWithServer() {
-    int session_init_return_code = initializeSession();
+    beginPhase();
+    int session_init_return_code = endPhase(SessionPhase::Connection, initializeSession());
     if (session_init_return_code != 0) {
         return session_init_return_code;
     }
 
-    int server_greetings_return_code = checkServerGreetings();
+    beginPhase();
+    int server_greetings_return_code = endPhase(SessionPhase::Greeting, checkServerGreetings());
     if (server_greetings_return_code != STATUS_CODE_SERVICE_READY) {
         return server_greetings_return_code;
     }
 
-    int client_init_return_code = sendServerIdentification();
+    beginPhase();
+    int client_init_return_code = endPhase(SessionPhase::Identification, sendServerIdentification());
     if (client_init_return_code != STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED) {
         return client_init_return_code;
     }
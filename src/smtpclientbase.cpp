@@ -1,17 +1,27 @@
 #include "smtpclientbase.h"
 #include <algorithm>
 #include <cerrno>
+#include <chrono>
 #include <cstddef>
 #include <cstring>
+#include <ctime>
+#include <functional>
 #include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
+#include <vector>
+#include "attachmentprefetcher.h"
 #include "base64.h"
+#include "datanormalizer.h"
+#include "dnsresolver.h"
 #include "errorresolver.h"
 #include "message.h"
 #include "messageaddress.h"
+#include "mimewriter.h"
 #include "serverauthoptions.h"
 #include "smtpclienterrors.h"
 #include "smtpserverstatuscodes.h"
@@ -24,119 +34,198 @@
     typedef SSIZE_T ssize_t;
     #include <windows.h>
     #include <WinNT.h>
-    constexpr auto sleep = Sleep;
 #else
     #include <fcntl.h>
     #include <netdb.h>
     #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <poll.h>
     #include <sys/socket.h>
     #include <sys/types.h>
+    #include <sys/uio.h>
     #include <unistd.h>
 #endif
 
 using namespace std::literals::string_literals;
 using namespace jed_utils;
 
+// Avoid the SIGPIPE signal when the server has closed a persistent session
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+namespace {
+// A build without communication log (CMake option SMTPCLIENT_ENABLE_COMM_LOG)
+// removes the recording of the items, not only its runtime level check
+#ifdef SMTPCLIENT_NO_COMM_LOG
+constexpr bool COMMUNICATION_LOG_ENABLED = false;
+#else
+constexpr bool COMMUNICATION_LOG_ENABLED = true;
+#endif
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+#else
+using SocketHandle = int;
+#endif
+
+void setSocketOption(SocketHandle pSocket, int pLevel, int pName, int pValue) {
+#ifdef _WIN32
+    setsockopt(pSocket, pLevel, pName, reinterpret_cast<const char *>(&pValue), sizeof(pValue));
+#else
+    setsockopt(pSocket, pLevel, pName, &pValue, sizeof(pValue));
+#endif
+}
+
+int toSocketOptionValue(unsigned int pValue) {
+    return static_cast<int>((std::min)(pValue, static_cast<unsigned int>((std::numeric_limits<int>::max)())));
+}
+
+// Set on each socket before it connects
+void applySocketOptions(SocketHandle pSocket, const TransportOptions &pOptions) {
+    if (pOptions.NoDelay) {
+        setSocketOption(pSocket, IPPROTO_TCP, TCP_NODELAY, 1);
+    }
+    if (pOptions.SendBufferSize > 0) {
+        setSocketOption(pSocket, SOL_SOCKET, SO_SNDBUF, pOptions.SendBufferSize);
+    }
+    if (pOptions.ReceiveBufferSize > 0) {
+        setSocketOption(pSocket, SOL_SOCKET, SO_RCVBUF, pOptions.ReceiveBufferSize);
+    }
+    if (!pOptions.KeepAlive) {
+        return;
+    }
+    setSocketOption(pSocket, SOL_SOCKET, SO_KEEPALIVE, 1);
+    if (pOptions.KeepAliveIdleSeconds > 0) {
+#if defined(TCP_KEEPIDLE)
+        setSocketOption(pSocket, IPPROTO_TCP, TCP_KEEPIDLE, toSocketOptionValue(pOptions.KeepAliveIdleSeconds));
+#elif defined(TCP_KEEPALIVE)
+        // The idle time on macOS
+        setSocketOption(pSocket, IPPROTO_TCP, TCP_KEEPALIVE, toSocketOptionValue(pOptions.KeepAliveIdleSeconds));
+#endif
+    }
+#ifdef TCP_KEEPINTVL
+    if (pOptions.KeepAliveIntervalSeconds > 0) {
+        setSocketOption(pSocket, IPPROTO_TCP, TCP_KEEPINTVL, toSocketOptionValue(pOptions.KeepAliveIntervalSeconds));
+    }
+#endif
+#ifdef TCP_KEEPCNT
+    if (pOptions.KeepAliveProbeCount > 0) {
+        setSocketOption(pSocket, IPPROTO_TCP, TCP_KEEPCNT, toSocketOptionValue(pOptions.KeepAliveProbeCount));
+    }
+#endif
+}
+
+// Encode an ENVID value as xtext (RFC 3461 section 4)
+void appendXtext(std::string_view pValue, std::string &pOutput) {
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    for (const char character : pValue) {
+        const auto code = static_cast<unsigned char>(character);
+        if (code < 33 || code > 126 || character == '+' || character == '=') {
+            pOutput += '+';
+            pOutput += HEX_DIGITS[code >> 4];
+            pOutput += HEX_DIGITS[code & 0x0F];
+        } else {
+            pOutput += character;
+        }
+    }
+}
+
+// A copy of a client traces its own sessions
+std::shared_ptr<SessionTrace> createEmptyTraceCopy(const std::shared_ptr<SessionTrace> &pTrace) {
+    return pTrace != nullptr ? std::make_shared<SessionTrace>(pTrace->getCapacity()) : nullptr;
+}
+}  // namespace
+
 SMTPClientBase::SMTPClientBase(const char *pServerName, unsigned int pPort)
-    : mServerName(nullptr),
-      mPort(pPort),
-      mCommunicationLog(nullptr),
-      mLastServerResponse(nullptr),
-      mCommandTimeOut(5),
+    : mPort(pPort),
+      mCommandTimeOutInMilliseconds(5000),
       mLastSocketErrNo(0),
-      mAuthOptions(nullptr),
-      mCredential(nullptr),
       mKeepUsingBaseSendCommands(false),
       sendCommandPtr(&SMTPClientBase::sendCommand),
-      sendCommandWithFeedbackPtr(&SMTPClientBase::sendCommandWithFeedback) {
-    std::string servername_str { pServerName == nullptr ? "" : pServerName };
-    if (pServerName == nullptr || strcmp(pServerName, "") == 0  || StringUtils::trim(servername_str).empty()) {
-        throw std::invalid_argument("Server name cannot be null or empty");
-    }
-    size_t server_name_len = strlen(pServerName);
-    mServerName = new char[server_name_len + 1];
-    strncpy(mServerName, pServerName, server_name_len);
-    mServerName[server_name_len] = '\0';
+      sendCommandWithFeedbackPtr(&SMTPClientBase::sendCommandWithFeedback),
+      receiveDataPtr(&SMTPClientBase::receiveData),
+      sendDataSegmentsPtr(&SMTPClientBase::sendDataSegments) {
+    setServerName(pServerName);
 }
 
-SMTPClientBase::~SMTPClientBase() {
-    delete[] mServerName;
-    mServerName = nullptr;
-    delete[] mCommunicationLog;
-    mCommunicationLog = nullptr;
-    delete[] mLastServerResponse;
-    mLastServerResponse = nullptr;
-    delete mAuthOptions;
-    mAuthOptions = nullptr;
-    mCredential = nullptr;
-}
+SMTPClientBase::~SMTPClientBase() = default;
 
-// Copy constructor
+// Copy constructor: only the configuration is copied, the copy starts
+// without connection, communication log content and session results
 SMTPClientBase::SMTPClientBase(const SMTPClientBase& other)
-    : mServerName(new char[strlen(other.mServerName) + 1]),
+    : mServerName(other.mServerName),
       mPort(other.mPort),
-      mCommunicationLog(other.mCommunicationLog != nullptr ? new char[strlen(other.mCommunicationLog) + 1]: nullptr),
-      mCommunicationLogSize(other.mCommunicationLogSize),
-      mLastServerResponse(other.mLastServerResponse != nullptr ? new char[strlen(other.mLastServerResponse) + 1]: nullptr),
-      mCommandTimeOut(other.mCommandTimeOut),
-      mLastSocketErrNo(other.mLastSocketErrNo),
-      mAuthOptions(other.mAuthOptions != nullptr ? new ServerAuthOptions(*other.mAuthOptions) : nullptr),
-      mCredential(other.mCredential != nullptr ? new Credential(*other.mCredential) : nullptr),
-      mSock(0),
+      mCommunicationLog(other.mCommunicationLog.createEmptyCopy()),
+      mCommandTimeOutInMilliseconds(other.mCommandTimeOutInMilliseconds),
+      mLastSocketErrNo(0),
+      mCredential(other.mCredential != nullptr ? std::make_unique<Credential>(*other.mCredential) : nullptr),
+      mPlainAuthCommand(other.mPlainAuthCommand),
+      mPipeliningEnabled(other.mPipeliningEnabled),
+      mChunkingEnabled(other.mChunkingEnabled),
+      mTextAttachmentEncodingEnabled(other.mTextAttachmentEncodingEnabled),
+      mTransportOptions(other.mTransportOptions),
+      mDsnOptions(other.mDsnOptions),
+      mOperationTimeoutInMilliseconds(other.mOperationTimeoutInMilliseconds),
+      mCancellationToken(other.mCancellationToken),
+      mAttachmentPrefetchBlockCount(other.mAttachmentPrefetchBlockCount),
+      mEncodedAttachmentCache(other.mEncodedAttachmentCache),
+      mCapabilityCache(other.mCapabilityCache),
+      mDkimSigner(other.mDkimSigner),
+      mSessionObserver(other.mSessionObserver),
+      mSessionTrace(createEmptyTraceCopy(other.mSessionTrace)),
+      mTransport(nullptr),
       mKeepUsingBaseSendCommands(other.mKeepUsingBaseSendCommands),
       sendCommandPtr(&SMTPClientBase::sendCommand),
-      sendCommandWithFeedbackPtr(&SMTPClientBase::sendCommandWithFeedback) {
-    size_t server_name_len = strlen(other.mServerName);
-    strncpy(mServerName, other.mServerName, server_name_len);
-    mServerName[server_name_len] = '\0';
-    if (mCommunicationLog != nullptr) {
-        size_t communication_log_len = strlen(other.mCommunicationLog);
-        strncpy(mCommunicationLog, other.mCommunicationLog, communication_log_len);
-        mCommunicationLog[communication_log_len] = '\0';
-    }
-
-    if (mLastServerResponse != nullptr) {
-        size_t last_server_response_len = strlen(other.mLastServerResponse);
-        strncpy(mLastServerResponse, other.mLastServerResponse, last_server_response_len);
-        mLastServerResponse[last_server_response_len] = '\0';
-    }
+      sendCommandWithFeedbackPtr(&SMTPClientBase::sendCommandWithFeedback),
+      receiveDataPtr(&SMTPClientBase::receiveData),
+      sendDataSegmentsPtr(&SMTPClientBase::sendDataSegments) {
     setKeepUsingBaseSendCommands(mKeepUsingBaseSendCommands);
 }
 
 // Assignment operator
 SMTPClientBase& SMTPClientBase::operator=(const SMTPClientBase& other) {
     if (this != &other) {
-        // mServerName
-        delete[] mServerName;
-        size_t server_name_len = strlen(other.mServerName);
-        mServerName = new char[server_name_len + 1];
-        strncpy(mServerName, other.mServerName, server_name_len);
-        mServerName[server_name_len] = '\0';
-        // mPort
+        if (mConnectionOpened) {
+            closeSocket();
+        }
+        mServerName = other.mServerName;
         mPort = other.mPort;
-        // mCommunicationLog
-        mCommunicationLog = other.mCommunicationLog != nullptr ? new char[strlen(other.mCommunicationLog) + 1]: nullptr;
-        if (mCommunicationLog != nullptr) {
-            size_t communication_log_len = strlen(other.mCommunicationLog);
-            strncpy(mCommunicationLog, other.mCommunicationLog, communication_log_len);
-            mCommunicationLog[communication_log_len] = '\0';
-        }
-        mCommunicationLogSize = other.mCommunicationLogSize;
-        // mLastServerResponse
-        mLastServerResponse = other.mLastServerResponse != nullptr ? new char[strlen(other.mLastServerResponse) + 1]: nullptr;
-        if (mLastServerResponse != nullptr) {
-            size_t last_server_response_len = strlen(other.mLastServerResponse);
-            strncpy(mLastServerResponse, other.mLastServerResponse, last_server_response_len);
-            mLastServerResponse[last_server_response_len] = '\0';
-        }
-        mCommandTimeOut = other.mCommandTimeOut;
-        mLastSocketErrNo = other.mLastSocketErrNo;
-
-        delete mAuthOptions;
-        mAuthOptions = other.mAuthOptions != nullptr ? new ServerAuthOptions(*other.mAuthOptions) : nullptr;
-        // mCredential
-        mCredential = other.mCredential != nullptr ? new Credential(*other.mCredential) : nullptr;
-        mSock = 0;
+        mCommunicationLog = other.mCommunicationLog.createEmptyCopy();
+        mLastServerResponse.clear();
+        mCommandTimeOutInMilliseconds = other.mCommandTimeOutInMilliseconds;
+        mLastSocketErrNo = 0;
+        mAuthOptions.reset();
+        mCredential = other.mCredential != nullptr ? std::make_unique<Credential>(*other.mCredential) : nullptr;
+        mPlainAuthCommand = other.mPlainAuthCommand;
+        mServerCapabilities = ServerCapabilities();
+        mPipeliningEnabled = other.mPipeliningEnabled;
+        mChunkingEnabled = other.mChunkingEnabled;
+        mTextAttachmentEncodingEnabled = other.mTextAttachmentEncodingEnabled;
+        mTransportOptions = other.mTransportOptions;
+        mDsnOptions = other.mDsnOptions;
+        mOperationTimeoutInMilliseconds = other.mOperationTimeoutInMilliseconds;
+        mCancellationToken = other.mCancellationToken;
+        mAttachmentPrefetchBlockCount = other.mAttachmentPrefetchBlockCount;
+        mEncodedAttachmentCache = other.mEncodedAttachmentCache;
+        mCapabilityCache = other.mCapabilityCache;
+        mDkimSigner = other.mDkimSigner;
+        mSessionObserver = other.mSessionObserver;
+        mSessionTrace = createEmptyTraceCopy(other.mSessionTrace);
+        // A transport is used by one session at a time, it is not copied
+        mTransport = nullptr;
+        mIoCounters = IoCounters();
+        mSessionOpenedBefore = false;
+        clearSocketFileDescriptor();
+        mReplyReader.clear();
+        mLastEnhancedStatusCode.clear();
+        mRecipientResults.clear();
+        mLastSendReturnCode = 0;
+        mLastSendPhaseFailed = false;
+        mLastSendFailedPhase = SessionPhase::Connection;
+        mOutputBuffer.clear();
         setKeepUsingBaseSendCommands(other.mKeepUsingBaseSendCommands);
     }
     return *this;
@@ -144,73 +233,116 @@ SMTPClientBase& SMTPClientBase::operator=(const SMTPClientBase& other) {
 
 // Move constructor
 SMTPClientBase::SMTPClientBase(SMTPClientBase&& other) noexcept
-    : mServerName(other.mServerName),
+    : mServerName(std::move(other.mServerName)),
       mPort(other.mPort),
-      mCommunicationLog(other.mCommunicationLog),
-      mCommunicationLogSize(other.mCommunicationLogSize),
-      mLastServerResponse(other.mLastServerResponse),
-      mCommandTimeOut(other.mCommandTimeOut),
+      mCommunicationLog(std::move(other.mCommunicationLog)),
+      mLastServerResponse(std::move(other.mLastServerResponse)),
+      mCommandTimeOutInMilliseconds(other.mCommandTimeOutInMilliseconds),
       mLastSocketErrNo(other.mLastSocketErrNo),
-      mAuthOptions(other.mAuthOptions),
-      mCredential(other.mCredential),
+      mAuthOptions(std::move(other.mAuthOptions)),
+      mCredential(std::move(other.mCredential)),
+      mPlainAuthCommand(std::move(other.mPlainAuthCommand)),
+      mServerCapabilities(other.mServerCapabilities),
+      mPipeliningEnabled(other.mPipeliningEnabled),
+      mChunkingEnabled(other.mChunkingEnabled),
+      mTextAttachmentEncodingEnabled(other.mTextAttachmentEncodingEnabled),
+      mTransportOptions(other.mTransportOptions),
+      mDsnOptions(std::move(other.mDsnOptions)),
+      mOperationTimeoutInMilliseconds(other.mOperationTimeoutInMilliseconds),
+      mCancellationToken(std::move(other.mCancellationToken)),
+      mAttachmentPrefetchBlockCount(other.mAttachmentPrefetchBlockCount),
+      mEncodedAttachmentCache(std::move(other.mEncodedAttachmentCache)),
+      mCapabilityCache(std::move(other.mCapabilityCache)),
+      mDkimSigner(std::move(other.mDkimSigner)),
+      mSessionObserver(std::move(other.mSessionObserver)),
+      mSessionTrace(std::move(other.mSessionTrace)),
+      mTransport(std::move(other.mTransport)),
+      mIoCounters(other.mIoCounters),
       mSock(other.mSock),
+      mSessionOpened(other.mSessionOpened),
+      mSessionOpenedBefore(other.mSessionOpenedBefore),
+      mTransactionResetRequired(other.mTransactionResetRequired),
+      mConnectionOpened(other.mConnectionOpened),
+      mMessageContentStarted(other.mMessageContentStarted),
+      mReplyReader(std::move(other.mReplyReader)),
+      mLastEnhancedStatusCode(std::move(other.mLastEnhancedStatusCode)),
+      mRecipientResults(std::move(other.mRecipientResults)),
+      mLastSendReturnCode(other.mLastSendReturnCode),
+      mLastSendPhaseFailed(other.mLastSendPhaseFailed),
+      mLastSendFailedPhase(other.mLastSendFailedPhase),
+      mOutputBuffer(std::move(other.mOutputBuffer)),
       mKeepUsingBaseSendCommands(other.mKeepUsingBaseSendCommands),
       sendCommandPtr(&SMTPClientBase::sendCommand),
-      sendCommandWithFeedbackPtr(&SMTPClientBase::sendCommandWithFeedback) {
-    other.mServerName = nullptr;
-    other.mPort = 0;
-    other.mCommunicationLog = nullptr;
-    other.mCommunicationLogSize = 0;
-    other.mLastServerResponse = nullptr;
-    other.mCommandTimeOut = 0;
-    other.mLastSocketErrNo = 0;
-    other.mAuthOptions = nullptr;
-    other.mCredential = nullptr;
-    other.mSock = 0;
-    other.mKeepUsingBaseSendCommands = false;
+      sendCommandWithFeedbackPtr(&SMTPClientBase::sendCommandWithFeedback),
+      receiveDataPtr(&SMTPClientBase::receiveData),
+      sendDataSegmentsPtr(&SMTPClientBase::sendDataSegments) {
+#ifdef _WIN32
+    mWSAStarted = other.mWSAStarted;
+    other.mWSAStarted = false;
+#endif
+    // The source no longer owns the connection
+    other.clearSocketFileDescriptor();
     setKeepUsingBaseSendCommands(mKeepUsingBaseSendCommands);
 }
 
 // Move assignement operator
 SMTPClientBase& SMTPClientBase::operator=(SMTPClientBase&& other) noexcept {
     if (this != &other) {
-        delete[] mServerName;
-        delete[] mCommunicationLog;
-        delete[] mLastServerResponse;
-        delete mAuthOptions;
-        delete mCredential;
-        // Copy the data pointer and its length from the source object.
-        mServerName = other.mServerName;
+        // The connection of this client is replaced by the one of the source
+        if (mConnectionOpened) {
+            closeSocket();
+        }
+        mServerName = std::move(other.mServerName);
         mPort = other.mPort;
-        mCommunicationLog = other.mCommunicationLog;
-        mCommunicationLogSize = other.mCommunicationLogSize;
-        mLastServerResponse = other.mLastServerResponse;
-        mCommandTimeOut = other.mCommandTimeOut;
+        mCommunicationLog = std::move(other.mCommunicationLog);
+        mLastServerResponse = std::move(other.mLastServerResponse);
+        mCommandTimeOutInMilliseconds = other.mCommandTimeOutInMilliseconds;
         mLastSocketErrNo = other.mLastSocketErrNo;
-        mAuthOptions = other.mAuthOptions;
-        mCredential = other.mCredential;
+        mAuthOptions = std::move(other.mAuthOptions);
+        mCredential = std::move(other.mCredential);
+        mPlainAuthCommand = std::move(other.mPlainAuthCommand);
+        mServerCapabilities = other.mServerCapabilities;
+        mPipeliningEnabled = other.mPipeliningEnabled;
+        mChunkingEnabled = other.mChunkingEnabled;
+        mTextAttachmentEncodingEnabled = other.mTextAttachmentEncodingEnabled;
+        mTransportOptions = other.mTransportOptions;
+        mDsnOptions = std::move(other.mDsnOptions);
+        mOperationTimeoutInMilliseconds = other.mOperationTimeoutInMilliseconds;
+        mCancellationToken = std::move(other.mCancellationToken);
+        mAttachmentPrefetchBlockCount = other.mAttachmentPrefetchBlockCount;
+        mEncodedAttachmentCache = std::move(other.mEncodedAttachmentCache);
+        mCapabilityCache = std::move(other.mCapabilityCache);
+        mDkimSigner = std::move(other.mDkimSigner);
+        mSessionObserver = std::move(other.mSessionObserver);
+        mSessionTrace = std::move(other.mSessionTrace);
+        mTransport = std::move(other.mTransport);
+        mIoCounters = other.mIoCounters;
         mSock = other.mSock;
+        mSessionOpened = other.mSessionOpened;
+        mSessionOpenedBefore = other.mSessionOpenedBefore;
+        mTransactionResetRequired = other.mTransactionResetRequired;
+        mConnectionOpened = other.mConnectionOpened;
+        mMessageContentStarted = other.mMessageContentStarted;
+        mReplyReader = std::move(other.mReplyReader);
+        mLastEnhancedStatusCode = std::move(other.mLastEnhancedStatusCode);
+        mRecipientResults = std::move(other.mRecipientResults);
+        mLastSendReturnCode = other.mLastSendReturnCode;
+        mLastSendPhaseFailed = other.mLastSendPhaseFailed;
+        mLastSendFailedPhase = other.mLastSendFailedPhase;
+        mOutputBuffer = std::move(other.mOutputBuffer);
+#ifdef _WIN32
+        mWSAStarted = other.mWSAStarted;
+        other.mWSAStarted = false;
+#endif
         mKeepUsingBaseSendCommands = other.mKeepUsingBaseSendCommands;
         setKeepUsingBaseSendCommands(mKeepUsingBaseSendCommands);
-        // Release the data pointer from the source object so that
-        // the destructor does not free the memory multiple times.
-        other.mServerName = nullptr;
-        other.mPort = 0;
-        other.mCommunicationLog = nullptr;
-        other.mCommunicationLogSize = 0;
-        other.mLastServerResponse = nullptr;
-        other.mCommandTimeOut = 0;
-        other.mLastSocketErrNo = 0;
-        other.mAuthOptions = nullptr;
-        other.mCredential = nullptr;
-        other.mSock = 0;
-        other.mKeepUsingBaseSendCommands = false;
+        other.clearSocketFileDescriptor();
     }
     return *this;
 }
 
 const char *SMTPClientBase::getServerName() const {
-    return mServerName;
+    return mServerName.c_str();
 }
 
 unsigned int SMTPClientBase::getServerPort() const {
@@ -218,15 +350,99 @@ unsigned int SMTPClientBase::getServerPort() const {
 }
 
 unsigned int SMTPClientBase::getCommandTimeout() const {
-    return mCommandTimeOut;
+    return mCommandTimeOutInMilliseconds / 1000;
+}
+
+unsigned int SMTPClientBase::getCommandTimeoutInMilliseconds() const {
+    return mCommandTimeOutInMilliseconds;
+}
+
+unsigned int SMTPClientBase::getOperationTimeoutInMilliseconds() const {
+    return mOperationTimeoutInMilliseconds;
+}
+
+std::shared_ptr<CancellationToken> SMTPClientBase::getCancellationToken() const {
+    return mCancellationToken;
+}
+
+const DsnOptions &SMTPClientBase::getDsnOptions() const {
+    return mDsnOptions;
 }
 
 const char *SMTPClientBase::getCommunicationLog() const {
-    return mCommunicationLog == nullptr ? "" : mCommunicationLog;
+    return mCommunicationLog.getContent();
+}
+
+std::string_view SMTPClientBase::getCommunicationLogView() const {
+    return mCommunicationLog.getContentView();
+}
+
+CommunicationLogLevel SMTPClientBase::getCommunicationLogLevel() const {
+    return mCommunicationLog.getLevel();
+}
+
+size_t SMTPClientBase::getCommunicationLogCapacity() const {
+    return mCommunicationLog.getCapacity();
 }
 
 const Credential *SMTPClientBase::getCredentials() const {
-    return mCredential;
+    return mCredential.get();
+}
+
+const ServerCapabilities &SMTPClientBase::getServerCapabilities() const {
+    return mServerCapabilities;
+}
+
+bool SMTPClientBase::isPipeliningEnabled() const {
+    return mPipeliningEnabled;
+}
+
+bool SMTPClientBase::isChunkingEnabled() const {
+    return mChunkingEnabled;
+}
+
+bool SMTPClientBase::isTextAttachmentEncodingEnabled() const {
+    return mTextAttachmentEncodingEnabled;
+}
+
+size_t SMTPClientBase::getDataWriteSize() const {
+    return mTransportOptions.WriteSize;
+}
+
+const TransportOptions &SMTPClientBase::getTransportOptions() const {
+    return mTransportOptions;
+}
+
+size_t SMTPClientBase::getAttachmentPrefetchBlockCount() const {
+    return mAttachmentPrefetchBlockCount;
+}
+
+std::shared_ptr<EncodedAttachmentCache> SMTPClientBase::getEncodedAttachmentCache() const {
+    return mEncodedAttachmentCache;
+}
+
+std::shared_ptr<CapabilityCache> SMTPClientBase::getCapabilityCache() const {
+    return mCapabilityCache;
+}
+
+std::shared_ptr<const DkimSigner> SMTPClientBase::getDkimSigner() const {
+    return mDkimSigner;
+}
+
+std::shared_ptr<SessionObserver> SMTPClientBase::getSessionObserver() const {
+    return mSessionObserver;
+}
+
+std::shared_ptr<const SessionTrace> SMTPClientBase::getSessionTrace() const {
+    return mSessionTrace;
+}
+
+std::shared_ptr<Transport> SMTPClientBase::getTransport() const {
+    return mTransport;
+}
+
+const IoCounters &SMTPClientBase::getIoCounters() const {
+    return mIoCounters;
 }
 
 void SMTPClientBase::setServerPort(unsigned int pPort) {
@@ -238,20 +454,33 @@ void SMTPClientBase::setServerName(const char *pServerName) {
     if (pServerName == nullptr || strcmp(pServerName, "") == 0  || StringUtils::trim(servername_str).empty()) {
         throw std::invalid_argument("Server name cannot be null or empty");
     }
-    delete []mServerName;
-    size_t server_name_len = strlen(pServerName);
-    mServerName = new char[server_name_len + 1];
-    strncpy(mServerName, pServerName, server_name_len);
-    mServerName[server_name_len] = '\0';
+    mServerName = pServerName;
 }
 
 void SMTPClientBase::setCommandTimeout(unsigned int pTimeOutInSeconds) {
-    mCommandTimeOut = pTimeOutInSeconds;
+    const unsigned int MAX_TIMEOUT_IN_SECONDS = (std::numeric_limits<unsigned int>::max)() / 1000;
+    mCommandTimeOutInMilliseconds = (std::min)(pTimeOutInSeconds, MAX_TIMEOUT_IN_SECONDS) * 1000;
+}
+
+void SMTPClientBase::setCommandTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds) {
+    mCommandTimeOutInMilliseconds = pTimeOutInMilliseconds;
+}
+
+void SMTPClientBase::setOperationTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds) {
+    mOperationTimeoutInMilliseconds = pTimeOutInMilliseconds;
+}
+
+void SMTPClientBase::setCancellationToken(std::shared_ptr<CancellationToken> pToken) {
+    mCancellationToken = std::move(pToken);
+}
+
+void SMTPClientBase::setDsnOptions(const DsnOptions &pOptions) {
+    mDsnOptions = pOptions;
 }
 
 void SMTPClientBase::setCredentials(const Credential &pCredential) {
-    delete mCredential;
-    mCredential = new Credential(pCredential);
+    mCredential = std::make_unique<Credential>(pCredential);
+    mPlainAuthCommand.clear();
 }
 
 void SMTPClientBase::setKeepUsingBaseSendCommands(bool pValue) {
@@ -259,10 +488,150 @@ void SMTPClientBase::setKeepUsingBaseSendCommands(bool pValue) {
     if (pValue) {
         sendCommandPtr = &SMTPClientBase::sendRawCommand;
         sendCommandWithFeedbackPtr = &SMTPClientBase::sendRawCommand;
+        receiveDataPtr = &SMTPClientBase::receiveRawData;
+        sendDataSegmentsPtr = &SMTPClientBase::sendRawDataSegments;
     } else {
         sendCommandPtr = &SMTPClientBase::sendCommand;
         sendCommandWithFeedbackPtr = &SMTPClientBase::sendCommandWithFeedback;
+        receiveDataPtr = &SMTPClientBase::receiveData;
+        sendDataSegmentsPtr = &SMTPClientBase::sendDataSegments;
+    }
+}
+
+void SMTPClientBase::setPipeliningEnabled(bool pValue) {
+    mPipeliningEnabled = pValue;
+}
+
+void SMTPClientBase::setChunkingEnabled(bool pValue) {
+    mChunkingEnabled = pValue;
+}
+
+void SMTPClientBase::setTextAttachmentEncodingEnabled(bool pValue) {
+    mTextAttachmentEncodingEnabled = pValue;
+}
+
+void SMTPClientBase::setCommunicationLogLevel(CommunicationLogLevel pLevel) {
+    mCommunicationLog.setLevel(pLevel);
+}
+
+void SMTPClientBase::setCommunicationLogCapacity(size_t pCapacity) {
+    mCommunicationLog.setCapacity(pCapacity);
+}
+
+void SMTPClientBase::setCommunicationLogSink(CommunicationLogSink pSink) {
+    mCommunicationLog.setSink(std::move(pSink));
+}
+
+void SMTPClientBase::setEncodedAttachmentCache(std::shared_ptr<EncodedAttachmentCache> pCache) {
+    mEncodedAttachmentCache = std::move(pCache);
+}
+
+void SMTPClientBase::setCapabilityCache(std::shared_ptr<CapabilityCache> pCache) {
+    mCapabilityCache = std::move(pCache);
+}
+
+void SMTPClientBase::setDkimSigner(std::shared_ptr<const DkimSigner> pSigner) {
+    mDkimSigner = std::move(pSigner);
+}
+
+void SMTPClientBase::setSessionObserver(std::shared_ptr<SessionObserver> pObserver) {
+    mSessionObserver = std::move(pObserver);
+}
+
+void SMTPClientBase::setSessionTraceCapacity(size_t pCapacity) {
+    mSessionTrace = pCapacity > 0 ? std::make_shared<SessionTrace>(pCapacity) : nullptr;
+}
+
+void SMTPClientBase::setTransport(std::shared_ptr<Transport> pTransport) {
+    mTransport = std::move(pTransport);
+}
+
+void SMTPClientBase::beginPhase() {
+    // The clock is not read when nothing is measured
+    if (mSessionObserver == nullptr && mSessionTrace == nullptr) {
+        return;
+    }
+    mPhaseStartTime = std::chrono::steady_clock::now();
+    mPhaseStartIoCounters = mIoCounters;
+}
+
+int SMTPClientBase::endPhase(SessionPhase pPhase, int pReturnCode) {
+    if (pReturnCode != 0) {
+        mLastSendPhaseFailed = true;
+        mLastSendFailedPhase = pPhase;
+    }
+    if (mSessionObserver == nullptr && mSessionTrace == nullptr) {
+        return pReturnCode;
+    }
+    PhaseMeasurement measurement;
+    measurement.Phase = pPhase;
+    measurement.Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mPhaseStartTime);
+    if (mSessionTrace != nullptr) {
+        mSessionTrace->recordPhase(pPhase, pReturnCode, measurement.Duration);
+    }
+    if (mSessionObserver == nullptr) {
+        return pReturnCode;
+    }
+    measurement.ReturnCode = pReturnCode;
+    measurement.Io.BytesWritten = mIoCounters.BytesWritten - mPhaseStartIoCounters.BytesWritten;
+    measurement.Io.BytesRead = mIoCounters.BytesRead - mPhaseStartIoCounters.BytesRead;
+    measurement.Io.WriteCalls = mIoCounters.WriteCalls - mPhaseStartIoCounters.WriteCalls;
+    measurement.Io.ReadCalls = mIoCounters.ReadCalls - mPhaseStartIoCounters.ReadCalls;
+    measurement.Io.WaitCalls = mIoCounters.WaitCalls - mPhaseStartIoCounters.WaitCalls;
+    mSessionObserver->onPhaseCompleted(measurement);
+    return pReturnCode;
+}
+
+void SMTPClientBase::recordSessionOpened() {
+    if (mSessionTrace != nullptr) {
+        mSessionTrace->recordSessionOpened();
     }
+    if (mSessionObserver != nullptr) {
+        mSessionObserver->onSessionOpened(mSessionOpenedBefore);
+    }
+    mSessionOpenedBefore = true;
+}
+
+void SMTPClientBase::recordTlsHandshake(bool pResumed) {
+    if (mSessionTrace != nullptr) {
+        mSessionTrace->recordTlsHandshake(pResumed);
+    }
+    if (mSessionObserver != nullptr) {
+        mSessionObserver->onTlsHandshakeCompleted(pResumed);
+    }
+}
+
+void SMTPClientBase::countWrite(size_t pBytesWritten) {
+    mIoCounters.WriteCalls++;
+    mIoCounters.BytesWritten += pBytesWritten;
+}
+
+void SMTPClientBase::countRead(size_t pBytesRead) {
+    mIoCounters.ReadCalls++;
+    mIoCounters.BytesRead += pBytesRead;
+}
+
+void SMTPClientBase::countWait() {
+    mIoCounters.WaitCalls++;
+}
+
+void SMTPClientBase::setDataWriteSize(size_t pWriteSize) {
+    const size_t MIN_WRITE_SIZE = 512;
+    const size_t MAX_WRITE_SIZE = static_cast<size_t>((std::numeric_limits<int>::max)());
+    mTransportOptions.WriteSize = (std::min)((std::max)(pWriteSize, MIN_WRITE_SIZE), MAX_WRITE_SIZE);
+}
+
+void SMTPClientBase::setTransportOptions(const TransportOptions &pOptions) {
+    const size_t MIN_READ_BUFFER_SIZE = 512;
+    const size_t MAX_READ_BUFFER_SIZE = static_cast<size_t>((std::numeric_limits<int>::max)());
+    mTransportOptions = pOptions;
+    mTransportOptions.ReadBufferSize = (std::min)((std::max)(pOptions.ReadBufferSize, MIN_READ_BUFFER_SIZE),
+            MAX_READ_BUFFER_SIZE);
+    setDataWriteSize(pOptions.WriteSize);
+}
+
+void SMTPClientBase::setAttachmentPrefetchBlockCount(size_t pBlockCount) {
+    mAttachmentPrefetchBlockCount = pBlockCount;
 }
 
 int SMTPClientBase::getSocketFileDescriptor() const {
@@ -271,10 +640,30 @@ int SMTPClientBase::getSocketFileDescriptor() const {
 
 void SMTPClientBase::clearSocketFileDescriptor() {
     mSock = 0;
+    mSessionOpened = false;
+    // Nothing is left to reset on a closed connection
+    mConnectionOpened = false;
+    mTransactionResetRequired = false;
+    mMessageContentStarted = false;
+}
+
+void SMTPClientBase::closeSocket() {
+    // The socket of a transport is closed by the transport
+    if (mTransport != nullptr) {
+        mTransport->close();
+    } else if (mSock != 0) {
+#ifdef _WIN32
+        shutdown(mSock, SD_BOTH);
+        closesocket(mSock);
+#else
+        close(mSock);
+#endif
+    }
+    clearSocketFileDescriptor();
 }
 
 const char *SMTPClientBase::getLastServerResponse() const {
-    return mLastServerResponse;
+    return mLastServerResponse.c_str();
 }
 
 void SMTPClientBase::setLastSocketErrNo(int lastError) {
@@ -282,16 +671,18 @@ void SMTPClientBase::setLastSocketErrNo(int lastError) {
 }
 
 void SMTPClientBase::setAuthenticationOptions(ServerAuthOptions *authOptions) {
-    delete mAuthOptions;
-    mAuthOptions = authOptions;
+    mAuthOptions.reset(authOptions);
+}
+
+void SMTPClientBase::setServerCapabilities(const ServerCapabilities &pCapabilities) {
+    mServerCapabilities = pCapabilities;
 }
 
 char *SMTPClientBase::getErrorMessage(int errorCode) {
-    ErrorResolver errorResolver(errorCode);
-    const char *errorMessageStr = errorResolver.getErrorMessage();
-    size_t error_message_len = strlen(errorMessageStr);
+    const std::string_view errorMessageStr = ErrorResolver::findErrorMessage(errorCode);
+    size_t error_message_len = errorMessageStr.size();
     char *errorMessage = new char[error_message_len + 1];
-    strncpy(errorMessage, errorMessageStr, error_message_len);
+    strncpy(errorMessage, errorMessageStr.data(), error_message_len);
     errorMessage[error_message_len] = '\0';
     return errorMessage;
 }
@@ -299,8 +690,7 @@ char *SMTPClientBase::getErrorMessage(int errorCode) {
 int SMTPClientBase::getErrorMessage_r(int errorCode,
         char *errorMessagePtr,
         const size_t maxLength) {
-    ErrorResolver errorResolver(errorCode);
-    const char *errorMessageStr = errorResolver.getErrorMessage();
+    const char *errorMessageStr = ErrorResolver::findErrorMessage(errorCode).data();
     if (!errorMessagePtr || maxLength == 0) {
         return -1;
     }
@@ -315,114 +705,554 @@ int SMTPClientBase::getErrorMessage_r(int errorCode,
     return 0;
 }
 
-int SMTPClientBase::sendMail(const Message &pMsg) {
+int SMTPClientBase::connect() {
+    if (mSessionOpened) {
+        return 0;
+    }
+    startOperation();
     int client_connect_ret_code = establishConnectionWithServer();
     if (client_connect_ret_code != 0) {
-        return client_connect_ret_code;
+        cleanup();
+        return finishOperation(client_connect_ret_code);
     }
+    mSessionOpened = true;
+    mConnectionOpened = true;
+    mTransactionResetRequired = false;
+    recordSessionOpened();
+    return 0;
+}
 
-    int set_mail_recipients_ret_code = setMailRecipients(pMsg);
-    if (set_mail_recipients_ret_code != 0) {
-        return set_mail_recipients_ret_code;
+int SMTPClientBase::disconnect() {
+    if (!mSessionOpened) {
+        return 0;
     }
+    startOperation();
+    int quit_ret_code = sendQuitCommand();
+    cleanup();
+    mSessionOpened = false;
+    return finishOperation(quit_ret_code);
+}
 
-    int set_mail_headers_ret_code = setMailHeaders(pMsg);
-    if (set_mail_headers_ret_code != 0) {
-        return set_mail_headers_ret_code;
-    }
+bool SMTPClientBase::isConnected() const {
+    return mSessionOpened;
+}
 
-    int set_mail_body_ret_code = setMailBody(pMsg);
-    if (set_mail_body_ret_code != 0) {
-        return set_mail_body_ret_code;
+int SMTPClientBase::prepare() {
+    if (mSessionOpened) {
+        if (sendNoop() == 0) {
+            return 0;
+        }
+        // The server no longer answers on the parked session
+        disconnect();
     }
+    return connect();
+}
 
-    cleanup();
+int SMTPClientBase::sendNoop() {
+    if (!mSessionOpened) {
+        return CLIENT_SESSION_NOT_OPENED_ERROR;
+    }
+    startOperation();
+    std::string noop_command { "NOOP\r\n" };
+    addCommunicationLogItem(noop_command.c_str());
+    int noop_ret_code = (*this.*sendCommandWithFeedbackPtr)(noop_command.c_str(), CLIENT_SESSION_NOOP_ERROR, CLIENT_SESSION_NOOP_TIMEOUT);
+    if (noop_ret_code != STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED) {
+        return finishOperation(noop_ret_code);
+    }
     return 0;
 }
 
+int SMTPClientBase::sendMail(const Message &pMsg) {
+    return sendMail(pMsg, nullptr, 0);
+}
 
-int SMTPClientBase::initializeSession() {
-    delete[] mCommunicationLog;
-    mCommunicationLog = new char[INITIAL_COMM_LOG_LENGTH];
-    mCommunicationLogSize = INITIAL_COMM_LOG_LENGTH;
-    mCommunicationLog[0] = '\0';
+int SMTPClientBase::sendMail(const Message &pMsg,
+        const MessageAddress *pEnvelopeRecipients,
+        size_t pEnvelopeRecipientCount) {
+    return recordSendResult(finishOperation(runMailTransaction([this, &pMsg, pEnvelopeRecipients, pEnvelopeRecipientCount]() {
+            return sendMailTransaction(pMsg, nullptr, pEnvelopeRecipients, pEnvelopeRecipientCount);
+            })));
+}
 
-#ifdef _WIN32
-    return initializeSessionWinSock();
-#else
-    return initializeSessionPOSIX();
-#endif
+int SMTPClientBase::sendRenderedMail(const char *pSenderAddress,
+        const char * const *pRecipientAddresses,
+        size_t pRecipientCount,
+        const char *pContent,
+        size_t pContentLength) {
+    const std::string_view content { pContent, pContentLength };
+    return recordSendResult(finishOperation(runMailTransaction([this, pSenderAddress, pRecipientAddresses, pRecipientCount, &content]() {
+            return sendRenderedMailTransaction(pSenderAddress, pRecipientAddresses, pRecipientCount, &content, 1);
+            })));
 }
 
-#ifdef _WIN32
-int SMTPClientBase::initializeSessionWinSock() {
-    // Windows Sockets version
-    WSADATA wsaData;
-    WORD wVersionRequested = MAKEWORD(2, 2);
-    int wsa_retVal = WSAStartup(wVersionRequested, &wsaData);
-    if (wsa_retVal != 0) {
-        std::stringstream ssError;
-        setLastSocketErrNo(wsa_retVal);
-        ssError << "WSAStartup failed with error: " << wsa_retVal;
-        addCommunicationLogItem(ssError.str().c_str());
-        return SOCKET_INIT_SESSION_WINSOCKET_STARTUP_ERROR;
+int SMTPClientBase::runMailTransaction(const std::function<int()> &pTransaction) {
+    // Nothing of the previous message is reported with this one
+    mLastSendPhaseFailed = false;
+    mLastEnhancedStatusCode.clear();
+    mLastServerResponse.clear();
+    mRecipientResults.clear();
+    startOperation();
+
+    // Persistent session opened by connect
+    if (mSessionOpened) {
+        return finishMailTransaction(pTransaction());
     }
-    mWSAStarted = true;
-    struct addrinfo *result = nullptr;
-    struct addrinfo hints;
-    memset(&hints, 0, sizeof hints);
-    hints.ai_family = AF_UNSPEC;  // use IPv4 or IPv6, whichever
-    hints.ai_socktype = SOCK_STREAM;
 
-    wsa_retVal = getaddrinfo(getServerName(), std::to_string(getServerPort()).c_str(), &hints, &result);
-    if (wsa_retVal != 0) {
-        addWSAMessageToCommunicationLog(wsa_retVal);
-        setLastSocketErrNo(wsa_retVal);
-        doWSACleanup();
-        return SOCKET_INIT_SESSION_WINSOCKET_GETADDRINFO_ERROR;
+    int client_connect_ret_code = establishConnectionWithServer();
+    if (client_connect_ret_code != 0) {
+        cleanup();
+        return client_connect_ret_code;
     }
-
-    mSock = static_cast<unsigned int>(socket(result->ai_family, result->ai_socktype, result->ai_protocol));
-    if (mSock == INVALID_SOCKET) {
-        int wsa_error = WSAGetLastError();
-        addWSAMessageToCommunicationLog(wsa_error);
-        setLastSocketErrNo(wsa_error);
-        doWSACleanup();
-        return SOCKET_INIT_SESSION_CREATION_ERROR;
+    mConnectionOpened = true;
+    recordSessionOpened();
+
+    int transaction_ret_code = pTransaction();
+    if (transaction_ret_code != 0) {
+        // The connection is not reused, it is closed whatever the state of
+        // the transaction
+        if (mConnectionOpened && !mMessageContentStarted) {
+            sendQuitCommand();
+        }
+        cleanup();
+        mTransactionResetRequired = false;
+        return transaction_ret_code;
     }
-    std::stringstream ss;
-    ss << "Trying to connect to " << getServerName() << " on port " << getServerPort();
-    addCommunicationLogItem(ss.str().c_str());
-    wsa_retVal = connect(mSock, result->ai_addr, static_cast<int>(result->ai_addrlen));
-    if (wsa_retVal == SOCKET_ERROR) {
-        int wsa_error = WSAGetLastError();
-        addWSAMessageToCommunicationLog(wsa_error);
-        setLastSocketErrNo(wsa_error);
-        doWSACleanup();
-        return SOCKET_INIT_SESSION_CONNECT_ERROR;
+    mTransactionResetRequired = false;
+
+    int quit_ret_code = sendQuitCommand();
+    if (quit_ret_code != 0) {
+        return quit_ret_code;
     }
+
+    cleanup();
     return 0;
 }
 
-bool SMTPClientBase::isWSAStarted() {
-    return mWSAStarted;
-};
-
-void SMTPClientBase::setWSAStopped() {
-    mWSAStarted = false;
-};
+int SMTPClientBase::recordSendResult(int pReturnCode) {
+    mLastSendReturnCode = pReturnCode;
+    if (pReturnCode == 0) {
+        mLastSendPhaseFailed = false;
+    }
+    return pReturnCode;
+}
 
-void SMTPClientBase::addWSAMessageToCommunicationLog(const int errorCode) {
-    LPTSTR formattedErrorMessage = nullptr;
-    if(FormatMessage( FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_MAX_WIDTH_MASK,
-        nullptr,
-        errorCode,
-        0,
-        (LPTSTR)&formattedErrorMessage,
-        0,
-        nullptr) != 0) {
-        addCommunicationLogItem(formattedErrorMessage);
-        LocalFree(formattedErrorMessage);
+SendResult SMTPClientBase::getLastSendResult() const {
+    SendResult result;
+    result.ReturnCode = mLastSendReturnCode;
+    result.Category = ErrorResolver::findErrorCategory(mLastSendReturnCode);
+    result.HasFailedPhase = mLastSendPhaseFailed;
+    result.FailedPhase = mLastSendFailedPhase;
+    if (mLastSendReturnCode != 0) {
+        result.Message = ErrorResolver::findErrorMessage(mLastSendReturnCode);
+    }
+    result.ServerReply = mLastServerResponse;
+    result.EnhancedStatusCode = mLastEnhancedStatusCode;
+    if (!mRecipientResults.empty()) {
+        result.RecipientResults = mRecipientResults.data();
+        result.RecipientResultCount = mRecipientResults.size();
+    }
+    return result;
+}
+
+std::vector<BulkRecipientResult> SMTPClientBase::sendBulk(const Message &pTemplate,
+        const MessageAddress *pRecipients,
+        size_t pRecipientCount) {
+    if (pRecipients == nullptr) {
+        return std::vector<BulkRecipientResult>(pRecipientCount);
+    }
+    return runBulkTransactions(pRecipientCount, [this, &pTemplate, pRecipients](size_t pIndex) {
+        return sendMailTransaction(pTemplate, &pRecipients[pIndex]);
+    });
+}
+
+std::vector<BulkRecipientResult> SMTPClientBase::sendBulk(const char *pSenderAddress,
+        const MessageTemplate &pTemplate,
+        const MergeRecipient *pRecipients,
+        size_t pRecipientCount) {
+    if (pRecipients == nullptr) {
+        return std::vector<BulkRecipientResult>(pRecipientCount);
+    }
+    // Only the values of the merge fields are copied for each recipient
+    RenderedTemplate rendered_template;
+    return runBulkTransactions(pRecipientCount, [this, pSenderAddress, &pTemplate, pRecipients, &rendered_template](size_t pIndex) {
+        int render_ret_code = pTemplate.render(pRecipients[pIndex].Fields, rendered_template);
+        if (render_ret_code != 0) {
+            return render_ret_code;
+        }
+        const char *recipient_address = pRecipients[pIndex].EmailAddress.c_str();
+        return sendRenderedMailTransaction(pSenderAddress, &recipient_address, 1,
+                rendered_template.getSegments(), rendered_template.getSegmentCount());
+    });
+}
+
+std::vector<BulkRecipientResult> SMTPClientBase::runBulkTransactions(size_t pRecipientCount,
+        const std::function<int(size_t)> &pTransaction) {
+    std::vector<BulkRecipientResult> results(pRecipientCount);
+    if (pRecipientCount == 0) {
+        return results;
+    }
+    const bool session_opened_by_bulk = !mSessionOpened;
+    int connect_ret_code = connect();
+    bool reconnect_allowed = true;
+    for (size_t index = 0; index < pRecipientCount; index++) {
+        if (connect_ret_code == 0 && !mSessionOpened) {
+            // The server has dropped the session, reopen it once
+            connect_ret_code = reconnect_allowed ? connect() : CLIENT_SESSION_NOT_OPENED_ERROR;
+            reconnect_allowed = false;
+        }
+        if (connect_ret_code != 0) {
+            results[index].ReturnCode = connect_ret_code;
+            continue;
+        }
+        mLastEnhancedStatusCode.clear();
+        mRecipientResults.clear();
+        startOperation();
+        results[index].ReturnCode = finishOperation(pTransaction(index));
+        results[index].EnhancedStatusCode = mLastEnhancedStatusCode;
+        finishMailTransaction(results[index].ReturnCode);
+    }
+    if (session_opened_by_bulk) {
+        disconnect();
+    }
+    return results;
+}
+
+int SMTPClientBase::sendMailTransaction(const Message &pMsg,
+        const MessageAddress *pRecipient,
+        const MessageAddress *pEnvelopeRecipients,
+        size_t pEnvelopeRecipientCount) {
+    // The attachments are sent without base64 when the server accepts
+    // binary content (RFC 3030) and a body with 8-bit characters is declared
+    // when the server accepts it (RFC 6152)
+    const bool use_chunking = mChunkingEnabled && mServerCapabilities.Chunking;
+    const bool binary_attachments = use_chunking && mServerCapabilities.BinaryMime && pMsg.getAttachmentsCount() > 0;
+    const bool eight_bit_body = (binary_attachments || mServerCapabilities.EightBitMime) &&
+        MimeWriter::containsEightBitData(pMsg);
+    std::string mail_parameters { binary_attachments ? "BODY=BINARYMIME" : (eight_bit_body ? "BODY=8BITMIME" : "") };
+    const char *body_transfer_encoding = eight_bit_body ? "8bit" : nullptr;
+    // The same boundary is hashed, measured and sent
+    mBoundary.generate(pMsg.getBodyView());
+    // The body is hashed before the headers are sent since the signature
+    // field precedes them
+    std::string signature_field;
+    if (mDkimSigner != nullptr) {
+        int signature_ret_code = createDkimSignatureField(pMsg, pRecipient, binary_attachments,
+                body_transfer_encoding, signature_field);
+        if (signature_ret_code != 0) {
+            return signature_ret_code;
+        }
+    }
+    if (mServerCapabilities.Size) {
+        const size_t message_size = signature_field.size() + MimeWriter::computeSize(pMsg, mBoundary, pRecipient,
+                body_transfer_encoding, binary_attachments, mTextAttachmentEncodingEnabled);
+        int size_ret_code = addMessageSizeParameter(message_size, mail_parameters);
+        if (size_ret_code != 0) {
+            return size_ret_code;
+        }
+    }
+
+    // A previous transaction of this session has not been completed
+    if (mTransactionResetRequired) {
+        int reset_ret_code = resetMailTransaction();
+        if (reset_ret_code != STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED) {
+            return reset_ret_code;
+        }
+    }
+    mTransactionResetRequired = true;
+
+    addDsnMailParameters(mail_parameters);
+    const char *mail_parameters_ptr = mail_parameters.empty() ? nullptr : mail_parameters.c_str();
+    beginPhase();
+    int set_mail_recipients_ret_code = endPhase(SessionPhase::Envelope, pEnvelopeRecipients != nullptr ?
+        setMailRecipients(pMsg, pEnvelopeRecipients, pEnvelopeRecipientCount, mail_parameters_ptr) :
+        setMailRecipients(pMsg, pRecipient, 1, mail_parameters_ptr));
+    if (set_mail_recipients_ret_code != 0) {
+        return set_mail_recipients_ret_code;
+    }
+
+    if (use_chunking) {
+        beginPhase();
+        return endPhase(SessionPhase::Body, setMailBodyChunked(pMsg, pRecipient, binary_attachments,
+                    body_transfer_encoding, signature_field));
+    }
+
+    beginPhase();
+    int set_mail_headers_ret_code = endPhase(SessionPhase::Headers, setMailHeaders(pMsg, pRecipient, signature_field));
+    if (set_mail_headers_ret_code != 0) {
+        return set_mail_headers_ret_code;
+    }
+
+    beginPhase();
+    int set_mail_body_ret_code = endPhase(SessionPhase::Body, setMailBody(pMsg, body_transfer_encoding));
+    // Nothing of a failed transaction is sent with the next one
+    mOutputBuffer.clear();
+    if (set_mail_body_ret_code != 0) {
+        return set_mail_body_ret_code;
+    }
+    return 0;
+}
+
+int SMTPClientBase::sendRenderedMailTransaction(const char *pSenderAddress,
+        const char * const *pRecipientAddresses,
+        size_t pRecipientCount,
+        const std::string_view *pContentSegments,
+        size_t pContentSegmentCount) {
+    size_t content_length = 0;
+    bool eight_bit_data = false;
+    for (size_t index = 0; index < pContentSegmentCount; index++) {
+        content_length += pContentSegments[index].size();
+        eight_bit_data = eight_bit_data || MimeWriter::containsEightBitData(pContentSegments[index]);
+    }
+    // The signature field is sent as the first segment of the content
+    std::string signature_field;
+    std::vector<std::string_view> signed_segments;
+    if (mDkimSigner != nullptr) {
+        int signature_ret_code = createDkimSignatureField(pContentSegments, pContentSegmentCount, signature_field);
+        if (signature_ret_code != 0) {
+            return signature_ret_code;
+        }
+        signed_segments.emplace_back(signature_field);
+        signed_segments.insert(signed_segments.end(), pContentSegments, pContentSegments + pContentSegmentCount);
+        pContentSegments = signed_segments.data();
+        pContentSegmentCount = signed_segments.size();
+        content_length += signature_field.size();
+    }
+    const bool use_chunking = mChunkingEnabled && mServerCapabilities.Chunking;
+    const bool eight_bit_content = mServerCapabilities.EightBitMime && eight_bit_data;
+    std::string mail_parameters { eight_bit_content ? "BODY=8BITMIME" : "" };
+    if (mServerCapabilities.Size) {
+        int size_ret_code = addMessageSizeParameter(content_length, mail_parameters);
+        if (size_ret_code != 0) {
+            return size_ret_code;
+        }
+    }
+    addDsnMailParameters(mail_parameters);
+
+    if (mTransactionResetRequired) {
+        int reset_ret_code = resetMailTransaction();
+        if (reset_ret_code != STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED) {
+            return reset_ret_code;
+        }
+    }
+    mTransactionResetRequired = true;
+
+    std::vector<const char *> recipients;
+    if (pRecipientAddresses != nullptr) {
+        recipients.assign(pRecipientAddresses, pRecipientAddresses + pRecipientCount);
+    }
+    beginPhase();
+    int envelope_ret_code = endPhase(SessionPhase::Envelope,
+            setMailEnvelope(pSenderAddress, nullptr, recipients, mail_parameters.empty() ? nullptr : mail_parameters.c_str()));
+    if (envelope_ret_code != 0) {
+        return envelope_ret_code;
+    }
+
+    // The rendered content, headers included, is measured as the body
+    beginPhase();
+    // The content is sent as a single chunk of known size
+    if (use_chunking) {
+        addCommunicationLogItem(("<"s + std::to_string(content_length) + " bytes of rendered message>"s).c_str());
+        size_t pending_reply_count = 0;
+        return endPhase(SessionPhase::Body, sendChunk(pContentSegments, pContentSegmentCount, true, pending_reply_count));
+    }
+
+    int data_ret_code = sendDataCommand();
+    if (data_ret_code != 0) {
+        return endPhase(SessionPhase::Body, data_ret_code);
+    }
+    addCommunicationLogItem(("<"s + std::to_string(content_length) + " bytes of rendered message>"s).c_str());
+    // A line of the content that starts with a dot must not end the data,
+    // the normalizer keeps the state of the line between the segments
+    std::vector<std::string_view> content_segments;
+    DataNormalizer normalizer;
+    for (size_t index = 0; index < pContentSegmentCount; index++) {
+        normalizer.normalize(pContentSegments[index], content_segments);
+    }
+    return endPhase(SessionPhase::Body, sendEndOfData(content_segments, CLIENT_SENDMAIL_BODY_ERROR));
+}
+
+int SMTPClientBase::addMessageSizeParameter(size_t pMessageSize, std::string &pMailParameters) {
+    // The message is refused before any byte of it is sent (RFC 1870)
+    if (mServerCapabilities.MaxMessageSize > 0 && pMessageSize > mServerCapabilities.MaxMessageSize) {
+        addCommunicationLogItem(("The message size ("s + std::to_string(pMessageSize) +
+                    " bytes) exceeds the maximum size accepted by the server ("s +
+                    std::to_string(mServerCapabilities.MaxMessageSize) + " bytes)"s).c_str());
+        return CLIENT_SENDMAIL_MESSAGE_SIZE_EXCEEDED_ERROR;
+    }
+    if (!pMailParameters.empty()) {
+        pMailParameters += ' ';
+    }
+    pMailParameters += "SIZE="s + std::to_string(pMessageSize);
+    return 0;
+}
+
+void SMTPClientBase::addDsnMailParameters(std::string &pMailParameters) const {
+    if (!mServerCapabilities.Dsn) {
+        return;
+    }
+    if (mDsnOptions.Return != DsnReturn::Default) {
+        pMailParameters += pMailParameters.empty() ? "" : " ";
+        pMailParameters += mDsnOptions.Return == DsnReturn::Full ? "RET=FULL" : "RET=HDRS";
+    }
+    if (!mDsnOptions.EnvelopeId.empty()) {
+        pMailParameters += pMailParameters.empty() ? "ENVID=" : " ENVID=";
+        appendXtext(mDsnOptions.EnvelopeId, pMailParameters);
+    }
+}
+
+int SMTPClientBase::finishMailTransaction(int pReturnCode) {
+    // The end of data or the last chunk accepted completes the transaction
+    // (RFC 5321 section 4.1.4), the next one starts without RSET
+    if (pReturnCode == 0) {
+        mTransactionResetRequired = false;
+    } else {
+        recoverFailedTransaction();
+    }
+    return pReturnCode;
+}
+
+void SMTPClientBase::recoverFailedTransaction() {
+    // The connection has been closed by an I/O error or nothing was started
+    if (!mConnectionOpened || !mTransactionResetRequired) {
+        return;
+    }
+    if (mMessageContentStarted) {
+        // The server would read the next commands as the message content
+        addCommunicationLogItem("The message content has been interrupted, the session is closed");
+        cleanup();
+        return;
+    }
+    int reset_ret_code = resetMailTransaction();
+    if (reset_ret_code == STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED) {
+        mTransactionResetRequired = false;
+    } else if (mConnectionOpened) {
+        // The state of the session is unknown
+        cleanup();
+    }
+}
+
+int SMTPClientBase::resetMailTransaction() {
+    std::string rset_command { "RSET\r\n" };
+    addCommunicationLogItem(rset_command.c_str());
+    return (*this.*sendCommandWithFeedbackPtr)(rset_command.c_str(), CLIENT_SENDMAIL_RSET_ERROR, CLIENT_SENDMAIL_RSET_TIMEOUT);
+}
+
+int SMTPClientBase::sendQuitCommand() {
+    std::string quit_command { "QUIT\r\n" };
+    addCommunicationLogItem(quit_command.c_str());
+    return (*this.*sendCommandPtr)(quit_command.c_str(), CLIENT_SENDMAIL_QUIT_ERROR);
+}
+
+int SMTPClientBase::initializeSession() {
+    mCommunicationLog.clear();
+    mReplyReader.clear();
+
+    if (mTransport != nullptr) {
+        return initializeSessionTransport();
+    }
+#ifdef _WIN32
+    return initializeSessionWinSock();
+#else
+    return initializeSessionPOSIX();
+#endif
+}
+
+unsigned int SMTPClientBase::getConnectTimeoutInMilliseconds() const {
+    return limitToOperationDeadline(mTransportOptions.ConnectTimeoutInMilliseconds > 0 ?
+        mTransportOptions.ConnectTimeoutInMilliseconds : mCommandTimeOutInMilliseconds);
+}
+
+int SMTPClientBase::initializeSessionTransport() {
+    std::stringstream ss;
+    ss << "Trying to connect to " << getServerName() << " on port " << getServerPort() << " through the transport";
+    addCommunicationLogItem(ss.str().c_str());
+    int open_ret_code = mTransport->open(getServerName(), getServerPort(), getConnectTimeoutInMilliseconds());
+    if (open_ret_code != 0) {
+        setLastSocketErrNo(mTransport->getLastError());
+        mTransport->close();
+        return open_ret_code;
+    }
+    // A transport without a socket is marked by the descriptor 0 like a
+    // closed session
+    int transport_socket = mTransport->getSocketFileDescriptor();
+    mSock = transport_socket >= 0 ? transport_socket : 0;
+    return 0;
+}
+
+#ifdef _WIN32
+int SMTPClientBase::initializeSessionWinSock() {
+    // Windows Sockets version
+    WSADATA wsaData;
+    WORD wVersionRequested = MAKEWORD(2, 2);
+    int wsa_retVal = WSAStartup(wVersionRequested, &wsaData);
+    if (wsa_retVal != 0) {
+        std::stringstream ssError;
+        setLastSocketErrNo(wsa_retVal);
+        ssError << "WSAStartup failed with error: " << wsa_retVal;
+        addCommunicationLogItem(ssError.str().c_str());
+        return SOCKET_INIT_SESSION_WINSOCKET_STARTUP_ERROR;
+    }
+    mWSAStarted = true;
+    std::vector<ResolvedAddress> addresses;
+    wsa_retVal = DnsResolver::getDefault().resolve(getServerName(), getServerPort(), addresses);
+    if (wsa_retVal != 0) {
+        addWSAMessageToCommunicationLog(wsa_retVal);
+        setLastSocketErrNo(wsa_retVal);
+        doWSACleanup();
+        return SOCKET_INIT_SESSION_WINSOCKET_GETADDRINFO_ERROR;
+    }
+
+    std::stringstream ss;
+    ss << "Trying to connect to " << getServerName() << " on port " << getServerPort();
+    addCommunicationLogItem(ss.str().c_str());
+    // Try the addresses in turn, alternating the address families
+    int return_code = SOCKET_INIT_SESSION_CONNECT_ERROR;
+    for (const ResolvedAddress &address : addresses) {
+        SOCKET attempt_socket = socket(address.Family, address.SocketType, address.Protocol);
+        if (attempt_socket == INVALID_SOCKET) {
+            int wsa_error = WSAGetLastError();
+            addWSAMessageToCommunicationLog(wsa_error);
+            setLastSocketErrNo(wsa_error);
+            return_code = SOCKET_INIT_SESSION_CREATION_ERROR;
+            continue;
+        }
+        applySocketOptions(attempt_socket, mTransportOptions);
+        wsa_retVal = ::connect(attempt_socket, reinterpret_cast<const struct sockaddr*>(address.Address.data()),
+                static_cast<int>(address.AddressLength));
+        if (wsa_retVal == SOCKET_ERROR) {
+            int wsa_error = WSAGetLastError();
+            addWSAMessageToCommunicationLog(wsa_error);
+            setLastSocketErrNo(wsa_error);
+            closesocket(attempt_socket);
+            return_code = SOCKET_INIT_SESSION_CONNECT_ERROR;
+            continue;
+        }
+        mSock = static_cast<unsigned int>(attempt_socket);
+        return 0;
+    }
+    doWSACleanup();
+    return return_code;
+}
+
+bool SMTPClientBase::isWSAStarted() {
+    return mWSAStarted;
+};
+
+void SMTPClientBase::setWSAStopped() {
+    mWSAStarted = false;
+};
+
+void SMTPClientBase::addWSAMessageToCommunicationLog(const int errorCode) {
+    LPTSTR formattedErrorMessage = nullptr;
+    if(FormatMessage( FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_MAX_WIDTH_MASK,
+        nullptr,
+        errorCode,
+        0,
+        (LPTSTR)&formattedErrorMessage,
+        0,
+        nullptr) != 0) {
+        addCommunicationLogItem(formattedErrorMessage);
+        LocalFree(formattedErrorMessage);
     }
 }
 
@@ -440,75 +1270,123 @@ void SMTPClientBase::doWSACleanup() {
 #else
 int SMTPClientBase::initializeSessionPOSIX() {
     // POSIX socket version
-    fd_set fdset;
-    struct timeval tv;
-    socklen_t lon;
-    int valopt;
-    mSock = socket(AF_INET, SOCK_STREAM, 0);
-    if (mSock < 0) {
-        setLastSocketErrNo(errno);
-        addCommunicationLogItem(strerror(errno));
-        return SOCKET_INIT_SESSION_CREATION_ERROR;
-    }
-    struct hostent *host = gethostbyname(getServerName());
-    if (!host || host->h_length < 0) {
+    std::vector<ResolvedAddress> addresses;
+    int resolve_result = DnsResolver::getDefault().resolve(getServerName(), getServerPort(), addresses);
+    if (resolve_result != 0) {
+        addCommunicationLogItem(gai_strerror(resolve_result));
         return SOCKET_INIT_SESSION_GETHOSTBYNAME_ERROR;
     }
-    struct sockaddr_in saddr_in {};
-    saddr_in.sin_family = AF_INET;
-    saddr_in.sin_port = htons(static_cast<u_short>(getServerPort()));
-    saddr_in.sin_addr.s_addr = 0;
-    memcpy(reinterpret_cast<char*>(&(saddr_in.sin_addr)),
-           host->h_addr,
-           static_cast<size_t>(host->h_length));
-    // Set non-blocking
-    if (int socketSetFlagsResult = setSocketToNonBlockingPOSIX() != 0) {
-        return socketSetFlagsResult;
-    }
     std::stringstream ss;
     ss << "Trying to connect to " << getServerName() << " on port " << getServerPort();
     addCommunicationLogItem(ss.str().c_str());
-    int res = connect(mSock, reinterpret_cast<struct sockaddr*>(&saddr_in), sizeof(saddr_in));
-    if (res < 0) {
-        if (errno == EINPROGRESS) {
-            do {
-                tv.tv_sec = mCommandTimeOut;
-                tv.tv_usec = 0;
-                FD_ZERO(&fdset);
-                FD_SET(mSock, &fdset);
-                res = select(mSock+1, NULL, &fdset, NULL, &tv);
-                if (res < 0 && errno != EINTR) {
-                    setLastSocketErrNo(errno);
-                    addCommunicationLogItem(strerror(errno));
-                    return SOCKET_INIT_SESSION_CONNECT_ERROR;
-                } else if (res > 0) {
-                    // Socket selected for write
-                    lon = sizeof(int);
-                    if (getsockopt(mSock,
-                                   SOL_SOCKET,
-                                   SO_ERROR,
-                                   static_cast<void*>(&valopt), &lon) < 0) {
-                        setLastSocketErrNo(errno);
-                        addCommunicationLogItem(strerror(errno));
-                        return SOCKET_INIT_SESSION_GET_SOCKET_OPTIONS_ERROR;
-                    }
-                    // Check the value returned...
-                    if (valopt) {
-                        setLastSocketErrNo(valopt);
-                        addCommunicationLogItem(strerror(valopt));
-                        return SOCKET_INIT_SESSION_DELAYED_CONNECTION_ERROR;
-                    }
-                    break;
-                } else {
-                    return SOCKET_INIT_SESSION_CONNECT_TIMEOUT;
-                }
-            } while (1);
-        } else {
-            setLastSocketErrNo(errno);
-            addCommunicationLogItem(strerror(errno));
-            return SOCKET_INIT_SESSION_CONNECT_ERROR;
+
+    // Happy Eyeballs (RFC 8305): the next address is tried when the previous
+    // attempt fails or after the Connection Attempt Delay, and the first
+    // connection established wins. poll is used instead of select since the
+    // descriptors can exceed FD_SETSIZE in a process with many connections.
+    const auto CONNECTION_ATTEMPT_DELAY = std::chrono::milliseconds(250);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(getConnectTimeoutInMilliseconds());
+    auto next_attempt_time = std::chrono::steady_clock::now();
+    std::vector<struct pollfd> attempts;
+    size_t next_address = 0;
+    int connected_socket = -1;
+    int return_code = SOCKET_INIT_SESSION_CONNECT_TIMEOUT;
+    int last_error = 0;
+    auto recordFailure = [this, &return_code, &last_error](int pReturnCode, int pError) {
+        return_code = pReturnCode;
+        last_error = pError;
+        addCommunicationLogItem(strerror(pError));
+    };
+    while (connected_socket < 0) {
+        auto now = std::chrono::steady_clock::now();
+        if (next_address < addresses.size() && (attempts.empty() || now >= next_attempt_time)) {
+            const ResolvedAddress &address = addresses[next_address++];
+            int attempt_socket = socket(address.Family, address.SocketType, address.Protocol);
+            if (attempt_socket < 0) {
+                recordFailure(SOCKET_INIT_SESSION_CREATION_ERROR, errno);
+                continue;
+            }
+            int flags = fcntl(attempt_socket, F_GETFL, NULL);
+            if (flags < 0 || fcntl(attempt_socket, F_SETFL, flags | O_NONBLOCK) < 0) {
+                recordFailure(flags < 0 ? SOCKET_INIT_SESSION_FCNTL_GET_ERROR : SOCKET_INIT_SESSION_FCNTL_SET_ERROR, errno);
+                close(attempt_socket);
+                continue;
+            }
+            applySocketOptions(attempt_socket, mTransportOptions);
+            if (::connect(attempt_socket, reinterpret_cast<const struct sockaddr*>(address.Address.data()),
+                    static_cast<socklen_t>(address.AddressLength)) == 0) {
+                connected_socket = attempt_socket;
+                break;
+            }
+            if (errno != EINPROGRESS) {
+                recordFailure(SOCKET_INIT_SESSION_CONNECT_ERROR, errno);
+                close(attempt_socket);
+                continue;
+            }
+            struct pollfd attempt {};
+            attempt.fd = attempt_socket;
+            attempt.events = POLLOUT;
+            attempts.push_back(attempt);
+            next_attempt_time = now + CONNECTION_ATTEMPT_DELAY;
+        }
+        if (attempts.empty()) {
+            if (next_address >= addresses.size()) {
+                break;
+            }
+            continue;
+        }
+        now = std::chrono::steady_clock::now();
+        if (now >= deadline || isOperationInterrupted()) {
+            return_code = SOCKET_INIT_SESSION_CONNECT_TIMEOUT;
+            break;
+        }
+        auto wait_until = deadline;
+        if (next_address < addresses.size() && next_attempt_time < wait_until) {
+            wait_until = next_attempt_time;
+        }
+        if (mCancellationToken != nullptr) {
+            wait_until = (std::min)(wait_until, now + std::chrono::milliseconds(CancellationToken::CHECK_INTERVAL_IN_MILLISECONDS));
         }
+        const auto wait_time = std::chrono::duration_cast<std::chrono::milliseconds>(wait_until - now).count() + 1;
+        const nfds_t attempt_count = attempts.size();
+        int res = poll(attempts.data(), attempt_count, static_cast<int>(wait_time));
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            recordFailure(SOCKET_INIT_SESSION_CONNECT_ERROR, errno);
+            break;
+        }
+        for (size_t index = attempts.size(); index-- > 0 && connected_socket < 0;) {
+            if (attempts[index].revents == 0) {
+                continue;
+            }
+            // Socket ready for write, check the result of the connection
+            int valopt = 0;
+            socklen_t lon = sizeof(int);
+            if (getsockopt(attempts[index].fd, SOL_SOCKET, SO_ERROR, static_cast<void*>(&valopt), &lon) < 0) {
+                recordFailure(SOCKET_INIT_SESSION_GET_SOCKET_OPTIONS_ERROR, errno);
+            } else if (valopt) {
+                recordFailure(SOCKET_INIT_SESSION_DELAYED_CONNECTION_ERROR, valopt);
+            } else {
+                connected_socket = attempts[index].fd;
+                attempts.erase(attempts.begin() + static_cast<std::ptrdiff_t>(index));
+                break;
+            }
+            close(attempts[index].fd);
+            attempts.erase(attempts.begin() + static_cast<std::ptrdiff_t>(index));
+            // Start the next attempt without waiting for the delay
+            next_attempt_time = now;
+        }
+    }
+    for (const auto &attempt : attempts) {
+        close(attempt.fd);
     }
+    if (connected_socket < 0) {
+        setLastSocketErrNo(last_error);
+        return return_code;
+    }
+    mSock = connected_socket;
     // Set to blocking mode again...
     return setSocketToBlockingPOSIX();
 }
@@ -548,24 +1426,16 @@ int SMTPClientBase::setSocketToBlockingPOSIX() {
 int SMTPClientBase::sendServerIdentification() {
     std::string ehlo { "ehlo localhost\r\n" };
     addCommunicationLogItem(ehlo.c_str());
-    return sendRawCommand(ehlo.c_str(),
+    int ehlo_ret_code = sendRawCommand(ehlo.c_str(),
             SOCKET_INIT_CLIENT_SEND_EHLO_ERROR,
             SOCKET_INIT_CLIENT_SEND_EHLO_TIMEOUT);
+    setServerCapabilities(resolveServerCapabilities(false));
+    return ehlo_ret_code;
 }
 
 int SMTPClientBase::checkServerGreetings() {
-    char outbuf[SERVERRESPONSE_BUFFER_LENGTH];
-    unsigned int waitTime = 0;
-    ssize_t bytes_received = 0;
-    while ((bytes_received = recv(mSock, outbuf, SERVERRESPONSE_BUFFER_LENGTH, 0)) <= 0
-            && waitTime < mCommandTimeOut) {
-        sleep(1);
-        waitTime += 1;
-    }
-    if (waitTime < mCommandTimeOut) {
-        outbuf[bytes_received-1] = '\0';
-        addCommunicationLogItem(outbuf, "s");
-        int status_code = extractReturnCode(outbuf);
+    if (readRawServerReply()) {
+        int status_code = mReplyReader.getCode();
         if (status_code == STATUS_CODE_SERVICE_READY) {
             addCommunicationLogItem("Connected!");
         }
@@ -575,6 +1445,20 @@ int SMTPClientBase::checkServerGreetings() {
 }
 
 int SMTPClientBase::sendRawCommand(const char *pCommand, int pErrorCode) {
+    if (isOperationInterrupted()) {
+        cleanup();
+        return pErrorCode;
+    }
+    if (mTransport != nullptr) {
+        std::string_view segment { pCommand };
+        if (mTransport->write(&segment, 1) != 0) {
+            setLastSocketErrNo(mTransport->getLastError());
+            cleanup();
+            return pErrorCode;
+        }
+        countWrite(segment.length());
+        return 0;
+    }
 #ifdef _WIN32
     size_t pCommandSize = strlen(pCommand);
     if (static_cast<intmax_t>(pCommandSize) > (std::numeric_limits<int>::max)()) {
@@ -584,47 +1468,374 @@ int SMTPClientBase::sendRawCommand(const char *pCommand, int pErrorCode) {
 #else
     size_t commandSize = strlen(pCommand);
 #endif
-    if (send(mSock, pCommand, commandSize, 0) == -1) {
+    if (send(mSock, pCommand, commandSize, SEND_FLAGS) == -1) {
         setLastSocketErrNo(errno);
         cleanup();
         return pErrorCode;
     }
+    countWrite(strlen(pCommand));
     return 0;
 }
 
 int SMTPClientBase::sendRawCommand(const char *pCommand, int pErrorCode, int pTimeoutCode) {
-    char outbuf[SERVERRESPONSE_BUFFER_LENGTH];
-    unsigned int waitTime {0};
-    ssize_t bytes_received {0};
     if (sendRawCommand(pCommand, pErrorCode) != 0) {
         return pErrorCode;
     }
 
-    while ((bytes_received = recv(mSock, outbuf, SERVERRESPONSE_BUFFER_LENGTH, 0)) <= 0 && waitTime < mCommandTimeOut) {
-        sleep(1);
-        waitTime += 1;
+    if (readRawServerReply()) {
+        return mReplyReader.getCode();
     }
-    if (waitTime < mCommandTimeOut) {
-        outbuf[bytes_received-1] = '\0';
-        setLastServerResponse(outbuf);
-        addCommunicationLogItem(outbuf, "s");
-        return extractReturnCode(outbuf);
+
+    cleanup();
+    return pTimeoutCode;
+}
+
+int SMTPClientBase::sendRawDataSegments(const std::string_view *pSegments, size_t pSegmentCount, int pErrorCode) {
+    if (isOperationInterrupted()) {
+        cleanup();
+        return pErrorCode;
+    }
+    if (mTransport != nullptr) {
+        // The transport receives the whole batch and splits it as it needs
+        if (mTransport->write(pSegments, pSegmentCount) != 0) {
+            setLastSocketErrNo(mTransport->getLastError());
+            cleanup();
+            return pErrorCode;
+        }
+        size_t length = 0;
+        for (size_t i = 0; i < pSegmentCount; i++) {
+            length += pSegments[i].length();
+        }
+        countWrite(length);
+        return 0;
+    }
+    const size_t MAX_BUFFERS_PER_WRITE = 64;
+    size_t segment_index = 0;
+    size_t segment_offset = 0;
+    while (segment_index < pSegmentCount) {
+        // Gather the pending segments, the first one may be partially sent
+#ifdef _WIN32
+        WSABUF buffers[MAX_BUFFERS_PER_WRITE];
+#else
+        struct iovec buffers[MAX_BUFFERS_PER_WRITE];
+#endif
+        size_t buffer_count = 0;
+        size_t write_length = 0;
+        size_t index = segment_index;
+        size_t offset = segment_offset;
+        while (index < pSegmentCount && buffer_count < MAX_BUFFERS_PER_WRITE && write_length < mTransportOptions.WriteSize) {
+            size_t length = (std::min)(pSegments[index].length() - offset, mTransportOptions.WriteSize - write_length);
+            if (length > 0) {
+#ifdef _WIN32
+                buffers[buffer_count].buf = const_cast<char *>(pSegments[index].data() + offset);
+                buffers[buffer_count].len = static_cast<ULONG>(length);
+#else
+                buffers[buffer_count].iov_base = const_cast<char *>(pSegments[index].data() + offset);
+                buffers[buffer_count].iov_len = length;
+#endif
+                buffer_count++;
+                write_length += length;
+            }
+            offset += length;
+            if (offset == pSegments[index].length()) {
+                index++;
+                offset = 0;
+            }
+        }
+        if (buffer_count == 0) {
+            break;
+        }
+        // A large content is interrupted between its writes
+        if (segment_index > 0 || segment_offset > 0) {
+            if (isOperationInterrupted()) {
+                cleanup();
+                return pErrorCode;
+            }
+        }
+
+#ifdef _WIN32
+        DWORD bytes_sent = 0;
+        if (WSASend(static_cast<SOCKET>(mSock), buffers, static_cast<DWORD>(buffer_count), &bytes_sent, 0, nullptr, nullptr) == SOCKET_ERROR) {
+            setLastSocketErrNo(WSAGetLastError());
+            cleanup();
+            return pErrorCode;
+        }
+#else
+        struct msghdr message {};
+        message.msg_iov = buffers;
+        message.msg_iovlen = buffer_count;
+        ssize_t bytes_sent = sendmsg(mSock, &message, SEND_FLAGS);
+        if (bytes_sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            setLastSocketErrNo(errno);
+            cleanup();
+            return pErrorCode;
+        }
+#endif
+        // Skip what has been sent, the write may have been partial
+        size_t remaining = static_cast<size_t>(bytes_sent);
+        countWrite(remaining);
+        while (segment_index < pSegmentCount) {
+            size_t available = pSegments[segment_index].length() - segment_offset;
+            if (remaining < available) {
+                segment_offset += remaining;
+                break;
+            }
+            remaining -= available;
+            segment_index++;
+            segment_offset = 0;
+        }
+    }
+    return 0;
+}
+
+int SMTPClientBase::sendDataSegments(const std::string_view *pSegments, size_t pSegmentCount, int pErrorCode) {
+    return sendRawDataSegments(pSegments, pSegmentCount, pErrorCode);
+}
+
+int SMTPClientBase::sendDataSegmentsWithFeedback(const std::string_view *pSegments,
+        size_t pSegmentCount,
+        int pErrorCode,
+        int pTimeoutCode) {
+    int send_ret_code = (*this.*sendDataSegmentsPtr)(pSegments, pSegmentCount, pErrorCode);
+    if (send_ret_code != 0) {
+        return send_ret_code;
+    }
+
+    if (readServerReply()) {
+        return mReplyReader.getCode();
     }
 
     cleanup();
     return pTimeoutCode;
 }
 
+int SMTPClientBase::waitForSocketData(unsigned int pTimeoutInMilliseconds) {
+    countWait();
+    const unsigned int timeout = limitToOperationDeadline(pTimeoutInMilliseconds);
+    if (mCancellationToken == nullptr) {
+        const int res = pollSocketData(timeout);
+        if (res == 0 && timeout < pTimeoutInMilliseconds) {
+            // The wait has been cut by the deadline
+            mOperationInterrupted = true;
+        }
+        return res;
+    }
+    // The wait is split to check the token between the polls
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    for (;;) {
+        if (isOperationInterrupted()) {
+            return 0;
+        }
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        const unsigned int poll_timeout = remaining <= 0 ? 0 :
+            static_cast<unsigned int>((std::min)(remaining, static_cast<std::remove_const_t<decltype(remaining)>>(CancellationToken::CHECK_INTERVAL_IN_MILLISECONDS)));
+        const int res = pollSocketData(poll_timeout);
+        if (res != 0 || remaining <= 0) {
+            if (res == 0 && timeout < pTimeoutInMilliseconds) {
+                mOperationInterrupted = true;
+            }
+            return res;
+        }
+    }
+}
+
+int SMTPClientBase::pollSocketData(unsigned int pTimeoutInMilliseconds) {
+    const int timeout = pTimeoutInMilliseconds > static_cast<unsigned int>((std::numeric_limits<int>::max)())
+        ? (std::numeric_limits<int>::max)()
+        : static_cast<int>(pTimeoutInMilliseconds);
+    if (mTransport != nullptr) {
+        int res = mTransport->waitForData(pTimeoutInMilliseconds);
+        if (res < 0) {
+            setLastSocketErrNo(mTransport->getLastError());
+        }
+        return res;
+    }
+#ifdef _WIN32
+    WSAPOLLFD fds {};
+    fds.fd = static_cast<SOCKET>(mSock);
+    fds.events = POLLRDNORM;
+    int res = WSAPoll(&fds, 1, timeout);
+    if (res == SOCKET_ERROR) {
+        setLastSocketErrNo(WSAGetLastError());
+        return -1;
+    }
+#else
+    struct pollfd fds {};
+    fds.fd = mSock;
+    fds.events = POLLIN;
+    int res;
+    do {
+        res = poll(&fds, 1, timeout);
+    } while (res < 0 && errno == EINTR);
+    if (res < 0) {
+        setLastSocketErrNo(errno);
+        return -1;
+    }
+#endif
+    return res;
+}
+
+int SMTPClientBase::receiveRawData(char *pBuffer, size_t pLength, unsigned int pTimeoutInMilliseconds) {
+    int wait_ret_code = waitForSocketData(pTimeoutInMilliseconds);
+    if (wait_ret_code <= 0) {
+        return wait_ret_code;
+    }
+    if (mTransport != nullptr) {
+        int bytes_received = mTransport->read(pBuffer, pLength);
+        if (bytes_received <= 0) {
+            setLastSocketErrNo(mTransport->getLastError());
+            return -1;
+        }
+        countRead(static_cast<size_t>(bytes_received));
+        return bytes_received;
+    }
+#ifdef _WIN32
+    int bytes_received = recv(mSock, pBuffer, static_cast<int>(pLength), 0);
+    if (bytes_received <= 0) {
+        setLastSocketErrNo(WSAGetLastError());
+        return -1;
+    }
+    countRead(static_cast<size_t>(bytes_received));
+    return bytes_received;
+#else
+    ssize_t bytes_received = recv(mSock, pBuffer, pLength, 0);
+    if (bytes_received <= 0) {
+        setLastSocketErrNo(errno);
+        return -1;
+    }
+    countRead(static_cast<size_t>(bytes_received));
+    return static_cast<int>(bytes_received);
+#endif
+}
+
+int SMTPClientBase::receiveData(char *pBuffer, size_t pLength, unsigned int pTimeoutInMilliseconds) {
+    return receiveRawData(pBuffer, pLength, pTimeoutInMilliseconds);
+}
+
+bool SMTPClientBase::readServerReply() {
+    return readServerReply(receiveDataPtr);
+}
+
+bool SMTPClientBase::readRawServerReply() {
+    return readServerReply(&SMTPClientBase::receiveRawData);
+}
+
+bool SMTPClientBase::readServerReply(int (SMTPClientBase::*pReceiveData)(char *pBuffer, size_t pLength, unsigned int pTimeoutInMilliseconds)) {
+    // The buffer is kept between the replies
+    mReadBuffer.resize(mTransportOptions.ReadBufferSize);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(mCommandTimeOutInMilliseconds);
+    // The data of the next replies can already be buffered (pipelining)
+    while (!mReplyReader.nextReply()) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        int bytes_received = (*this.*pReceiveData)(mReadBuffer.data(),
+                mReadBuffer.size(),
+                static_cast<unsigned int>((std::max)(remaining, static_cast<decltype(remaining)>(0))));
+        if (bytes_received <= 0) {
+            return false;
+        }
+        mReplyReader.append(mReadBuffer.data(), static_cast<size_t>(bytes_received));
+    }
+    // Assigned in place so that the buffers of the client are reused
+    mLastServerResponse.assign(mReplyReader.getText());
+    mLastEnhancedStatusCode.assign(mReplyReader.getEnhancedStatusCode());
+    addCommunicationLogItem(mLastServerResponse.c_str(), "s");
+    if (mSessionTrace != nullptr) {
+        mSessionTrace->recordReply(mReplyReader.getCode());
+    }
+    if (mSessionObserver != nullptr) {
+        mSessionObserver->onReplyReceived(mReplyReader.getCode());
+    }
+    return true;
+}
+
+const ServerReplyReader &SMTPClientBase::getServerReplyReader() const {
+    return mReplyReader;
+}
+
+void SMTPClientBase::discardPendingServerData() {
+    mReplyReader.clear();
+}
+
+int SMTPClientBase::readPipelinedResponses(size_t pCount,
+        std::vector<int> &pReturnCodes,
+        int pTimeoutCode,
+        std::vector<std::string> *pEnhancedStatusCodes) {
+    pReturnCodes.clear();
+    if (pEnhancedStatusCodes != nullptr) {
+        pEnhancedStatusCodes->clear();
+    }
+    while (pReturnCodes.size() < pCount) {
+        if (!readServerReply()) {
+            cleanup();
+            return pTimeoutCode;
+        }
+        pReturnCodes.push_back(mReplyReader.getCode());
+        if (pEnhancedStatusCodes != nullptr) {
+            pEnhancedStatusCodes->emplace_back(mReplyReader.getEnhancedStatusCode());
+        }
+    }
+    return 0;
+}
+
+void SMTPClientBase::startOperation() {
+    mOperationDeadline = mOperationTimeoutInMilliseconds > 0 ?
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(mOperationTimeoutInMilliseconds) :
+        std::chrono::steady_clock::time_point::max();
+    mOperationInterrupted = false;
+}
+
+bool SMTPClientBase::isOperationInterrupted() {
+    if (!mOperationInterrupted) {
+        mOperationInterrupted = (mCancellationToken != nullptr && mCancellationToken->isCancelled()) ||
+            (mOperationDeadline != std::chrono::steady_clock::time_point::max() &&
+             std::chrono::steady_clock::now() >= mOperationDeadline);
+    }
+    return mOperationInterrupted;
+}
+
+int SMTPClientBase::finishOperation(int pReturnCode) {
+    if (pReturnCode == 0 || !mOperationInterrupted) {
+        return pReturnCode;
+    }
+    if (mCancellationToken != nullptr && mCancellationToken->isCancelled()) {
+        return CLIENT_OPERATION_CANCELLED_ERROR;
+    }
+    return CLIENT_OPERATION_DEADLINE_EXCEEDED_ERROR;
+}
+
+unsigned int SMTPClientBase::limitToOperationDeadline(unsigned int pTimeoutInMilliseconds) const {
+    if (mOperationDeadline == std::chrono::steady_clock::time_point::max()) {
+        return pTimeoutInMilliseconds;
+    }
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+            mOperationDeadline - std::chrono::steady_clock::now()).count();
+    if (remaining <= 0) {
+        return 0;
+    }
+    return static_cast<unsigned int>((std::min)(remaining, static_cast<std::remove_const_t<decltype(remaining)>>(pTimeoutInMilliseconds)));
+}
+
 void SMTPClientBase::setLastServerResponse(const char *pResponse) {
-    delete[] mLastServerResponse;
-    size_t response_len = strlen(pResponse);
-    mLastServerResponse = new char[response_len + 1];
-    strncpy(mLastServerResponse, pResponse, response_len);
-    mLastServerResponse[response_len] = '\0';
+    mLastServerResponse = pResponse;
 }
 
 int SMTPClientBase::authenticateClient() {
     if (mCredential != nullptr) {
+        if (mAuthOptions == nullptr) {
+            return CLIENT_AUTHENTICATION_METHOD_NOTSUPPORTED;
+        }
+        if (mCredential->getTokenSource() != nullptr) {
+            if (mAuthOptions->XOAuth2) {
+                return authenticateWithToken(OAuth2Mechanism::XOAuth2);
+            }
+            if (mAuthOptions->OAuthBearer) {
+                return authenticateWithToken(OAuth2Mechanism::OAuthBearer);
+            }
+            return CLIENT_AUTHENTICATION_METHOD_NOTSUPPORTED;
+        }
         if (mAuthOptions->Plain) {
             return authenticateWithMethodPlain();
         }
@@ -638,16 +1849,16 @@ int SMTPClientBase::authenticateClient() {
 
 int SMTPClientBase::authenticateWithMethodPlain() {
     addCommunicationLogItem("AUTH PLAIN ***************\r\n");
-    std::stringstream ss_credentials;
-    // Format : \0username\0password
-    ss_credentials << '\0' << mCredential->getUsername() << '\0' << mCredential->getPassword();
-    std::string str_credentials = ss_credentials.str();
-    std::stringstream ss;
-    ss << "AUTH PLAIN "
-        << Base64::Encode(reinterpret_cast<const unsigned char*>(str_credentials.c_str()),
-                strlen(mCredential->getUsername()) + strlen(mCredential->getPassword()) + 2)  // + 2 for the two null characters
-        << "\r\n";
-    return (*this.*sendCommandWithFeedbackPtr)(ss.str().c_str(), CLIENT_AUTHENTICATE_ERROR, CLIENT_AUTHENTICATE_TIMEOUT);
+    if (mPlainAuthCommand.empty()) {
+        // Format : \0username\0password
+        std::string str_credentials;
+        str_credentials.reserve(strlen(mCredential->getUsername()) + strlen(mCredential->getPassword()) + 2);
+        str_credentials.append(1, '\0').append(mCredential->getUsername()).append(1, '\0').append(mCredential->getPassword());
+        mPlainAuthCommand = "AUTH PLAIN "s
+            + Base64::Encode(reinterpret_cast<const unsigned char*>(str_credentials.data()), str_credentials.size())
+            + "\r\n"s;
+    }
+    return (*this.*sendCommandWithFeedbackPtr)(mPlainAuthCommand.c_str(), CLIENT_AUTHENTICATE_ERROR, CLIENT_AUTHENTICATE_TIMEOUT);
 }
 
 int SMTPClientBase::authenticateWithMethodLogin() {
@@ -659,32 +1870,106 @@ int SMTPClientBase::authenticateWithMethodLogin() {
         return CLIENT_AUTHENTICATE_ERROR;
     }
 
-    std::string encoded_username { Base64::Encode(reinterpret_cast<const unsigned char*>(mCredential->getUsername()),
-            strlen(mCredential->getUsername())) };
-    std::stringstream ss_username;
-    ss_username << encoded_username << "\r\n";
-    int username_return_code = (*this.*sendCommandWithFeedbackPtr)(ss_username.str().c_str(),
+    const std::string encoded_username { Base64::Encode(reinterpret_cast<const unsigned char*>(mCredential->getUsername()),
+            strlen(mCredential->getUsername())) + "\r\n"s };
+    int username_return_code = (*this.*sendCommandWithFeedbackPtr)(encoded_username.c_str(),
             CLIENT_AUTHENTICATE_ERROR,
             CLIENT_AUTHENTICATE_TIMEOUT);
     if (username_return_code != STATUS_CODE_SERVER_CHALLENGE) {
         return CLIENT_AUTHENTICATE_ERROR;
     }
-    std::string encoded_password { Base64::Encode(reinterpret_cast<const unsigned char*>(mCredential->getPassword()),
-            strlen(mCredential->getPassword())) };
-    std::stringstream ss_password;
-    ss_password << encoded_password << "\r\n";
-    return (*this.*sendCommandWithFeedbackPtr)(ss_password.str().c_str(), CLIENT_AUTHENTICATE_ERROR, CLIENT_AUTHENTICATE_TIMEOUT);
+    const std::string encoded_password { Base64::Encode(reinterpret_cast<const unsigned char*>(mCredential->getPassword()),
+            strlen(mCredential->getPassword())) + "\r\n"s };
+    return (*this.*sendCommandWithFeedbackPtr)(encoded_password.c_str(), CLIENT_AUTHENTICATE_ERROR, CLIENT_AUTHENTICATE_TIMEOUT);
+}
+
+int SMTPClientBase::authenticateWithToken(OAuth2Mechanism pMechanism) {
+    const std::shared_ptr<OAuth2TokenSource> token_source { mCredential->getTokenSource() };
+    const std::string mechanism_name { pMechanism == OAuth2Mechanism::XOAuth2 ? "XOAUTH2" : "OAUTHBEARER" };
+    int auth_return_code = CLIENT_AUTHENTICATE_ERROR;
+    // A token refused before its expiry (revoked) is replaced once, unless
+    // it has just been obtained
+    for (int attempt = 0; attempt < 2; attempt++) {
+        const size_t refresh_count { token_source->getRefreshCount() };
+        std::string initial_response;
+        if (token_source->getInitialResponse(pMechanism, mCredential->getUsername(), initial_response) != 0) {
+            return CLIENT_AUTHENTICATE_TOKEN_ERROR;
+        }
+        addCommunicationLogItem(("AUTH "s + mechanism_name + " ***************\r\n").c_str());
+        const std::string auth_command { "AUTH "s + mechanism_name + " "s + initial_response + "\r\n"s };
+        auth_return_code = (*this.*sendCommandWithFeedbackPtr)(auth_command.c_str(),
+                CLIENT_AUTHENTICATE_ERROR,
+                CLIENT_AUTHENTICATE_TIMEOUT);
+        if (auth_return_code == STATUS_CODE_SERVER_CHALLENGE) {
+            // The challenge carries the error details of the server, the
+            // exchange is ended by an empty response (XOAUTH2) or by the
+            // ^A response (OAUTHBEARER)
+            auth_return_code = (*this.*sendCommandWithFeedbackPtr)(pMechanism == OAuth2Mechanism::XOAuth2 ? "\r\n" : "AQ==\r\n",
+                    CLIENT_AUTHENTICATE_ERROR,
+                    CLIENT_AUTHENTICATE_TIMEOUT);
+        }
+        if (auth_return_code != SMTPSERVER_CREDENTIALSINVALID_ERROR) {
+            return auth_return_code;
+        }
+        if (token_source->getRefreshCount() != refresh_count) {
+            break;
+        }
+        token_source->invalidate();
+    }
+    return auth_return_code;
 }
 
-int SMTPClientBase::setMailRecipients(const Message &pMsg) {
+int SMTPClientBase::setMailRecipients(const Message &pMsg,
+        const MessageAddress *pRecipients,
+        size_t pRecipientCount,
+        const char *pMailParameters) {
+    std::vector<const char *> recipients;
+    if (pRecipients != nullptr) {
+        recipients.reserve(pRecipientCount);
+        for (size_t index = 0; index < pRecipientCount; index++) {
+            recipients.push_back(pRecipients[index].getEmailAddress());
+        }
+    } else {
+        // The To, Cc and Bcc recipients are read in order from the table
+        const RecipientTable &table = pMsg.getRecipients();
+        recipients.reserve(table.size());
+        for (size_t index = 0; index < table.size(); index++) {
+            recipients.push_back(table.getEmailAddress(index));
+        }
+    }
+    return setMailEnvelope(pMsg.getFrom().getEmailAddress(), pMsg.getFrom().getDisplayName(), recipients, pMailParameters);
+}
+
+int SMTPClientBase::setMailEnvelope(const char *pSenderAddress,
+        const char *pSenderDisplayName,
+        const std::vector<const char *> &pRecipientAddresses,
+        const char *pMailParameters) {
+    // The ASCII envelopes are sent as they are
+    const std::vector<const char *> *recipient_addresses = &pRecipientAddresses;
+    bool ascii_envelope = StringUtils::isAscii(pSenderAddress);
+    for (size_t index = 0; ascii_envelope && index < pRecipientAddresses.size(); index++) {
+        ascii_envelope = StringUtils::isAscii(pRecipientAddresses[index]);
+    }
+    if (!ascii_envelope) {
+        int utf8_ret_code = prepareInternationalizedEnvelope(pSenderAddress, recipient_addresses, pMailParameters);
+        if (utf8_ret_code != 0) {
+            return utf8_ret_code;
+        }
+    }
+    if (mPipeliningEnabled && mServerCapabilities.Pipelining) {
+        return setMailEnvelopePipelined(pSenderAddress, *recipient_addresses, pMailParameters);
+    }
     const int INVALID_ADDRESS { 501 };
     const int SENDER_OK { 250 };
     const int RECIPIENT_OK { 250 };
+    const std::string parameters { pMailParameters != nullptr ? " "s + pMailParameters : ""s };
     std::vector<std::string> mailFormats;
     // Method 1, 2 and 3
-    mailFormats.push_back("MAIL FROM: <"s + pMsg.getFrom().getDisplayName() + " " + pMsg.getFrom().getEmailAddress() + ">\r\n"s);
-    mailFormats.push_back("MAIL FROM: "s + pMsg.getFrom().getEmailAddress() + "\r\n"s);
-    mailFormats.push_back("MAIL FROM: <"s + pMsg.getFrom().getEmailAddress() + ">\r\n"s);
+    if (pSenderDisplayName != nullptr) {
+        mailFormats.push_back("MAIL FROM: <"s + pSenderDisplayName + " " + pSenderAddress + ">"s + parameters + "\r\n"s);
+    }
+    mailFormats.push_back("MAIL FROM: "s + pSenderAddress + parameters + "\r\n"s);
+    mailFormats.push_back("MAIL FROM: <"s + pSenderAddress + ">"s + parameters + "\r\n"s);
 
 
     int mail_from_ret_code { 0 };
@@ -705,250 +1990,692 @@ int SMTPClientBase::setMailRecipients(const Message &pMsg) {
     }
 
     // Send command for the recipients
-    std::vector<std::pair<MessageAddress **, size_t>> recipients {
-        std::pair<MessageAddress **, size_t>(pMsg.getTo(), pMsg.getToCount()),
-            std::pair<MessageAddress **, size_t>(pMsg.getCc(), pMsg.getCcCount()),
-            std::pair<MessageAddress **, size_t>(pMsg.getBcc(), pMsg.getBccCount())
-    };
-    for (const auto &item : recipients) {
-        if (item.first != nullptr) {
-            int rcpt_to_ret_code = addMailRecipients(item.first, item.second, RECIPIENT_OK);
-            if (rcpt_to_ret_code != RECIPIENT_OK) {
-                return rcpt_to_ret_code;
-            }
+    mRecipientResults.assign(recipient_addresses->size(), RecipientResult());
+    if (!recipient_addresses->empty()) {
+        int rcpt_to_ret_code = addMailRecipients(*recipient_addresses, RECIPIENT_OK);
+        if (rcpt_to_ret_code != RECIPIENT_OK) {
+            return rcpt_to_ret_code;
         }
     }
     return 0;
 }
 
-int SMTPClientBase::addMailRecipients(jed_utils::MessageAddress **list, size_t count, const int RECIPIENT_OK) {
+int SMTPClientBase::setMailEnvelopePipelined(const char *pSenderAddress,
+        const std::vector<const char *> &pRecipientAddresses,
+        const char *pMailParameters) {
+    const int SENDER_OK { 250 };
+    const int RECIPIENT_OK { 250 };
+    // The MAIL FROM and every RCPT TO commands are sent in a single write (RFC 2920).
+    // The DATA command is kept out of the group since it cannot be withdrawn once
+    // the server has accepted it, even if a recipient has been rejected.
+    std::string commands { "MAIL FROM: <"s + pSenderAddress + ">"s +
+        (pMailParameters != nullptr ? " "s + pMailParameters : ""s) + "\r\n"s };
+    addCommunicationLogItem(commands.c_str());
+    for (const char *address : pRecipientAddresses) {
+        const std::string &rcpt_to = buildRecipientCommand(address);
+        addCommunicationLogItem(rcpt_to.c_str());
+        commands += rcpt_to;
+    }
+    mRecipientResults.assign(pRecipientAddresses.size(), RecipientResult());
+    if ((*this.*sendCommandPtr)(commands.c_str(), CLIENT_SENDMAIL_MAILFROM_ERROR) != 0) {
+        return CLIENT_SENDMAIL_MAILFROM_ERROR;
+    }
+
+    // The replies of the recipients are read into the results of the
+    // transaction, the first rejection determines the return code
+    if (!readServerReply()) {
+        cleanup();
+        return CLIENT_SENDMAIL_RCPTTO_TIMEOUT;
+    }
+    const int mail_from_ret_code = mReplyReader.getCode();
+    RecipientResult sender_result;
+    int first_rejection = mail_from_ret_code != SENDER_OK ? mail_from_ret_code : 0;
+    if (first_rejection != 0) {
+        sender_result.ReplyCode = mail_from_ret_code;
+        mReplyReader.getEnhancedStatusCode().copy(sender_result.EnhancedStatusCode, RecipientResult::MAX_ENHANCED_STATUS_CODE_LENGTH);
+    }
+    for (size_t index = 0; index < pRecipientAddresses.size(); index++) {
+        if (!readServerReply()) {
+            cleanup();
+            return CLIENT_SENDMAIL_RCPTTO_TIMEOUT;
+        }
+        const int rcpt_to_ret_code = mReplyReader.getCode();
+        recordRecipientResult(index, rcpt_to_ret_code, mReplyReader.getEnhancedStatusCode());
+        if (first_rejection == 0 && rcpt_to_ret_code != RECIPIENT_OK) {
+            first_rejection = rcpt_to_ret_code;
+            sender_result = mRecipientResults[index];
+        }
+    }
+    mLastEnhancedStatusCode = sender_result.EnhancedStatusCode;
+    return first_rejection;
+}
+
+int SMTPClientBase::addMailRecipients(const std::vector<const char *> &pRecipientAddresses, const int RECIPIENT_OK) {
     int rcpt_to_ret_code = RECIPIENT_OK;
-    std::for_each(list, list + count, [this, &rcpt_to_ret_code, &RECIPIENT_OK](MessageAddress *address) {
-            std::stringstream ss_rcpt_to;
-            ss_rcpt_to << "RCPT TO: <"s << address->getEmailAddress() << ">\r\n"s;
-            addCommunicationLogItem(ss_rcpt_to.str().c_str());
-            int ret_code = (*this.*sendCommandWithFeedbackPtr)(ss_rcpt_to.str().c_str(), CLIENT_SENDMAIL_RCPTTO_ERROR, CLIENT_SENDMAIL_RCPTTO_TIMEOUT);
-            if (ret_code != RECIPIENT_OK) {
+    for (size_t index = 0; index < pRecipientAddresses.size(); index++) {
+        const std::string &rcpt_to = buildRecipientCommand(pRecipientAddresses[index]);
+        addCommunicationLogItem(rcpt_to.c_str());
+        mLastEnhancedStatusCode.clear();
+        int ret_code = (*this.*sendCommandWithFeedbackPtr)(rcpt_to.c_str(), CLIENT_SENDMAIL_RCPTTO_ERROR, CLIENT_SENDMAIL_RCPTTO_TIMEOUT);
+        recordRecipientResult(index, ret_code, mLastEnhancedStatusCode);
+        if (ret_code != RECIPIENT_OK) {
             rcpt_to_ret_code = ret_code;
-            }
-            });
+        }
+    }
     return rcpt_to_ret_code;
 }
 
-int SMTPClientBase::setMailHeaders(const Message &pMsg) {
-    // Data section
+int SMTPClientBase::prepareInternationalizedEnvelope(const char *&pSenderAddress,
+        const std::vector<const char *> *&pRecipientAddresses,
+        const char *&pMailParameters) {
+    if (mServerCapabilities.SmtpUtf8) {
+        mEnvelopeParameters.assign(pMailParameters != nullptr ? pMailParameters : "");
+        mEnvelopeParameters += mEnvelopeParameters.empty() ? "SMTPUTF8" : " SMTPUTF8";
+        pMailParameters = mEnvelopeParameters.c_str();
+        return 0;
+    }
+    // Without SMTPUTF8, only the domains can be converted (RFC 5890)
+    const size_t address_count = pRecipientAddresses->size() + 1;
+    mEnvelopeAddresses.resize(address_count);
+    for (size_t index = 0; index < address_count; index++) {
+        int convert_ret_code = convertEnvelopeAddress(index == 0 ? pSenderAddress : (*pRecipientAddresses)[index - 1],
+                mEnvelopeAddresses[index]);
+        if (convert_ret_code != 0) {
+            return convert_ret_code;
+        }
+    }
+    mEnvelopeRecipients.clear();
+    for (size_t index = 1; index < address_count; index++) {
+        mEnvelopeRecipients.push_back(mEnvelopeAddresses[index].c_str());
+    }
+    pSenderAddress = mEnvelopeAddresses[0].c_str();
+    pRecipientAddresses = &mEnvelopeRecipients;
+    return 0;
+}
+
+int SMTPClientBase::convertEnvelopeAddress(const char *pAddress, std::string &pAsciiAddress) {
+    const std::string_view address { pAddress };
+    const size_t at_position = address.rfind('@');
+    const std::string_view local_part = address.substr(0, at_position);
+    if (!StringUtils::isAscii(local_part)) {
+        return CLIENT_SENDMAIL_SMTPUTF8_NOT_SUPPORTED_ERROR;
+    }
+    const std::string_view domain = at_position == std::string_view::npos ? std::string_view() : address.substr(at_position + 1);
+    if (StringUtils::isAscii(domain)) {
+        pAsciiAddress.assign(address);
+        return 0;
+    }
+    const std::string *ascii_domain = mIdnaConverter.toAscii(domain);
+    if (ascii_domain == nullptr) {
+        return CLIENT_SENDMAIL_IDNA_CONVERSION_ERROR;
+    }
+    pAsciiAddress.assign(local_part).append(1, '@').append(*ascii_domain);
+    return 0;
+}
+
+const std::string &SMTPClientBase::buildRecipientCommand(const char *pAddress) {
+    mRecipientCommand.assign("RCPT TO: <").append(pAddress).append(">");
+    if (mServerCapabilities.Dsn) {
+        if (mDsnOptions.NotifyNever) {
+            mRecipientCommand += " NOTIFY=NEVER";
+        } else if (mDsnOptions.NotifySuccess || mDsnOptions.NotifyFailure || mDsnOptions.NotifyDelay) {
+            mRecipientCommand += " NOTIFY=";
+            const size_t values_start = mRecipientCommand.size();
+            for (const auto &[requested, value] : { std::make_pair(mDsnOptions.NotifySuccess, "SUCCESS"),
+                    std::make_pair(mDsnOptions.NotifyFailure, "FAILURE"),
+                    std::make_pair(mDsnOptions.NotifyDelay, "DELAY") }) {
+                if (requested) {
+                    mRecipientCommand += mRecipientCommand.size() > values_start ? "," : "";
+                    mRecipientCommand += value;
+                }
+            }
+        }
+    }
+    mRecipientCommand += "\r\n";
+    return mRecipientCommand;
+}
+
+void SMTPClientBase::recordRecipientResult(size_t pIndex, int pReplyCode, std::string_view pEnhancedStatusCode) {
+    if (pIndex >= mRecipientResults.size()) {
+        return;
+    }
+    RecipientResult &result = mRecipientResults[pIndex];
+    result.ReplyCode = pReplyCode;
+    const size_t length = pEnhancedStatusCode.copy(result.EnhancedStatusCode, RecipientResult::MAX_ENHANCED_STATUS_CODE_LENGTH);
+    result.EnhancedStatusCode[length] = '\0';
+}
+
+int SMTPClientBase::sendDataCommand() {
     std::string data_cmd = "DATA\r\n";
     addCommunicationLogItem(data_cmd.c_str());
     int data_ret_code = (*this.*sendCommandWithFeedbackPtr)(data_cmd.c_str(), CLIENT_SENDMAIL_DATA_ERROR, CLIENT_SENDMAIL_DATA_TIMEOUT);
     if (data_ret_code != STATUS_CODE_START_MAIL_INPUT) {
         return data_ret_code;
     }
+    mMessageContentStarted = true;
+    return 0;
+}
 
-    // Mail headers
-    // From
-    int header_from_ret_code = addMailHeader("From", pMsg.getFrom().getEmailAddress(), CLIENT_SENDMAIL_HEADERFROM_ERROR);
-    if (header_from_ret_code != 0) {
-        return header_from_ret_code;
+int SMTPClientBase::setMailHeaders(const Message &pMsg,
+        const MessageAddress *pRecipient,
+        std::string_view pSignatureField) {
+    mOutputBuffer.clear();
+    // Data section
+    int data_ret_code = sendDataCommand();
+    if (data_ret_code != 0) {
+        return data_ret_code;
     }
 
-    // To and Cc.
-    // Note : Bcc are not included in the header
-    std::vector<std::tuple<MessageAddress **, size_t, const char *>> recipients {
-        std::tuple<MessageAddress **, size_t, const char *>(pMsg.getTo(), pMsg.getToCount(), "To"),
-            std::tuple<MessageAddress **, size_t, const char *>(pMsg.getCc(), pMsg.getCcCount(), "Cc")
-    };
-    for (const auto &item : recipients) {
-        MessageAddress **list = std::get<0>(item);
-        size_t count = std::get<1>(item);
-        const char *field = std::get<2>(item);
-        if (list != nullptr) {
-            std::for_each(list, list + count, [this, &field](MessageAddress *address) {
-                    return addMailHeader(field, address->getEmailAddress(), CLIENT_SENDMAIL_HEADERTOANDCC_ERROR);
-                    });
+    // Mail headers, kept in the output buffer until the body is sent so that
+    // they share its writes and its TLS records
+    mOutputBuffer.append(pSignatureField);
+    MimeWriter::appendHeaders(pMsg, mBoundary, pRecipient, mOutputBuffer);
+    addCommunicationLogContent({ mOutputBuffer });
+    return 0;
+}
+
+int SMTPClientBase::setMailBody(const Message &pMsg, const char *pBodyTransferEncoding) {
+    // Body part
+    const std::string body_header = MimeWriter::createBodyPartHeader(pMsg, mBoundary, pBodyTransferEncoding);
+    addCommunicationLogContent({ body_header, pMsg.getBodyView(), "\r\n" });
+    // The first attachment is prepared while the body is written
+    const std::vector<TransferEncoding> attachment_encodings { selectAttachmentEncodings(pMsg, false) };
+    const auto prefetcher = createAttachmentPrefetcher(pMsg, attachment_encodings);
+    // The body is dot-stuffed and its bare LF are converted while it is
+    // sent, the unchanged runs are not copied
+    std::vector<std::string_view> body_segments { mOutputBuffer, body_header };
+    DataNormalizer().normalize(pMsg.getBodyView(), body_segments);
+    body_segments.emplace_back("\r\n");
+    if (pMsg.getAttachmentsCount() == 0) {
+        // Without attachments the end of data is sent in the last write of the body
+        body_segments.emplace_back(mBoundary.getClosingDelimiter());
+        int end_data_ret_code = sendEndOfData(body_segments, CLIENT_SENDMAIL_BODY_ERROR);
+        mOutputBuffer.clear();
+        return end_data_ret_code;
+    }
+    int body_ret_code = (*this.*sendDataSegmentsPtr)(body_segments.data(), body_segments.size(), CLIENT_SENDMAIL_BODY_ERROR);
+    mOutputBuffer.clear();
+    if (body_ret_code != 0) {
+        return body_ret_code;
+    }
+
+    // Attachments are read, encoded and sent block by block
+    Attachment** arr_attachment = pMsg.getAttachments();
+    for (size_t index = 0; index < pMsg.getAttachmentsCount(); index++) {
+        int attachment_ret_code = sendAttachment(*arr_attachment[index], attachment_encodings[index], prefetcher.get());
+        if (attachment_ret_code != 0) {
+            return attachment_ret_code;
         }
     }
 
-    // Subject
-    std::stringstream ss_header_subject;
-    ss_header_subject << "Subject: " << pMsg.getSubject() << "\r\n";
-    addCommunicationLogItem(ss_header_subject.str().c_str());
-    int header_subject_ret_code = (*this.*sendCommandPtr)(ss_header_subject.str().c_str(), CLIENT_SENDMAIL_HEADERSUBJECT_ERROR);
-    if (header_subject_ret_code != 0) {
-        return header_subject_ret_code;
+    // The closing delimiter is sent with the end of data that needs a reply
+    std::vector<std::string_view> closing_segments { mBoundary.getClosingDelimiter() };
+    return sendEndOfData(closing_segments, CLIENT_SENDMAIL_END_DATA_ERROR);
+}
+
+int SMTPClientBase::setMailBodyChunked(const Message &pMsg,
+        const MessageAddress *pRecipient,
+        bool pBinaryAttachments,
+        const char *pBodyTransferEncoding,
+        std::string_view pSignatureField) {
+    size_t pending_reply_count = 0;
+
+    // The headers and the body part make the first chunk
+    std::string headers { pSignatureField };
+    MimeWriter::appendHeaders(pMsg, mBoundary, pRecipient, headers);
+    addCommunicationLogContent({ headers });
+    const std::string body_header = MimeWriter::createBodyPartHeader(pMsg, mBoundary, pBodyTransferEncoding);
+    addCommunicationLogContent({ body_header, pMsg.getBodyView(), "\r\n" });
+    // The size of a chunk is exact so the body is not dot-stuffed, only its
+    // bare LF are converted
+    const std::vector<TransferEncoding> attachment_encodings { selectAttachmentEncodings(pMsg, pBinaryAttachments) };
+    const auto prefetcher = createAttachmentPrefetcher(pMsg, attachment_encodings);
+    std::vector<std::string_view> body_segments { headers, body_header };
+    DataNormalizer(false).normalize(pMsg.getBodyView(), body_segments);
+    body_segments.emplace_back("\r\n");
+    int body_ret_code = sendChunk(body_segments.data(), body_segments.size(), false, pending_reply_count);
+    if (body_ret_code != 0) {
+        return readPendingChunkReplies(body_ret_code, pending_reply_count);
     }
 
-    // Content-Type
-    std::string content_type { "Content-Type: multipart/mixed; boundary=sep\r\n\r\n" };
-    addCommunicationLogItem(content_type.c_str());
-    int header_content_type_ret_code = (*this.*sendCommandPtr)(content_type.c_str(), CLIENT_SENDMAIL_HEADERCONTENTTYPE_ERROR);
-    if (header_content_type_ret_code != 0) {
-        return header_content_type_ret_code;
+    // Each block of an attachment is sent in its own chunk
+    Attachment** arr_attachment = pMsg.getAttachments();
+    for (size_t index = 0; index < pMsg.getAttachmentsCount(); index++) {
+        const Attachment &attachment = *arr_attachment[index];
+        const std::string attachment_header { createAttachmentHeader(attachment, attachment_encodings[index]) };
+        addCommunicationLogContent({ attachment_header });
+        bool content_sent = false;
+        auto send_block = [this, &attachment_header, &content_sent, &pending_reply_count](std::string_view pBlock) {
+            const std::string_view segments[] { attachment_header, pBlock };
+            const size_t first_segment = content_sent ? 1 : 0;
+            content_sent = true;
+            return sendChunk(segments + first_segment, 2 - first_segment, false, pending_reply_count);
+        };
+        int stream_ret_code = streamAttachment(attachment, attachment_encodings[index], prefetcher.get(), send_block);
+        if (!content_sent) {
+            // A file that is empty or cannot be opened is sent as an empty attachment
+            const std::string_view header_segment { attachment_header };
+            stream_ret_code = sendChunk(&header_segment, 1, false, pending_reply_count);
+        } else if (stream_ret_code == -1) {
+            // The message cannot be completed if the file could not be read entirely
+            return readPendingChunkReplies(CLIENT_SENDMAIL_BODYPART_ERROR, pending_reply_count);
+        }
+        if (stream_ret_code != 0) {
+            return readPendingChunkReplies(stream_ret_code, pending_reply_count);
+        }
     }
 
+    const std::string_view closing_segment { mBoundary.getClosingDelimiter() };
+    return sendChunk(&closing_segment, 1, true, pending_reply_count);
+}
+
+int SMTPClientBase::sendChunk(const std::string_view *pSegments,
+        size_t pSegmentCount,
+        bool pLast,
+        size_t &pPendingReplyCount) {
+    size_t chunk_size = 0;
+    for (size_t index = 0; index < pSegmentCount; index++) {
+        chunk_size += pSegments[index].size();
+    }
+    // The size is exact so the content is neither scanned nor dot-stuffed
+    const std::string command { "BDAT "s + std::to_string(chunk_size) + (pLast ? " LAST\r\n"s : "\r\n"s) };
+    addCommunicationLogItem(command.c_str());
+    std::vector<std::string_view> segments { command };
+    segments.insert(segments.end(), pSegments, pSegments + pSegmentCount);
+    int send_ret_code = (*this.*sendDataSegmentsPtr)(segments.data(), segments.size(), CLIENT_SENDMAIL_BDAT_ERROR);
+    if (send_ret_code != 0) {
+        return send_ret_code;
+    }
+    pPendingReplyCount++;
+
+    // With PIPELINING the next chunks are sent without waiting for the reply
+    // of the previous ones (RFC 3030 section 4.2). The number of replies
+    // pending is bounded so that they cannot fill the socket buffers.
+    const size_t MAX_PENDING_REPLY_COUNT = 16;
+    const bool pipelined = mPipeliningEnabled && mServerCapabilities.Pipelining;
+    if (!pLast && pipelined && pPendingReplyCount < MAX_PENDING_REPLY_COUNT) {
+        return 0;
+    }
+    std::vector<int> return_codes;
+    std::vector<std::string> enhanced_status_codes;
+    int read_ret_code = readPipelinedResponses(pPendingReplyCount, return_codes, CLIENT_SENDMAIL_BDAT_TIMEOUT, &enhanced_status_codes);
+    pPendingReplyCount = 0;
+    if (read_ret_code != 0) {
+        return read_ret_code;
+    }
+    for (size_t index = 0; index < return_codes.size(); index++) {
+        if (return_codes[index] != STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED) {
+            mLastEnhancedStatusCode = enhanced_status_codes[index];
+            return return_codes[index];
+        }
+    }
     return 0;
 }
 
-int SMTPClientBase::addMailHeader(const char *field, const char *value, int pErrorCode) {
-    std::stringstream ss_header_item;
-    ss_header_item << field << ": " << value << "\r\n";
-    addCommunicationLogItem(ss_header_item.str().c_str());
-    return (*this.*sendCommandPtr)(ss_header_item.str().c_str(), pErrorCode);
+int SMTPClientBase::readPendingChunkReplies(int pReturnCode, size_t &pPendingReplyCount) {
+    // The replies of the chunks already sent must not be taken for the
+    // replies of the commands that reset the transaction
+    if (pPendingReplyCount > 0 && mConnectionOpened) {
+        std::vector<int> return_codes;
+        readPipelinedResponses(pPendingReplyCount, return_codes, CLIENT_SENDMAIL_BDAT_TIMEOUT);
+    }
+    pPendingReplyCount = 0;
+    return pReturnCode;
 }
 
-int SMTPClientBase::setMailBody(const Message &pMsg) {
-    // Body part
-    std::ostringstream body_ss;
-    body_ss << "--sep\r\nContent-Type: " << pMsg.getMimeType() << "; charset=UTF-8\r\n\r\n" << pMsg.getBody() << "\r\n";
-    std::string body_real = body_ss.str();
-    addCommunicationLogItem(body_real.c_str());
+int SMTPClientBase::sendEndOfData(std::vector<std::string_view> &pSegments, int pErrorCode) {
+    const char *END_DATA_COMMAND = "\r\n.\r\n";
+    addCommunicationLogItem(END_DATA_COMMAND);
+    // The command is written with the end of the content rather than in a
+    // write of its own
+    pSegments.emplace_back(END_DATA_COMMAND);
+    int end_data_ret_code = sendDataSegmentsWithFeedback(pSegments.data(), pSegments.size(), pErrorCode, CLIENT_SENDMAIL_END_DATA_TIMEOUT);
+    mMessageContentStarted = false;
+    if (end_data_ret_code != STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED) {
+        return end_data_ret_code;
+    }
+    return 0;
+}
+
+int SMTPClientBase::createDkimSignatureField(const Message &pMsg,
+        const MessageAddress *pRecipient,
+        bool pBinaryAttachments,
+        const char *pBodyTransferEncoding,
+        std::string &pField) const {
+    // The body is hashed as the recipient reads it: without the dot-stuffing
+    // of DATA, which the server removes
+    DkimBodyHasher hasher;
+    hasher.update(MimeWriter::createBodyPartHeader(pMsg, mBoundary, pBodyTransferEncoding));
+    std::vector<std::string_view> body_segments;
+    DataNormalizer(false).normalize(pMsg.getBodyView(), body_segments);
+    for (const std::string_view &segment : body_segments) {
+        hasher.update(segment);
+    }
+    hasher.update("\r\n");
 
-    // If there's attachments, prepare the attachments text content
+    // The attachments are encoded block by block, as they are sent
+    const std::vector<TransferEncoding> attachment_encodings { selectAttachmentEncodings(pMsg, pBinaryAttachments) };
     Attachment** arr_attachment = pMsg.getAttachments();
+    for (size_t index = 0; index < pMsg.getAttachmentsCount(); index++) {
+        hasher.update(createAttachmentHeader(*arr_attachment[index], attachment_encodings[index]));
+        bool content_hashed = false;
+        int stream_ret_code = streamAttachment(*arr_attachment[index], attachment_encodings[index], nullptr,
+                [&hasher, &content_hashed](std::string_view pBlock) {
+            hasher.update(pBlock);
+            content_hashed = true;
+            return 0;
+        });
+        // Same rule as when the attachment is sent
+        if (content_hashed && stream_ret_code != 0) {
+            return CLIENT_SENDMAIL_BODYPART_ERROR;
+        }
+    }
+    hasher.update(mBoundary.getClosingDelimiter());
 
-    std::vector<Attachment*> vect_attachment(arr_attachment, arr_attachment + pMsg.getAttachmentsCount());
-    if (pMsg.getAttachmentsCount() > 0) {
-        std::string attachments_text = createAttachmentsText(vect_attachment);
-        body_real += attachments_text;
+    std::string headers;
+    MimeWriter::appendHeaders(pMsg, mBoundary, pRecipient, headers);
+    if (!mDkimSigner->createSignatureField(headers, hasher.finish(), std::time(nullptr), pField)) {
+        return CLIENT_DKIM_SIGNATURE_ERROR;
     }
+    return 0;
+}
 
-    const size_t CHUNK_MAXLENGTH = 512;
-    if (body_real.length() > CHUNK_MAXLENGTH) {
-        // Split into chunk
-        for (size_t index_start = 0; index_start < body_real.length(); index_start += CHUNK_MAXLENGTH) {
-            size_t length = CHUNK_MAXLENGTH;
-            if (index_start + CHUNK_MAXLENGTH > body_real.length() - 1) {
-                length = body_real.length() - index_start;
-            }
-            int body_part_ret_code = (*this.*sendCommandPtr)(body_real.substr(index_start, length).c_str(), CLIENT_SENDMAIL_BODYPART_ERROR);
-            if (body_part_ret_code != 0) {
-                return body_part_ret_code;
+int SMTPClientBase::createDkimSignatureField(const std::string_view *pContentSegments,
+        size_t pContentSegmentCount,
+        std::string &pField) const {
+    // The header fields end with the first blank line, which can be split
+    // between two segments
+    const char HEADERS_END[] = "\r\n\r\n";
+    std::string headers;
+    DkimBodyHasher hasher;
+    bool headers_ended = false;
+    for (size_t index = 0; index < pContentSegmentCount; index++) {
+        std::string_view segment { pContentSegments[index] };
+        if (!headers_ended) {
+            const size_t search_start = headers.size() < 3 ? 0 : headers.size() - 3;
+            headers.append(segment);
+            const size_t headers_end = headers.find(HEADERS_END, search_start);
+            if (headers_end == std::string::npos) {
+                continue;
             }
+            headers_ended = true;
+            const size_t body_start = headers_end + 4;
+            segment.remove_prefix(segment.size() - (headers.size() - body_start));
+            headers.resize(body_start);
         }
-    } else {
-        int body_ret_code = (*this.*sendCommandPtr)(body_real.c_str(), CLIENT_SENDMAIL_BODY_ERROR);
-        if (body_ret_code != 0) {
-            return body_ret_code;
+        hasher.update(segment);
+    }
+    if (!mDkimSigner->createSignatureField(headers, hasher.finish(), std::time(nullptr), pField)) {
+        return CLIENT_DKIM_SIGNATURE_ERROR;
+    }
+    return 0;
+}
+
+std::vector<TransferEncoding> SMTPClientBase::selectAttachmentEncodings(const Message &pMsg, bool pBinaryAttachments) const {
+    std::vector<TransferEncoding> encodings;
+    encodings.reserve(pMsg.getAttachmentsCount());
+    Attachment** arr_attachment = pMsg.getAttachments();
+    for (size_t index = 0; index < pMsg.getAttachmentsCount(); index++) {
+        if (pBinaryAttachments) {
+            encodings.push_back(TransferEncoding::Binary);
+        } else if (mTextAttachmentEncodingEnabled) {
+            encodings.push_back(MimeWriter::selectAttachmentEncoding(*arr_attachment[index]));
+        } else {
+            encodings.push_back(TransferEncoding::Base64);
         }
     }
+    return encodings;
+}
+
+std::unique_ptr<AttachmentPrefetcher> SMTPClientBase::createAttachmentPrefetcher(const Message &pMsg,
+        const std::vector<TransferEncoding> &pEncodings) const {
+    // A single attachment is not worth a thread
+    if (mAttachmentPrefetchBlockCount == 0 || pMsg.getAttachmentsCount() < 2) {
+        return nullptr;
+    }
+    std::vector<AttachmentPrefetcher::Producer> producers;
+    Attachment** arr_attachment = pMsg.getAttachments();
+    for (size_t index = 0; index < pMsg.getAttachmentsCount(); index++) {
+        const Attachment *attachment = arr_attachment[index];
+        const TransferEncoding encoding = pEncodings[index];
+        producers.emplace_back([this, attachment, encoding](const AttachmentBlockWriter &pWriter) {
+            return streamAttachment(*attachment, encoding, nullptr, pWriter);
+        });
+    }
+    return std::make_unique<AttachmentPrefetcher>(std::move(producers), mAttachmentPrefetchBlockCount);
+}
 
-    // End of data
-    std::string end_data_command { "\r\n.\r\n" };
-    addCommunicationLogItem(end_data_command.c_str());
-    int end_data_ret_code = (*this.*sendCommandWithFeedbackPtr)(end_data_command.c_str(), CLIENT_SENDMAIL_END_DATA_ERROR, CLIENT_SENDMAIL_END_DATA_TIMEOUT);
-    if (end_data_ret_code != STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED) {
-        return end_data_ret_code;
+int SMTPClientBase::streamAttachment(const Attachment &pAttachment,
+        TransferEncoding pEncoding,
+        AttachmentPrefetcher *pPrefetcher,
+        const AttachmentBlockWriter &pWriter) const {
+    if (pPrefetcher != nullptr) {
+        std::string block;
+        int ret_code = 0;
+        while (pPrefetcher->nextBlock(block, ret_code)) {
+            int writer_ret_code = pWriter(block);
+            if (writer_ret_code != 0) {
+                return writer_ret_code;
+            }
+        }
+        return ret_code;
+    }
+    auto write_encoded_block = [&pWriter](const std::string &pEncodedBlock) {
+            return pWriter(pEncodedBlock);
+            };
+    switch (pEncoding) {
+        case TransferEncoding::Binary:
+            return pAttachment.streamFile(pWriter);
+        case TransferEncoding::SevenBit:
+        case TransferEncoding::QuotedPrintable:
+            return pAttachment.streamQuotedPrintableEncodedFile(write_encoded_block);
+        case TransferEncoding::Base64:
+        default:
+            return streamBase64EncodedAttachment(pAttachment, write_encoded_block);
     }
+}
 
-    std::string quit_command { "QUIT\r\n" };
-    addCommunicationLogItem(quit_command.c_str());
-    int quit_ret_code = (*this.*sendCommandPtr)(quit_command.c_str(), CLIENT_SENDMAIL_QUIT_ERROR);
-    if (quit_ret_code != 0) {
-        return quit_ret_code;
+int SMTPClientBase::sendAttachment(const Attachment &pAttachment,
+        TransferEncoding pEncoding,
+        AttachmentPrefetcher *pPrefetcher) {
+    const std::string attachment_header { createAttachmentHeader(pAttachment, pEncoding) };
+    addCommunicationLogContent({ attachment_header });
+
+    // The header is sent in the same write as the first encoded block
+    bool content_sent = false;
+    int stream_ret_code = streamAttachment(pAttachment, pEncoding, pPrefetcher, [this, &attachment_header, &content_sent](std::string_view pEncodedBlock) {
+            const std::string_view segments[] { attachment_header, pEncodedBlock };
+            const size_t first_segment = content_sent ? 1 : 0;
+            content_sent = true;
+            return (*this.*sendDataSegmentsPtr)(segments + first_segment, 2 - first_segment, CLIENT_SENDMAIL_BODYPART_ERROR);
+            });
+    if (!content_sent) {
+        // A file that is empty or cannot be opened is sent as an empty attachment
+        const std::string_view header_segment { attachment_header };
+        return (*this.*sendDataSegmentsPtr)(&header_segment, 1, CLIENT_SENDMAIL_BODYPART_ERROR);
     }
-    return 0;
+    // The message cannot be completed if the file could not be read entirely
+    if (stream_ret_code == -1) {
+        return CLIENT_SENDMAIL_BODYPART_ERROR;
+    }
+    return stream_ret_code;
 }
 
 void SMTPClientBase::addCommunicationLogItem(const char *pItem, const char *pPrefix) {
-    std::string item { pItem };
-    if (strcmp(pPrefix, "c") == 0) {
-        /* Replace the \ by \\ */
-        const std::string FROM { "\r\n" };
-        const std::string TO { "\\r\\n" };
-        size_t start_pos = 0;
-        while ((start_pos = item.find(FROM, start_pos)) != std::string::npos) {
-            item.replace(start_pos, FROM.length(), TO);
-            start_pos += TO.length();  // Handles case where 'to' is a substring of 'from'
-        }
-    }
-    const std::string ENDOFLINE { "\n" };
-    const std::string SEPARATOR { ": " };
-    size_t currentLogSize = strlen(mCommunicationLog);
-    size_t appendSize = ENDOFLINE.length() + strlen(pPrefix) + SEPARATOR.length() + item.length() + 1;
-    if (mCommunicationLogSize - currentLogSize <= appendSize) {
-        size_t newSize = currentLogSize + appendSize + INITIAL_COMM_LOG_LENGTH;
-        char *newBuffer = new char[newSize];
-        std::strncpy(newBuffer, mCommunicationLog, currentLogSize);
-        newBuffer[currentLogSize] = '\0';
-        mCommunicationLogSize = newSize;
-        char *tmpBuffer = mCommunicationLog;
-        mCommunicationLog = newBuffer;
-        delete [] tmpBuffer;
-    }
-    strncat(mCommunicationLog, ENDOFLINE.c_str(), mCommunicationLogSize-1);
-    strncat(mCommunicationLog, pPrefix, mCommunicationLogSize-1);
-    strncat(mCommunicationLog, SEPARATOR.c_str(), mCommunicationLogSize-1);
-    strncat(mCommunicationLog, item.c_str(), mCommunicationLogSize-1);
-    mCommunicationLog[mCommunicationLogSize-1] = '\0';
-}
-
-std::string SMTPClientBase::createAttachmentsText(const std::vector<Attachment*> &pAttachments) {
-    std::string retval;
-    for (const auto &item : pAttachments) {
-        retval += "\r\n--sep\r\n";
-        retval += "Content-Type: " + std::string(item->getMimeType()) + "; file=\"" + std::string(item->getName()) + "\"\r\n";
-        retval += "Content-Disposition: Inline; filename=\"" + std::string(item->getName()) + "\"\r\n";
-        retval += "Content-Transfer-Encoding: base64\r\n\r\n";
-        retval += std::string((item->getBase64EncodedFile() != nullptr ? item->getBase64EncodedFile() : ""));
-    }
-    retval += "\r\n--sep--";
-    return retval;
+    // The commands are logged as they are sent, the other items of the
+    // client are not terminated by a line break
+    if (mSessionTrace != nullptr && strcmp(pPrefix, "c") == 0) {
+        const std::string_view item { pItem };
+        if (item.size() >= 2 && item.compare(item.size() - 2, 2, "\r\n") == 0) {
+            mSessionTrace->recordCommand(item);
+        }
+    }
+    if constexpr (COMMUNICATION_LOG_ENABLED) {
+        mCommunicationLog.add(CommunicationLogLevel::Commands, pPrefix, { pItem });
+    } else {
+        (void)pItem;
+        (void)pPrefix;
+    }
+}
+
+void SMTPClientBase::addCommunicationLogContent(std::initializer_list<std::string_view> pParts) {
+    if constexpr (COMMUNICATION_LOG_ENABLED) {
+        mCommunicationLog.add(CommunicationLogLevel::Full, "c", pParts);
+    } else {
+        (void)pParts;
+    }
+}
+
+std::string SMTPClientBase::createAttachmentHeader(const Attachment &pAttachment, TransferEncoding pEncoding) const {
+    return MimeWriter::createAttachmentHeader(pAttachment, mBoundary, MimeWriter::getTransferEncodingName(pEncoding));
+}
+
+int SMTPClientBase::streamBase64EncodedAttachment(const Attachment &pAttachment,
+        const std::function<int(const std::string &pEncodedBlock)> &pWriter) const {
+    if (mEncodedAttachmentCache != nullptr) {
+        return mEncodedAttachmentCache->streamBase64EncodedFile(pAttachment, pWriter);
+    }
+    return pAttachment.streamBase64EncodedFile(pWriter);
 }
 
 int SMTPClientBase::extractReturnCode(const char *pOutput) {
-    if (pOutput != nullptr && strlen(pOutput) >= 3) {
-        std::string code_str { pOutput };
-        try {
-            return std::stoi(code_str.substr(0, 3));
-        }
-        catch (std::exception const &) {
+    // The reply begins with a code of three digits (RFC 5321 section 4.2)
+    if (pOutput == nullptr) {
+        return -1;
+    }
+    int code = 0;
+    for (size_t i = 0; i < 3; i++) {
+        if (pOutput[i] < '0' || pOutput[i] > '9') {
             return -1;
         }
+        code = code * 10 + (pOutput[i] - '0');
     }
-    return -1;
+    return code;
 }
 
 ServerAuthOptions *SMTPClientBase::extractAuthenticationOptions(const char *pEhloOutput) {
-    ServerAuthOptions *retVal = nullptr;
-    const std::string AUTH_LINE_PREFIX = "250-AUTH";
+    const ServerCapabilities capabilities = extractServerCapabilities(pEhloOutput);
+    if (!capabilities.Auth) {
+        return nullptr;
+    }
+    return new ServerAuthOptions(capabilities.AuthOptions);
+}
+
+namespace {
+// The keywords and parameters of the EHLO response are not case sensitive
+bool equalsIgnoreCase(std::string_view pValue, std::string_view pUpperKeyword) {
+    if (pValue.length() != pUpperKeyword.length()) {
+        return false;
+    }
+    for (size_t i = 0; i < pValue.length(); i++) {
+        char c = pValue[i];
+        if (c >= 'a' && c <= 'z') {
+            c = static_cast<char>(c - 'a' + 'A');
+        }
+        if (c != pUpperKeyword[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void addAuthMechanism(ServerAuthOptions *pOptions, std::string_view pMechanism) {
+    if (equalsIgnoreCase(pMechanism, "PLAIN")) {
+        pOptions->Plain = true;
+    } else if (equalsIgnoreCase(pMechanism, "LOGIN")) {
+        pOptions->Login = true;
+    } else if (equalsIgnoreCase(pMechanism, "XOAUTH2")) {
+        pOptions->XOAuth2 = true;
+    } else if (equalsIgnoreCase(pMechanism, "PLAIN-CLIENTTOKEN")) {
+        pOptions->Plain_ClientToken = true;
+    } else if (equalsIgnoreCase(pMechanism, "OAUTHBEARER")) {
+        pOptions->OAuthBearer = true;
+    } else if (equalsIgnoreCase(pMechanism, "XOAUTH")) {
+        pOptions->XOAuth = true;
+    }
+}
+
+// Return 0 when the value is missing or not a number of bytes
+size_t parseMessageSize(std::string_view pValue) {
+    size_t size = 0;
+    for (char c : pValue) {
+        if (c < '0' || c > '9' || size > ((std::numeric_limits<size_t>::max)() - 9) / 10) {
+            return 0;
+        }
+        size = size * 10 + static_cast<size_t>(c - '0');
+    }
+    return size;
+}
+}  // namespace
+
+ServerCapabilities SMTPClientBase::resolveServerCapabilities(bool pSecure) {
+    const char *ehlo_response = getLastServerResponse();
+    if (mCapabilityCache == nullptr || ehlo_response == nullptr) {
+        return extractServerCapabilities(ehlo_response);
+    }
+    ServerCapabilities capabilities;
+    if (mCapabilityCache->find(mServerName.c_str(), mPort, pSecure, ehlo_response, capabilities)) {
+        return capabilities;
+    }
+    capabilities = extractServerCapabilities(ehlo_response);
+    // A refused EHLO does not replace the capabilities of the server
+    if (extractReturnCode(ehlo_response) == STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED) {
+        mCapabilityCache->insert(mServerName.c_str(), mPort, pSecure, ehlo_response, capabilities);
+    }
+    return capabilities;
+}
+
+ServerCapabilities SMTPClientBase::extractServerCapabilities(const char *pEhloOutput) {
+    ServerCapabilities retVal;
     if (pEhloOutput == nullptr) {
         return retVal;
     }
-    const std::string DELIMITER { "\r\n" };
-    std::string ehlo_output { pEhloOutput };
-    size_t ehlo_character_index { 0 };
-    while ((ehlo_character_index = ehlo_output.find(DELIMITER)) != std::string::npos) {
-        std::string line { ehlo_output.substr(0, ehlo_character_index)};
-        // Find the line that begin with 250-AUTH
-        if (line.substr(0, AUTH_LINE_PREFIX.length()) == AUTH_LINE_PREFIX) {
-            retVal = new ServerAuthOptions();
-            // Find each options
-            std::vector<std::string> options;
-            size_t line_character_index { 0 };
-            while ((line_character_index = line.find(' ')) != std::string::npos) {
-                std::string option { line.substr(0, line_character_index)};
-                options.push_back(option);
-                line.erase(0, line_character_index + 1);
+    // The response is scanned once, the lines and their words are views of it
+    std::string_view ehlo_output { pEhloOutput };
+    while (!ehlo_output.empty()) {
+        size_t line_end = ehlo_output.find('\n');
+        std::string_view line { ehlo_output.substr(0, line_end) };
+        ehlo_output.remove_prefix(line_end == std::string_view::npos ? ehlo_output.length() : line_end + 1);
+        // The last line may be received without its line ending
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        // Each extension line begin with 250- or 250 followed by the keyword
+        if (line.length() <= 4 || line.compare(0, 3, "250") != 0 || (line[3] != '-' && line[3] != ' ')) {
+            continue;
+        }
+        line.remove_prefix(4);
+        // Some servers still send the AUTH=LOGIN form of the old drafts
+        size_t keyword_end = line.find_first_of(" =");
+        std::string_view keyword { line.substr(0, keyword_end) };
+        std::string_view parameters { keyword_end == std::string_view::npos ? std::string_view() : line.substr(keyword_end + 1) };
+        if (equalsIgnoreCase(keyword, "PIPELINING")) {
+            retVal.Pipelining = true;
+        } else if (equalsIgnoreCase(keyword, "STARTTLS")) {
+            retVal.StartTLS = true;
+        } else if (equalsIgnoreCase(keyword, "CHUNKING")) {
+            retVal.Chunking = true;
+        } else if (equalsIgnoreCase(keyword, "BINARYMIME")) {
+            retVal.BinaryMime = true;
+        } else if (equalsIgnoreCase(keyword, "8BITMIME")) {
+            retVal.EightBitMime = true;
+        } else if (equalsIgnoreCase(keyword, "SMTPUTF8")) {
+            retVal.SmtpUtf8 = true;
+        } else if (equalsIgnoreCase(keyword, "ENHANCEDSTATUSCODES")) {
+            retVal.EnhancedStatusCodes = true;
+        } else if (equalsIgnoreCase(keyword, "DSN")) {
+            retVal.Dsn = true;
+        } else if (equalsIgnoreCase(keyword, "SIZE")) {
+            retVal.Size = true;
+            retVal.MaxMessageSize = parseMessageSize(parameters.substr(0, parameters.find(' ')));
+        } else if (equalsIgnoreCase(keyword, "AUTH")) {
+            retVal.Auth = true;
+            while (!parameters.empty()) {
+                size_t mechanism_end = parameters.find(' ');
+                addAuthMechanism(&retVal.AuthOptions, parameters.substr(0, mechanism_end));
+                parameters.remove_prefix(mechanism_end == std::string_view::npos ? parameters.length() : mechanism_end + 1);
             }
-            options.push_back(line);
-            // Try to match the string options with the ServerAuthOptions struct attributes
-            for_each(options.begin(), options.end(), [&retVal](const std::string &option) {
-                if (option == "PLAIN") {
-                    retVal->Plain = true;
-                } else if (option == "LOGIN") {
-                    retVal->Login = true;
-                } else if (option == "XOAUTH2") {
-                    retVal->XOAuth2 = true;
-                } else if (option == "PLAIN-CLIENTTOKEN") {
-                    retVal->Plain_ClientToken = true;
-                } else if (option == "OAUTHBEARER") {
-                    retVal->OAuthBearer = true;
-                } else if (option == "XOAUTH") {
-                    retVal->XOAuth = true;
-                }
-                });
-            break;
         }
-        ehlo_output.erase(0, ehlo_character_index + DELIMITER.length());
     }
     return retVal;
 }
@@ -1,15 +1,38 @@
 #ifndef SMTPCLIENTBASE_H
 #define SMTPCLIENTBASE_H
 
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <vector>
 #include "attachment.h"
+#include "attachmentprefetcher.h"
+#include "bulkrecipientresult.h"
+#include "cancellationtoken.h"
+#include "capabilitycache.h"
+#include "communicationlog.h"
 #include "credential.h"
+#include "dkimsigner.h"
+#include "dsnoptions.h"
+#include "encodedattachmentcache.h"
 #include "htmlmessage.h"
+#include "idnaconverter.h"
 #include "messageaddress.h"
+#include "messagetemplate.h"
+#include "mimewriter.h"
 #include "plaintextmessage.h"
+#include "sendresult.h"
 #include "serverauthoptions.h"
+#include "servercapabilities.h"
+#include "serverreplyreader.h"
+#include "sessionobserver.h"
+#include "sessiontrace.h"
+#include "transport.h"
+#include "transportoptions.h"
 
 #ifdef _WIN32
     #ifdef SMTPCLIENT_EXPORTS
@@ -21,15 +44,20 @@
     #define SMTPCLIENTBASE_API
 #endif
 
-/** The max length of the communication log */
-#define INITIAL_COMM_LOG_LENGTH 4096
+/** The default capacity of the communication log */
+#define INITIAL_COMM_LOG_LENGTH 65536
 
-/** The max length of the server response buffer */
+/** The default length of the server response buffer, see TransportOptions */
 #define SERVERRESPONSE_BUFFER_LENGTH 1024
 
 namespace jed_utils {
 /** @brief The SMTPClientBase represents the base class for all SMTP clients
  *  that will or will not use encryption for communication.
+ *
+ *  A client holds the state of one session (socket, communication log, last
+ *  server reply, capabilities) and must be used by one thread at a time. To
+ *  send from several threads, share a SmtpClientConfig and give each thread
+ *  its own SmtpSession, or use the SmtpConnectionPool or the AsyncSmtpClient.
  */
 class SMTPCLIENTBASE_API SMTPClientBase {
  public:
@@ -45,16 +73,20 @@ class SMTPCLIENTBASE_API SMTPClientBase {
     /** Destructor of the SMTPClientBase. */
     virtual ~SMTPClientBase();
 
-    /** SMTPClientBase copy constructor. */
+    /** SMTPClientBase copy constructor. Only the configuration is copied:
+     *  the copy is not connected and has an empty communication log. */
     SMTPClientBase(const SMTPClientBase& other);
 
-    /** SMTPClientBase copy assignment operator. */
+    /** SMTPClientBase copy assignment operator. Only the configuration is
+     *  copied and the connection of this client is closed. */
     SMTPClientBase& operator=(const SMTPClientBase& other);
 
-    /** SMTPClientBase move constructor. */
+    /** SMTPClientBase move constructor. The connection and the session
+     *  state are moved without copy. */
     SMTPClientBase(SMTPClientBase&& other) noexcept;
 
-    /** SMTPClientBase move assignment operator. */
+    /** SMTPClientBase move assignment operator. The connection of this
+     *  client is closed and replaced by the one of the source. */
     SMTPClientBase& operator=(SMTPClientBase&& other) noexcept;
 
     /** Return the server name. */
@@ -66,12 +98,82 @@ class SMTPCLIENTBASE_API SMTPClientBase {
     /** Return the command timeout in seconds. */
     unsigned int getCommandTimeout() const;
 
+    /** Return the command timeout in milliseconds. */
+    unsigned int getCommandTimeoutInMilliseconds() const;
+
     /** Return the communication log produced by the sendMail method. */
     const char *getCommunicationLog() const;
 
+    /** Return the communication log without computing its length. The view
+     *  remains valid until the next command of the client. */
+    std::string_view getCommunicationLogView() const;
+
+    /** Return the items recorded in the communication log. */
+    CommunicationLogLevel getCommunicationLogLevel() const;
+
+    /** Return the capacity of the communication log in bytes. */
+    size_t getCommunicationLogCapacity() const;
+
+    /** Return the maximum duration of an operation in milliseconds, 0 if
+     *  only the command timeout applies. */
+    unsigned int getOperationTimeoutInMilliseconds() const;
+
+    /** Return the token that cancels the operations or nullptr if there is none. */
+    std::shared_ptr<CancellationToken> getCancellationToken() const;
+
     /** Return the credentials configured. */
     const Credential *getCredentials() const;
 
+    /** Return the ESMTP extensions advertised by the server in its last EHLO response. */
+    const ServerCapabilities &getServerCapabilities() const;
+
+    /** Indicate if the commands are pipelined when the server supports PIPELINING. */
+    bool isPipeliningEnabled() const;
+
+    /** Indicate if the content is sent with BDAT when the server supports CHUNKING. */
+    bool isChunkingEnabled() const;
+
+    /** Indicate if the encoding of the text attachments is chosen from their content. */
+    bool isTextAttachmentEncodingEnabled() const;
+
+    /** Return the maximum number of bytes passed to a single write of the message data. */
+    size_t getDataWriteSize() const;
+
+    /** Return the buffer sizes and the socket options of the connections. */
+    const TransportOptions &getTransportOptions() const;
+
+    /** Return the delivery status notifications requested. */
+    const DsnOptions &getDsnOptions() const;
+
+    /** Return the maximum number of attachment blocks prepared in advance,
+     *  0 if the attachments are prepared by the sending thread. */
+    size_t getAttachmentPrefetchBlockCount() const;
+
+    /** Return the cache of the encoded attachments or nullptr if there is none. */
+    std::shared_ptr<EncodedAttachmentCache> getEncodedAttachmentCache() const;
+
+    /** Return the cache of the server capabilities or nullptr if there is none. */
+    std::shared_ptr<CapabilityCache> getCapabilityCache() const;
+
+    /** Return the DKIM signer of the messages or nullptr if they are not signed. */
+    std::shared_ptr<const DkimSigner> getDkimSigner() const;
+
+    /** Return the observer of the session phases or nullptr if there is none. */
+    std::shared_ptr<SessionObserver> getSessionObserver() const;
+
+    /** Return the trace of the last protocol events of the sessions or
+     *  nullptr if they are not traced. It can be read by another thread
+     *  while the client is used. */
+    std::shared_ptr<const SessionTrace> getSessionTrace() const;
+
+    /** Return the transport of the sessions or nullptr if the client connects
+     *  its own socket. */
+    std::shared_ptr<Transport> getTransport() const;
+
+    /** Return the data exchanged with the servers and the calls made to the
+     *  socket since the client was created. */
+    const IoCounters &getIoCounters() const;
+
     /**
      *  @brief  Set the server name.
      *  @param pServerName A char array pointer of the server name.
@@ -89,10 +191,53 @@ class SMTPCLIENTBASE_API SMTPClientBase {
     /**
      *  @brief  Set the command timeout in seconds.
      *  @param pTimeOutInSeconds The timeout in seconds.
-     *  Default: 3 seconds
+     *  Default: 5 seconds
      */
     void setCommandTimeout(unsigned int pTimeOutInSeconds);
 
+    /**
+     *  @brief  Set the command timeout in milliseconds.
+     *  @param pTimeOutInMilliseconds The timeout in milliseconds.
+     *  Default: 5000 milliseconds
+     */
+    void setCommandTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds);
+
+    /**
+     *  @brief  Set the maximum duration of each operation: a sendMail or
+     *  sendRenderedMail call including its connection, a message of
+     *  sendBulk, connect, sendNoop or disconnect. Every wait for the server
+     *  ends at the deadline of the operation, which then fails with
+     *  CLIENT_OPERATION_DEADLINE_EXCEEDED_ERROR, so the duration no longer
+     *  grows with the number of commands. The name resolution is not
+     *  interrupted.
+     *  @param pTimeOutInMilliseconds The timeout in milliseconds or 0 to
+     *  only apply the command timeout to each reply.
+     *  Default: 0
+     */
+    void setOperationTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds);
+
+    /**
+     *  @brief  Set the token that another thread triggers to interrupt the
+     *  operations of the client. An operation interrupted fails with
+     *  CLIENT_OPERATION_CANCELLED_ERROR and closes its connection, and the
+     *  next operations fail at once while the token remains cancelled.
+     *  @param pToken The token, which can be shared by several clients, or
+     *  nullptr.
+     *  Default: nullptr
+     */
+    void setCancellationToken(std::shared_ptr<CancellationToken> pToken);
+
+    /**
+     *  @brief  Set the delivery status notifications requested for the next
+     *  messages (RFC 3461). The NOTIFY parameter is added to each RCPT TO
+     *  command, the RET and ENVID parameters to the MAIL FROM command, when
+     *  the server advertises DSN. Change the envelope identifier before each
+     *  message to tell their notifications apart.
+     *  @param pOptions The notifications.
+     *  Default: no parameter
+     */
+    void setDsnOptions(const DsnOptions &pOptions);
+
     /**
      *  @brief  Set the credentials.
      *  @param pCredential The credential containing the username and the password.
@@ -110,12 +255,161 @@ class SMTPCLIENTBASE_API SMTPClientBase {
      */
     void setKeepUsingBaseSendCommands(bool pValue);
 
+    /**
+     *  @brief  Indicate if the MAIL FROM and RCPT TO commands are sent in a
+     *  single write when the server advertises the PIPELINING extension
+     *  (RFC 2920).
+     *  @param pValue True to pipeline the commands (default), false to wait
+     *  for the response of each command before sending the next one.
+     */
+    void setPipeliningEnabled(bool pValue);
+
+    /**
+     *  @brief  Indicate if the content is sent with BDAT chunks of known size
+     *  when the server advertises the CHUNKING extension (RFC 3030). The
+     *  attachments are then sent without base64 if the server also
+     *  advertises BINARYMIME.
+     *  @param pValue True to use BDAT (default), false to always use DATA.
+     */
+    void setChunkingEnabled(bool pValue);
+
+    /**
+     *  @brief  Indicate if the attachments of a text type, such as CSV files
+     *  and logs, are sent in 7bit or in quoted-printable when it is smaller
+     *  than base64. Their content is read once more to be measured. The
+     *  binary attachments of BINARYMIME are not affected.
+     *  @param pValue True to choose the encoding from the content, false to
+     *  send all the attachments in base64 (default).
+     */
+    void setTextAttachmentEncodingEnabled(bool pValue);
+
+    /**
+     *  @brief  Set the maximum number of bytes passed to a single socket or
+     *  TLS write when the message body and the attachments are sent. The
+     *  parts of the message are gathered or coalesced up to this size.
+     *  @param pWriteSize The write size in bytes. Values lower than 512 are
+     *  replaced by 512.
+     *  Default: 65536 bytes
+     */
+    void setDataWriteSize(size_t pWriteSize);
+
+    /**
+     *  @brief  Set the buffer sizes and the socket options of the
+     *  connections: TCP_NODELAY, SO_SNDBUF, SO_RCVBUF, the TCP keepalive and
+     *  the connection timeout. They apply from the next connection, the
+     *  buffer sizes from the next read or write.
+     *  @param pOptions The options. The buffer sizes lower than 512 are
+     *  replaced by 512.
+     */
+    void setTransportOptions(const TransportOptions &pOptions);
+
+    /**
+     *  @brief  Set the maximum number of attachment blocks prepared in
+     *  advance. When a message has several attachments, they are read and
+     *  encoded on a separate thread while the previous blocks are written,
+     *  and each block holds about 76 KB.
+     *  @param pBlockCount The number of blocks or 0 to read and encode the
+     *  attachments on the sending thread.
+     *  Default: 4
+     */
+    void setAttachmentPrefetchBlockCount(size_t pBlockCount);
+
+    /**
+     *  @brief  Set the items recorded in the communication log.
+     *  @param pLevel CommunicationLogLevel::Full to record the commands and
+     *  the content of the messages (default), CommunicationLogLevel::Commands
+     *  to record only the commands and the server replies or
+     *  CommunicationLogLevel::None to disable the log. A library built with
+     *  the SMTPCLIENT_ENABLE_COMM_LOG option off records nothing.
+     */
+    void setCommunicationLogLevel(CommunicationLogLevel pLevel);
+
+    /**
+     *  @brief  Set the capacity of the communication log. Once it is full,
+     *  the oldest items are overwritten. The content is discarded.
+     *  @param pCapacity The capacity in bytes. 0 records nothing, the sink
+     *  still receives the items.
+     *  Default: 65536 bytes
+     */
+    void setCommunicationLogCapacity(size_t pCapacity);
+
+    /**
+     *  @brief  Set a function that receives each item of the communication
+     *  log as it is added.
+     *  @param pSink The function or an empty function to remove it.
+     */
+    void setCommunicationLogSink(CommunicationLogSink pSink);
+
+    /**
+     *  @brief  Set the cache of the encoded attachments. The attachments
+     *  sent in base64 are then encoded once for all the messages and the
+     *  clients that share the cache.
+     *  @param pCache The cache or nullptr to encode the attachments each time.
+     *  Default: nullptr
+     */
+    void setEncodedAttachmentCache(std::shared_ptr<EncodedAttachmentCache> pCache);
+
+    /**
+     *  @brief  Set the signer that adds a DKIM-Signature header field to the
+     *  messages sent with sendMail and sendRenderedMail (RFC 6376). The body
+     *  is canonicalized and hashed block by block before the DATA or the
+     *  first BDAT command, then the header fields are signed. The
+     *  attachments are therefore read twice, their sources must return the
+     *  same content each time.
+     *  @param pSigner The signer, which can be shared by several clients,
+     *  or nullptr to send the messages unsigned.
+     *  Default: nullptr
+     */
+    void setDkimSigner(std::shared_ptr<const DkimSigner> pSigner);
+
+    /**
+     *  @brief  Set the cache of the server capabilities. An EHLO response
+     *  identical to the previous one of the server is then not parsed again
+     *  and the clients that share the cache know the capabilities of the
+     *  server before they connect.
+     *  @param pCache The cache or nullptr to parse each EHLO response.
+     *  Default: nullptr
+     */
+    void setCapabilityCache(std::shared_ptr<CapabilityCache> pCache);
+
+    /**
+     *  @brief  Set the observer that receives the duration and the data
+     *  exchanged of each phase of the sessions: connection, greeting, EHLO,
+     *  STARTTLS, authentication, envelope, headers and body.
+     *  @param pObserver The observer or nullptr to measure nothing.
+     *  Default: nullptr
+     */
+    void setSessionObserver(std::shared_ptr<SessionObserver> pObserver);
+
+    /**
+     *  @brief  Keep the last protocol events of the sessions (commands
+     *  verbs, reply codes, phases) in a ring of fixed capacity, for instance
+     *  to dump them with getSessionTrace()->dump() when sendMail fails. A
+     *  copy of the client has its own empty trace.
+     *  @param pCapacity The number of events kept or 0 to trace nothing.
+     *  Default: 0
+     */
+    void setSessionTraceCapacity(size_t pCapacity);
+
+    /**
+     *  @brief  Set the transport through which the sessions exchange data
+     *  with the server. The transport is opened when a session starts and
+     *  closed when it ends. A transport is used by one session at a time,
+     *  so a copy of the client does not get it and connects its own socket
+     *  until it is given another transport. SmtpClientConfig::setTransportFactory
+     *  creates a transport for each client.
+     *  @param pTransport The transport or nullptr to connect a socket.
+     *  Default: nullptr
+     */
+    void setTransport(std::shared_ptr<Transport> pTransport);
+
     /**
      *  @brief  Retreive the error message string that correspond to
      *  the error code provided.
      *  @return A pointer to an allocated char array that pointed to the
      *  error message. The user is responsible to delete this pointer after
-     *  usage.
+     *  usage. ErrorResolver::findErrorMessage returns the same message
+     *  without any allocation.
      */
     static char *getErrorMessage(int errorCode);
 
@@ -135,17 +429,159 @@ class SMTPCLIENTBASE_API SMTPClientBase {
             char *errorMessagePtr,
             const size_t maxLength);
 
+    /**
+     *  @brief  Open a persistent session with the server.
+     *
+     *  The connection, the server greetings, the EHLO, the STARTTLS negotiation
+     *  and the authentication are done once. The following calls to sendMail
+     *  will reuse the session until disconnect is called. A transaction that
+     *  fails with a reply of the server is reset with RSET and the session is
+     *  kept, the session is only closed when the connection fails or when the
+     *  message content has been interrupted.
+     *  @return 0 for success or if the session is already opened, otherwise
+     *  the error code of the failed step.
+     */
+    int connect();
+
+    /**
+     *  @brief  Close the persistent session opened by connect.
+     *
+     *  A QUIT command is sent to the server and the connection is released.
+     *  @return 0 for success or if no session is opened, otherwise
+     *  CLIENT_SENDMAIL_QUIT_ERROR.
+     */
+    int disconnect();
+
+    /** Indicate if a persistent session is currently opened with the server. */
+    bool isConnected() const;
+
+    /**
+     *  @brief  Prepare a persistent session ahead of the first message.
+     *
+     *  The connection, the server greetings, the EHLO, the STARTTLS negotiation
+     *  and the authentication are done as by connect, so that the next sendMail
+     *  only sends the envelope and the content. When the session is already
+     *  opened, a NOOP command keeps it alive and a session dropped by the
+     *  server is opened again. Call it periodically to keep a parked session.
+     *  @return 0 for success, otherwise the error code of the failed step.
+     */
+    int prepare();
+
+    /**
+     *  @brief  Send a NOOP command on the persistent session to check that
+     *  the server is still responding.
+     *  @return 0 for success, CLIENT_SESSION_NOT_OPENED_ERROR if no session
+     *  is opened, otherwise the error code returned by the server.
+     */
+    int sendNoop();
+
+    /**
+     *  @brief  Send a message.
+     *
+     *  If a persistent session has been opened with connect, the message is
+     *  sent through it and the session remains open. Otherwise, a new
+     *  connection is established and closed once the message is sent.
+     *  @param pMsg The message to send.
+     *  @return 0 for success, otherwise the error code of the failed step.
+     */
     int sendMail(const Message &pMsg);
 
+    /**
+     *  @brief  Send a message to a subset of its recipients.
+     *
+     *  The envelope (RCPT TO) only contains the recipients provided while the
+     *  From, To and Cc headers of the message are kept unchanged. It is used
+     *  to deliver a message to the server of each recipient domain.
+     *  @param pMsg The message to send.
+     *  @param pEnvelopeRecipients The recipients array.
+     *  @param pEnvelopeRecipientCount The number of recipients in the array.
+     *  @return 0 for success, otherwise the error code of the failed step.
+     */
+    int sendMail(const Message &pMsg,
+            const MessageAddress *pEnvelopeRecipients,
+            size_t pEnvelopeRecipientCount);
+
+    /**
+     *  @brief  Send a message already rendered, usually by a MimeWriter.
+     *
+     *  The content is sent as is between the DATA command and the end of
+     *  data, so it is not encoded again when the message is retried.
+     *  @param pSenderAddress The email address of the envelope sender.
+     *  @param pRecipientAddresses The email addresses of the envelope recipients.
+     *  @param pRecipientCount The number of recipients in the array.
+     *  @param pContent The rendered headers and body.
+     *  @param pContentLength The length of the content.
+     *  @return 0 for success, otherwise the error code of the failed step.
+     */
+    int sendRenderedMail(const char *pSenderAddress,
+            const char * const *pRecipientAddresses,
+            size_t pRecipientCount,
+            const char *pContent,
+            size_t pContentLength);
+
+    /**
+     *  @brief  Send the same message to each recipient in its own mail
+     *  transaction over a single session.
+     *
+     *  The To header is rendered for each recipient and the To, Cc and Bcc
+     *  recipients of the template are ignored. A rejected recipient does not
+     *  stop the batch. If the server drops the session, it is reopened once
+     *  before the remaining recipients are marked as failed. A session
+     *  opened by this method is closed at the end, a persistent session
+     *  opened with connect remains open.
+     *  @param pTemplate The message to send.
+     *  @param pRecipients The recipients array.
+     *  @param pRecipientCount The number of recipients in the array.
+     *  @return The result of each recipient, in the order of the array.
+     */
+    std::vector<BulkRecipientResult> sendBulk(const Message &pTemplate,
+            const MessageAddress *pRecipients,
+            size_t pRecipientCount);
+
+    /**
+     *  @brief  Send a message template to each recipient of a mail merge in
+     *  its own mail transaction over a single session.
+     *
+     *  The template is rendered with the merge fields of each recipient
+     *  into a buffer reused for the whole batch, and the literal text of
+     *  the template is sent from the template itself. A recipient with a
+     *  missing merge field fails with CLIENT_TEMPLATE_FIELD_ERROR without
+     *  stopping the batch. The session is handled as by the other sendBulk.
+     *  @param pSenderAddress The email address of the envelope sender.
+     *  @param pTemplate The message template.
+     *  @param pRecipients The recipients array.
+     *  @param pRecipientCount The number of recipients in the array.
+     *  @return The result of each recipient, in the order of the array.
+     */
+    std::vector<BulkRecipientResult> sendBulk(const char *pSenderAddress,
+            const MessageTemplate &pTemplate,
+            const MergeRecipient *pRecipients,
+            size_t pRecipientCount);
+
+    /**
+     *  @brief  Retreive the outcome of the last sendMail or sendRenderedMail
+     *  call without any allocation.
+     *  @return The return code, its category and message, the phase that
+     *  failed and the last reply of the server. The views remain valid until
+     *  the next command sent by the client.
+     */
+    SendResult getLastSendResult() const;
+
  protected:
     virtual void cleanup() = 0;
     int getSocketFileDescriptor() const;
     void clearSocketFileDescriptor();
+    // Close the transport or the socket of the session
+    void closeSocket();
     const char *getLastServerResponse() const;
     void setLastSocketErrNo(int lastError);
     void setAuthenticationOptions(ServerAuthOptions *authOptions);
+    void setServerCapabilities(const ServerCapabilities &pCapabilities);
     // Methods used to establish the connection with server
     int initializeSession();
+    int initializeSessionTransport();
+    // The connection timeout of the options or else the command timeout
+    unsigned int getConnectTimeoutInMilliseconds() const;
     #ifdef _WIN32
     int initializeSessionWinSock();
     bool isWSAStarted();
@@ -166,37 +602,271 @@ class SMTPCLIENTBASE_API SMTPClientBase {
     int sendRawCommand(const char *pCommand, int pErrorCode, int pTimeoutCode);
     virtual int sendCommand(const char *pCommand, int pErrorCode) = 0;
     virtual int sendCommandWithFeedback(const char *pCommand, int pErrorCode, int pTimeoutCode) = 0;
+    // Send the segments in order with as few writes as possible. Each write
+    // contains at most getDataWriteSize() bytes.
+    int sendRawDataSegments(const std::string_view *pSegments, size_t pSegmentCount, int pErrorCode);
+    virtual int sendDataSegments(const std::string_view *pSegments, size_t pSegmentCount, int pErrorCode);
+    // Send the segments, the last one being a command, then read the reply
+    // of the command. Return its code, pErrorCode or pTimeoutCode.
+    virtual int sendDataSegmentsWithFeedback(const std::string_view *pSegments,
+            size_t pSegmentCount,
+            int pErrorCode,
+            int pTimeoutCode);
+    // Wait until data can be read or the timeout expires, then read it.
+    // Return the number of bytes received, 0 on timeout or -1 if the
+    // connection has been closed or an error occurred.
+    int waitForSocketData(unsigned int pTimeoutInMilliseconds);
+    int receiveRawData(char *pBuffer, size_t pLength, unsigned int pTimeoutInMilliseconds);
+    virtual int receiveData(char *pBuffer, size_t pLength, unsigned int pTimeoutInMilliseconds);
+    // Read a complete reply, possibly multi-line, and store it as the last
+    // server response. Return false on timeout or if the connection is closed.
+    bool readServerReply();
+    bool readRawServerReply();
+    const ServerReplyReader &getServerReplyReader() const;
+    void discardPendingServerData();
+    int readPipelinedResponses(size_t pCount,
+            std::vector<int> &pReturnCodes,
+            int pTimeoutCode,
+            std::vector<std::string> *pEnhancedStatusCodes = nullptr);
     // Methods used for authentication
     int authenticateClient();
     int authenticateWithMethodPlain();
     int authenticateWithMethodLogin();
-    // Methods to send an email
-    int setMailRecipients(const Message &pMsg);
-    int addMailRecipients(jed_utils::MessageAddress **list, size_t count, const int RECIPIENT_OK);
-    int setMailHeaders(const Message &pMsg);
-    int addMailHeader(const char *field, const char *value, int pErrorCode);
-    int setMailBody(const Message &pMsg);
+    int authenticateWithToken(OAuth2Mechanism pMechanism);
+    // Methods to send an email. When pRecipient is provided, it replaces all
+    // the recipients of the message in the envelope and in the headers.
+    // When pEnvelopeRecipients is provided, it replaces the recipients of the
+    // message in the envelope only.
+    // pMailParameters is appended to the MAIL FROM command, for instance
+    // BODY=8BITMIME, or nullptr
+    int setMailRecipients(const Message &pMsg,
+            const MessageAddress *pRecipients = nullptr,
+            size_t pRecipientCount = 1,
+            const char *pMailParameters = nullptr);
+    // The display name is only used by the first MAIL FROM format tried when
+    // the server does not support pipelining, nullptr skips this format
+    int setMailEnvelope(const char *pSenderAddress,
+            const char *pSenderDisplayName,
+            const std::vector<const char *> &pRecipientAddresses,
+            const char *pMailParameters = nullptr);
+    int setMailEnvelopePipelined(const char *pSenderAddress,
+            const std::vector<const char *> &pRecipientAddresses,
+            const char *pMailParameters = nullptr);
+    int addMailRecipients(const std::vector<const char *> &pRecipientAddresses, const int RECIPIENT_OK);
+    // Called when an envelope address is not ASCII (RFC 6531): add the
+    // SMTPUTF8 parameter when the server supports it, otherwise replace the
+    // addresses by those whose domains are converted to ASCII
+    int prepareInternationalizedEnvelope(const char *&pSenderAddress,
+            const std::vector<const char *> *&pRecipientAddresses,
+            const char *&pMailParameters);
+    int convertEnvelopeAddress(const char *pAddress, std::string &pAsciiAddress);
+    // Build the RCPT TO command of a recipient in a buffer reused for each
+    // recipient, with the NOTIFY parameter when it is requested
+    const std::string &buildRecipientCommand(const char *pAddress);
+    // Keep the reply of the recipient at pIndex in the envelope
+    void recordRecipientResult(size_t pIndex, int pReplyCode, std::string_view pEnhancedStatusCode);
+    // Append the RET and ENVID parameters when they are requested and the
+    // server supports DSN
+    void addDsnMailParameters(std::string &pMailParameters) const;
+    int sendDataCommand();
+    // The signature field, if any, is sent before the other header fields
+    int setMailHeaders(const Message &pMsg,
+            const MessageAddress *pRecipient = nullptr,
+            std::string_view pSignatureField = {});
+    int setMailBody(const Message &pMsg, const char *pBodyTransferEncoding = nullptr);
+    // Send the headers and the body with BDAT instead of DATA (RFC 3030)
+    int setMailBodyChunked(const Message &pMsg,
+            const MessageAddress *pRecipient,
+            bool pBinaryAttachments,
+            const char *pBodyTransferEncoding,
+            std::string_view pSignatureField = {});
+    // Send a chunk made of segments. The replies are read when the chunk is
+    // the last one or when the session is not pipelined.
+    int sendChunk(const std::string_view *pSegments,
+            size_t pSegmentCount,
+            bool pLast,
+            size_t &pPendingReplyCount);
+    // Read the replies of the pipelined chunks that have not been read yet,
+    // the connection is closed if they cannot be read. Return pReturnCode.
+    int readPendingChunkReplies(int pReturnCode, size_t &pPendingReplyCount);
+    // Send the last segments of the content followed by the end of data in
+    // the same writes and read its reply. pErrorCode is returned if the
+    // segments cannot be sent.
+    int sendEndOfData(std::vector<std::string_view> &pSegments, int pErrorCode);
+    // Hash the body of a message as it is sent and create its DKIM-Signature
+    // field
+    int createDkimSignatureField(const Message &pMsg,
+            const MessageAddress *pRecipient,
+            bool pBinaryAttachments,
+            const char *pBodyTransferEncoding,
+            std::string &pField) const;
+    // Same for a rendered message, whose header fields are its first lines
+    int createDkimSignatureField(const std::string_view *pContentSegments,
+            size_t pContentSegmentCount,
+            std::string &pField) const;
+    // The Content-Transfer-Encoding of each attachment of a message
+    std::vector<TransferEncoding> selectAttachmentEncodings(const Message &pMsg, bool pBinaryAttachments) const;
+    // Prepare the attachments on a separate thread when the message has
+    // several of them, nullptr when the sending thread reads them
+    std::unique_ptr<AttachmentPrefetcher> createAttachmentPrefetcher(const Message &pMsg,
+            const std::vector<TransferEncoding> &pEncodings) const;
+    // Pass the blocks of an attachment to the writer, from the prefetcher
+    // when there is one
+    int streamAttachment(const Attachment &pAttachment,
+            TransferEncoding pEncoding,
+            AttachmentPrefetcher *pPrefetcher,
+            const AttachmentBlockWriter &pWriter) const;
+    int sendAttachment(const Attachment &pAttachment,
+            TransferEncoding pEncoding = TransferEncoding::Base64,
+            AttachmentPrefetcher *pPrefetcher = nullptr);
+    int sendMailTransaction(const Message &pMsg,
+            const MessageAddress *pRecipient = nullptr,
+            const MessageAddress *pEnvelopeRecipients = nullptr,
+            size_t pEnvelopeRecipientCount = 0);
+    // The content is the concatenation of the segments
+    int sendRenderedMailTransaction(const char *pSenderAddress,
+            const char * const *pRecipientAddresses,
+            size_t pRecipientCount,
+            const std::string_view *pContentSegments,
+            size_t pContentSegmentCount);
+    // Run the transaction of each recipient of a bulk send over a single
+    // session
+    std::vector<BulkRecipientResult> runBulkTransactions(size_t pRecipientCount,
+            const std::function<int(size_t)> &pTransaction);
+    // Run a transaction on the persistent session or on a new connection
+    // closed once the transaction is done
+    int runMailTransaction(const std::function<int()> &pTransaction);
+    // Leave the persistent session ready for the next transaction after
+    // pReturnCode. Returns pReturnCode.
+    int finishMailTransaction(int pReturnCode);
+    // Keep pReturnCode for getLastSendResult. Returns pReturnCode.
+    int recordSendResult(int pReturnCode);
+    // Reset a failed transaction with RSET or close the connection when the
+    // server cannot read commands anymore
+    void recoverFailedTransaction();
+    // Refuse a message over the limit of the server or declare its size
+    // with the SIZE parameter of the MAIL FROM command
+    int addMessageSizeParameter(size_t pMessageSize, std::string &pMailParameters);
+    int resetMailTransaction();
+    int sendQuitCommand();
 
     void addCommunicationLogItem(const char *pItem, const char *pPrefix = "c");
-    static std::string createAttachmentsText(const std::vector<Attachment*> &pAttachments);
+    // Record a part of the message content, only at the Full level
+    void addCommunicationLogContent(std::initializer_list<std::string_view> pParts);
+    std::string createAttachmentHeader(const Attachment &pAttachment,
+            TransferEncoding pEncoding = TransferEncoding::Base64) const;
+    // Encode an attachment with the cache when there is one
+    int streamBase64EncodedAttachment(const Attachment &pAttachment,
+            const std::function<int(const std::string &pEncodedBlock)> &pWriter) const;
     static int extractReturnCode(const char *pOutput);
     static ServerAuthOptions *extractAuthenticationOptions(const char *pEhloOutput);
+    static ServerCapabilities extractServerCapabilities(const char *pEhloOutput);
+    // Capabilities of the last EHLO response, from the capability cache when
+    // the server has sent the same response before
+    ServerCapabilities resolveServerCapabilities(bool pSecure);
+    // Measure a phase between beginPhase and endPhase when an observer or a
+    // trace is set. endPhase returns pReturnCode.
+    void beginPhase();
+    int endPhase(SessionPhase pPhase, int pReturnCode);
+    // Report a completed TLS handshake to the observer and the trace
+    void recordTlsHandshake(bool pResumed);
+    void countWrite(size_t pBytesWritten);
+    void countRead(size_t pBytesRead);
+    void countWait();
+    // Start the deadline of an operation and forget the interruption of the
+    // previous one
+    void startOperation();
+    // Indicate if the operation has been cancelled or has reached its
+    // deadline. Checked by the waits and the writes.
+    bool isOperationInterrupted();
+    // Replace the error code of an interrupted operation by
+    // CLIENT_OPERATION_CANCELLED_ERROR or
+    // CLIENT_OPERATION_DEADLINE_EXCEEDED_ERROR. Returns the code.
+    int finishOperation(int pReturnCode);
+    // Limit a wait to the deadline of the operation
+    unsigned int limitToOperationDeadline(unsigned int pTimeoutInMilliseconds) const;
 
  private:
-    char *mServerName;
+    // The configuration is copied with the client, the session state is moved
+    // only: a copy starts without connection, log content and results
+    std::string mServerName;
     unsigned int mPort;
-    char *mCommunicationLog;
-    size_t mCommunicationLogSize = 0;
-    char *mLastServerResponse;
-    unsigned int mCommandTimeOut;
+    CommunicationLog mCommunicationLog { INITIAL_COMM_LOG_LENGTH };
+    std::string mLastServerResponse;
+    unsigned int mCommandTimeOutInMilliseconds;
     int mLastSocketErrNo;
-    ServerAuthOptions *mAuthOptions;
-    Credential *mCredential;
+    std::unique_ptr<ServerAuthOptions> mAuthOptions;
+    std::unique_ptr<Credential> mCredential;
+    // The AUTH PLAIN command, built once per credential
+    std::string mPlainAuthCommand;
+    ServerCapabilities mServerCapabilities;
+    bool mPipeliningEnabled = true;
+    bool mChunkingEnabled = true;
+    bool mTextAttachmentEncodingEnabled = false;
+    TransportOptions mTransportOptions;
+    DsnOptions mDsnOptions;
+    unsigned int mOperationTimeoutInMilliseconds = 0;
+    std::shared_ptr<CancellationToken> mCancellationToken;
+    size_t mAttachmentPrefetchBlockCount = 4;
+    std::shared_ptr<EncodedAttachmentCache> mEncodedAttachmentCache;
+    std::shared_ptr<CapabilityCache> mCapabilityCache;
+    std::shared_ptr<const DkimSigner> mDkimSigner;
+    std::shared_ptr<SessionObserver> mSessionObserver;
+    std::shared_ptr<SessionTrace> mSessionTrace;
+    std::shared_ptr<Transport> mTransport;
+    IoCounters mIoCounters;
+    std::chrono::steady_clock::time_point mPhaseStartTime;
+    IoCounters mPhaseStartIoCounters;
     int mSock = 0;
+    bool mSessionOpened = false;
+    // A session has been opened before, the next one is a reconnection
+    bool mSessionOpenedBefore = false;
+    // A transaction has been started and has neither completed nor been reset
+    bool mTransactionResetRequired = false;
+    // The connection is established and has not been closed by cleanup
+    bool mConnectionOpened = false;
+    // The server reads the message content until the end of data
+    bool mMessageContentStarted = false;
+    ServerReplyReader mReplyReader;
+    // Receives the data of the replies, not copied with the client
+    std::vector<char> mReadBuffer;
+    // Enhanced status code of the reply that determined the result of the
+    // last command or group of pipelined commands
+    std::string mLastEnhancedStatusCode;
+    // Reply to each RCPT TO command of the last transaction, the array is
+    // reused by the next transactions
+    std::vector<RecipientResult> mRecipientResults;
+    // RCPT TO command being built, reused for each recipient
+    std::string mRecipientCommand;
+    // ASCII form of the internationalized domains of the envelopes, and
+    // envelope whose domains are converted or MAIL FROM parameters with
+    // SMTPUTF8, reused by the transactions
+    IdnaConverter mIdnaConverter;
+    std::vector<std::string> mEnvelopeAddresses;
+    std::vector<const char *> mEnvelopeRecipients;
+    std::string mEnvelopeParameters;
+    // Boundary of the message being sent, generated for each transaction
+    MimeBoundary mBoundary;
+    // Outcome of the last sendMail or sendRenderedMail call
+    int mLastSendReturnCode = 0;
+    bool mLastSendPhaseFailed = false;
+    SessionPhase mLastSendFailedPhase = SessionPhase::Connection;
+    // Deadline of the current operation, time_point::max() without timeout
+    std::chrono::steady_clock::time_point mOperationDeadline { std::chrono::steady_clock::time_point::max() };
+    bool mOperationInterrupted = false;
+    // Content of the DATA section not sent yet: the headers until the body
+    // is sent and the closing delimiter until the end of data
+    std::string mOutputBuffer;
     #ifdef _WIN32
     bool mWSAStarted = false;
     #endif
 
+    bool readServerReply(int (SMTPClientBase::*pReceiveData)(char *pBuffer, size_t pLength, unsigned int pTimeoutInMilliseconds));
+    // Wait once for the data of the transport or the socket
+    int pollSocketData(unsigned int pTimeoutInMilliseconds);
+    // Report a session opened by connect or by a send to the observer and the trace
+    void recordSessionOpened();
+
     // This field indicate the class will keep using base send command even if a child class
     // as overriden the sendCommand and sendCommandWithFeedback.
     // This is used for example if you are using a secure client class but the STARTTLS
@@ -205,6 +875,8 @@ class SMTPCLIENTBASE_API SMTPClientBase {
 
     int (SMTPClientBase::*sendCommandPtr)(const char *pCommand, int pErrorCode);
     int (SMTPClientBase::*sendCommandWithFeedbackPtr)(const char *pCommand, int pErrorCode, int pTimeoutCode);
+    int (SMTPClientBase::*receiveDataPtr)(char *pBuffer, size_t pLength, unsigned int pTimeoutInMilliseconds);
+    int (SMTPClientBase::*sendDataSegmentsPtr)(const std::string_view *pSegments, size_t pSegmentCount, int pErrorCode);
 };
 }  // namespace jed_utils
 
@@ -0,0 +1,248 @@
+#include "smtpclientconfig.h"
+#include <stdexcept>
+#include <utility>
+#include "forcedsecuresmtpclient.h"
+#include "opportunisticsecuresmtpclient.h"
+#include "smtpclient.h"
+#include "stringutils.h"
+
+using namespace jed_utils;
+
+SmtpClientConfig::SmtpClientConfig(SmtpClientType pType, const char *pServerName, unsigned int pPort)
+    : mClientType(pType),
+      mPort(pPort) {
+    if (pServerName == nullptr || StringUtils::trim(std::string(pServerName)).empty()) {
+        throw std::invalid_argument("Server name cannot be null or empty");
+    }
+    mServerName = pServerName;
+}
+
+SmtpClientType SmtpClientConfig::getClientType() const {
+    return mClientType;
+}
+
+const char *SmtpClientConfig::getServerName() const {
+    return mServerName.c_str();
+}
+
+unsigned int SmtpClientConfig::getServerPort() const {
+    return mPort;
+}
+
+unsigned int SmtpClientConfig::getCommandTimeoutInMilliseconds() const {
+    return mCommandTimeOutInMilliseconds;
+}
+
+unsigned int SmtpClientConfig::getOperationTimeoutInMilliseconds() const {
+    return mOperationTimeoutInMilliseconds;
+}
+
+const Credential *SmtpClientConfig::getCredentials() const {
+    return mCredential.has_value() ? &*mCredential : nullptr;
+}
+
+bool SmtpClientConfig::isPipeliningEnabled() const {
+    return mPipeliningEnabled;
+}
+
+bool SmtpClientConfig::isChunkingEnabled() const {
+    return mChunkingEnabled;
+}
+
+bool SmtpClientConfig::isTextAttachmentEncodingEnabled() const {
+    return mTextAttachmentEncodingEnabled;
+}
+
+size_t SmtpClientConfig::getDataWriteSize() const {
+    return mTransportOptions.WriteSize;
+}
+
+const TransportOptions &SmtpClientConfig::getTransportOptions() const {
+    return mTransportOptions;
+}
+
+const DsnOptions &SmtpClientConfig::getDsnOptions() const {
+    return mDsnOptions;
+}
+
+size_t SmtpClientConfig::getAttachmentPrefetchBlockCount() const {
+    return mAttachmentPrefetchBlockCount;
+}
+
+CommunicationLogLevel SmtpClientConfig::getCommunicationLogLevel() const {
+    return mCommunicationLogLevel;
+}
+
+size_t SmtpClientConfig::getCommunicationLogCapacity() const {
+    return mCommunicationLogCapacity;
+}
+
+std::shared_ptr<TlsContext> SmtpClientConfig::getTlsContext() const {
+    return mTlsContext;
+}
+
+std::shared_ptr<EncodedAttachmentCache> SmtpClientConfig::getEncodedAttachmentCache() const {
+    return mEncodedAttachmentCache;
+}
+
+std::shared_ptr<CapabilityCache> SmtpClientConfig::getCapabilityCache() const {
+    return mCapabilityCache;
+}
+
+std::shared_ptr<const DkimSigner> SmtpClientConfig::getDkimSigner() const {
+    return mDkimSigner;
+}
+
+std::shared_ptr<SessionObserver> SmtpClientConfig::getSessionObserver() const {
+    return mSessionObserver;
+}
+
+size_t SmtpClientConfig::getSessionTraceCapacity() const {
+    return mSessionTraceCapacity;
+}
+
+const TransportFactory &SmtpClientConfig::getTransportFactory() const {
+    return mTransportFactory;
+}
+
+void SmtpClientConfig::setCommandTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds) {
+    mCommandTimeOutInMilliseconds = pTimeOutInMilliseconds;
+}
+
+void SmtpClientConfig::setOperationTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds) {
+    mOperationTimeoutInMilliseconds = pTimeOutInMilliseconds;
+}
+
+void SmtpClientConfig::setCredentials(const Credential &pCredential) {
+    mCredential.emplace(pCredential);
+}
+
+void SmtpClientConfig::setPipeliningEnabled(bool pValue) {
+    mPipeliningEnabled = pValue;
+}
+
+void SmtpClientConfig::setChunkingEnabled(bool pValue) {
+    mChunkingEnabled = pValue;
+}
+
+void SmtpClientConfig::setTextAttachmentEncodingEnabled(bool pValue) {
+    mTextAttachmentEncodingEnabled = pValue;
+}
+
+void SmtpClientConfig::setDataWriteSize(size_t pWriteSize) {
+    mTransportOptions.WriteSize = pWriteSize;
+}
+
+void SmtpClientConfig::setTransportOptions(const TransportOptions &pOptions) {
+    mTransportOptions = pOptions;
+}
+
+void SmtpClientConfig::setDsnOptions(const DsnOptions &pOptions) {
+    mDsnOptions = pOptions;
+}
+
+void SmtpClientConfig::setAttachmentPrefetchBlockCount(size_t pBlockCount) {
+    mAttachmentPrefetchBlockCount = pBlockCount;
+}
+
+void SmtpClientConfig::setCommunicationLogLevel(CommunicationLogLevel pLevel) {
+    mCommunicationLogLevel = pLevel;
+}
+
+void SmtpClientConfig::setCommunicationLogCapacity(size_t pCapacity) {
+    mCommunicationLogCapacity = pCapacity;
+}
+
+void SmtpClientConfig::setCommunicationLogSink(CommunicationLogSink pSink) {
+    mCommunicationLogSink = std::move(pSink);
+}
+
+void SmtpClientConfig::setTlsContext(std::shared_ptr<TlsContext> pTlsContext) {
+    mTlsContext = std::move(pTlsContext);
+}
+
+void SmtpClientConfig::setEncodedAttachmentCache(std::shared_ptr<EncodedAttachmentCache> pCache) {
+    mEncodedAttachmentCache = std::move(pCache);
+}
+
+void SmtpClientConfig::setCapabilityCache(std::shared_ptr<CapabilityCache> pCache) {
+    mCapabilityCache = std::move(pCache);
+}
+
+void SmtpClientConfig::setDkimSigner(std::shared_ptr<const DkimSigner> pSigner) {
+    mDkimSigner = std::move(pSigner);
+}
+
+void SmtpClientConfig::setSessionObserver(std::shared_ptr<SessionObserver> pObserver) {
+    mSessionObserver = std::move(pObserver);
+}
+
+void SmtpClientConfig::setSessionTraceCapacity(size_t pCapacity) {
+    mSessionTraceCapacity = pCapacity;
+}
+
+void SmtpClientConfig::setTransportFactory(TransportFactory pFactory) {
+    mTransportFactory = std::move(pFactory);
+}
+
+std::unique_ptr<SMTPClientBase> SmtpClientConfig::createClient() const {
+    std::unique_ptr<SMTPClientBase> client;
+    switch (mClientType) {
+        case SmtpClientType::Plain:
+            client = std::make_unique<SmtpClient>(mServerName.c_str(), mPort);
+            break;
+        case SmtpClientType::OpportunisticSecure: {
+            auto secure_client = std::make_unique<OpportunisticSecureSMTPClient>(mServerName.c_str(), mPort);
+            secure_client->setTlsContext(mTlsContext);
+            client = std::move(secure_client);
+            break;
+        }
+        case SmtpClientType::ForcedSecure: {
+            auto secure_client = std::make_unique<ForcedSecureSMTPClient>(mServerName.c_str(), mPort);
+            secure_client->setTlsContext(mTlsContext);
+            client = std::move(secure_client);
+            break;
+        }
+    }
+    if (client == nullptr) {
+        return nullptr;
+    }
+    client->setCommandTimeoutInMilliseconds(mCommandTimeOutInMilliseconds);
+    client->setOperationTimeoutInMilliseconds(mOperationTimeoutInMilliseconds);
+    if (mCredential.has_value()) {
+        client->setCredentials(*mCredential);
+    }
+    client->setPipeliningEnabled(mPipeliningEnabled);
+    client->setChunkingEnabled(mChunkingEnabled);
+    client->setTextAttachmentEncodingEnabled(mTextAttachmentEncodingEnabled);
+    client->setTransportOptions(mTransportOptions);
+    client->setDsnOptions(mDsnOptions);
+    client->setAttachmentPrefetchBlockCount(mAttachmentPrefetchBlockCount);
+    client->setCommunicationLogLevel(mCommunicationLogLevel);
+    // The log of a new client is already allocated with the default capacity
+    if (mCommunicationLogCapacity != client->getCommunicationLogCapacity()) {
+        client->setCommunicationLogCapacity(mCommunicationLogCapacity);
+    }
+    if (mCommunicationLogSink) {
+        client->setCommunicationLogSink(mCommunicationLogSink);
+    }
+    client->setEncodedAttachmentCache(mEncodedAttachmentCache);
+    client->setCapabilityCache(mCapabilityCache);
+    client->setDkimSigner(mDkimSigner);
+    client->setSessionObserver(mSessionObserver);
+    client->setSessionTraceCapacity(mSessionTraceCapacity);
+    if (mTransportFactory) {
+        client->setTransport(mTransportFactory());
+    }
+    return client;
+}
+
+int SmtpClientConfig::sendMail(const Message &pMsg) const {
+    return createClient()->sendMail(pMsg);
+}
+
+int SmtpClientConfig::sendMail(const Message &pMsg,
+        const MessageAddress *pEnvelopeRecipients,
+        size_t pEnvelopeRecipientCount) const {
+    return createClient()->sendMail(pMsg, pEnvelopeRecipients, pEnvelopeRecipientCount);
+}
@@ -0,0 +1,266 @@
+#ifndef SMTPCLIENTCONFIG_H
+#define SMTPCLIENTCONFIG_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include "capabilitycache.h"
+#include "communicationlog.h"
+#include "credential.h"
+#include "dkimsigner.h"
+#include "dsnoptions.h"
+#include "encodedattachmentcache.h"
+#include "message.h"
+#include "messageaddress.h"
+#include "sessionobserver.h"
+#include "smtpclientbase.h"
+#include "tlscontext.h"
+#include "transport.h"
+#include "transportoptions.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define SMTPCLIENTCONFIG_API __declspec(dllexport)
+    #else
+        #define SMTPCLIENTCONFIG_API __declspec(dllimport)
+    #endif
+#else
+    #define SMTPCLIENTCONFIG_API
+#endif
+
+namespace jed_utils {
+/** @brief The SmtpClientType enumeration indicates which SMTP client class
+ *  is instantiated by the SmtpClientConfig and the SmtpConnectionPool.
+ */
+enum class SmtpClientType {
+    /** The SmtpClient class (no encryption). */
+    Plain,
+    /** The OpportunisticSecureSMTPClient class (STARTTLS). */
+    OpportunisticSecure,
+    /** The ForcedSecureSMTPClient class (TLS from the initial connection). */
+    ForcedSecure
+};
+
+/** @brief The function that creates the transport of each new session. */
+using TransportFactory = std::function<std::shared_ptr<Transport>()>;
+
+/** @brief The SmtpClientConfig class holds the configuration of an SMTP
+ *  client (server, credential, timeouts, extensions, shared resources)
+ *  without any state of a session.
+ *
+ *  A configuration is set up once and then shared, usually as a
+ *  std::shared_ptr<const SmtpClientConfig>. Its const methods can be called
+ *  by any number of threads at the same time: each call that sends a message
+ *  creates its own session (an SMTPClientBase), so the threads share neither
+ *  a socket nor a communication log and take no lock. The setters must not be
+ *  called while the configuration is shared.
+ */
+class SMTPCLIENTCONFIG_API SmtpClientConfig {
+ public:
+    /**
+     *  @brief  Construct a new SmtpClientConfig.
+     *  @param pType The SMTP client class of the sessions.
+     *  @param pServerName The name of the server.
+     *  @param pPort The server port number.
+     */
+    SmtpClientConfig(SmtpClientType pType, const char *pServerName, unsigned int pPort);
+
+    /** Return the SMTP client class of the sessions. */
+    SmtpClientType getClientType() const;
+
+    /** Return the server name. */
+    const char *getServerName() const;
+
+    /** Return the server port number. */
+    unsigned int getServerPort() const;
+
+    /** Return the command timeout in milliseconds. */
+    unsigned int getCommandTimeoutInMilliseconds() const;
+
+    /** Return the maximum duration of an operation in milliseconds, 0 if
+     *  only the command timeout applies. */
+    unsigned int getOperationTimeoutInMilliseconds() const;
+
+    /** Return the credential or nullptr if the sessions do not authenticate. */
+    const Credential *getCredentials() const;
+
+    /** Indicate if the PIPELINING extension is used when it is available. */
+    bool isPipeliningEnabled() const;
+
+    /** Indicate if the CHUNKING extension is used when it is available. */
+    bool isChunkingEnabled() const;
+
+    /** Indicate if the encoding of the text attachments is chosen from their content. */
+    bool isTextAttachmentEncodingEnabled() const;
+
+    /** Return the size of the writes of the message content. */
+    size_t getDataWriteSize() const;
+
+    /** Return the buffer sizes and the socket options of the sessions. */
+    const TransportOptions &getTransportOptions() const;
+
+    /** Return the delivery status notifications requested. */
+    const DsnOptions &getDsnOptions() const;
+
+    /** Return the maximum number of attachment blocks prepared in advance. */
+    size_t getAttachmentPrefetchBlockCount() const;
+
+    /** Return the level of the communication log of the sessions. */
+    CommunicationLogLevel getCommunicationLogLevel() const;
+
+    /** Return the capacity of the communication log of the sessions. */
+    size_t getCommunicationLogCapacity() const;
+
+    /** Return the TLS context of the secure sessions or nullptr to use
+     *  TlsContext::getDefault(). */
+    std::shared_ptr<TlsContext> getTlsContext() const;
+
+    /** Return the encoded attachment cache or nullptr if none is used. */
+    std::shared_ptr<EncodedAttachmentCache> getEncodedAttachmentCache() const;
+
+    /** Return the capability cache or nullptr if none is used. */
+    std::shared_ptr<CapabilityCache> getCapabilityCache() const;
+
+    /** Return the DKIM signer or nullptr if the messages are not signed. */
+    std::shared_ptr<const DkimSigner> getDkimSigner() const;
+
+    /** Return the session observer or nullptr if none is used. */
+    std::shared_ptr<SessionObserver> getSessionObserver() const;
+
+    /** Return the number of protocol events traced per session, 0 if they
+     *  are not traced. */
+    size_t getSessionTraceCapacity() const;
+
+    /** Return the factory of the transports or an empty function if the
+     *  sessions connect their own socket. */
+    const TransportFactory &getTransportFactory() const;
+
+    /** Set the command timeout in milliseconds. Default: 5000 */
+    void setCommandTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds);
+
+    /** Set the maximum duration of each operation of the sessions, see
+     *  SMTPClientBase::setOperationTimeoutInMilliseconds. Default: 0 */
+    void setOperationTimeoutInMilliseconds(unsigned int pTimeOutInMilliseconds);
+
+    /** Set the credential used to authenticate. */
+    void setCredentials(const Credential &pCredential);
+
+    /** Indicate if the PIPELINING extension is used. Default: true */
+    void setPipeliningEnabled(bool pValue);
+
+    /** Indicate if the CHUNKING extension is used. Default: true */
+    void setChunkingEnabled(bool pValue);
+
+    /** Indicate if the text attachments are sent in 7bit or in
+     *  quoted-printable when it is smaller than base64. Default: false */
+    void setTextAttachmentEncodingEnabled(bool pValue);
+
+    /** Set the size of the writes of the message content. Default: 65536 */
+    void setDataWriteSize(size_t pWriteSize);
+
+    /** Set the buffer sizes and the socket options of the sessions, the
+     *  write size included. */
+    void setTransportOptions(const TransportOptions &pOptions);
+
+    /** Set the delivery status notifications requested to the servers that
+     *  advertise DSN. Default: no parameter */
+    void setDsnOptions(const DsnOptions &pOptions);
+
+    /** Set the maximum number of attachment blocks prepared in advance, 0 to
+     *  prepare the attachments on the sending thread. Default: 4 */
+    void setAttachmentPrefetchBlockCount(size_t pBlockCount);
+
+    /** Set the level of the communication log of the sessions.
+     *  Default: CommunicationLogLevel::Full */
+    void setCommunicationLogLevel(CommunicationLogLevel pLevel);
+
+    /** Set the capacity of the communication log of the sessions.
+     *  Default: 65536 */
+    void setCommunicationLogCapacity(size_t pCapacity);
+
+    /**
+     *  @brief  Set the function that receives the communication log items of
+     *  all the sessions. It is called by the threads that send.
+     */
+    void setCommunicationLogSink(CommunicationLogSink pSink);
+
+    /** Set the TLS context shared by the secure sessions. */
+    void setTlsContext(std::shared_ptr<TlsContext> pTlsContext);
+
+    /** Set the encoded attachment cache shared by the sessions. */
+    void setEncodedAttachmentCache(std::shared_ptr<EncodedAttachmentCache> pCache);
+
+    /** Set the capability cache shared by the sessions. */
+    void setCapabilityCache(std::shared_ptr<CapabilityCache> pCache);
+
+    /** Set the DKIM signer shared by the sessions. */
+    void setDkimSigner(std::shared_ptr<const DkimSigner> pSigner);
+
+    /** Set the observer shared by the sessions. It is called by the threads
+     *  that send. */
+    void setSessionObserver(std::shared_ptr<SessionObserver> pObserver);
+
+    /** Set the number of protocol events traced by each session, see
+     *  SMTPClientBase::setSessionTraceCapacity. Default: 0 */
+    void setSessionTraceCapacity(size_t pCapacity);
+
+    /**
+     *  @brief  Set the function that creates the transport of each client
+     *  created by this configuration. It is called by the threads that send
+     *  and must be thread-safe.
+     *  @param pFactory The factory or an empty function to connect a socket.
+     */
+    void setTransportFactory(TransportFactory pFactory);
+
+    /**
+     *  @brief  Create a new client configured with this configuration. The
+     *  client is not connected.
+     */
+    std::unique_ptr<SMTPClientBase> createClient() const;
+
+    /**
+     *  @brief  Send a message in a new session that is closed afterwards.
+     *  Thread-safe.
+     *  @return 0 for success, otherwise the error code of the failed step.
+     */
+    int sendMail(const Message &pMsg) const;
+
+    /**
+     *  @brief  Send a message to the envelope recipients in a new session
+     *  that is closed afterwards. Thread-safe.
+     *  @return 0 for success, otherwise the error code of the failed step.
+     */
+    int sendMail(const Message &pMsg,
+            const MessageAddress *pEnvelopeRecipients,
+            size_t pEnvelopeRecipientCount) const;
+
+ private:
+    SmtpClientType mClientType;
+    std::string mServerName;
+    unsigned int mPort;
+    unsigned int mCommandTimeOutInMilliseconds = 5000;
+    unsigned int mOperationTimeoutInMilliseconds = 0;
+    std::optional<Credential> mCredential;
+    bool mPipeliningEnabled = true;
+    bool mChunkingEnabled = true;
+    bool mTextAttachmentEncodingEnabled = false;
+    TransportOptions mTransportOptions;
+    DsnOptions mDsnOptions;
+    size_t mAttachmentPrefetchBlockCount = 4;
+    CommunicationLogLevel mCommunicationLogLevel = CommunicationLogLevel::Full;
+    size_t mCommunicationLogCapacity = INITIAL_COMM_LOG_LENGTH;
+    CommunicationLogSink mCommunicationLogSink;
+    std::shared_ptr<TlsContext> mTlsContext;
+    std::shared_ptr<EncodedAttachmentCache> mEncodedAttachmentCache;
+    std::shared_ptr<CapabilityCache> mCapabilityCache;
+    std::shared_ptr<const DkimSigner> mDkimSigner;
+    std::shared_ptr<SessionObserver> mSessionObserver;
+    size_t mSessionTraceCapacity = 0;
+    TransportFactory mTransportFactory;
+};
+}  // namespace jed_utils
+
+#endif
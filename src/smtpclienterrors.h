@@ -23,6 +23,51 @@ const int CLIENT_SENDMAIL_BODY_ERROR = -96;
 const int CLIENT_SENDMAIL_END_DATA_ERROR = -97;
 const int CLIENT_SENDMAIL_END_DATA_TIMEOUT = -98;
 const int CLIENT_SENDMAIL_QUIT_ERROR = -99;
+const int CLIENT_SENDMAIL_RSET_ERROR = -100;
+const int CLIENT_SENDMAIL_RSET_TIMEOUT = -101;
+
+// Persistent session error codes
+const int CLIENT_SESSION_NOOP_ERROR = -102;
+const int CLIENT_SESSION_NOOP_TIMEOUT = -103;
+const int CLIENT_SESSION_NOT_OPENED_ERROR = -104;
+
+// Direct delivery error codes
+const int CLIENT_DELIVERY_MX_LOOKUP_ERROR = -105;
+const int CLIENT_DELIVERY_NULL_MX_ERROR = -106;
+const int CLIENT_DELIVERY_INVALID_DOMAIN_ERROR = -107;
+
+// Mail queue error codes
+const int CLIENT_QUEUE_FULL_ERROR = -108;
+const int CLIENT_QUEUE_STOPPED_ERROR = -109;
+
+// Mail spool error codes
+const int CLIENT_SPOOL_IO_ERROR = -110;
+const int CLIENT_SPOOL_EMPTY_ERROR = -111;
+const int CLIENT_SPOOL_CORRUPT_RECORD_ERROR = -122;
+
+// Chunking error codes
+const int CLIENT_SENDMAIL_BDAT_ERROR = -112;
+const int CLIENT_SENDMAIL_BDAT_TIMEOUT = -113;
+
+// Message size error codes
+const int CLIENT_SENDMAIL_MESSAGE_SIZE_EXCEEDED_ERROR = -114;
+
+// OAuth 2.0 error codes
+const int CLIENT_AUTHENTICATE_TOKEN_ERROR = -115;
+
+// Message template error codes
+const int CLIENT_TEMPLATE_FIELD_ERROR = -116;
+
+// DKIM error codes
+const int CLIENT_DKIM_SIGNATURE_ERROR = -117;
+
+// Deadline and cancellation error codes
+const int CLIENT_OPERATION_DEADLINE_EXCEEDED_ERROR = -118;
+const int CLIENT_OPERATION_CANCELLED_ERROR = -119;
+
+// Internationalized address error codes
+const int CLIENT_SENDMAIL_SMTPUTF8_NOT_SUPPORTED_ERROR = -120;
+const int CLIENT_SENDMAIL_IDNA_CONVERSION_ERROR = -121;
 
 // SMTP standard error code
 const int SMTPSERVER_AUTHENTICATIONREQUIRED_ERROR = 530;
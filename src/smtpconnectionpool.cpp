@@ -0,0 +1,359 @@
+#include "smtpconnectionpool.h"
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <tuple>
+#include <utility>
+
+using namespace jed_utils;
+
+namespace {
+const int KEY_SALT_LENGTH = 16;
+
+// Only a failure before the content can be sent again (the reset of a
+// previous transaction is not part of a phase), once the server has received
+// the content it might have accepted the message
+bool isRetryableFailure(const SMTPClientBase &pClient) {
+    const SendResult result = pClient.getLastSendResult();
+    return !pClient.isConnected() &&
+        (!result.HasFailedPhase || result.FailedPhase <= SessionPhase::Envelope);
+}
+}  // namespace
+
+bool SmtpConnectionPool::PoolKey::operator<(const PoolKey &other) const {
+    return std::tie(type, serverName, port, hasCredential, username, passwordHash, tokenSource)
+        < std::tie(other.type, other.serverName, other.port, other.hasCredential, other.username, other.passwordHash, other.tokenSource);
+}
+
+SmtpConnectionPool::SmtpConnectionPool(size_t pMaxSessionsPerServer,
+        unsigned int pIdleTimeoutInSeconds,
+        unsigned int pHealthCheckIntervalInSeconds)
+    : mMaxSessionsPerServer(pMaxSessionsPerServer == 0 ? 1 : pMaxSessionsPerServer),
+      mIdleTimeout(pIdleTimeoutInSeconds),
+      mHealthCheckInterval(pHealthCheckIntervalInSeconds),
+      mCapabilityCache(std::make_shared<CapabilityCache>()) {
+    unsigned char salt[KEY_SALT_LENGTH];
+    if (RAND_bytes(salt, KEY_SALT_LENGTH) == 1) {
+        mKeySalt.assign(reinterpret_cast<const char *>(salt), KEY_SALT_LENGTH);
+    }
+}
+
+SmtpConnectionPool::~SmtpConnectionPool() {
+    for (auto &item : mEntries) {
+        for (auto &session : item.second.idle) {
+            session.client->disconnect();
+        }
+    }
+}
+
+SMTPClientBase *SmtpConnectionPool::createClient(const PoolKey &pKey,
+        const Credential *pCredential,
+        const std::shared_ptr<TlsContext> &pTlsContext,
+        const std::shared_ptr<SessionObserver> &pSessionObserver,
+        const TransportFactory &pTransportFactory) const {
+    SmtpClientConfig config(pKey.type, pKey.serverName.c_str(), pKey.port);
+    config.setTlsContext(pTlsContext);
+    config.setSessionObserver(pSessionObserver);
+    config.setCapabilityCache(mCapabilityCache);
+    config.setTransportFactory(pTransportFactory);
+    if (pCredential != nullptr) {
+        config.setCredentials(*pCredential);
+    }
+    return config.createClient().release();
+}
+
+SmtpConnectionPool::PoolKey SmtpConnectionPool::makeKey(SmtpClientType pType,
+        const char *pServerName,
+        unsigned int pPort,
+        const Credential *pCredential) const {
+    PoolKey key;
+    key.type = pType;
+    key.serverName = pServerName == nullptr ? "" : pServerName;
+    key.port = pPort;
+    key.hasCredential = pCredential != nullptr;
+    key.username = pCredential != nullptr ? pCredential->getUsername() : "";
+    if (pCredential != nullptr && pCredential->getTokenSource() == nullptr) {
+        const std::string salted_password = mKeySalt + pCredential->getPassword();
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digest_length = 0;
+        if (EVP_Digest(salted_password.data(), salted_password.size(), digest, &digest_length, EVP_sha256(), nullptr) == 1) {
+            key.passwordHash.assign(reinterpret_cast<const char *>(digest), digest_length);
+        }
+    }
+    key.tokenSource = pCredential != nullptr ? pCredential->getTokenSource() : nullptr;
+    return key;
+}
+
+SMTPClientBase *SmtpConnectionPool::acquire(SmtpClientType pType,
+        const char *pServerName,
+        unsigned int pPort,
+        const Credential *pCredential,
+        int *pErrorCode) {
+    if (pErrorCode != nullptr) {
+        *pErrorCode = 0;
+    }
+    const PoolKey key = makeKey(pType, pServerName, pPort, pCredential);
+    std::unique_lock<std::mutex> lock(mMutex);
+    PoolEntry &entry = mEntries[key];
+    while (true) {
+        // Reuse the most recently released session first
+        while (!entry.idle.empty()) {
+            IdleSession session = std::move(entry.idle.back());
+            entry.idle.pop_back();
+            auto idleTime = std::chrono::steady_clock::now() - session.lastUsed;
+            if (idleTime >= mIdleTimeout || !session.client->isConnected()) {
+                entry.opened--;
+                lock.unlock();
+                session.client->disconnect();
+                session.client.reset();
+                lock.lock();
+                continue;
+            }
+            SMTPClientBase *client = session.client.release();
+            mCheckedOut[client] = key;
+            if (idleTime < mHealthCheckInterval) {
+                return client;
+            }
+            // The session has been idle for a while, make sure it is still alive
+            lock.unlock();
+            if (client->sendNoop() == 0) {
+                return client;
+            }
+            release(client, true);
+            lock.lock();
+        }
+
+        if (entry.opened < mMaxSessionsPerServer) {
+            entry.opened++;
+            std::shared_ptr<TlsContext> tls_context = mTlsContext;
+            std::shared_ptr<SessionObserver> session_observer = mSessionObserver;
+            TransportFactory transport_factory = mTransportFactory;
+            lock.unlock();
+            std::unique_ptr<SMTPClientBase> client(createClient(key, pCredential, tls_context, session_observer, transport_factory));
+            int connect_ret_code = client->connect();
+            lock.lock();
+            if (connect_ret_code != 0) {
+                entry.opened--;
+                lock.unlock();
+                mSessionReleased.notify_all();
+                if (pErrorCode != nullptr) {
+                    *pErrorCode = connect_ret_code;
+                }
+                return nullptr;
+            }
+            mCheckedOut[client.get()] = key;
+            return client.release();
+        }
+
+        mSessionReleased.wait(lock);
+    }
+}
+
+void SmtpConnectionPool::release(SMTPClientBase *pClient, bool pDiscard) {
+    if (pClient == nullptr) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mMutex);
+    auto checkedOut = mCheckedOut.find(pClient);
+    if (checkedOut == mCheckedOut.end()) {
+        return;
+    }
+    PoolEntry &entry = mEntries[checkedOut->second];
+    mCheckedOut.erase(checkedOut);
+    if (pDiscard || !pClient->isConnected()) {
+        entry.opened--;
+        lock.unlock();
+        pClient->disconnect();
+        delete pClient;
+    } else {
+        IdleSession session;
+        session.client.reset(pClient);
+        session.lastUsed = std::chrono::steady_clock::now();
+        entry.idle.push_back(std::move(session));
+        lock.unlock();
+    }
+    mSessionReleased.notify_all();
+}
+
+int SmtpConnectionPool::sendMail(SmtpClientType pType,
+        const char *pServerName,
+        unsigned int pPort,
+        const Credential *pCredential,
+        const Message &pMsg) {
+    int acquire_ret_code = 0;
+    SMTPClientBase *client = acquire(pType, pServerName, pPort, pCredential, &acquire_ret_code);
+    if (client == nullptr) {
+        return acquire_ret_code;
+    }
+    int send_ret_code = client->sendMail(pMsg);
+    if (send_ret_code != 0 && isRetryableFailure(*client)) {
+        // The server has dropped the session, reconnect and try again once
+        release(client, true);
+        client = acquire(pType, pServerName, pPort, pCredential, &acquire_ret_code);
+        if (client == nullptr) {
+            return acquire_ret_code;
+        }
+        send_ret_code = client->sendMail(pMsg);
+    }
+    release(client);
+    return send_ret_code;
+}
+
+int SmtpConnectionPool::sendMail(SmtpClientType pType,
+        RelayGroup &pRelays,
+        const Credential *pCredential,
+        const Message &pMsg) {
+    std::vector<size_t> tried;
+    int ret_code = 0;
+    size_t index = 0;
+    while (pRelays.acquire(index, tried)) {
+        const RelayEndpoint &endpoint = pRelays.getEndpoint(index);
+        ret_code = sendMail(pType, endpoint.ServerName.c_str(), endpoint.Port, pCredential, pMsg);
+        pRelays.release(index, ret_code);
+        if (!RelayGroup::isFailoverError(ret_code)) {
+            break;
+        }
+        tried.push_back(index);
+    }
+    return ret_code;
+}
+
+size_t SmtpConnectionPool::warm(SmtpClientType pType,
+        const char *pServerName,
+        unsigned int pPort,
+        const Credential *pCredential,
+        size_t pIdleSessionCount,
+        int *pErrorCode) {
+    if (pErrorCode != nullptr) {
+        *pErrorCode = 0;
+    }
+    const PoolKey key = makeKey(pType, pServerName, pPort, pCredential);
+    std::unique_lock<std::mutex> lock(mMutex);
+    PoolEntry &entry = mEntries[key];
+    // The sessions checked are taken out of the pool but stay counted as opened
+    std::vector<IdleSession> checked;
+    const auto now = std::chrono::steady_clock::now();
+    for (auto session = entry.idle.begin(); session != entry.idle.end();) {
+        if (now - session->lastUsed >= mHealthCheckInterval) {
+            checked.push_back(std::move(*session));
+            session = entry.idle.erase(session);
+        } else {
+            ++session;
+        }
+    }
+    lock.unlock();
+    for (auto &session : checked) {
+        if (session.client->sendNoop() != 0) {
+            session.client->disconnect();
+            session.client.reset();
+        }
+    }
+    lock.lock();
+    for (auto &session : checked) {
+        if (session.client != nullptr) {
+            session.lastUsed = std::chrono::steady_clock::now();
+            entry.idle.push_back(std::move(session));
+        } else {
+            entry.opened--;
+        }
+    }
+
+    while (entry.idle.size() < pIdleSessionCount && entry.opened < mMaxSessionsPerServer) {
+        entry.opened++;
+        std::shared_ptr<TlsContext> tls_context = mTlsContext;
+        std::shared_ptr<SessionObserver> session_observer = mSessionObserver;
+        TransportFactory transport_factory = mTransportFactory;
+        lock.unlock();
+        std::unique_ptr<SMTPClientBase> client(createClient(key, pCredential, tls_context, session_observer, transport_factory));
+        int connect_ret_code = client->connect();
+        lock.lock();
+        if (connect_ret_code != 0) {
+            entry.opened--;
+            if (pErrorCode != nullptr) {
+                *pErrorCode = connect_ret_code;
+            }
+            break;
+        }
+        IdleSession session;
+        session.client = std::move(client);
+        session.lastUsed = std::chrono::steady_clock::now();
+        entry.idle.push_back(std::move(session));
+    }
+    const size_t idle_session_count = entry.idle.size();
+    lock.unlock();
+    mSessionReleased.notify_all();
+    return idle_session_count;
+}
+
+void SmtpConnectionPool::evictIdleSessions() {
+    std::vector<std::unique_ptr<SMTPClientBase>> expired;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        const auto now = std::chrono::steady_clock::now();
+        for (auto &item : mEntries) {
+            auto &idle = item.second.idle;
+            for (auto session = idle.begin(); session != idle.end();) {
+                if (now - session->lastUsed >= mIdleTimeout) {
+                    expired.push_back(std::move(session->client));
+                    session = idle.erase(session);
+                    item.second.opened--;
+                } else {
+                    ++session;
+                }
+            }
+        }
+    }
+    for (auto &client : expired) {
+        client->disconnect();
+    }
+    if (!expired.empty()) {
+        mSessionReleased.notify_all();
+    }
+}
+
+size_t SmtpConnectionPool::getSessionCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t count = 0;
+    for (const auto &item : mEntries) {
+        count += item.second.opened;
+    }
+    return count;
+}
+
+size_t SmtpConnectionPool::getIdleSessionCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t count = 0;
+    for (const auto &item : mEntries) {
+        count += item.second.idle.size();
+    }
+    return count;
+}
+
+void SmtpConnectionPool::setTlsContext(std::shared_ptr<TlsContext> pTlsContext) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mTlsContext = std::move(pTlsContext);
+}
+
+void SmtpConnectionPool::setSessionObserver(std::shared_ptr<SessionObserver> pObserver) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSessionObserver = std::move(pObserver);
+}
+
+void SmtpConnectionPool::setTransportFactory(TransportFactory pFactory) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mTransportFactory = std::move(pFactory);
+}
+
+bool SmtpConnectionPool::findServerCapabilities(SmtpClientType pType,
+        const char *pServerName,
+        unsigned int pPort,
+        ServerCapabilities &pCapabilities) const {
+    if (pType != SmtpClientType::Plain && mCapabilityCache->find(pServerName, pPort, true, pCapabilities)) {
+        return true;
+    }
+    // The forced secure sessions only send EHLO over TLS
+    return pType != SmtpClientType::ForcedSecure && mCapabilityCache->find(pServerName, pPort, false, pCapabilities);
+}
+
+std::shared_ptr<CapabilityCache> SmtpConnectionPool::getCapabilityCache() const {
+    return mCapabilityCache;
+}
@@ -0,0 +1,234 @@
+#ifndef SMTPCONNECTIONPOOL_H
+#define SMTPCONNECTIONPOOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "capabilitycache.h"
+#include "credential.h"
+#include "message.h"
+#include "relaygroup.h"
+#include "smtpclientbase.h"
+#include "smtpclientconfig.h"
+#include "tlscontext.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define SMTPCONNECTIONPOOL_API __declspec(dllexport)
+    #else
+        #define SMTPCONNECTIONPOOL_API __declspec(dllimport)
+    #endif
+#else
+    #define SMTPCONNECTIONPOOL_API
+#endif
+
+namespace jed_utils {
+/** @brief The SmtpConnectionPool keeps persistent, already authenticated
+ *  sessions per (client type, server, port, credential) and shares them
+ *  between threads. A session is checked out by one thread at a time.
+ */
+class SMTPCONNECTIONPOOL_API SmtpConnectionPool {
+ public:
+    /**
+     *  @brief  Construct a new SmtpConnectionPool.
+     *  @param pMaxSessionsPerServer The maximum number of sessions opened for
+     *  the same (client type, server, port, credential) key.
+     *  @param pIdleTimeoutInSeconds The number of seconds after which an idle
+     *  session is closed instead of being reused.
+     *  Default: 60 seconds
+     *  @param pHealthCheckIntervalInSeconds The number of seconds a session
+     *  can stay idle before a NOOP command is sent to validate it on checkout.
+     *  Default: 10 seconds
+     */
+    explicit SmtpConnectionPool(size_t pMaxSessionsPerServer,
+            unsigned int pIdleTimeoutInSeconds = 60,
+            unsigned int pHealthCheckIntervalInSeconds = 10);
+
+    /** Destructor of the SmtpConnectionPool. All the idle sessions are closed. */
+    ~SmtpConnectionPool();
+
+    SmtpConnectionPool(const SmtpConnectionPool& other) = delete;
+    SmtpConnectionPool& operator=(const SmtpConnectionPool& other) = delete;
+
+    /**
+     *  @brief  Check out a connected session from the pool. A new session
+     *  is opened if none is idle and the maximum is not reached, otherwise
+     *  the call waits for a session to be released.
+     *  @param pType The SMTP client class to use.
+     *  @param pServerName The name of the server.
+     *  @param pPort The server port number.
+     *  @param pCredential The credential used to authenticate or nullptr.
+     *  @param pErrorCode Receive 0 for success or the connect error code.
+     *  @return The session or nullptr if the connection failed. The session
+     *  must be given back with release.
+     */
+    SMTPClientBase *acquire(SmtpClientType pType,
+            const char *pServerName,
+            unsigned int pPort,
+            const Credential *pCredential,
+            int *pErrorCode = nullptr);
+
+    /**
+     *  @brief  Give back a session obtained with acquire.
+     *  @param pClient The session to give back.
+     *  @param pDiscard True to close the session instead of keeping it.
+     */
+    void release(SMTPClientBase *pClient, bool pDiscard = false);
+
+    /**
+     *  @brief  Send a message through a pooled session. If the server has
+     *  dropped the session before the content of the message was sent (while
+     *  connecting, or at the NOOP or MAIL FROM of a stale idle session), a new
+     *  one is opened and the send is retried once. A failure during the
+     *  content is never retried, the server might have accepted the message.
+     *  @return 0 for success, otherwise the error code of the failed step.
+     */
+    int sendMail(SmtpClientType pType,
+            const char *pServerName,
+            unsigned int pPort,
+            const Credential *pCredential,
+            const Message &pMsg);
+
+    /**
+     *  @brief  Send a message through a pooled session to one of the servers
+     *  of a relay group. When a server cannot be used (see
+     *  RelayGroup::isFailoverError), it is ejected from the group and the
+     *  message is sent again through another server, until each server has
+     *  been tried once.
+     *  @param pRelays The relay servers, shared by the senders.
+     *  @return 0 for success, otherwise the error code of the last server tried.
+     */
+    int sendMail(SmtpClientType pType,
+            RelayGroup &pRelays,
+            const Credential *pCredential,
+            const Message &pMsg);
+
+    /**
+     *  @brief  Open idle sessions ahead of the first messages so that a send
+     *  only pays for the envelope and the content.
+     *
+     *  The idle sessions of the key that have not been checked within the
+     *  health check interval are validated with a NOOP command and their idle
+     *  timeout is restarted, then new sessions are opened until the key has
+     *  pIdleSessionCount idle sessions or the maximum is reached. Call it
+     *  periodically to keep the sessions parked.
+     *  @param pType The SMTP client class to use.
+     *  @param pServerName The name of the server.
+     *  @param pPort The server port number.
+     *  @param pCredential The credential used to authenticate or nullptr.
+     *  @param pIdleSessionCount The number of idle sessions wanted.
+     *  @param pErrorCode Receive 0 for success or the connect error code.
+     *  @return The number of idle sessions of the key.
+     */
+    size_t warm(SmtpClientType pType,
+            const char *pServerName,
+            unsigned int pPort,
+            const Credential *pCredential,
+            size_t pIdleSessionCount,
+            int *pErrorCode = nullptr);
+
+    /** Close the idle sessions that have reached the idle timeout. */
+    void evictIdleSessions();
+
+    /** Return the number of sessions (idle and checked out) currently opened. */
+    size_t getSessionCount() const;
+
+    /** Return the number of idle sessions available in the pool. */
+    size_t getIdleSessionCount() const;
+
+    /**
+     *  @brief  Set the TLS context shared by the secure sessions opened
+     *  from now on.
+     *  @param pTlsContext The context or nullptr to use TlsContext::getDefault().
+     */
+    void setTlsContext(std::shared_ptr<TlsContext> pTlsContext);
+
+    /**
+     *  @brief  Set the observer shared by the sessions opened from now on,
+     *  for instance a SendStatistics to count the activity of the pool.
+     *  @param pObserver The observer or nullptr to measure nothing.
+     */
+    void setSessionObserver(std::shared_ptr<SessionObserver> pObserver);
+
+    /**
+     *  @brief  Set the function that creates the transport of the sessions
+     *  opened from now on (see SmtpClientConfig::setTransportFactory).
+     *  @param pFactory The factory or an empty function to connect a socket.
+     */
+    void setTransportFactory(TransportFactory pFactory);
+
+    /**
+     *  @brief  Find the capabilities advertised by a server to the sessions
+     *  of the pool, before any session is checked out.
+     *  @param pType The SMTP client class used.
+     *  @param pServerName The name of the server.
+     *  @param pPort The server port number.
+     *  @param pCapabilities Receive the capabilities, those received over
+     *  TLS for the secure client classes when the session is encrypted.
+     *  @return True if a session of the pool has received them.
+     */
+    bool findServerCapabilities(SmtpClientType pType,
+            const char *pServerName,
+            unsigned int pPort,
+            ServerCapabilities &pCapabilities) const;
+
+    /** Return the capability cache shared by the sessions of the pool. */
+    std::shared_ptr<CapabilityCache> getCapabilityCache() const;
+
+ private:
+    struct PoolKey {
+        SmtpClientType type;
+        std::string serverName;
+        unsigned int port;
+        bool hasCredential;
+        std::string username;
+        // A salted digest of the password, the pool does not keep the
+        // password itself
+        std::string passwordHash;
+        // The sessions authenticated with a token are shared by the
+        // credentials of the same token source
+        std::shared_ptr<OAuth2TokenSource> tokenSource;
+        bool operator<(const PoolKey &other) const;
+    };
+    struct IdleSession {
+        std::unique_ptr<SMTPClientBase> client;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+    struct PoolEntry {
+        std::vector<IdleSession> idle;
+        size_t opened = 0;
+    };
+
+    SMTPClientBase *createClient(const PoolKey &pKey,
+            const Credential *pCredential,
+            const std::shared_ptr<TlsContext> &pTlsContext,
+            const std::shared_ptr<SessionObserver> &pSessionObserver,
+            const TransportFactory &pTransportFactory) const;
+    PoolKey makeKey(SmtpClientType pType,
+            const char *pServerName,
+            unsigned int pPort,
+            const Credential *pCredential) const;
+
+    size_t mMaxSessionsPerServer;
+    std::chrono::seconds mIdleTimeout;
+    std::chrono::seconds mHealthCheckInterval;
+    // Mixed into the password digests of the keys
+    std::string mKeySalt;
+    mutable std::mutex mMutex;
+    std::condition_variable mSessionReleased;
+    std::map<PoolKey, PoolEntry> mEntries;
+    std::map<SMTPClientBase *, PoolKey> mCheckedOut;
+    std::shared_ptr<TlsContext> mTlsContext;
+    std::shared_ptr<SessionObserver> mSessionObserver;
+    TransportFactory mTransportFactory;
+    // Shared by the sessions, it is thread-safe and is never replaced
+    const std::shared_ptr<CapabilityCache> mCapabilityCache;
+};
+}  // namespace jed_utils
+
+#endif
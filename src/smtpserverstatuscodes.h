@@ -7,4 +7,10 @@ const int STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED = 250;
 const int STATUS_CODE_SERVER_CHALLENGE = 334;
 const int STATUS_CODE_START_MAIL_INPUT = 354;
 
+// Transient negative completion replies (RFC 5321 section 4.2.1)
+const int STATUS_CODE_SERVICE_NOT_AVAILABLE = 421;
+const int STATUS_CODE_MAILBOX_BUSY = 450;
+const int STATUS_CODE_LOCAL_ERROR_IN_PROCESSING = 451;
+const int STATUS_CODE_INSUFFICIENT_SYSTEM_STORAGE = 452;
+
 #endif
\ No newline at end of file
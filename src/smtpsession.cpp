@@ -0,0 +1,57 @@
+#include "smtpsession.h"
+#include <stdexcept>
+#include <utility>
+
+using namespace jed_utils;
+
+SmtpSession::SmtpSession(std::shared_ptr<const SmtpClientConfig> pConfig)
+    : mConfig(std::move(pConfig)) {
+    if (mConfig == nullptr) {
+        throw std::invalid_argument("Config cannot be null");
+    }
+    mClient = mConfig->createClient();
+}
+
+SmtpSession::~SmtpSession() {
+    if (mClient != nullptr && mClient->isConnected()) {
+        mClient->disconnect();
+    }
+}
+
+const std::shared_ptr<const SmtpClientConfig> &SmtpSession::getConfig() const {
+    return mConfig;
+}
+
+int SmtpSession::connect() {
+    return mClient->connect();
+}
+
+int SmtpSession::disconnect() {
+    return mClient->disconnect();
+}
+
+bool SmtpSession::isConnected() const {
+    return mClient->isConnected();
+}
+
+int SmtpSession::sendMail(const Message &pMsg) {
+    return mClient->sendMail(pMsg);
+}
+
+int SmtpSession::sendMail(const Message &pMsg,
+        const MessageAddress *pEnvelopeRecipients,
+        size_t pEnvelopeRecipientCount) {
+    return mClient->sendMail(pMsg, pEnvelopeRecipients, pEnvelopeRecipientCount);
+}
+
+const char *SmtpSession::getCommunicationLog() const {
+    return mClient->getCommunicationLog();
+}
+
+const ServerCapabilities &SmtpSession::getServerCapabilities() const {
+    return mClient->getServerCapabilities();
+}
+
+const IoCounters &SmtpSession::getIoCounters() const {
+    return mClient->getIoCounters();
+}
@@ -0,0 +1,102 @@
+#ifndef SMTPSESSION_H
+#define SMTPSESSION_H
+
+#include <cstddef>
+#include <memory>
+#include "message.h"
+#include "messageaddress.h"
+#include "servercapabilities.h"
+#include "sessionobserver.h"
+#include "smtpclientbase.h"
+#include "smtpclientconfig.h"
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define SMTPSESSION_API __declspec(dllexport)
+    #else
+        #define SMTPSESSION_API __declspec(dllimport)
+    #endif
+#else
+    #define SMTPSESSION_API
+#endif
+
+namespace jed_utils {
+/** @brief The SmtpSession class holds the state of one session with the
+ *  server (socket, TLS connection, capabilities, communication log) opened
+ *  with a shared SmtpClientConfig.
+ *
+ *  A session is used by one thread at a time. The threads that send
+ *  concurrently each create their own session from the same configuration,
+ *  which is never copied nor locked.
+ */
+class SMTPSESSION_API SmtpSession {
+ public:
+    /**
+     *  @brief  Construct a new SmtpSession. The session is not connected.
+     *  @param pConfig The configuration of the session. It must not be
+     *  nullptr.
+     */
+    explicit SmtpSession(std::shared_ptr<const SmtpClientConfig> pConfig);
+
+    /** Destructor of the SmtpSession. The session is closed if it is open. */
+    ~SmtpSession();
+
+    SmtpSession(const SmtpSession& other) = delete;
+    SmtpSession& operator=(const SmtpSession& other) = delete;
+
+    /** SmtpSession move constructor. */
+    SmtpSession(SmtpSession&& other) noexcept = default;
+
+    /** SmtpSession move assignment operator. */
+    SmtpSession& operator=(SmtpSession&& other) noexcept = default;
+
+    /** Return the configuration of the session. */
+    const std::shared_ptr<const SmtpClientConfig> &getConfig() const;
+
+    /**
+     *  @brief  Open the session. The following calls to sendMail reuse it.
+     *  @return 0 for success, otherwise the error code of the failed step.
+     */
+    int connect();
+
+    /**
+     *  @brief  Send QUIT and close the session.
+     *  @return 0 for success, otherwise the error code of the failed step.
+     */
+    int disconnect();
+
+    /** Indicate if the session is open. */
+    bool isConnected() const;
+
+    /**
+     *  @brief  Send a message. The session is opened first if needed and
+     *  stays open only if it was opened by connect.
+     *  @return 0 for success, otherwise the error code of the failed step.
+     */
+    int sendMail(const Message &pMsg);
+
+    /**
+     *  @brief  Send a message to a subset of its recipients.
+     *  @return 0 for success, otherwise the error code of the failed step.
+     */
+    int sendMail(const Message &pMsg,
+            const MessageAddress *pEnvelopeRecipients,
+            size_t pEnvelopeRecipientCount);
+
+    /** Return the communication log of the session. */
+    const char *getCommunicationLog() const;
+
+    /** Return the ESMTP extensions advertised by the server. */
+    const ServerCapabilities &getServerCapabilities() const;
+
+    /** Return the data exchanged with the server by the session. */
+    const IoCounters &getIoCounters() const;
+
+ private:
+    std::shared_ptr<const SmtpClientConfig> mConfig;
+    std::unique_ptr<SMTPClientBase> mClient;
+};
+}  // namespace jed_utils
+
+#endif
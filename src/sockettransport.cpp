@@ -0,0 +1,184 @@
+#include "sockettransport.h"
+#include <algorithm>
+#include <cerrno>
+#include <limits>
+#include "socketerrors.h"
+#ifdef _WIN32
+    #include <WinSock2.h>
+    #include <BaseTsd.h>
+    typedef SSIZE_T ssize_t;
+#else
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/types.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+using namespace jed_utils;
+
+// Avoid the SIGPIPE signal when the server has closed the connection
+#ifdef MSG_NOSIGNAL
+const int TRANSPORT_SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int TRANSPORT_SEND_FLAGS = 0;
+#endif
+
+SocketTransport::SocketTransport(int pSocket)
+    : mSocket(pSocket) {
+}
+
+SocketTransport::~SocketTransport() {
+    SocketTransport::close();
+}
+
+int SocketTransport::open(const char *pServerName, unsigned int pPort, unsigned int pTimeoutInMilliseconds) {
+    (void)pServerName;
+    (void)pPort;
+    (void)pTimeoutInMilliseconds;
+    return mSocket >= 0 ? 0 : SOCKET_INIT_SESSION_CONNECT_ERROR;
+}
+
+void SocketTransport::close() {
+    if (mSocket < 0) {
+        return;
+    }
+#ifdef _WIN32
+    shutdown(mSocket, SD_BOTH);
+    closesocket(mSocket);
+#else
+    ::close(mSocket);
+#endif
+    mSocket = -1;
+}
+
+int SocketTransport::write(const std::string_view *pSegments, size_t pSegmentCount) {
+    const size_t MAX_BUFFERS_PER_WRITE = 64;
+    size_t segment_index = 0;
+    size_t segment_offset = 0;
+    while (segment_index < pSegmentCount) {
+#ifdef _WIN32
+        WSABUF buffers[MAX_BUFFERS_PER_WRITE];
+#else
+        struct iovec buffers[MAX_BUFFERS_PER_WRITE];
+#endif
+        size_t buffer_count = 0;
+        size_t index = segment_index;
+        size_t offset = segment_offset;
+        while (index < pSegmentCount && buffer_count < MAX_BUFFERS_PER_WRITE) {
+            size_t length = (std::min)(pSegments[index].length() - offset,
+                    static_cast<size_t>((std::numeric_limits<int>::max)()));
+            if (length > 0) {
+#ifdef _WIN32
+                buffers[buffer_count].buf = const_cast<char *>(pSegments[index].data() + offset);
+                buffers[buffer_count].len = static_cast<ULONG>(length);
+#else
+                buffers[buffer_count].iov_base = const_cast<char *>(pSegments[index].data() + offset);
+                buffers[buffer_count].iov_len = length;
+#endif
+                buffer_count++;
+            }
+            offset += length;
+            if (offset < pSegments[index].length()) {
+                break;
+            }
+            index++;
+            offset = 0;
+        }
+        if (buffer_count == 0) {
+            break;
+        }
+
+#ifdef _WIN32
+        DWORD bytes_sent = 0;
+        if (WSASend(static_cast<SOCKET>(mSocket), buffers, static_cast<DWORD>(buffer_count), &bytes_sent, 0, nullptr, nullptr) == SOCKET_ERROR) {
+            mLastError = WSAGetLastError();
+            return -1;
+        }
+#else
+        struct msghdr message {};
+        message.msg_iov = buffers;
+        message.msg_iovlen = buffer_count;
+        ssize_t bytes_sent = sendmsg(mSocket, &message, TRANSPORT_SEND_FLAGS);
+        if (bytes_sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            mLastError = errno;
+            return -1;
+        }
+#endif
+        // Skip what has been sent, the write may have been partial
+        size_t remaining = static_cast<size_t>(bytes_sent);
+        while (segment_index < pSegmentCount) {
+            size_t available = pSegments[segment_index].length() - segment_offset;
+            if (remaining < available) {
+                segment_offset += remaining;
+                break;
+            }
+            remaining -= available;
+            segment_index++;
+            segment_offset = 0;
+        }
+    }
+    return 0;
+}
+
+int SocketTransport::waitForData(unsigned int pTimeoutInMilliseconds) {
+    const int timeout = pTimeoutInMilliseconds > static_cast<unsigned int>((std::numeric_limits<int>::max)())
+        ? (std::numeric_limits<int>::max)()
+        : static_cast<int>(pTimeoutInMilliseconds);
+#ifdef _WIN32
+    WSAPOLLFD fds {};
+    fds.fd = static_cast<SOCKET>(mSocket);
+    fds.events = POLLRDNORM;
+    int res = WSAPoll(&fds, 1, timeout);
+    if (res == SOCKET_ERROR) {
+        mLastError = WSAGetLastError();
+        return -1;
+    }
+#else
+    struct pollfd fds {};
+    fds.fd = mSocket;
+    fds.events = POLLIN;
+    int res;
+    do {
+        res = poll(&fds, 1, timeout);
+    } while (res < 0 && errno == EINTR);
+    if (res < 0) {
+        mLastError = errno;
+        return -1;
+    }
+#endif
+    return res;
+}
+
+int SocketTransport::read(char *pBuffer, size_t pLength) {
+    const size_t length = (std::min)(pLength, static_cast<size_t>((std::numeric_limits<int>::max)()));
+#ifdef _WIN32
+    int bytes_received = recv(mSocket, pBuffer, static_cast<int>(length), 0);
+    if (bytes_received <= 0) {
+        mLastError = WSAGetLastError();
+        return -1;
+    }
+    return bytes_received;
+#else
+    ssize_t bytes_received;
+    do {
+        bytes_received = recv(mSocket, pBuffer, length, 0);
+    } while (bytes_received < 0 && errno == EINTR);
+    if (bytes_received <= 0) {
+        mLastError = bytes_received == 0 ? 0 : errno;
+        return -1;
+    }
+    return static_cast<int>(bytes_received);
+#endif
+}
+
+int SocketTransport::getSocketFileDescriptor() const {
+    return mSocket;
+}
+
+int SocketTransport::getLastError() const {
+    return mLastError;
+}
@@ -0,0 +1,53 @@
+#ifndef SOCKETTRANSPORT_H
+#define SOCKETTRANSPORT_H
+
+#include <cstddef>
+#include <string_view>
+#include "transport.h"
+
+#ifdef _WIN32
+    #ifdef SMTPCLIENT_EXPORTS
+        #define SOCKETTRANSPORT_API __declspec(dllexport)
+    #else
+        #define SOCKETTRANSPORT_API __declspec(dllimport)
+    #endif
+#else
+    #define SOCKETTRANSPORT_API
+#endif
+
+namespace jed_utils {
+/** @brief The SocketTransport class is a Transport over a blocking socket
+ *  that is already connected to the server, for example a socket connected
+ *  through a proxy or by the event loop of the application.
+ *
+ *  The transport owns the socket and closes it when the session ends, so it
+ *  can be used for one session only.
+ */
+class SOCKETTRANSPORT_API SocketTransport : public Transport {
+ public:
+    /**
+     *  @brief  Construct a new SocketTransport.
+     *  @param pSocket The connected socket, in blocking mode.
+     */
+    explicit SocketTransport(int pSocket);
+    ~SocketTransport() override;
+    SocketTransport(const SocketTransport& other) = delete;
+    SocketTransport& operator=(const SocketTransport& other) = delete;
+
+    /** Return 0 while the socket is open, otherwise
+     *  SOCKET_INIT_SESSION_CONNECT_ERROR. The socket is not reconnected. */
+    int open(const char *pServerName, unsigned int pPort, unsigned int pTimeoutInMilliseconds) override;
+    void close() override;
+    int write(const std::string_view *pSegments, size_t pSegmentCount) override;
+    int waitForData(unsigned int pTimeoutInMilliseconds) override;
+    int read(char *pBuffer, size_t pLength) override;
+    int getSocketFileDescriptor() const override;
+    int getLastError() const override;
+
+ private:
+    int mSocket;
+    int mLastError = 0;
+};
+}  // namespace jed_utils
+
+#endif
@@ -1,10 +1,25 @@
 #include "stringutils.h"
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
+#include <cstring>
 #include <locale>
 
 using namespace jed_utils;
 
+namespace {
+// The high bit of each of the eight bytes of a block
+const uint64_t NON_ASCII_MASK = 0x8080808080808080ULL;
+
+// The addresses are too short to pay for the setup of the SSE2 paths of the
+// encoders, eight bytes are tested at once with a plain word
+bool isAsciiBlock(const char *pData) {
+    uint64_t block;
+    memcpy(&block, pData, sizeof(block));
+    return (block & NON_ASCII_MASK) == 0;
+}
+}  // namespace
+
 // Trim from start
 std::string StringUtils::trimLeft(const std::string &pString) {
     std::string s = pString;
@@ -44,3 +59,67 @@ std::string StringUtils::toUpper(const std::string &pString) {
             [](unsigned char c){ return static_cast<char>(std::toupper(c)); });
     return transformed_string;
 }
+
+bool StringUtils::isAscii(std::string_view pString) {
+    size_t index = 0;
+    for (; index + sizeof(uint64_t) <= pString.size(); index += sizeof(uint64_t)) {
+        if (!isAsciiBlock(pString.data() + index)) {
+            return false;
+        }
+    }
+    for (; index < pString.size(); index++) {
+        if (static_cast<unsigned char>(pString[index]) >= 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StringUtils::isValidUtf8(std::string_view pString) {
+    size_t index = 0;
+    while (index < pString.size()) {
+        if (index + sizeof(uint64_t) <= pString.size() && isAsciiBlock(pString.data() + index)) {
+            index += sizeof(uint64_t);
+            continue;
+        }
+        const auto lead = static_cast<unsigned char>(pString[index]);
+        if (lead < 0x80) {
+            index++;
+            continue;
+        }
+        size_t length;
+        uint32_t code_point;
+        uint32_t min_code_point;
+        if ((lead & 0xE0) == 0xC0) {
+            length = 2;
+            code_point = lead & 0x1Fu;
+            min_code_point = 0x80;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 3;
+            code_point = lead & 0x0Fu;
+            min_code_point = 0x800;
+        } else if ((lead & 0xF8) == 0xF0) {
+            length = 4;
+            code_point = lead & 0x07u;
+            min_code_point = 0x10000;
+        } else {
+            return false;
+        }
+        if (length > pString.size() - index) {
+            return false;
+        }
+        for (size_t offset = 1; offset < length; offset++) {
+            const auto continuation = static_cast<unsigned char>(pString[index + offset]);
+            if ((continuation & 0xC0) != 0x80) {
+                return false;
+            }
+            code_point = (code_point << 6) | (continuation & 0x3Fu);
+        }
+        if (code_point < min_code_point || code_point > 0x10FFFF ||
+                (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+            return false;
+        }
+        index += length;
+    }
+    return true;
+}
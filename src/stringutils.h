@@ -2,6 +2,7 @@
 #define STRINGUTILS_H
 
 #include <string>
+#include <string_view>
 
 #ifdef _WIN32
     #ifdef SMTPCLIENT_EXPORTS
@@ -47,6 +48,21 @@ class STRINGUTILS_API StringUtils {
      *  @param pString The string that will be processed.
      */
     static std::string toUpper(const std::string &pString);
+
+    /**
+     *  @brief  Indicate if a string contains only ASCII characters. The
+     *  string is checked eight bytes at a time.
+     *  @param pString The string that will be processed.
+     */
+    static bool isAscii(std::string_view pString);
+
+    /**
+     *  @brief  Indicate if a string is valid UTF-8: no overlong sequence, no
+     *  surrogate and no code point above U+10FFFF. The ASCII characters are
+     *  skipped eight bytes at a time.
+     *  @param pString The string that will be processed.
+     */
+    static bool isValidUtf8(std::string_view pString);
 };
 }  // namespace jed_utils
 
@@ -0,0 +1,328 @@
+#include "tlscontext.h"
+#include <openssl/err.h>
+#include <openssl/x509.h>
+#include <mutex>
+#include "sslerrors.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <wincrypt.h>
+#endif
+
+using namespace jed_utils;
+
+namespace {
+// The key of the server is attached to each SSL object and freed with it
+void freeServerKey(void *, void *pData, CRYPTO_EX_DATA *, int, long, void *) {
+    delete static_cast<std::string *>(pData);
+}
+
+int getServerKeyIndex() {
+    static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, freeServerKey);
+    return index;
+}
+
+// The trust anchors of the system, shared by reference by the contexts.
+// Importing the ROOT store of Windows takes tens of milliseconds.
+struct SharedTrustStore {
+    ~SharedTrustStore() {
+        if (Store != nullptr) {
+            X509_STORE_free(Store);
+        }
+#ifdef _WIN32
+        if (ChangeEvent != nullptr) {
+            CloseHandle(ChangeEvent);
+        }
+        if (SystemStore != nullptr) {
+            CertCloseStore(SystemStore, 0);
+        }
+#endif
+    }
+
+    std::mutex Mutex;
+    X509_STORE *Store = nullptr;
+    uint64_t Generation = 0;
+    std::chrono::steady_clock::time_point LoadTime;
+    std::chrono::seconds RefreshInterval { 3600 };
+    bool RefreshRequested = false;
+#ifdef _WIN32
+    // Kept open to be notified of the changes of the ROOT store
+    HCERTSTORE SystemStore = nullptr;
+    HANDLE ChangeEvent = nullptr;
+#endif
+};
+
+SharedTrustStore &getSharedTrustStore() {
+    static SharedTrustStore shared_store;
+    return shared_store;
+}
+
+// Called with the mutex of the store locked
+bool isTrustStoreStale(SharedTrustStore &pShared) {
+#ifdef _WIN32
+    if (pShared.ChangeEvent != nullptr && WaitForSingleObject(pShared.ChangeEvent, 0) == WAIT_OBJECT_0) {
+        pShared.RefreshRequested = true;
+    }
+#endif
+    return pShared.Store == nullptr ||
+        pShared.RefreshRequested ||
+        (pShared.RefreshInterval.count() > 0 &&
+         std::chrono::steady_clock::now() - pShared.LoadTime >= pShared.RefreshInterval);
+}
+
+int loadSystemTrustAnchors(SharedTrustStore &pShared, X509_STORE *pStore, int &pLastSSLErrNo) {
+#ifdef _WIN32
+    /* On Windows, we need to import all the ROOT certificates to
+       the OpenSSL Store */
+    if (pShared.SystemStore == nullptr) {
+        pShared.SystemStore = CertOpenSystemStore(NULL, "ROOT");
+        if (!pShared.SystemStore) {
+            pLastSSLErrNo = static_cast<int>(GetLastError());
+            return SSL_CLIENT_STARTTLS_WIN_CERTOPENSYSTEMSTORE_ERROR;
+        }
+        // The event is signaled when the ROOT store is modified
+        pShared.ChangeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (pShared.ChangeEvent != nullptr &&
+                !CertControlStore(pShared.SystemStore, 0, CERT_STORE_CTRL_NOTIFY_CHANGE, &pShared.ChangeEvent)) {
+            CloseHandle(pShared.ChangeEvent);
+            pShared.ChangeEvent = nullptr;
+        }
+    } else {
+        // Bring the open store up to date, which also arms the event again
+        CertControlStore(pShared.SystemStore, 0, CERT_STORE_CTRL_RESYNC,
+                pShared.ChangeEvent != nullptr ? &pShared.ChangeEvent : nullptr);
+    }
+
+    PCCERT_CONTEXT pContext = CertEnumCertificatesInStore(pShared.SystemStore, nullptr);
+    while (pContext) {
+        const unsigned char *encoded = pContext->pbCertEncoded;
+        X509 *x509 = d2i_X509(nullptr, &encoded, pContext->cbCertEncoded);
+        if (x509) {
+            X509_STORE_add_cert(pStore, x509);
+            X509_free(x509);
+        }
+        pContext = CertEnumCertificatesInStore(pShared.SystemStore, pContext);
+    }
+#else
+    (void)pShared;
+    if (X509_STORE_set_default_paths(pStore) == 0) {
+        pLastSSLErrNo = static_cast<int>(ERR_get_error());
+        return SSL_CLIENT_STARTTLS_CTX_SET_DEFAULT_VERIFY_PATHS_ERROR;
+    }
+#endif
+    return 0;
+}
+
+// Called with the mutex of the store locked. The previous store is kept
+// when it cannot be loaded again.
+int updateTrustStore(SharedTrustStore &pShared, int &pLastSSLErrNo) {
+    if (!isTrustStoreStale(pShared)) {
+        return 0;
+    }
+    X509_STORE *store = X509_STORE_new();
+    if (store == nullptr) {
+        pLastSSLErrNo = static_cast<int>(ERR_get_error());
+        return pShared.Store != nullptr ? 0 : SSL_CLIENT_STARTTLS_CTX_SET_DEFAULT_VERIFY_PATHS_ERROR;
+    }
+    const int load_ret_code = loadSystemTrustAnchors(pShared, store, pLastSSLErrNo);
+    if (load_ret_code != 0) {
+        X509_STORE_free(store);
+        return pShared.Store != nullptr ? 0 : load_ret_code;
+    }
+    if (pShared.Store != nullptr) {
+        // The contexts created with the previous store keep their reference
+        X509_STORE_free(pShared.Store);
+    }
+    pShared.Store = store;
+    pShared.Generation++;
+    pShared.LoadTime = std::chrono::steady_clock::now();
+    pShared.RefreshRequested = false;
+    return 0;
+}
+}  // namespace
+
+TlsContext::TlsContext()
+    : mCTX(nullptr),
+      mInitializationErrorCode(0),
+      mLastSSLErrNo(0),
+      mTrustStoreGeneration(0),
+      mSessionResumptionEnabled(true),
+      mResumedHandshakeCount(0),
+      mFullHandshakeCount(0) {
+    static std::once_flag library_initialized;
+    std::call_once(library_initialized, []() {
+            SSL_library_init();
+            OpenSSL_add_all_algorithms();
+            SSL_load_error_strings();
+            });
+
+    mCTX = SSL_CTX_new(TLS_client_method());
+    if (mCTX == nullptr) {
+        mLastSSLErrNo = static_cast<int>(ERR_get_error());
+        mInitializationErrorCode = SSL_CLIENT_STARTTLS_INITSSLCTX_ERROR;
+        return;
+    }
+    mInitializationErrorCode = loadTrustAnchors();
+    if (mInitializationErrorCode != 0) {
+        SSL_CTX_free(mCTX);
+        mCTX = nullptr;
+        return;
+    }
+    // The sessions are kept by this class per server instead of the
+    // internal cache of OpenSSL, which is only used by servers
+    SSL_CTX_set_app_data(mCTX, this);
+    SSL_CTX_set_session_cache_mode(mCTX, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(mCTX, &TlsContext::onNewSession);
+}
+
+TlsContext::~TlsContext() {
+    clearSessionCache();
+    if (mCTX != nullptr) {
+        SSL_CTX_free(mCTX);
+    }
+    mCTX = nullptr;
+}
+
+std::shared_ptr<TlsContext> TlsContext::getDefault() {
+    static std::mutex default_mutex;
+    static std::shared_ptr<TlsContext> default_context;
+    std::lock_guard<std::mutex> lock(default_mutex);
+    if (default_context == nullptr || !default_context->isValid() || !default_context->hasCurrentTrustStore()) {
+        default_context = std::make_shared<TlsContext>();
+    }
+    return default_context;
+}
+
+void TlsContext::setTrustStoreRefreshInterval(std::chrono::seconds pInterval) {
+    SharedTrustStore &shared_store = getSharedTrustStore();
+    std::lock_guard<std::mutex> lock(shared_store.Mutex);
+    shared_store.RefreshInterval = pInterval;
+}
+
+std::chrono::seconds TlsContext::getTrustStoreRefreshInterval() {
+    SharedTrustStore &shared_store = getSharedTrustStore();
+    std::lock_guard<std::mutex> lock(shared_store.Mutex);
+    return shared_store.RefreshInterval;
+}
+
+void TlsContext::refreshTrustStore() {
+    SharedTrustStore &shared_store = getSharedTrustStore();
+    std::lock_guard<std::mutex> lock(shared_store.Mutex);
+    shared_store.RefreshRequested = true;
+}
+
+uint64_t TlsContext::getTrustStoreLoadCount() {
+    SharedTrustStore &shared_store = getSharedTrustStore();
+    std::lock_guard<std::mutex> lock(shared_store.Mutex);
+    return shared_store.Generation;
+}
+
+bool TlsContext::hasCurrentTrustStore() const {
+    SharedTrustStore &shared_store = getSharedTrustStore();
+    std::lock_guard<std::mutex> lock(shared_store.Mutex);
+    return !isTrustStoreStale(shared_store) && mTrustStoreGeneration == shared_store.Generation;
+}
+
+bool TlsContext::isValid() const {
+    return mCTX != nullptr;
+}
+
+int TlsContext::getInitializationErrorCode() const {
+    return mInitializationErrorCode;
+}
+
+int TlsContext::getLastSSLErrNo() const {
+    return mLastSSLErrNo;
+}
+
+SSL_CTX *TlsContext::getNativeContext() const {
+    return mCTX;
+}
+
+bool TlsContext::isSessionResumptionEnabled() const {
+    return mSessionResumptionEnabled;
+}
+
+void TlsContext::setSessionResumptionEnabled(bool pValue) {
+    mSessionResumptionEnabled = pValue;
+    if (!pValue) {
+        clearSessionCache();
+    }
+}
+
+size_t TlsContext::getResumedHandshakeCount() const {
+    return mResumedHandshakeCount;
+}
+
+size_t TlsContext::getFullHandshakeCount() const {
+    return mFullHandshakeCount;
+}
+
+size_t TlsContext::getCachedSessionCount() const {
+    std::lock_guard<std::mutex> lock(mSessionsMutex);
+    return mSessions.size();
+}
+
+void TlsContext::clearSessionCache() {
+    std::lock_guard<std::mutex> lock(mSessionsMutex);
+    for (auto &item : mSessions) {
+        SSL_SESSION_free(item.second);
+    }
+    mSessions.clear();
+}
+
+void TlsContext::prepareSession(SSL *pSSL, const std::string &pServerKey) {
+    SSL_set_ex_data(pSSL, getServerKeyIndex(), new std::string(pServerKey));
+    if (!mSessionResumptionEnabled) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mSessionsMutex);
+    auto session = mSessions.find(pServerKey);
+    if (session != mSessions.end()) {
+        // SSL_set_session takes its own reference on the session
+        SSL_set_session(pSSL, session->second);
+    }
+}
+
+void TlsContext::recordHandshake(SSL *pSSL) {
+    if (SSL_session_reused(pSSL)) {
+        mResumedHandshakeCount++;
+    } else {
+        mFullHandshakeCount++;
+    }
+}
+
+void TlsContext::storeSession(const std::string &pServerKey, SSL_SESSION *pSession) {
+    std::lock_guard<std::mutex> lock(mSessionsMutex);
+    SSL_SESSION *&cached = mSessions[pServerKey];
+    if (cached != nullptr) {
+        SSL_SESSION_free(cached);
+    }
+    cached = pSession;
+}
+
+int TlsContext::onNewSession(SSL *pSSL, SSL_SESSION *pSession) {
+    // Called by OpenSSL after the handshake (TLS 1.2) or when a ticket is
+    // received (TLS 1.3). Returning 1 keeps the reference on the session.
+    auto context = static_cast<TlsContext *>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(pSSL)));
+    auto server_key = static_cast<std::string *>(SSL_get_ex_data(pSSL, getServerKeyIndex()));
+    if (context == nullptr || server_key == nullptr || !context->mSessionResumptionEnabled) {
+        return 0;
+    }
+    context->storeSession(*server_key, pSession);
+    return 1;
+}
+
+int TlsContext::loadTrustAnchors() {
+    SharedTrustStore &shared_store = getSharedTrustStore();
+    std::lock_guard<std::mutex> lock(shared_store.Mutex);
+    const int update_ret_code = updateTrustStore(shared_store, mLastSSLErrNo);
+    if (update_ret_code != 0) {
+        return update_ret_code;
+    }
+    // The context takes its own reference on the shared store
+    X509_STORE_up_ref(shared_store.Store);
+    SSL_CTX_set_cert_store(mCTX, shared_store.Store);
+    mTrustStoreGeneration = shared_store.Generation;
+    return 0;
+}
@@ -0,0 +1,141 @@
+#ifndef TLSCONTEXT_H
+#define TLSCONTEXT_H
+
+#include <openssl/ssl.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#ifdef _WIN32
+    #pragma warning(disable: 4251)
+    #ifdef SMTPCLIENT_EXPORTS
+        #define TLSCONTEXT_API __declspec(dllexport)
+    #else
+        #define TLSCONTEXT_API __declspec(dllimport)
+    #endif
+#else
+    #define TLSCONTEXT_API
+#endif
+
+namespace jed_utils {
+/** @brief The TlsContext class owns an OpenSSL client context loaded with
+ *  the trust anchors of the system (the ROOT certificate store on Windows,
+ *  the default verify paths elsewhere).
+ *
+ *  The trust anchors are loaded once per process into a certificate store
+ *  shared by reference by all the contexts, and loaded again when the
+ *  refresh interval has elapsed or, on Windows, when the ROOT store has
+ *  changed. A context keeps the store it has been created with. A context
+ *  can be shared by any number of secure clients and threads, each
+ *  connection then only creates its own SSL object from it.
+ *
+ *  The context also keeps the last TLS session negotiated with each server
+ *  and port, and offers it on the next connection so that the server can
+ *  resume it (session ID or ticket in TLS 1.2, PSK in TLS 1.3) instead of
+ *  performing a full handshake.
+ */
+class TLSCONTEXT_API TlsContext {
+ public:
+    /** Construct a new TlsContext and load the trust anchors of the system. */
+    TlsContext();
+
+    /** Destructor of the TlsContext. */
+    ~TlsContext();
+
+    TlsContext(const TlsContext& other) = delete;
+    TlsContext& operator=(const TlsContext& other) = delete;
+
+    /**
+     *  @brief  Return the process-wide context used by the secure clients
+     *  that have not been given one with setTlsContext. It is created on
+     *  the first call, and created again if its initialization failed or
+     *  if the trust anchors have been loaded again.
+     */
+    static std::shared_ptr<TlsContext> getDefault();
+
+    /**
+     *  @brief  Set the time after which the trust anchors of the system are
+     *  loaded again by the next context constructed.
+     *  @param pInterval The interval or 0 to keep them until refreshTrustStore.
+     *  Default: 1 hour
+     */
+    static void setTrustStoreRefreshInterval(std::chrono::seconds pInterval);
+
+    /** Return the time after which the trust anchors are loaded again. */
+    static std::chrono::seconds getTrustStoreRefreshInterval();
+
+    /** Load the trust anchors of the system again when the next context is
+     *  constructed, for instance after a root certificate has been installed. */
+    static void refreshTrustStore();
+
+    /** Return the number of times the trust anchors of the system have been
+     *  loaded in the process. */
+    static uint64_t getTrustStoreLoadCount();
+
+    /** Indicate if the context uses the trust anchors loaded last. */
+    bool hasCurrentTrustStore() const;
+
+    /** Indicate if the context has been initialized successfully. */
+    bool isValid() const;
+
+    /** Return 0 if the context is valid, otherwise the SSL_CLIENT_STARTTLS
+     *  error code of the step that failed. */
+    int getInitializationErrorCode() const;
+
+    /** Return the OpenSSL error number of the failed initialization step. */
+    int getLastSSLErrNo() const;
+
+    /** Return the underlying OpenSSL context or nullptr if it is not valid. */
+    SSL_CTX *getNativeContext() const;
+
+    /** Indicate if the cached sessions are offered to the servers. */
+    bool isSessionResumptionEnabled() const;
+
+    /**
+     *  @brief  Indicate if the cached sessions are offered to the servers.
+     *  @param pValue True to resume the sessions (default), false to always
+     *  perform a full handshake. Disabling it clears the cache.
+     */
+    void setSessionResumptionEnabled(bool pValue);
+
+    /** Return the number of handshakes that resumed a cached session. */
+    size_t getResumedHandshakeCount() const;
+
+    /** Return the number of full handshakes. */
+    size_t getFullHandshakeCount() const;
+
+    /** Return the number of servers for which a session is cached. */
+    size_t getCachedSessionCount() const;
+
+    /** Discard all the cached sessions. */
+    void clearSessionCache();
+
+ private:
+    friend class SecureSMTPClientBase;
+
+    int loadTrustAnchors();
+    // Attach the key of the server to the connection and offer its cached session
+    void prepareSession(SSL *pSSL, const std::string &pServerKey);
+    // Count the handshake as resumed or full once it is completed
+    void recordHandshake(SSL *pSSL);
+    void storeSession(const std::string &pServerKey, SSL_SESSION *pSession);
+    static int onNewSession(SSL *pSSL, SSL_SESSION *pSession);
+
+    SSL_CTX *mCTX;
+    int mInitializationErrorCode;
+    int mLastSSLErrNo;
+    // The load of the shared store used by the context
+    uint64_t mTrustStoreGeneration;
+    std::atomic<bool> mSessionResumptionEnabled;
+    std::atomic<size_t> mResumedHandshakeCount;
+    std::atomic<size_t> mFullHandshakeCount;
+    mutable std::mutex mSessionsMutex;
+    std::map<std::string, SSL_SESSION *> mSessions;
+};
+}  // namespace jed_utils
+
+#endif
@@ -0,0 +1,11 @@
+#include "transport.h"
+
+using namespace jed_utils;
+
+int Transport::getSocketFileDescriptor() const {
+    return -1;
+}
+
+int Transport::getLastError() const {
+    return 0;
+}
@@ -0,0 +1,79 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <cstddef>
+#include <string_view>
+
+#ifdef _WIN32
+    #ifdef SMTPCLIENT_EXPORTS
+        #define TRANSPORT_API __declspec(dllexport)
+    #else
+        #define TRANSPORT_API __declspec(dllimport)
+    #endif
+#else
+    #define TRANSPORT_API
+#endif
+
+namespace jed_utils {
+/** @brief The Transport class is the interface through which an SMTP
+ *  client exchanges data with the server when one is set with
+ *  setTransport. Without a transport, the clients use a blocking socket
+ *  connected by themselves.
+ *
+ *  A transport lets the application run the connection on its own event loop
+ *  (asio, libuv, epoll, io_uring...) or on a socket it has connected itself.
+ *  The protocol logic only calls the methods below: the commands, the
+ *  pipelined envelope and the content are given to write as batches of
+ *  segments, and the replies are read with waitForData and read. A transport
+ *  is used by one session at a time.
+ */
+class TRANSPORT_API Transport {
+ public:
+    virtual ~Transport() = default;
+
+    /**
+     *  @brief  Open the connection with the server, called when a session
+     *  starts.
+     *  @param pServerName The name of the server.
+     *  @param pPort The server port number.
+     *  @param pTimeoutInMilliseconds The maximum time to connect.
+     *  @return 0 for success, otherwise a negative error code, usually one
+     *  of the SOCKET_INIT_SESSION error codes.
+     */
+    virtual int open(const char *pServerName, unsigned int pPort, unsigned int pTimeoutInMilliseconds) = 0;
+
+    /** Close the connection, called when the session ends or fails. It is
+     *  also called when the connection is not open and must do nothing then. */
+    virtual void close() = 0;
+
+    /**
+     *  @brief  Write all the segments, in order. The segments of one call
+     *  can be submitted as a single vectored write.
+     *  @return 0 for success, -1 if the connection failed.
+     */
+    virtual int write(const std::string_view *pSegments, size_t pSegmentCount) = 0;
+
+    /**
+     *  @brief  Wait until data can be read.
+     *  @return 1 if data can be read, 0 if the timeout expired, -1 if the
+     *  connection failed.
+     */
+    virtual int waitForData(unsigned int pTimeoutInMilliseconds) = 0;
+
+    /**
+     *  @brief  Read the data available, after waitForData returned 1.
+     *  @return The number of bytes read, or -1 if the connection failed or
+     *  was closed by the server.
+     */
+    virtual int read(char *pBuffer, size_t pLength) = 0;
+
+    /** Return the socket descriptor of the connection or -1 if there is
+     *  none. */
+    virtual int getSocketFileDescriptor() const;
+
+    /** Return the system error code of the last failure, 0 if unknown. */
+    virtual int getLastError() const;
+};
+}  // namespace jed_utils
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef TRANSPORTOPTIONS_H
+#define TRANSPORTOPTIONS_H
+
+#include <cstddef>
+
+namespace jed_utils {
+/** @brief The TransportOptions struct contains the buffer sizes and the
+ *  socket options of the connections of a client.
+ *
+ *  The socket options are set before the connection is established, so
+ *  that a larger receive buffer is taken into account by the TCP window
+ *  scaling. An option that the system refuses is ignored. The socket
+ *  options do not apply to the connections of a Transport given to the
+ *  client, which configures its own.
+ */
+struct TransportOptions {
+    // Size of the buffer that receives the server replies, at least 512 bytes
+    size_t ReadBufferSize = 1024;
+    // Maximum number of bytes passed to a single socket or TLS write of the
+    // message content, at least 512 bytes (see SMTPClientBase::setDataWriteSize)
+    size_t WriteSize = 65536;
+    // TCP_NODELAY: the client coalesces what it sends until it needs a reply
+    bool NoDelay = true;
+    // SO_SNDBUF and SO_RCVBUF in bytes, 0 to keep the system default. Raise
+    // them for the links with a high bandwidth-delay product.
+    int SendBufferSize = 0;
+    int ReceiveBufferSize = 0;
+    // SO_KEEPALIVE, so that a persistent or pooled session left idle detects
+    // a peer that has gone away and is not dropped by the middleboxes
+    bool KeepAlive = false;
+    // Idle time before the first probe, interval between the probes and
+    // number of probes before the connection is closed, 0 to keep the
+    // system default. Ignored where the system does not support them.
+    unsigned int KeepAliveIdleSeconds = 0;
+    unsigned int KeepAliveIntervalSeconds = 0;
+    unsigned int KeepAliveProbeCount = 0;
+    // Maximum time to establish the connection, 0 to use the command
+    // timeout. The Windows sockets connect without timeout.
+    unsigned int ConnectTimeoutInMilliseconds = 0;
+};
+}  // namespace jed_utils
+
+#endif
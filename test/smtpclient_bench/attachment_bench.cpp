@@ -0,0 +1,37 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include "../../src/attachment.h"
+#include "../../src/attachmentsource.h"
+
+using namespace jed_utils;
+
+static void BM_Attachment_getMimeType(benchmark::State &state) {
+    const char *names[] { "report.pdf", "photo.JPEG", "archive.tar.gz", "notes.txt", "unknown.xyz", "README" };
+    std::vector<Attachment> attachments;
+    for (const char *name : names) {
+        attachments.emplace_back(std::make_shared<BufferAttachmentSource>(std::string("x")), name);
+    }
+    for (auto _ : state) {
+        for (const Attachment &attachment : attachments) {
+            benchmark::DoNotOptimize(attachment.getMimeType());
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(attachments.size()));
+}
+BENCHMARK(BM_Attachment_getMimeType);
+
+static void BM_Attachment_streamBase64EncodedFile(benchmark::State &state) {
+    const Attachment attachment(std::make_shared<BufferAttachmentSource>(std::string(static_cast<size_t>(state.range(0)), 'a')),
+            "content.bin");
+    for (auto _ : state) {
+        size_t encoded_size = 0;
+        attachment.streamBase64EncodedFile([&encoded_size](const std::string &pEncodedBlock) {
+                encoded_size += pEncodedBlock.size();
+                return 0;
+                });
+        benchmark::DoNotOptimize(encoded_size);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_Attachment_streamBase64EncodedFile)->Arg(4096)->Arg(1024 * 1024);
@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+#include "../../src/base64.h"
+
+using namespace jed_utils;
+
+namespace {
+std::string createContent(size_t pSize) {
+    std::string content(pSize, '\0');
+    for (size_t index = 0; index < pSize; index++) {
+        content[index] = static_cast<char>(index * 31 + 7);
+    }
+    return content;
+}
+}  // namespace
+
+static void BM_Base64_Encode(benchmark::State &state) {
+    const std::string content = createContent(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Base64::Encode(reinterpret_cast<const unsigned char *>(content.data()), content.size()));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_Base64_Encode)->Arg(64)->Arg(4096)->Arg(64 * 1024)->Arg(1024 * 1024);
+
+static void BM_Base64_EncodeToBuffer(benchmark::State &state) {
+    const std::string content = createContent(static_cast<size_t>(state.range(0)));
+    std::vector<char> encoded(Base64::EncodedLength(content.size()));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Base64::EncodeToBuffer(reinterpret_cast<const unsigned char *>(content.data()),
+                    content.size(),
+                    encoded.data()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_Base64_EncodeToBuffer)->Arg(64)->Arg(4096)->Arg(64 * 1024)->Arg(1024 * 1024);
+
+static void BM_Base64_Decode(benchmark::State &state) {
+    const std::string content = createContent(static_cast<size_t>(state.range(0)));
+    const std::string encoded = Base64::Encode(reinterpret_cast<const unsigned char *>(content.data()), content.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Base64::Decode(encoded));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(encoded.size()));
+}
+BENCHMARK(BM_Base64_Decode)->Arg(64)->Arg(4096)->Arg(64 * 1024)->Arg(1024 * 1024);
+
+static void BM_Base64_DecodeToBuffer(benchmark::State &state) {
+    const std::string content = createContent(static_cast<size_t>(state.range(0)));
+    const std::string encoded = Base64::Encode(reinterpret_cast<const unsigned char *>(content.data()), content.size());
+    std::vector<unsigned char> decoded(Base64::DecodedMaxLength(encoded.size()));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Base64::DecodeToBuffer(encoded.data(), encoded.size(), decoded.data()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(encoded.size()));
+}
+BENCHMARK(BM_Base64_DecodeToBuffer)->Arg(64)->Arg(4096)->Arg(64 * 1024)->Arg(1024 * 1024);
@@ -0,0 +1,32 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include "../../src/base64.h"
+#include "../../src/dkimsigner.h"
+
+using namespace jed_utils;
+
+namespace {
+// An attachment encoded in base64 lines of 76 characters, as it is hashed
+std::string createEncodedContent(size_t pSize) {
+    std::string content;
+    content.reserve(pSize + 78);
+    const std::string line { Base64::Encode(reinterpret_cast<const unsigned char *>(
+                "2024-03-01;order shipped;Paris;12.50;EUR;paid by card"), 57) + "\r\n" };
+    while (content.size() < pSize) {
+        content += line;
+    }
+    content.resize(pSize);
+    return content;
+}
+}  // namespace
+
+static void BM_DkimBodyHasher_update(benchmark::State &state) {
+    const std::string content = createEncodedContent(static_cast<size_t>(state.range(0)));
+    DkimBodyHasher hasher;
+    for (auto _ : state) {
+        hasher.update(content);
+        benchmark::DoNotOptimize(hasher.finish());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_DkimBodyHasher_update)->Arg(64 * 1024)->Arg(1024 * 1024);
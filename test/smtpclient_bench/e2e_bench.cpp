@@ -0,0 +1,245 @@
+// End-to-end benchmark of the SMTP clients against the loopback FakeSmtpServer.
+//
+// Usage: smtpclient_e2e_bench [--clients=plain,starttls,implicit]
+//     [--threads=1,4,16] [--sizes=1024,65536,1048576] [--messages=200]
+//     [--latency-us=0] [--persistent] [--no-pipelining] [--no-chunking]
+//
+// For each client, thread count and message size, the messages are shared
+// between the threads, each with its own client. The messages per second and
+// the 50th and 99th percentiles of the sendMail latency are printed. Without
+// --persistent, each message opens its own session (connection, TLS
+// handshake and authentication).
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "fakesmtpserver.h"
+#include "../../src/credential.h"
+#include "../../src/forcedsecuresmtpclient.h"
+#include "../../src/messageaddress.h"
+#include "../../src/opportunisticsecuresmtpclient.h"
+#include "../../src/plaintextmessage.h"
+#include "../../src/smtpclient.h"
+#include "../../src/tlscontext.h"
+
+using namespace jed_utils;
+using namespace jed_utils::bench;
+
+namespace {
+struct BenchOptions {
+    std::vector<std::string> Clients { "plain", "starttls", "implicit" };
+    std::vector<size_t> Threads { 1, 4, 16 };
+    std::vector<size_t> Sizes { 1024, 65536, 1048576 };
+    size_t Messages = 200;
+    FakeSmtpServerOptions Server;
+    bool Persistent = false;
+};
+
+struct RunResult {
+    double MessagesPerSecond = 0;
+    double P50Milliseconds = 0;
+    double P99Milliseconds = 0;
+    size_t ErrorCount = 0;
+};
+
+std::vector<std::string> splitList(const std::string &pValue) {
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= pValue.size()) {
+        size_t end = pValue.find(',', start);
+        if (end == std::string::npos) {
+            end = pValue.size();
+        }
+        if (end > start) {
+            items.push_back(pValue.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return items;
+}
+
+std::vector<size_t> splitNumberList(const std::string &pValue) {
+    std::vector<size_t> numbers;
+    for (const auto &item : splitList(pValue)) {
+        numbers.push_back(std::strtoul(item.c_str(), nullptr, 10));
+    }
+    return numbers;
+}
+
+bool parseArguments(int argc, char *argv[], BenchOptions &pOptions) {
+    for (int i = 1; i < argc; i++) {
+        const std::string argument { argv[i] };
+        const size_t equal = argument.find('=');
+        const std::string name { argument.substr(0, equal) };
+        const std::string value { equal == std::string::npos ? "" : argument.substr(equal + 1) };
+        if (name == "--clients") {
+            pOptions.Clients = splitList(value);
+        } else if (name == "--threads") {
+            pOptions.Threads = splitNumberList(value);
+        } else if (name == "--sizes") {
+            pOptions.Sizes = splitNumberList(value);
+        } else if (name == "--messages") {
+            pOptions.Messages = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (name == "--latency-us") {
+            pOptions.Server.Latency = std::chrono::microseconds(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (name == "--persistent") {
+            pOptions.Persistent = true;
+        } else if (name == "--no-pipelining") {
+            pOptions.Server.Pipelining = false;
+        } else if (name == "--no-chunking") {
+            pOptions.Server.Chunking = false;
+        } else {
+            std::fprintf(stderr, "Unknown argument %s\n", argument.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<SMTPClientBase> createClient(const std::string &pClient,
+        unsigned int pPort,
+        const std::shared_ptr<TlsContext> &pTlsContext) {
+    const Credential credential("bench@example.com", "password");
+    if (pClient == "starttls") {
+        auto client = std::make_unique<OpportunisticSecureSMTPClient>("127.0.0.1", pPort);
+        client->setTlsContext(pTlsContext);
+        client->setCredentials(credential);
+        return client;
+    }
+    if (pClient == "implicit") {
+        auto client = std::make_unique<ForcedSecureSMTPClient>("127.0.0.1", pPort);
+        client->setTlsContext(pTlsContext);
+        client->setCredentials(credential);
+        return client;
+    }
+    return std::make_unique<SmtpClient>("127.0.0.1", pPort);
+}
+
+double percentile(const std::vector<double> &pSortedValues, double pRank) {
+    if (pSortedValues.empty()) {
+        return 0;
+    }
+    const auto index = static_cast<size_t>(std::ceil(pRank * static_cast<double>(pSortedValues.size())));
+    return pSortedValues[(std::max)(index, size_t { 1 }) - 1];
+}
+
+RunResult run(const BenchOptions &pOptions,
+        const std::string &pClient,
+        unsigned int pPort,
+        const std::shared_ptr<TlsContext> &pTlsContext,
+        size_t pThreadCount,
+        const Message &pMessage) {
+    std::mutex results_mutex;
+    std::vector<double> latencies;
+    latencies.reserve(pOptions.Messages);
+    RunResult result;
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < pThreadCount; t++) {
+        const size_t message_count = pOptions.Messages / pThreadCount + (t < pOptions.Messages % pThreadCount ? 1 : 0);
+        threads.emplace_back([&, message_count]() {
+            auto client = createClient(pClient, pPort, pTlsContext);
+            client->setCommunicationLogLevel(CommunicationLogLevel::None);
+            std::vector<double> thread_latencies;
+            thread_latencies.reserve(message_count);
+            size_t error_count = 0;
+            if (pOptions.Persistent && client->connect() != 0) {
+                error_count = message_count;
+            } else {
+                for (size_t i = 0; i < message_count; i++) {
+                    const auto send_start = std::chrono::steady_clock::now();
+                    if (client->sendMail(pMessage) != 0) {
+                        error_count++;
+                    }
+                    const std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - send_start;
+                    thread_latencies.push_back(latency.count());
+                }
+            }
+            if (pOptions.Persistent) {
+                client->disconnect();
+            }
+            std::lock_guard<std::mutex> lock(results_mutex);
+            latencies.insert(latencies.end(), thread_latencies.begin(), thread_latencies.end());
+            result.ErrorCount += error_count;
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::sort(latencies.begin(), latencies.end());
+    result.MessagesPerSecond = static_cast<double>(latencies.size() - std::min(latencies.size(), result.ErrorCount)) / elapsed.count();
+    result.P50Milliseconds = percentile(latencies, 0.50);
+    result.P99Milliseconds = percentile(latencies, 0.99);
+    return result;
+}
+
+FakeSmtpServerMode getServerMode(const std::string &pClient) {
+    if (pClient == "starttls") {
+        return FakeSmtpServerMode::StartTLS;
+    }
+    if (pClient == "implicit") {
+        return FakeSmtpServerMode::ImplicitTLS;
+    }
+    return FakeSmtpServerMode::Plain;
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    BenchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        return 1;
+    }
+    std::printf("%-10s %8s %10s %12s %10s %10s %8s\n",
+            "client", "threads", "size", "msgs/s", "p50 (ms)", "p99 (ms)", "errors");
+    for (const auto &client : options.Clients) {
+        FakeSmtpServerOptions server_options = options.Server;
+        server_options.Mode = getServerMode(client);
+        FakeSmtpServer server(server_options);
+        if (server.start() != 0) {
+            std::fprintf(stderr, "Unable to start the fake server for %s\n", client.c_str());
+            return 1;
+        }
+        // The clients trust the self-signed certificate of the server
+        auto tls_context = std::make_shared<TlsContext>();
+        if (!tls_context->isValid() || server.addTrustAnchorTo(tls_context->getNativeContext()) != 0) {
+            std::fprintf(stderr, "Unable to create the TLS context\n");
+            return 1;
+        }
+        for (size_t size : options.Sizes) {
+            std::string body;
+            body.reserve(size);
+            while (body.size() < size) {
+                body.append(std::string((std::min)(size - body.size(), size_t { 76 }), 'x'));
+                body.append("\r\n");
+            }
+            const PlaintextMessage message(MessageAddress("from@example.com", "Bench"),
+                    MessageAddress("to@example.com"),
+                    "Benchmark",
+                    body.c_str());
+            for (size_t thread_count : options.Threads) {
+                if (thread_count == 0) {
+                    continue;
+                }
+                const RunResult result = run(options, client, server.getPort(), tls_context, thread_count, message);
+                std::printf("%-10s %8zu %10zu %12.1f %10.3f %10.3f %8zu\n",
+                        client.c_str(),
+                        thread_count,
+                        size,
+                        result.MessagesPerSecond,
+                        result.P50Milliseconds,
+                        result.P99Milliseconds,
+                        result.ErrorCount);
+                std::fflush(stdout);
+            }
+        }
+        server.stop();
+    }
+    return 0;
+}
@@ -0,0 +1,382 @@
+#include "fakesmtpserver.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/evp.h>
+#include <openssl/x509v3.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <utility>
+
+using namespace jed_utils::bench;
+
+namespace {
+// Reads and writes through TLS once it has been negotiated
+class Channel {
+ public:
+    explicit Channel(int pSocket)
+        : mSocket(pSocket), mSSL(nullptr) {
+    }
+
+    ~Channel() {
+        if (mSSL != nullptr) {
+            SSL_free(mSSL);
+        }
+    }
+
+    Channel(const Channel& other) = delete;
+    Channel& operator=(const Channel& other) = delete;
+
+    bool isSecure() const {
+        return mSSL != nullptr;
+    }
+
+    int startTLS(SSL_CTX *pCTX) {
+        mSSL = SSL_new(pCTX);
+        if (mSSL == nullptr || SSL_set_fd(mSSL, mSocket) != 1) {
+            return -1;
+        }
+        return SSL_accept(mSSL) == 1 ? 0 : -1;
+    }
+
+    // Return the number of bytes read, 0 or less when the connection is closed
+    long read(char *pBuffer, size_t pLength) {
+        if (mSSL != nullptr) {
+            return SSL_read(mSSL, pBuffer, static_cast<int>(pLength));
+        }
+        return recv(mSocket, pBuffer, pLength, 0);
+    }
+
+    bool write(std::string_view pData) {
+        while (!pData.empty()) {
+            long written = mSSL != nullptr
+                ? SSL_write(mSSL, pData.data(), static_cast<int>(pData.size()))
+                : send(mSocket, pData.data(), pData.size(), MSG_NOSIGNAL);
+            if (written <= 0) {
+                return false;
+            }
+            pData.remove_prefix(static_cast<size_t>(written));
+        }
+        return true;
+    }
+
+ private:
+    int mSocket;
+    SSL *mSSL;
+};
+
+bool startsWithCommand(std::string_view pLine, std::string_view pCommand) {
+    if (pLine.size() < pCommand.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < pCommand.size(); i++) {
+        if (std::toupper(static_cast<unsigned char>(pLine[i])) != pCommand[i]) {
+            return false;
+        }
+    }
+    return pLine.size() == pCommand.size() || pLine[pCommand.size()] == ' ';
+}
+}  // namespace
+
+FakeSmtpServer::FakeSmtpServer(const FakeSmtpServerOptions &pOptions)
+    : mOptions(pOptions),
+      mKey(nullptr),
+      mCertificate(nullptr),
+      mCTX(nullptr),
+      mListenSocket(-1),
+      mPort(0),
+      mStopping(false),
+      mMessageCount(0),
+      mConnectionThreadCount(0) {
+    generateCertificate();
+}
+
+FakeSmtpServer::~FakeSmtpServer() {
+    stop();
+    if (mCTX != nullptr) {
+        SSL_CTX_free(mCTX);
+    }
+    if (mCertificate != nullptr) {
+        X509_free(mCertificate);
+    }
+    if (mKey != nullptr) {
+        EVP_PKEY_free(mKey);
+    }
+}
+
+int FakeSmtpServer::generateCertificate() {
+    EVP_PKEY_CTX *key_ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+    if (key_ctx == nullptr) {
+        return -1;
+    }
+    if (EVP_PKEY_keygen_init(key_ctx) <= 0
+            || EVP_PKEY_CTX_set_ec_paramgen_curve_nid(key_ctx, NID_X9_62_prime256v1) <= 0
+            || EVP_PKEY_keygen(key_ctx, &mKey) <= 0) {
+        EVP_PKEY_CTX_free(key_ctx);
+        return -1;
+    }
+    EVP_PKEY_CTX_free(key_ctx);
+
+    mCertificate = X509_new();
+    X509_set_version(mCertificate, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(mCertificate), 1);
+    X509_gmtime_adj(X509_getm_notBefore(mCertificate), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(mCertificate), 7 * 24 * 3600);
+    X509_set_pubkey(mCertificate, mKey);
+    X509_NAME *name = X509_get_subject_name(mCertificate);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char *>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(mCertificate, name);
+
+    X509V3_CTX ext_ctx;
+    X509V3_set_ctx_nodb(&ext_ctx);
+    X509V3_set_ctx(&ext_ctx, mCertificate, mCertificate, nullptr, nullptr, 0);
+    const std::pair<int, const char *> extensions[] = {
+        { NID_basic_constraints, "critical,CA:TRUE" },
+        { NID_subject_alt_name, "DNS:localhost,IP:127.0.0.1" }
+    };
+    for (const auto &extension : extensions) {
+        X509_EXTENSION *ext = X509V3_EXT_conf_nid(nullptr, &ext_ctx, extension.first, extension.second);
+        if (ext == nullptr) {
+            return -1;
+        }
+        X509_add_ext(mCertificate, ext, -1);
+        X509_EXTENSION_free(ext);
+    }
+    return X509_sign(mCertificate, mKey, EVP_sha256()) > 0 ? 0 : -1;
+}
+
+int FakeSmtpServer::start() {
+    if (mOptions.Mode != FakeSmtpServerMode::Plain) {
+        mCTX = SSL_CTX_new(TLS_server_method());
+        if (mCTX == nullptr
+                || SSL_CTX_use_certificate(mCTX, mCertificate) != 1
+                || SSL_CTX_use_PrivateKey(mCTX, mKey) != 1) {
+            return -1;
+        }
+    }
+
+    mListenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (mListenSocket < 0) {
+        return -1;
+    }
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t address_length = sizeof(address);
+    if (bind(mListenSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0
+            || listen(mListenSocket, SOMAXCONN) != 0
+            || getsockname(mListenSocket, reinterpret_cast<sockaddr *>(&address), &address_length) != 0) {
+        close(mListenSocket);
+        mListenSocket = -1;
+        return -1;
+    }
+    mPort = ntohs(address.sin_port);
+    mStopping = false;
+    mAcceptThread = std::thread(&FakeSmtpServer::acceptConnections, this);
+    return 0;
+}
+
+void FakeSmtpServer::stop() {
+    mStopping = true;
+    if (mAcceptThread.joinable()) {
+        mAcceptThread.join();
+    }
+    if (mListenSocket >= 0) {
+        close(mListenSocket);
+        mListenSocket = -1;
+    }
+    std::unique_lock<std::mutex> lock(mConnectionsMutex);
+    // Unblock the reads of the connection threads
+    for (int open_socket : mOpenSockets) {
+        shutdown(open_socket, SHUT_RDWR);
+    }
+    mConnectionsClosed.wait(lock, [this]() { return mConnectionThreadCount == 0; });
+}
+
+unsigned int FakeSmtpServer::getPort() const {
+    return mPort;
+}
+
+size_t FakeSmtpServer::getMessageCount() const {
+    return mMessageCount;
+}
+
+X509 *FakeSmtpServer::getCertificate() const {
+    return mCertificate;
+}
+
+int FakeSmtpServer::addTrustAnchorTo(SSL_CTX *pClientContext) const {
+    if (pClientContext == nullptr || mCertificate == nullptr) {
+        return -1;
+    }
+    return X509_STORE_add_cert(SSL_CTX_get_cert_store(pClientContext), mCertificate) == 1 ? 0 : -1;
+}
+
+void FakeSmtpServer::acceptConnections() {
+    const int POLL_INTERVAL_MS = 50;
+    while (!mStopping) {
+        pollfd listen_fd { mListenSocket, POLLIN, 0 };
+        if (poll(&listen_fd, 1, POLL_INTERVAL_MS) <= 0) {
+            continue;
+        }
+        int client_socket = accept(mListenSocket, nullptr, nullptr);
+        if (client_socket < 0) {
+            continue;
+        }
+        // The replies are written once per batch, they must not wait for an ACK
+        int no_delay = 1;
+        setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+        std::lock_guard<std::mutex> lock(mConnectionsMutex);
+        mOpenSockets.insert(client_socket);
+        mConnectionThreadCount++;
+        std::thread(&FakeSmtpServer::serveConnection, this, client_socket).detach();
+    }
+}
+
+void FakeSmtpServer::serveConnection(int pSocket) {
+    {
+        Channel channel(pSocket);
+        bool connected = mOptions.Mode != FakeSmtpServerMode::ImplicitTLS || channel.startTLS(mCTX) == 0;
+        std::string input;
+        std::string output { "220 fake ESMTP ready\r\n" };
+        bool in_data = false;
+        size_t bdat_remaining = 0;
+        bool bdat_last = false;
+        int auth_lines_remaining = 0;
+        bool quit = false;
+        auto flush = [&]() {
+            if (output.empty()) {
+                return true;
+            }
+            if (mOptions.Latency.count() > 0) {
+                std::this_thread::sleep_for(mOptions.Latency);
+            }
+            bool written = channel.write(output);
+            output.clear();
+            return written;
+        };
+        const size_t READ_BUFFER_SIZE = 65536;
+        std::string read_buffer(READ_BUFFER_SIZE, '\0');
+        while (connected && !quit && flush()) {
+            long read_length = channel.read(&read_buffer[0], read_buffer.size());
+            if (read_length <= 0) {
+                break;
+            }
+            input.append(read_buffer.data(), static_cast<size_t>(read_length));
+            // Answer all the complete commands received, the replies are sent together
+            while (!quit) {
+                if (bdat_remaining > 0) {
+                    const size_t length = (std::min)(bdat_remaining, input.size());
+                    input.erase(0, length);
+                    bdat_remaining -= length;
+                    if (bdat_remaining > 0) {
+                        break;
+                    }
+                    output += "250 2.0.0 Chunk accepted\r\n";
+                    if (bdat_last) {
+                        mMessageCount++;
+                    }
+                    continue;
+                }
+                if (in_data) {
+                    const size_t end = input.find("\r\n.\r\n");
+                    if (end == std::string::npos) {
+                        // Keep the bytes that can start the end of the data
+                        if (input.size() > 4) {
+                            input.erase(0, input.size() - 4);
+                        }
+                        break;
+                    }
+                    input.erase(0, end + 5);
+                    in_data = false;
+                    mMessageCount++;
+                    output += "250 2.0.0 Message accepted\r\n";
+                    continue;
+                }
+                const size_t line_end = input.find("\r\n");
+                if (line_end == std::string::npos) {
+                    break;
+                }
+                const std::string line { input.substr(0, line_end) };
+                input.erase(0, line_end + 2);
+                if (auth_lines_remaining > 0) {
+                    output += --auth_lines_remaining > 0 ? "334 UGFzc3dvcmQ6\r\n" : "235 2.7.0 Authentication successful\r\n";
+                } else if (startsWithCommand(line, "EHLO")) {
+                    output += "250-fake greets you\r\n";
+                    if (mOptions.Pipelining) {
+                        output += "250-PIPELINING\r\n";
+                    }
+                    if (mOptions.Chunking) {
+                        output += "250-CHUNKING\r\n250-BINARYMIME\r\n";
+                    }
+                    if (mOptions.Auth && (mOptions.Mode == FakeSmtpServerMode::Plain || channel.isSecure())) {
+                        output += "250-AUTH PLAIN LOGIN\r\n";
+                    }
+                    if (mOptions.Mode == FakeSmtpServerMode::StartTLS && !channel.isSecure()) {
+                        output += "250-STARTTLS\r\n";
+                    }
+                    output += "250-8BITMIME\r\n250 ENHANCEDSTATUSCODES\r\n";
+                } else if (startsWithCommand(line, "HELO")) {
+                    output += "250 fake\r\n";
+                } else if (startsWithCommand(line, "STARTTLS")
+                        && mOptions.Mode == FakeSmtpServerMode::StartTLS && !channel.isSecure()) {
+                    output += "220 2.0.0 Ready to start TLS\r\n";
+                    // The commands sent before the negotiation are discarded
+                    input.clear();
+                    connected = flush() && channel.startTLS(mCTX) == 0;
+                    break;
+                } else if (startsWithCommand(line, "AUTH") && mOptions.Auth) {
+                    const std::string_view arguments = std::string_view(line).substr((std::min)(line.size(), size_t { 5 }));
+                    if (startsWithCommand(arguments, "LOGIN")) {
+                        auth_lines_remaining = 2;
+                        output += "334 VXNlcm5hbWU6\r\n";
+                    } else if (arguments.find(' ') == std::string_view::npos) {
+                        auth_lines_remaining = 1;
+                        output += "334 \r\n";
+                    } else {
+                        output += "235 2.7.0 Authentication successful\r\n";
+                    }
+                } else if (startsWithCommand(line, "MAIL") || startsWithCommand(line, "RSET")
+                        || startsWithCommand(line, "NOOP")) {
+                    output += "250 2.0.0 OK\r\n";
+                } else if (startsWithCommand(line, "RCPT")) {
+                    output += "250 2.1.5 OK\r\n";
+                } else if (startsWithCommand(line, "DATA")) {
+                    output += "354 End data with <CR><LF>.<CR><LF>\r\n";
+                    in_data = true;
+                    // The data can end on its first line
+                    input.insert(0, "\r\n");
+                } else if (startsWithCommand(line, "BDAT")) {
+                    bdat_remaining = std::strtoul(line.c_str() + 5, nullptr, 10);
+                    bdat_last = line.find(" LAST") != std::string::npos;
+                    if (bdat_remaining == 0) {
+                        output += "250 2.0.0 Chunk accepted\r\n";
+                        if (bdat_last) {
+                            mMessageCount++;
+                        }
+                    }
+                } else if (startsWithCommand(line, "QUIT")) {
+                    output += "221 2.0.0 Bye\r\n";
+                    flush();
+                    quit = true;
+                } else {
+                    output += "500 5.5.2 Command not recognized\r\n";
+                }
+            }
+        }
+    }
+    std::unique_lock<std::mutex> lock(mConnectionsMutex);
+    // Closed under the lock so that stop never shuts down a reused descriptor
+    close(pSocket);
+    mOpenSockets.erase(pSocket);
+    mConnectionThreadCount--;
+    // Notified once the thread no longer touches the server
+    std::notify_all_at_thread_exit(mConnectionsClosed, std::move(lock));
+}
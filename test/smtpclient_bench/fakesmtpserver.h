@@ -0,0 +1,104 @@
+#ifndef FAKESMTPSERVER_H
+#define FAKESMTPSERVER_H
+
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace jed_utils {
+namespace bench {
+
+/** @brief The security of the connections accepted by the FakeSmtpServer. */
+enum class FakeSmtpServerMode {
+    /** Plain connections, STARTTLS is not advertised. */
+    Plain,
+    /** Plain connections that advertise STARTTLS (port 587). */
+    StartTLS,
+    /** TLS from the first byte (port 465). */
+    ImplicitTLS
+};
+
+/** @brief The options of a FakeSmtpServer. */
+struct FakeSmtpServerOptions {
+    FakeSmtpServerMode Mode = FakeSmtpServerMode::Plain;
+    /** Advertise PIPELINING (RFC 2920). */
+    bool Pipelining = true;
+    /** Advertise CHUNKING and BINARYMIME (RFC 3030). */
+    bool Chunking = true;
+    /** Advertise AUTH PLAIN LOGIN. Any credential is accepted. */
+    bool Auth = true;
+    /** The delay before the replies to the commands received together are
+     *  sent. Pipelined commands pay it once, like a network round trip. */
+    std::chrono::microseconds Latency { 0 };
+};
+
+/** @brief The FakeSmtpServer class is an SMTP sink listening on the loopback
+ *  interface, used to measure the clients without a real relay.
+ *
+ *  The server answers EHLO, STARTTLS, AUTH, MAIL, RCPT, DATA, BDAT, RSET, NOOP
+ *  and QUIT, discards the messages and counts them. Each connection is served
+ *  by its own thread. The TLS connections use a self-signed certificate for
+ *  localhost and 127.0.0.1 generated when the server is constructed.
+ */
+class FakeSmtpServer {
+ public:
+    explicit FakeSmtpServer(const FakeSmtpServerOptions &pOptions = FakeSmtpServerOptions());
+    ~FakeSmtpServer();
+    FakeSmtpServer(const FakeSmtpServer& other) = delete;
+    FakeSmtpServer& operator=(const FakeSmtpServer& other) = delete;
+
+    /**
+     *  @brief  Listen on an ephemeral port of 127.0.0.1 and start accepting
+     *  the connections.
+     *  @return 0 for success, -1 if the socket or the TLS context cannot be
+     *  created.
+     */
+    int start();
+
+    /** Stop accepting, close the open connections and wait for their threads. */
+    void stop();
+
+    /** Return the port the server listens on, 0 before start. */
+    unsigned int getPort() const;
+
+    /** Return the number of messages accepted. */
+    size_t getMessageCount() const;
+
+    /** Return the self-signed certificate of the server. */
+    X509 *getCertificate() const;
+
+    /**
+     *  @brief  Add the certificate of the server to the trust anchors of a
+     *  client context so that its connections are verified.
+     *  @return 0 for success, -1 if the certificate cannot be added.
+     */
+    int addTrustAnchorTo(SSL_CTX *pClientContext) const;
+
+ private:
+    void acceptConnections();
+    void serveConnection(int pSocket);
+    int generateCertificate();
+    FakeSmtpServerOptions mOptions;
+    EVP_PKEY *mKey;
+    X509 *mCertificate;
+    SSL_CTX *mCTX;
+    int mListenSocket;
+    unsigned int mPort;
+    std::atomic<bool> mStopping;
+    std::atomic<size_t> mMessageCount;
+    std::thread mAcceptThread;
+    std::mutex mConnectionsMutex;
+    std::condition_variable mConnectionsClosed;
+    std::set<int> mOpenSockets;
+    size_t mConnectionThreadCount;
+};
+}  // namespace bench
+}  // namespace jed_utils
+
+#endif
@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../../src/addressvalidator.h"
+#include "../../src/messageaddress.h"
+#include "../../src/plaintextmessage.h"
+
+using namespace jed_utils;
+
+namespace {
+const char *ADDRESSES[] {
+    "john.doe@example.com",
+    "first.last+tag@sub.domain.example.org",
+    "user@[192.168.0.1]",
+    "not an address",
+    "very.long.local.part.with.many.dots@mail.a-very-long-domain-name.example"
+};
+}  // namespace
+
+static void BM_MessageAddress_Construct(benchmark::State &state) {
+    for (auto _ : state) {
+        MessageAddress address("john.doe@example.com", "John Doe");
+        benchmark::DoNotOptimize(address.getEmailAddress());
+    }
+}
+BENCHMARK(BM_MessageAddress_Construct);
+
+static void BM_AddressValidator_isValid(benchmark::State &state) {
+    for (auto _ : state) {
+        for (const char *address : ADDRESSES) {
+            benchmark::DoNotOptimize(AddressValidator::isValid(address));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(sizeof(ADDRESSES) / sizeof(ADDRESSES[0])));
+}
+BENCHMARK(BM_AddressValidator_isValid);
+
+static void BM_AddressValidator_validateAddresses(benchmark::State &state) {
+    std::vector<std::string> addresses;
+    for (int64_t index = 0; index < state.range(0); index++) {
+        addresses.push_back("recipient" + std::to_string(index) + "@example.com");
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(AddressValidator::validateAddresses(addresses));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_AddressValidator_validateAddresses)->Arg(10)->Arg(1000);
+
+static void BM_Message_CopyWithBcc(benchmark::State &state) {
+    std::vector<MessageAddress> bcc;
+    for (int64_t index = 0; index < state.range(0); index++) {
+        bcc.emplace_back(("recipient" + std::to_string(index) + "@example.com").c_str());
+    }
+    const PlaintextMessage msg(MessageAddress("from@example.com"), { MessageAddress("to@example.com") },
+            "Subject", std::make_shared<const std::string>("Body"), {}, std::move(bcc));
+    for (auto _ : state) {
+        PlaintextMessage copy(msg);
+        benchmark::DoNotOptimize(copy.getBccCount());
+    }
+}
+BENCHMARK(BM_Message_CopyWithBcc)->Arg(10)->Arg(5000);
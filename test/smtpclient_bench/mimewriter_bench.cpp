@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../../src/attachment.h"
+#include "../../src/attachmentsource.h"
+#include "../../src/mimewriter.h"
+#include "../../src/plaintextmessage.h"
+
+using namespace jed_utils;
+
+namespace {
+PlaintextMessage createMessage(size_t pAttachmentCount) {
+    std::vector<Attachment> attachments;
+    for (size_t index = 0; index < pAttachmentCount; index++) {
+        attachments.emplace_back(std::make_shared<BufferAttachmentSource>(std::string(64 * 1024, 'a')),
+                ("attachment" + std::to_string(index) + ".pdf").c_str());
+    }
+    const MessageAddress to[] { MessageAddress("to@example.com"), MessageAddress("other@example.com") };
+    std::string body;
+    for (size_t line = 0; line < 200; line++) {
+        body += "This is a line of the body of the message.\r\n";
+    }
+    return PlaintextMessage(MessageAddress("from@example.com"),
+            to,
+            2,
+            "Monthly report",
+            body.c_str(),
+            nullptr,
+            0,
+            nullptr,
+            0,
+            attachments.data(),
+            attachments.size());
+}
+}  // namespace
+
+static void BM_MimeWriter_write(benchmark::State &state) {
+    const PlaintextMessage msg = createMessage(static_cast<size_t>(state.range(0)));
+    MimeWriter writer;
+    for (auto _ : state) {
+        writer.write(msg);
+        benchmark::DoNotOptimize(writer.getContent().data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(writer.getSize()));
+}
+BENCHMARK(BM_MimeWriter_write)->Arg(0)->Arg(1)->Arg(10);
+
+static void BM_MimeWriter_computeSize(benchmark::State &state) {
+    const PlaintextMessage msg = createMessage(static_cast<size_t>(state.range(0)));
+    const MimeBoundary boundary;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(MimeWriter::computeSize(msg, boundary));
+    }
+}
+BENCHMARK(BM_MimeWriter_computeSize)->Arg(0)->Arg(1)->Arg(10);
+
+// A boundary is drawn from the generator of the thread, the body is only
+// searched for it when it contains =_
+static void BM_MimeBoundary_generate(benchmark::State &state) {
+    const std::string body(static_cast<size_t>(state.range(0)), 'a');
+    MimeBoundary boundary;
+    for (auto _ : state) {
+        boundary.generate(body);
+        benchmark::DoNotOptimize(boundary.getValue().data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_MimeBoundary_generate)->Arg(0)->Arg(64 * 1024);
+
+// The headers are appended to a buffer that is reused, an ASCII subject and
+// the folding of the To header do not allocate
+static void BM_MimeWriter_appendHeaders(benchmark::State &state) {
+    std::vector<MessageAddress> to;
+    for (int64_t index = 0; index < state.range(0); index++) {
+        to.emplace_back(("recipient" + std::to_string(index) + "@example.com").c_str());
+    }
+    const PlaintextMessage msg(MessageAddress("from@example.com"),
+            to.data(),
+            to.size(),
+            state.range(1) != 0 ? "Rapport mensuel \xE2\x80\x94 r\xC3\xA9sultats" : "Monthly report",
+            "Body");
+    const MimeBoundary boundary;
+    std::string headers;
+    for (auto _ : state) {
+        headers.clear();
+        MimeWriter::appendHeaders(msg, boundary, nullptr, headers);
+        benchmark::DoNotOptimize(headers.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(headers.size()));
+}
+BENCHMARK(BM_MimeWriter_appendHeaders)->Args({ 1, 0 })->Args({ 100, 0 })->Args({ 1, 1 });
@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include "../../src/base64.h"
+#include "../../src/quotedprintable.h"
+
+using namespace jed_utils;
+
+namespace {
+// Lines of a CSV export, mostly ASCII with a few accented characters
+std::string createTextContent(size_t pSize) {
+    const std::string line { "2024-03-01;Caf\xC3\xA9 de la gare;Paris;12.50;EUR;paid by card\n" };
+    std::string content;
+    content.reserve(pSize + line.size());
+    while (content.size() < pSize) {
+        content += line;
+    }
+    content.resize(pSize);
+    return content;
+}
+}  // namespace
+
+static void BM_QuotedPrintable_encode(benchmark::State &state) {
+    const std::string content = createTextContent(static_cast<size_t>(state.range(0)));
+    std::string encoded;
+    for (auto _ : state) {
+        encoded.clear();
+        QuotedPrintableEncoder encoder;
+        encoder.encode(content, encoded);
+        encoder.finish(encoded);
+        benchmark::DoNotOptimize(encoded.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.counters["ratio"] = static_cast<double>(encoded.size()) / static_cast<double>(content.size());
+}
+BENCHMARK(BM_QuotedPrintable_encode)->Arg(4096)->Arg(64 * 1024)->Arg(1024 * 1024);
+
+static void BM_QuotedPrintable_measure(benchmark::State &state) {
+    const std::string content = createTextContent(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        QuotedPrintableEncoder encoder;
+        encoder.measure(content);
+        encoder.finishMeasure();
+        benchmark::DoNotOptimize(encoder.getEncodedSize());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_QuotedPrintable_measure)->Arg(64 * 1024)->Arg(1024 * 1024);
+
+// The same content in base64, for comparison
+static void BM_QuotedPrintable_Base64Baseline(benchmark::State &state) {
+    const std::string content = createTextContent(static_cast<size_t>(state.range(0)));
+    std::string encoded(Base64::EncodedLength(content.size()), '\0');
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Base64::EncodeToBuffer(reinterpret_cast<const unsigned char *>(content.data()),
+                    content.size(),
+                    &encoded[0]));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.counters["ratio"] = static_cast<double>(encoded.size()) / static_cast<double>(content.size());
+}
+BENCHMARK(BM_QuotedPrintable_Base64Baseline)->Arg(64 * 1024)->Arg(1024 * 1024);
@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include "../../src/nulltransport.h"
+#include "../../src/plaintextmessage.h"
+#include "../../src/serverauthoptions.h"
+#include "../../src/smtpclient.h"
+
+using namespace jed_utils;
+
+namespace {
+// Expose the protected members measured
+class BenchSmtpClient : public SmtpClient {
+ public:
+    BenchSmtpClient()
+        : SmtpClient("127.0.0.1", 25) {
+    }
+    using SMTPClientBase::addCommunicationLogItem;
+    using SMTPClientBase::extractAuthenticationOptions;
+    using SMTPClientBase::extractReturnCode;
+    using SMTPClientBase::extractServerCapabilities;
+};
+
+const char EHLO_RESPONSE[] = "250-smtp.example.com at your service, [203.0.113.7]\r\n"
+    "250-SIZE 35882577\r\n"
+    "250-8BITMIME\r\n"
+    "250-STARTTLS\r\n"
+    "250-AUTH LOGIN PLAIN XOAUTH2 PLAIN-CLIENTTOKEN OAUTHBEARER XOAUTH\r\n"
+    "250-ENHANCEDSTATUSCODES\r\n"
+    "250-PIPELINING\r\n"
+    "250-CHUNKING\r\n"
+    "250 SMTPUTF8\r\n";
+}  // namespace
+
+static void BM_SMTPClientBase_extractAuthenticationOptions(benchmark::State &state) {
+    for (auto _ : state) {
+        ServerAuthOptions *options = BenchSmtpClient::extractAuthenticationOptions(EHLO_RESPONSE);
+        benchmark::DoNotOptimize(options);
+        delete options;
+    }
+}
+BENCHMARK(BM_SMTPClientBase_extractAuthenticationOptions);
+
+static void BM_SMTPClientBase_extractServerCapabilities(benchmark::State &state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BenchSmtpClient::extractServerCapabilities(EHLO_RESPONSE));
+    }
+}
+BENCHMARK(BM_SMTPClientBase_extractServerCapabilities);
+
+static void BM_SMTPClientBase_extractReturnCode(benchmark::State &state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BenchSmtpClient::extractReturnCode("250 2.1.5 OK\r\n"));
+    }
+}
+BENCHMARK(BM_SMTPClientBase_extractReturnCode);
+
+// Fill the log well past its capacity, the oldest items are overwritten
+static void BM_SMTPClientBase_addCommunicationLogItem(benchmark::State &state) {
+    const std::string item(static_cast<size_t>(state.range(0)), 'x');
+    BenchSmtpClient client;
+    for (auto _ : state) {
+        client.addCommunicationLogItem(item.c_str());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_SMTPClientBase_addCommunicationLogItem)->Arg(32)->Arg(1024);
+
+// Dry run of a persistent session: rendering, encoding and dot-stuffing of
+// the messages without the network
+static void BM_SmtpClient_sendMailWithNullTransport(benchmark::State &state) {
+    auto transport = std::make_shared<NullTransport>(state.range(1) != 0);
+    SmtpClient client("127.0.0.1", 25);
+    client.setTransport(transport);
+    client.setCommunicationLogLevel(CommunicationLogLevel::None);
+    const std::string body(static_cast<size_t>(state.range(0)), 'x');
+    PlaintextMessage msg(MessageAddress("from@example.com"), MessageAddress("to@example.com"), "Subject", body.c_str());
+    client.connect();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(client.sendMail(msg));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.SetBytesProcessed(static_cast<int64_t>(transport->getContentByteCount()));
+}
+BENCHMARK(BM_SmtpClient_sendMailWithNullTransport)->Args({ 1024, 0 })->Args({ 1048576, 0 })->Args({ 1048576, 1 });
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "../../src/addressvalidator.h"
+
+using namespace jed_utils;
+
+TEST(AddressValidator_isValid, WithCommonAddresses_ReturnTrue) {
+    ASSERT_TRUE(AddressValidator::isValid("test@domain.com"));
+    ASSERT_TRUE(AddressValidator::isValid("first.last@sub.domain-example.co.uk"));
+    ASSERT_TRUE(AddressValidator::isValid("User+Tag@Example.COM"));
+    ASSERT_TRUE(AddressValidator::isValid("test@domain"));
+    ASSERT_TRUE(AddressValidator::isValid("a@b.museum"));
+}
+
+TEST(AddressValidator_isValid, WithAtextCharacters_ReturnTrue) {
+    ASSERT_TRUE(AddressValidator::isValid("!#$%&'*+-/=?^_`{|}~@domain.com"));
+}
+
+TEST(AddressValidator_isValid, WithAddressLiteral_ReturnTrue) {
+    ASSERT_TRUE(AddressValidator::isValid("test@[192.168.0.1]"));
+    ASSERT_TRUE(AddressValidator::isValid("test@[IPv6:2001:db8::1]"));
+}
+
+TEST(AddressValidator_isValid, WithMissingParts_ReturnFalse) {
+    ASSERT_FALSE(AddressValidator::isValid(""));
+    ASSERT_FALSE(AddressValidator::isValid(" "));
+    ASSERT_FALSE(AddressValidator::isValid("test"));
+    ASSERT_FALSE(AddressValidator::isValid("@"));
+    ASSERT_FALSE(AddressValidator::isValid("test@"));
+    ASSERT_FALSE(AddressValidator::isValid("@domain.com"));
+}
+
+TEST(AddressValidator_isValid, WithInvalidDots_ReturnFalse) {
+    ASSERT_FALSE(AddressValidator::isValid(".test@domain.com"));
+    ASSERT_FALSE(AddressValidator::isValid("test.@domain.com"));
+    ASSERT_FALSE(AddressValidator::isValid("te..st@domain.com"));
+    ASSERT_FALSE(AddressValidator::isValid("test@.domain.com"));
+    ASSERT_FALSE(AddressValidator::isValid("test@domain..com"));
+    ASSERT_FALSE(AddressValidator::isValid("test@domain.com."));
+}
+
+TEST(AddressValidator_isValid, WithInvalidCharacters_ReturnFalse) {
+    ASSERT_FALSE(AddressValidator::isValid("te st@domain.com"));
+    ASSERT_FALSE(AddressValidator::isValid("test@dom@ain.com"));
+    ASSERT_FALSE(AddressValidator::isValid("test@do_main.com"));
+    ASSERT_FALSE(AddressValidator::isValid("test@domain.com\r\nRCPT TO:<other@domain.com>"));
+    ASSERT_FALSE(AddressValidator::isValid("<test@domain.com>"));
+}
+
+TEST(AddressValidator_isValid, WithInternationalizedAddress_ReturnTrue) {
+    ASSERT_TRUE(AddressValidator::isValid("t\xc3\xa9st@domain.com"));
+    ASSERT_TRUE(AddressValidator::isValid("test@b\xc3\xbc" "cher.example"));
+    ASSERT_TRUE(AddressValidator::isValid("\xe7\x94\xa8\xe6\x88\xb7@\xe4\xbe\x8b\xe5\xad\x90.\xe5\x85\xac\xe5\x8f\xb8"));
+}
+
+TEST(AddressValidator_isValid, WithInvalidUtf8_ReturnFalse) {
+    ASSERT_FALSE(AddressValidator::isValid("t\xc3st@domain.com"));
+    ASSERT_FALSE(AddressValidator::isValid("test@domain.c\xc0\xafm"));
+}
+
+TEST(AddressValidator_isValid, WithHyphenAtLabelEnds_ReturnFalse) {
+    ASSERT_FALSE(AddressValidator::isValid("test@-domain.com"));
+    ASSERT_FALSE(AddressValidator::isValid("test@domain-.com"));
+    ASSERT_FALSE(AddressValidator::isValid("test@domain.com-"));
+}
+
+TEST(AddressValidator_isValid, WithInvalidAddressLiteral_ReturnFalse) {
+    ASSERT_FALSE(AddressValidator::isValid("test@[]"));
+    ASSERT_FALSE(AddressValidator::isValid("test@[192.168.0.1"));
+    ASSERT_FALSE(AddressValidator::isValid("test@[2001:db8::1]"));
+    ASSERT_FALSE(AddressValidator::isValid("test@[IPv6:]"));
+}
+
+TEST(AddressValidator_isValid, WithLengthLimits_ReturnExpected) {
+    const std::string local_part_64(64, 'a');
+    const std::string label_63(63, 'b');
+    ASSERT_TRUE(AddressValidator::isValid(local_part_64 + "@" + label_63 + ".com"));
+    ASSERT_FALSE(AddressValidator::isValid(local_part_64 + "a@domain.com"));
+    ASSERT_FALSE(AddressValidator::isValid("test@" + label_63 + "b.com"));
+    ASSERT_FALSE(AddressValidator::isValid(local_part_64 + "@" + label_63 + "." + label_63 + "." + label_63 + "." + label_63));
+}
+
+TEST(AddressValidator_validateAddresses, WithPointers_ReturnInvalidIndices) {
+    const char *addresses[] { "a@domain.com", "invalid", nullptr, "b@domain.com", "c@" };
+    ASSERT_EQ((std::vector<size_t> { 1, 2, 4 }), AddressValidator::validateAddresses(addresses, 5));
+}
+
+TEST(AddressValidator_validateAddresses, WithStrings_ReturnInvalidIndices) {
+    const std::vector<std::string> addresses { "a@domain.com", "b@domain.com", "c d@domain.com" };
+    ASSERT_EQ((std::vector<size_t> { 2 }), AddressValidator::validateAddresses(addresses));
+}
+
+TEST(AddressValidator_validateAddresses, WithAllValid_ReturnEmpty) {
+    const std::vector<std::string> addresses { "a@domain.com", "b@domain.com" };
+    ASSERT_TRUE(AddressValidator::validateAddresses(addresses).empty());
+    ASSERT_TRUE(AddressValidator::validateAddresses(nullptr, 0).empty());
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "../../src/asyncsmtpclient.h"
+
+#ifdef SMTPCLIENT_HAS_COROUTINES
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <memory>
+#include <vector>
+#include "../../src/plaintextmessage.h"
+
+using namespace jed_utils;
+
+namespace {
+// A coroutine that starts immediately and is not awaited
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+std::shared_ptr<const Message> createMessage() {
+    return std::make_shared<PlaintextMessage>(MessageAddress("from@test.com"),
+            MessageAddress("to@test.com"),
+            "Subject",
+            "Body");
+}
+
+DetachedTask sendAndStore(AsyncSmtpClient &pClient,
+        std::shared_ptr<const Message> pMsg,
+        AsyncSmtpClient::ResumeExecutor pExecutor,
+        std::promise<int> &pResult) {
+    int return_code = co_await pClient.sendMail(std::move(pMsg), std::move(pExecutor));
+    pResult.set_value(return_code);
+}
+}  // namespace
+
+TEST(AsyncSmtpClient_sendMailCoroutine, WithUnreachableServer_ResumeWithErrorCode) {
+    AsyncSmtpClient client(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 1);
+    std::promise<int> result;
+    auto future = result.get_future();
+    sendAndStore(client, createMessage(), nullptr, result);
+    ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(30)));
+    ASSERT_NE(0, future.get());
+}
+
+TEST(AsyncSmtpClient_sendMailCoroutine, WithExecutor_ResumeThroughExecutor) {
+    AsyncSmtpClient client(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 1);
+    std::atomic<int> executor_calls { 0 };
+    std::promise<int> result;
+    auto future = result.get_future();
+    sendAndStore(client, createMessage(), [&executor_calls](std::coroutine_handle<> pHandle) {
+        executor_calls++;
+        pHandle.resume();
+    }, result);
+    ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(30)));
+    ASSERT_NE(0, future.get());
+    ASSERT_EQ(1, executor_calls.load());
+}
+
+TEST(AsyncSmtpClient_sendMailCoroutine, WithManyCoroutines_ResumeEachOnce) {
+    AsyncSmtpClient client(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 2);
+    const size_t COROUTINE_COUNT = 10;
+    std::vector<std::promise<int>> results(COROUTINE_COUNT);
+    for (auto &result : results) {
+        sendAndStore(client, createMessage(), nullptr, result);
+    }
+    for (auto &result : results) {
+        auto future = result.get_future();
+        ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(30)));
+        ASSERT_NE(0, future.get());
+    }
+}
+#endif
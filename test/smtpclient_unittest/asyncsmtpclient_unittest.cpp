@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include "../../src/asyncsmtpclient.h"
+#include "../../src/plaintextmessage.h"
+
+using namespace jed_utils;
+
+namespace {
+std::shared_ptr<const Message> createMessage() {
+    return std::make_shared<PlaintextMessage>(MessageAddress("from@test.com"),
+            MessageAddress("to@test.com"),
+            "Subject",
+            "Body");
+}
+}  // namespace
+
+TEST(AsyncSmtpClient_Constructor, WithNullServerName_ThrowInvalidArgument) {
+    try {
+        AsyncSmtpClient client(SmtpClientType::Plain, nullptr, 25);
+        FAIL();
+    }
+    catch(std::invalid_argument &err) {
+        ASSERT_STREQ("Server name cannot be null or empty", err.what());
+    }
+}
+
+TEST(AsyncSmtpClient_Constructor, NewClient_ReturnNoPendingMessages) {
+    AsyncSmtpClient client(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 2);
+    ASSERT_EQ(0, client.getPendingCount());
+}
+
+TEST(AsyncSmtpClient_sendMailAsync, WithNullMessage_ThrowInvalidArgument) {
+    AsyncSmtpClient client(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 1);
+    try {
+        client.sendMailAsync(nullptr);
+        FAIL();
+    }
+    catch(std::invalid_argument &err) {
+        ASSERT_STREQ("Message cannot be null", err.what());
+    }
+}
+
+TEST(AsyncSmtpClient_sendMailAsync, WithUnreachableServer_FutureReturnErrorCode) {
+    AsyncSmtpClient client(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 2);
+    std::future<int> result = client.sendMailAsync(createMessage());
+    ASSERT_EQ(std::future_status::ready, result.wait_for(std::chrono::seconds(30)));
+    ASSERT_NE(0, result.get());
+}
+
+TEST(AsyncSmtpClient_sendMailAsync, WithCallbackAndUnreachableServer_CallEachCallback) {
+    std::atomic<int> callback_count { 0 };
+    std::atomic<int> error_count { 0 };
+    AsyncSmtpClient client(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 2);
+    for (int index = 0; index < 5; index++) {
+        client.sendMailAsync(createMessage(), [&callback_count, &error_count](int pReturnCode) {
+                callback_count++;
+                if (pReturnCode != 0) {
+                    error_count++;
+                }
+                });
+    }
+    client.waitForIdle();
+    ASSERT_EQ(0, client.getPendingCount());
+    ASSERT_EQ(5, callback_count.load());
+    ASSERT_EQ(5, error_count.load());
+}
+
+TEST(AsyncSmtpClient_Destructor, WithQueuedMessages_SendAllBeforeStopping) {
+    std::atomic<int> callback_count { 0 };
+    {
+        AsyncSmtpClient client(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 1);
+        for (int index = 0; index < 3; index++) {
+            client.sendMailAsync(createMessage(), [&callback_count](int) { callback_count++; });
+        }
+    }
+    ASSERT_EQ(3, callback_count.load());
+}
@@ -1,13 +1,17 @@
 #include <gtest/gtest.h>
 #include "../../src/attachment.h"
 #include "../../src/cpp/attachment.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <string_view>
 
 using namespace jed_utils;
 
 template <typename T>
 class MultiAttachmentFixture : public ::testing::Test {
  public:
-    MultiAttachmentFixture<T>()
+    MultiAttachmentFixture()
         : att("test.png", "test") {
     }
     T att;
@@ -453,3 +457,99 @@ TEST(CPPAttachement, getBase64EncodedFile_NonExsitantFile_ReturnNullPTR) {
     ASSERT_EQ(att1.getBase64EncodedFile(), "");
 }
 
+
+class AttachmentStreamFixture : public ::testing::Test {
+ public:
+    void SetUp() override {
+        std::ofstream out(filename, std::ios::out | std::ios::binary);
+        for (size_t index = 0; index < content_length; index++) {
+            content += static_cast<char>(index % 251);
+        }
+        out.write(content.c_str(), static_cast<std::streamsize>(content.length()));
+    }
+
+    void TearDown() override {
+        std::remove(filename);
+    }
+
+    const char *filename = "attachment_stream_unittest.bin";
+    // More than one block of 57 * 1024 bytes and not a multiple of 3
+    const size_t content_length = 60000;
+    std::string content;
+};
+
+TYPED_TEST(MultiAttachmentFixture, streamBase64EncodedFile_NonExsitantFile_ReturnMinus1) {
+    TypeParam att1("C:\\NonExistantfile.txt", "");
+    bool writer_called = false;
+    ASSERT_EQ(-1, att1.streamBase64EncodedFile([&writer_called](const std::string &) {
+        writer_called = true;
+        return 0;
+    }));
+    ASSERT_FALSE(writer_called);
+}
+
+TYPED_TEST(MultiAttachmentFixture, streamFile_NonExsitantFile_ReturnMinus1) {
+    TypeParam att1("C:\\NonExistantfile.txt", "");
+    bool writer_called = false;
+    ASSERT_EQ(-1, att1.streamFile([&writer_called](std::string_view) {
+        writer_called = true;
+        return 0;
+    }));
+    ASSERT_FALSE(writer_called);
+}
+
+TEST_F(AttachmentStreamFixture, streamFile_ValidFile_ReturnRawContent) {
+    Attachment att1(filename, "");
+    std::string read_content;
+    ASSERT_EQ(0, att1.streamFile([&read_content](std::string_view pBlock) {
+        read_content.append(pBlock.data(), pBlock.size());
+        return 0;
+    }));
+    ASSERT_EQ(content, read_content);
+}
+
+TEST_F(AttachmentStreamFixture, streamFile_WriterReturnError_StopAndReturnError) {
+    Attachment att1(filename, "");
+    size_t block_count = 0;
+    ASSERT_EQ(-42, att1.streamFile([&block_count](std::string_view) {
+        block_count++;
+        return -42;
+    }));
+    ASSERT_EQ(1, block_count);
+}
+
+TEST_F(AttachmentStreamFixture, streamBase64EncodedFile_ValidFile_ReturnWrappedContent) {
+    Attachment att1(filename, "");
+    std::string encoded;
+    size_t block_count = 0;
+    ASSERT_EQ(0, att1.streamBase64EncodedFile([&encoded, &block_count](const std::string &pEncodedBlock) {
+        encoded += pEncodedBlock;
+        block_count++;
+        return 0;
+    }));
+    ASSERT_EQ(2, block_count);
+    std::string unwrapped;
+    size_t line_start = 0;
+    size_t line_end = 0;
+    while ((line_end = encoded.find("\r\n", line_start)) != std::string::npos) {
+        ASSERT_EQ(76, line_end - line_start);
+        unwrapped += encoded.substr(line_start, line_end - line_start);
+        line_start = line_end + 2;
+    }
+    ASSERT_LE(encoded.length() - line_start, 76);
+    unwrapped += encoded.substr(line_start);
+    ASSERT_EQ(content, Base64::Decode(unwrapped));
+    const char *whole_file = att1.getBase64EncodedFile();
+    ASSERT_EQ(std::string(whole_file), unwrapped);
+    delete[] whole_file;
+}
+
+TEST_F(AttachmentStreamFixture, streamBase64EncodedFile_WriterReturnError_StopAndReturnError) {
+    Attachment att1(filename, "");
+    size_t block_count = 0;
+    ASSERT_EQ(-42, att1.streamBase64EncodedFile([&block_count](const std::string &) {
+        block_count++;
+        return -42;
+    }));
+    ASSERT_EQ(1, block_count);
+}
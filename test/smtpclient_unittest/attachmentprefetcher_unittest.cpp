@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../../src/attachmentprefetcher.h"
+
+using namespace jed_utils;
+
+namespace {
+AttachmentPrefetcher::Producer createProducer(std::vector<std::string> pBlocks, int pReturnCode = 0) {
+    return [pBlocks, pReturnCode](const AttachmentBlockWriter &pWriter) {
+        for (const auto &block : pBlocks) {
+            int ret_code = pWriter(block);
+            if (ret_code != 0) {
+                return ret_code;
+            }
+        }
+        return pReturnCode;
+    };
+}
+
+std::vector<std::string> readAttachment(AttachmentPrefetcher &pPrefetcher, int &pReturnCode) {
+    std::vector<std::string> blocks;
+    std::string block;
+    while (pPrefetcher.nextBlock(block, pReturnCode)) {
+        blocks.push_back(block);
+    }
+    return blocks;
+}
+}  // namespace
+
+TEST(AttachmentPrefetcher_nextBlock, WithSeveralProducers_ReturnBlocksInOrder) {
+    AttachmentPrefetcher prefetcher({ createProducer({ "a1", "a2" }), createProducer({}), createProducer({ "c1" }) }, 1);
+    int ret_code = 1;
+    ASSERT_EQ((std::vector<std::string> { "a1", "a2" }), readAttachment(prefetcher, ret_code));
+    ASSERT_EQ(0, ret_code);
+    ret_code = 1;
+    ASSERT_TRUE(readAttachment(prefetcher, ret_code).empty());
+    ASSERT_EQ(0, ret_code);
+    ret_code = 1;
+    ASSERT_EQ((std::vector<std::string> { "c1" }), readAttachment(prefetcher, ret_code));
+    ASSERT_EQ(0, ret_code);
+}
+
+TEST(AttachmentPrefetcher_nextBlock, WithFailingProducer_ReturnBlocksThenErrorCode) {
+    AttachmentPrefetcher prefetcher({ createProducer({ "a1" }, -1), createProducer({ "b1" }) }, 4);
+    int ret_code = 0;
+    ASSERT_EQ((std::vector<std::string> { "a1" }), readAttachment(prefetcher, ret_code));
+    ASSERT_EQ(-1, ret_code);
+    ASSERT_EQ((std::vector<std::string> { "b1" }), readAttachment(prefetcher, ret_code));
+    ASSERT_EQ(0, ret_code);
+}
+
+TEST(AttachmentPrefetcher_nextBlock, WithThrowingProducer_ReturnMinus1) {
+    AttachmentPrefetcher prefetcher({ [](const AttachmentBlockWriter &) -> int {
+        throw std::runtime_error("unreadable");
+    } }, 4);
+    int ret_code = 0;
+    ASSERT_TRUE(readAttachment(prefetcher, ret_code).empty());
+    ASSERT_EQ(-1, ret_code);
+}
+
+TEST(AttachmentPrefetcher_nextBlock, WithSlowReader_BlocksInAdvanceAreBounded) {
+    std::atomic<size_t> written_count { 0 };
+    AttachmentPrefetcher prefetcher({ [&written_count](const AttachmentBlockWriter &pWriter) {
+        for (int index = 0; index < 10; index++) {
+            if (pWriter(std::to_string(index)) != 0) {
+                return -1;
+            }
+            written_count++;
+        }
+        return 0;
+    } }, 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    // The third block waits for the reader
+    ASSERT_EQ(2U, written_count.load());
+    std::string block;
+    int ret_code = 1;
+    ASSERT_TRUE(prefetcher.nextBlock(block, ret_code));
+    ASSERT_EQ("0", block);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(3U, written_count.load());
+}
+
+TEST(AttachmentPrefetcher_Destructor, WithBlockedProducer_StopProducer) {
+    std::atomic<int> producer_ret_code { 1 };
+    {
+        AttachmentPrefetcher prefetcher({ [&producer_ret_code](const AttachmentBlockWriter &pWriter) {
+            int ret_code = 0;
+            while (ret_code == 0) {
+                ret_code = pWriter("block");
+            }
+            producer_ret_code = ret_code;
+            return ret_code;
+        } }, 1);
+        std::string block;
+        int ret_code = 0;
+        ASSERT_TRUE(prefetcher.nextBlock(block, ret_code));
+    }
+    ASSERT_NE(0, producer_ret_code.load());
+}
@@ -0,0 +1,252 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../../src/attachment.h"
+#include "../../src/attachmentsource.h"
+#include "../../src/base64.h"
+#include "../../src/cpp/attachment.hpp"
+
+using namespace jed_utils;
+
+namespace {
+std::string readAll(const AttachmentSource &pSource) {
+    std::string retval;
+    pSource.read([&retval](std::string_view pBlock) {
+        retval.append(pBlock.data(), pBlock.size());
+        return 0;
+    });
+    return retval;
+}
+
+std::string createContent(size_t pLength) {
+    std::string retval;
+    for (size_t index = 0; index < pLength; index++) {
+        retval += static_cast<char>(index % 251);
+    }
+    return retval;
+}
+
+// Give the content by blocks of a few bytes, restarting after the end
+AttachmentReadCallback createCallback(std::shared_ptr<const std::string> pContent, size_t pBlockLength) {
+    auto position = std::make_shared<size_t>(0);
+    return [pContent, pBlockLength, position](char *pBuffer, size_t pBufferSize, size_t &pBytesRead) {
+        pBytesRead = (std::min)({ pBlockLength, pBufferSize, pContent->size() - *position });
+        memcpy(pBuffer, pContent->data() + *position, pBytesRead);
+        *position = pBytesRead == 0 ? 0 : *position + pBytesRead;
+        return 0;
+    };
+}
+}  // namespace
+
+TEST(BufferAttachmentSource_read, WithContent_ReturnContentInOneBlock) {
+    BufferAttachmentSource source("Hello");
+    size_t block_count = 0;
+    ASSERT_EQ(0, source.read([&block_count](std::string_view pBlock) {
+        block_count++;
+        return pBlock == "Hello" ? 0 : -2;
+    }));
+    ASSERT_EQ(1, block_count);
+    ASSERT_EQ(5, source.getSize().value());
+}
+
+TEST(BufferAttachmentSource_read, EmptyContent_WriterNotCalled) {
+    BufferAttachmentSource source("");
+    ASSERT_EQ(0, source.read([](std::string_view) { return -2; }));
+    ASSERT_EQ(0, source.getSize().value());
+}
+
+TEST(ViewAttachmentSource_read, WithContent_ReturnViewOfData) {
+    const std::string data { "Hello" };
+    ViewAttachmentSource source(data);
+    const char *block_data = nullptr;
+    ASSERT_EQ(0, source.read([&block_data](std::string_view pBlock) {
+        block_data = pBlock.data();
+        return 0;
+    }));
+    ASSERT_EQ(data.data(), block_data);
+    ASSERT_EQ(5, source.getSize().value());
+}
+
+TEST(FileAttachmentSource_read, MissingFile_ReturnMinus1) {
+    FileAttachmentSource source("attachmentsource_unittest_missing.bin");
+    ASSERT_EQ(-1, source.read([](std::string_view) { return 0; }));
+    ASSERT_FALSE(source.getSize().has_value());
+}
+
+TEST(FileAttachmentSource_read, ValidFile_ReturnContentAndSize) {
+    const char *filename = "attachmentsource_unittest.bin";
+    const std::string content { createContent(100000) };
+    std::ofstream(filename, std::ios::binary) << content;
+    FileAttachmentSource source(filename);
+    ASSERT_EQ(content, readAll(source));
+    ASSERT_EQ(content.size(), source.getSize().value());
+    std::remove(filename);
+}
+
+TEST(FileAttachmentSource_read, MemoryMapped_ReturnWholeFileInOneBlock) {
+    const char *filename = "attachmentsource_unittest_mapped.bin";
+    const std::string content { createContent(200000) };
+    std::ofstream(filename, std::ios::binary) << content;
+    size_t block_count = 0;
+    std::string mapped_content;
+    ASSERT_EQ(0, FileAttachmentSource(filename).read([&block_count, &mapped_content](std::string_view pBlock) {
+        block_count++;
+        mapped_content.append(pBlock.data(), pBlock.size());
+        return 0;
+    }));
+    ASSERT_EQ(1, block_count);
+    ASSERT_EQ(content, mapped_content);
+    ASSERT_EQ(content, readAll(FileAttachmentSource(filename, false)));
+    std::remove(filename);
+}
+
+TEST(FileAttachmentSource_read, EmptyFile_WriterNotCalled) {
+    const char *filename = "attachmentsource_unittest_empty.bin";
+    std::ofstream(filename, std::ios::binary).close();
+    ASSERT_EQ(0, FileAttachmentSource(filename).read([](std::string_view) { return -2; }));
+    ASSERT_EQ(0, FileAttachmentSource(filename).getSize().value());
+    std::remove(filename);
+}
+
+TEST(FileAttachmentSource_read, WriterReturnError_ReturnError) {
+    const char *filename = "attachmentsource_unittest_error.bin";
+    std::ofstream(filename, std::ios::binary) << "Hello";
+    ASSERT_EQ(-42, FileAttachmentSource(filename).read([](std::string_view) { return -42; }));
+    std::remove(filename);
+}
+
+TEST(FileAttachmentSource_read, SeveralThreads_ReturnSameEncoding) {
+    const char *filename = "attachmentsource_unittest_threads.bin";
+    std::ofstream(filename, std::ios::binary) << createContent(300000);
+    const Attachment attachment(filename, "file.bin");
+    std::string encoded[4];
+    std::vector<std::thread> threads;
+    for (auto &thread_encoded : encoded) {
+        threads.emplace_back([&attachment, &thread_encoded]() {
+            attachment.streamBase64EncodedFile([&thread_encoded](const std::string &pEncodedBlock) {
+                thread_encoded += pEncodedBlock;
+                return 0;
+            });
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    ASSERT_FALSE(encoded[0].empty());
+    for (const auto &thread_encoded : encoded) {
+        ASSERT_EQ(encoded[0], thread_encoded);
+    }
+    std::remove(filename);
+}
+
+TEST(CallbackAttachmentSource_read, SmallBlocks_ReturnContentTwice) {
+    auto content = std::make_shared<const std::string>(createContent(1000));
+    CallbackAttachmentSource source(createCallback(content, 7));
+    ASSERT_EQ(*content, readAll(source));
+    ASSERT_EQ(*content, readAll(source));
+    ASSERT_FALSE(source.getSize().has_value());
+}
+
+TEST(CallbackAttachmentSource_read, CallbackError_ReturnMinus1) {
+    CallbackAttachmentSource source([](char *, size_t, size_t &pBytesRead) {
+        pBytesRead = 0;
+        return 5;
+    }, 10);
+    ASSERT_EQ(-1, source.read([](std::string_view) { return 0; }));
+    ASSERT_EQ(10, source.getSize().value());
+}
+
+TEST(CallbackAttachmentSource_read, WriterReturnError_StopAndReturnError) {
+    auto content = std::make_shared<const std::string>(createContent(1000));
+    CallbackAttachmentSource source(createCallback(content, 7));
+    size_t block_count = 0;
+    ASSERT_EQ(-42, source.read([&block_count](std::string_view) {
+        block_count++;
+        return -42;
+    }));
+    ASSERT_EQ(1, block_count);
+}
+
+TEST(Attachment_Constructor, WithNullSource_ThrowInvalidArgument) {
+    ASSERT_THROW(Attachment(std::shared_ptr<const AttachmentSource>(), "report.csv"), std::invalid_argument);
+}
+
+TEST(Attachment_Constructor, WithSourceAndEmptyName_ThrowInvalidArgument) {
+    ASSERT_THROW(Attachment(std::make_shared<BufferAttachmentSource>("a"), " "), std::invalid_argument);
+}
+
+TEST(Attachment_Constructor, WithSource_ReturnNameAndMimeType) {
+    Attachment attachment(std::make_shared<BufferAttachmentSource>("a,b"), "report.csv");
+    ASSERT_STREQ("report.csv", attachment.getName());
+    ASSERT_STREQ("report.csv", attachment.getFilename());
+    ASSERT_STREQ("text/csv", attachment.getMimeType());
+    ASSERT_EQ(3, attachment.getSize().value());
+}
+
+TEST(Attachment_streamBase64EncodedFile, AllSources_ReturnSameEncoding) {
+    // More than two blocks of 57 * 1024 bytes and not a multiple of 3
+    const std::string content { createContent(57 * 1024 * 2 + 1001) };
+    const char *filename = "attachmentsource_unittest_encoding.bin";
+    std::ofstream(filename, std::ios::binary) << content;
+    auto shared_content = std::make_shared<const std::string>(content);
+    const Attachment attachments[] {
+        Attachment(filename, "file.bin"),
+        Attachment(std::make_shared<BufferAttachmentSource>(content), "file.bin"),
+        Attachment(std::make_shared<ViewAttachmentSource>(content), "file.bin"),
+        Attachment(std::make_shared<CallbackAttachmentSource>(createCallback(shared_content, 1000)), "file.bin"),
+        Attachment(std::make_shared<CallbackAttachmentSource>(createCallback(shared_content, 57 * 1024)), "file.bin")
+    };
+    std::string expected;
+    for (const auto &attachment : attachments) {
+        std::string encoded;
+        size_t block_count = 0;
+        ASSERT_EQ(0, attachment.streamBase64EncodedFile([&encoded, &block_count](const std::string &pEncodedBlock) {
+            encoded += pEncodedBlock;
+            block_count++;
+            return 0;
+        }));
+        ASSERT_EQ(3, block_count);
+        if (expected.empty()) {
+            expected = encoded;
+        }
+        ASSERT_EQ(expected, encoded);
+    }
+    std::string unwrapped { expected };
+    size_t position;
+    while ((position = unwrapped.find("\r\n")) != std::string::npos) {
+        unwrapped.erase(position, 2);
+    }
+    ASSERT_EQ(content, Base64::Decode(unwrapped));
+    std::remove(filename);
+}
+
+TEST(Attachment_getBase64EncodedFile, WithBufferSource_ReturnEncodedContent) {
+    Attachment attachment(std::make_shared<BufferAttachmentSource>("Hello"), "hello.txt");
+    const char *encoded = attachment.getBase64EncodedFile();
+    ASSERT_STREQ("SGVsbG8=", encoded);
+    delete[] encoded;
+}
+
+TEST(Attachment_CopyConstructor, WithSource_ShareSource) {
+    Attachment attachment1(std::make_shared<BufferAttachmentSource>("Hello"), "hello.txt");
+    Attachment attachment2(attachment1);
+    std::string content;
+    ASSERT_EQ(0, attachment2.streamFile([&content](std::string_view pBlock) {
+        content.append(pBlock.data(), pBlock.size());
+        return 0;
+    }));
+    ASSERT_EQ("Hello", content);
+}
+
+TEST(Attachment_cppToStdAttachment, WithSource_KeepSource) {
+    cpp::Attachment attachment(std::make_shared<BufferAttachmentSource>("Hello"), "hello.txt");
+    const char *encoded = attachment.toStdAttachment().getBase64EncodedFile();
+    ASSERT_STREQ("SGVsbG8=", encoded);
+    delete[] encoded;
+}
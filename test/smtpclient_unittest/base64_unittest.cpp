@@ -0,0 +1,117 @@
+#include "../../src/base64.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace jed_utils;
+
+namespace {
+// Straightforward encoding used as a reference for the optimized paths
+std::string referenceEncode(const std::vector<unsigned char> &pBytes) {
+    static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string ret;
+    size_t index = 0;
+    for (; index + 3 <= pBytes.size(); index += 3) {
+        ret += chars[pBytes[index] >> 2];
+        ret += chars[((pBytes[index] & 0x03) << 4) | (pBytes[index + 1] >> 4)];
+        ret += chars[((pBytes[index + 1] & 0x0F) << 2) | (pBytes[index + 2] >> 6)];
+        ret += chars[pBytes[index + 2] & 0x3F];
+    }
+    size_t remaining = pBytes.size() - index;
+    if (remaining == 1) {
+        ret += chars[pBytes[index] >> 2];
+        ret += chars[(pBytes[index] & 0x03) << 4];
+        ret += "==";
+    } else if (remaining == 2) {
+        ret += chars[pBytes[index] >> 2];
+        ret += chars[((pBytes[index] & 0x03) << 4) | (pBytes[index + 1] >> 4)];
+        ret += chars[(pBytes[index + 1] & 0x0F) << 2];
+        ret += '=';
+    }
+    return ret;
+}
+
+std::vector<unsigned char> randomBytes(size_t pLength, std::mt19937 &pGenerator) {
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::vector<unsigned char> ret(pLength);
+    for (auto &byte : ret) {
+        byte = static_cast<unsigned char>(distribution(pGenerator));
+    }
+    return ret;
+}
+
+std::string encode(const std::string &pText) {
+    return Base64::Encode(reinterpret_cast<const unsigned char *>(pText.c_str()), pText.length());
+}
+}  // namespace
+
+TEST(Base64, Encode_WithRFC4648Vectors_ReturnExpected) {
+    ASSERT_EQ("", encode(""));
+    ASSERT_EQ("Zg==", encode("f"));
+    ASSERT_EQ("Zm8=", encode("fo"));
+    ASSERT_EQ("Zm9v", encode("foo"));
+    ASSERT_EQ("Zm9vYg==", encode("foob"));
+    ASSERT_EQ("Zm9vYmE=", encode("fooba"));
+    ASSERT_EQ("Zm9vYmFy", encode("foobar"));
+}
+
+TEST(Base64, Decode_WithRFC4648Vectors_ReturnExpected) {
+    ASSERT_EQ("", Base64::Decode(""));
+    ASSERT_EQ("f", Base64::Decode("Zg=="));
+    ASSERT_EQ("fo", Base64::Decode("Zm8="));
+    ASSERT_EQ("foo", Base64::Decode("Zm9v"));
+    ASSERT_EQ("foob", Base64::Decode("Zm9vYg=="));
+    ASSERT_EQ("fooba", Base64::Decode("Zm9vYmE="));
+    ASSERT_EQ("foobar", Base64::Decode("Zm9vYmFy"));
+}
+
+TEST(Base64, Encode_WithRandomInputs_ReturnSameAsReference) {
+    std::mt19937 generator(1234);
+    for (size_t length = 0; length <= 300; length++) {
+        auto bytes = randomBytes(length, generator);
+        std::string encoded = Base64::Encode(bytes.data(), bytes.size());
+        ASSERT_EQ(referenceEncode(bytes), encoded) << "length " << length;
+        std::string decoded = Base64::Decode(encoded);
+        ASSERT_EQ(std::string(bytes.begin(), bytes.end()), decoded) << "length " << length;
+    }
+}
+
+TEST(Base64, Encode_WithVectorBoundaryLengths_ReturnSameAsReference) {
+    std::mt19937 generator(42);
+    for (size_t length : { 12, 15, 16, 17, 27, 28, 29, 57 }) {
+        auto bytes = randomBytes(length, generator);
+        ASSERT_EQ(referenceEncode(bytes), Base64::Encode(bytes.data(), bytes.size())) << "length " << length;
+    }
+}
+
+TEST(Base64, EncodeToBuffer_WithInput_ReturnEncodedLengthAndDoNotWritePastIt) {
+    const std::string text { "Hello World!!" };
+    std::string buffer(Base64::EncodedLength(text.length()) + 1, '#');
+    size_t written = Base64::EncodeToBuffer(reinterpret_cast<const unsigned char *>(text.c_str()),
+            text.length(), &buffer[0]);
+    ASSERT_EQ(20, written);
+    ASSERT_EQ(Base64::EncodedLength(text.length()), written);
+    ASSERT_EQ("SGVsbG8gV29ybGQhIQ==#", buffer);
+}
+
+TEST(Base64, DecodeToBuffer_WithPadding_ReturnDecodedLength) {
+    const std::string encoded { "Zm9vYg==" };
+    std::vector<unsigned char> buffer(Base64::DecodedMaxLength(encoded.length()));
+    ASSERT_EQ(6, buffer.size());
+    ASSERT_EQ(4, Base64::DecodeToBuffer(encoded.c_str(), encoded.length(), buffer.data()));
+    ASSERT_EQ("foob", std::string(buffer.begin(), buffer.begin() + 4));
+}
+
+TEST(Base64, Decode_WithInvalidCharacter_StopAtIt) {
+    ASSERT_EQ("foo", Base64::Decode("Zm9v*YmFy"));
+}
+
+TEST(Base64, Decode_WithDataAfterPadding_StopAtPadding) {
+    ASSERT_EQ("f", Base64::Decode("Zg==Zm9v"));
+}
+
+TEST(Base64, Decode_WithoutPadding_ReturnPartialGroup) {
+    ASSERT_EQ("fo", Base64::Decode("Zm8"));
+    ASSERT_EQ("f", Base64::Decode("Zg"));
+}
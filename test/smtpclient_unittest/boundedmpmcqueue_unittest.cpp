@@ -0,0 +1,87 @@
+#include "../../src/boundedmpmcqueue.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace jed_utils;
+
+TEST(BoundedMpmcQueue_Constructor, ZeroCapacity_ReturnCapacityOfOne) {
+    BoundedMpmcQueue<int> queue(0);
+    ASSERT_EQ(1, queue.getCapacity());
+}
+
+TEST(BoundedMpmcQueue_tryPush, FullQueue_ReturnFalse) {
+    BoundedMpmcQueue<int> queue(3);
+    ASSERT_TRUE(queue.tryPush(1));
+    ASSERT_TRUE(queue.tryPush(2));
+    ASSERT_TRUE(queue.tryPush(3));
+    ASSERT_FALSE(queue.tryPush(4));
+}
+
+TEST(BoundedMpmcQueue_tryPop, EmptyQueue_ReturnFalse) {
+    BoundedMpmcQueue<int> queue(3);
+    int value = 0;
+    ASSERT_FALSE(queue.tryPop(value));
+}
+
+TEST(BoundedMpmcQueue_tryPop, SeveralTurns_ReturnItemsInOrder) {
+    BoundedMpmcQueue<int> queue(3);
+    int value = 0;
+    for (int turn = 0; turn < 5; turn++) {
+        ASSERT_TRUE(queue.tryPush(turn * 2));
+        ASSERT_TRUE(queue.tryPush(turn * 2 + 1));
+        ASSERT_TRUE(queue.tryPop(value));
+        ASSERT_EQ(turn * 2, value);
+        ASSERT_TRUE(queue.tryPop(value));
+        ASSERT_EQ(turn * 2 + 1, value);
+    }
+    ASSERT_FALSE(queue.tryPop(value));
+}
+
+TEST(BoundedMpmcQueue_tryPop, MoveOnlyItems_ReleaseTheCell) {
+    BoundedMpmcQueue<std::shared_ptr<int>> queue(1);
+    auto item = std::make_shared<int>(5);
+    ASSERT_TRUE(queue.tryPush(std::shared_ptr<int>(item)));
+    ASSERT_EQ(2, item.use_count());
+    std::shared_ptr<int> value;
+    ASSERT_TRUE(queue.tryPop(value));
+    value.reset();
+    ASSERT_EQ(1, item.use_count());
+}
+
+TEST(BoundedMpmcQueue_tryPop, ConcurrentProducersAndConsumers_ReturnEachItemOnce) {
+    const int PRODUCER_COUNT = 4;
+    const int ITEMS_PER_PRODUCER = 20000;
+    BoundedMpmcQueue<int> queue(64);
+    std::atomic<long long> sum { 0 };
+    std::atomic<int> consumed { 0 };
+    std::vector<std::thread> threads;
+    for (int producer = 0; producer < PRODUCER_COUNT; producer++) {
+        threads.emplace_back([&queue]() {
+                for (int item = 1; item <= ITEMS_PER_PRODUCER; item++) {
+                    while (!queue.tryPush(int(item))) {
+                        std::this_thread::yield();
+                    }
+                }
+                });
+        threads.emplace_back([&queue, &sum, &consumed]() {
+                int value = 0;
+                while (consumed.load() < PRODUCER_COUNT * ITEMS_PER_PRODUCER) {
+                    if (queue.tryPop(value)) {
+                        sum += value;
+                        consumed++;
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+                });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    const long long expected_sum = static_cast<long long>(PRODUCER_COUNT) * ITEMS_PER_PRODUCER * (ITEMS_PER_PRODUCER + 1) / 2;
+    ASSERT_EQ(PRODUCER_COUNT * ITEMS_PER_PRODUCER, consumed.load());
+    ASSERT_EQ(expected_sum, sum.load());
+}
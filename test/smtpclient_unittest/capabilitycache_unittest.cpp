@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "../../src/capabilitycache.h"
+
+using namespace jed_utils;
+
+namespace {
+const char *EHLO_RESPONSE = "250-smtp.example.com Hello [192.0.2.1]\r\n"
+                            "250-PIPELINING\r\n"
+                            "250 CHUNKING\r\n";
+
+ServerCapabilities createCapabilities() {
+    ServerCapabilities capabilities;
+    capabilities.Pipelining = true;
+    capabilities.Chunking = true;
+    return capabilities;
+}
+}  // namespace
+
+TEST(CapabilityCache_Constructor, NewCache_ReturnNoEntries) {
+    CapabilityCache cache;
+    ServerCapabilities capabilities;
+    ASSERT_EQ(0U, cache.getEntryCount());
+    ASSERT_FALSE(cache.find("smtp.example.com", 587, false, capabilities));
+}
+
+TEST(CapabilityCache_find, WithSameResponse_ReturnCachedCapabilities) {
+    CapabilityCache cache;
+    ServerCapabilities capabilities;
+    ASSERT_FALSE(cache.find("smtp.example.com", 587, false, EHLO_RESPONSE, capabilities));
+    cache.insert("smtp.example.com", 587, false, EHLO_RESPONSE, createCapabilities());
+    ASSERT_TRUE(cache.find("SMTP.example.com", 587, false, EHLO_RESPONSE, capabilities));
+    ASSERT_TRUE(capabilities.Pipelining);
+    ASSERT_TRUE(capabilities.Chunking);
+    ASSERT_EQ(1U, cache.getHitCount());
+    ASSERT_EQ(1U, cache.getMissCount());
+}
+
+TEST(CapabilityCache_find, WithOtherGreetingLine_ReturnCachedCapabilities) {
+    CapabilityCache cache;
+    cache.insert("smtp.example.com", 587, false, EHLO_RESPONSE, createCapabilities());
+    ServerCapabilities capabilities;
+    ASSERT_TRUE(cache.find("smtp.example.com", 587, false,
+                "250-smtp.example.com Hello [192.0.2.2]\r\n"
+                "250-PIPELINING\r\n"
+                "250 CHUNKING\r\n", capabilities));
+}
+
+TEST(CapabilityCache_find, WithChangedExtensions_ReturnFalse) {
+    CapabilityCache cache;
+    cache.insert("smtp.example.com", 587, false, EHLO_RESPONSE, createCapabilities());
+    ServerCapabilities capabilities;
+    ASSERT_FALSE(cache.find("smtp.example.com", 587, false,
+                "250-smtp.example.com Hello [192.0.2.1]\r\n"
+                "250 PIPELINING\r\n", capabilities));
+}
+
+TEST(CapabilityCache_find, WithOtherEndpoint_ReturnFalse) {
+    CapabilityCache cache;
+    cache.insert("smtp.example.com", 587, false, EHLO_RESPONSE, createCapabilities());
+    ServerCapabilities capabilities;
+    ASSERT_FALSE(cache.find("smtp.example.com", 25, false, EHLO_RESPONSE, capabilities));
+    ASSERT_FALSE(cache.find("smtp.example.org", 587, false, EHLO_RESPONSE, capabilities));
+    // The capabilities received over TLS are kept apart
+    ASSERT_FALSE(cache.find("smtp.example.com", 587, true, capabilities));
+    ASSERT_TRUE(cache.find("smtp.example.com", 587, false, capabilities));
+}
+
+TEST(CapabilityCache_clear, WithEntries_RemoveEntries) {
+    CapabilityCache cache;
+    cache.insert("smtp.example.com", 587, false, EHLO_RESPONSE, createCapabilities());
+    cache.insert("smtp.example.com", 587, true, EHLO_RESPONSE, createCapabilities());
+    ASSERT_EQ(2U, cache.getEntryCount());
+    cache.clear();
+    ASSERT_EQ(0U, cache.getEntryCount());
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../../src/communicationlog.h"
+
+using namespace jed_utils;
+
+TEST(CommunicationLog_Constructor, NewLog_ReturnEmptyFullLog) {
+    CommunicationLog log;
+    ASSERT_EQ("", std::string(log.getContent()));
+    ASSERT_EQ(CommunicationLogLevel::Full, log.getLevel());
+    ASSERT_EQ(CommunicationLog::DEFAULT_CAPACITY, log.getCapacity());
+}
+
+TEST(CommunicationLog_add, ClientItem_ReturnPrefixedItemWithEscapedCRLF) {
+    CommunicationLog log;
+    log.add(CommunicationLogLevel::Commands, "c", { "EHLO localhost\r\n" });
+    ASSERT_EQ("\nc: EHLO localhost\\r\\n", std::string(log.getContent()));
+}
+
+TEST(CommunicationLog_add, ServerItem_ReturnItemUnchanged) {
+    CommunicationLog log;
+    log.add(CommunicationLogLevel::Commands, "s", { "250-a\r\n250 b\r\n" });
+    ASSERT_EQ("\ns: 250-a\r\n250 b\r\n", std::string(log.getContent()));
+}
+
+TEST(CommunicationLog_add, SeveralParts_ReturnSingleItem) {
+    CommunicationLog log;
+    log.add(CommunicationLogLevel::Full, "c", { "Header\r\n", "Body", "\r\n" });
+    ASSERT_EQ("\nc: Header\\r\\nBody\\r\\n", std::string(log.getContent()));
+}
+
+TEST(CommunicationLog_add, ContentWithCommandsLevel_ReturnOnlyCommands) {
+    CommunicationLog log;
+    log.setLevel(CommunicationLogLevel::Commands);
+    log.add(CommunicationLogLevel::Commands, "c", { "DATA" });
+    log.add(CommunicationLogLevel::Full, "c", { "Body" });
+    ASSERT_EQ("\nc: DATA", std::string(log.getContent()));
+}
+
+TEST(CommunicationLog_add, WithNoneLevel_ReturnEmpty) {
+    CommunicationLog log;
+    log.setLevel(CommunicationLogLevel::None);
+    log.add(CommunicationLogLevel::Commands, "c", { "DATA" });
+    ASSERT_EQ("", std::string(log.getContent()));
+    ASSERT_FALSE(log.isEnabled(CommunicationLogLevel::Commands));
+}
+
+TEST(CommunicationLog_add, BeyondCapacity_ReturnNewestCompleteLines) {
+    CommunicationLog log(32);
+    log.add(CommunicationLogLevel::Commands, "c", { "first item" });
+    log.add(CommunicationLogLevel::Commands, "c", { "second item" });
+    log.add(CommunicationLogLevel::Commands, "c", { "third item" });
+    ASSERT_EQ("\nc: second item\nc: third item", std::string(log.getContent()));
+}
+
+TEST(CommunicationLog_add, WrappedContent_ReturnItemsInOrder) {
+    CommunicationLog log(40);
+    for (int index = 0; index < 10; index++) {
+        log.add(CommunicationLogLevel::Commands, "c", { "item " + std::to_string(index) });
+    }
+    ASSERT_EQ("\nc: item 6\nc: item 7\nc: item 8\nc: item 9", std::string(log.getContent()));
+    log.add(CommunicationLogLevel::Commands, "c", { "item 10" });
+    ASSERT_EQ("\nc: item 8\nc: item 9\nc: item 10", std::string(log.getContent()));
+}
+
+TEST(CommunicationLog_getContentView, WrappedContent_ReturnSameAsContent) {
+    CommunicationLog log(40);
+    ASSERT_TRUE(log.getContentView().empty());
+    for (int index = 0; index < 10; index++) {
+        log.add(CommunicationLogLevel::Commands, "c", { "item " + std::to_string(index) });
+    }
+    ASSERT_EQ("\nc: item 6\nc: item 7\nc: item 8\nc: item 9", log.getContentView());
+    ASSERT_EQ(log.getContent(), log.getContentView().data());
+}
+
+TEST(CommunicationLog_add, ItemLargerThanCapacity_ReturnEmpty) {
+    CommunicationLog log(16);
+    log.add(CommunicationLogLevel::Commands, "c", { std::string(100, 'x') });
+    ASSERT_EQ("", std::string(log.getContent()));
+}
+
+TEST(CommunicationLog_add, WithSink_SinkReceiveEachPart) {
+    CommunicationLog log;
+    std::vector<std::pair<std::string, std::string>> items;
+    log.setSink([&items](const char *pPrefix, std::string_view pItem) {
+            items.emplace_back(pPrefix, std::string(pItem));
+            });
+    log.add(CommunicationLogLevel::Commands, "s", { "250 OK\r\n" });
+    log.add(CommunicationLogLevel::Full, "c", { "Header\r\n", "Body" });
+    ASSERT_EQ(3, items.size());
+    ASSERT_EQ("s", items[0].first);
+    ASSERT_EQ("250 OK\r\n", items[0].second);
+    ASSERT_EQ("Header\r\n", items[1].second);
+    ASSERT_EQ("Body", items[2].second);
+}
+
+TEST(CommunicationLog_add, WithSinkAndZeroCapacity_OnlySinkReceiveItems) {
+    CommunicationLog log(0);
+    int item_count = 0;
+    log.setSink([&item_count](const char *, std::string_view) { item_count++; });
+    ASSERT_TRUE(log.isEnabled(CommunicationLogLevel::Full));
+    log.add(CommunicationLogLevel::Commands, "c", { "QUIT" });
+    ASSERT_EQ(1, item_count);
+    ASSERT_EQ("", std::string(log.getContent()));
+}
+
+TEST(CommunicationLog_isEnabled, WithZeroCapacityAndNoSink_ReturnFalse) {
+    CommunicationLog log(0);
+    ASSERT_FALSE(log.isEnabled(CommunicationLogLevel::Commands));
+}
+
+TEST(CommunicationLog_setCapacity, WithContent_ReturnEmpty) {
+    CommunicationLog log;
+    log.add(CommunicationLogLevel::Commands, "c", { "NOOP" });
+    log.setCapacity(128);
+    ASSERT_EQ(128, log.getCapacity());
+    ASSERT_EQ("", std::string(log.getContent()));
+    log.add(CommunicationLogLevel::Commands, "c", { "NOOP" });
+    ASSERT_EQ("\nc: NOOP", std::string(log.getContent()));
+}
+
+TEST(CommunicationLog_clear, WithContent_ReturnEmpty) {
+    CommunicationLog log;
+    log.add(CommunicationLogLevel::Commands, "c", { "NOOP" });
+    log.clear();
+    ASSERT_EQ("", std::string(log.getContent()));
+}
+
+TEST(CommunicationLog_Copy, WithContent_ReturnSameContent) {
+    CommunicationLog log(32);
+    log.add(CommunicationLogLevel::Commands, "c", { "first item" });
+    log.add(CommunicationLogLevel::Commands, "c", { "second item" });
+    CommunicationLog copy(log);
+    ASSERT_EQ(std::string(log.getContent()), std::string(copy.getContent()));
+}
+
+TEST(CommunicationLog_Move, WithContent_ReturnContentAndEmptySource) {
+    CommunicationLog log;
+    log.add(CommunicationLogLevel::Commands, "c", { "NOOP" });
+    CommunicationLog moved(std::move(log));
+    ASSERT_EQ("\nc: NOOP", std::string(moved.getContent()));
+    ASSERT_EQ("", std::string(log.getContent()));
+    log.add(CommunicationLogLevel::Commands, "c", { "QUIT" });
+    ASSERT_EQ("\nc: QUIT", std::string(log.getContent()));
+}
@@ -1,6 +1,7 @@
 #include "../../src/credential.h"
 #include "../../src/cpp/credential.hpp"
 #include <gtest/gtest.h>
+#include <memory>
 #include <string>
 
 using namespace jed_utils;
@@ -8,7 +9,7 @@ using namespace jed_utils;
 template <typename T>
 class MultiCredentialFixture : public ::testing::Test {
  public:
-    MultiCredentialFixture<T>()
+    MultiCredentialFixture()
         : att("test", "123") {
     }
     T att;
@@ -187,3 +188,27 @@ TYPED_TEST(MultiCredentialFixture, setPassword_ValidOnlySpacesPassword) {
     cred.setPassword("   ");
     ASSERT_EQ("   ", std::string(cred.getPassword()));
 }
+
+TYPED_TEST(MultiCredentialFixture, Constructor_WithTokenSource_ReturnTokenSourceAndEmptyPassword) {
+    auto token_source = std::make_shared<OAuth2TokenSource>(nullptr);
+    TypeParam cred("Test", token_source);
+    ASSERT_EQ(token_source, cred.getTokenSource());
+    ASSERT_EQ("", std::string(cred.getPassword()));
+    TypeParam copy(cred);
+    ASSERT_EQ(token_source, copy.getTokenSource());
+}
+
+TEST(Credential, Constructor_WithNullTokenSource_ThrowInvalidArgument) {
+    try {
+        Credential cred("Test", std::shared_ptr<OAuth2TokenSource>());
+        FAIL();
+    }
+    catch(std::invalid_argument &err) {
+        ASSERT_STREQ("Token source cannot be null", err.what());
+    }
+}
+
+TEST(Credential, getTokenSource_WithPassword_ReturnNullPtr) {
+    Credential cred("Test", "123");
+    ASSERT_EQ(nullptr, cred.getTokenSource());
+}
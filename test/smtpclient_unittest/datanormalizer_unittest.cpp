@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../../src/datanormalizer.h"
+
+using namespace jed_utils;
+
+namespace {
+std::string join(const std::vector<std::string_view> &pSegments) {
+    std::string retval;
+    for (const auto &segment : pSegments) {
+        retval += segment;
+    }
+    return retval;
+}
+
+std::string normalize(std::string_view pData, bool pDotStuffing = true) {
+    std::string retval;
+    DataNormalizer(pDotStuffing).normalize(pData, retval);
+    return retval;
+}
+}  // namespace
+
+TEST(DataNormalizer_Normalize, EmptyData_ReturnEmpty) {
+    std::vector<std::string_view> segments;
+    DataNormalizer().normalize("", segments);
+    ASSERT_TRUE(segments.empty());
+    ASSERT_EQ("", normalize(""));
+}
+
+TEST(DataNormalizer_Normalize, NormalizedData_ReturnSingleViewOfData) {
+    const std::string data { "Line 1\r\nLine 2\r\n" };
+    std::vector<std::string_view> segments;
+    DataNormalizer().normalize(data, segments);
+    ASSERT_EQ(1, segments.size());
+    ASSERT_EQ(data.data(), segments[0].data());
+    ASSERT_EQ(data.size(), segments[0].size());
+}
+
+TEST(DataNormalizer_Normalize, BareLineFeeds_ReturnCRLF) {
+    ASSERT_EQ("Line 1\r\nLine 2\r\n\r\nLine 4", normalize("Line 1\nLine 2\n\nLine 4"));
+}
+
+TEST(DataNormalizer_Normalize, MixedLineEndings_ReturnCRLF) {
+    ASSERT_EQ("A\r\nB\r\nC\r\n", normalize("A\r\nB\nC\r\n"));
+}
+
+TEST(DataNormalizer_Normalize, BareCarriageReturn_ReturnUnchanged) {
+    ASSERT_EQ("A\rB\r\n", normalize("A\rB\n"));
+}
+
+TEST(DataNormalizer_Normalize, LeadingDot_ReturnDoubledDot) {
+    ASSERT_EQ("..Line 1\r\n..\r\nLine 3 .\r\n...", normalize(".Line 1\r\n.\r\nLine 3 .\r\n.."));
+}
+
+TEST(DataNormalizer_Normalize, LeadingDotAfterBareLineFeed_ReturnCRLFAndDoubledDot) {
+    ASSERT_EQ("A\r\n..\r\nB", normalize("A\n.\nB"));
+}
+
+TEST(DataNormalizer_Normalize, DotStuffingDisabled_ReturnOnlyCRLF) {
+    ASSERT_EQ(".A\r\n.\r\nB", normalize(".A\n.\r\nB", false));
+}
+
+TEST(DataNormalizer_Normalize, Segments_ReferToDataForUnchangedRuns) {
+    const std::string data { "A\nB" };
+    std::vector<std::string_view> segments;
+    DataNormalizer().normalize(data, segments);
+    ASSERT_EQ(3, segments.size());
+    ASSERT_EQ(data.data(), segments[0].data());
+    ASSERT_EQ("\r\n", segments[1]);
+    ASSERT_EQ(data.data() + 2, segments[2].data());
+    ASSERT_EQ("A\r\nB", join(segments));
+}
+
+TEST(DataNormalizer_Normalize, SegmentsAppended_KeepExistingSegments) {
+    std::vector<std::string_view> segments { "Header\r\n" };
+    DataNormalizer().normalize(".Body", segments);
+    ASSERT_EQ("Header\r\n..Body", join(segments));
+}
+
+TEST(DataNormalizer_Normalize, CRLFSplitBetweenParts_ReturnSingleCRLF) {
+    DataNormalizer normalizer;
+    std::string output;
+    normalizer.normalize("A\r", output);
+    normalizer.normalize("\nB", output);
+    ASSERT_EQ("A\r\nB", output);
+}
+
+TEST(DataNormalizer_Normalize, LeadingDotInNextPart_ReturnDoubledDot) {
+    DataNormalizer normalizer;
+    std::string output;
+    normalizer.normalize("A\n", output);
+    normalizer.normalize(".B", output);
+    ASSERT_EQ("A\r\n..B", output);
+}
+
+TEST(DataNormalizer_Normalize, DotInMiddleOfLineInNextPart_ReturnUnchanged) {
+    DataNormalizer normalizer;
+    std::string output;
+    normalizer.normalize("A", output);
+    normalizer.normalize(".B", output);
+    ASSERT_EQ("A.B", output);
+}
+
+TEST(DataNormalizer_Reset, AfterMiddleOfLine_DoubleLeadingDot) {
+    DataNormalizer normalizer;
+    std::string output;
+    normalizer.normalize("A", output);
+    normalizer.reset();
+    normalizer.normalize(".B", output);
+    ASSERT_EQ("A..B", output);
+}
+
+TEST(DataNormalizer_Normalize, LongDataWithFewLines_ReturnSameLength) {
+    const std::string line(100000, 'x');
+    const std::string data { line + "\n." + line };
+    const std::string output { normalize(data) };
+    ASSERT_EQ(data.size() + 2, output.size());
+    ASSERT_EQ(line + "\r\n.." + line, output);
+}
+
+TEST(DataNormalizer_IsNormalized, ValidData_ReturnTrue) {
+    ASSERT_TRUE(DataNormalizer().isNormalized(""));
+    ASSERT_TRUE(DataNormalizer().isNormalized("A\r\nB.\r\n"));
+}
+
+TEST(DataNormalizer_IsNormalized, BareLineFeedOrLeadingDot_ReturnFalse) {
+    ASSERT_FALSE(DataNormalizer().isNormalized("A\nB"));
+    ASSERT_FALSE(DataNormalizer().isNormalized("A\r\n.B"));
+    ASSERT_FALSE(DataNormalizer().isNormalized(".A"));
+}
+
+TEST(DataNormalizer_IsNormalized, LeadingDotWithoutDotStuffing_ReturnTrue) {
+    ASSERT_TRUE(DataNormalizer(false).isNormalized("A\r\n.B"));
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include "../../src/deliverythrottle.h"
+#include "../../src/smtpclienterrors.h"
+#include "../../src/smtpserverstatuscodes.h"
+#include "../../src/socketerrors.h"
+
+using namespace jed_utils;
+
+namespace {
+std::chrono::steady_clock::time_point in(int pMilliseconds) {
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds(pMilliseconds);
+}
+
+DeliveryThrottleOptions createOptions() {
+    DeliveryThrottleOptions options;
+    options.InitialRate = 100.0;
+    options.BurstSize = 100.0;
+    options.InitialConcurrency = 4;
+    options.MaxConcurrency = 8;
+    return options;
+}
+}  // namespace
+
+TEST(DeliveryThrottle_Constructor, WithInconsistentOptions_ReturnClampedLimits) {
+    DeliveryThrottleOptions options;
+    options.InitialRate = 0;
+    options.MinRate = 2.0;
+    options.MaxRate = 1.0;
+    options.InitialConcurrency = 0;
+    options.MinConcurrency = 0;
+    DeliveryThrottle throttle(options);
+    ASSERT_DOUBLE_EQ(2.0, throttle.getRate("smtp.example.com"));
+    ASSERT_EQ(1, throttle.getConcurrencyLimit("smtp.example.com"));
+}
+
+TEST(DeliveryThrottle_acquire, NewHost_ReturnInitialLimits) {
+    DeliveryThrottle throttle(createOptions());
+    ASSERT_DOUBLE_EQ(100.0, throttle.getRate("smtp.example.com"));
+    ASSERT_EQ(4, throttle.getConcurrencyLimit("smtp.example.com"));
+    ASSERT_EQ(0, throttle.getActiveCount("smtp.example.com"));
+}
+
+TEST(DeliveryThrottle_acquire, OverConcurrencyLimit_WaitUntilRelease) {
+    DeliveryThrottle throttle(createOptions());
+    DeliveryPermit permits[4];
+    for (auto &permit : permits) {
+        ASSERT_TRUE(throttle.acquire("smtp.example.com", in(0), permit));
+    }
+    ASSERT_EQ(4, throttle.getActiveCount("SMTP.example.com"));
+    DeliveryPermit permit;
+    ASSERT_FALSE(throttle.acquire("smtp.example.com", in(10), permit));
+    // The other hosts have their own limits
+    ASSERT_TRUE(throttle.acquire("smtp.example.org", in(0), permit));
+    std::thread releaser([&throttle, &permits]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        throttle.release(permits[0], 0);
+    });
+    ASSERT_TRUE(throttle.acquire("smtp.example.com", in(5000), permit));
+    releaser.join();
+}
+
+TEST(DeliveryThrottle_acquire, WithEmptyBucket_WaitForNextToken) {
+    DeliveryThrottleOptions options;
+    options.InitialRate = 20.0;
+    options.BurstSize = 1.0;
+    DeliveryThrottle throttle(options);
+    DeliveryPermit permit;
+    ASSERT_TRUE(throttle.acquire("smtp.example.com", in(0), permit));
+    throttle.release(permit, CLIENT_SENDMAIL_BODY_ERROR);
+    ASSERT_FALSE(throttle.acquire("smtp.example.com", in(0), permit));
+    // A token is added every 50 ms
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(throttle.acquire("smtp.example.com", in(5000), permit));
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(30));
+}
+
+TEST(DeliveryThrottle_release, WithSuccess_IncreaseLimits) {
+    DeliveryThrottle throttle(createOptions());
+    for (int index = 0; index < 4; index++) {
+        DeliveryPermit permit;
+        ASSERT_TRUE(throttle.acquire("smtp.example.com", in(0), permit));
+        throttle.release(permit, 0);
+    }
+    ASSERT_GT(throttle.getRate("smtp.example.com"), 100.0);
+    ASSERT_EQ(5, throttle.getConcurrencyLimit("smtp.example.com"));
+    ASSERT_EQ(0, throttle.getActiveCount("smtp.example.com"));
+}
+
+TEST(DeliveryThrottle_release, WithServiceNotAvailable_DecreaseLimitsOnce) {
+    DeliveryThrottle throttle(createOptions());
+    DeliveryPermit permits[4];
+    for (auto &permit : permits) {
+        ASSERT_TRUE(throttle.acquire("smtp.example.com", in(0), permit));
+    }
+    // The deliveries started together are rejected together
+    for (auto &permit : permits) {
+        throttle.release(permit, STATUS_CODE_SERVICE_NOT_AVAILABLE);
+    }
+    ASSERT_DOUBLE_EQ(50.0, throttle.getRate("smtp.example.com"));
+    ASSERT_EQ(2, throttle.getConcurrencyLimit("smtp.example.com"));
+    // A delivery started after the decrease decreases the limits again
+    DeliveryPermit permit;
+    ASSERT_TRUE(throttle.acquire("smtp.example.com", in(5000), permit));
+    throttle.release(permit, STATUS_CODE_LOCAL_ERROR_IN_PROCESSING);
+    ASSERT_DOUBLE_EQ(25.0, throttle.getRate("smtp.example.com"));
+    ASSERT_EQ(1, throttle.getConcurrencyLimit("smtp.example.com"));
+}
+
+TEST(DeliveryThrottle_release, WithManyRejections_KeepMinimumLimits) {
+    DeliveryThrottleOptions options = createOptions();
+    options.MinRate = 40.0;
+    DeliveryThrottle throttle(options);
+    for (int index = 0; index < 5; index++) {
+        DeliveryPermit permit;
+        ASSERT_TRUE(throttle.acquire("smtp.example.com", in(5000), permit));
+        throttle.release(permit, STATUS_CODE_MAILBOX_BUSY);
+    }
+    ASSERT_DOUBLE_EQ(40.0, throttle.getRate("smtp.example.com"));
+    ASSERT_EQ(1, throttle.getConcurrencyLimit("smtp.example.com"));
+}
+
+TEST(DeliveryThrottle_isThrottlingError, WithReturnCodes_ReturnExpectedValue) {
+    ASSERT_TRUE(DeliveryThrottle::isThrottlingError(STATUS_CODE_SERVICE_NOT_AVAILABLE));
+    ASSERT_TRUE(DeliveryThrottle::isThrottlingError(STATUS_CODE_MAILBOX_BUSY));
+    ASSERT_TRUE(DeliveryThrottle::isThrottlingError(STATUS_CODE_LOCAL_ERROR_IN_PROCESSING));
+    ASSERT_FALSE(DeliveryThrottle::isThrottlingError(0));
+    ASSERT_FALSE(DeliveryThrottle::isThrottlingError(550));
+    ASSERT_FALSE(DeliveryThrottle::isThrottlingError(SOCKET_INIT_SESSION_CONNECT_ERROR));
+}
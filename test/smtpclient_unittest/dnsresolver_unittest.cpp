@@ -0,0 +1,93 @@
+#include "../../src/dnsresolver.h"
+#include <gtest/gtest.h>
+#include <vector>
+#ifdef _WIN32
+    #include <WinSock2.h>
+#else
+    #include <sys/socket.h>
+#endif
+
+using namespace jed_utils;
+
+TEST(DnsResolver_resolve, NumericIPv4Address_ReturnOneAddress) {
+    DnsResolver resolver;
+    std::vector<ResolvedAddress> addresses;
+    ASSERT_EQ(0, resolver.resolve("127.0.0.1", 25, addresses));
+    ASSERT_EQ(1, addresses.size());
+    ASSERT_EQ(AF_INET, addresses[0].Family);
+    ASSERT_EQ(SOCK_STREAM, addresses[0].SocketType);
+    ASSERT_LT(0, addresses[0].AddressLength);
+}
+
+TEST(DnsResolver_resolve, Localhost_ReturnAlternatedFamilies) {
+    DnsResolver resolver;
+    std::vector<ResolvedAddress> addresses;
+    ASSERT_EQ(0, resolver.resolve("localhost", 25, addresses));
+    ASSERT_FALSE(addresses.empty());
+    // Two consecutive addresses of the same family are only allowed once
+    // the other family is exhausted
+    size_t index = 1;
+    while (index < addresses.size() && addresses[index].Family != addresses[index - 1].Family) {
+        index++;
+    }
+    for (; index < addresses.size(); index++) {
+        ASSERT_EQ(addresses[index - 1].Family, addresses[index].Family);
+    }
+}
+
+TEST(DnsResolver_resolve, NullServerName_ReturnError) {
+    DnsResolver resolver;
+    std::vector<ResolvedAddress> addresses;
+    ASSERT_NE(0, resolver.resolve(nullptr, 25, addresses));
+    ASSERT_TRUE(addresses.empty());
+}
+
+TEST(DnsResolver_resolve, InvalidServerName_ReturnError) {
+    DnsResolver resolver;
+    std::vector<ResolvedAddress> addresses;
+    ASSERT_NE(0, resolver.resolve("invalid..name", 25, addresses));
+    ASSERT_TRUE(addresses.empty());
+}
+
+TEST(DnsResolver_resolve, SameServerTwice_ReturnCachedAddresses) {
+    DnsResolver resolver;
+    std::vector<ResolvedAddress> first;
+    std::vector<ResolvedAddress> second;
+    ASSERT_EQ(0, resolver.resolve("127.0.0.1", 587, first));
+    ASSERT_EQ(1, resolver.getCacheEntryCount());
+    ASSERT_EQ(0, resolver.resolve("127.0.0.1", 587, second));
+    ASSERT_EQ(1, resolver.getCacheEntryCount());
+    ASSERT_EQ(first.size(), second.size());
+    ASSERT_EQ(first[0].Address, second[0].Address);
+}
+
+TEST(DnsResolver_resolve, DifferentPorts_ReturnSeparateEntries) {
+    DnsResolver resolver;
+    std::vector<ResolvedAddress> addresses;
+    ASSERT_EQ(0, resolver.resolve("127.0.0.1", 25, addresses));
+    ASSERT_EQ(0, resolver.resolve("127.0.0.1", 465, addresses));
+    ASSERT_EQ(2, resolver.getCacheEntryCount());
+}
+
+TEST(DnsResolver_resolve, CacheDisabled_ReturnNoEntry) {
+    DnsResolver resolver(0);
+    std::vector<ResolvedAddress> addresses;
+    ASSERT_EQ(0, resolver.resolve("127.0.0.1", 25, addresses));
+    ASSERT_EQ(0, resolver.getCacheEntryCount());
+    ASSERT_EQ(1, addresses.size());
+}
+
+TEST(DnsResolver_clearCache, WithEntries_ReturnNoEntry) {
+    DnsResolver resolver;
+    std::vector<ResolvedAddress> addresses;
+    ASSERT_EQ(0, resolver.resolve("127.0.0.1", 25, addresses));
+    resolver.clearCache();
+    ASSERT_EQ(0, resolver.getCacheEntryCount());
+}
+
+TEST(DnsResolver_setCacheTtl, ValidTtl_ReturnTtl) {
+    DnsResolver resolver;
+    ASSERT_EQ(60, resolver.getCacheTtl());
+    resolver.setCacheTtl(300);
+    ASSERT_EQ(300, resolver.getCacheTtl());
+}
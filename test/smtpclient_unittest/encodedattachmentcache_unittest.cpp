@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../src/attachment.h"
+#include "../../src/attachmentsource.h"
+#include "../../src/encodedattachmentcache.h"
+#include "../../src/mimewriter.h"
+#include "../../src/plaintextmessage.h"
+
+using namespace jed_utils;
+
+namespace {
+std::string encode(const Attachment &pAttachment) {
+    std::string retval;
+    pAttachment.streamBase64EncodedFile([&retval](const std::string &pEncodedBlock) {
+        retval += pEncodedBlock;
+        return 0;
+    });
+    return retval;
+}
+
+std::string encode(EncodedAttachmentCache &pCache, const Attachment &pAttachment, int *pRetCode = nullptr) {
+    std::string retval;
+    int ret_code = pCache.streamBase64EncodedFile(pAttachment, [&retval](const std::string &pEncodedBlock) {
+        retval += pEncodedBlock;
+        return 0;
+    });
+    if (pRetCode != nullptr) {
+        *pRetCode = ret_code;
+    }
+    return retval;
+}
+
+Attachment createBufferAttachment(const std::string &pContent, const char *pName = "file.bin") {
+    return Attachment(std::make_shared<BufferAttachmentSource>(pContent), pName);
+}
+}  // namespace
+
+TEST(EncodedAttachmentCache_Constructor, Default_ReturnEmptyCache) {
+    EncodedAttachmentCache cache;
+    ASSERT_EQ(EncodedAttachmentCache::DEFAULT_CAPACITY, cache.getCapacity());
+    ASSERT_EQ(0, cache.getSize());
+    ASSERT_EQ(0, cache.getEntryCount());
+}
+
+TEST(EncodedAttachmentCache_streamBase64EncodedFile, SameAttachmentTwice_EncodeOnce) {
+    EncodedAttachmentCache cache;
+    const Attachment attachment { createBufferAttachment(std::string(100000, 'x')) };
+    const std::string expected { encode(attachment) };
+    ASSERT_EQ(expected, encode(cache, attachment));
+    ASSERT_EQ(expected, encode(cache, attachment));
+    ASSERT_EQ(1, cache.getMissCount());
+    ASSERT_EQ(1, cache.getHitCount());
+    ASSERT_EQ(1, cache.getEntryCount());
+}
+
+TEST(EncodedAttachmentCache_streamBase64EncodedFile, SameContentInOtherAttachment_ReturnCachedContent) {
+    EncodedAttachmentCache cache;
+    encode(cache, createBufferAttachment("Hello", "a.txt"));
+    ASSERT_EQ("SGVsbG8=", encode(cache, createBufferAttachment("Hello", "b.txt")));
+    ASSERT_EQ(1, cache.getHitCount());
+}
+
+TEST(EncodedAttachmentCache_streamBase64EncodedFile, DifferentContent_ReturnOwnContent) {
+    EncodedAttachmentCache cache;
+    ASSERT_EQ("SGVsbG8=", encode(cache, createBufferAttachment("Hello")));
+    ASSERT_EQ("V29ybGQ=", encode(cache, createBufferAttachment("World")));
+    ASSERT_EQ(0, cache.getHitCount());
+    ASSERT_EQ(2, cache.getEntryCount());
+}
+
+TEST(EncodedAttachmentCache_streamBase64EncodedFile, ModifiedFile_EncodeNewContent) {
+    const char *filename = "encodedattachmentcache_unittest.txt";
+    std::ofstream(filename, std::ios::binary) << "Hello";
+    EncodedAttachmentCache cache;
+    const Attachment attachment(filename, "hello.txt");
+    ASSERT_EQ("SGVsbG8=", encode(cache, attachment));
+    std::ofstream(filename, std::ios::binary) << "Hello World";
+    ASSERT_EQ(encode(attachment), encode(cache, attachment));
+    ASSERT_EQ(0, cache.getHitCount());
+    std::remove(filename);
+}
+
+TEST(EncodedAttachmentCache_streamBase64EncodedFile, MissingFile_ReturnMinus1) {
+    EncodedAttachmentCache cache;
+    int ret_code = 0;
+    ASSERT_EQ("", encode(cache, Attachment("encodedattachmentcache_unittest_missing.txt", "missing.txt"), &ret_code));
+    ASSERT_EQ(-1, ret_code);
+    ASSERT_EQ(0, cache.getEntryCount());
+}
+
+TEST(EncodedAttachmentCache_streamBase64EncodedFile, CallbackSource_NotCached) {
+    EncodedAttachmentCache cache;
+    auto position = std::make_shared<bool>(false);
+    const Attachment attachment(std::make_shared<CallbackAttachmentSource>([position](char *pBuffer, size_t, size_t &pBytesRead) {
+        pBytesRead = *position ? 0 : 5;
+        memcpy(pBuffer, "Hello", pBytesRead);
+        *position = !*position;
+        return 0;
+    }), "hello.txt");
+    ASSERT_EQ("SGVsbG8=", encode(cache, attachment));
+    ASSERT_EQ("SGVsbG8=", encode(cache, attachment));
+    ASSERT_EQ(0, cache.getEntryCount());
+}
+
+TEST(EncodedAttachmentCache_streamBase64EncodedFile, ContentLargerThanCapacity_NotCached) {
+    EncodedAttachmentCache cache(100);
+    const Attachment attachment { createBufferAttachment(std::string(1000, 'x')) };
+    ASSERT_EQ(encode(attachment), encode(cache, attachment));
+    ASSERT_EQ(0, cache.getEntryCount());
+    ASSERT_EQ(nullptr, cache.getEncodedContent(attachment));
+}
+
+TEST(EncodedAttachmentCache_streamBase64EncodedFile, CapacityExceeded_EvictLeastRecentlyUsed) {
+    // Each entry is the key of 71 characters and 8 encoded characters
+    EncodedAttachmentCache cache(200);
+    const Attachment first { createBufferAttachment("first") };
+    const Attachment second { createBufferAttachment("secnd") };
+    const Attachment third { createBufferAttachment("third") };
+    encode(cache, first);
+    encode(cache, second);
+    encode(cache, first);
+    encode(cache, third);
+    ASSERT_EQ(2, cache.getEntryCount());
+    ASSERT_LE(cache.getSize(), 200);
+    encode(cache, first);
+    ASSERT_EQ(2, cache.getHitCount());
+    encode(cache, second);
+    ASSERT_EQ(2, cache.getHitCount());
+}
+
+TEST(EncodedAttachmentCache_getEncodedContent, Evicted_ContentStaysValid) {
+    EncodedAttachmentCache cache;
+    const Attachment attachment { createBufferAttachment("Hello") };
+    auto encoded = cache.getEncodedContent(attachment);
+    cache.clear();
+    ASSERT_EQ(0, cache.getEntryCount());
+    ASSERT_EQ(0, cache.getSize());
+    ASSERT_EQ("SGVsbG8=", *encoded);
+}
+
+TEST(EncodedAttachmentCache_getEncodedContent, SeveralThreads_ReturnSameContent) {
+    EncodedAttachmentCache cache;
+    const Attachment attachment { createBufferAttachment(std::string(200000, 'y')) };
+    const std::string expected { encode(attachment) };
+    std::vector<std::thread> threads;
+    std::vector<std::string> results(8);
+    for (auto &result : results) {
+        threads.emplace_back([&cache, &attachment, &result]() {
+            for (int index = 0; index < 10; index++) {
+                result = *cache.getEncodedContent(attachment);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (const auto &result : results) {
+        ASSERT_EQ(expected, result);
+    }
+    ASSERT_EQ(1, cache.getEntryCount());
+    ASSERT_EQ(80, cache.getHitCount() + cache.getMissCount());
+}
+
+TEST(EncodedAttachmentCache_MimeWriter, WithCache_ReturnSameContent) {
+    const Attachment attachments[] { createBufferAttachment("Hello", "hello.txt") };
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body",
+            nullptr, nullptr, attachments, 1);
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(msg));
+    auto cache = std::make_shared<EncodedAttachmentCache>();
+    MimeWriter cached_writer;
+    cached_writer.setEncodedAttachmentCache(cache);
+    ASSERT_EQ(0, cached_writer.write(msg));
+    ASSERT_EQ(0, cached_writer.write(msg));
+    // Only the boundaries of the messages differ
+    const std::string_view part = writer.getSegment(2);
+    const std::string_view cached_part = cached_writer.getSegment(2);
+    ASSERT_EQ(writer.getSize(), cached_writer.getSize());
+    ASSERT_EQ(part.substr(part.find("\r\n\r\n")), cached_part.substr(cached_part.find("\r\n\r\n")));
+    ASSERT_EQ(1, cache->getHitCount());
+}
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <string_view>
 #include "../../src/errorresolver.h"
 #include "../../src/smtpclienterrors.h"
 #include "../../src/socketerrors.h"
@@ -272,6 +273,128 @@ TEST(ErrorResolver_getErrorMessage, WithCLIENT_SENDMAIL_QUIT_ERROR_ReturnValidMe
     ASSERT_EQ("The QUIT command return an error"s, errorResolver.getErrorMessage());
 }
 
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_SENDMAIL_RSET_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_SENDMAIL_RSET_ERROR);
+    ASSERT_EQ("The RSET command return an error"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_SENDMAIL_RSET_TIMEOUT_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_SENDMAIL_RSET_TIMEOUT);
+    ASSERT_EQ("The RSET command timed out"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_SESSION_NOOP_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_SESSION_NOOP_ERROR);
+    ASSERT_EQ("The NOOP command return an error"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_SESSION_NOOP_TIMEOUT_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_SESSION_NOOP_TIMEOUT);
+    ASSERT_EQ("The NOOP command timed out"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_SESSION_NOT_OPENED_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_SESSION_NOT_OPENED_ERROR);
+    ASSERT_EQ("No persistent session is opened with the server"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_DELIVERY_MX_LOOKUP_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_DELIVERY_MX_LOOKUP_ERROR);
+    ASSERT_EQ("Unable to find the mail exchangers of the domain"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_DELIVERY_NULL_MX_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_DELIVERY_NULL_MX_ERROR);
+    ASSERT_EQ("The domain does not accept email (null MX)"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_DELIVERY_INVALID_DOMAIN_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_DELIVERY_INVALID_DOMAIN_ERROR);
+    ASSERT_EQ("The recipient address has no domain"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_QUEUE_FULL_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_QUEUE_FULL_ERROR);
+    ASSERT_EQ("The mail queue is full"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_QUEUE_STOPPED_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_QUEUE_STOPPED_ERROR);
+    ASSERT_EQ("The mail queue has been stopped"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_SPOOL_IO_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_SPOOL_IO_ERROR);
+    ASSERT_EQ("Unable to read or write the spool files"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_SPOOL_EMPTY_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_SPOOL_EMPTY_ERROR);
+    ASSERT_EQ("The mail spool has no pending message"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_SENDMAIL_BDAT_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_SENDMAIL_BDAT_ERROR);
+    ASSERT_EQ("The BDAT command return an error"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_SENDMAIL_BDAT_TIMEOUT_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_SENDMAIL_BDAT_TIMEOUT);
+    ASSERT_EQ("The BDAT command timed out"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_SENDMAIL_MESSAGE_SIZE_EXCEEDED_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_SENDMAIL_MESSAGE_SIZE_EXCEEDED_ERROR);
+    ASSERT_EQ("The message exceeds the maximum size accepted by the server"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_AUTHENTICATE_TOKEN_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_AUTHENTICATE_TOKEN_ERROR);
+    ASSERT_EQ("Unable to obtain the OAuth 2.0 access token"s, errorResolver.getErrorMessage());
+    ASSERT_EQ(ErrorCategory::Authentication, errorResolver.getErrorCategory());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_TEMPLATE_FIELD_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_TEMPLATE_FIELD_ERROR);
+    ASSERT_EQ("A merge field of the message template has no value"s, errorResolver.getErrorMessage());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_DKIM_SIGNATURE_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_DKIM_SIGNATURE_ERROR);
+    ASSERT_EQ("Unable to create the DKIM signature of the message"s, errorResolver.getErrorMessage());
+    ASSERT_EQ(ErrorCategory::Permanent, errorResolver.getErrorCategory());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_OPERATION_DEADLINE_EXCEEDED_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_OPERATION_DEADLINE_EXCEEDED_ERROR);
+    ASSERT_EQ("The operation has not completed before its deadline"s, errorResolver.getErrorMessage());
+    ASSERT_EQ(ErrorCategory::Transport, errorResolver.getErrorCategory());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_OPERATION_CANCELLED_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_OPERATION_CANCELLED_ERROR);
+    ASSERT_EQ("The operation has been cancelled"s, errorResolver.getErrorMessage());
+    ASSERT_EQ(ErrorCategory::Transient, errorResolver.getErrorCategory());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_SENDMAIL_SMTPUTF8_NOT_SUPPORTED_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_SENDMAIL_SMTPUTF8_NOT_SUPPORTED_ERROR);
+    ASSERT_EQ("The server does not support the internationalized email addresses (SMTPUTF8)"s, errorResolver.getErrorMessage());
+    ASSERT_EQ(ErrorCategory::Permanent, errorResolver.getErrorCategory());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_SENDMAIL_IDNA_CONVERSION_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_SENDMAIL_IDNA_CONVERSION_ERROR);
+    ASSERT_EQ("Unable to convert the domain of an address to its ASCII form"s, errorResolver.getErrorMessage());
+    ASSERT_EQ(ErrorCategory::Permanent, errorResolver.getErrorCategory());
+}
+
+TEST(ErrorResolver_getErrorMessage, WithCLIENT_SPOOL_CORRUPT_RECORD_ERROR_ReturnValidMessage) {
+    ErrorResolver errorResolver(CLIENT_SPOOL_CORRUPT_RECORD_ERROR);
+    ASSERT_EQ("A record of the mail spool cannot be parsed, it has been dropped"s, errorResolver.getErrorMessage());
+    ASSERT_EQ(ErrorCategory::Permanent, errorResolver.getErrorCategory());
+}
+
 TEST(ErrorResolver_getErrorMessage, WithSMTPSERVER_AUTHENTICATIONREQUIRED_ERROR_ReturnValidMessage) {
     ErrorResolver errorResolver(SMTPSERVER_AUTHENTICATIONREQUIRED_ERROR);
     ASSERT_EQ("Authentication required"s, errorResolver.getErrorMessage());
@@ -291,3 +414,52 @@ TEST(ErrorResolver_getErrorMessage, WithSMTPSERVER_ENCRYPTIONREQUIREDFORAUTH_ERR
     ErrorResolver errorResolver(SMTPSERVER_ENCRYPTIONREQUIREDFORAUTH_ERROR);
     ASSERT_EQ("Encryption required for requested authentication mechanism"s, errorResolver.getErrorMessage());
 }
+
+TEST(ErrorResolver_findErrorMessage, WithKnownCode_ReturnSameMessageAsConstructor) {
+    ErrorResolver errorResolver(CLIENT_SENDMAIL_RCPTTO_TIMEOUT);
+    ASSERT_EQ(std::string_view(errorResolver.getErrorMessage()), ErrorResolver::findErrorMessage(CLIENT_SENDMAIL_RCPTTO_TIMEOUT));
+}
+
+TEST(ErrorResolver_findErrorMessage, WithNonExistantCode_ReturnNoMessage) {
+    ASSERT_EQ("No message correspond to this error code", ErrorResolver::findErrorMessage(-1000));
+}
+
+TEST(ErrorResolver_findErrorMessage, WithKnownCode_ReturnNullTerminatedView) {
+    const std::string_view message = ErrorResolver::findErrorMessage(SSL_CLIENT_STARTTLS_VERIFY_RESULT_ERROR);
+    ASSERT_EQ('\0', message.data()[message.size()]);
+}
+
+TEST(ErrorResolver_findErrorCategory, WithZero_ReturnNone) {
+    ASSERT_EQ(ErrorCategory::None, ErrorResolver::findErrorCategory(0));
+}
+
+TEST(ErrorResolver_findErrorCategory, WithSocketError_ReturnTransport) {
+    ASSERT_EQ(ErrorCategory::Transport, ErrorResolver::findErrorCategory(SOCKET_INIT_SESSION_CONNECT_TIMEOUT));
+    ASSERT_EQ(ErrorCategory::Transport, ErrorResolver::findErrorCategory(CLIENT_SENDMAIL_DATA_TIMEOUT));
+}
+
+TEST(ErrorResolver_findErrorCategory, WithSSLError_ReturnTLS) {
+    ASSERT_EQ(ErrorCategory::TLS, ErrorResolver::findErrorCategory(SSL_CLIENT_STARTTLS_BIO_HANDSHAKE_ERROR));
+}
+
+TEST(ErrorResolver_findErrorCategory, WithAuthenticationError_ReturnAuthentication) {
+    ASSERT_EQ(ErrorCategory::Authentication, ErrorResolver::findErrorCategory(CLIENT_AUTHENTICATE_ERROR));
+    ASSERT_EQ(ErrorCategory::Authentication, ErrorResolver::findErrorCategory(SMTPSERVER_CREDENTIALSINVALID_ERROR));
+}
+
+TEST(ErrorResolver_findErrorCategory, WithServerReplies_ReturnTransientOrPermanent) {
+    ASSERT_EQ(ErrorCategory::Transient, ErrorResolver::findErrorCategory(421));
+    ASSERT_EQ(ErrorCategory::Transient, ErrorResolver::findErrorCategory(CLIENT_QUEUE_FULL_ERROR));
+    ASSERT_EQ(ErrorCategory::Permanent, ErrorResolver::findErrorCategory(550));
+    ASSERT_EQ(ErrorCategory::Permanent, ErrorResolver::findErrorCategory(CLIENT_DELIVERY_NULL_MX_ERROR));
+}
+
+TEST(ErrorResolver_findErrorCategory, WithNonExistantCode_ReturnUnknown) {
+    ASSERT_EQ(ErrorCategory::Unknown, ErrorResolver::findErrorCategory(-1000));
+    ASSERT_EQ(ErrorCategory::Unknown, ErrorResolver::findErrorCategory(250));
+}
+
+TEST(ErrorResolver_getErrorCategory, WithSSLError_ReturnTLS) {
+    ErrorResolver errorResolver(SSL_CLIENT_INITSECURECLIENT_TIMEOUT);
+    ASSERT_EQ(ErrorCategory::TLS, errorResolver.getErrorCategory());
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "../../src/attachment.h"
+#include "../../src/attachmentsource.h"
+#include "../../src/gzipattachmentsource.h"
+
+#ifdef SMTPCLIENT_HAS_ZLIB
+    #include <zlib.h>
+#endif
+
+using namespace jed_utils;
+
+namespace {
+std::string createExport(size_t pLineCount) {
+    std::string content;
+    for (size_t index = 0; index < pLineCount; index++) {
+        content += "2024-03-01;" + std::to_string(index) + ";order shipped;EUR;12.50\n";
+    }
+    return content;
+}
+
+std::string readAll(const AttachmentSource &pSource, int *pRetCode = nullptr) {
+    std::string content;
+    const int ret_code = pSource.read([&content](std::string_view pBlock) {
+        content.append(pBlock);
+        return 0;
+    });
+    if (pRetCode != nullptr) {
+        *pRetCode = ret_code;
+    }
+    return content;
+}
+
+// The gzip trailer ends with the size of the uncompressed content (RFC 1952)
+size_t readUncompressedSize(const std::string &pCompressed) {
+    size_t size = 0;
+    for (size_t index = 0; index < 4; index++) {
+        size |= static_cast<size_t>(static_cast<unsigned char>(pCompressed[pCompressed.size() - 4 + index])) << (8 * index);
+    }
+    return size;
+}
+
+class GzipAttachmentSourceFixture : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        if (!GzipAttachmentSource::isAvailable()) {
+            GTEST_SKIP() << "Built without zlib";
+        }
+    }
+};
+}  // namespace
+
+TEST_F(GzipAttachmentSourceFixture, read_WithTextContent_ReturnSmallerGzipContent) {
+    const std::string content { createExport(5000) };
+    GzipAttachmentSource source(std::make_shared<BufferAttachmentSource>(content));
+    int ret_code = -1;
+    const std::string compressed { readAll(source, &ret_code) };
+    ASSERT_EQ(0, ret_code);
+    ASSERT_GE(compressed.size(), 18U);
+    ASSERT_EQ('\x1F', compressed[0]);
+    ASSERT_EQ('\x8B', compressed[1]);
+    ASSERT_EQ(content.size(), readUncompressedSize(compressed));
+    ASSERT_LT(compressed.size() * 5, content.size());
+#ifdef SMTPCLIENT_HAS_ZLIB
+    z_stream stream {};
+    ASSERT_EQ(Z_OK, inflateInit2(&stream, 15 + 16));
+    std::string decompressed(content.size() + 1, '\0');
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    stream.next_out = reinterpret_cast<Bytef *>(&decompressed[0]);
+    stream.avail_out = static_cast<uInt>(decompressed.size());
+    ASSERT_EQ(Z_STREAM_END, inflate(&stream, Z_FINISH));
+    decompressed.resize(stream.total_out);
+    inflateEnd(&stream);
+    ASSERT_EQ(content, decompressed);
+#endif
+}
+
+TEST_F(GzipAttachmentSourceFixture, read_WithContentInSeveralBlocks_ReturnSameCompressedSize) {
+    const std::string content { createExport(20000) };
+    size_t offset = 0;
+    GzipAttachmentSource source(std::make_shared<CallbackAttachmentSource>(
+                [&content, &offset](char *pBuffer, size_t pBufferSize, size_t &pBytesRead) {
+        pBytesRead = std::min(pBufferSize, content.size() - offset);
+        content.copy(pBuffer, pBytesRead, offset);
+        offset += pBytesRead;
+        return 0;
+    }));
+    const std::string compressed { readAll(source) };
+    ASSERT_EQ(content.size(), readUncompressedSize(compressed));
+    ASSERT_EQ(compressed, readAll(GzipAttachmentSource(std::make_shared<BufferAttachmentSource>(content))));
+}
+
+TEST_F(GzipAttachmentSourceFixture, read_WithEmptyContent_ReturnGzipHeaderAndTrailer) {
+    GzipAttachmentSource source(std::make_shared<BufferAttachmentSource>(""));
+    const std::string compressed { readAll(source) };
+    ASSERT_GE(compressed.size(), 18U);
+    ASSERT_EQ(0U, readUncompressedSize(compressed));
+}
+
+TEST_F(GzipAttachmentSourceFixture, read_WithUnreadableSource_ReturnMinusOne) {
+    GzipAttachmentSource source(std::make_shared<FileAttachmentSource>("gzipattachmentsource_unittest_missing.csv"));
+    int ret_code = 0;
+    readAll(source, &ret_code);
+    ASSERT_EQ(-1, ret_code);
+}
+
+TEST_F(GzipAttachmentSourceFixture, read_WithWriterError_ReturnWriterError) {
+    GzipAttachmentSource source(std::make_shared<BufferAttachmentSource>(createExport(100)));
+    ASSERT_EQ(-42, source.read([](std::string_view) {
+        return -42;
+    }));
+}
+
+TEST_F(GzipAttachmentSourceFixture, getCacheKey_WithIdentifiedSource_ReturnPrefixedKey) {
+    auto buffer = std::make_shared<BufferAttachmentSource>("a;b");
+    GzipAttachmentSource source(buffer, 9);
+    ASSERT_EQ("gzip9:" + buffer->getCacheKey(), source.getCacheKey());
+    ASSERT_FALSE(source.getSize().has_value());
+}
+
+TEST_F(GzipAttachmentSourceFixture, Attachment_WithGzName_ReturnGzipMimeType) {
+    Attachment attachment(std::make_shared<GzipAttachmentSource>(std::make_shared<BufferAttachmentSource>("a;b")),
+            "export.csv.gz");
+    ASSERT_STREQ("application/gzip", attachment.getMimeType());
+}
+
+TEST(GzipAttachmentSource_Constructor, WithNullSourceOrInvalidLevel_Throw) {
+    ASSERT_THROW(GzipAttachmentSource(std::shared_ptr<const AttachmentSource>()), std::invalid_argument);
+    ASSERT_THROW(GzipAttachmentSource(std::make_shared<BufferAttachmentSource>("a"), 0), std::invalid_argument);
+    ASSERT_THROW(GzipAttachmentSource(std::make_shared<BufferAttachmentSource>("a"), 10), std::invalid_argument);
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "../../src/base64.h"
+#include "../../src/headerencoder.h"
+#include "../../src/recipienttable.h"
+
+using namespace jed_utils;
+
+namespace {
+// Check that no line exceeds the maximum length and that each continuation
+// line starts with whitespace
+void assertFolded(const std::string &pField) {
+    size_t line_start = 0;
+    while (line_start < pField.size()) {
+        const size_t line_end = pField.find("\r\n", line_start);
+        ASSERT_NE(std::string::npos, line_end);
+        ASSERT_LE(line_end - line_start, HeaderEncoder::MAX_LINE_LENGTH);
+        if (line_start > 0) {
+            ASSERT_EQ(' ', pField[line_start]);
+        }
+        line_start = line_end + 2;
+    }
+}
+
+// Concatenate the decoded text of the encoded-words of a field
+std::string decodeEncodedWords(const std::string &pField) {
+    std::string decoded;
+    size_t position = 0;
+    while ((position = pField.find("=?UTF-8?B?", position)) != std::string::npos) {
+        position += 10;
+        const size_t end = pField.find("?=", position);
+        decoded += Base64::Decode(pField.substr(position, end - position));
+        position = end + 2;
+    }
+    return decoded;
+}
+}  // namespace
+
+TEST(HeaderEncoder_appendUnstructuredField, WithShortAsciiValue_AppendUnchangedField) {
+    std::string output { "From: from@test.com\r\n" };
+    HeaderEncoder::appendUnstructuredField(output, "Subject", "Monthly report");
+    ASSERT_EQ("From: from@test.com\r\nSubject: Monthly report\r\n", output);
+}
+
+TEST(HeaderEncoder_appendUnstructuredField, WithEmptyValue_AppendEmptyField) {
+    std::string output;
+    HeaderEncoder::appendUnstructuredField(output, "Subject", "");
+    ASSERT_EQ("Subject: \r\n", output);
+}
+
+TEST(HeaderEncoder_appendUnstructuredField, WithLongAsciiValue_FoldBeforeWhitespace) {
+    std::string value;
+    for (int index = 0; index < 20; index++) {
+        value += "word" + std::to_string(index) + " ";
+    }
+    value.pop_back();
+    std::string output;
+    HeaderEncoder::appendUnstructuredField(output, "Subject", value);
+    assertFolded(output);
+    ASSERT_NE(std::string::npos, output.find("\r\n "));
+    // Unfolding removes the CRLF only
+    std::string unfolded { output };
+    for (size_t position; (position = unfolded.find("\r\n ")) != std::string::npos;) {
+        unfolded.erase(position, 2);
+    }
+    ASSERT_EQ("Subject: " + value + "\r\n", unfolded);
+}
+
+TEST(HeaderEncoder_appendUnstructuredField, WithLongWordWithoutWhitespace_KeepWordOnItsLine) {
+    const std::string value(100, 'x');
+    std::string output;
+    HeaderEncoder::appendUnstructuredField(output, "Subject", value);
+    ASSERT_EQ("Subject: " + value + "\r\n", output);
+}
+
+TEST(HeaderEncoder_appendUnstructuredField, WithUtf8Value_AppendEncodedWord) {
+    std::string output;
+    HeaderEncoder::appendUnstructuredField(output, "Subject", "Caf\xC3\xA9");
+    ASSERT_EQ("Subject: =?UTF-8?B?Q2Fmw6k=?=\r\n", output);
+}
+
+TEST(HeaderEncoder_appendUnstructuredField, WithLineBreakInValue_AppendEncodedWord) {
+    std::string output;
+    HeaderEncoder::appendUnstructuredField(output, "Subject", "Hello\r\nBcc: other@test.com");
+    ASSERT_EQ(std::string::npos, output.find("\r\nBcc"));
+    ASSERT_EQ("Hello\r\nBcc: other@test.com", decodeEncodedWords(output));
+}
+
+TEST(HeaderEncoder_appendUnstructuredField, WithLongUtf8Value_SplitWordsOnCharacterBoundaries) {
+    std::string value;
+    for (int index = 0; index < 60; index++) {
+        value += "\xE2\x82\xAC";  // Euro sign
+    }
+    std::string output;
+    HeaderEncoder::appendUnstructuredField(output, "Subject", value);
+    assertFolded(output);
+    ASSERT_EQ(value, decodeEncodedWords(output));
+    size_t position = 0;
+    while ((position = output.find("=?UTF-8?B?", position)) != std::string::npos) {
+        position += 10;
+        const size_t end = output.find("?=", position);
+        ASSERT_LE(end + 2 - (position - 10), HeaderEncoder::MAX_ENCODED_WORD_LENGTH);
+        ASSERT_EQ(0U, Base64::Decode(output.substr(position, end - position)).size() % 3);
+        position = end + 2;
+    }
+}
+
+TEST(HeaderEncoder_appendUnstructuredField, WithLongFieldName_StartEncodedWordOnNextLine) {
+    const std::string name(70, 'X');
+    std::string output;
+    HeaderEncoder::appendUnstructuredField(output, name, "\xF0\x9F\x98\x80");
+    ASSERT_EQ(name + ":\r\n =?UTF-8?B?8J+YgA==?=\r\n", output);
+}
+
+TEST(HeaderEncoder_appendAddressField, WithSingleAddress_AppendField) {
+    RecipientTable table;
+    table.append("to@test.com", "");
+    std::string output;
+    HeaderEncoder::appendAddressField(output, "To", table, 0, 1);
+    ASSERT_EQ("To: to@test.com\r\n", output);
+}
+
+TEST(HeaderEncoder_appendAddressField, WithEmptyRange_AppendNothing) {
+    RecipientTable table;
+    table.append("to@test.com", "");
+    std::string output;
+    HeaderEncoder::appendAddressField(output, "Cc", table, 1, 1);
+    ASSERT_EQ("", output);
+}
+
+TEST(HeaderEncoder_appendAddressField, WithManyAddresses_AppendSingleFoldedField) {
+    RecipientTable table;
+    std::string expected_unfolded { "To: " };
+    for (int index = 0; index < 12; index++) {
+        const std::string address { "recipient" + std::to_string(index) + "@example.com" };
+        table.append(address, "");
+        expected_unfolded += (index > 0 ? ", " : "") + address;
+    }
+    expected_unfolded += "\r\n";
+    std::string output;
+    HeaderEncoder::appendAddressField(output, "To", table, 0, table.size());
+    assertFolded(output);
+    ASSERT_EQ(0U, output.find("To: recipient0@example.com, recipient1@example.com, recipient2@example.com,\r\n recipient3"));
+    std::string unfolded { output };
+    for (size_t position; (position = unfolded.find("\r\n ")) != std::string::npos;) {
+        unfolded.erase(position, 2);
+    }
+    ASSERT_EQ(expected_unfolded, unfolded);
+}
+
+TEST(HeaderEncoder_requiresEncoding, WithPrintableAsciiAndTab_ReturnFalse) {
+    ASSERT_FALSE(HeaderEncoder::requiresEncoding("Report\tof ~March~"));
+}
+
+TEST(HeaderEncoder_requiresEncoding, WithEightBitOrControlCharacters_ReturnTrue) {
+    ASSERT_TRUE(HeaderEncoder::requiresEncoding("Caf\xC3\xA9"));
+    ASSERT_TRUE(HeaderEncoder::requiresEncoding("Line\nBreak"));
+}
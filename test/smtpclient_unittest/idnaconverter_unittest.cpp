@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "../../src/idnaconverter.h"
+
+using namespace jed_utils;
+
+TEST(IdnaConverter_convertToAscii, WithAsciiDomain_ReturnSameDomain) {
+    std::string ascii_domain;
+    ASSERT_TRUE(IdnaConverter::convertToAscii("mail.Example.com", ascii_domain));
+    ASSERT_EQ("mail.Example.com", ascii_domain);
+}
+
+TEST(IdnaConverter_convertToAscii, WithInternationalizedLabels_ReturnALabels) {
+    std::string ascii_domain;
+    ASSERT_TRUE(IdnaConverter::convertToAscii("b\xc3\xbc" "cher.example", ascii_domain));
+    ASSERT_EQ("xn--bcher-kva.example", ascii_domain);
+    ASSERT_TRUE(IdnaConverter::convertToAscii("M\xc3\xbcnchen.de", ascii_domain));
+    ASSERT_EQ("xn--mnchen-3ya.de", ascii_domain);
+    ASSERT_TRUE(IdnaConverter::convertToAscii("\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e.jp", ascii_domain));
+    ASSERT_EQ("xn--wgv71a119e.jp", ascii_domain);
+}
+
+TEST(IdnaConverter_convertToAscii, WithInvalidDomain_ReturnFalse) {
+    std::string ascii_domain;
+    ASSERT_FALSE(IdnaConverter::convertToAscii("b\xc3" "cher.example", ascii_domain));
+    // 60 two-byte characters give an A-label longer than 63 characters
+    std::string long_label;
+    for (int index = 0; index < 60; index++) {
+        long_label += "\xc3\xa9";
+    }
+    ASSERT_FALSE(IdnaConverter::convertToAscii(long_label + ".example", ascii_domain));
+}
+
+TEST(IdnaConverter_toAscii, CalledTwice_ReturnCachedDomain) {
+    IdnaConverter converter;
+    const std::string *first = converter.toAscii("b\xc3\xbc" "cher.example");
+    ASSERT_NE(nullptr, first);
+    ASSERT_EQ("xn--bcher-kva.example", *first);
+    ASSERT_EQ(first, converter.toAscii("b\xc3\xbc" "cher.example"));
+    ASSERT_EQ(1U, converter.getCachedDomainCount());
+    ASSERT_EQ(nullptr, converter.toAscii("\xc0\xaf.example"));
+    ASSERT_EQ(1U, converter.getCachedDomainCount());
+}
+
+TEST(IdnaConverter_toAscii, WithFullCache_ClearCache) {
+    IdnaConverter converter;
+    for (size_t index = 0; index <= IdnaConverter::MAX_CACHED_DOMAIN_COUNT; index++) {
+        ASSERT_NE(nullptr, converter.toAscii("\xc3\xa9" + std::to_string(index) + ".example"));
+    }
+    ASSERT_EQ(1U, converter.getCachedDomainCount());
+}
@@ -0,0 +1,291 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../../src/deliverythrottle.h"
+#include "../../src/mailqueue.h"
+#include "../../src/plaintextmessage.h"
+#include "../../src/smtpclienterrors.h"
+#include "../../src/smtpserverstatuscodes.h"
+#include "../../src/socketerrors.h"
+
+using namespace jed_utils;
+
+namespace {
+std::shared_ptr<const Message> createMessage() {
+    return std::make_shared<PlaintextMessage>(MessageAddress("from@test.com"),
+            MessageAddress("to@test.com"),
+            "Subject",
+            "Body");
+}
+}  // namespace
+
+TEST(MailQueue_Constructor, WithNullServerName_ThrowInvalidArgument) {
+    try {
+        MailQueue queue(SmtpClientType::Plain, nullptr, 25);
+        FAIL();
+    }
+    catch(std::invalid_argument &err) {
+        ASSERT_STREQ("Server name cannot be null or empty", err.what());
+    }
+}
+
+TEST(MailQueue_Constructor, NewQueue_ReturnEmptyQueue) {
+    MailQueue queue(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 16, 2);
+    ASSERT_EQ(16, queue.getCapacity());
+    ASSERT_EQ(0, queue.getReservedWorkerCount());
+    ASSERT_EQ(8, queue.getPriorityWeight(MailPriority::High));
+    ASSERT_EQ(0, queue.getQueuedCount());
+    ASSERT_EQ(0, queue.getPendingCount());
+    ASSERT_FALSE(queue.isBackpressureActive());
+}
+
+TEST(MailQueue_enqueue, WithNullMessage_ThrowInvalidArgument) {
+    MailQueue queue(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 4, 1);
+    try {
+        queue.enqueue(nullptr);
+        FAIL();
+    }
+    catch(std::invalid_argument &err) {
+        ASSERT_STREQ("Message cannot be null", err.what());
+    }
+}
+
+TEST(MailQueue_enqueue, AfterShutdown_ReturnStoppedError) {
+    MailQueue queue(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 4, 1);
+    queue.shutdown();
+    ASSERT_EQ(CLIENT_QUEUE_STOPPED_ERROR, queue.enqueue(createMessage()));
+}
+
+TEST(MailQueue_enqueue, UnreachableServer_RetryThenCallWithError) {
+    MailQueue queue(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 4, 1);
+    queue.setRetryPolicy(3, 1, 2);
+    std::promise<int> result;
+    ASSERT_EQ(0, queue.enqueue(createMessage(), [&result](int pReturnCode) { result.set_value(pReturnCode); }));
+    int return_code = result.get_future().get();
+    ASSERT_TRUE(MailQueue::isTransientError(return_code));
+    queue.waitForIdle();
+    ASSERT_EQ(2, queue.getRetryCount());
+    ASSERT_EQ(0, queue.getPendingCount());
+}
+
+TEST(MailQueue_enqueue, FullQueue_ReturnFullErrorAndSignalBackpressure) {
+    MailQueue queue(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 2, 1);
+    queue.setRetryPolicy(1, 1, 1);
+    std::atomic<int> activation_count { 0 };
+    std::atomic<int> release_count { 0 };
+    queue.setBackpressureCallback([&activation_count, &release_count](bool pActive) {
+            (pActive ? activation_count : release_count)++;
+            }, 2, 0);
+    // The worker is held in the callback of the first message
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    ASSERT_EQ(0, queue.enqueue(createMessage(), [&started, released](int) {
+            started.set_value();
+            released.wait();
+            }));
+    started.get_future().wait();
+    ASSERT_EQ(0, queue.enqueue(createMessage()));
+    ASSERT_EQ(0, queue.enqueue(createMessage()));
+    ASSERT_EQ(CLIENT_QUEUE_FULL_ERROR, queue.enqueue(createMessage()));
+    ASSERT_TRUE(queue.isBackpressureActive());
+    ASSERT_EQ(1, activation_count.load());
+    ASSERT_EQ(3, queue.getPendingCount());
+    release.set_value();
+    queue.waitForIdle();
+    ASSERT_FALSE(queue.isBackpressureActive());
+    ASSERT_EQ(1, release_count.load());
+}
+
+TEST(MailQueue_shutdown, WithoutDrain_CallQueuedMessagesWithStoppedError) {
+    MailQueue queue(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 2, 1);
+    queue.setRetryPolicy(1, 1, 1);
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    ASSERT_EQ(0, queue.enqueue(createMessage(), [&started, released](int) {
+            started.set_value();
+            released.wait();
+            }));
+    started.get_future().wait();
+    std::atomic<int> stopped_count { 0 };
+    auto count_stopped = [&stopped_count](int pReturnCode) {
+        if (pReturnCode == CLIENT_QUEUE_STOPPED_ERROR) {
+            stopped_count++;
+        }
+    };
+    ASSERT_EQ(0, queue.enqueue(createMessage(), count_stopped));
+    ASSERT_EQ(0, queue.enqueue(createMessage(), count_stopped));
+    std::thread stopper([&queue]() { queue.shutdown(false); });
+    // The queue is full until the shutdown starts
+    while (queue.enqueue(createMessage()) != CLIENT_QUEUE_STOPPED_ERROR) {
+        std::this_thread::yield();
+    }
+    release.set_value();
+    stopper.join();
+    ASSERT_EQ(2, stopped_count.load());
+    ASSERT_EQ(0, queue.getPendingCount());
+}
+
+TEST(MailQueue_shutdown, WithDrain_SendQueuedMessages) {
+    std::atomic<int> completed_count { 0 };
+    {
+        MailQueue queue(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 8, 2);
+        queue.setRetryPolicy(1, 1, 1);
+        for (int index = 0; index < 5; index++) {
+            ASSERT_EQ(0, queue.enqueue(createMessage(), [&completed_count](int pReturnCode) {
+                    if (pReturnCode != CLIENT_QUEUE_STOPPED_ERROR) {
+                        completed_count++;
+                    }
+                    }));
+        }
+    }
+    ASSERT_EQ(5, completed_count.load());
+}
+
+TEST(MailQueue_setThrottle, WithThrottle_ReleasePermitAfterEachAttempt) {
+    auto throttle = std::make_shared<DeliveryThrottle>();
+    MailQueue queue(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 8, 2);
+    queue.setThrottle(throttle);
+    ASSERT_EQ(throttle, queue.getThrottle());
+    queue.setRetryPolicy(2, 1, 1);
+    std::atomic<int> completed_count { 0 };
+    for (int index = 0; index < 3; index++) {
+        ASSERT_EQ(0, queue.enqueue(createMessage(), [&completed_count](int) { completed_count++; }));
+    }
+    queue.waitForIdle();
+    ASSERT_EQ(3, completed_count.load());
+    ASSERT_EQ(0, throttle->getActiveCount("127.0.0.1"));
+    // The connection failures are not a throttling of the server
+    ASSERT_EQ(2, throttle->getConcurrencyLimit("127.0.0.1"));
+}
+
+TEST(MailQueue_shutdown, WithoutDrainAndThrottledServer_CallWaitingMessagesWithStoppedError) {
+    DeliveryThrottleOptions options;
+    options.InitialRate = 0.001;
+    options.MinRate = 0.001;
+    options.BurstSize = 1;
+    auto throttle = std::make_shared<DeliveryThrottle>(options);
+    DeliveryPermit permit;
+    ASSERT_TRUE(throttle->acquire("127.0.0.1", std::chrono::steady_clock::now(), permit));
+    std::atomic<int> stopped_count { 0 };
+    {
+        MailQueue queue(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 8, 1);
+        queue.setThrottle(throttle);
+        ASSERT_EQ(0, queue.enqueue(createMessage(), [&stopped_count](int pReturnCode) {
+                if (pReturnCode == CLIENT_QUEUE_STOPPED_ERROR) {
+                    stopped_count++;
+                }
+                }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        queue.shutdown(false);
+    }
+    ASSERT_EQ(1, stopped_count.load());
+}
+
+TEST(MailQueue_enqueue, WithHighPriority_SendBeforeQueuedBulkMessages) {
+    MailQueue queue(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 8, 1);
+    queue.setRetryPolicy(1, 1, 1);
+    std::mutex order_mutex;
+    std::vector<MailPriority> order;
+    auto record = [&order_mutex, &order](MailPriority pPriority) {
+        return [&order_mutex, &order, pPriority](int) {
+            std::lock_guard<std::mutex> lock(order_mutex);
+            order.push_back(pPriority);
+        };
+    };
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    ASSERT_EQ(0, queue.enqueue(createMessage(), [&started, released](int) {
+            started.set_value();
+            released.wait();
+            }));
+    started.get_future().wait();
+    ASSERT_EQ(0, queue.enqueue(createMessage(), record(MailPriority::Bulk), MailPriority::Bulk));
+    ASSERT_EQ(0, queue.enqueue(createMessage(), record(MailPriority::Bulk), MailPriority::Bulk));
+    ASSERT_EQ(0, queue.enqueue(createMessage(), record(MailPriority::High), MailPriority::High));
+    ASSERT_EQ(3, queue.getQueuedCount());
+    ASSERT_EQ(2, queue.getQueuedCount(MailPriority::Bulk));
+    ASSERT_EQ(1, queue.getQueuedCount(MailPriority::High));
+    release.set_value();
+    queue.waitForIdle();
+    ASSERT_EQ((std::vector<MailPriority> { MailPriority::High, MailPriority::Bulk, MailPriority::Bulk }), order);
+}
+
+TEST(MailQueue_setPriorityWeights, WithBacklogInTwoClasses_ShareWorkersByWeight) {
+    MailQueue queue(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 16, 1);
+    queue.setRetryPolicy(1, 1, 1);
+    queue.setPriorityWeights(1, 3, 0);
+    ASSERT_EQ(3, queue.getPriorityWeight(MailPriority::Normal));
+    ASSERT_EQ(1, queue.getPriorityWeight(MailPriority::Bulk));
+    std::mutex order_mutex;
+    std::vector<MailPriority> order;
+    auto record = [&order_mutex, &order](MailPriority pPriority) {
+        return [&order_mutex, &order, pPriority](int) {
+            std::lock_guard<std::mutex> lock(order_mutex);
+            order.push_back(pPriority);
+        };
+    };
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    ASSERT_EQ(0, queue.enqueue(createMessage(), [&started, released](int) {
+            started.set_value();
+            released.wait();
+            }, MailPriority::High));
+    started.get_future().wait();
+    for (int index = 0; index < 4; index++) {
+        ASSERT_EQ(0, queue.enqueue(createMessage(), record(MailPriority::Bulk), MailPriority::Bulk));
+        ASSERT_EQ(0, queue.enqueue(createMessage(), record(MailPriority::Normal), MailPriority::Normal));
+    }
+    release.set_value();
+    queue.waitForIdle();
+    ASSERT_EQ(8, order.size());
+    // The bulk messages are neither starved nor sent in a run
+    ASSERT_EQ(1, std::count(order.begin(), order.begin() + 4, MailPriority::Bulk));
+    ASSERT_EQ(MailPriority::Bulk, order.back());
+}
+
+TEST(MailQueue_setReservedWorkerCount, WithBusyWorker_SendHighPriorityOnReservedWorker) {
+    MailQueue queue(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 8, 2);
+    queue.setRetryPolicy(1, 1, 1);
+    queue.setReservedWorkerCount(5);
+    ASSERT_EQ(1, queue.getReservedWorkerCount());
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    ASSERT_EQ(0, queue.enqueue(createMessage(), [&started, released](int) {
+            started.set_value();
+            released.wait();
+            }, MailPriority::Bulk));
+    started.get_future().wait();
+    ASSERT_EQ(0, queue.enqueue(createMessage(), nullptr, MailPriority::Bulk));
+    std::promise<int> high_result;
+    ASSERT_EQ(0, queue.enqueue(createMessage(), [&high_result](int pReturnCode) {
+            high_result.set_value(pReturnCode);
+            }, MailPriority::High));
+    ASSERT_NE(0, high_result.get_future().get());
+    // The reserved worker does not take the bulk messages
+    ASSERT_EQ(1, queue.getQueuedCount(MailPriority::Bulk));
+    release.set_value();
+    queue.waitForIdle();
+    ASSERT_EQ(0, queue.getPendingCount());
+}
+
+TEST(MailQueue_isTransientError, WithReturnCodes_ReturnExpectedValue) {
+    ASSERT_TRUE(MailQueue::isTransientError(STATUS_CODE_SERVICE_NOT_AVAILABLE));
+    ASSERT_TRUE(MailQueue::isTransientError(STATUS_CODE_MAILBOX_BUSY));
+    ASSERT_TRUE(MailQueue::isTransientError(STATUS_CODE_INSUFFICIENT_SYSTEM_STORAGE));
+    ASSERT_TRUE(MailQueue::isTransientError(SOCKET_INIT_SESSION_CONNECT_TIMEOUT));
+    ASSERT_FALSE(MailQueue::isTransientError(0));
+    ASSERT_FALSE(MailQueue::isTransientError(550));
+    ASSERT_FALSE(MailQueue::isTransientError(CLIENT_SENDMAIL_BODY_ERROR));
+}
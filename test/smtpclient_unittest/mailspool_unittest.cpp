@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include "../../src/mailqueue.h"
+#include "../../src/mailspool.h"
+#include "../../src/plaintextmessage.h"
+#include "../../src/smtpclient.h"
+#include "../../src/smtpclienterrors.h"
+
+using namespace jed_utils;
+
+namespace {
+PlaintextMessage createMessage(const char *pSubject = "Subject") {
+    return PlaintextMessage(MessageAddress("from@test.com"),
+            MessageAddress("to@test.com"),
+            pSubject,
+            "Body");
+}
+
+class MailSpoolFixture : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        mDirectory = (std::filesystem::temp_directory_path() /
+                ("mailspool_unittest_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()))).string();
+        std::filesystem::remove_all(mDirectory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(mDirectory);
+    }
+
+    std::string getFirstSegmentPath() const {
+        for (const auto &entry : std::filesystem::directory_iterator(mDirectory)) {
+            if (entry.path().extension() == ".seg") {
+                return entry.path().string();
+            }
+        }
+        return "";
+    }
+
+    std::string mDirectory;
+};
+}  // namespace
+
+TEST(MailSpool_Constructor, WithNullDirectory_ThrowInvalidArgument) {
+    try {
+        MailSpool spool(nullptr);
+        FAIL();
+    }
+    catch(std::invalid_argument &err) {
+        ASSERT_STREQ("Spool directory cannot be null or empty", err.what());
+    }
+}
+
+TEST_F(MailSpoolFixture, Constructor_WithValidDirectory_ReturnEmptySpool) {
+    MailSpool spool(mDirectory.c_str(), 1024);
+    ASSERT_EQ(mDirectory, spool.getDirectory());
+    ASSERT_EQ(1024, spool.getMaxSegmentSize());
+    ASSERT_EQ(0, spool.getPendingCount());
+    ASSERT_FALSE(spool.isSyncOnWrite());
+    ASSERT_FALSE(std::filesystem::exists(mDirectory));
+}
+
+TEST_F(MailSpoolFixture, open_WithMissingDirectory_CreateDirectory) {
+    MailSpool spool(mDirectory.c_str());
+    ASSERT_EQ(0, spool.open());
+    ASSERT_TRUE(std::filesystem::is_directory(mDirectory));
+    ASSERT_EQ(0, spool.getSegmentCount());
+}
+
+TEST_F(MailSpoolFixture, open_WithDirectoryThatIsAFile_ReturnIOError) {
+    std::ofstream(mDirectory) << "not a directory";
+    MailSpool spool(mDirectory.c_str());
+    ASSERT_EQ(CLIENT_SPOOL_IO_ERROR, spool.open());
+    std::filesystem::remove(mDirectory);
+}
+
+TEST_F(MailSpoolFixture, open_WithForeignFiles_IgnoreFiles) {
+    std::filesystem::create_directories(mDirectory);
+    std::ofstream(mDirectory + "/spool-999999999999999999999.seg") << "foreign";
+    std::ofstream(mDirectory + "/spool-12a.seg") << "foreign";
+    std::ofstream(mDirectory + "/spool--1.seg") << "foreign";
+    MailSpool spool(mDirectory.c_str());
+    ASSERT_EQ(0, spool.open());
+    ASSERT_EQ(0, spool.getPendingCount());
+    ASSERT_EQ(0, spool.getSegmentCount());
+    ASSERT_EQ(0, spool.enqueue(createMessage()));
+    ASSERT_EQ(1, spool.getPendingCount());
+}
+
+TEST_F(MailSpoolFixture, enqueue_WithThreeMessages_ReturnThreePending) {
+    MailSpool spool(mDirectory.c_str());
+    spool.setSyncOnWrite(true);
+    for (int index = 0; index < 3; index++) {
+        ASSERT_EQ(0, spool.enqueue(createMessage()));
+    }
+    ASSERT_EQ(3, spool.getPendingCount());
+    ASSERT_EQ(1, spool.getSegmentCount());
+}
+
+TEST_F(MailSpoolFixture, enqueue_WithSmallMaxSegmentSize_StartNewSegments) {
+    MailSpool spool(mDirectory.c_str(), 1);
+    for (int index = 0; index < 3; index++) {
+        ASSERT_EQ(0, spool.enqueue(createMessage()));
+    }
+    ASSERT_EQ(3, spool.getPendingCount());
+    ASSERT_EQ(3, spool.getSegmentCount());
+}
+
+TEST_F(MailSpoolFixture, open_AfterRestart_ReturnPendingRecords) {
+    {
+        MailSpool spool(mDirectory.c_str(), 1);
+        ASSERT_EQ(0, spool.enqueue(createMessage()));
+        ASSERT_EQ(0, spool.enqueue(createMessage()));
+    }
+    MailSpool spool(mDirectory.c_str(), 1);
+    ASSERT_EQ(0, spool.open());
+    ASSERT_EQ(2, spool.getPendingCount());
+    ASSERT_EQ(0, spool.enqueue(createMessage()));
+    ASSERT_EQ(3, spool.getPendingCount());
+    ASSERT_EQ(3, spool.getSegmentCount());
+}
+
+TEST_F(MailSpoolFixture, open_WithTornRecord_TruncateSegment) {
+    uintmax_t complete_size = 0;
+    {
+        MailSpool spool(mDirectory.c_str());
+        ASSERT_EQ(0, spool.enqueue(createMessage()));
+        complete_size = std::filesystem::file_size(getFirstSegmentPath());
+        ASSERT_EQ(0, spool.enqueue(createMessage()));
+    }
+    const std::string segment_path = getFirstSegmentPath();
+    std::filesystem::resize_file(segment_path, std::filesystem::file_size(segment_path) - 10);
+    MailSpool spool(mDirectory.c_str());
+    ASSERT_EQ(0, spool.open());
+    ASSERT_EQ(1, spool.getPendingCount());
+    ASSERT_EQ(complete_size, std::filesystem::file_size(segment_path));
+}
+
+TEST_F(MailSpoolFixture, open_WithCorruptedRecord_DropFollowingRecords) {
+    {
+        MailSpool spool(mDirectory.c_str());
+        ASSERT_EQ(0, spool.enqueue(createMessage()));
+        ASSERT_EQ(0, spool.enqueue(createMessage()));
+    }
+    const std::string segment_path = getFirstSegmentPath();
+    {
+        // Change a byte of the content of the first record
+        std::fstream file(segment_path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(40);
+        file.put('#');
+    }
+    MailSpool spool(mDirectory.c_str());
+    ASSERT_EQ(0, spool.open());
+    ASSERT_EQ(0, spool.getPendingCount());
+    ASSERT_EQ(0, spool.getSegmentCount());
+}
+
+TEST_F(MailSpoolFixture, deliverNext_WithCorruptPayload_DropRecordAndDeliverNextOnes) {
+    MailSpool spool(mDirectory.c_str());
+    ASSERT_EQ(0, spool.enqueue(createMessage()));
+    ASSERT_EQ(0, spool.enqueue(createMessage()));
+    {
+        // Give the sender of the first record a length past the end of the
+        // payload, the checksum is only verified when the spool is opened
+        std::fstream file(getFirstSegmentPath(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(16);
+        file.write("\xFF\xFF\xFF\x7F", 4);
+    }
+    SmtpClient client("127.0.0.1", 1);
+    client.setCommandTimeout(1);
+    ASSERT_EQ(CLIENT_SPOOL_CORRUPT_RECORD_ERROR, spool.deliverNext(client));
+    ASSERT_EQ(1, spool.getPendingCount());
+    ASSERT_TRUE(MailQueue::isTransientError(spool.deliverNext(client)));
+    ASSERT_EQ(1, spool.getPendingCount());
+}
+
+TEST_F(MailSpoolFixture, deliverAll_WithCorruptRecordCount_SkipRecord) {
+    MailSpool spool(mDirectory.c_str());
+    ASSERT_EQ(0, spool.enqueue(createMessage()));
+    ASSERT_EQ(0, spool.enqueue(createMessage()));
+    {
+        // The recipient count follows the sender "from@test.com"
+        std::fstream file(getFirstSegmentPath(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(16 + 4 + 13);
+        file.write("\xFF\xFF\xFF\xFF", 4);
+    }
+    SmtpClient client("127.0.0.1", 1);
+    client.setCommandTimeout(1);
+    ASSERT_EQ(1, spool.deliverAll(client));
+    ASSERT_EQ(1, spool.getPendingCount());
+}
+
+TEST_F(MailSpoolFixture, deliverNext_WithTruncatedSegment_DropRecord) {
+    MailSpool spool(mDirectory.c_str());
+    ASSERT_EQ(0, spool.enqueue(createMessage()));
+    std::filesystem::resize_file(getFirstSegmentPath(), 20);
+    SmtpClient client("127.0.0.1", 1);
+    ASSERT_EQ(CLIENT_SPOOL_CORRUPT_RECORD_ERROR, spool.deliverNext(client));
+    ASSERT_EQ(0, spool.getPendingCount());
+}
+
+TEST_F(MailSpoolFixture, deliverNext_WithRemovedSegment_KeepRecord) {
+    MailSpool spool(mDirectory.c_str());
+    ASSERT_EQ(0, spool.enqueue(createMessage()));
+    std::filesystem::remove(getFirstSegmentPath());
+    SmtpClient client("127.0.0.1", 1);
+    ASSERT_EQ(CLIENT_SPOOL_IO_ERROR, spool.deliverNext(client));
+    ASSERT_EQ(1, spool.getPendingCount());
+    ASSERT_EQ(0, spool.deliverAll(client));
+    ASSERT_EQ(1, spool.getPendingCount());
+}
+
+TEST_F(MailSpoolFixture, deliverNext_WithEmptySpool_ReturnEmptyError) {
+    MailSpool spool(mDirectory.c_str());
+    SmtpClient client("127.0.0.1", 1);
+    ASSERT_EQ(CLIENT_SPOOL_EMPTY_ERROR, spool.deliverNext(client));
+}
+
+TEST_F(MailSpoolFixture, deliverNext_WithUnreachableServer_KeepRecord) {
+    MailSpool spool(mDirectory.c_str());
+    ASSERT_EQ(0, spool.enqueue(createMessage()));
+    SmtpClient client("127.0.0.1", 1);
+    client.setCommandTimeout(1);
+    ASSERT_TRUE(MailQueue::isTransientError(spool.deliverNext(client)));
+    ASSERT_EQ(1, spool.getPendingCount());
+    ASSERT_EQ(0, spool.deliverAll(client));
+    ASSERT_EQ(1, spool.getPendingCount());
+}
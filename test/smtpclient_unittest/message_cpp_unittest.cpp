@@ -137,5 +137,12 @@ TEST(Message_MoveAssignment, MessageMoveAssignmentValid) {
     validateFakeMessageSample2(msg2);
 }
 
+TEST(Message_getSubjectView, WithSubject_ReturnSubject) {
+    auto msg = getFakeMessageSample1();
+    ASSERT_EQ("Subject", msg.getSubjectView());
+    ASSERT_EQ("from@from.com", msg.getFrom().getEmailAddressView());
+    ASSERT_EQ("", msg.getFrom().getDisplayNameView());
+}
+
 }  // namespace cpp_message
 }  // namespace jed_utils_unittest
@@ -161,3 +161,61 @@ TEST(Message_MoveAssignment, MessageMoveAssignmentValid) {
     msg2 = std::move(msg1);
     validateFakeMessageSample2(msg2);
 }
+
+TEST(Message_getSubjectView, WithSubjectAndBody_ReturnSubject) {
+    FakeMessage msg(MessageAddress("test@test.com"), MessageAddress("test2@test.com"), "Subject", "Body");
+    ASSERT_EQ("Subject", msg.getSubjectView());
+    ASSERT_EQ(msg.getSubject(), msg.getSubjectView().data());
+}
+
+TEST(Message_getBodyView, WithSubjectAndBody_ReturnBody) {
+    FakeMessage msg(MessageAddress("test@test.com"), MessageAddress("test2@test.com"), "Subject", "Body\r\nLine 2");
+    ASSERT_EQ("Body\r\nLine 2", msg.getBodyView());
+    ASSERT_EQ(msg.getBody(), msg.getBodyView().data());
+}
+
+TEST(Message_getBodyView, WithNullSubjectAndBody_ReturnEmpty) {
+    FakeMessage msg(MessageAddress("test@test.com"), MessageAddress("test2@test.com"), nullptr, nullptr);
+    ASSERT_EQ("", msg.getSubjectView());
+    ASSERT_EQ("", msg.getBodyView());
+}
+
+TEST(Message_getBodyView, AfterMove_ReturnEmptySource) {
+    auto msg1 = getFakeMessageSample1();
+    FakeMessage msg2(std::move(msg1));
+    ASSERT_EQ("Body", msg2.getBodyView());
+    ASSERT_EQ("", msg1.getBodyView());
+    ASSERT_EQ(0, msg1.getToCount());
+    ASSERT_EQ(nullptr, msg1.getTo());
+}
+
+TEST(Message_CopyConstructor, WithCopy_RecipientsAreSharedAndAttachmentsIndependent) {
+    auto msg1 = getFakeMessageSample2();
+    FakeMessage msg2(msg1);
+    // The recipients cannot be modified, the copies share them
+    ASSERT_EQ(&msg1.getRecipients(), &msg2.getRecipients());
+    ASSERT_EQ(msg1.getTo()[0], msg2.getTo()[0]);
+    ASSERT_NE(msg1.getAttachments()[0], msg2.getAttachments()[0]);
+    ASSERT_STREQ(msg1.getCc()[1]->getEmailAddress(), msg2.getCc()[1]->getEmailAddress());
+}
+
+TEST(Message_getRecipients, WithToCcAndBcc_ReturnRecipientsInOrder) {
+    const MessageAddress to[] { MessageAddress("to1@test.com", "To One"), MessageAddress("to2@test.com") };
+    const MessageAddress cc[] { MessageAddress("cc@test.com") };
+    const MessageAddress bcc[] { MessageAddress("bcc@test.com", "Hidden") };
+    FakeMessage msg(MessageAddress("from@test.com"), to, 2, "Subject", "Body", cc, 1, bcc, 1);
+    const RecipientTable &recipients = msg.getRecipients();
+    ASSERT_EQ(4U, recipients.size());
+    ASSERT_STREQ("to1@test.com", recipients.getEmailAddress(0));
+    ASSERT_STREQ("To One", recipients.getDisplayName(0));
+    ASSERT_STREQ("cc@test.com", recipients.getEmailAddress(msg.getToCount()));
+    ASSERT_STREQ("bcc@test.com", recipients.getEmailAddress(msg.getToCount() + msg.getCcCount()));
+    ASSERT_STREQ("Hidden", msg.getBcc()[0]->getDisplayName());
+}
+
+TEST(Message_getRecipients, AfterMove_ReturnEmptySource) {
+    auto msg1 = getFakeMessageSample2();
+    FakeMessage msg2(std::move(msg1));
+    ASSERT_TRUE(msg1.getRecipients().empty());
+    ASSERT_FALSE(msg2.getRecipients().empty());
+}
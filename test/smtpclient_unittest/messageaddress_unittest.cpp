@@ -8,7 +8,7 @@ using namespace jed_utils;
 template <typename T>
 class MultiMessageAddressFixture : public ::testing::Test {
  public:
-    MultiMessageAddressFixture<T>()
+    MultiMessageAddressFixture()
         : msg_add("test@domain", "Test Address") {
     }
     T msg_add;
@@ -0,0 +1,97 @@
+#include "../../src/cpp/messagebuilder.hpp"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace jed_utils::cpp;
+
+namespace jed_utils_unittest {
+namespace cpp_messagebuilder {
+
+TEST(MessageBuilder_buildPlaintextMessage, WithAllParts_ReturnMessage) {
+    PlaintextMessage msg = MessageBuilder()
+        .setFrom(MessageAddress("from@from.com"))
+        .addRecipient(MessageAddress("to1@to.com"))
+        .addRecipient(MessageAddress("cc1@cc.com"), RecipientType::Cc)
+        .addRecipient(MessageAddress("bcc1@bcc.com"), RecipientType::Bcc)
+        .addRecipients({ MessageAddress("to2@to.com"), MessageAddress("to3@to.com") })
+        .addAttachment(Attachment("file1.png"))
+        .setSubject("Subject")
+        .setBody("Body")
+        .buildPlaintextMessage();
+    ASSERT_EQ("from@from.com", msg.getFrom().getEmailAddress());
+    ASSERT_EQ(3, msg.getToCount());
+    ASSERT_EQ("to1@to.com", msg.getTo()[0].getEmailAddress());
+    ASSERT_EQ("to3@to.com", msg.getTo()[2].getEmailAddress());
+    ASSERT_EQ(1, msg.getCcCount());
+    ASSERT_EQ("cc1@cc.com", msg.getCc()[0].getEmailAddress());
+    ASSERT_EQ(1, msg.getBccCount());
+    ASSERT_EQ("bcc1@bcc.com", msg.getBcc()[0].getEmailAddress());
+    ASSERT_EQ(1, msg.getAttachmentsCount());
+    ASSERT_EQ("Subject", msg.getSubject());
+    ASSERT_EQ("Body", msg.getBody());
+    ASSERT_EQ("text/plain", msg.getMimeType());
+}
+
+TEST(MessageBuilder_buildHTMLMessage, WithRequiredParts_ReturnHtmlMessage) {
+    HTMLMessage msg = MessageBuilder()
+        .setFrom(MessageAddress("from@from.com"))
+        .addRecipient(MessageAddress("to@to.com"))
+        .setBody("<p>Body</p>")
+        .buildHTMLMessage();
+    ASSERT_EQ("text/html", msg.getMimeType());
+    ASSERT_EQ("<p>Body</p>", msg.getBody());
+    ASSERT_EQ("", msg.getSubject());
+    ASSERT_EQ(0, msg.getCcCount());
+}
+
+TEST(MessageBuilder_buildPlaintextMessage, WithoutFrom_ThrowInvalidArgument) {
+    MessageBuilder builder;
+    builder.addRecipient(MessageAddress("to@to.com"));
+    try {
+        builder.buildPlaintextMessage();
+        FAIL();
+    }
+    catch(std::invalid_argument &err) {
+        ASSERT_STREQ("From cannot be empty", err.what());
+    }
+}
+
+TEST(MessageBuilder_buildPlaintextMessage, WithoutTo_ThrowInvalidArgument) {
+    MessageBuilder builder;
+    builder.setFrom(MessageAddress("from@from.com"))
+        .addRecipient(MessageAddress("cc@cc.com"), RecipientType::Cc);
+    try {
+        builder.buildPlaintextMessage();
+        FAIL();
+    }
+    catch(std::invalid_argument &err) {
+        ASSERT_STREQ("To cannot be empty", err.what());
+    }
+}
+
+TEST(MessageBuilder_buildPlaintextMessage, CalledTwice_SecondCallThrowsSinceBuilderIsEmpty) {
+    MessageBuilder builder;
+    builder.setFrom(MessageAddress("from@from.com"))
+        .addRecipient(MessageAddress("to@to.com"));
+    builder.buildPlaintextMessage();
+    ASSERT_THROW(builder.buildPlaintextMessage(), std::invalid_argument);
+}
+
+TEST(MessageBuilder_setBody, WithMovedBody_StdMessageSharesBody) {
+    std::string body(100000, 'x');
+    const char *body_data = body.data();
+    HTMLMessage msg = MessageBuilder()
+        .setFrom(MessageAddress("from@from.com"))
+        .addRecipient(MessageAddress("to@to.com"))
+        .setBody(std::move(body))
+        .buildHTMLMessage();
+    const jed_utils::HTMLMessage &std_msg = msg;
+    ASSERT_EQ(body_data, msg.getBody().data());
+    ASSERT_EQ(body_data, std_msg.getBody());
+}
+
+}  // namespace cpp_messagebuilder
+}  // namespace jed_utils_unittest
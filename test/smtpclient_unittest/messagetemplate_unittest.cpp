@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include "../../src/messagetemplate.h"
+#include "../../src/smtpclienterrors.h"
+
+using namespace jed_utils;
+
+TEST(MessageTemplate_Constructor, WithMergeFields_ReturnFieldNames) {
+    MessageTemplate message_template("To: {{Email}}\r\n\r\nHello {{Name}}, {{Name}}");
+    ASSERT_EQ(3U, message_template.getFieldCount());
+    ASSERT_EQ("Email", message_template.getFieldName(0));
+    ASSERT_EQ("Name", message_template.getFieldName(1));
+    ASSERT_EQ("Name", message_template.getFieldName(2));
+    ASSERT_EQ("", message_template.getFieldName(3));
+}
+
+TEST(MessageTemplate_Constructor, WithUnmatchedOrEmptyBraces_KeepLiteralText) {
+    MessageTemplate message_template("{{}} {{a\r\nb}} {{{Name}} {{open");
+    ASSERT_EQ(1U, message_template.getFieldCount());
+    ASSERT_EQ("Name", message_template.getFieldName(0));
+    RenderedTemplate rendered;
+    ASSERT_EQ(0, message_template.render({ { "Name", "N" } }, rendered));
+    ASSERT_EQ("{{}} {{a\r\nb}} {N {{open", rendered.toString());
+}
+
+TEST(MessageTemplate_render, WithAllFields_ReturnSubstitutedContent) {
+    MessageTemplate message_template("Hello {{Name}}, your code is {{Code}}.");
+    RenderedTemplate rendered;
+    ASSERT_EQ(0, message_template.render({ { "Name", "Alice" }, { "Code", "1234" } }, rendered));
+    ASSERT_EQ("Hello Alice, your code is 1234.", rendered.toString());
+    ASSERT_EQ(rendered.toString().size(), rendered.getSize());
+    // The literal segments refer to the template
+    ASSERT_EQ(5U, rendered.getSegmentCount());
+    ASSERT_EQ(message_template.getContent().data(), rendered.getSegments()[0].data());
+}
+
+TEST(MessageTemplate_render, WithReusedOutput_ReplacePreviousContent) {
+    MessageTemplate message_template("{{Greeting}} {{Name}}");
+    RenderedTemplate rendered;
+    ASSERT_EQ(0, message_template.render({ { "Greeting", "Good morning" }, { "Name", "Alice" } }, rendered));
+    ASSERT_EQ(0, message_template.render({ { "Greeting", "Hi" }, { "Name", "" } }, rendered));
+    ASSERT_EQ("Hi ", rendered.toString());
+    ASSERT_EQ(3U, rendered.getSize());
+}
+
+TEST(MessageTemplate_render, WithMissingField_ReturnTemplateFieldError) {
+    MessageTemplate message_template("Hello {{Name}}");
+    RenderedTemplate rendered;
+    ASSERT_EQ(CLIENT_TEMPLATE_FIELD_ERROR, message_template.render({ { "Other", "value" } }, rendered));
+    ASSERT_EQ(0U, rendered.getSegmentCount());
+    ASSERT_EQ(0U, rendered.getSize());
+}
+
+TEST(MessageTemplate_render, WithoutFields_ReturnContent) {
+    MessageTemplate message_template("Subject: Static\r\n\r\nBody");
+    RenderedTemplate rendered;
+    ASSERT_EQ(0, message_template.render({}, rendered));
+    ASSERT_EQ(0U, message_template.getFieldCount());
+    ASSERT_EQ("Subject: Static\r\n\r\nBody", rendered.toString());
+}
+
+TEST(MessageTemplate_CopyConstructor, WithCopy_RenderFromOwnContent) {
+    auto *original = new MessageTemplate("Hello {{Name}}");
+    MessageTemplate copy(*original);
+    delete original;
+    RenderedTemplate rendered;
+    ASSERT_EQ(0, copy.render({ { "Name", "Bob" } }, rendered));
+    ASSERT_EQ("Hello Bob", rendered.toString());
+}
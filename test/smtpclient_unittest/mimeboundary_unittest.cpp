@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "../../src/mimeboundary.h"
+
+using namespace jed_utils;
+
+TEST(MimeBoundary_Constructor, NewBoundary_ReturnGeneratedValue) {
+    const MimeBoundary boundary;
+    ASSERT_EQ(MimeBoundary::GENERATED_LENGTH, boundary.getValue().size());
+    ASSERT_EQ("=_", boundary.getValue().substr(0, 2));
+    ASSERT_EQ(std::string::npos, boundary.getValue().find_first_not_of(
+                "=_.ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789"));
+}
+
+TEST(MimeBoundary_Constructor, WithValue_ReturnDelimiters) {
+    const MimeBoundary boundary("sep");
+    ASSERT_EQ("sep", boundary.getValue());
+    ASSERT_EQ("--sep", boundary.getDelimiter());
+    ASSERT_EQ("\r\n--sep--", boundary.getClosingDelimiter());
+}
+
+TEST(MimeBoundary_Constructor, WithInvalidValue_ThrowInvalidArgument) {
+    ASSERT_THROW(MimeBoundary(""), std::invalid_argument);
+    ASSERT_THROW(MimeBoundary(std::string(71, 'a')), std::invalid_argument);
+    ASSERT_EQ(70U, MimeBoundary(std::string(70, 'a')).getValue().size());
+}
+
+TEST(MimeBoundary_generate, CalledRepeatedly_ReturnDistinctValues) {
+    MimeBoundary boundary;
+    std::set<std::string> values;
+    for (int index = 0; index < 1000; index++) {
+        boundary.generate();
+        values.emplace(boundary.getValue());
+    }
+    ASSERT_EQ(1000U, values.size());
+}
+
+TEST(MimeBoundary_generate, OnSeveralThreads_ReturnDistinctValues) {
+    std::string first;
+    std::string second;
+    std::thread first_thread([&first]() { first = MimeBoundary().getValue(); });
+    std::thread second_thread([&second]() { second = MimeBoundary().getValue(); });
+    first_thread.join();
+    second_thread.join();
+    ASSERT_NE(first, second);
+}
+
+TEST(MimeBoundary_generate, WithBodyContainingPrefix_ReturnValueAbsentFromBody) {
+    MimeBoundary boundary;
+    std::string body;
+    for (int index = 0; index < 100; index++) {
+        body += "a=_b ==_ --";
+        body += MimeBoundary().getValue();
+    }
+    for (int index = 0; index < 100; index++) {
+        boundary.generate(body);
+        ASSERT_EQ(std::string::npos, body.find(boundary.getValue()));
+    }
+}
+
+TEST(MimeBoundary_copy, CopiedBoundary_ReturnSameDelimiters) {
+    const MimeBoundary boundary;
+    MimeBoundary copy("sep");
+    copy = boundary;
+    ASSERT_EQ(boundary.getValue(), copy.getValue());
+    ASSERT_EQ(boundary.getClosingDelimiter(), copy.getClosingDelimiter());
+    ASSERT_NE(boundary.getValue().data(), copy.getValue().data());
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include "../../src/attachment.h"
+#include "../../src/mimetypes.h"
+
+using namespace jed_utils;
+
+class MimeTypesFixture : public ::testing::Test {
+ public:
+    void TearDown() override {
+        MimeTypes::clearRegisteredMimeTypes();
+    }
+};
+
+TEST_F(MimeTypesFixture, find_KnownExtension_ReturnType) {
+    ASSERT_STREQ("application/pdf", MimeTypes::find("pdf"));
+    ASSERT_STREQ("video/x-msvideo", MimeTypes::find("avi"));
+    ASSERT_STREQ("application/zip", MimeTypes::find("zip"));
+}
+
+TEST_F(MimeTypesFixture, find_AnyCase_ReturnType) {
+    ASSERT_STREQ("image/png", MimeTypes::find("PNG"));
+    ASSERT_STREQ("image/png", MimeTypes::find("Png"));
+}
+
+TEST_F(MimeTypesFixture, find_UnknownOrPartialExtension_ReturnEmpty) {
+    ASSERT_STREQ("", MimeTypes::find(""));
+    ASSERT_STREQ("", MimeTypes::find("json"));
+    ASSERT_STREQ("", MimeTypes::find("pn"));
+    ASSERT_STREQ("", MimeTypes::find("pngx"));
+}
+
+TEST_F(MimeTypesFixture, registerMimeType_NewExtension_ReturnRegisteredType) {
+    MimeTypes::registerMimeType(".json", "application/json");
+    ASSERT_STREQ("application/json", MimeTypes::find("JSON"));
+    ASSERT_STREQ("application/json", Attachment("data.json", "data.json").getMimeType());
+}
+
+TEST_F(MimeTypesFixture, registerMimeType_KnownExtension_OverrideType) {
+    MimeTypes::registerMimeType("js", "text/javascript");
+    ASSERT_STREQ("text/javascript", MimeTypes::find("js"));
+    MimeTypes::registerMimeType("JS", "application/x-javascript");
+    ASSERT_STREQ("application/x-javascript", MimeTypes::find("js"));
+}
+
+TEST_F(MimeTypesFixture, registerMimeType_EmptyExtensionOrType_ThrowInvalidArgument) {
+    ASSERT_THROW(MimeTypes::registerMimeType(".", "text/plain"), std::invalid_argument);
+    ASSERT_THROW(MimeTypes::registerMimeType("ext", ""), std::invalid_argument);
+}
+
+TEST_F(MimeTypesFixture, clearRegisteredMimeTypes_ReturnBuiltInType) {
+    MimeTypes::registerMimeType("pdf", "application/x-pdf");
+    MimeTypes::clearRegisteredMimeTypes();
+    ASSERT_STREQ("application/pdf", MimeTypes::find("pdf"));
+}
@@ -0,0 +1,309 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include "../../src/attachment.h"
+#include "../../src/attachmentsource.h"
+#include "../../src/base64.h"
+#include "../../src/cpp/plaintextmessage.hpp"
+#include "../../src/htmlmessage.h"
+#include "../../src/mimewriter.h"
+#include "../../src/plaintextmessage.h"
+#include "../../src/quotedprintable.h"
+#include "../../src/smtpclienterrors.h"
+
+using namespace jed_utils;
+
+namespace {
+PlaintextMessage createMessage(const Attachment *pAttachments = nullptr, size_t pAttachmentsSize = 0) {
+    const MessageAddress cc[] { MessageAddress("cc@test.com") };
+    return PlaintextMessage(MessageAddress("from@test.com"),
+            MessageAddress("to@test.com"),
+            "Subject",
+            "Body",
+            cc,
+            nullptr,
+            pAttachments,
+            pAttachmentsSize);
+}
+
+// Replace the boundary by @B, so that the content is compared with a
+// fixed text
+std::string maskBoundary(std::string_view pContent, const MimeBoundary &pBoundary) {
+    std::string masked { pContent };
+    const std::string_view boundary { pBoundary.getValue() };
+    for (size_t position = masked.find(boundary); position != std::string::npos; position = masked.find(boundary, position)) {
+        masked.replace(position, boundary.size(), "@B");
+    }
+    return masked;
+}
+
+const MimeBoundary SEP { "sep" };
+const char EXPECTED_HEADERS[] = "From: from@test.com\r\n"
+    "To: to@test.com\r\n"
+    "Cc: cc@test.com\r\n"
+    "Subject: Subject\r\n"
+    "Content-Type: multipart/mixed; boundary=\"@B\"\r\n\r\n";
+const char EXPECTED_BODY_PART[] = "--@B\r\nContent-Type: text/plain; charset=UTF-8\r\n\r\nBody\r\n";
+}  // namespace
+
+TEST(MimeWriter_Constructor, NewWriter_ReturnEmptyContent) {
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.getSize());
+    ASSERT_EQ(0, writer.getSegmentCount());
+    ASSERT_EQ("", writer.getContent());
+}
+
+TEST(MimeWriter_write, WithoutAttachment_ReturnHeadersBodyAndClosingDelimiter) {
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(createMessage()));
+    ASSERT_EQ(3, writer.getSegmentCount());
+    const MimeBoundary &boundary = writer.getBoundary();
+    ASSERT_EQ(EXPECTED_HEADERS, maskBoundary(writer.getSegment(0), boundary));
+    ASSERT_EQ(EXPECTED_BODY_PART, maskBoundary(writer.getSegment(1), boundary));
+    ASSERT_EQ("\r\n--@B--", maskBoundary(writer.getSegment(2), boundary));
+    ASSERT_EQ(std::string(EXPECTED_HEADERS) + EXPECTED_BODY_PART + "\r\n--@B--", maskBoundary(writer.getContent(), boundary));
+    ASSERT_EQ(writer.getContent().size(), writer.getSize());
+}
+
+TEST(MimeWriter_write, WithRecipient_ReturnOnlyThisRecipientInHeaders) {
+    MimeWriter writer;
+    MessageAddress recipient("other@test.com");
+    ASSERT_EQ(0, writer.write(createMessage(), &recipient));
+    ASSERT_EQ("From: from@test.com\r\n"
+            "To: other@test.com\r\n"
+            "Subject: Subject\r\n"
+            "Content-Type: multipart/mixed; boundary=\"@B\"\r\n\r\n", maskBoundary(writer.getSegment(0), writer.getBoundary()));
+}
+
+TEST(MimeWriter_write, WithSeveralToRecipients_ReturnSingleFoldedToHeader) {
+    const MessageAddress to[] {
+        MessageAddress("first.recipient@test.com"),
+        MessageAddress("second.recipient@test.com"),
+        MessageAddress("third.recipient@test.com")
+    };
+    PlaintextMessage msg(MessageAddress("from@test.com"), to, 3, "Subject", "Body");
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(msg));
+    ASSERT_EQ("From: from@test.com\r\n"
+            "To: first.recipient@test.com, second.recipient@test.com,\r\n"
+            " third.recipient@test.com\r\n"
+            "Subject: Subject\r\n"
+            "Content-Type: multipart/mixed; boundary=\"@B\"\r\n\r\n", maskBoundary(writer.getSegment(0), writer.getBoundary()));
+}
+
+TEST(MimeWriter_write, WithUtf8Subject_ReturnEncodedWordSubject) {
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Caf\xC3\xA9", "Body");
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(msg));
+    ASSERT_NE(std::string::npos, writer.getSegment(0).find("\r\nSubject: =?UTF-8?B?Q2Fmw6k=?=\r\n"));
+}
+
+TEST(MimeWriter_appendHeaders, WithExistingContent_AppendHeadersOfWrite) {
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(createMessage()));
+    std::string output { "prefix" };
+    MimeWriter::appendHeaders(createMessage(), writer.getBoundary(), nullptr, output);
+    ASSERT_EQ("prefix" + std::string(writer.getSegment(0)), output);
+}
+
+TEST(MimeWriter_write, WithHtmlMessage_ReturnHtmlBodyPart) {
+    MimeWriter writer;
+    HTMLMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "<p>Body</p>");
+    ASSERT_EQ(0, writer.write(msg));
+    ASSERT_EQ("--@B\r\nContent-Type: text/html; charset=UTF-8\r\n\r\n<p>Body</p>\r\n", maskBoundary(writer.getSegment(1), writer.getBoundary()));
+}
+
+TEST(MimeWriter_write, WithBareLineFeedsInBody_ReturnCRLFWithoutDotStuffing) {
+    MimeWriter writer;
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Line 1\n.Line 2");
+    ASSERT_EQ(0, writer.write(msg));
+    ASSERT_EQ("--@B\r\nContent-Type: text/plain; charset=UTF-8\r\n\r\nLine 1\r\n.Line 2\r\n", maskBoundary(writer.getSegment(1), writer.getBoundary()));
+}
+
+TEST(MimeWriter_write, WithAttachment_ReturnEncodedAttachmentSegment) {
+    const char *filename = "mimewriter_unittest_attachment.txt";
+    std::ofstream(filename, std::ios::binary) << "Hello";
+    const Attachment attachments[] { Attachment(filename, "hello.txt") };
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(createMessage(attachments, 1)));
+    ASSERT_EQ(4, writer.getSegmentCount());
+    ASSERT_EQ(MimeWriter::createAttachmentHeader(attachments[0], writer.getBoundary()) + "SGVsbG8=", writer.getSegment(2));
+    std::remove(filename);
+}
+
+TEST(MimeWriter_write, WithMissingAttachmentFile_ReturnEmptyAttachment) {
+    const Attachment attachments[] { Attachment("mimewriter_unittest_missing.txt", "missing.txt") };
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(createMessage(attachments, 1)));
+    ASSERT_EQ(MimeWriter::createAttachmentHeader(attachments[0], writer.getBoundary()), writer.getSegment(2));
+}
+
+TEST(MimeWriter_write, CalledTwice_ReplacePreviousContent) {
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(createMessage()));
+    const size_t size = writer.getSize();
+    ASSERT_EQ(0, writer.write(createMessage()));
+    ASSERT_EQ(size, writer.getSize());
+    ASSERT_EQ(3, writer.getSegmentCount());
+}
+
+TEST(MimeWriter_write, WithCppMessage_ReturnSameContentAsStdMessage) {
+    cpp::PlaintextMessage msg(cpp::MessageAddress("from@test.com"),
+            { cpp::MessageAddress("to@test.com") },
+            "Subject",
+            "Body",
+            { cpp::MessageAddress("cc@test.com") });
+    MimeWriter cpp_writer;
+    ASSERT_EQ(0, cpp_writer.write(msg));
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(createMessage()));
+    ASSERT_EQ(maskBoundary(writer.getContent(), writer.getBoundary()), maskBoundary(cpp_writer.getContent(), cpp_writer.getBoundary()));
+}
+
+TEST(MimeWriter_write, CalledTwice_GenerateNewBoundary) {
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(createMessage()));
+    const std::string first_boundary { writer.getBoundary().getValue() };
+    ASSERT_EQ(0, writer.write(createMessage()));
+    ASSERT_NE(first_boundary, writer.getBoundary().getValue());
+}
+
+TEST(MimeWriter_write, WithBodyContainingPreviousBoundary_ReturnBoundaryAbsentFromBody) {
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(createMessage()));
+    const std::string body { "--" + std::string(writer.getBoundary().getValue()) + "\r\n=_" };
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", body.c_str());
+    ASSERT_EQ(0, writer.write(msg));
+    ASSERT_EQ(std::string::npos, body.find(writer.getBoundary().getValue()));
+    ASSERT_NE(std::string::npos, writer.getSegment(0).find("boundary=\"" + std::string(writer.getBoundary().getValue()) + "\""));
+}
+
+TEST(MimeWriter_computeSize, WithoutAttachment_ReturnRenderedSize) {
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(createMessage()));
+    ASSERT_EQ(writer.getSize(), MimeWriter::computeSize(createMessage(), writer.getBoundary()));
+}
+
+TEST(MimeWriter_computeSize, WithBareLineFeedsAndDotsInBody_ReturnRenderedSize) {
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "\nLine 1\n.Line 2\r\nLine 3\n");
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(msg));
+    ASSERT_EQ(writer.getSize(), MimeWriter::computeSize(msg, writer.getBoundary()));
+}
+
+TEST(MimeWriter_computeSize, WithAttachments_ReturnRenderedSize) {
+    const Attachment attachments[] {
+        Attachment(std::make_shared<BufferAttachmentSource>(std::string(1000, 'x')), "report.csv"),
+        Attachment(std::make_shared<BufferAttachmentSource>(std::string(57, 'y')), "small.txt")
+    };
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(createMessage(attachments, 2)));
+    ASSERT_EQ(writer.getSize(), MimeWriter::computeSize(createMessage(attachments, 2), writer.getBoundary()));
+}
+
+TEST(MimeWriter_computeSize, WithRecipientAndBinaryAttachment_ReturnSentSize) {
+    const Attachment attachments[] {
+        Attachment(std::make_shared<BufferAttachmentSource>(std::string(1000, 'x')), "report.csv")
+    };
+    MessageAddress recipient("other@test.com");
+    const PlaintextMessage msg = createMessage(attachments, 1);
+    size_t expected = 0;
+    for (const auto &line : MimeWriter::createHeaderLines(msg, SEP, &recipient)) {
+        expected += line.first.size();
+    }
+    expected += MimeWriter::createBodyPartHeader(msg, SEP, "8bit").size() + strlen("Body\r\n") +
+        MimeWriter::createAttachmentHeader(attachments[0], SEP, "binary").size() + 1000 +
+        SEP.getClosingDelimiter().size();
+    ASSERT_EQ(expected, MimeWriter::computeSize(msg, SEP, &recipient, "8bit", true));
+}
+
+TEST(MimeWriter_createBodyPartHeader, WithTransferEncoding_ReturnEncodingField) {
+    ASSERT_EQ("--sep\r\nContent-Type: text/plain; charset=UTF-8\r\nContent-Transfer-Encoding: 8bit\r\n\r\n",
+            MimeWriter::createBodyPartHeader(createMessage(), SEP, "8bit"));
+}
+
+TEST(MimeWriter_createAttachmentHeader, WithBinaryEncoding_ReturnBinaryField) {
+    Attachment attachment("file.png", "file.png");
+    ASSERT_NE(std::string::npos, MimeWriter::createAttachmentHeader(attachment, SEP, "binary").find("Content-Transfer-Encoding: binary\r\n\r\n"));
+    ASSERT_NE(std::string::npos, MimeWriter::createAttachmentHeader(attachment, SEP).find("Content-Transfer-Encoding: base64\r\n\r\n"));
+}
+
+TEST(MimeWriter_containsEightBitData, WithAsciiMessage_ReturnFalse) {
+    ASSERT_FALSE(MimeWriter::containsEightBitData(createMessage()));
+}
+
+TEST(MimeWriter_containsEightBitData, WithUtf8Body_ReturnTrue) {
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Caf\xC3\xA9");
+    ASSERT_TRUE(MimeWriter::containsEightBitData(msg));
+}
+
+TEST(MimeWriter_containsEightBitData, WithUtf8Subject_ReturnTrue) {
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Caf\xC3\xA9", "Body");
+    ASSERT_TRUE(MimeWriter::containsEightBitData(msg));
+}
+
+TEST(MimeWriter_clear, WithContent_ReturnEmptyContent) {
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(createMessage()));
+    writer.clear();
+    ASSERT_EQ(0, writer.getSize());
+    ASSERT_EQ(0, writer.getSegmentCount());
+}
+
+TEST(MimeWriter_getSegment, WithOutOfRangeIndex_ReturnEmpty) {
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(createMessage()));
+    ASSERT_EQ("", writer.getSegment(3));
+}
+
+TEST(MimeWriter_write, WithBufferAttachment_ReturnEncodedAttachmentSegment) {
+    const Attachment attachments[] { Attachment(std::make_shared<BufferAttachmentSource>("Hello"), "hello.txt") };
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(createMessage(attachments, 1)));
+    ASSERT_EQ(4, writer.getSegmentCount());
+    ASSERT_EQ(MimeWriter::createAttachmentHeader(attachments[0], writer.getBoundary()) + "SGVsbG8=", writer.getSegment(2));
+}
+
+TEST(MimeWriter_write, WithTextAttachmentEncoding_ReturnSevenBitTextAttachment) {
+    const Attachment attachments[] { Attachment(std::make_shared<BufferAttachmentSource>("Hello\nWorld"), "hello.txt") };
+    MimeWriter writer;
+    writer.setTextAttachmentEncodingEnabled(true);
+    ASSERT_EQ(0, writer.write(createMessage(attachments, 1)));
+    ASSERT_EQ(MimeWriter::createAttachmentHeader(attachments[0], writer.getBoundary(), "7bit") + "Hello\r\nWorld", writer.getSegment(2));
+}
+
+TEST(MimeWriter_selectAttachmentEncoding, WithMostlyAsciiText_ReturnQuotedPrintable) {
+    const char content[] = "id;name;price\n1;Caf\xC3\xA9;10\n2;Tea;8\n";
+    const Attachment attachment(std::make_shared<BufferAttachmentSource>(content), "prices.csv");
+    size_t encoded_size = 0;
+    ASSERT_EQ(TransferEncoding::QuotedPrintable, MimeWriter::selectAttachmentEncoding(attachment, &encoded_size));
+    ASSERT_EQ("id;name;price\r\n1;Caf=C3=A9;10\r\n2;Tea;8\r\n", QuotedPrintableEncoder::encodeAll(content));
+    ASSERT_EQ(QuotedPrintableEncoder::encodeAll(content).size(), encoded_size);
+}
+
+TEST(MimeWriter_selectAttachmentEncoding, WithMostlyEightBitText_ReturnBase64) {
+    const Attachment attachment(std::make_shared<BufferAttachmentSource>(std::string(300, '\xE9')), "latin1.txt");
+    ASSERT_EQ(TransferEncoding::Base64, MimeWriter::selectAttachmentEncoding(attachment));
+}
+
+TEST(MimeWriter_selectAttachmentEncoding, WithBinaryType_ReturnBase64) {
+    const Attachment attachment(std::make_shared<BufferAttachmentSource>("plain text"), "image.png");
+    size_t encoded_size = 0;
+    ASSERT_EQ(TransferEncoding::Base64, MimeWriter::selectAttachmentEncoding(attachment, &encoded_size));
+    ASSERT_EQ(Base64::EncodedLength(10), encoded_size);
+}
+
+TEST(MimeWriter_computeSize, WithTextAttachmentEncoding_ReturnWrittenSize) {
+    const Attachment attachments[] {
+        Attachment(std::make_shared<BufferAttachmentSource>("a=b\n" + std::string(500, 'c')), "data.log"),
+        Attachment(std::make_shared<BufferAttachmentSource>("Hello"), "hello.txt")
+    };
+    const PlaintextMessage msg = createMessage(attachments, 2);
+    MimeWriter writer;
+    writer.setTextAttachmentEncodingEnabled(true);
+    ASSERT_EQ(0, writer.write(msg));
+    ASSERT_NE(std::string::npos, writer.getSegment(2).find("Content-Transfer-Encoding: quoted-printable\r\n"));
+    ASSERT_EQ(writer.getSize(), MimeWriter::computeSize(msg, writer.getBoundary(), nullptr, nullptr, false, true));
+}
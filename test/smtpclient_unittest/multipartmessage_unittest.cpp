@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../../src/attachmentsource.h"
+#include "../../src/encodedattachmentcache.h"
+#include "../../src/mimewriter.h"
+#include "../../src/multipartmessage.h"
+
+using namespace jed_utils;
+
+namespace {
+MultipartMessage createMessage(const std::vector<InlineResource> &pInlineResources = {},
+        EncodedAttachmentCache *pCache = nullptr) {
+    return MultipartMessage(MessageAddress("from@test.com"),
+            { MessageAddress("to@test.com") },
+            "Subject",
+            "Hello",
+            "<p>Hello <img src=\"cid:logo@test.com\"></p>",
+            pInlineResources,
+            {},
+            {},
+            {},
+            pCache);
+}
+
+InlineResource createLogo() {
+    return InlineResource { Attachment(std::make_shared<BufferAttachmentSource>("PNG"), "logo.png"), "logo@test.com" };
+}
+}  // namespace
+
+TEST(MultipartMessage_Constructor, WithTextAndHtml_ReturnAlternativeBody) {
+    const MultipartMessage msg = createMessage();
+    ASSERT_EQ(0U, std::string_view(msg.getMimeType()).find("multipart/alternative; boundary=\"=_"));
+    ASSERT_EQ("Hello", msg.getTextBodyView());
+    ASSERT_EQ("<p>Hello <img src=\"cid:logo@test.com\"></p>", msg.getHtmlBodyView());
+    ASSERT_EQ(0U, msg.getInlineResourceCount());
+    const std::string body { msg.getBodyView() };
+    const size_t text_part = body.find("Content-Type: text/plain; charset=UTF-8\r\n\r\nHello\r\n--=_");
+    const size_t html_part = body.find("Content-Type: text/html; charset=UTF-8\r\n\r\n<p>");
+    ASSERT_NE(std::string::npos, text_part);
+    ASSERT_GT(html_part, text_part);
+    ASSERT_EQ(body.size() - 2, body.rfind("--"));
+}
+
+TEST(MultipartMessage_Constructor, WithInlineResource_ReturnRelatedBody) {
+    const MultipartMessage msg = createMessage({ createLogo() });
+    ASSERT_EQ(0U, std::string_view(msg.getMimeType()).find("multipart/related; type=\"multipart/alternative\"; boundary=\"=_"));
+    ASSERT_EQ(1U, msg.getInlineResourceCount());
+    const std::string body { msg.getBodyView() };
+    ASSERT_NE(std::string::npos, body.find("\r\nContent-Type: multipart/alternative; boundary=\"=_"));
+    ASSERT_NE(std::string::npos, body.find("Content-Type: image/png; name=\"logo.png\"\r\n"
+                "Content-ID: <logo@test.com>\r\n"
+                "Content-Disposition: inline; filename=\"logo.png\"\r\n"
+                "Content-Transfer-Encoding: base64\r\n\r\nUE5H\r\n--=_"));
+    ASSERT_EQ("Hello", msg.getTextBodyView());
+}
+
+TEST(MultipartMessage_Constructor, WithEightBitText_DeclareEightBitPart) {
+    const MultipartMessage msg(MessageAddress("from@test.com"), { MessageAddress("to@test.com") }, "Subject",
+            "Caf\xC3\xA9", "<p>Tea</p>");
+    const std::string body { msg.getBodyView() };
+    ASSERT_NE(std::string::npos, body.find("text/plain; charset=UTF-8\r\nContent-Transfer-Encoding: 8bit\r\n\r\nCaf"));
+    ASSERT_NE(std::string::npos, body.find("text/html; charset=UTF-8\r\n\r\n<p>Tea</p>"));
+}
+
+TEST(MultipartMessage_Constructor, WithInvalidContentId_ThrowInvalidArgument) {
+    InlineResource resource { createLogo() };
+    resource.ContentId = "logo\r\nBcc: x@test.com";
+    ASSERT_THROW(createMessage({ resource }), std::invalid_argument);
+    resource.ContentId = "";
+    ASSERT_THROW(createMessage({ resource }), std::invalid_argument);
+}
+
+TEST(MultipartMessage_Constructor, WithSharedCache_EncodeResourceOnce) {
+    EncodedAttachmentCache cache;
+    const InlineResource logo { createLogo() };
+    const MultipartMessage first = createMessage({ logo }, &cache);
+    const MultipartMessage second = createMessage({ logo }, &cache);
+    ASSERT_EQ(1U, cache.getMissCount());
+    ASSERT_EQ(1U, cache.getHitCount());
+    ASSERT_EQ(first.getBodyView().size(), second.getBodyView().size());
+}
+
+TEST(MultipartMessage_copy, CopiedMessage_ShareRenderedBody) {
+    const MultipartMessage msg = createMessage({ createLogo() });
+    const MultipartMessage copy { msg };
+    ASSERT_EQ(msg.getBodyView().data(), copy.getBodyView().data());
+    ASSERT_STREQ(msg.getMimeType(), copy.getMimeType());
+    ASSERT_EQ("Hello", copy.getTextBodyView());
+}
+
+TEST(MultipartMessage_MimeWriter, WithAttachment_ReturnNestedParts) {
+    const MultipartMessage msg(MessageAddress("from@test.com"), { MessageAddress("to@test.com") }, "Subject",
+            "Hello", "<p>Hello</p>", { createLogo() }, {}, {},
+            { Attachment(std::make_shared<BufferAttachmentSource>("a;b"), "data.csv") });
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(msg));
+    ASSERT_EQ(4U, writer.getSegmentCount());
+    const std::string body_part { writer.getSegment(1) };
+    ASSERT_EQ(std::string(writer.getBoundary().getDelimiter()) + "\r\nContent-Type: " + msg.getMimeType() + "\r\n\r\n",
+            body_part.substr(0, body_part.find("\r\n\r\n") + 4));
+    ASSERT_EQ(std::string::npos, msg.getBodyView().find(writer.getBoundary().getValue()));
+    ASSERT_NE(std::string::npos, writer.getSegment(2).find("Content-Disposition: Inline; filename=\"data.csv\""));
+}
@@ -0,0 +1,43 @@
+#include "../../src/mxdeliveryclient.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "../../src/plaintextmessage.h"
+
+using namespace jed_utils;
+
+TEST(MxDeliveryClient_groupRecipientsByDomain, SeveralDomains_ReturnOneGroupPerDomain) {
+    const MessageAddress to[] { MessageAddress("a@example.com"), MessageAddress("b@other.org") };
+    const MessageAddress cc[] { MessageAddress("c@EXAMPLE.com") };
+    const MessageAddress bcc[] { MessageAddress("d@other.org"), MessageAddress("e@third.net") };
+    PlaintextMessage msg(MessageAddress("from@test.com"), to, 2, "Subject", "Body", cc, 1, bcc, 2);
+    auto groups = MxDeliveryClient::groupRecipientsByDomain(msg);
+    ASSERT_EQ(3, groups.size());
+    ASSERT_EQ(2, groups["example.com"].size());
+    ASSERT_STREQ("a@example.com", groups["example.com"][0].getEmailAddress());
+    ASSERT_STREQ("c@EXAMPLE.com", groups["example.com"][1].getEmailAddress());
+    ASSERT_EQ(2, groups["other.org"].size());
+    ASSERT_STREQ("b@other.org", groups["other.org"][0].getEmailAddress());
+    ASSERT_STREQ("d@other.org", groups["other.org"][1].getEmailAddress());
+    ASSERT_EQ(1, groups["third.net"].size());
+}
+
+TEST(MxDeliveryClient_sendMail, UnreachableRoutedHosts_ReturnErrorPerDomain) {
+    MxDeliveryClient client(SmtpClientType::Plain, 1);
+    client.setDomainRoute("example.com", "127.0.0.1");
+    client.setDomainRoute("other.org", "127.0.0.1");
+    const MessageAddress to[] { MessageAddress("a@example.com"), MessageAddress("b@other.org"), MessageAddress("c@example.com") };
+    PlaintextMessage msg(MessageAddress("from@test.com"), to, 3, "Subject", "Body");
+    auto results = client.sendMail(msg);
+    ASSERT_EQ(2, results.size());
+    ASSERT_EQ("example.com", results[0].Domain);
+    ASSERT_EQ(2, results[0].Recipients.size());
+    ASSERT_EQ("a@example.com", results[0].Recipients[0]);
+    ASSERT_EQ("c@example.com", results[0].Recipients[1]);
+    ASSERT_EQ("127.0.0.1", results[0].MxHost);
+    ASSERT_NE(0, results[0].ReturnCode);
+    ASSERT_EQ("other.org", results[1].Domain);
+    ASSERT_EQ(1, results[1].Recipients.size());
+    ASSERT_NE(0, results[1].ReturnCode);
+}
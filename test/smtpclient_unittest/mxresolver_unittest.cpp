@@ -0,0 +1,98 @@
+#include "../../src/mxresolver.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "../../src/smtpclienterrors.h"
+
+using namespace jed_utils;
+
+namespace {
+// Response to the MX query of example.com with two records whose names
+// are compressed: 10 mx1.example.com (TTL 300) and 5 mx2.example.com (TTL 120)
+const std::vector<unsigned char> MX_RESPONSE {
+    0x12, 0x34, 0x81, 0x80, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00,
+    // Question
+    0x07, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 0x03, 'c', 'o', 'm', 0x00, 0x00, 0x0F, 0x00, 0x01,
+    // Answers
+    0xC0, 0x0C, 0x00, 0x0F, 0x00, 0x01, 0x00, 0x00, 0x01, 0x2C, 0x00, 0x08,
+    0x00, 0x0A, 0x03, 'm', 'x', '1', 0xC0, 0x0C,
+    0xC0, 0x0C, 0x00, 0x0F, 0x00, 0x01, 0x00, 0x00, 0x00, 0x78, 0x00, 0x08,
+    0x00, 0x05, 0x03, 'm', 'x', '2', 0xC0, 0x0C
+};
+}  // namespace
+
+TEST(MxResolver_parseDnsResponse, ValidResponse_ReturnRecords) {
+    std::vector<MxRecord> records;
+    unsigned int ttl = 0;
+    ASSERT_TRUE(MxResolver::parseDnsResponse(MX_RESPONSE.data(), MX_RESPONSE.size(), records, ttl));
+    ASSERT_EQ(2, records.size());
+    ASSERT_EQ(10, records[0].Preference);
+    ASSERT_EQ("mx1.example.com", records[0].Host);
+    ASSERT_EQ(5, records[1].Preference);
+    ASSERT_EQ("mx2.example.com", records[1].Host);
+    ASSERT_EQ(120, ttl);
+}
+
+TEST(MxResolver_parseDnsResponse, TruncatedResponse_ReturnFalse) {
+    std::vector<MxRecord> records;
+    unsigned int ttl = 0;
+    ASSERT_FALSE(MxResolver::parseDnsResponse(MX_RESPONSE.data(), MX_RESPONSE.size() - 3, records, ttl));
+    ASSERT_FALSE(MxResolver::parseDnsResponse(MX_RESPONSE.data(), 8, records, ttl));
+}
+
+TEST(MxResolver_parseDnsResponse, NullResponse_ReturnFalse) {
+    std::vector<MxRecord> records;
+    unsigned int ttl = 0;
+    ASSERT_FALSE(MxResolver::parseDnsResponse(nullptr, 0, records, ttl));
+}
+
+TEST(MxResolver_parseDnsResponse, CompressionLoop_ReturnFalse) {
+    std::vector<unsigned char> response(MX_RESPONSE);
+    // The name of the first answer points to itself
+    response[30] = 0x1D;
+    std::vector<MxRecord> records;
+    unsigned int ttl = 0;
+    ASSERT_FALSE(MxResolver::parseDnsResponse(response.data(), response.size(), records, ttl));
+}
+
+TEST(MxResolver_parseDnsResponse, NullMx_ReturnRecordWithEmptyHost) {
+    const std::vector<unsigned char> response {
+        0x00, 0x01, 0x81, 0x80, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x0F, 0x00, 0x01, 0x00, 0x00, 0x0E, 0x10, 0x00, 0x03,
+        0x00, 0x00, 0x00
+    };
+    std::vector<MxRecord> records;
+    unsigned int ttl = 0;
+    ASSERT_TRUE(MxResolver::parseDnsResponse(response.data(), response.size(), records, ttl));
+    ASSERT_EQ(1, records.size());
+    ASSERT_EQ(0, records[0].Preference);
+    ASSERT_EQ("", records[0].Host);
+    ASSERT_EQ(3600, ttl);
+}
+
+TEST(MxResolver_parseDnsResponse, OtherRecordTypes_AreIgnored) {
+    std::vector<unsigned char> response(MX_RESPONSE);
+    // The first answer becomes a CNAME record
+    response[32] = 0x05;
+    std::vector<MxRecord> records;
+    unsigned int ttl = 0;
+    ASSERT_TRUE(MxResolver::parseDnsResponse(response.data(), response.size(), records, ttl));
+    ASSERT_EQ(1, records.size());
+    ASSERT_EQ("mx2.example.com", records[0].Host);
+}
+
+TEST(MxResolver_resolve, EmptyDomain_ReturnInvalidDomainError) {
+    MxResolver resolver;
+    std::vector<MxRecord> records;
+    ASSERT_EQ(CLIENT_DELIVERY_INVALID_DOMAIN_ERROR, resolver.resolve("", records));
+    ASSERT_EQ(CLIENT_DELIVERY_INVALID_DOMAIN_ERROR, resolver.resolve(nullptr, records));
+    ASSERT_EQ(CLIENT_DELIVERY_INVALID_DOMAIN_ERROR, resolver.resolve(".", records));
+    ASSERT_TRUE(records.empty());
+    ASSERT_EQ(0, resolver.getCacheEntryCount());
+}
+
+TEST(MxResolver_clearCache, EmptyCache_ReturnNoEntry) {
+    MxResolver resolver;
+    resolver.clearCache();
+    ASSERT_EQ(0, resolver.getCacheEntryCount());
+}
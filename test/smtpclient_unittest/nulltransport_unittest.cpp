@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "../../src/attachmentsource.h"
+#include "../../src/credential.h"
+#include "../../src/nulltransport.h"
+#include "../../src/plaintextmessage.h"
+#include "../../src/sendstatistics.h"
+#include "../../src/sessionobserver.h"
+#include "../../src/smtpclienterrors.h"
+#include "../../src/smtpclient.h"
+
+using namespace jed_utils;
+
+namespace {
+PlaintextMessage createMessage() {
+    return PlaintextMessage(MessageAddress("from@example.com"),
+            MessageAddress("to@example.com"),
+            "Subject",
+            "Body\r\n.Line starting with a dot");
+}
+
+std::string readReplies(NullTransport &pTransport) {
+    std::string replies;
+    char buffer[256];
+    while (pTransport.waitForData(0) == 1) {
+        const int length = pTransport.read(buffer, sizeof(buffer));
+        replies.append(buffer, static_cast<size_t>(length));
+    }
+    return replies;
+}
+
+int writeText(NullTransport &pTransport, std::string_view pText) {
+    return pTransport.write(&pText, 1);
+}
+
+// A content that cannot be read after its first block
+class InterruptedAttachmentSource : public AttachmentSource {
+ public:
+    int read(const AttachmentBlockWriter &pWriter) const override {
+        const int ret_code = pWriter(std::string(100000, 'a'));
+        return ret_code != 0 ? ret_code : -1;
+    }
+    std::optional<size_t> getSize() const override {
+        return std::nullopt;
+    }
+};
+}  // namespace
+
+TEST(NullTransport_write, WithoutOpen_ReturnError) {
+    NullTransport transport;
+    ASSERT_EQ(-1, writeText(transport, "NOOP\r\n"));
+    ASSERT_EQ(-1, transport.waitForData(0));
+}
+
+TEST(NullTransport_waitForData, WithNoCommand_ReturnTimeoutImmediately) {
+    NullTransport transport;
+    ASSERT_EQ(0, transport.open("localhost", 25, 1000));
+    ASSERT_EQ("220 null.transport ESMTP\r\n", readReplies(transport));
+    ASSERT_EQ(0, transport.waitForData(60000));
+}
+
+TEST(NullTransport_write, WithDataSplitAcrossWrites_AcceptMessageAtTerminator) {
+    NullTransport transport;
+    ASSERT_EQ(0, transport.open("localhost", 25, 1000));
+    readReplies(transport);
+    ASSERT_EQ(0, writeText(transport, "DA"));
+    ASSERT_EQ(0, writeText(transport, "TA\r\n"));
+    ASSERT_EQ("354 Start mail input\r\n", readReplies(transport));
+    ASSERT_EQ(0, writeText(transport, "Subject: x\r\n\r\n..stuffed\r\n.\r"));
+    ASSERT_EQ(0U, transport.getMessageCount());
+    ASSERT_EQ(0, writeText(transport, "\nQUIT\r\n"));
+    ASSERT_EQ("250 2.0.0 OK\r\n221 2.0.0 Bye\r\n", readReplies(transport));
+    ASSERT_EQ(1U, transport.getMessageCount());
+    ASSERT_EQ(std::string_view("Subject: x\r\n\r\n..stuffed\r\n").size(), transport.getContentByteCount());
+}
+
+TEST(NullTransport_write, WithBdatChunks_AcceptMessageAtLastChunk) {
+    NullTransport transport;
+    ASSERT_EQ(0, transport.open("localhost", 25, 1000));
+    readReplies(transport);
+    ASSERT_EQ(0, writeText(transport, "BDAT 5\r\nHelloBDAT 3 LAST\r\n"));
+    ASSERT_EQ(0U, transport.getMessageCount());
+    ASSERT_EQ(0, writeText(transport, "abc"));
+    ASSERT_EQ("250 2.0.0 OK\r\n250 2.0.0 OK\r\n", readReplies(transport));
+    ASSERT_EQ(1U, transport.getMessageCount());
+    ASSERT_EQ(8U, transport.getContentByteCount());
+}
+
+TEST(NullTransport_sendMail, WithData_SendWholeMessage) {
+    auto transport = std::make_shared<NullTransport>(false);
+    SmtpClient client("localhost", 25);
+    client.setTransport(transport);
+    ASSERT_EQ(0, client.sendMail(createMessage()));
+    ASSERT_EQ(1U, transport->getMessageCount());
+    ASSERT_GT(transport->getContentByteCount(), 0U);
+    ASSERT_EQ(transport->getBytesWritten(), client.getIoCounters().BytesWritten);
+}
+
+TEST(NullTransport_sendMail, WithChunkingAndCredentials_SendWholeMessage) {
+    auto transport = std::make_shared<NullTransport>();
+    SmtpClient client("localhost", 25);
+    client.setTransport(transport);
+    client.setCredentials(Credential("user", "password"));
+    ASSERT_EQ(0, client.sendMail(createMessage()));
+    ASSERT_EQ(1U, transport->getMessageCount());
+    ASSERT_TRUE(client.getServerCapabilities().Chunking);
+}
+
+TEST(NullTransport_sendMail, WithSessionMetrics_MeasureContentByPhase) {
+    auto transport = std::make_shared<NullTransport>(false);
+    auto metrics = std::make_shared<SessionMetrics>();
+    SmtpClient client("localhost", 25);
+    client.setTransport(transport);
+    client.setSessionObserver(metrics);
+    ASSERT_EQ(0, client.connect());
+    for (int index = 0; index < 3; index++) {
+        ASSERT_EQ(0, client.sendMail(createMessage()));
+    }
+    ASSERT_EQ(3U, transport->getMessageCount());
+    const PhaseStatistics headers = metrics->getPhaseStatistics(SessionPhase::Headers);
+    const PhaseStatistics body = metrics->getPhaseStatistics(SessionPhase::Body);
+    ASSERT_EQ(3U, body.Count);
+    ASSERT_EQ(0U, body.ErrorCount);
+    // The DATA command and the content, its terminator included
+    ASSERT_EQ(transport->getContentByteCount() + 3 * (std::string_view("DATA\r\n").size() + std::string_view(".\r\n").size()),
+            headers.Io.BytesWritten + body.Io.BytesWritten);
+}
+
+TEST(NullTransport_sendMail, WithPipelinedChunksAndInterruptedAttachment_KeepSessionInStep) {
+    auto transport = std::make_shared<NullTransport>();
+    SmtpClient client("localhost", 25);
+    client.setTransport(transport);
+    client.setAttachmentPrefetchBlockCount(0);
+    const Attachment attachments[] { Attachment(std::make_shared<InterruptedAttachmentSource>(), "data.bin") };
+    PlaintextMessage msg(MessageAddress("from@example.com"),
+            MessageAddress("to@example.com"),
+            "Subject",
+            "Body",
+            nullptr,
+            nullptr,
+            attachments,
+            1);
+    auto statistics = std::make_shared<SendStatistics>();
+    client.setSessionObserver(statistics);
+    ASSERT_EQ(0, client.connect());
+    ASSERT_EQ(CLIENT_SENDMAIL_BODYPART_ERROR, client.sendMail(msg));
+    ASSERT_TRUE(client.isConnected());
+    // The replies of the 2 chunks sent before the failure are read before
+    // the RSET: greeting, EHLO, MAIL FROM, RCPT TO, BDAT, BDAT and RSET
+    ASSERT_EQ(7U, statistics->getReplyClassCount(2));
+    ASSERT_EQ(0, client.sendMail(createMessage()));
+    ASSERT_EQ(1U, transport->getMessageCount());
+    // MAIL FROM, RCPT TO and the 2 chunks of the next message
+    ASSERT_EQ(11U, statistics->getReplyClassCount(2));
+    client.disconnect();
+}
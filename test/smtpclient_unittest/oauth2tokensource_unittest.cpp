@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "../../src/base64.h"
+#include "../../src/oauth2tokensource.h"
+
+using namespace jed_utils;
+
+namespace {
+AccessTokenRefresher createRefresher(int &pCallCount, std::chrono::seconds pLifetime) {
+    return [&pCallCount, pLifetime](std::string &pAccessToken, std::chrono::seconds &pTokenLifetime) {
+        pAccessToken = "token" + std::to_string(++pCallCount);
+        pTokenLifetime = pLifetime;
+        return 0;
+    };
+}
+}  // namespace
+
+TEST(OAuth2TokenSource_getAccessToken, WithValidToken_CallRefresherOnce) {
+    int call_count = 0;
+    OAuth2TokenSource token_source(createRefresher(call_count, std::chrono::seconds(3600)));
+    std::string access_token;
+    ASSERT_EQ(0, token_source.getAccessToken(access_token));
+    ASSERT_EQ("token1", access_token);
+    ASSERT_EQ(0, token_source.getAccessToken(access_token));
+    ASSERT_EQ("token1", access_token);
+    ASSERT_EQ(1, call_count);
+    ASSERT_EQ(1U, token_source.getRefreshCount());
+}
+
+TEST(OAuth2TokenSource_getAccessToken, WithTokenWithinRefreshMargin_RefreshToken) {
+    int call_count = 0;
+    // The margin is reduced to half of the lifetime, the token is refreshed after 1 second
+    OAuth2TokenSource token_source(createRefresher(call_count, std::chrono::seconds(2)), std::chrono::seconds(60));
+    std::string access_token;
+    ASSERT_EQ(0, token_source.getAccessToken(access_token));
+    ASSERT_EQ(0, token_source.getAccessToken(access_token));
+    ASSERT_EQ("token1", access_token);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    ASSERT_EQ(0, token_source.getAccessToken(access_token));
+    ASSERT_EQ("token2", access_token);
+}
+
+TEST(OAuth2TokenSource_getAccessToken, WithUnknownLifetime_KeepToken) {
+    int call_count = 0;
+    OAuth2TokenSource token_source(createRefresher(call_count, std::chrono::seconds(0)));
+    std::string access_token;
+    ASSERT_EQ(0, token_source.getAccessToken(access_token));
+    ASSERT_EQ(0, token_source.getAccessToken(access_token));
+    ASSERT_EQ(1, call_count);
+}
+
+TEST(OAuth2TokenSource_getAccessToken, WithFailingRefresher_ReturnRefresherError) {
+    OAuth2TokenSource token_source([](std::string &, std::chrono::seconds &) {
+        return -7;
+    });
+    std::string access_token;
+    ASSERT_EQ(-7, token_source.getAccessToken(access_token));
+    ASSERT_EQ(0U, token_source.getRefreshCount());
+}
+
+TEST(OAuth2TokenSource_getAccessToken, WithEmptyTokenOrNoRefresher_ReturnMinus1) {
+    OAuth2TokenSource empty_token_source([](std::string &pAccessToken, std::chrono::seconds &) {
+        pAccessToken.clear();
+        return 0;
+    });
+    std::string access_token;
+    ASSERT_EQ(-1, empty_token_source.getAccessToken(access_token));
+    OAuth2TokenSource no_refresher(nullptr);
+    ASSERT_EQ(-1, no_refresher.getAccessToken(access_token));
+}
+
+TEST(OAuth2TokenSource_getInitialResponse, WithXOAuth2_ReturnEncodedResponse) {
+    int call_count = 0;
+    OAuth2TokenSource token_source(createRefresher(call_count, std::chrono::seconds(3600)));
+    std::string response;
+    ASSERT_EQ(0, token_source.getInitialResponse(OAuth2Mechanism::XOAuth2, "u@test.com", response));
+    ASSERT_EQ("dXNlcj11QHRlc3QuY29tAWF1dGg9QmVhcmVyIHRva2VuMQEB", response);
+}
+
+TEST(OAuth2TokenSource_getInitialResponse, WithOAuthBearer_ReturnEncodedResponse) {
+    int call_count = 0;
+    OAuth2TokenSource token_source(createRefresher(call_count, std::chrono::seconds(3600)));
+    std::string response;
+    ASSERT_EQ(0, token_source.getInitialResponse(OAuth2Mechanism::OAuthBearer, "u@test.com", response));
+    ASSERT_EQ("bixhPXVAdGVzdC5jb20sAWF1dGg9QmVhcmVyIHRva2VuMQEB", response);
+}
+
+TEST(OAuth2TokenSource_getInitialResponse, WithOAuthBearerAndSaslNameSpecials_EscapeAuthorizationIdentity) {
+    int call_count = 0;
+    OAuth2TokenSource token_source(createRefresher(call_count, std::chrono::seconds(3600)));
+    std::string response;
+    ASSERT_EQ(0, token_source.getInitialResponse(OAuth2Mechanism::OAuthBearer, "SRS0=HHH=TT=test.com=u,x@test.com", response));
+    ASSERT_EQ("n,a=SRS0=3DHHH=3DTT=3Dtest.com=3Du=2Cx@test.com,\x01" "auth=Bearer token1\x01\x01", Base64::Decode(response));
+}
+
+TEST(OAuth2TokenSource_getInitialResponse, WithXOAuth2AndEqualSign_KeepUsername) {
+    int call_count = 0;
+    OAuth2TokenSource token_source(createRefresher(call_count, std::chrono::seconds(3600)));
+    std::string response;
+    ASSERT_EQ(0, token_source.getInitialResponse(OAuth2Mechanism::XOAuth2, "u=x@test.com", response));
+    ASSERT_EQ("user=u=x@test.com\x01" "auth=Bearer token1\x01\x01", Base64::Decode(response));
+}
+
+TEST(OAuth2TokenSource_invalidate, WithCachedResponse_BuildResponseFromNewToken) {
+    int call_count = 0;
+    OAuth2TokenSource token_source(createRefresher(call_count, std::chrono::seconds(3600)));
+    std::string first_response;
+    ASSERT_EQ(0, token_source.getInitialResponse(OAuth2Mechanism::XOAuth2, "u@test.com", first_response));
+    std::string response;
+    ASSERT_EQ(0, token_source.getInitialResponse(OAuth2Mechanism::XOAuth2, "u@test.com", response));
+    ASSERT_EQ(first_response, response);
+    token_source.invalidate();
+    ASSERT_EQ(0, token_source.getInitialResponse(OAuth2Mechanism::XOAuth2, "u@test.com", response));
+    ASSERT_NE(first_response, response);
+    ASSERT_EQ(2, call_count);
+}
@@ -14,7 +14,7 @@ class FakeOpportunisticSecureSMTPClient : public ::testing::Test, public Opportu
 template <typename T>
 class MultiOppSmtpClientFixture : public ::testing::Test {
  public:
-    MultiOppSmtpClientFixture<T>()
+    MultiOppSmtpClientFixture()
         : client("test", 587) {
     }
     T client;
@@ -141,3 +141,15 @@ TEST_F(FakeOpportunisticSecureSMTPClient, isStartTLSSupported_WithoutServerRepon
                 "250-CHUNKING\r\n"
                 "250 SMTPUTF8"));
 }
+
+TYPED_TEST(MultiOppSmtpClientFixture, getTlsContext_Default_ReturnNullPtr) {
+    ASSERT_EQ(nullptr, this->client.getTlsContext());
+}
+
+TYPED_TEST(MultiOppSmtpClientFixture, setTlsContext_WithSharedContext_ReturnSameContext) {
+    auto context = std::make_shared<TlsContext>();
+    this->client.setTlsContext(context);
+    ASSERT_EQ(context, this->client.getTlsContext());
+    TypeParam copy(this->client);
+    ASSERT_EQ(context, copy.getTlsContext());
+}
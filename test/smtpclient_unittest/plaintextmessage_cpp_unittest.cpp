@@ -59,5 +59,36 @@ TEST(PlaintextMessage_ConversionToStdPlaintextMessage, WithExtendedArgs_ReturnSu
     ASSERT_EQ(2, stdMsg.getAttachmentsCount());
 }
 
+TEST(PlaintextMessage_ConversionToStdPlaintextMessage, CalledTwice_ReturnSameInstance) {
+    PlaintextMessage msg(MessageAddress("from@from.com"), { MessageAddress("to@to.com") }, "Subject", "Body");
+    const jed_utils::PlaintextMessage &stdMsg1 = msg;
+    const jed_utils::PlaintextMessage &stdMsg2 = msg;
+    ASSERT_EQ(&stdMsg1, &stdMsg2);
+}
+
+TEST(PlaintextMessage_ConversionToStdPlaintextMessage, WithCopiedMessage_ReturnSameContent) {
+    PlaintextMessage msg(MessageAddress("from@from.com"), { MessageAddress("to@to.com") }, "Subject", "Body");
+    PlaintextMessage copy(msg);
+    const jed_utils::PlaintextMessage &stdMsg = copy;
+    ASSERT_STREQ("to@to.com", stdMsg.getTo()[0]->getEmailAddress());
+    ASSERT_STREQ("Body", stdMsg.getBody());
+}
+
+TEST(PlaintextMessage_ConversionToStdPlaintextMessage, WithMessage_ShareBodyAndKeepRecipientsOrder) {
+    PlaintextMessage msg(MessageAddress("from@from.com"),
+                   { MessageAddress("to@to.com", "To") },
+                   "Subject",
+                   std::string(4096, 'a'),
+                   { MessageAddress("cc@cc.com") },
+                   { MessageAddress("bcc@bcc.com", "Hidden") });
+    const jed_utils::PlaintextMessage &stdMsg = msg;
+    ASSERT_EQ(msg.getBody().data(), stdMsg.getBodyView().data());
+    const jed_utils::RecipientTable &recipients = stdMsg.getRecipients();
+    ASSERT_EQ(3U, recipients.size());
+    ASSERT_STREQ("To", recipients.getDisplayName(0));
+    ASSERT_STREQ("cc@cc.com", stdMsg.getCc()[0]->getEmailAddress());
+    ASSERT_STREQ("Hidden", stdMsg.getBcc()[0]->getDisplayName());
+}
+
 }  // namespace cpp_plainmessage
 }  // namespace jed_utils_unittest
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
+#include <memory>
 #include <stdexcept>
+#include <string>
 #include <vector>
 #include "../../src/plaintextmessage.h"
 
@@ -105,3 +107,59 @@ TEST_F(SimpleMessage, getMimeTypeReturnValidPlainText) {
 }
 
 // End Simple Message fixture tests
+
+TEST(PlaintextMessage_Constructor, WithMovedParts_ReturnRecipientsInOrder) {
+    PlaintextMessage msg(MessageAddress("from@test.com"),
+            { MessageAddress("to1@test.com"), MessageAddress("to2@test.com") },
+            "Subject",
+            std::make_shared<const std::string>("Body"),
+            { MessageAddress("cc@test.com") },
+            { MessageAddress("bcc@test.com") });
+    ASSERT_STREQ("from@test.com", msg.getFrom().getEmailAddress());
+    ASSERT_EQ(2, msg.getToCount());
+    ASSERT_STREQ("to2@test.com", msg.getTo()[1]->getEmailAddress());
+    ASSERT_EQ(1, msg.getCcCount());
+    ASSERT_STREQ("cc@test.com", msg.getCc()[0]->getEmailAddress());
+    ASSERT_EQ(1, msg.getBccCount());
+    ASSERT_STREQ("bcc@test.com", msg.getBcc()[0]->getEmailAddress());
+    ASSERT_STREQ("Subject", msg.getSubject());
+    ASSERT_STREQ("Body", msg.getBody());
+    ASSERT_EQ(nullptr, msg.getAttachments());
+}
+
+TEST(PlaintextMessage_Constructor, WithNullBody_ReturnEmptyBody) {
+    PlaintextMessage msg(MessageAddress("from@test.com"), { MessageAddress("to@test.com") }, "", nullptr);
+    ASSERT_STREQ("", msg.getBody());
+    ASSERT_EQ("", msg.getBodyView());
+}
+
+TEST(PlaintextMessage_CopyConstructor, WithCopy_BodyIsShared) {
+    PlaintextMessage msg1(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    PlaintextMessage msg2(msg1);
+    ASSERT_EQ(msg1.getBody(), msg2.getBody());
+    ASSERT_NE(msg1.getSubject(), msg2.getSubject());
+}
+
+TEST(PlaintextMessage_Constructor, WithRecipientTable_ReturnRecipientsByKind) {
+    RecipientTable recipients;
+    recipients.append("to@test.com", "To");
+    recipients.append("cc@test.com", "");
+    recipients.append("bcc1@test.com", "");
+    recipients.append("bcc2@test.com", "Hidden");
+    PlaintextMessage msg(MessageAddress("from@test.com"), std::move(recipients), 1, 1, "Subject",
+            std::make_shared<const std::string>("Body"));
+    ASSERT_EQ(1U, msg.getToCount());
+    ASSERT_EQ(1U, msg.getCcCount());
+    ASSERT_EQ(2U, msg.getBccCount());
+    ASSERT_STREQ("To", msg.getTo()[0]->getDisplayName());
+    ASSERT_STREQ("cc@test.com", msg.getCc()[0]->getEmailAddress());
+    ASSERT_STREQ("Hidden", msg.getBcc()[1]->getDisplayName());
+    ASSERT_EQ("Body", msg.getBodyView());
+}
+
+TEST(PlaintextMessage_Constructor, WithCountsBeyondRecipientTable_ThrowInvalidArgument) {
+    RecipientTable recipients;
+    recipients.append("to@test.com", "");
+    ASSERT_THROW(PlaintextMessage(MessageAddress("from@test.com"), recipients, 2, 0, "", nullptr), std::invalid_argument);
+    ASSERT_THROW(PlaintextMessage(MessageAddress("from@test.com"), recipients, 1, 1, "", nullptr), std::invalid_argument);
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "../../src/quotedprintable.h"
+
+using namespace jed_utils;
+
+namespace {
+// Check the line length limit and that no line ends with a whitespace
+void assertValidLines(const std::string &pEncoded) {
+    size_t line_start = 0;
+    while (line_start <= pEncoded.size()) {
+        size_t line_end = pEncoded.find("\r\n", line_start);
+        if (line_end == std::string::npos) {
+            line_end = pEncoded.size();
+        }
+        ASSERT_LE(line_end - line_start, QuotedPrintableEncoder::MAX_LINE_LENGTH);
+        if (line_end > line_start) {
+            ASSERT_NE(' ', pEncoded[line_end - 1]);
+            ASSERT_NE('\t', pEncoded[line_end - 1]);
+            ASSERT_NE('.', pEncoded[line_start]);
+        }
+        line_start = line_end + 2;
+    }
+}
+
+// Decode the soft line breaks and the =XX sequences
+std::string decode(const std::string &pEncoded) {
+    std::string decoded;
+    for (size_t index = 0; index < pEncoded.size(); index++) {
+        if (pEncoded[index] != '=') {
+            decoded += pEncoded[index];
+        } else if (pEncoded.compare(index + 1, 2, "\r\n") == 0) {
+            index += 2;
+        } else {
+            decoded += static_cast<char>(std::stoi(pEncoded.substr(index + 1, 2), nullptr, 16));
+            index += 2;
+        }
+    }
+    return decoded;
+}
+}  // namespace
+
+TEST(QuotedPrintableEncoder_encodeAll, WithPrintableText_ReturnSameText) {
+    ASSERT_EQ("Hello, World!\r\nSecond line", QuotedPrintableEncoder::encodeAll("Hello, World!\r\nSecond line"));
+}
+
+TEST(QuotedPrintableEncoder_encodeAll, WithBareLineFeeds_ReturnCrLfLineBreaks) {
+    ASSERT_EQ("a\r\nb\r\n", QuotedPrintableEncoder::encodeAll("a\nb\n"));
+}
+
+TEST(QuotedPrintableEncoder_encodeAll, WithEqualSignAndEightBitCharacters_ReturnEscapedCharacters) {
+    ASSERT_EQ("a=3Db Caf=C3=A9", QuotedPrintableEncoder::encodeAll("a=b Caf\xC3\xA9"));
+}
+
+TEST(QuotedPrintableEncoder_encodeAll, WithWhitespaceAtEndOfLines_ReturnEncodedWhitespace) {
+    ASSERT_EQ("a =20\r\nb=09\r\nc=20", QuotedPrintableEncoder::encodeAll("a  \r\nb\t\nc "));
+}
+
+TEST(QuotedPrintableEncoder_encodeAll, WithDotAtBeginningOfLine_ReturnEscapedDot) {
+    ASSERT_EQ("=2E\r\na.b\r\n=2E.", QuotedPrintableEncoder::encodeAll(".\r\na.b\r\n.."));
+}
+
+TEST(QuotedPrintableEncoder_encodeAll, WithBareCarriageReturn_ReturnEscapedCarriageReturn) {
+    ASSERT_EQ("a=0Db=0D", QuotedPrintableEncoder::encodeAll("a\rb\r"));
+}
+
+TEST(QuotedPrintableEncoder_encodeAll, WithLongLines_ReturnSoftLineBreaks) {
+    std::string content(200, 'x');
+    content += " \r\n";
+    for (int index = 0; index < 40; index++) {
+        content += "\xC3\xA9 .";
+    }
+    const std::string encoded = QuotedPrintableEncoder::encodeAll(content);
+    assertValidLines(encoded);
+    ASSERT_EQ(0U, encoded.find(std::string(75, 'x') + "=\r\n"));
+    std::string expected { content };
+    ASSERT_EQ(expected, decode(encoded));
+}
+
+TEST(QuotedPrintableEncoder_encode, WithContentSplitInBlocks_ReturnSameAsWholeContent) {
+    const std::string content { "line one  \r\nline=two\t\r\n.three\rfour \xE2\x82\xAC" + std::string(100, 'y') + " \r\n" };
+    for (size_t split = 0; split <= content.size(); split++) {
+        QuotedPrintableEncoder encoder;
+        std::string encoded;
+        encoder.encode(std::string_view(content).substr(0, split), encoded);
+        encoder.encode(std::string_view(content).substr(split), encoded);
+        encoder.finish(encoded);
+        ASSERT_EQ(QuotedPrintableEncoder::encodeAll(content), encoded) << "split at " << split;
+    }
+}
+
+TEST(QuotedPrintableEncoder_measure, WithContent_ReturnEncodedSizeAndCounters) {
+    const std::string content { "a=b\r\n" + std::string(100, 'z') };
+    QuotedPrintableEncoder encoder;
+    encoder.measure(content);
+    encoder.finishMeasure();
+    ASSERT_EQ(QuotedPrintableEncoder::encodeAll(content).size(), encoder.getEncodedSize());
+    ASSERT_EQ(1U, encoder.getEscapedCount());
+    ASSERT_EQ(1U, encoder.getSoftLineBreakCount());
+    encoder.reset();
+    ASSERT_EQ(0U, encoder.getEncodedSize());
+    ASSERT_EQ(0U, encoder.getEscapedCount());
+}
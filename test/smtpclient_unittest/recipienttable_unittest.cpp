@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "../../src/recipienttable.h"
+
+using namespace jed_utils;
+
+TEST(RecipientTable_Constructor, WithNoEntry_ReturnEmpty) {
+    RecipientTable table;
+    ASSERT_TRUE(table.empty());
+    ASSERT_EQ(0U, table.size());
+}
+
+TEST(RecipientTable_append, WithSeveralEntries_ReturnEntriesInOrder) {
+    RecipientTable table;
+    table.reserve(3, 64);
+    table.append("a@test.com", "Alice");
+    table.append("b@test.com", "");
+    table.append("c@test.com", "Carol");
+    ASSERT_EQ(3U, table.size());
+    ASSERT_STREQ("a@test.com", table.getEmailAddress(0));
+    ASSERT_STREQ("Alice", table.getDisplayName(0));
+    ASSERT_STREQ("b@test.com", table.getEmailAddress(1));
+    ASSERT_STREQ("", table.getDisplayName(1));
+    ASSERT_EQ("c@test.com", table.getEmailAddressView(2));
+    ASSERT_STREQ("Carol", table.getDisplayName(2));
+}
+
+TEST(RecipientTable_CopyConstructor, WithCopy_EntriesAreIndependent) {
+    auto *table = new RecipientTable();
+    table->append("a@test.com", "Alice");
+    RecipientTable copy(*table);
+    delete table;
+    ASSERT_STREQ("a@test.com", copy.getEmailAddress(0));
+    ASSERT_STREQ("Alice", copy.getDisplayName(0));
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../../src/plaintextmessage.h"
+#include "../../src/relaygroup.h"
+#include "../../src/smtpconnectionpool.h"
+#include "../../src/smtpserverstatuscodes.h"
+#include "../../src/socketerrors.h"
+#include "../../src/sslerrors.h"
+
+using namespace jed_utils;
+
+namespace {
+std::vector<RelayEndpoint> createEndpoints() {
+    return { { "relay1.example.com", 25, 1 }, { "relay2.example.com", 587, 2 } };
+}
+}  // namespace
+
+TEST(RelayGroup_Constructor, WithInvalidEndpoints_Throw) {
+    ASSERT_THROW(RelayGroup({}), std::invalid_argument);
+    ASSERT_THROW(RelayGroup({ { "", 25, 1 } }), std::invalid_argument);
+    ASSERT_THROW(RelayGroup({ { "relay1.example.com", 25, 1 }, { "relay2.example.com", 25, 0 } }), std::invalid_argument);
+}
+
+TEST(RelayGroup_Constructor, WithEndpoints_ReturnEndpoints) {
+    RelayGroup relays(createEndpoints());
+    ASSERT_EQ(2U, relays.getEndpointCount());
+    ASSERT_EQ("relay2.example.com", relays.getEndpoint(1).ServerName);
+    ASSERT_EQ(587U, relays.getEndpoint(1).Port);
+    ASSERT_EQ(0U, relays.getOutstandingCount(0));
+    ASSERT_FALSE(relays.isEjected(0));
+}
+
+TEST(RelayGroup_acquire, WithWeights_ReturnLeastOutstandingPerWeight) {
+    RelayGroup relays(createEndpoints());
+    std::vector<size_t> counts(2);
+    size_t index = 0;
+    for (int count = 0; count < 6; count++) {
+        ASSERT_TRUE(relays.acquire(index));
+        counts[index]++;
+    }
+    // The server with a weight of 2 receives twice as many deliveries
+    ASSERT_EQ(2U, counts[0]);
+    ASSERT_EQ(4U, counts[1]);
+    ASSERT_EQ(2U, relays.getOutstandingCount(0));
+    ASSERT_EQ(4U, relays.getOutstandingCount(1));
+}
+
+TEST(RelayGroup_acquire, WithEqualLoad_ReturnServersInTurn) {
+    RelayGroup relays({ { "relay1.example.com", 25, 1 }, { "relay2.example.com", 25, 1 } });
+    size_t index = 0;
+    std::vector<size_t> selected;
+    for (int count = 0; count < 4; count++) {
+        ASSERT_TRUE(relays.acquire(index));
+        relays.release(index, 0);
+        selected.push_back(index);
+    }
+    ASSERT_EQ((std::vector<size_t> { 0, 1, 0, 1 }), selected);
+}
+
+TEST(RelayGroup_acquire, WithAllServersTried_ReturnFalse) {
+    RelayGroup relays(createEndpoints());
+    size_t index = 0;
+    ASSERT_TRUE(relays.acquire(index, { 0 }));
+    ASSERT_EQ(1U, index);
+    ASSERT_FALSE(relays.acquire(index, { 0, 1 }));
+}
+
+TEST(RelayGroup_release, WithConnectError_EjectServer) {
+    RelayGroup relays(createEndpoints());
+    size_t index = 0;
+    ASSERT_TRUE(relays.acquire(index, { 0 }));
+    relays.release(index, SOCKET_INIT_SESSION_CONNECT_TIMEOUT);
+    ASSERT_TRUE(relays.isEjected(1));
+    ASSERT_EQ(0U, relays.getOutstandingCount(1));
+    // The deliveries avoid the ejected server despite its weight
+    for (int count = 0; count < 3; count++) {
+        ASSERT_TRUE(relays.acquire(index));
+        ASSERT_EQ(0U, index);
+    }
+}
+
+TEST(RelayGroup_release, WithRecipientRejected_KeepServer) {
+    RelayGroup relays(createEndpoints());
+    size_t index = 0;
+    ASSERT_TRUE(relays.acquire(index));
+    relays.release(index, 550);
+    ASSERT_FALSE(relays.isEjected(index));
+}
+
+TEST(RelayGroup_release, AfterEjectionTime_ReturnServerAgain) {
+    RelayGroup relays({ { "relay1.example.com", 25, 1 }, { "relay2.example.com", 25, 1 } }, 20);
+    size_t index = 0;
+    ASSERT_TRUE(relays.acquire(index, { 1 }));
+    relays.release(index, SOCKET_INIT_SESSION_CONNECT_ERROR);
+    ASSERT_TRUE(relays.isEjected(0));
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    ASSERT_FALSE(relays.isEjected(0));
+    ASSERT_TRUE(relays.acquire(index, { 1 }));
+    ASSERT_EQ(0U, index);
+}
+
+TEST(RelayGroup_acquire, WithAllServersEjected_ReturnFirstServerBack) {
+    RelayGroup relays({ { "relay1.example.com", 25, 1 }, { "relay2.example.com", 25, 1 } });
+    size_t index = 0;
+    ASSERT_TRUE(relays.acquire(index, { 0 }));
+    relays.release(index, SSL_CLIENT_STARTTLS_BIO_CONNECT_ERROR);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    ASSERT_TRUE(relays.acquire(index, { 1 }));
+    relays.release(index, STATUS_CODE_SERVICE_NOT_AVAILABLE);
+    ASSERT_TRUE(relays.acquire(index));
+    ASSERT_EQ(1U, index);
+}
+
+TEST(RelayGroup_isFailoverError, WithReturnCodes_ReturnTrueForUnusableServer) {
+    ASSERT_TRUE(RelayGroup::isFailoverError(SOCKET_INIT_SESSION_CONNECT_ERROR));
+    ASSERT_TRUE(RelayGroup::isFailoverError(SOCKET_INIT_SESSION_CONNECT_TIMEOUT));
+    ASSERT_TRUE(RelayGroup::isFailoverError(SSL_CLIENT_STARTTLS_BIO_CONNECT_ERROR));
+    ASSERT_TRUE(RelayGroup::isFailoverError(STATUS_CODE_SERVICE_NOT_AVAILABLE));
+    ASSERT_FALSE(RelayGroup::isFailoverError(0));
+    ASSERT_FALSE(RelayGroup::isFailoverError(STATUS_CODE_MAILBOX_BUSY));
+    ASSERT_FALSE(RelayGroup::isFailoverError(550));
+}
+
+TEST(SmtpConnectionPool_sendMail, WithUnreachableRelays_TryEachRelayAndEjectThem) {
+    SmtpConnectionPool pool(4);
+    RelayGroup relays({ { "127.0.0.1", 1, 1 }, { "127.0.0.1", 2, 1 } });
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    const int ret_code = pool.sendMail(SmtpClientType::Plain, relays, nullptr, msg);
+    ASSERT_TRUE(RelayGroup::isFailoverError(ret_code));
+    ASSERT_TRUE(relays.isEjected(0));
+    ASSERT_TRUE(relays.isEjected(1));
+    ASSERT_EQ(0U, relays.getOutstandingCount(0));
+    ASSERT_EQ(0U, relays.getOutstandingCount(1));
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../../src/nulltransport.h"
+#include "../../src/plaintextmessage.h"
+#include "../../src/sendstatistics.h"
+#include "../../src/smtpclient.h"
+#include "../../src/smtpclienterrors.h"
+
+using namespace jed_utils;
+
+namespace {
+PhaseMeasurement createMeasurement(SessionPhase pPhase, int pReturnCode = 0) {
+    PhaseMeasurement measurement;
+    measurement.Phase = pPhase;
+    measurement.Duration = std::chrono::microseconds(100);
+    measurement.ReturnCode = pReturnCode;
+    measurement.Io.BytesWritten = 10;
+    measurement.Io.BytesRead = 20;
+    return measurement;
+}
+}  // namespace
+
+TEST(LatencyHistogram_getBucketIndex, WithBoundaries_ReturnBucketContainingValue) {
+    for (long long value : { 0LL, 1LL, 7LL, 8LL, 15LL, 16LL, 17LL, 1000LL, 123456789LL, 1LL << 41 }) {
+        const size_t index = LatencyHistogram::getBucketIndex(std::chrono::nanoseconds(value));
+        ASSERT_LT(index, LatencyHistogram::BUCKET_COUNT);
+        ASSERT_LE(LatencyHistogram::getBucketLowerBound(index).count(), value);
+        ASSERT_GE(LatencyHistogram::getBucketUpperBound(index).count(), value);
+    }
+    ASSERT_EQ(LatencyHistogram::BUCKET_COUNT - 1, LatencyHistogram::getBucketIndex(std::chrono::hours(10)));
+    ASSERT_EQ(0U, LatencyHistogram::getBucketIndex(std::chrono::nanoseconds(-5)));
+}
+
+TEST(LatencyHistogram_getBucketUpperBound, EachBucket_FollowPreviousOne) {
+    for (size_t index = 1; index < LatencyHistogram::BUCKET_COUNT; index++) {
+        ASSERT_EQ(LatencyHistogram::getBucketUpperBound(index - 1).count() + 1, LatencyHistogram::getBucketLowerBound(index).count());
+    }
+}
+
+TEST(LatencyHistogram_getValueAtPercentile, WithoutValue_ReturnZero) {
+    LatencyHistogram histogram;
+    ASSERT_EQ(0, histogram.getValueAtPercentile(99).count());
+    ASSERT_EQ(0U, histogram.getCount());
+}
+
+TEST(LatencyHistogram_getValueAtPercentile, WithValues_ReturnValueWithinPrecision) {
+    LatencyHistogram histogram;
+    for (int value = 1; value <= 1000; value++) {
+        histogram.record(std::chrono::microseconds(value));
+    }
+    ASSERT_EQ(1000U, histogram.getCount());
+    ASSERT_EQ(1000, histogram.getMax().count() / 1000);
+    ASSERT_EQ(500500, histogram.getTotal().count() / 1000);
+    const auto median = histogram.getValueAtPercentile(50).count();
+    ASSERT_GE(median, 500000);
+    ASSERT_LE(median, 500000 * 1125 / 1000);
+    const auto p99 = histogram.getValueAtPercentile(99).count();
+    ASSERT_GE(p99, 990000);
+    ASSERT_LE(p99, 1000000);
+    ASSERT_EQ(histogram.getMax(), histogram.getValueAtPercentile(100));
+}
+
+TEST(LatencyHistogram_reset, WithValues_ReturnEmptyHistogram) {
+    LatencyHistogram histogram;
+    histogram.record(std::chrono::milliseconds(3));
+    histogram.reset();
+    ASSERT_EQ(0U, histogram.getCount());
+    ASSERT_EQ(0, histogram.getMax().count());
+    ASSERT_EQ(0U, histogram.getBucketCount(LatencyHistogram::getBucketIndex(std::chrono::milliseconds(3))));
+}
+
+TEST(SendStatistics_onPhaseCompleted, WithTransactions_CountMessagesAndBytes) {
+    SendStatistics statistics;
+    statistics.onPhaseCompleted(createMeasurement(SessionPhase::Envelope));
+    statistics.onPhaseCompleted(createMeasurement(SessionPhase::Headers));
+    statistics.onPhaseCompleted(createMeasurement(SessionPhase::Body));
+    statistics.onPhaseCompleted(createMeasurement(SessionPhase::Envelope, 550));
+    statistics.onPhaseCompleted(createMeasurement(SessionPhase::Envelope));
+    statistics.onPhaseCompleted(createMeasurement(SessionPhase::Body, CLIENT_SENDMAIL_BODYPART_ERROR));
+    ASSERT_EQ(1U, statistics.getMessageCount());
+    ASSERT_EQ(2U, statistics.getFailedMessageCount());
+    ASSERT_EQ(60U, statistics.getBytesWritten());
+    ASSERT_EQ(120U, statistics.getBytesRead());
+    ASSERT_EQ(3U, statistics.getPhaseLatency(SessionPhase::Envelope).getCount());
+    ASSERT_EQ(0U, statistics.getPhaseLatency(SessionPhase::Connection).getCount());
+}
+
+TEST(SendStatistics_onReplyReceived, WithCodes_ReturnCountPerCodeAndClass) {
+    SendStatistics statistics;
+    for (int code : { 250, 250, 354, 421, 450, 550, 99, 600, -1 }) {
+        statistics.onReplyReceived(code);
+    }
+    ASSERT_EQ(2U, statistics.getReplyCount(250));
+    ASSERT_EQ(1U, statistics.getReplyCount(550));
+    ASSERT_EQ(0U, statistics.getReplyCount(99));
+    ASSERT_EQ(0U, statistics.getReplyCount(600));
+    ASSERT_EQ(2U, statistics.getReplyClassCount(2));
+    ASSERT_EQ(2U, statistics.getReplyClassCount(4));
+}
+
+TEST(SendStatistics_onSessionOpened, WithReconnectionsAndHandshakes_CountThem) {
+    SendStatistics statistics;
+    statistics.onSessionOpened(false);
+    statistics.onSessionOpened(true);
+    statistics.onTlsHandshakeCompleted(false);
+    statistics.onTlsHandshakeCompleted(true);
+    ASSERT_EQ(2U, statistics.getSessionCount());
+    ASSERT_EQ(1U, statistics.getReconnectionCount());
+    ASSERT_EQ(2U, statistics.getTlsHandshakeCount());
+    ASSERT_EQ(1U, statistics.getResumedTlsHandshakeCount());
+    statistics.reset();
+    ASSERT_EQ(0U, statistics.getSessionCount());
+    ASSERT_EQ(0U, statistics.getResumedTlsHandshakeCount());
+}
+
+TEST(SendStatistics_onPhaseCompleted, OnSeveralThreads_CountEachMeasurement) {
+    SendStatistics statistics;
+    std::vector<std::thread> threads;
+    for (int thread_index = 0; thread_index < 4; thread_index++) {
+        threads.emplace_back([&statistics]() {
+            for (int index = 0; index < 1000; index++) {
+                statistics.onPhaseCompleted(createMeasurement(SessionPhase::Body));
+                statistics.onReplyReceived(250);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(4000U, statistics.getMessageCount());
+    ASSERT_EQ(4000U, statistics.getReplyCount(250));
+    ASSERT_EQ(4000U, statistics.getPhaseLatency(SessionPhase::Body).getCount());
+}
+
+TEST(SendStatistics_sendMail, WithNullTransport_CountSessionsAndReplies) {
+    auto statistics = std::make_shared<SendStatistics>();
+    SmtpClient client("localhost", 25);
+    client.setTransport(std::make_shared<NullTransport>());
+    client.setSessionObserver(statistics);
+    const PlaintextMessage msg(MessageAddress("from@example.com"), MessageAddress("to@example.com"), "Subject", "Body");
+    ASSERT_EQ(0, client.connect());
+    ASSERT_EQ(0, client.sendMail(msg));
+    ASSERT_EQ(0, client.sendMail(msg));
+    ASSERT_EQ(0, client.disconnect());
+    ASSERT_EQ(0, client.connect());
+    ASSERT_EQ(2U, statistics->getMessageCount());
+    ASSERT_EQ(0U, statistics->getFailedMessageCount());
+    ASSERT_EQ(2U, statistics->getSessionCount());
+    ASSERT_EQ(1U, statistics->getReconnectionCount());
+    ASSERT_EQ(2U, statistics->getReplyCount(220));
+    ASSERT_GT(statistics->getReplyCount(250), 0U);
+    ASSERT_GT(statistics->getBytesWritten(), 0U);
+    ASSERT_EQ(2U, statistics->getPhaseLatency(SessionPhase::Connection).getCount());
+}
@@ -0,0 +1,159 @@
+#include "../../src/serverreplyreader.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace jed_utils;
+
+TEST(ServerReplyReader, nextReply_WithNoData_ReturnFalse) {
+    ServerReplyReader reader;
+    ASSERT_FALSE(reader.nextReply());
+    ASSERT_EQ(-1, reader.getCode());
+    ASSERT_EQ(0, reader.getLineCount());
+    ASSERT_FALSE(reader.hasPendingData());
+}
+
+TEST(ServerReplyReader, nextReply_WithPartialLine_ReturnFalse) {
+    ServerReplyReader reader;
+    std::string data { "250 2.1.0 Ok" };
+    reader.append(data.c_str(), data.length());
+    ASSERT_FALSE(reader.nextReply());
+    ASSERT_TRUE(reader.hasPendingData());
+}
+
+TEST(ServerReplyReader, nextReply_WithSingleLineReply_ReturnReply) {
+    ServerReplyReader reader;
+    std::string data { "220 smtp.example.com ESMTP ready\r\n" };
+    reader.append(data.c_str(), data.length());
+    ASSERT_TRUE(reader.nextReply());
+    ASSERT_EQ(220, reader.getCode());
+    ASSERT_EQ(1, reader.getLineCount());
+    ASSERT_EQ("smtp.example.com ESMTP ready", reader.getLine(0));
+    ASSERT_EQ("220 smtp.example.com ESMTP ready", reader.getText());
+    ASSERT_EQ("", reader.getEnhancedStatusCode());
+    ASSERT_FALSE(reader.hasPendingData());
+}
+
+TEST(ServerReplyReader, nextReply_WithIncompleteMultilineReply_ReturnFalse) {
+    ServerReplyReader reader;
+    std::string data { "250-smtp.example.com\r\n250-PIPELINING\r\n" };
+    reader.append(data.c_str(), data.length());
+    ASSERT_FALSE(reader.nextReply());
+}
+
+TEST(ServerReplyReader, nextReply_WithMultilineReplyInSeveralParts_ReturnReply) {
+    ServerReplyReader reader;
+    const std::string parts[] { "250-smtp.exam", "ple.com\r\n250-PIPELI", "NING\r\n250 AUTH PLAIN", "\r\n" };
+    for (size_t index = 0; index < 3; index++) {
+        reader.append(parts[index].c_str(), parts[index].length());
+        ASSERT_FALSE(reader.nextReply());
+    }
+    reader.append(parts[3].c_str(), parts[3].length());
+    ASSERT_TRUE(reader.nextReply());
+    ASSERT_EQ(250, reader.getCode());
+    ASSERT_EQ(3, reader.getLineCount());
+    ASSERT_EQ("smtp.example.com", reader.getLine(0));
+    ASSERT_EQ("PIPELINING", reader.getLine(1));
+    ASSERT_EQ("AUTH PLAIN", reader.getLine(2));
+    ASSERT_EQ("250-smtp.example.com\r\n250-PIPELINING\r\n250 AUTH PLAIN", reader.getText());
+}
+
+TEST(ServerReplyReader, nextReply_WithSeveralReplies_ReturnEachReplyInOrder) {
+    ServerReplyReader reader;
+    std::string data { "250 2.1.0 Ok\r\n250 2.1.5 Ok\r\n550 5.1.1 Unknown user\r\n354 Go" };
+    reader.append(data.c_str(), data.length());
+    ASSERT_TRUE(reader.nextReply());
+    ASSERT_EQ(250, reader.getCode());
+    ASSERT_EQ("2.1.0", reader.getEnhancedStatusCode());
+    ASSERT_TRUE(reader.hasPendingData());
+    ASSERT_TRUE(reader.nextReply());
+    ASSERT_EQ(250, reader.getCode());
+    ASSERT_EQ("2.1.5", reader.getEnhancedStatusCode());
+    ASSERT_TRUE(reader.nextReply());
+    ASSERT_EQ(550, reader.getCode());
+    ASSERT_EQ("5.1.1", reader.getEnhancedStatusCode());
+    ASSERT_EQ("5.1.1 Unknown user", reader.getLine(0));
+    ASSERT_FALSE(reader.nextReply());
+    ASSERT_EQ(-1, reader.getCode());
+    std::string end { "\r\n" };
+    reader.append(end.c_str(), end.length());
+    ASSERT_TRUE(reader.nextReply());
+    ASSERT_EQ(354, reader.getCode());
+    ASSERT_FALSE(reader.hasPendingData());
+}
+
+TEST(ServerReplyReader, nextReply_WithLineFeedOnly_ReturnReply) {
+    ServerReplyReader reader;
+    std::string data { "250-first\n250 last\n" };
+    reader.append(data.c_str(), data.length());
+    ASSERT_TRUE(reader.nextReply());
+    ASSERT_EQ(250, reader.getCode());
+    ASSERT_EQ(2, reader.getLineCount());
+    ASSERT_EQ("last", reader.getLine(1));
+}
+
+TEST(ServerReplyReader, nextReply_WithCodeOnly_ReturnReply) {
+    ServerReplyReader reader;
+    std::string data { "250\r\n" };
+    reader.append(data.c_str(), data.length());
+    ASSERT_TRUE(reader.nextReply());
+    ASSERT_EQ(250, reader.getCode());
+    ASSERT_EQ("", reader.getLine(0));
+}
+
+TEST(ServerReplyReader, nextReply_WithInvalidCode_ReturnMinus1) {
+    ServerReplyReader reader;
+    std::string data { "Hello\r\n" };
+    reader.append(data.c_str(), data.length());
+    ASSERT_TRUE(reader.nextReply());
+    ASSERT_EQ(-1, reader.getCode());
+}
+
+TEST(ServerReplyReader, getEnhancedStatusCode_WithClassDifferentFromCode_ReturnEmpty) {
+    ServerReplyReader reader;
+    std::string data { "250 5.1.1 Mismatch\r\n" };
+    reader.append(data.c_str(), data.length());
+    ASSERT_TRUE(reader.nextReply());
+    ASSERT_EQ("", reader.getEnhancedStatusCode());
+}
+
+TEST(ServerReplyReader, getEnhancedStatusCode_WithVersionLikeText_ReturnEmpty) {
+    ServerReplyReader reader;
+    std::string data { "220 2.0 Postfix\r\n" };
+    reader.append(data.c_str(), data.length());
+    ASSERT_TRUE(reader.nextReply());
+    ASSERT_EQ("", reader.getEnhancedStatusCode());
+}
+
+TEST(ServerReplyReader, getEnhancedStatusCode_WithMultiDigitsSubject_ReturnCode) {
+    ServerReplyReader reader;
+    std::string data { "452-4.5.3 Too many\r\n452 4.5.3 recipients\r\n" };
+    reader.append(data.c_str(), data.length());
+    ASSERT_TRUE(reader.nextReply());
+    ASSERT_EQ(452, reader.getCode());
+    ASSERT_EQ("4.5.3", reader.getEnhancedStatusCode());
+}
+
+TEST(ServerReplyReader, getLine_WithOutOfRangeIndex_ReturnEmpty) {
+    ServerReplyReader reader;
+    std::string data { "250 Ok\r\n" };
+    reader.append(data.c_str(), data.length());
+    ASSERT_TRUE(reader.nextReply());
+    ASSERT_EQ("", reader.getLine(1));
+}
+
+TEST(ServerReplyReader, clear_WithPendingData_DiscardAll) {
+    ServerReplyReader reader;
+    std::string data { "250 Ok\r\n250 Ok\r\n" };
+    reader.append(data.c_str(), data.length());
+    ASSERT_TRUE(reader.nextReply());
+    reader.clear();
+    ASSERT_FALSE(reader.hasPendingData());
+    ASSERT_EQ(-1, reader.getCode());
+    ASSERT_FALSE(reader.nextReply());
+}
+
+TEST(ServerReplyReader, append_WithNullptr_DoNothing) {
+    ServerReplyReader reader;
+    reader.append(nullptr, 10);
+    ASSERT_FALSE(reader.hasPendingData());
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../src/sessionobserver.h"
+#include "../../src/smtpclienterrors.h"
+
+using namespace jed_utils;
+using namespace std::literals::string_literals;
+
+namespace {
+PhaseMeasurement createMeasurement(SessionPhase pPhase, long long pDurationInNanoseconds, int pReturnCode = 0) {
+    PhaseMeasurement measurement;
+    measurement.Phase = pPhase;
+    measurement.Duration = std::chrono::nanoseconds(pDurationInNanoseconds);
+    measurement.ReturnCode = pReturnCode;
+    measurement.Io.BytesWritten = 10;
+    measurement.Io.BytesRead = 20;
+    measurement.Io.WriteCalls = 1;
+    measurement.Io.ReadCalls = 2;
+    measurement.Io.WaitCalls = 3;
+    return measurement;
+}
+}  // namespace
+
+TEST(SessionObserver_getPhaseName, WithEachPhase_ReturnLowercaseName) {
+    ASSERT_EQ("connection"s, SessionObserver::getPhaseName(SessionPhase::Connection));
+    ASSERT_EQ("greeting"s, SessionObserver::getPhaseName(SessionPhase::Greeting));
+    ASSERT_EQ("identification"s, SessionObserver::getPhaseName(SessionPhase::Identification));
+    ASSERT_EQ("starttls"s, SessionObserver::getPhaseName(SessionPhase::StartTLS));
+    ASSERT_EQ("authentication"s, SessionObserver::getPhaseName(SessionPhase::Authentication));
+    ASSERT_EQ("envelope"s, SessionObserver::getPhaseName(SessionPhase::Envelope));
+    ASSERT_EQ("headers"s, SessionObserver::getPhaseName(SessionPhase::Headers));
+    ASSERT_EQ("body"s, SessionObserver::getPhaseName(SessionPhase::Body));
+}
+
+TEST(SessionMetrics_getPhaseStatistics, WithoutMeasurement_ReturnZero) {
+    SessionMetrics metrics;
+    PhaseStatistics statistics = metrics.getPhaseStatistics(SessionPhase::Body);
+    ASSERT_EQ(0U, statistics.Count);
+    ASSERT_EQ(0U, statistics.ErrorCount);
+    ASSERT_EQ(0, statistics.TotalDuration.count());
+    ASSERT_EQ(0U, statistics.Io.BytesWritten);
+}
+
+TEST(SessionMetrics_onPhaseCompleted, WithTwoMeasurements_ReturnSumsAndMax) {
+    SessionMetrics metrics;
+    metrics.onPhaseCompleted(createMeasurement(SessionPhase::Envelope, 100));
+    metrics.onPhaseCompleted(createMeasurement(SessionPhase::Envelope, 300));
+    PhaseStatistics statistics = metrics.getPhaseStatistics(SessionPhase::Envelope);
+    ASSERT_EQ(2U, statistics.Count);
+    ASSERT_EQ(0U, statistics.ErrorCount);
+    ASSERT_EQ(400, statistics.TotalDuration.count());
+    ASSERT_EQ(300, statistics.MaxDuration.count());
+    ASSERT_EQ(20U, statistics.Io.BytesWritten);
+    ASSERT_EQ(40U, statistics.Io.BytesRead);
+    ASSERT_EQ(2U, statistics.Io.WriteCalls);
+    ASSERT_EQ(4U, statistics.Io.ReadCalls);
+    ASSERT_EQ(6U, statistics.Io.WaitCalls);
+    ASSERT_EQ(0U, metrics.getPhaseStatistics(SessionPhase::Body).Count);
+}
+
+TEST(SessionMetrics_onPhaseCompleted, WithSuccessCodes_ReturnNoError) {
+    SessionMetrics metrics;
+    metrics.onPhaseCompleted(createMeasurement(SessionPhase::Greeting, 1, 220));
+    metrics.onPhaseCompleted(createMeasurement(SessionPhase::Greeting, 1, 250));
+    metrics.onPhaseCompleted(createMeasurement(SessionPhase::Greeting, 1, 0));
+    ASSERT_EQ(0U, metrics.getPhaseStatistics(SessionPhase::Greeting).ErrorCount);
+}
+
+TEST(SessionMetrics_onPhaseCompleted, WithFailureCodes_ReturnErrors) {
+    SessionMetrics metrics;
+    metrics.onPhaseCompleted(createMeasurement(SessionPhase::Envelope, 1, 550));
+    metrics.onPhaseCompleted(createMeasurement(SessionPhase::Envelope, 1, CLIENT_SENDMAIL_MAILFROM_ERROR));
+    metrics.onPhaseCompleted(createMeasurement(SessionPhase::Envelope, 1, 0));
+    PhaseStatistics statistics = metrics.getPhaseStatistics(SessionPhase::Envelope);
+    ASSERT_EQ(3U, statistics.Count);
+    ASSERT_EQ(2U, statistics.ErrorCount);
+}
+
+TEST(SessionMetrics_reset, WithMeasurements_ReturnZero) {
+    SessionMetrics metrics;
+    metrics.onPhaseCompleted(createMeasurement(SessionPhase::Body, 100));
+    metrics.reset();
+    ASSERT_EQ(0U, metrics.getPhaseStatistics(SessionPhase::Body).Count);
+    ASSERT_EQ(0, metrics.getPhaseStatistics(SessionPhase::Body).MaxDuration.count());
+}
+
+TEST(SessionMetrics_onPhaseCompleted, FromSeveralThreads_ReturnAllMeasurements) {
+    SessionMetrics metrics;
+    const size_t THREAD_COUNT = 4;
+    const size_t MEASUREMENT_COUNT = 1000;
+    std::vector<std::thread> threads;
+    for (size_t index = 0; index < THREAD_COUNT; index++) {
+        threads.emplace_back([&metrics]() {
+                for (size_t count = 0; count < MEASUREMENT_COUNT; count++) {
+                    metrics.onPhaseCompleted(createMeasurement(SessionPhase::Body, 1));
+                }
+                });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    PhaseStatistics statistics = metrics.getPhaseStatistics(SessionPhase::Body);
+    ASSERT_EQ(THREAD_COUNT * MEASUREMENT_COUNT, statistics.Count);
+    ASSERT_EQ(static_cast<long long>(THREAD_COUNT * MEASUREMENT_COUNT), statistics.TotalDuration.count());
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../src/nulltransport.h"
+#include "../../src/plaintextmessage.h"
+#include "../../src/sessiontrace.h"
+#include "../../src/smtpclient.h"
+
+using namespace jed_utils;
+
+TEST(SessionTrace_Constructor, WithZeroCapacity_ThrowInvalidArgument) {
+    ASSERT_THROW(SessionTrace(0), std::invalid_argument);
+}
+
+TEST(SessionTrace_getEvents, WithoutEvent_ReturnEmpty) {
+    const SessionTrace trace(4);
+    ASSERT_EQ(4U, trace.getCapacity());
+    ASSERT_TRUE(trace.getEvents().empty());
+    ASSERT_EQ("", trace.dump());
+}
+
+TEST(SessionTrace_record, WithEachType_ReturnEventsInOrder) {
+    SessionTrace trace(8);
+    trace.recordSessionOpened();
+    trace.recordCommand("MAIL FROM: <from@test.com>\r\n");
+    trace.recordReply(550);
+    trace.recordTlsHandshake(true);
+    trace.recordPhase(SessionPhase::Envelope, 550, std::chrono::milliseconds(2));
+    trace.recordCommand("\r\n.\r\n");
+    const std::vector<TraceEvent> events = trace.getEvents();
+    ASSERT_EQ(6U, events.size());
+    ASSERT_EQ(TraceEventType::SessionOpened, events[0].Type);
+    ASSERT_EQ(TraceEventType::Command, events[1].Type);
+    ASSERT_EQ("MAIL", events[1].Verb);
+    ASSERT_EQ(TraceEventType::Reply, events[2].Type);
+    ASSERT_EQ(550, events[2].Code);
+    ASSERT_EQ(TraceEventType::TlsHandshake, events[3].Type);
+    ASSERT_EQ(1, events[3].Code);
+    ASSERT_EQ(TraceEventType::PhaseCompleted, events[4].Type);
+    ASSERT_EQ(SessionPhase::Envelope, events[4].Phase);
+    ASSERT_EQ(550, events[4].Code);
+    ASSERT_EQ(2000000, events[4].Duration.count());
+    ASSERT_EQ(".", events[5].Verb);
+    ASSERT_LE(events[0].Time, events[5].Time);
+}
+
+TEST(SessionTrace_record, WithNegativeCode_ReturnSameCode) {
+    SessionTrace trace(1);
+    trace.recordPhase(SessionPhase::Body, -54, std::chrono::nanoseconds(10));
+    ASSERT_EQ(-54, trace.getEvents().front().Code);
+}
+
+TEST(SessionTrace_record, WithLongVerb_KeepEightCharacters) {
+    SessionTrace trace(1);
+    trace.recordCommand("VERYLONGCOMMAND\r\n");
+    ASSERT_EQ("VERYLONG", trace.getEvents().front().Verb);
+}
+
+TEST(SessionTrace_record, OverCapacity_KeepLastEvents) {
+    SessionTrace trace(3);
+    for (int code = 200; code < 210; code++) {
+        trace.recordReply(code);
+    }
+    const std::vector<TraceEvent> events = trace.getEvents();
+    ASSERT_EQ(10U, trace.getRecordedCount());
+    ASSERT_EQ(3U, events.size());
+    ASSERT_EQ(207, events[0].Code);
+    ASSERT_EQ(209, events[2].Code);
+}
+
+TEST(SessionTrace_dump, WithEvents_ReturnOneLinePerEvent) {
+    SessionTrace trace(4);
+    trace.recordCommand("RCPT TO: <to@test.com>\r\n");
+    trace.recordReply(250);
+    trace.recordPhase(SessionPhase::Envelope, 0, std::chrono::microseconds(1500));
+    const std::string dump = trace.dump();
+    ASSERT_EQ(0U, dump.find("+0.000 ms c RCPT\n"));
+    ASSERT_NE(std::string::npos, dump.find(" ms s 250\n"));
+    ASSERT_NE(std::string::npos, dump.find(" ms envelope 0 (1.500 ms)\n"));
+}
+
+TEST(SessionTrace_getEvents, WhileRecording_ReturnConsistentEvents) {
+    SessionTrace trace(16);
+    std::atomic<bool> done { false };
+    std::thread writer([&trace, &done]() {
+        for (int index = 0; index < 100000; index++) {
+            // Each event has the same code and duration
+            trace.recordPhase(SessionPhase::Body, index % 1000, std::chrono::nanoseconds(index % 1000));
+        }
+        done = true;
+    });
+    while (!done) {
+        for (const TraceEvent &event : trace.getEvents()) {
+            ASSERT_EQ(event.Code, event.Duration.count());
+        }
+    }
+    writer.join();
+    ASSERT_EQ(16U, trace.getEvents().size());
+}
+
+TEST(SessionTrace_sendMail, WithNullTransport_TraceCommandsAndReplies) {
+    SmtpClient client("localhost", 25);
+    client.setTransport(std::make_shared<NullTransport>(false));
+    ASSERT_EQ(nullptr, client.getSessionTrace());
+    client.setSessionTraceCapacity(64);
+    ASSERT_EQ(0, client.sendMail(PlaintextMessage(MessageAddress("from@example.com"),
+            MessageAddress("to@example.com"), "Subject", "Body")));
+    const std::string dump = client.getSessionTrace()->dump();
+    ASSERT_NE(std::string::npos, dump.find("connection 0"));
+    ASSERT_NE(std::string::npos, dump.find("s 220\n"));
+    ASSERT_NE(std::string::npos, dump.find("session opened\n"));
+    ASSERT_NE(std::string::npos, dump.find("c MAIL\n"));
+    ASSERT_NE(std::string::npos, dump.find("c RCPT\n"));
+    ASSERT_NE(std::string::npos, dump.find("c DATA\n"));
+    ASSERT_NE(std::string::npos, dump.find("s 354\n"));
+    ASSERT_NE(std::string::npos, dump.find("body 0"));
+    ASSERT_EQ(std::string::npos, dump.find("Connected"));
+}
+
+TEST(SessionTrace_copy, CopiedClient_HaveItsOwnEmptyTrace) {
+    SmtpClient client("localhost", 25);
+    client.setTransport(std::make_shared<NullTransport>());
+    client.setSessionTraceCapacity(32);
+    ASSERT_EQ(0, client.connect());
+    const SmtpClient copy { client };
+    ASSERT_NE(client.getSessionTrace(), copy.getSessionTrace());
+    ASSERT_EQ(32U, copy.getSessionTrace()->getCapacity());
+    ASSERT_TRUE(copy.getSessionTrace()->getEvents().empty());
+    ASSERT_FALSE(client.getSessionTrace()->getEvents().empty());
+    SmtpClient untraced("localhost", 25);
+    untraced = client;
+    ASSERT_EQ(32U, untraced.getSessionTrace()->getCapacity());
+    client.setSessionTraceCapacity(0);
+    ASSERT_EQ(nullptr, client.getSessionTrace());
+}
@@ -1,5 +1,6 @@
 #include "../../src/smtpclient.h"
 #include "../../src/cpp/smtpclient.hpp"
+#include "../../src/plaintextmessage.h"
 #include <gtest/gtest.h>
 
 using namespace jed_utils;
@@ -98,3 +99,23 @@ TEST(SmtpClient_MoveAssignment, SmtpClientMoveAssignmentValid) {
     ASSERT_STREQ("user1", client2.getCredentials()->getUsername());
     ASSERT_STREQ("pass1", client2.getCredentials()->getPassword());
 }
+
+TEST(SmtpClient_sendBulk, WithNoRecipients_ReturnEmptyResults) {
+    SmtpClient client("127.0.0.1", 1);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_TRUE(client.sendBulk(msg, nullptr, 0).empty());
+}
+
+TEST(SmtpClient_sendBulk, WithUnreachableServer_ReturnConnectErrorForEachRecipient) {
+    SmtpClient client("127.0.0.1", 1);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    const MessageAddress recipients[] { MessageAddress("a@test.com"), MessageAddress("b@test.com"), MessageAddress("c@test.com") };
+    auto results = client.sendBulk(msg, recipients, 3);
+    ASSERT_EQ(3, results.size());
+    for (const auto &result : results) {
+        ASSERT_NE(0, result.ReturnCode);
+        ASSERT_EQ(results[0].ReturnCode, result.ReturnCode);
+        ASSERT_EQ("", result.EnhancedStatusCode);
+    }
+    ASSERT_FALSE(client.isConnected());
+}
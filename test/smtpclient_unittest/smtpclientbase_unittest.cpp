@@ -1,13 +1,34 @@
 #include <gtest/gtest.h>
+#include <openssl/bio.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "../../src/attachmentsource.h"
+#include "../../src/dkimsigner.h"
+#include "../../src/oauth2tokensource.h"
+#include "../../src/mimewriter.h"
+#include "../../src/plaintextmessage.h"
+#include "../../src/smtpclient.h"
 #include "../../src/smtpclientbase.h"
+#include "../../src/forcedsecuresmtpclient.h"
+#include "../../src/opportunisticsecuresmtpclient.h"
 #include "../../src/cpp/forcedsecuresmtpclient.hpp"
 #include "../../src/cpp/opportunisticsecuresmtpclient.hpp"
 #include "../../src/cpp/smtpclient.hpp"
 #include "../../src/smtpclienterrors.h"
+#include "../../src/smtpserverstatuscodes.h"
 #include "../../src/socketerrors.h"
 
 using namespace jed_utils;
+using namespace std::literals::string_literals;
 
 class FakeSMTPClientBase : public SMTPClientBase {
  public:
@@ -15,20 +36,78 @@ class FakeSMTPClientBase : public SMTPClientBase {
         : SMTPClientBase(pServerName, pPort) {
     }
 
-    void cleanup() override {}
+    void cleanup() override {
+        mCleanupCount++;
+        closeSocket();
+    }
 
     int establishConnectionWithServer() override {
         return 0;
     }
 
     int sendCommand(const char *pCommand, int pErrorCode) override {
+        mCommands.emplace_back(pCommand);
         return 0;
     }
 
     int sendCommandWithFeedback(const char *pCommand, int pErrorCode, int pTimeoutCode) override {
+        mCommandsWithFeedback.emplace_back(pCommand);
+        // The longest matching prefix wins
+        for (auto reply = mReplies.rbegin(); reply != mReplies.rend(); ++reply) {
+            if (std::string_view(pCommand).substr(0, reply->first.size()) == reply->first) {
+                return reply->second;
+            }
+        }
+        return 0;
+    }
+
+    // Reply with pReturnCode to the commands that start with pCommandPrefix
+    void setReply(const std::string &pCommandPrefix, int pReturnCode) {
+        mReplies[pCommandPrefix] = pReturnCode;
+    }
+
+    int getCleanupCount() const {
+        return mCleanupCount;
+    }
+
+    int sendDataSegments(const std::string_view *pSegments, size_t pSegmentCount, int pErrorCode) override {
+        std::string data;
+        for (size_t index = 0; index < pSegmentCount; index++) {
+            data.append(pSegments[index]);
+        }
+        mDataWrites.push_back(data);
         return 0;
     }
 
+    // The command sent after the data is answered like the other commands
+    int sendDataSegmentsWithFeedback(const std::string_view *pSegments,
+            size_t pSegmentCount,
+            int pErrorCode,
+            int pTimeoutCode) override {
+        if (pSegmentCount > 1) {
+            sendDataSegments(pSegments, pSegmentCount - 1, pErrorCode);
+        }
+        return sendCommandWithFeedback(std::string(pSegments[pSegmentCount - 1]).c_str(), pErrorCode, pTimeoutCode);
+    }
+
+    const std::vector<std::string> &getCommands() const {
+        return mCommands;
+    }
+
+    const std::vector<std::string> &getDataWrites() const {
+        return mDataWrites;
+    }
+
+    const std::vector<std::string> &getCommandsWithFeedback() const {
+        return mCommandsWithFeedback;
+    }
+
+    using SMTPClientBase::setServerCapabilities;
+    using SMTPClientBase::setLastServerResponse;
+    using SMTPClientBase::resolveServerCapabilities;
+    using SMTPClientBase::setAuthenticationOptions;
+    using SMTPClientBase::authenticateClient;
+
     static const char *getNullChar() { return nullptr; }
 
     static int extractReturnCode(const char *pOutput) {
@@ -38,6 +117,17 @@ class FakeSMTPClientBase : public SMTPClientBase {
     static ServerAuthOptions *extractAuthenticationOptions(const char *pEhloOutput) {
         return SMTPClientBase::extractAuthenticationOptions(pEhloOutput);
     }
+
+    static ServerCapabilities extractServerCapabilities(const char *pEhloOutput) {
+        return SMTPClientBase::extractServerCapabilities(pEhloOutput);
+    }
+
+ private:
+    std::vector<std::string> mCommands;
+    std::vector<std::string> mCommandsWithFeedback;
+    std::vector<std::string> mDataWrites;
+    std::map<std::string, int> mReplies;
+    int mCleanupCount = 0;
 };
 
 template<typename T>
@@ -71,6 +161,10 @@ class FakeCPPSMTPClientBase : public T {
         return T::extractAuthenticationOptions(pEhloOutput == nullptr ? getNullChar() : pEhloOutput);
     }
 
+    static ServerCapabilities extractServerCapabilities(const char *pEhloOutput) {
+        return T::extractServerCapabilities(pEhloOutput == nullptr ? getNullChar() : pEhloOutput);
+    }
+
  private:
     static const std::string nullChar;
 };
@@ -81,7 +175,7 @@ const std::string FakeCPPSMTPClientBase<T>::nullChar = "";
 template <typename T>
 class MultiSmtpClientBaseFixture : public ::testing::Test {
  public:
-    MultiSmtpClientBaseFixture<T>()
+    MultiSmtpClientBaseFixture()
         : client("127.0.0.1", 587) {
     }
     T client;
@@ -215,10 +309,64 @@ TYPED_TEST(MultiSmtpClientBaseFixture, getCommunicationLog_WithNewClient_ReturnE
     ASSERT_EQ("", std::string(this->client.getCommunicationLog()));
 }
 
+TYPED_TEST(MultiSmtpClientBaseFixture, getCommunicationLogLevel_Default_ReturnFull) {
+    ASSERT_EQ(CommunicationLogLevel::Full, this->client.getCommunicationLogLevel());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, setCommunicationLogLevel_WithCommands_ReturnCommands) {
+    this->client.setCommunicationLogLevel(CommunicationLogLevel::Commands);
+    ASSERT_EQ(CommunicationLogLevel::Commands, this->client.getCommunicationLogLevel());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, getCommunicationLogCapacity_Default_Return65536) {
+    ASSERT_EQ(65536, this->client.getCommunicationLogCapacity());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, setCommunicationLogCapacity_With1024_Return1024) {
+    this->client.setCommunicationLogCapacity(1024);
+    ASSERT_EQ(1024, this->client.getCommunicationLogCapacity());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, getEncodedAttachmentCache_Default_ReturnNullPtr) {
+    ASSERT_EQ(nullptr, this->client.getEncodedAttachmentCache());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, setEncodedAttachmentCache_WithCache_ReturnSameCache) {
+    auto cache = std::make_shared<EncodedAttachmentCache>();
+    this->client.setEncodedAttachmentCache(cache);
+    ASSERT_EQ(cache, this->client.getEncodedAttachmentCache());
+}
+
 TYPED_TEST(MultiSmtpClientBaseFixture, getCredentials_WithNewClient_ReturnNullPtr) {
     ASSERT_EQ(nullptr, this->client.getCredentials());
 }
 
+TYPED_TEST(MultiSmtpClientBaseFixture, isConnected_WithNewClient_ReturnFalse) {
+    ASSERT_FALSE(this->client.isConnected());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, connect_WithSuccessfulConnection_ReturnConnected) {
+    ASSERT_EQ(0, this->client.connect());
+    ASSERT_TRUE(this->client.isConnected());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, connect_WhenAlreadyConnected_Return0) {
+    ASSERT_EQ(0, this->client.connect());
+    ASSERT_EQ(0, this->client.connect());
+    ASSERT_TRUE(this->client.isConnected());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, disconnect_WhenConnected_ReturnNotConnected) {
+    ASSERT_EQ(0, this->client.connect());
+    ASSERT_EQ(0, this->client.disconnect());
+    ASSERT_FALSE(this->client.isConnected());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, disconnect_WhenNotConnected_Return0) {
+    ASSERT_EQ(0, this->client.disconnect());
+    ASSERT_FALSE(this->client.isConnected());
+}
+
 TEST(Credential, setCredentials_WithABCAnd123_ReturnSuccess) {
     FakeSMTPClientBase client("test", 587);
     ASSERT_EQ(nullptr, client.getCredentials());
@@ -239,6 +387,17 @@ TEST(CPP_Credential, setCredentials_WithABCAnd123_ReturnSuccess) {
     ASSERT_EQ("123", std::string(credentials->getPassword()));
 }
 
+TYPED_TEST(MultiSmtpClientBaseFixture, getCommunicationLogView_Default_ReturnEmpty) {
+    ASSERT_TRUE(this->client.getCommunicationLogView().empty());
+}
+
+TEST(CPP_SmtpClient, getServerNameView_WithServerName_ReturnServerName) {
+    FakeCPPSMTPClientBase<::jed_utils::cpp::SmtpClient> client("test", 587);
+    ASSERT_EQ("test", client.getServerNameView());
+    client.setServerName("smtp.example.com");
+    ASSERT_EQ("smtp.example.com", client.getServerNameView());
+}
+
 TYPED_TEST(MultiSmtpClientBaseFixture, extractReturnCode_ValidWelcomeCode220_Return220) {
     ASSERT_EQ(220, TypeParam::extractReturnCode("220 smtp.gmail.com ESMTP z13sm224346qkj.34 - gsmtp"));
 }
@@ -275,6 +434,18 @@ TYPED_TEST(MultiSmtpClientBaseFixture, extractReturnCode_NullPtr_ReturnMinus1) {
     ASSERT_EQ(-1, TypeParam::extractReturnCode(TypeParam::getNullChar()));
 }
 
+TYPED_TEST(MultiSmtpClientBaseFixture, extractReturnCode_TwoDigits_ReturnMinus1) {
+    ASSERT_EQ(-1, TypeParam::extractReturnCode("25"));
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractReturnCode_NegativeNumber_ReturnMinus1) {
+    ASSERT_EQ(-1, TypeParam::extractReturnCode("-25 error"));
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractReturnCode_LeadingSpace_ReturnMinus1) {
+    ASSERT_EQ(-1, TypeParam::extractReturnCode(" 250 OK"));
+}
+
 TYPED_TEST(MultiSmtpClientBaseFixture, getCommandTimeout_DefaultTimeOut_Return5) {
     TypeParam client1("fdfdsfs", 587);
     ASSERT_EQ(5, client1.getCommandTimeout());
@@ -286,6 +457,24 @@ TYPED_TEST(MultiSmtpClientBaseFixture, setCommandTimeout_With2_Return2) {
     ASSERT_EQ(2, client1.getCommandTimeout());
 }
 
+TYPED_TEST(MultiSmtpClientBaseFixture, getCommandTimeoutInMilliseconds_DefaultTimeOut_Return5000) {
+    TypeParam client1("fdfdsfs", 587);
+    ASSERT_EQ(5000, client1.getCommandTimeoutInMilliseconds());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, setCommandTimeout_With2_Return2000Milliseconds) {
+    TypeParam client1("fdfdsfs", 587);
+    client1.setCommandTimeout(2);
+    ASSERT_EQ(2000, client1.getCommandTimeoutInMilliseconds());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, setCommandTimeoutInMilliseconds_With1500_Return1500) {
+    TypeParam client1("fdfdsfs", 587);
+    client1.setCommandTimeoutInMilliseconds(1500);
+    ASSERT_EQ(1500, client1.getCommandTimeoutInMilliseconds());
+    ASSERT_EQ(1, client1.getCommandTimeout());
+}
+
 TYPED_TEST(MultiSmtpClientBaseFixture, extractAuthenticationOptions_WithNullEhlo_ReturnNullptr) {
     ASSERT_EQ(nullptr, TypeParam::extractAuthenticationOptions(nullptr));
 }
@@ -335,6 +524,269 @@ TYPED_TEST(MultiSmtpClientBaseFixture, extractAuthenticationOptions_WithAuthMult
     ASSERT_TRUE(options->XOAuth);
 }
 
+TYPED_TEST(MultiSmtpClientBaseFixture, extractAuthenticationOptions_WithAuthOnLastLineEhlo_ReturnOptions) {
+    ServerAuthOptions *options = TypeParam::extractAuthenticationOptions("250-PIPELINING\r\n250 AUTH LOGIN PLAIN\r");
+    ASSERT_NE(nullptr, options);
+    ASSERT_TRUE(options->Plain);
+    ASSERT_TRUE(options->Login);
+    ASSERT_FALSE(options->XOAuth2);
+    delete options;
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithNullEhlo_ReturnNoCapabilities) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities(nullptr);
+    ASSERT_FALSE(capabilities.Pipelining);
+    ASSERT_FALSE(capabilities.StartTLS);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithEmptyEhlo_ReturnNoCapabilities) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("");
+    ASSERT_FALSE(capabilities.Pipelining);
+    ASSERT_FALSE(capabilities.StartTLS);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithNoExtensionsEhlo_ReturnNoCapabilities) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("250-SIZE 35882577\r\n250 8BITMIME\r\n");
+    ASSERT_FALSE(capabilities.Pipelining);
+    ASSERT_FALSE(capabilities.StartTLS);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithPipeliningAndStartTLSEhlo_ReturnBoth) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("250-smtp.example.com\r\n250-PIPELINING\r\n250-STARTTLS\r\n250 8BITMIME\r\n");
+    ASSERT_TRUE(capabilities.Pipelining);
+    ASSERT_TRUE(capabilities.StartTLS);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithPipeliningOnLastLineWithoutCRLF_ReturnPipelining) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("250-smtp.example.com\r\n250 PIPELINING\r");
+    ASSERT_TRUE(capabilities.Pipelining);
+    ASSERT_FALSE(capabilities.StartTLS);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithLowercaseKeyword_ReturnPipelining) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("250-smtp.example.com\r\n250-pipelining\r\n");
+    ASSERT_TRUE(capabilities.Pipelining);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithKeywordAsPrefix_ReturnNoCapabilities) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("250-PIPELININGX\r\n250 XSTARTTLS\r\n");
+    ASSERT_FALSE(capabilities.Pipelining);
+    ASSERT_FALSE(capabilities.StartTLS);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithChunkingBinaryMimeAnd8BitMimeEhlo_ReturnAll) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("250-smtp.example.com\r\n250-CHUNKING\r\n250-BINARYMIME\r\n250 8BITMIME\r\n");
+    ASSERT_TRUE(capabilities.Chunking);
+    ASSERT_TRUE(capabilities.BinaryMime);
+    ASSERT_TRUE(capabilities.EightBitMime);
+    ASSERT_FALSE(capabilities.Pipelining);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithNoExtensionsEhlo_ReturnNoChunking) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("250-SIZE 35882577\r\n250 HELP\r\n");
+    ASSERT_FALSE(capabilities.Chunking);
+    ASSERT_FALSE(capabilities.BinaryMime);
+    ASSERT_FALSE(capabilities.EightBitMime);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithGmailEhlo_ReturnAll) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("250-smtp.gmail.com at your service, [24.48.180.30]\r\n"
+            "250-SIZE 35882577\r\n"
+            "250-8BITMIME\r\n"
+            "250-AUTH LOGIN PLAIN XOAUTH2 PLAIN-CLIENTTOKEN OAUTHBEARER XOAUTH\r\n"
+            "250-ENHANCEDSTATUSCODES\r\n"
+            "250-PIPELINING\r\n"
+            "250-CHUNKING\r\n"
+            "250 SMTPUTF8\r\n");
+    ASSERT_TRUE(capabilities.Size);
+    ASSERT_EQ(35882577U, capabilities.MaxMessageSize);
+    ASSERT_TRUE(capabilities.EightBitMime);
+    ASSERT_TRUE(capabilities.EnhancedStatusCodes);
+    ASSERT_TRUE(capabilities.Pipelining);
+    ASSERT_TRUE(capabilities.Chunking);
+    ASSERT_TRUE(capabilities.SmtpUtf8);
+    ASSERT_FALSE(capabilities.StartTLS);
+    ASSERT_FALSE(capabilities.BinaryMime);
+    ASSERT_TRUE(capabilities.Auth);
+    ASSERT_TRUE(capabilities.AuthOptions.Login);
+    ASSERT_TRUE(capabilities.AuthOptions.Plain);
+    ASSERT_TRUE(capabilities.AuthOptions.XOAuth2);
+    ASSERT_TRUE(capabilities.AuthOptions.Plain_ClientToken);
+    ASSERT_TRUE(capabilities.AuthOptions.OAuthBearer);
+    ASSERT_TRUE(capabilities.AuthOptions.XOAuth);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithSizeWithoutLimit_ReturnSizeWithZero) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("250-smtp.example.com\r\n250 SIZE\r\n");
+    ASSERT_TRUE(capabilities.Size);
+    ASSERT_EQ(0U, capabilities.MaxMessageSize);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithInvalidSize_ReturnSizeWithZero) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("250-smtp.example.com\r\n250 SIZE 10MB\r\n");
+    ASSERT_TRUE(capabilities.Size);
+    ASSERT_EQ(0U, capabilities.MaxMessageSize);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithoutAuth_ReturnNoAuth) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("250-smtp.example.com\r\n250 PIPELINING\r\n");
+    ASSERT_FALSE(capabilities.Auth);
+    ASSERT_FALSE(capabilities.AuthOptions.Plain);
+    ASSERT_FALSE(capabilities.AuthOptions.Login);
+    ASSERT_FALSE(capabilities.Size);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithLowercaseAuthMechanisms_ReturnMechanisms) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("250-smtp.example.com\r\n250 auth login plain\r\n");
+    ASSERT_TRUE(capabilities.Auth);
+    ASSERT_TRUE(capabilities.AuthOptions.Login);
+    ASSERT_TRUE(capabilities.AuthOptions.Plain);
+    ASSERT_FALSE(capabilities.AuthOptions.XOAuth2);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithOldAuthEqualsForm_ReturnMechanisms) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("250-smtp.example.com\r\n250-AUTH=LOGIN\r\n250 STARTTLS\r\n");
+    ASSERT_TRUE(capabilities.Auth);
+    ASSERT_TRUE(capabilities.AuthOptions.Login);
+    ASSERT_FALSE(capabilities.AuthOptions.Plain);
+    ASSERT_TRUE(capabilities.StartTLS);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithBareLFLineEndings_ReturnAll) {
+    ServerCapabilities capabilities = TypeParam::extractServerCapabilities("250-smtp.example.com\n250-SMTPUTF8\n250 ENHANCEDSTATUSCODES");
+    ASSERT_TRUE(capabilities.SmtpUtf8);
+    ASSERT_TRUE(capabilities.EnhancedStatusCodes);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractServerCapabilities_WithDsn_ReturnDsn) {
+    ASSERT_TRUE(TypeParam::extractServerCapabilities("250-smtp.example.com\r\n250 DSN\r\n").Dsn);
+    ASSERT_FALSE(TypeParam::extractServerCapabilities("250-smtp.example.com\r\n250 8BITMIME\r\n").Dsn);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, getDsnOptions_Default_ReturnNoNotification) {
+    const DsnOptions &options = this->client.getDsnOptions();
+    ASSERT_FALSE(options.NotifySuccess || options.NotifyFailure || options.NotifyDelay || options.NotifyNever);
+    ASSERT_EQ(DsnReturn::Default, options.Return);
+    ASSERT_TRUE(options.EnvelopeId.empty());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, setDsnOptions_WithOptions_ReturnOptions) {
+    DsnOptions options;
+    options.NotifyFailure = true;
+    options.Return = DsnReturn::Headers;
+    options.EnvelopeId = "QQ314159";
+    this->client.setDsnOptions(options);
+    ASSERT_TRUE(this->client.getDsnOptions().NotifyFailure);
+    ASSERT_EQ(DsnReturn::Headers, this->client.getDsnOptions().Return);
+    ASSERT_EQ("QQ314159", this->client.getDsnOptions().EnvelopeId);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, extractAuthenticationOptions_WithAuthOnSeveralLines_ReturnAllMechanisms) {
+    ServerAuthOptions *options = TypeParam::extractAuthenticationOptions("250-AUTH LOGIN\r\n250 AUTH=PLAIN\r\n");
+    ASSERT_NE(nullptr, options);
+    ASSERT_TRUE(options->Login);
+    ASSERT_TRUE(options->Plain);
+    delete options;
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, isChunkingEnabled_Default_ReturnTrue) {
+    ASSERT_TRUE(this->client.isChunkingEnabled());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, setChunkingEnabled_WithFalse_ReturnFalse) {
+    this->client.setChunkingEnabled(false);
+    ASSERT_FALSE(this->client.isChunkingEnabled());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, isPipeliningEnabled_Default_ReturnTrue) {
+    ASSERT_TRUE(this->client.isPipeliningEnabled());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, setPipeliningEnabled_WithFalse_ReturnFalse) {
+    this->client.setPipeliningEnabled(false);
+    ASSERT_FALSE(this->client.isPipeliningEnabled());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, getDataWriteSize_Default_Return65536) {
+    ASSERT_EQ(65536, this->client.getDataWriteSize());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, setDataWriteSize_With16384_Return16384) {
+    this->client.setDataWriteSize(16384);
+    ASSERT_EQ(16384, this->client.getDataWriteSize());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, setDataWriteSize_WithValueBelowMinimum_Return512) {
+    this->client.setDataWriteSize(0);
+    ASSERT_EQ(512, this->client.getDataWriteSize());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, getTransportOptions_Default_ReturnDefaultOptions) {
+    const TransportOptions &options = this->client.getTransportOptions();
+    ASSERT_EQ(1024, options.ReadBufferSize);
+    ASSERT_EQ(65536, options.WriteSize);
+    ASSERT_TRUE(options.NoDelay);
+    ASSERT_EQ(0, options.SendBufferSize);
+    ASSERT_EQ(0, options.ReceiveBufferSize);
+    ASSERT_FALSE(options.KeepAlive);
+    ASSERT_EQ(0, options.ConnectTimeoutInMilliseconds);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, setTransportOptions_WithValidOptions_ReturnOptions) {
+    TransportOptions options;
+    options.ReadBufferSize = 8192;
+    options.WriteSize = 262144;
+    options.NoDelay = false;
+    options.SendBufferSize = 1048576;
+    options.ReceiveBufferSize = 524288;
+    options.KeepAlive = true;
+    options.KeepAliveIdleSeconds = 60;
+    options.KeepAliveIntervalSeconds = 10;
+    options.KeepAliveProbeCount = 5;
+    options.ConnectTimeoutInMilliseconds = 2000;
+    this->client.setTransportOptions(options);
+    const TransportOptions &result = this->client.getTransportOptions();
+    ASSERT_EQ(8192, result.ReadBufferSize);
+    ASSERT_EQ(262144, result.WriteSize);
+    ASSERT_EQ(262144, this->client.getDataWriteSize());
+    ASSERT_FALSE(result.NoDelay);
+    ASSERT_EQ(1048576, result.SendBufferSize);
+    ASSERT_EQ(524288, result.ReceiveBufferSize);
+    ASSERT_TRUE(result.KeepAlive);
+    ASSERT_EQ(60, result.KeepAliveIdleSeconds);
+    ASSERT_EQ(10, result.KeepAliveIntervalSeconds);
+    ASSERT_EQ(5, result.KeepAliveProbeCount);
+    ASSERT_EQ(2000, result.ConnectTimeoutInMilliseconds);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, setTransportOptions_WithSizesBelowMinimum_Return512) {
+    TransportOptions options;
+    options.ReadBufferSize = 16;
+    options.WriteSize = 0;
+    this->client.setTransportOptions(options);
+    ASSERT_EQ(512, this->client.getTransportOptions().ReadBufferSize);
+    ASSERT_EQ(512, this->client.getTransportOptions().WriteSize);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, setDataWriteSize_With16384_ReturnTransportOptionsWriteSize16384) {
+    this->client.setDataWriteSize(16384);
+    ASSERT_EQ(16384, this->client.getTransportOptions().WriteSize);
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, getAttachmentPrefetchBlockCount_Default_Return4) {
+    ASSERT_EQ(4, this->client.getAttachmentPrefetchBlockCount());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, setAttachmentPrefetchBlockCount_With0_Return0) {
+    this->client.setAttachmentPrefetchBlockCount(0);
+    ASSERT_EQ(0, this->client.getAttachmentPrefetchBlockCount());
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, getServerCapabilities_BeforeConnect_ReturnNoCapabilities) {
+    ASSERT_FALSE(this->client.getServerCapabilities().Pipelining);
+    ASSERT_FALSE(this->client.getServerCapabilities().StartTLS);
+}
+
 TYPED_TEST(MultiSmtpClientBaseFixture, getErrorMessage_WithZero_ReturnNoMessage) {
     ASSERT_EQ("No message correspond to this error code",
               std::string(TypeParam::getErrorMessage(0)));
@@ -349,6 +801,811 @@ TYPED_TEST(MultiSmtpClientBaseFixture, getErrorMessage_With538_ReturnErrorMessag
               std::string(TypeParam::getErrorMessage(SMTPSERVER_ENCRYPTIONREQUIREDFORAUTH_ERROR)));
 }
 
+TEST(SMTPClientBase_sendMail, WithMessageOverServerSizeLimit_ReturnSizeExceededBeforeMailFrom) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    client.setServerCapabilities(FakeSMTPClientBase::extractServerCapabilities("250-localhost\r\n250 SIZE 100\r\n"));
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", std::string(200, 'a').c_str());
+    ASSERT_EQ(CLIENT_SENDMAIL_MESSAGE_SIZE_EXCEEDED_ERROR, client.sendMail(msg));
+    ASSERT_TRUE(client.getCommandsWithFeedback().empty());
+}
+
+TEST(SMTPClientBase_sendMail, WithMessageUnderServerSizeLimit_DeclareSizeInMailFrom) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    client.setServerCapabilities(FakeSMTPClientBase::extractServerCapabilities("250-localhost\r\n250 SIZE 35882577\r\n"));
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(0, client.sendMail(msg));
+    ASSERT_FALSE(client.getCommandsWithFeedback().empty());
+    ASSERT_EQ("MAIL FROM: < from@test.com> SIZE="s + std::to_string(MimeWriter::computeSize(msg, MimeBoundary())) + "\r\n"s,
+            client.getCommandsWithFeedback()[0]);
+}
+
+TEST(SMTPClientBase_sendMail, WithSizeWithoutLimit_DeclareSizeInMailFrom) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    client.setServerCapabilities(FakeSMTPClientBase::extractServerCapabilities("250-localhost\r\n250 SIZE\r\n"));
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", std::string(200, 'a').c_str());
+    ASSERT_EQ(0, client.sendMail(msg));
+    ASSERT_EQ("MAIL FROM: < from@test.com> SIZE="s + std::to_string(MimeWriter::computeSize(msg, MimeBoundary())) + "\r\n"s,
+            client.getCommandsWithFeedback()[0]);
+}
+
+TEST(SMTPClientBase_sendMail, WithoutSizeExtension_DoNotDeclareSize) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(0, client.sendMail(msg));
+    ASSERT_EQ("MAIL FROM: < from@test.com>\r\n"s, client.getCommandsWithFeedback()[0]);
+}
+
+TEST(SMTPClientBase_sendMail, WithManyRecipients_SendHeadersWithBodyInOneWrite) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    std::vector<MessageAddress> recipients;
+    for (int index = 0; index < 100; index++) {
+        recipients.emplace_back(("to" + std::to_string(index) + "@test.com").c_str());
+    }
+    PlaintextMessage msg(MessageAddress("from@test.com"),
+            recipients.data(),
+            recipients.size(),
+            "Subject",
+            "Body");
+    ASSERT_EQ(0, client.sendMail(msg));
+    // The header lines are not sent one by one
+    for (const auto &command : client.getCommands()) {
+        ASSERT_EQ(std::string::npos, command.find("@test.com")) << command;
+    }
+    ASSERT_EQ(1U, client.getDataWrites().size());
+    const std::string &content = client.getDataWrites()[0];
+    ASSERT_EQ(0U, content.find("From: "));
+    ASSERT_NE(std::string::npos, content.find("to99@test.com"));
+    ASSERT_NE(std::string::npos, content.find("Subject: Subject\r\n"));
+    ASSERT_NE(std::string::npos, content.find("\r\nBody\r\n"));
+}
+
+namespace {
+// Return the boundary declared in the headers of a content
+MimeBoundary extractBoundary(const std::string &pContent) {
+    const std::string PARAMETER = "boundary=\"";
+    const size_t start = pContent.find(PARAMETER) + PARAMETER.size();
+    return MimeBoundary(pContent.substr(start, pContent.find('"', start) - start));
+}
+}  // namespace
+
+TEST(SMTPClientBase_sendMail, WithDataCommand_SendEndOfDataWithBody) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(0, client.sendMail(msg));
+    const MimeBoundary first_boundary = extractBoundary(client.getDataWrites()[0]);
+    const std::string first_closing_delimiter { first_boundary.getClosingDelimiter() };
+    ASSERT_EQ(client.getDataWrites()[0].size() - first_closing_delimiter.size(), client.getDataWrites()[0].rfind(first_closing_delimiter));
+    ASSERT_EQ("\r\n.\r\n", client.getCommandsWithFeedback().back());
+    // The next message starts with its own headers and boundary
+    ASSERT_EQ(0, client.sendMail(msg));
+    ASSERT_EQ(2U, client.getDataWrites().size());
+    ASSERT_EQ(0U, client.getDataWrites()[1].find("From: "));
+    const MimeBoundary second_boundary = extractBoundary(client.getDataWrites()[1]);
+    ASSERT_NE(first_boundary.getValue(), second_boundary.getValue());
+    ASSERT_NE(std::string::npos, client.getDataWrites()[1].find(second_boundary.getClosingDelimiter()));
+    ASSERT_NE(std::string::npos, client.getDataWrites()[1].find(std::string(second_boundary.getDelimiter()) + "\r\nContent-Type: text/plain"));
+}
+
+TEST(SMTPClientBase_sendMail, WithSeveralAttachments_SendSameContentWithAndWithoutPrefetch) {
+    std::vector<Attachment> attachments;
+    for (int index = 0; index < 3; index++) {
+        attachments.emplace_back(std::make_shared<BufferAttachmentSource>(std::string(200000, static_cast<char>('a' + index))),
+                ("file" + std::to_string(index) + ".txt").c_str());
+    }
+    PlaintextMessage msg(MessageAddress("from@test.com"),
+            MessageAddress("to@test.com"),
+            "Subject",
+            "Body",
+            nullptr,
+            nullptr,
+            attachments.data(),
+            attachments.size());
+    FakeSMTPClientBase prefetch_client("127.0.0.1", 587);
+    prefetch_client.setAttachmentPrefetchBlockCount(1);
+    ASSERT_EQ(0, prefetch_client.sendMail(msg));
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    client.setAttachmentPrefetchBlockCount(0);
+    ASSERT_EQ(0, client.sendMail(msg));
+    // The boundaries of the messages differ, not the blocks of the
+    // attachments. The last write is the closing delimiter.
+    ASSERT_EQ(client.getDataWrites().size(), prefetch_client.getDataWrites().size());
+    for (size_t index = 1; index + 1 < client.getDataWrites().size(); index++) {
+        ASSERT_EQ(client.getDataWrites()[index].size(), prefetch_client.getDataWrites()[index].size());
+        const std::string &data = prefetch_client.getDataWrites()[index];
+        const std::string expected = client.getDataWrites()[index];
+        ASSERT_EQ(expected.substr(expected.size() - 1000), data.substr(data.size() - 1000));
+    }
+}
+
+TEST(SMTPClientBase_sendMail, WithTextAttachmentEncoding_SendTextAttachmentInQuotedPrintable) {
+    const Attachment attachments[] {
+        Attachment(std::make_shared<BufferAttachmentSource>("name=value\n.dot\n"), "report.csv"),
+        Attachment(std::make_shared<BufferAttachmentSource>("Hello"), "image.png")
+    };
+    PlaintextMessage msg(MessageAddress("from@test.com"),
+            MessageAddress("to@test.com"),
+            "Subject",
+            "Body",
+            nullptr,
+            nullptr,
+            attachments,
+            2);
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    client.setTextAttachmentEncodingEnabled(true);
+    ASSERT_TRUE(client.isTextAttachmentEncodingEnabled());
+    ASSERT_EQ(0, client.sendMail(msg));
+    std::string data;
+    for (const auto &write : client.getDataWrites()) {
+        data += write;
+    }
+    const MimeBoundary boundary = extractBoundary(data);
+    ASSERT_NE(std::string::npos, data.find(
+            MimeWriter::createAttachmentHeader(attachments[0], boundary, "quoted-printable") + "name=3Dvalue\r\n=2Edot\r\n"));
+    ASSERT_NE(std::string::npos, data.find(MimeWriter::createAttachmentHeader(attachments[1], boundary) + "SGVsbG8="));
+}
+
+namespace {
+std::shared_ptr<const DkimSigner> createDkimSigner() {
+    EVP_PKEY *key = nullptr;
+    EVP_PKEY_CTX *context = EVP_PKEY_CTX_new_id(EVP_PKEY_ED25519, nullptr);
+    EVP_PKEY_keygen_init(context);
+    EVP_PKEY_keygen(context, &key);
+    EVP_PKEY_CTX_free(context);
+    BIO *bio = BIO_new(BIO_s_mem());
+    PEM_write_bio_PrivateKey(bio, key, nullptr, nullptr, 0, nullptr, nullptr);
+    char *data = nullptr;
+    const long length = BIO_get_mem_data(bio, &data);
+    auto dkim_key = std::make_shared<DkimKey>(std::string_view(data, static_cast<size_t>(length)));
+    BIO_free(bio);
+    EVP_PKEY_free(key);
+    return std::make_shared<DkimSigner>("example.com", "sel", dkim_key);
+}
+
+std::string getBodyHashTag(const std::string &pContent) {
+    const size_t start = pContent.find("bh=");
+    return start == std::string::npos ? "" : pContent.substr(start, pContent.find(';', start) - start);
+}
+
+std::string hashDkimBody(const std::string &pContent) {
+    DkimBodyHasher hasher;
+    hasher.update(pContent.substr(pContent.find("\r\n\r\n") + 4));
+    return "bh=" + hasher.finish();
+}
+
+PlaintextMessage createDkimMessage(const Attachment *pAttachments, size_t pAttachmentCount) {
+    return PlaintextMessage(MessageAddress("from@example.com"),
+            MessageAddress("to@test.com"),
+            "Subject",
+            "Body with  spaces \n.dot line\n",
+            nullptr,
+            nullptr,
+            pAttachments,
+            pAttachmentCount);
+}
+}  // namespace
+
+TEST(SMTPClientBase_sendMail, WithDkimSigner_SendSignatureOfContentBeforeHeaders) {
+    const Attachment attachments[] { Attachment(std::make_shared<BufferAttachmentSource>(std::string(100000, 'x')), "data.bin") };
+    PlaintextMessage msg { createDkimMessage(attachments, 1) };
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    client.setDkimSigner(createDkimSigner());
+    ASSERT_NE(nullptr, client.getDkimSigner());
+    ASSERT_EQ(0, client.sendMail(msg));
+    std::string content;
+    for (const auto &write : client.getDataWrites()) {
+        content += write;
+    }
+    ASSERT_EQ(0U, content.find("DKIM-Signature: v=1; a=ed25519-sha256; c=relaxed/relaxed; d=example.com; s=sel;\r\n"));
+    ASSERT_NE(std::string::npos, content.find("\r\nFrom: from@example.com\r\n"));
+    // The receiver reads the content without the dot-stuffing
+    std::string end_of_data { client.getCommandsWithFeedback().back() };
+    content += end_of_data.substr(0, end_of_data.size() - 3);
+    size_t stuffed_dot = content.find("\r\n..dot");
+    ASSERT_NE(std::string::npos, stuffed_dot);
+    content.erase(stuffed_dot + 2, 1);
+    ASSERT_EQ(hashDkimBody(content), getBodyHashTag(content));
+}
+
+TEST(SMTPClientBase_sendMail, WithDkimSignerAndChunking_SignSameBodyAsWithData) {
+    const Attachment attachments[] { Attachment(std::make_shared<BufferAttachmentSource>("a;b\n"), "data.csv") };
+    PlaintextMessage msg { createDkimMessage(attachments, 1) };
+    auto signer = createDkimSigner();
+    FakeSMTPClientBase data_client("127.0.0.1", 587);
+    data_client.setDkimSigner(signer);
+    ASSERT_EQ(0, data_client.sendMail(msg));
+    FakeSMTPClientBase chunking_client("127.0.0.1", 587);
+    chunking_client.setServerCapabilities(FakeSMTPClientBase::extractServerCapabilities(
+                "250-localhost\r\n250 CHUNKING\r\n"));
+    chunking_client.setDkimSigner(signer);
+    // The fake server does not reply to BDAT, only the first chunk is sent
+    chunking_client.sendMail(msg);
+    ASSERT_FALSE(chunking_client.getDataWrites().empty());
+    ASSERT_EQ(0U, chunking_client.getDataWrites()[0].find("BDAT "));
+    ASSERT_NE(std::string::npos, chunking_client.getDataWrites()[0].find("\r\nDKIM-Signature: "));
+    // The content sent with DATA, without its dot-stuffing and with the
+    // boundary of the chunked message, has the same body hash
+    std::string content;
+    for (const auto &write : data_client.getDataWrites()) {
+        content += write;
+    }
+    const std::string end_of_data { data_client.getCommandsWithFeedback().back() };
+    content += end_of_data.substr(0, end_of_data.size() - 3);
+    content.erase(content.find("\r\n..dot") + 2, 1);
+    const std::string data_boundary { extractBoundary(content).getValue() };
+    const std::string chunking_boundary { extractBoundary(chunking_client.getDataWrites()[0]).getValue() };
+    for (size_t position = content.find(data_boundary); position != std::string::npos; position = content.find(data_boundary, position)) {
+        content.replace(position, data_boundary.size(), chunking_boundary);
+    }
+    ASSERT_EQ(hashDkimBody(content), getBodyHashTag(chunking_client.getDataWrites()[0]));
+}
+
+TEST(SMTPClientBase_sendRenderedMail, WithDkimSigner_SendSignatureOfRenderedContent) {
+    PlaintextMessage msg { createDkimMessage(nullptr, 0) };
+    MimeWriter writer;
+    ASSERT_EQ(0, writer.write(msg));
+    const std::string rendered { writer.getContent() };
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    client.setDkimSigner(createDkimSigner());
+    const char *recipients[] { "to@test.com" };
+    ASSERT_EQ(0, client.sendRenderedMail("from@example.com", recipients, 1, rendered.c_str(), rendered.size()));
+    std::string content;
+    for (const auto &write : client.getDataWrites()) {
+        content += write;
+    }
+    ASSERT_EQ(0U, content.find("DKIM-Signature: "));
+    ASSERT_EQ(hashDkimBody(rendered), getBodyHashTag(content));
+}
+
+TYPED_TEST(MultiSmtpClientBaseFixture, isTextAttachmentEncodingEnabled_Default_ReturnFalse) {
+    ASSERT_FALSE(this->client.isTextAttachmentEncodingEnabled());
+}
+
+namespace {
+void setAcceptedEnvelope(FakeSMTPClientBase &pClient) {
+    pClient.setReply("MAIL FROM", STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED);
+    pClient.setReply("RCPT TO", STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED);
+    pClient.setReply("RSET", STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED);
+}
+
+long countCommand(const std::vector<std::string> &pCommands, const std::string &pCommand) {
+    return std::count(pCommands.begin(), pCommands.end(), pCommand);
+}
+
+std::string findCommand(const std::vector<std::string> &pCommands, const std::string &pPrefix) {
+    auto command = std::find_if(pCommands.begin(), pCommands.end(), [&pPrefix](const std::string &pCommand) {
+            return pCommand.find(pPrefix) == 0;
+            });
+    return command != pCommands.end() ? *command : "";
+}
+}  // namespace
+
+TEST(SMTPClientBase_sendMail, WithPersistentSessionAndSuccess_SendNoRset) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(0, client.connect());
+    ASSERT_EQ(0, client.sendMail(msg));
+    ASSERT_EQ(0, client.sendMail(msg));
+    ASSERT_EQ(0, countCommand(client.getCommandsWithFeedback(), "RSET\r\n"));
+    const auto &commands = client.getCommandsWithFeedback();
+    ASSERT_EQ(2, std::count_if(commands.begin(), commands.end(), [](const std::string &pCommand) {
+            return pCommand.find("MAIL FROM") == 0;
+            }));
+}
+
+TEST(SMTPClientBase_sendMail, WithPersistentSessionAndRejectedRecipient_ResetAndKeepSession) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    client.setReply("RCPT TO", 550);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(0, client.connect());
+    ASSERT_EQ(550, client.sendMail(msg));
+    ASSERT_EQ("RSET\r\n", client.getCommandsWithFeedback().back());
+    ASSERT_TRUE(client.isConnected());
+    ASSERT_EQ(0, client.getCleanupCount());
+    // The next transaction does not need another reset
+    client.setReply("RCPT TO", STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED);
+    ASSERT_EQ(0, client.sendMail(msg));
+    ASSERT_EQ(1, countCommand(client.getCommandsWithFeedback(), "RSET\r\n"));
+}
+
+TEST(SMTPClientBase_sendMail, WithPersistentSessionAndRejectedReset_CloseSession) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    client.setReply("RCPT TO", 550);
+    client.setReply("RSET", STATUS_CODE_SERVICE_NOT_AVAILABLE);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(0, client.connect());
+    ASSERT_EQ(550, client.sendMail(msg));
+    ASSERT_FALSE(client.isConnected());
+    ASSERT_EQ(1, client.getCleanupCount());
+}
+
+TEST(SMTPClientBase_sendMail, WithPersistentSessionAndInterruptedContent_CloseSessionWithoutRset) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    client.setReply("DATA", STATUS_CODE_START_MAIL_INPUT);
+    // The first block is sent, then the content cannot be read anymore
+    auto read_count = std::make_shared<int>(0);
+    std::vector<Attachment> attachments;
+    attachments.emplace_back(std::make_shared<CallbackAttachmentSource>([read_count](char *pBuffer, size_t pBufferSize, size_t &pBytesRead) {
+            if ((*read_count)++ > 0) {
+                return -1;
+            }
+            pBytesRead = pBufferSize;
+            memset(pBuffer, 'a', pBufferSize);
+            return 0;
+            }), "file.txt");
+    PlaintextMessage msg(MessageAddress("from@test.com"),
+            MessageAddress("to@test.com"),
+            "Subject",
+            "Body",
+            nullptr,
+            nullptr,
+            attachments.data(),
+            attachments.size());
+    ASSERT_EQ(0, client.connect());
+    ASSERT_EQ(CLIENT_SENDMAIL_BODYPART_ERROR, client.sendMail(msg));
+    ASSERT_EQ(0, countCommand(client.getCommandsWithFeedback(), "RSET\r\n"));
+    ASSERT_FALSE(client.isConnected());
+}
+
+TEST(SMTPClientBase_sendMail, WithoutSessionAndRejectedRecipient_QuitAndClose) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    client.setReply("RCPT TO", 550);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(550, client.sendMail(msg));
+    ASSERT_EQ("QUIT\r\n", client.getCommands().back());
+    ASSERT_EQ(1, client.getCleanupCount());
+    ASSERT_EQ(0, countCommand(client.getCommandsWithFeedback(), "RSET\r\n"));
+}
+
+TEST(SMTPClientBase_resolveServerCapabilities, WithCapabilityCache_ParseSameResponseOnce) {
+    FakeSMTPClientBase client("smtp.example.com", 587);
+    auto cache = std::make_shared<CapabilityCache>();
+    client.setCapabilityCache(cache);
+    ASSERT_EQ(cache, client.getCapabilityCache());
+    client.setLastServerResponse("250-smtp.example.com\r\n250-PIPELINING\r\n250 SIZE 1000\r\n");
+    ASSERT_TRUE(client.resolveServerCapabilities(false).Pipelining);
+    ASSERT_EQ(1000U, client.resolveServerCapabilities(false).MaxMessageSize);
+    ASSERT_EQ(1U, cache->getMissCount());
+    ASSERT_EQ(1U, cache->getHitCount());
+    ServerCapabilities capabilities;
+    ASSERT_TRUE(cache->find("smtp.example.com", 587, false, capabilities));
+    ASSERT_TRUE(capabilities.Pipelining);
+}
+
+TEST(SMTPClientBase_resolveServerCapabilities, WithRefusedEhlo_KeepCachedCapabilities) {
+    FakeSMTPClientBase client("smtp.example.com", 587);
+    auto cache = std::make_shared<CapabilityCache>();
+    client.setCapabilityCache(cache);
+    client.setLastServerResponse("250-smtp.example.com\r\n250 PIPELINING\r\n");
+    client.resolveServerCapabilities(false);
+    client.setLastServerResponse("421 Service not available\r\n");
+    ASSERT_FALSE(client.resolveServerCapabilities(false).Pipelining);
+    ServerCapabilities capabilities;
+    ASSERT_TRUE(cache->find("smtp.example.com", 587, false, capabilities));
+    ASSERT_TRUE(capabilities.Pipelining);
+}
+
+TEST(SMTPClientBase_prepare, WithoutSession_OpenSession) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    ASSERT_EQ(0, client.prepare());
+    ASSERT_TRUE(client.isConnected());
+    ASSERT_EQ(0, countCommand(client.getCommandsWithFeedback(), "NOOP\r\n"));
+}
+
+TEST(SMTPClientBase_prepare, WithOpenedSession_SendNoopAndKeepSession) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    client.setReply("NOOP", STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED);
+    ASSERT_EQ(0, client.prepare());
+    ASSERT_EQ(0, client.prepare());
+    ASSERT_EQ(1, countCommand(client.getCommandsWithFeedback(), "NOOP\r\n"));
+    ASSERT_TRUE(client.isConnected());
+    ASSERT_EQ(0, client.getCleanupCount());
+}
+
+TEST(SMTPClientBase_prepare, WithDroppedSession_OpenSessionAgain) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    client.setReply("NOOP", STATUS_CODE_SERVICE_NOT_AVAILABLE);
+    ASSERT_EQ(0, client.prepare());
+    ASSERT_EQ(0, client.prepare());
+    ASSERT_TRUE(client.isConnected());
+    ASSERT_EQ(1, client.getCleanupCount());
+}
+
+namespace {
+ServerAuthOptions *createAuthOptions(bool pPlain, bool pXOAuth2, bool pOAuthBearer) {
+    auto *options = new ServerAuthOptions();
+    options->Plain = pPlain;
+    options->XOAuth2 = pXOAuth2;
+    options->OAuthBearer = pOAuthBearer;
+    return options;
+}
+
+std::shared_ptr<OAuth2TokenSource> createTokenSource() {
+    auto token_count = std::make_shared<int>(0);
+    return std::make_shared<OAuth2TokenSource>([token_count](std::string &pAccessToken, std::chrono::seconds &pLifetime) {
+        pAccessToken = "token" + std::to_string(++*token_count);
+        pLifetime = std::chrono::seconds(3600);
+        return 0;
+    });
+}
+}  // namespace
+
+TEST(SMTPClientBase_authenticateClient, WithPlain_SendCachedInitialResponse) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    client.setCredentials(Credential("ABC", "123"));
+    client.setAuthenticationOptions(createAuthOptions(true, false, false));
+    client.setReply("AUTH PLAIN", STATUS_CODE_AUTHENTICATION_SUCCEEDED);
+    ASSERT_EQ(STATUS_CODE_AUTHENTICATION_SUCCEEDED, client.authenticateClient());
+    ASSERT_EQ(STATUS_CODE_AUTHENTICATION_SUCCEEDED, client.authenticateClient());
+    ASSERT_EQ(2, countCommand(client.getCommandsWithFeedback(), "AUTH PLAIN AEFCQwAxMjM=\r\n"));
+    client.setCredentials(Credential("ABC", "456"));
+    ASSERT_EQ(STATUS_CODE_AUTHENTICATION_SUCCEEDED, client.authenticateClient());
+    ASSERT_EQ("AUTH PLAIN AEFCQwA0NTY=\r\n", client.getCommandsWithFeedback().back());
+}
+
+TEST(SMTPClientBase_authenticateClient, WithTokenAndXOAuth2_SendInitialResponse) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    auto token_source = createTokenSource();
+    client.setCredentials(Credential("u@test.com", token_source));
+    client.setAuthenticationOptions(createAuthOptions(true, true, true));
+    client.setReply("AUTH XOAUTH2", STATUS_CODE_AUTHENTICATION_SUCCEEDED);
+    ASSERT_EQ(STATUS_CODE_AUTHENTICATION_SUCCEEDED, client.authenticateClient());
+    ASSERT_EQ(STATUS_CODE_AUTHENTICATION_SUCCEEDED, client.authenticateClient());
+    ASSERT_EQ(2, countCommand(client.getCommandsWithFeedback(), "AUTH XOAUTH2 dXNlcj11QHRlc3QuY29tAWF1dGg9QmVhcmVyIHRva2VuMQEB\r\n"));
+    ASSERT_EQ(1U, token_source->getRefreshCount());
+    // The token is never written to the communication log
+    ASSERT_EQ(std::string::npos, std::string(client.getCommunicationLog()).find("dXNlcj11QHRlc3QuY29tAWF1dGg9QmVhcmVyIHRva2VuMQEB"));
+}
+
+TEST(SMTPClientBase_authenticateClient, WithTokenAndOAuthBearerRejected_EndExchangeAndRetryOnce) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    auto token_source = createTokenSource();
+    client.setCredentials(Credential("u@test.com", token_source));
+    client.setAuthenticationOptions(createAuthOptions(false, false, true));
+    // The token obtained before the session is refused by the server
+    std::string initial_response;
+    ASSERT_EQ(0, token_source->getInitialResponse(OAuth2Mechanism::OAuthBearer, "u@test.com", initial_response));
+    client.setReply("AUTH OAUTHBEARER", STATUS_CODE_SERVER_CHALLENGE);
+    client.setReply("AQ==", SMTPSERVER_CREDENTIALSINVALID_ERROR);
+    ASSERT_EQ(SMTPSERVER_CREDENTIALSINVALID_ERROR, client.authenticateClient());
+    // The cached token is replaced once, the new token is not retried
+    ASSERT_EQ(2, std::count_if(client.getCommandsWithFeedback().begin(), client.getCommandsWithFeedback().end(),
+            [](const std::string &pCommand) { return pCommand.rfind("AUTH OAUTHBEARER ", 0) == 0; }));
+    ASSERT_EQ(1, countCommand(client.getCommandsWithFeedback(), "AUTH OAUTHBEARER bixhPXVAdGVzdC5jb20sAWF1dGg9QmVhcmVyIHRva2VuMQEB\r\n"));
+    ASSERT_EQ(2, countCommand(client.getCommandsWithFeedback(), "AQ==\r\n"));
+    ASSERT_EQ(2U, token_source->getRefreshCount());
+}
+
+TEST(SMTPClientBase_authenticateClient, WithTokenAndNoTokenMechanism_ReturnNotSupported) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    client.setCredentials(Credential("u@test.com", createTokenSource()));
+    client.setAuthenticationOptions(createAuthOptions(true, false, false));
+    ASSERT_EQ(CLIENT_AUTHENTICATION_METHOD_NOTSUPPORTED, client.authenticateClient());
+    ASSERT_TRUE(client.getCommandsWithFeedback().empty());
+}
+
+TEST(SMTPClientBase_authenticateClient, WithFailingRefresher_ReturnTokenError) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    client.setCredentials(Credential("u@test.com", std::make_shared<OAuth2TokenSource>([](std::string &, std::chrono::seconds &) {
+        return -1;
+    })));
+    client.setAuthenticationOptions(createAuthOptions(false, true, false));
+    ASSERT_EQ(CLIENT_AUTHENTICATE_TOKEN_ERROR, client.authenticateClient());
+    ASSERT_TRUE(client.getCommandsWithFeedback().empty());
+}
+
+TEST(SMTPClientBase_sendBulk, WithMessageTemplate_SendRenderedCopyToEachRecipient) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    client.setReply("DATA", STATUS_CODE_START_MAIL_INPUT);
+    client.setReply("\r\n.\r\n", STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED);
+    MessageTemplate message_template("To: {{Email}}\r\nSubject: Hello {{Name}}\r\n\r\nDear {{Name}},\r\n.hidden\r\n");
+    const std::vector<MergeRecipient> recipients {
+        { "a@test.com", { { "Email", "a@test.com" }, { "Name", "A" } } },
+        { "b@test.com", { { "Email", "b@test.com" } } },
+        { "c@test.com", { { "Email", "c@test.com" }, { "Name", "C" } } }
+    };
+    auto results = client.sendBulk("from@test.com", message_template, recipients.data(), recipients.size());
+    ASSERT_EQ(3U, results.size());
+    ASSERT_EQ(0, results[0].ReturnCode);
+    // The missing merge field does not stop the batch
+    ASSERT_EQ(CLIENT_TEMPLATE_FIELD_ERROR, results[1].ReturnCode);
+    ASSERT_EQ(0, results[2].ReturnCode);
+    ASSERT_EQ(2U, client.getDataWrites().size());
+    ASSERT_EQ("To: a@test.com\r\nSubject: Hello A\r\n\r\nDear A,\r\n..hidden\r\n", client.getDataWrites()[0]);
+    ASSERT_EQ("To: c@test.com\r\nSubject: Hello C\r\n\r\nDear C,\r\n..hidden\r\n", client.getDataWrites()[1]);
+    ASSERT_EQ(1, countCommand(client.getCommandsWithFeedback(), "RCPT TO: <c@test.com>\r\n"));
+    ASSERT_EQ(0, countCommand(client.getCommandsWithFeedback(), "RCPT TO: <b@test.com>\r\n"));
+}
+
+TEST(SMTPClientBase_getOperationTimeoutInMilliseconds, NewClient_ReturnNoDeadlineAndNoToken) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    ASSERT_EQ(0, client.getOperationTimeoutInMilliseconds());
+    ASSERT_EQ(nullptr, client.getCancellationToken());
+    client.setOperationTimeoutInMilliseconds(1500);
+    ASSERT_EQ(1500, client.getOperationTimeoutInMilliseconds());
+}
+
+TEST(SMTPClientBase_CopyConstructor, AfterSend_CopyConfigurationOnly) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    client.setCredentials(Credential("user", "pass"));
+    client.setPipeliningEnabled(false);
+    client.setOperationTimeoutInMilliseconds(30000);
+    client.setCancellationToken(std::make_shared<CancellationToken>());
+    client.setCommunicationLogLevel(CommunicationLogLevel::Commands);
+    setAcceptedEnvelope(client);
+    client.setReply("RCPT TO", 550);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(550, client.sendMail(msg));
+    ASSERT_EQ(CommunicationLog::isAvailable(), !client.getCommunicationLogView().empty());
+
+    FakeSMTPClientBase copy(client);
+    ASSERT_STREQ("127.0.0.1", copy.getServerName());
+    ASSERT_STREQ("user", copy.getCredentials()->getUsername());
+    ASSERT_NE(client.getCredentials(), copy.getCredentials());
+    ASSERT_FALSE(copy.isPipeliningEnabled());
+    ASSERT_EQ(30000, copy.getOperationTimeoutInMilliseconds());
+    ASSERT_EQ(client.getCancellationToken(), copy.getCancellationToken());
+    ASSERT_EQ(CommunicationLogLevel::Commands, copy.getCommunicationLogLevel());
+    ASSERT_TRUE(copy.getCommunicationLogView().empty());
+    ASSERT_EQ(0, copy.getLastSendResult().ReturnCode);
+    ASSERT_EQ(0U, copy.getIoCounters().BytesWritten);
+    ASSERT_EQ(550, client.getLastSendResult().ReturnCode);
+}
+
+TEST(SMTPClientBase_CopyAssignment, AfterSend_CopyConfigurationOnly) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    client.setReply("RCPT TO", 550);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(550, client.sendMail(msg));
+    FakeSMTPClientBase copy("other", 25);
+    copy.setCredentials(Credential("other", "pass"));
+    copy = client;
+    ASSERT_STREQ("127.0.0.1", copy.getServerName());
+    ASSERT_EQ(nullptr, copy.getCredentials());
+    ASSERT_TRUE(copy.getCommunicationLogView().empty());
+    ASSERT_EQ(0, copy.getLastSendResult().ReturnCode);
+}
+
+TEST(SMTPClientBase_MoveConstructor, AfterSend_KeepSessionState) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    client.setCredentials(Credential("user", "pass"));
+    setAcceptedEnvelope(client);
+    client.setReply("RCPT TO", 550);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(550, client.sendMail(msg));
+    const std::string log { client.getCommunicationLogView() };
+    const Credential *credential = client.getCredentials();
+
+    FakeSMTPClientBase moved(std::move(client));
+    ASSERT_EQ(log, moved.getCommunicationLogView());
+    ASSERT_EQ(550, moved.getLastSendResult().ReturnCode);
+    // The credential is not copied
+    ASSERT_EQ(credential, moved.getCredentials());
+    ASSERT_EQ(nullptr, client.getCredentials());
+}
+
+TEST(SMTPClientBase_MoveConstructor, AllClients_AreNoexcept) {
+    static_assert(std::is_nothrow_move_constructible<SmtpClient>::value, "SmtpClient");
+    static_assert(std::is_nothrow_move_assignable<SmtpClient>::value, "SmtpClient");
+    static_assert(std::is_nothrow_move_constructible<OpportunisticSecureSMTPClient>::value, "OpportunisticSecureSMTPClient");
+    static_assert(std::is_nothrow_move_assignable<OpportunisticSecureSMTPClient>::value, "OpportunisticSecureSMTPClient");
+    static_assert(std::is_nothrow_move_constructible<ForcedSecureSMTPClient>::value, "ForcedSecureSMTPClient");
+    static_assert(std::is_nothrow_move_assignable<ForcedSecureSMTPClient>::value, "ForcedSecureSMTPClient");
+    static_assert(std::is_nothrow_move_constructible<cpp::SmtpClient>::value, "cpp::SmtpClient");
+    static_assert(std::is_nothrow_move_constructible<cpp::ForcedSecureSMTPClient>::value, "cpp::ForcedSecureSMTPClient");
+    SUCCEED();
+}
+
+TEST(CPP_SmtpClient, CopyConstructor_WithCredentials_ShareCredentials) {
+    std::vector<jed_utils::cpp::SmtpClient> clients;
+    jed_utils::cpp::SmtpClient client("test", 587);
+    client.setCredentials(jed_utils::cpp::Credential("ABC", "123"));
+    for (int index = 0; index < 4; index++) {
+        clients.push_back(client);
+    }
+    for (const auto &copy : clients) {
+        ASSERT_EQ(client.getCredentials(), copy.getCredentials());
+    }
+    clients.clear();
+    ASSERT_EQ("ABC", client.getCredentials()->getUsername());
+}
+
+TEST(SMTPClientBase_getLastSendResult, WithRejectedRecipient_ReturnEnvelopeFailure) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    client.setReply("RCPT TO", 550);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(550, client.sendMail(msg));
+    const SendResult result = client.getLastSendResult();
+    ASSERT_EQ(550, result.ReturnCode);
+    ASSERT_EQ(ErrorCategory::Permanent, result.Category);
+    ASSERT_TRUE(result.HasFailedPhase);
+    ASSERT_EQ(SessionPhase::Envelope, result.FailedPhase);
+    ASSERT_TRUE(result.EnhancedStatusCode.empty());
+}
+
+TEST(SMTPClientBase_getLastSendResult, WithRecipients_ReturnResultOfEachRecipient) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    client.setReply("RCPT TO: <bad@test.com>", 550);
+    const MessageAddress recipients[] = { MessageAddress("to@test.com"), MessageAddress("bad@test.com") };
+    PlaintextMessage msg(MessageAddress("from@test.com"), recipients, 2, "Subject", "Body");
+    ASSERT_EQ(550, client.sendMail(msg));
+    SendResult result = client.getLastSendResult();
+    ASSERT_EQ(2U, result.RecipientResultCount);
+    ASSERT_EQ(STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED, result.RecipientResults[0].ReplyCode);
+    ASSERT_EQ(550, result.RecipientResults[1].ReplyCode);
+    // The results of the next transaction reuse the same array
+    const RecipientResult *results = result.RecipientResults;
+    client.setReply("RCPT TO: <bad@test.com>", STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED);
+    ASSERT_EQ(0, client.sendMail(msg));
+    result = client.getLastSendResult();
+    ASSERT_EQ(results, result.RecipientResults);
+    ASSERT_EQ(STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED, result.RecipientResults[1].ReplyCode);
+}
+
+TEST(SMTPClientBase_sendMail, WithDsnOptionsAndNoDsnCapability_SendNoDsnParameter) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    DsnOptions options;
+    options.NotifyFailure = true;
+    options.Return = DsnReturn::Full;
+    options.EnvelopeId = "ID1";
+    client.setDsnOptions(options);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(0, client.sendMail(msg));
+    ASSERT_EQ(std::string::npos, findCommand(client.getCommandsWithFeedback(), "MAIL FROM").find('='));
+    ASSERT_EQ(1, countCommand(client.getCommandsWithFeedback(), "RCPT TO: <to@test.com>\r\n"));
+}
+
+TEST(SMTPClientBase_sendMail, WithDsnOptionsAndDsnCapability_SendDsnParameters) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    ServerCapabilities capabilities;
+    capabilities.Dsn = true;
+    client.setServerCapabilities(capabilities);
+    DsnOptions options;
+    options.NotifySuccess = true;
+    options.NotifyDelay = true;
+    options.Return = DsnReturn::Headers;
+    options.EnvelopeId = "A+B=C D";
+    client.setDsnOptions(options);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(0, client.connect());
+    ASSERT_EQ(0, client.sendMail(msg));
+    const std::string mail_from = findCommand(client.getCommandsWithFeedback(), "MAIL FROM");
+    ASSERT_EQ(" RET=HDRS ENVID=A+2BB+3DC+20D\r\n", mail_from.substr(mail_from.find('>') + 1));
+    ASSERT_EQ(1, countCommand(client.getCommandsWithFeedback(), "RCPT TO: <to@test.com> NOTIFY=SUCCESS,DELAY\r\n"));
+}
+
+TEST(SMTPClientBase_sendMail, WithNotifyNever_SendOnlyNever) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    ServerCapabilities capabilities;
+    capabilities.Dsn = true;
+    client.setServerCapabilities(capabilities);
+    DsnOptions options;
+    options.NotifyFailure = true;
+    options.NotifyNever = true;
+    client.setDsnOptions(options);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(0, client.connect());
+    ASSERT_EQ(0, client.sendMail(msg));
+    ASSERT_EQ(std::string::npos, findCommand(client.getCommandsWithFeedback(), "MAIL FROM").find('='));
+    ASSERT_EQ(1, countCommand(client.getCommandsWithFeedback(), "RCPT TO: <to@test.com> NOTIFY=NEVER\r\n"));
+}
+
+TEST(SMTPClientBase_sendMail, WithUtf8AddressesAndSmtpUtf8_SendAddressesWithSmtpUtf8Parameter) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    ServerCapabilities capabilities;
+    capabilities.SmtpUtf8 = true;
+    client.setServerCapabilities(capabilities);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("j\xc3\xb6rg@b\xc3\xbc" "cher.example"), "Subject", "Body");
+    ASSERT_EQ(0, client.connect());
+    ASSERT_EQ(0, client.sendMail(msg));
+    const std::string mail_from = findCommand(client.getCommandsWithFeedback(), "MAIL FROM");
+    ASSERT_EQ(" SMTPUTF8\r\n", mail_from.substr(mail_from.find('>') + 1));
+    ASSERT_EQ(1, countCommand(client.getCommandsWithFeedback(), "RCPT TO: <j\xc3\xb6rg@b\xc3\xbc" "cher.example>\r\n"));
+}
+
+TEST(SMTPClientBase_sendMail, WithUtf8DomainAndNoSmtpUtf8_SendALabel) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("jorg@b\xc3\xbc" "cher.example"), "Subject", "Body");
+    ASSERT_EQ(0, client.sendMail(msg));
+    ASSERT_EQ(std::string::npos, findCommand(client.getCommandsWithFeedback(), "MAIL FROM").find("SMTPUTF8"));
+    ASSERT_EQ(1, countCommand(client.getCommandsWithFeedback(), "RCPT TO: <jorg@xn--bcher-kva.example>\r\n"));
+}
+
+TEST(SMTPClientBase_sendMail, WithUtf8LocalPartAndNoSmtpUtf8_ReturnError) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("j\xc3\xb6rg@example.com"), "Subject", "Body");
+    ASSERT_EQ(CLIENT_SENDMAIL_SMTPUTF8_NOT_SUPPORTED_ERROR, client.sendMail(msg));
+    ASSERT_EQ("", findCommand(client.getCommandsWithFeedback(), "MAIL FROM"));
+    ASSERT_EQ(SessionPhase::Envelope, client.getLastSendResult().FailedPhase);
+}
+
+TEST(SMTPClientBase_getLastSendResult, WithMessageTooLarge_ReturnFailureWithoutPhase) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    ServerCapabilities capabilities;
+    capabilities.Size = true;
+    capabilities.MaxMessageSize = 10;
+    client.setServerCapabilities(capabilities);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(0, client.connect());
+    ASSERT_EQ(CLIENT_SENDMAIL_MESSAGE_SIZE_EXCEEDED_ERROR, client.sendMail(msg));
+    const SendResult result = client.getLastSendResult();
+    ASSERT_EQ(ErrorCategory::Permanent, result.Category);
+    ASSERT_FALSE(result.HasFailedPhase);
+    ASSERT_EQ("The message exceeds the maximum size accepted by the server", result.Message);
+}
+
+TEST(SMTPClientBase_getLastSendResult, AfterFailureThenSuccess_ReturnSuccess) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    setAcceptedEnvelope(client);
+    client.setReply("RCPT TO", STATUS_CODE_MAILBOX_BUSY);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_EQ(0, client.connect());
+    ASSERT_EQ(STATUS_CODE_MAILBOX_BUSY, client.sendMail(msg));
+    ASSERT_EQ(ErrorCategory::Transient, client.getLastSendResult().Category);
+    client.setReply("RCPT TO", STATUS_CODE_REQUESTED_MAIL_ACTION_OK_OR_COMPLETED);
+    ASSERT_EQ(0, client.sendMail(msg));
+    const SendResult result = client.getLastSendResult();
+    ASSERT_EQ(0, result.ReturnCode);
+    ASSERT_EQ(ErrorCategory::None, result.Category);
+    ASSERT_FALSE(result.HasFailedPhase);
+    ASSERT_TRUE(result.Message.empty());
+}
+
+TEST(SMTPClientBase_setSessionObserver, WithObserver_ReturnTransactionPhases) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    auto metrics = std::make_shared<SessionMetrics>();
+    client.setSessionObserver(metrics);
+    ASSERT_EQ(metrics, client.getSessionObserver());
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    client.sendMail(msg);
+    ASSERT_EQ(1U, metrics->getPhaseStatistics(SessionPhase::Envelope).Count);
+    ASSERT_EQ(1U, metrics->getPhaseStatistics(SessionPhase::Headers).Count);
+    ASSERT_EQ(1U, metrics->getPhaseStatistics(SessionPhase::Body).Count);
+    ASSERT_EQ(0U, metrics->getPhaseStatistics(SessionPhase::Connection).Count);
+}
+
+TEST(SMTPClientBase_setSessionObserver, WithNullptr_ReturnNoMeasurement) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    auto metrics = std::make_shared<SessionMetrics>();
+    client.setSessionObserver(metrics);
+    client.setSessionObserver(nullptr);
+    ASSERT_EQ(nullptr, client.getSessionObserver());
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    client.sendMail(msg);
+    ASSERT_EQ(0U, metrics->getPhaseStatistics(SessionPhase::Envelope).Count);
+}
+
+TEST(SMTPClientBase_setSessionObserver, CopyClient_ShareObserver) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    auto metrics = std::make_shared<SessionMetrics>();
+    client.setSessionObserver(metrics);
+    FakeSMTPClientBase copy(client);
+    ASSERT_EQ(metrics, copy.getSessionObserver());
+}
+
+TEST(SMTPClientBase_getIoCounters, NewClient_ReturnZero) {
+    FakeSMTPClientBase client("127.0.0.1", 587);
+    ASSERT_EQ(0U, client.getIoCounters().BytesWritten);
+    ASSERT_EQ(0U, client.getIoCounters().BytesRead);
+    ASSERT_EQ(0U, client.getIoCounters().WriteCalls);
+    ASSERT_EQ(0U, client.getIoCounters().ReadCalls);
+    ASSERT_EQ(0U, client.getIoCounters().WaitCalls);
+}
+
 TEST(SMTPClientBase, getErrorMessage_r_WithNullPtr_ReturnMinus1) {
     ASSERT_EQ(-1, FakeSMTPClientBase::getErrorMessage_r(-1, nullptr, 0));
 }
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../../src/communicationlog.h"
+#include "../../src/forcedsecuresmtpclient.h"
+#include "../../src/opportunisticsecuresmtpclient.h"
+#include "../../src/plaintextmessage.h"
+#include "../../src/smtpclient.h"
+#include "../../src/smtpclientconfig.h"
+
+using namespace jed_utils;
+
+TEST(SmtpClientConfig_Constructor, WithNullServerName_ThrowInvalidArgument) {
+    ASSERT_THROW(SmtpClientConfig(SmtpClientType::Plain, nullptr, 25), std::invalid_argument);
+}
+
+TEST(SmtpClientConfig_Constructor, WithBlankServerName_ThrowInvalidArgument) {
+    ASSERT_THROW(SmtpClientConfig(SmtpClientType::Plain, "  ", 25), std::invalid_argument);
+}
+
+TEST(SmtpClientConfig_Constructor, WithValidParams_ReturnDefaults) {
+    SmtpClientConfig config(SmtpClientType::ForcedSecure, "smtp.example.com", 465);
+    ASSERT_EQ(SmtpClientType::ForcedSecure, config.getClientType());
+    ASSERT_STREQ("smtp.example.com", config.getServerName());
+    ASSERT_EQ(465, config.getServerPort());
+    ASSERT_EQ(5000, config.getCommandTimeoutInMilliseconds());
+    ASSERT_EQ(0, config.getOperationTimeoutInMilliseconds());
+    ASSERT_EQ(nullptr, config.getCredentials());
+    ASSERT_TRUE(config.isPipeliningEnabled());
+    ASSERT_TRUE(config.isChunkingEnabled());
+    ASSERT_FALSE(config.isTextAttachmentEncodingEnabled());
+    ASSERT_EQ(65536, config.getDataWriteSize());
+    ASSERT_EQ(4, config.getAttachmentPrefetchBlockCount());
+    ASSERT_EQ(CommunicationLogLevel::Full, config.getCommunicationLogLevel());
+    ASSERT_EQ(INITIAL_COMM_LOG_LENGTH, config.getCommunicationLogCapacity());
+    ASSERT_EQ(nullptr, config.getTlsContext());
+    ASSERT_EQ(nullptr, config.getEncodedAttachmentCache());
+    ASSERT_EQ(nullptr, config.getCapabilityCache());
+    ASSERT_EQ(nullptr, config.getDkimSigner());
+    ASSERT_EQ(nullptr, config.getSessionObserver());
+}
+
+TEST(SmtpClientConfig_setCredentials, WithCredential_ReturnCopy) {
+    SmtpClientConfig config(SmtpClientType::Plain, "127.0.0.1", 25);
+    {
+        Credential credential("user", "pass");
+        config.setCredentials(credential);
+    }
+    ASSERT_NE(nullptr, config.getCredentials());
+    ASSERT_STREQ("user", config.getCredentials()->getUsername());
+    ASSERT_STREQ("pass", config.getCredentials()->getPassword());
+}
+
+TEST(SmtpClientConfig_createClient, WithPlainType_ReturnSmtpClient) {
+    SmtpClientConfig config(SmtpClientType::Plain, "127.0.0.1", 2525);
+    auto client = config.createClient();
+    ASSERT_NE(nullptr, dynamic_cast<SmtpClient *>(client.get()));
+    ASSERT_STREQ("127.0.0.1", client->getServerName());
+    ASSERT_EQ(2525, client->getServerPort());
+    ASSERT_FALSE(client->isConnected());
+}
+
+TEST(SmtpClientConfig_createClient, WithOpportunisticSecureType_ReturnClientWithTlsContext) {
+    SmtpClientConfig config(SmtpClientType::OpportunisticSecure, "127.0.0.1", 587);
+    auto context = std::make_shared<TlsContext>();
+    config.setTlsContext(context);
+    auto client = config.createClient();
+    auto *secure_client = dynamic_cast<OpportunisticSecureSMTPClient *>(client.get());
+    ASSERT_NE(nullptr, secure_client);
+    ASSERT_EQ(context, secure_client->getTlsContext());
+}
+
+TEST(SmtpClientConfig_createClient, WithForcedSecureType_ReturnForcedSecureClient) {
+    SmtpClientConfig config(SmtpClientType::ForcedSecure, "127.0.0.1", 465);
+    auto client = config.createClient();
+    ASSERT_NE(nullptr, dynamic_cast<ForcedSecureSMTPClient *>(client.get()));
+}
+
+TEST(SmtpClientConfig_createClient, WithSettings_ReturnConfiguredClient) {
+    SmtpClientConfig config(SmtpClientType::Plain, "127.0.0.1", 25);
+    auto observer = std::make_shared<SessionMetrics>();
+    auto cache = std::make_shared<EncodedAttachmentCache>(1024);
+    auto capability_cache = std::make_shared<CapabilityCache>();
+    config.setCommandTimeoutInMilliseconds(1500);
+    config.setOperationTimeoutInMilliseconds(20000);
+    config.setCredentials(Credential("user", "pass"));
+    config.setPipeliningEnabled(false);
+    config.setChunkingEnabled(false);
+    config.setTextAttachmentEncodingEnabled(true);
+    config.setDataWriteSize(4096);
+    config.setAttachmentPrefetchBlockCount(0);
+    config.setCommunicationLogLevel(CommunicationLogLevel::Commands);
+    config.setCommunicationLogCapacity(1024);
+    config.setSessionObserver(observer);
+    config.setEncodedAttachmentCache(cache);
+    config.setCapabilityCache(capability_cache);
+    auto client = config.createClient();
+    ASSERT_EQ(1500, client->getCommandTimeoutInMilliseconds());
+    ASSERT_EQ(20000, client->getOperationTimeoutInMilliseconds());
+    ASSERT_NE(nullptr, client->getCredentials());
+    ASSERT_STREQ("user", client->getCredentials()->getUsername());
+    ASSERT_FALSE(client->isPipeliningEnabled());
+    ASSERT_FALSE(client->isChunkingEnabled());
+    ASSERT_TRUE(client->isTextAttachmentEncodingEnabled());
+    ASSERT_EQ(4096, client->getDataWriteSize());
+    ASSERT_EQ(0, client->getAttachmentPrefetchBlockCount());
+    ASSERT_EQ(CommunicationLogLevel::Commands, client->getCommunicationLogLevel());
+    ASSERT_EQ(1024, client->getCommunicationLogCapacity());
+    ASSERT_EQ(observer, client->getSessionObserver());
+    ASSERT_EQ(cache, client->getEncodedAttachmentCache());
+    ASSERT_EQ(capability_cache, client->getCapabilityCache());
+}
+
+TEST(SmtpClientConfig_createClient, WithTransportOptions_ReturnClientWithOptions) {
+    SmtpClientConfig config(SmtpClientType::Plain, "127.0.0.1", 25);
+    TransportOptions options;
+    options.ReadBufferSize = 4096;
+    options.KeepAlive = true;
+    options.KeepAliveIdleSeconds = 30;
+    options.ReceiveBufferSize = 262144;
+    config.setTransportOptions(options);
+    config.setDataWriteSize(8192);
+    ASSERT_EQ(8192, config.getTransportOptions().WriteSize);
+    auto client = config.createClient();
+    ASSERT_EQ(4096, client->getTransportOptions().ReadBufferSize);
+    ASSERT_EQ(8192, client->getDataWriteSize());
+    ASSERT_TRUE(client->getTransportOptions().KeepAlive);
+    ASSERT_EQ(30, client->getTransportOptions().KeepAliveIdleSeconds);
+    ASSERT_EQ(262144, client->getTransportOptions().ReceiveBufferSize);
+}
+
+TEST(SmtpClientConfig_createClient, WithDsnOptions_ReturnClientWithOptions) {
+    SmtpClientConfig config(SmtpClientType::Plain, "127.0.0.1", 25);
+    DsnOptions options;
+    options.NotifyFailure = true;
+    options.EnvelopeId = "ID1";
+    config.setDsnOptions(options);
+    ASSERT_TRUE(config.getDsnOptions().NotifyFailure);
+    auto client = config.createClient();
+    ASSERT_TRUE(client->getDsnOptions().NotifyFailure);
+    ASSERT_EQ("ID1", client->getDsnOptions().EnvelopeId);
+}
+
+TEST(SmtpClientConfig_createClient, CalledTwice_ReturnIndependentClients) {
+    SmtpClientConfig config(SmtpClientType::Plain, "127.0.0.1", 25);
+    auto client1 = config.createClient();
+    auto client2 = config.createClient();
+    ASSERT_NE(client1.get(), client2.get());
+    client1->setServerPort(26);
+    ASSERT_EQ(25, client2->getServerPort());
+    ASSERT_EQ(25, config.getServerPort());
+}
+
+TEST(SmtpClientConfig_sendMail, WithUnreachableServer_ReturnErrorCode) {
+    SmtpClientConfig config(SmtpClientType::Plain, "127.0.0.1", 1);
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_LT(config.sendMail(msg), 0);
+}
+
+TEST(SmtpClientConfig_sendMail, FromManyThreads_EachThreadLogsItsOwnSession) {
+    if (!CommunicationLog::isAvailable()) {
+        GTEST_SKIP() << "Built without communication log";
+    }
+    auto config = std::make_shared<SmtpClientConfig>(SmtpClientType::Plain, "127.0.0.1", 1);
+    std::atomic<size_t> log_item_count { 0 };
+    config->setCommunicationLogSink([&log_item_count](const char *, std::string_view) {
+        log_item_count++;
+    });
+    std::shared_ptr<const SmtpClientConfig> shared_config = config;
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    const size_t THREAD_COUNT = 8;
+    std::vector<int> return_codes(THREAD_COUNT, 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < THREAD_COUNT; i++) {
+        threads.emplace_back([&, i]() {
+            return_codes[i] = shared_config->sendMail(msg);
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (int return_code : return_codes) {
+        ASSERT_LT(return_code, 0);
+    }
+    ASSERT_GE(log_item_count, THREAD_COUNT);
+}
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include "../../src/plaintextmessage.h"
+#include "../../src/smtpconnectionpool.h"
+#include "../../src/smtpclient.h"
+
+using namespace jed_utils;
+
+namespace {
+// A transport that answers like an SMTP server until it receives the command
+// that drops the connection, then reads fail like on a closed socket
+class DroppingTransport : public Transport {
+ public:
+    DroppingTransport(std::string pDropCommand, int &pOpenCount)
+        : mDropCommand(std::move(pDropCommand)),
+          mOpenCount(pOpenCount) {
+    }
+    int open(const char *, unsigned int, unsigned int) override {
+        mOpenCount++;
+        mOpened = true;
+        mOutput = "220 dropping ESMTP\r\n";
+        return 0;
+    }
+    void close() override {
+        mOpened = false;
+    }
+    int write(const std::string_view *pSegments, size_t pSegmentCount) override {
+        if (!mOpened) {
+            return -1;
+        }
+        for (size_t i = 0; i < pSegmentCount; i++) {
+            mInput.append(pSegments[i]);
+        }
+        processInput();
+        return 0;
+    }
+    int waitForData(unsigned int) override {
+        return !mOpened || !mOutput.empty() ? 1 : 0;
+    }
+    int read(char *pBuffer, size_t pLength) override {
+        if (!mOpened || mOutput.empty()) {
+            return -1;
+        }
+        size_t length = (std::min)(pLength, mOutput.size());
+        memcpy(pBuffer, mOutput.data(), length);
+        mOutput.erase(0, length);
+        return static_cast<int>(length);
+    }
+
+ private:
+    void processInput() {
+        while (mOpened) {
+            size_t end = mInput.find(mInData ? "\r\n.\r\n" : "\r\n");
+            if (end == std::string::npos) {
+                return;
+            }
+            std::string command = mInData ? "." : mInput.substr(0, 4);
+            mInput.erase(0, end + (mInData ? 5 : 2));
+            mInData = false;
+            if (command == mDropCommand) {
+                mOpened = false;
+                mOutput.clear();
+            } else if (command == "EHLO") {
+                mOutput += "250-dropping\r\n250 AUTH PLAIN\r\n";
+            } else if (command == "AUTH") {
+                mOutput += "235 Authenticated\r\n";
+            } else if (command == "DATA") {
+                mInData = true;
+                mOutput += "354 Go ahead\r\n";
+            } else if (command == "QUIT") {
+                mOutput += "221 Bye\r\n";
+            } else {
+                mOutput += "250 OK\r\n";
+            }
+        }
+    }
+    std::string mDropCommand;
+    int &mOpenCount;
+    bool mOpened = false;
+    bool mInData = false;
+    std::string mInput;
+    std::string mOutput;
+};
+
+// The first session drops the connection at pDropCommand, the next ones
+// answer every command
+TransportFactory createDroppingTransportFactory(const std::string &pDropCommand, int &pOpenCount) {
+    return [pDropCommand, &pOpenCount]() {
+        return std::make_shared<DroppingTransport>(pOpenCount == 0 ? pDropCommand : "", pOpenCount);
+    };
+}
+
+PlaintextMessage createMessage() {
+    return PlaintextMessage(MessageAddress("from@example.com"),
+            MessageAddress("to@example.com"),
+            "Subject",
+            "Body");
+}
+}  // namespace
+
+TEST(SmtpConnectionPool_Constructor, NewPool_ReturnNoSessions) {
+    SmtpConnectionPool pool(4);
+    ASSERT_EQ(0, pool.getSessionCount());
+    ASSERT_EQ(0, pool.getIdleSessionCount());
+}
+
+TEST(SmtpConnectionPool_release, WithNullPtr_DoNothing) {
+    SmtpConnectionPool pool(4);
+    pool.release(nullptr);
+    ASSERT_EQ(0, pool.getSessionCount());
+}
+
+TEST(SmtpConnectionPool_release, WithClientNotFromPool_DoNothing) {
+    SmtpConnectionPool pool(4);
+    SmtpClient client("127.0.0.1", 25);
+    pool.release(&client);
+    ASSERT_EQ(0, pool.getSessionCount());
+    ASSERT_EQ(0, pool.getIdleSessionCount());
+}
+
+TEST(SmtpConnectionPool_acquire, WithUnreachableServer_ReturnNullPtrAndErrorCode) {
+    SmtpConnectionPool pool(4);
+    int errorCode = 0;
+    SMTPClientBase *client = pool.acquire(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, &errorCode);
+    ASSERT_EQ(nullptr, client);
+    ASSERT_NE(0, errorCode);
+    ASSERT_EQ(0, pool.getSessionCount());
+}
+
+TEST(SmtpConnectionPool_acquire, WithOtherPassword_OpenAnotherSession) {
+    SmtpConnectionPool pool(4);
+    int open_count = 0;
+    pool.setTransportFactory(createDroppingTransportFactory("", open_count));
+    Credential credential("user", "first");
+    SMTPClientBase *client = pool.acquire(SmtpClientType::Plain, "localhost", 25, &credential);
+    ASSERT_NE(nullptr, client);
+    pool.release(client);
+    Credential other_credential("user", "second");
+    client = pool.acquire(SmtpClientType::Plain, "localhost", 25, &other_credential);
+    ASSERT_NE(nullptr, client);
+    pool.release(client);
+    ASSERT_EQ(2, open_count);
+    Credential same_credential("user", "first");
+    client = pool.acquire(SmtpClientType::Plain, "localhost", 25, &same_credential);
+    ASSERT_NE(nullptr, client);
+    pool.release(client);
+    ASSERT_EQ(2, open_count);
+    ASSERT_EQ(2, pool.getIdleSessionCount());
+}
+
+TEST(SmtpConnectionPool_sendMail, WithSessionDroppedAtMailFrom_RetryOnNewSession) {
+    SmtpConnectionPool pool(4);
+    int open_count = 0;
+    pool.setTransportFactory(createDroppingTransportFactory("MAIL", open_count));
+    ASSERT_EQ(0, pool.sendMail(SmtpClientType::Plain, "localhost", 25, nullptr, createMessage()));
+    ASSERT_EQ(2, open_count);
+}
+
+TEST(SmtpConnectionPool_sendMail, WithSessionDroppedAfterContent_DoNotRetry) {
+    SmtpConnectionPool pool(4);
+    int open_count = 0;
+    pool.setTransportFactory(createDroppingTransportFactory(".", open_count));
+    ASSERT_NE(0, pool.sendMail(SmtpClientType::Plain, "localhost", 25, nullptr, createMessage()));
+    ASSERT_EQ(1, open_count);
+    ASSERT_EQ(0, pool.getSessionCount());
+}
+
+TEST(SmtpConnectionPool_warm, WithZeroSession_OpenNothing) {
+    SmtpConnectionPool pool(4);
+    int errorCode = 1;
+    ASSERT_EQ(0, pool.warm(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 0, &errorCode));
+    ASSERT_EQ(0, errorCode);
+    ASSERT_EQ(0, pool.getSessionCount());
+}
+
+TEST(SmtpConnectionPool_warm, WithUnreachableServer_ReturnZeroAndErrorCode) {
+    SmtpConnectionPool pool(4);
+    int errorCode = 0;
+    ASSERT_EQ(0, pool.warm(SmtpClientType::Plain, "127.0.0.1", 1, nullptr, 2, &errorCode));
+    ASSERT_NE(0, errorCode);
+    ASSERT_EQ(0, pool.getSessionCount());
+    ASSERT_EQ(0, pool.getIdleSessionCount());
+}
+
+TEST(SmtpConnectionPool_findServerCapabilities, WithKnownServer_ReturnCapabilitiesOfClientType) {
+    SmtpConnectionPool pool(4);
+    ASSERT_NE(nullptr, pool.getCapabilityCache());
+    ServerCapabilities capabilities;
+    ASSERT_FALSE(pool.findServerCapabilities(SmtpClientType::Plain, "smtp.example.com", 587, capabilities));
+    capabilities.StartTLS = true;
+    pool.getCapabilityCache()->insert("smtp.example.com", 587, false, "250-smtp.example.com\r\n250 STARTTLS\r\n", capabilities);
+    capabilities.StartTLS = false;
+    capabilities.Chunking = true;
+    pool.getCapabilityCache()->insert("smtp.example.com", 587, true, "250-smtp.example.com\r\n250 CHUNKING\r\n", capabilities);
+    ServerCapabilities found;
+    ASSERT_TRUE(pool.findServerCapabilities(SmtpClientType::Plain, "smtp.example.com", 587, found));
+    ASSERT_TRUE(found.StartTLS);
+    ASSERT_TRUE(pool.findServerCapabilities(SmtpClientType::OpportunisticSecure, "smtp.example.com", 587, found));
+    ASSERT_TRUE(found.Chunking);
+    ASSERT_FALSE(found.StartTLS);
+}
+
+TEST(SmtpConnectionPool_evictIdleSessions, WithNoSessions_DoNothing) {
+    SmtpConnectionPool pool(4, 0);
+    pool.evictIdleSessions();
+    ASSERT_EQ(0, pool.getSessionCount());
+}
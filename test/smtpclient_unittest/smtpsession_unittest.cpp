@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include "../../src/communicationlog.h"
+#include "../../src/plaintextmessage.h"
+#include "../../src/smtpsession.h"
+
+using namespace jed_utils;
+
+TEST(SmtpSession_Constructor, WithNullConfig_ThrowInvalidArgument) {
+    ASSERT_THROW(SmtpSession(nullptr), std::invalid_argument);
+}
+
+TEST(SmtpSession_Constructor, WithConfig_ReturnDisconnectedSession) {
+    auto config = std::make_shared<const SmtpClientConfig>(SmtpClientType::Plain, "127.0.0.1", 25);
+    SmtpSession session(config);
+    ASSERT_EQ(config, session.getConfig());
+    ASSERT_FALSE(session.isConnected());
+    ASSERT_EQ(0, session.getIoCounters().BytesWritten);
+}
+
+TEST(SmtpSession_connect, WithUnreachableServer_ReturnErrorCode) {
+    SmtpSession session(std::make_shared<const SmtpClientConfig>(SmtpClientType::Plain, "127.0.0.1", 1));
+    ASSERT_LT(session.connect(), 0);
+    ASSERT_FALSE(session.isConnected());
+    ASSERT_EQ(CommunicationLog::isAvailable(), strlen(session.getCommunicationLog()) != 0);
+}
+
+TEST(SmtpSession_disconnect, WithoutConnect_ReturnZero) {
+    SmtpSession session(std::make_shared<const SmtpClientConfig>(SmtpClientType::Plain, "127.0.0.1", 25));
+    ASSERT_EQ(0, session.disconnect());
+}
+
+TEST(SmtpSession_sendMail, WithUnreachableServer_ReturnErrorCode) {
+    SmtpSession session(std::make_shared<const SmtpClientConfig>(SmtpClientType::Plain, "127.0.0.1", 1));
+    PlaintextMessage msg(MessageAddress("from@test.com"), MessageAddress("to@test.com"), "Subject", "Body");
+    ASSERT_LT(session.sendMail(msg), 0);
+}
+
+TEST(SmtpSession_Constructor, SessionsFromOneConfig_HaveTheirOwnLog) {
+    if (!CommunicationLog::isAvailable()) {
+        GTEST_SKIP() << "Built without communication log";
+    }
+    auto config = std::make_shared<const SmtpClientConfig>(SmtpClientType::Plain, "127.0.0.1", 1);
+    SmtpSession session1(config);
+    SmtpSession session2(config);
+    session1.connect();
+    ASSERT_NE(0, strlen(session1.getCommunicationLog()));
+    ASSERT_EQ(0, strlen(session2.getCommunicationLog()));
+}
+
+TEST(SmtpSession_MoveConstructor, WithSession_KeepConfig) {
+    auto config = std::make_shared<const SmtpClientConfig>(SmtpClientType::Plain, "127.0.0.1", 25);
+    SmtpSession session1(config);
+    SmtpSession session2(std::move(session1));
+    ASSERT_EQ(config, session2.getConfig());
+    ASSERT_FALSE(session2.isConnected());
+}
@@ -0,0 +1,389 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../../src/opportunisticsecuresmtpclient.h"
+#include "../../src/plaintextmessage.h"
+#include "../../src/smtpclienterrors.h"
+#include "../../src/smtpclient.h"
+#include "../../src/smtpclientconfig.h"
+#include "../../src/socketerrors.h"
+#include "../../src/sockettransport.h"
+#include "../../src/sslerrors.h"
+#ifndef _WIN32
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+using namespace jed_utils;
+using namespace std::literals::string_literals;
+
+namespace {
+// A transport that answers the commands like an SMTP server, without network
+class ScriptedTransport : public Transport {
+ public:
+    explicit ScriptedTransport(bool pAdvertiseStartTLS = false)
+        : mAdvertiseStartTLS(pAdvertiseStartTLS) {
+    }
+    int open(const char *, unsigned int, unsigned int) override {
+        mOpenCount++;
+        if (mOpenError != 0) {
+            return mOpenError;
+        }
+        mOpened = true;
+        mOutput = "220 scripted ESMTP\r\n";
+        mPendingDelay = mReplyDelayInMilliseconds;
+        return 0;
+    }
+    void close() override {
+        if (mOpened) {
+            mCloseCount++;
+        }
+        mOpened = false;
+    }
+    int write(const std::string_view *pSegments, size_t pSegmentCount) override {
+        if (!mOpened) {
+            return -1;
+        }
+        mWriteCount++;
+        mWrites.emplace_back();
+        for (size_t i = 0; i < pSegmentCount; i++) {
+            mInput.append(pSegments[i]);
+            mReceived.append(pSegments[i]);
+            mWrites.back().append(pSegments[i]);
+        }
+        processInput();
+        mPendingDelay = mReplyDelayInMilliseconds;
+        return 0;
+    }
+    int waitForData(unsigned int pTimeoutInMilliseconds) override {
+        if (mOutput.empty()) {
+            return 0;
+        }
+        // A slow server answers each write after the reply delay
+        if (mPendingDelay > 0) {
+            const unsigned int wait = (std::min)(pTimeoutInMilliseconds, mPendingDelay);
+            std::this_thread::sleep_for(std::chrono::milliseconds(wait));
+            mPendingDelay -= wait;
+            if (mPendingDelay > 0) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+    int read(char *pBuffer, size_t pLength) override {
+        if (mOutput.empty()) {
+            return -1;
+        }
+        size_t length = (std::min)(pLength, mOutput.size());
+        memcpy(pBuffer, mOutput.data(), length);
+        mOutput.erase(0, length);
+        return static_cast<int>(length);
+    }
+    bool mAdvertiseStartTLS;
+    unsigned int mReplyDelayInMilliseconds = 0;
+    int mOpenError = 0;
+    bool mOpened = false;
+    int mOpenCount = 0;
+    int mCloseCount = 0;
+    int mWriteCount = 0;
+    size_t mMessageCount = 0;
+    std::string mReceived;
+    // Each write of the client
+    std::vector<std::string> mWrites;
+
+ private:
+    void processInput() {
+        for (;;) {
+            if (mInTLS) {
+                if (!mInput.empty()) {
+                    mInput.clear();
+                    mOutput += "500 Not TLS\r\n";
+                }
+                return;
+            }
+            if (mInData) {
+                size_t end = mInput.find("\r\n.\r\n");
+                if (end == std::string::npos) {
+                    return;
+                }
+                mInput.erase(0, end + 5);
+                mInData = false;
+                mMessageCount++;
+                mOutput += "250 OK\r\n";
+                continue;
+            }
+            size_t end = mInput.find("\r\n");
+            if (end == std::string::npos) {
+                return;
+            }
+            std::string command = mInput.substr(0, 4);
+            std::transform(command.begin(), command.end(), command.begin(), ::toupper);
+            mInput.erase(0, end + 2);
+            if (command == "EHLO") {
+                mOutput += mAdvertiseStartTLS ? "250-scripted\r\n250 STARTTLS\r\n" : "250-scripted\r\n250 PIPELINING\r\n";
+            } else if (command == "DATA") {
+                mInData = true;
+                mOutput += "354 Go ahead\r\n";
+            } else if (command == "STAR") {
+                mOutput += "220 Ready to start TLS\r\n";
+                mInTLS = true;
+            } else if (command == "QUIT") {
+                mOutput += "221 Bye\r\n";
+            } else {
+                mOutput += "250 OK\r\n";
+            }
+        }
+    }
+    std::string mInput;
+    std::string mOutput;
+    bool mInData = false;
+    bool mInTLS = false;
+    unsigned int mPendingDelay = 0;
+};
+
+long long getElapsedMilliseconds(std::chrono::steady_clock::time_point pStart) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - pStart).count();
+}
+
+PlaintextMessage createMessage() {
+    return PlaintextMessage(MessageAddress("from@example.com"),
+            MessageAddress("to@example.com"),
+            "Subject",
+            "Body");
+}
+}  // namespace
+
+TEST(SMTPClientBase_setTransport, WithScriptedTransport_SendMailThroughTransport) {
+    auto transport = std::make_shared<ScriptedTransport>();
+    SmtpClient client("localhost", 25);
+    client.setTransport(transport);
+    ASSERT_EQ(transport, client.getTransport());
+    ASSERT_EQ(0, client.sendMail(createMessage()));
+    ASSERT_EQ(1U, transport->mMessageCount);
+    ASSERT_EQ(1, transport->mOpenCount);
+    ASSERT_EQ(1, transport->mCloseCount);
+    ASSERT_NE(std::string::npos, transport->mReceived.find("MAIL FROM: <from@example.com>\r\n"));
+    ASSERT_NE(std::string::npos, transport->mReceived.find("RCPT TO: <to@example.com>\r\n"));
+    ASSERT_NE(std::string::npos, transport->mReceived.find("\r\n\r\nBody"));
+    ASSERT_NE(std::string::npos, transport->mReceived.find("\r\n.\r\n"));
+    ASSERT_EQ(transport->mReceived.size(), client.getIoCounters().BytesWritten);
+    ASSERT_EQ(static_cast<size_t>(transport->mWriteCount), client.getIoCounters().WriteCalls);
+}
+
+TEST(SMTPClientBase_setTransport, WithoutAttachment_SendEndOfDataWithBody) {
+    auto transport = std::make_shared<ScriptedTransport>();
+    SmtpClient client("localhost", 25);
+    client.setTransport(transport);
+    ASSERT_EQ(0, client.sendMail(createMessage()));
+    const auto body_write = std::find_if(transport->mWrites.begin(), transport->mWrites.end(),
+            [](const std::string &pWrite) { return pWrite.find("\r\n\r\nBody") != std::string::npos; });
+    ASSERT_NE(transport->mWrites.end(), body_write);
+    ASSERT_EQ(body_write->size() - 5, body_write->rfind("\r\n.\r\n"));
+    ASSERT_EQ("QUIT\r\n", *(body_write + 1));
+}
+
+TEST(SMTPClientBase_setTransport, WithPersistentSession_ReuseTransport) {
+    auto transport = std::make_shared<ScriptedTransport>();
+    SmtpClient client("localhost", 25);
+    client.setTransport(transport);
+    ASSERT_EQ(0, client.connect());
+    ASSERT_EQ(0, client.sendMail(createMessage()));
+    ASSERT_EQ(0, client.sendMail(createMessage()));
+    client.disconnect();
+    ASSERT_EQ(2U, transport->mMessageCount);
+    ASSERT_EQ(1, transport->mOpenCount);
+    ASSERT_EQ(1, transport->mCloseCount);
+}
+
+TEST(SMTPClientBase_setTransport, WithOpenError_ReturnOpenError) {
+    auto transport = std::make_shared<ScriptedTransport>();
+    transport->mOpenError = SOCKET_INIT_SESSION_CONNECT_TIMEOUT;
+    SmtpClient client("localhost", 25);
+    client.setTransport(transport);
+    ASSERT_EQ(SOCKET_INIT_SESSION_CONNECT_TIMEOUT, client.sendMail(createMessage()));
+    ASSERT_EQ(0U, transport->mMessageCount);
+}
+
+TEST(SMTPClientBase_setTransport, WithCopy_DoNotShareTransport) {
+    auto transport = std::make_shared<ScriptedTransport>();
+    SmtpClient client("localhost", 25);
+    client.setTransport(transport);
+    ASSERT_EQ(0, client.connect());
+    SmtpClient copy(client);
+    ASSERT_EQ(nullptr, copy.getTransport());
+    SmtpClient assigned("localhost", 25);
+    assigned.setTransport(std::make_shared<ScriptedTransport>());
+    assigned = client;
+    ASSERT_EQ(nullptr, assigned.getTransport());
+    // The session of the original is not disturbed by its copies
+    ASSERT_EQ(1, transport->mOpenCount);
+    ASSERT_EQ(0, client.sendMail(createMessage()));
+    ASSERT_EQ(1U, transport->mMessageCount);
+    client.disconnect();
+    SmtpClient moved(std::move(client));
+    ASSERT_EQ(transport, moved.getTransport());
+}
+
+TEST(SMTPClientBase_setOperationTimeoutInMilliseconds, WithSlowServer_ReturnDeadlineExceeded) {
+    auto transport = std::make_shared<ScriptedTransport>();
+    transport->mReplyDelayInMilliseconds = 100;
+    SmtpClient client("localhost", 25);
+    client.setTransport(transport);
+    client.setOperationTimeoutInMilliseconds(250);
+    const auto start = std::chrono::steady_clock::now();
+    // Each reply arrives within the command timeout but the whole send does not
+    ASSERT_EQ(CLIENT_OPERATION_DEADLINE_EXCEEDED_ERROR, client.sendMail(createMessage()));
+    ASSERT_LT(getElapsedMilliseconds(start), 1000);
+    ASSERT_EQ(0U, transport->mMessageCount);
+    ASSERT_EQ(CLIENT_OPERATION_DEADLINE_EXCEEDED_ERROR, client.getLastSendResult().ReturnCode);
+}
+
+TEST(SMTPClientBase_setOperationTimeoutInMilliseconds, WithServerWithinDeadline_SendMail) {
+    auto transport = std::make_shared<ScriptedTransport>();
+    transport->mReplyDelayInMilliseconds = 10;
+    SmtpClient client("localhost", 25);
+    client.setTransport(transport);
+    client.setOperationTimeoutInMilliseconds(5000);
+    ASSERT_EQ(0, client.sendMail(createMessage()));
+    // The deadline starts again with each operation
+    ASSERT_EQ(0, client.sendMail(createMessage()));
+    ASSERT_EQ(2U, transport->mMessageCount);
+}
+
+TEST(SMTPClientBase_setCancellationToken, WithCancelFromAnotherThread_ReturnCancelled) {
+    auto transport = std::make_shared<ScriptedTransport>();
+    transport->mReplyDelayInMilliseconds = 100;
+    auto token = std::make_shared<CancellationToken>();
+    SmtpClient client("localhost", 25);
+    client.setTransport(transport);
+    client.setCommandTimeout(30);
+    client.setCancellationToken(token);
+    ASSERT_EQ(token, client.getCancellationToken());
+    const auto start = std::chrono::steady_clock::now();
+    std::thread canceller([token]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        token->cancel();
+    });
+    const int ret_code = client.sendMail(createMessage());
+    canceller.join();
+    ASSERT_EQ(CLIENT_OPERATION_CANCELLED_ERROR, ret_code);
+    ASSERT_LT(getElapsedMilliseconds(start), 1000);
+    ASSERT_EQ(0U, transport->mMessageCount);
+    ASSERT_EQ(1, transport->mCloseCount);
+}
+
+TEST(SMTPClientBase_setCancellationToken, WithCancelledToken_FailAtOnce) {
+    auto transport = std::make_shared<ScriptedTransport>();
+    auto token = std::make_shared<CancellationToken>();
+    token->cancel();
+    SmtpClient client("localhost", 25);
+    client.setTransport(transport);
+    client.setCancellationToken(token);
+    ASSERT_EQ(CLIENT_OPERATION_CANCELLED_ERROR, client.sendMail(createMessage()));
+    ASSERT_EQ(CLIENT_OPERATION_CANCELLED_ERROR, client.connect());
+    ASSERT_EQ(0U, transport->mMessageCount);
+    // A new token lets the client send again
+    client.setCancellationToken(std::make_shared<CancellationToken>());
+    ASSERT_EQ(0, client.sendMail(createMessage()));
+}
+
+TEST(SecureSMTPClientBase_setTransport, WithScriptedTransport_NegotiateTLSThroughTransport) {
+    auto transport = std::make_shared<ScriptedTransport>(true);
+    OpportunisticSecureSMTPClient client("localhost", 587);
+    client.setTransport(transport);
+    // The scripted server does not speak TLS, the handshake fails on its reply
+    ASSERT_EQ(SSL_CLIENT_STARTTLS_BIO_HANDSHAKE_ERROR, client.sendMail(createMessage()));
+    size_t client_hello = transport->mReceived.find("STARTTLS\r\n");
+    ASSERT_NE(std::string::npos, client_hello);
+    client_hello += strlen("STARTTLS\r\n");
+    ASSERT_LT(client_hello + 5, transport->mReceived.size());
+    // A handshake record
+    ASSERT_EQ('\x16', transport->mReceived[client_hello]);
+    ASSERT_EQ('\x03', transport->mReceived[client_hello + 1]);
+    ASSERT_EQ(0U, transport->mMessageCount);
+    ASSERT_EQ(1, transport->mCloseCount);
+}
+
+TEST(SmtpClientConfig_setTransportFactory, WithFactory_EachClientHasNewTransport) {
+    SmtpClientConfig config(SmtpClientType::Plain, "localhost", 25);
+    ASSERT_FALSE(config.getTransportFactory());
+    int created_count = 0;
+    config.setTransportFactory([&created_count]() {
+        created_count++;
+        return std::make_shared<ScriptedTransport>();
+    });
+    ASSERT_EQ(0, config.sendMail(createMessage()));
+    ASSERT_EQ(0, config.sendMail(createMessage()));
+    ASSERT_EQ(2, created_count);
+}
+
+#ifndef _WIN32
+class SocketTransportFixture : public ::testing::Test {
+ public:
+    void SetUp() override {
+        int sockets[2];
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+        transport = std::make_unique<SocketTransport>(sockets[0]);
+        peer = sockets[1];
+    }
+    void TearDown() override {
+        if (peer >= 0) {
+            ::close(peer);
+        }
+    }
+    std::unique_ptr<SocketTransport> transport;
+    int peer = -1;
+};
+
+TEST_F(SocketTransportFixture, open_WithOpenSocket_ReturnZero) {
+    ASSERT_EQ(0, transport->open("localhost", 25, 1000));
+    ASSERT_GE(transport->getSocketFileDescriptor(), 0);
+}
+
+TEST_F(SocketTransportFixture, open_AfterClose_ReturnConnectError) {
+    transport->close();
+    transport->close();
+    ASSERT_EQ(-1, transport->getSocketFileDescriptor());
+    ASSERT_EQ(SOCKET_INIT_SESSION_CONNECT_ERROR, transport->open("localhost", 25, 1000));
+}
+
+TEST_F(SocketTransportFixture, write_WithSegments_PeerReceivesAllInOrder) {
+    const std::string large(100000, 'x');
+    const std::string_view segments[] { "BDAT 100002\r\n", "", large, "\r\n" };
+    ASSERT_EQ(0, transport->write(segments, 4));
+    std::string received;
+    char buffer[4096];
+    while (received.size() < 100000 + 15) {
+        ssize_t length = ::read(peer, buffer, sizeof(buffer));
+        ASSERT_GT(length, 0);
+        received.append(buffer, static_cast<size_t>(length));
+    }
+    ASSERT_EQ("BDAT 100002\r\n"s + large + "\r\n", received);
+}
+
+TEST_F(SocketTransportFixture, waitForData_WithoutData_ReturnZero) {
+    ASSERT_EQ(0, transport->waitForData(0));
+}
+
+TEST_F(SocketTransportFixture, read_WithPeerData_ReturnData) {
+    ASSERT_EQ(10, ::write(peer, "250 OK\r\nxx", 10));
+    ASSERT_EQ(1, transport->waitForData(1000));
+    char buffer[64];
+    ASSERT_EQ(10, transport->read(buffer, sizeof(buffer)));
+    ASSERT_EQ("250 OK\r\nxx"s, std::string(buffer, 10));
+}
+
+TEST_F(SocketTransportFixture, read_AfterPeerClosed_ReturnMinusOne) {
+    ::close(peer);
+    peer = -1;
+    ASSERT_EQ(1, transport->waitForData(1000));
+    char buffer[64];
+    ASSERT_EQ(-1, transport->read(buffer, sizeof(buffer)));
+}
+#endif
@@ -109,3 +109,29 @@ TEST(ToUpper, AllCaps) {
 TEST(ToUpper, AllLowerCase) {
     ASSERT_EQ("TEST", StringUtils::toUpper("test"));
 }
+
+TEST(IsAscii, WithAsciiLongerThanABlock_ReturnTrue) {
+    ASSERT_TRUE(StringUtils::isAscii(""));
+    ASSERT_TRUE(StringUtils::isAscii("joeblow@domainexample.com"));
+}
+
+TEST(IsAscii, WithNonAsciiInBlockOrTail_ReturnFalse) {
+    ASSERT_FALSE(StringUtils::isAscii("j\xC3\xBCrgen@example.com"));
+    ASSERT_FALSE(StringUtils::isAscii("jurgen@example.c\xC3\xB6m"));
+}
+
+TEST(IsValidUtf8, WithValidSequences_ReturnTrue) {
+    ASSERT_TRUE(StringUtils::isValidUtf8("plain ascii text"));
+    ASSERT_TRUE(StringUtils::isValidUtf8("b\xC3\xBC" "cher"));
+    ASSERT_TRUE(StringUtils::isValidUtf8("\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E"));
+    ASSERT_TRUE(StringUtils::isValidUtf8("\xF0\x9F\x98\x80 emoji"));
+}
+
+TEST(IsValidUtf8, WithInvalidSequences_ReturnFalse) {
+    // Lone continuation, overlong, surrogate, above U+10FFFF and truncated
+    ASSERT_FALSE(StringUtils::isValidUtf8("abc\x80"));
+    ASSERT_FALSE(StringUtils::isValidUtf8("\xC0\xAF"));
+    ASSERT_FALSE(StringUtils::isValidUtf8("\xED\xA0\x80"));
+    ASSERT_FALSE(StringUtils::isValidUtf8("\xF4\x90\x80\x80"));
+    ASSERT_FALSE(StringUtils::isValidUtf8("twelve chars\xE6\x97"));
+}
@@ -0,0 +1,85 @@
+#include "../../src/tlscontext.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+using namespace jed_utils;
+
+TEST(TlsContext_Constructor, NewContext_ReturnValidContext) {
+    TlsContext context;
+    ASSERT_TRUE(context.isValid());
+    ASSERT_NE(nullptr, context.getNativeContext());
+    ASSERT_EQ(0, context.getInitializationErrorCode());
+}
+
+TEST(TlsContext_getDefault, CalledTwice_ReturnSameContext) {
+    std::shared_ptr<TlsContext> first = TlsContext::getDefault();
+    std::shared_ptr<TlsContext> second = TlsContext::getDefault();
+    ASSERT_NE(nullptr, first);
+    ASSERT_EQ(first, second);
+    ASSERT_TRUE(first->isValid());
+}
+
+TEST(TlsContext_getNativeContext, TwoContexts_ReturnDistinctNativeContexts) {
+    TlsContext first;
+    TlsContext second;
+    ASSERT_NE(first.getNativeContext(), second.getNativeContext());
+}
+
+TEST(TlsContext_Constructor, NewContext_ReturnNoHandshakesAndNoSessions) {
+    TlsContext context;
+    ASSERT_TRUE(context.isSessionResumptionEnabled());
+    ASSERT_EQ(0, context.getFullHandshakeCount());
+    ASSERT_EQ(0, context.getResumedHandshakeCount());
+    ASSERT_EQ(0, context.getCachedSessionCount());
+}
+
+TEST(TlsContext_setSessionResumptionEnabled, WithFalse_ReturnFalse) {
+    TlsContext context;
+    context.setSessionResumptionEnabled(false);
+    ASSERT_FALSE(context.isSessionResumptionEnabled());
+    ASSERT_EQ(0, context.getCachedSessionCount());
+}
+
+TEST(TlsContext_clearSessionCache, WithNoSessions_ReturnNoSessions) {
+    TlsContext context;
+    context.clearSessionCache();
+    ASSERT_EQ(0, context.getCachedSessionCount());
+}
+
+TEST(TlsContext_Constructor, TwoContexts_ShareTrustStore) {
+    TlsContext first;
+    const uint64_t load_count = TlsContext::getTrustStoreLoadCount();
+    TlsContext second;
+    ASSERT_EQ(load_count, TlsContext::getTrustStoreLoadCount());
+    ASSERT_EQ(SSL_CTX_get_cert_store(first.getNativeContext()), SSL_CTX_get_cert_store(second.getNativeContext()));
+    ASSERT_TRUE(first.hasCurrentTrustStore());
+}
+
+TEST(TlsContext_refreshTrustStore, NextContext_LoadTrustStoreAgain) {
+    TlsContext before;
+    std::shared_ptr<TlsContext> default_before = TlsContext::getDefault();
+    const uint64_t load_count = TlsContext::getTrustStoreLoadCount();
+    TlsContext::refreshTrustStore();
+    ASSERT_FALSE(before.hasCurrentTrustStore());
+    TlsContext after;
+    ASSERT_EQ(load_count + 1, TlsContext::getTrustStoreLoadCount());
+    ASSERT_TRUE(after.isValid());
+    ASSERT_NE(SSL_CTX_get_cert_store(before.getNativeContext()), SSL_CTX_get_cert_store(after.getNativeContext()));
+    ASSERT_FALSE(before.hasCurrentTrustStore());
+    ASSERT_TRUE(after.hasCurrentTrustStore());
+    // The default context is replaced so that the new anchors are used
+    ASSERT_NE(default_before, TlsContext::getDefault());
+    ASSERT_EQ(TlsContext::getDefault(), TlsContext::getDefault());
+}
+
+TEST(TlsContext_setTrustStoreRefreshInterval, WithInterval_ReturnInterval) {
+    const std::chrono::seconds previous = TlsContext::getTrustStoreRefreshInterval();
+    ASSERT_EQ(3600, previous.count());
+    TlsContext::setTrustStoreRefreshInterval(std::chrono::seconds(0));
+    ASSERT_EQ(0, TlsContext::getTrustStoreRefreshInterval().count());
+    TlsContext context;
+    ASSERT_TRUE(context.hasCurrentTrustStore());
+    TlsContext::setTrustStoreRefreshInterval(previous);
+}